@@ -75,6 +75,11 @@ class PlannerData
 
             planner_data *p_data = (planner_data *)msgInfo->p_data;
 
+            if (msgInfo->isDataByteorderCpu()) // data in cpu byteorder
+            {
+                return p_data;
+            }
+
             if (msgInfo->isDataByteorderLe()) // data in little endian
             {
                 le_to_cpu(p_data);
@@ -112,6 +117,11 @@ class PlannerCommand
 
             planner_command *p_data = (planner_command *)msgInfo->p_data;
 
+            if (msgInfo->isDataByteorderCpu()) // data in cpu byteorder
+            {
+                return p_data;
+            }
+
             if (msgInfo->isDataByteorderLe()) // data in little endian
             {
                 le_to_cpu(p_data);
@@ -0,0 +1,493 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2006 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Marko Reimer <reimer@rts.uni-hannover.de>
+ *
+ */
+#include <main/rack_module.h>
+#include <main/rack_name.h>
+#include <main/argopts.h>
+#include <main/camera_tool.h>
+
+#include <stdlib.h>
+#include <math.h>
+
+//
+// Converts synthetic camera images with all instruction sets of the
+// CameraTool and in row stripes. The times per image are printed, the
+// results have to be equal to the scalar conversion. The 16 bit filters
+// run serial and in row stripes on a full range and a 12 bit depth image,
+// their results have to be equal to the previous per pixel filters.
+// The job mailboxes of the workers need a running TiMS router.
+//
+
+//
+// data structures
+//
+
+arg_table_t argTab[] = {
+
+    { ARGOPT_OPT, "width", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Image width, default 1280", { 1280 } },
+
+    { ARGOPT_OPT, "height", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Image height, default 1024", { 1024 } },
+
+    { ARGOPT_OPT, "loopNum", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Conversions per measurement, default 20", { 20 } },
+
+    { ARGOPT_OPT, "workerNum", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Number of worker tasks, default 3", { 3 } },
+
+    { 0, "", 0, 0, "", { 0 } } // last entry
+};
+
+typedef struct {
+    int         type;
+    int         colorFilterId;
+    int         inBytes;                    // per pixel
+    int         outBytes;
+    const char  *name;
+} convert_type;
+
+static const convert_type convertTypes[] = {
+    { CAMERA_TOOL_UYVY2RGB,       0,                 2, 3, "uyvy -> rgb       " },
+    { CAMERA_TOOL_UYVY2BGR,       0,                 2, 3, "uyvy -> bgr       " },
+    { CAMERA_TOOL_UYVY2GRAY,      0,                 2, 1, "uyvy -> gray      " },
+    { CAMERA_TOOL_BAYER2RGB,      COLORFILTER_RGGB,  1, 3, "bayer rggb       " },
+    { CAMERA_TOOL_BAYER2RGB,      COLORFILTER_GBRG,  1, 3, "bayer gbrg       " },
+    { CAMERA_TOOL_BAYER2RGB,      COLORFILTER_GRBG,  1, 3, "bayer grbg       " },
+    { CAMERA_TOOL_BAYER2RGB,      COLORFILTER_BGGR,  1, 3, "bayer bggr       " },
+    { CAMERA_TOOL_BAYER2RGB_EDGE, COLORFILTER_RGGB,  1, 3, "bayer rggb edge  " },
+    { CAMERA_TOOL_BAYER2RGB_EDGE, COLORFILTER_BGGR,  1, 3, "bayer bggr edge  " },
+    { CAMERA_TOOL_MONO122MONO8,   0,                 2, 1, "mono12 -> mono8  " },
+    { CAMERA_TOOL_MONO162MONO8,   0,                 2, 1, "mono16 -> mono8  " },
+};
+
+typedef struct {
+    int         type;
+    int         radius;
+    const char  *name;
+} filter_type;
+
+static const filter_type filterTypes[] = {
+    { CAMERA_TOOL_MEDIAN16,       5,  "median 5         " },
+    { CAMERA_TOOL_MEDIAN16,       9,  "median 9         " },
+    { CAMERA_TOOL_MEDIAN16,       10, "median 10        " },
+    { CAMERA_TOOL_MEDIAN16,       16, "median 16        " },
+    { CAMERA_TOOL_MEDIAN16,       31, "median 31        " },
+    { CAMERA_TOOL_MEDIAN16_2D,    2,  "median 5x5       " },
+    { CAMERA_TOOL_MEDIAN16_2D,    7,  "median 15x15     " },
+    { CAMERA_TOOL_BOX16,          2,  "box 5x5          " },
+    { CAMERA_TOOL_BOX16,          15, "box 31x31        " },
+};
+
+static int filter(CameraTool *tool, int type, short *output, short *input, int width,
+                  int height, int radius)
+{
+    switch (type)
+    {
+        case CAMERA_TOOL_MEDIAN16:
+            return tool->qsMedianFilter16Bit(output, input, width, height, radius);
+        case CAMERA_TOOL_MEDIAN16_2D:
+            return tool->medianFilter16Bit2d(output, input, width, height, radius);
+        default:
+            return tool->lowPassFilter16Bit(output, input, width, height, radius);
+    }
+}
+
+//
+// previous per pixel filters as reference
+//
+
+// median of radius pixels in the row, selection sort of every window
+static void refMedian(short *outputData, short *inputData, int width, int height, int radius)
+{
+    int     i, j, k, l, minIndex;
+    short   swapValue;
+    short   arr[radius];
+
+    for (i = 0; i < height; i++)
+    {
+        for (j = radius / 2; j < width - radius / 2; j++)
+        {
+            memcpy(arr, &inputData[i * width + j - radius / 2], radius * sizeof(short));
+
+            for (k = 0; k <= radius / 2; k++)
+            {
+                minIndex  = k;
+                swapValue = arr[k];
+
+                for (l = k + 1; l < radius; l++)
+                {
+                    if (arr[l] < arr[minIndex])
+                        minIndex = l;
+                }
+
+                arr[k]        = arr[minIndex];
+                arr[minIndex] = swapValue;
+            }
+            outputData[i * width + j] = arr[radius / 2];
+        }
+
+        for (j = 0; j < radius / 2; j++)
+        {
+            outputData[i * width + j] = outputData[i * width + radius / 2];
+            outputData[i * width + j + width - radius / 2] =
+                outputData[i * width + width - radius / 2 - 1];
+        }
+    }
+}
+
+// value k of the sorted array (quickselect)
+static short refSelect(short *arr, int num, int k)
+{
+    int     left = 0, right = num - 1, i, j;
+    short   pivot, swapValue;
+
+    while (left < right)
+    {
+        pivot = arr[(left + right) / 2];
+        i     = left;
+        j     = right;
+
+        while (i <= j)
+        {
+            while (arr[i] < pivot)
+                i++;
+            while (arr[j] > pivot)
+                j--;
+            if (i <= j)
+            {
+                swapValue = arr[i];
+                arr[i]    = arr[j];
+                arr[j]    = swapValue;
+                i++;
+                j--;
+            }
+        }
+
+        if (k <= j)
+            right = j;
+        else if (k >= i)
+            left = i;
+        else
+            break;
+    }
+    return arr[k];
+}
+
+// the first and last radius pixels and rows take the nearest filtered one
+static void refBorder(short *outputData, int width, int height, int radius)
+{
+    int i, j;
+
+    for (i = radius; i < height - radius; i++)
+    {
+        for (j = 0; j < radius; j++)
+        {
+            outputData[i * width + j] = outputData[i * width + radius];
+            outputData[i * width + j + width - radius] = outputData[i * width + width - radius - 1];
+        }
+    }
+
+    for (i = 0; i < radius; i++)
+    {
+        for (j = 0; j < width; j++)
+        {
+            outputData[i * width + j] = outputData[radius * width + j];
+            outputData[(height - i - 1) * width + j] = outputData[(height - radius - 1) * width + j];
+        }
+    }
+}
+
+// median of the (2 * radius + 1)^2 window
+static void refMedian2d(short *outputData, short *inputData, int width, int height, int radius)
+{
+    int     i, j, k, l, num, side = 2 * radius + 1;
+    short   arr[side * side];
+
+    for (i = radius; i < height - radius; i++)
+    {
+        for (j = radius; j < width - radius; j++)
+        {
+            num = 0;
+            for (k = i - radius; k <= i + radius; k++)
+            {
+                for (l = j - radius; l <= j + radius; l++)
+                    arr[num++] = inputData[k * width + l];
+            }
+            outputData[i * width + j] = refSelect(arr, num, num / 2);
+        }
+    }
+    refBorder(outputData, width, height, radius);
+}
+
+// mean of the (2 * radius + 1)^2 window, floor(sum / n)
+static void refBox(short *outputData, short *inputData, int width, int height, int radius)
+{
+    int     i, j, k, l, side = 2 * radius + 1;
+    double  sum;
+
+    for (i = radius; i < height - radius; i++)
+    {
+        for (j = radius; j < width - radius; j++)
+        {
+            sum = 0;
+            for (k = 0; k < side; k++)
+            {
+                for (l = 0; l < side; l++)
+                    sum += inputData[(i - radius + k) * width + j - radius + l];
+            }
+            outputData[i * width + j] = (short)floor(sum / (side * side));
+        }
+    }
+    refBorder(outputData, width, height, radius);
+}
+
+static void refFilter(int type, short *output, short *input, int width, int height,
+                      int radius)
+{
+    switch (type)
+    {
+        case CAMERA_TOOL_MEDIAN16:
+            refMedian(output, input, width, height, radius);
+            break;
+        case CAMERA_TOOL_MEDIAN16_2D:
+            refMedian2d(output, input, width, height, radius);
+            break;
+        default:
+            refBox(output, input, width, height, radius);
+            break;
+    }
+}
+
+// gradients with some noise and edges
+static void fillImage(uint8_t *data, int type, int width, int height, int bytes)
+{
+    int x, y, b, val;
+
+    for (y = 0; y < height; y++)
+    {
+        for (x = 0; x < width; x++)
+        {
+            for (b = 0; b < bytes; b++)
+            {
+                val = (x * 255 / width + y * 3 + b * 77 + (rand() & 15)) & 0xff;
+                if (((x / 64) + (y / 64)) & 1)
+                    val = 255 - val;
+
+                // 12 bit values in big endian
+                if ((type == CAMERA_TOOL_MONO122MONO8) && (b == 0))
+                    val &= 0x0f;
+
+                data[(y * width + x) * bytes + b] = val;
+            }
+        }
+    }
+}
+
+// 12 bit depth gradients with some noise and edges
+static void fillDepth(short *data, int width, int height)
+{
+    int x, y, val;
+
+    for (y = 0; y < height; y++)
+    {
+        for (x = 0; x < width; x++)
+        {
+            val = 500 + x + y + (rand() & 31);
+            if (((x / 64) + (y / 64)) & 1)
+                val += 1000;
+
+            data[y * width + x] = val & 0xfff;
+        }
+    }
+}
+
+int  main(int argc, char *argv[])
+{
+    RackTime        rackTime;
+    RackMailbox     jobMbx, doneMbx;
+    CameraTool      serialTool, stripeTool;
+    uint8_t         *input, *reference, *output;
+    uint64_t        time;
+    double          ms, msScalar;
+    int             width, height, loopNum, workerNum, maxLevel;
+    int             t, level, image, i, k, err, ret;
+    const char      *levelName[3] = { "scalar", "sse2", "avx2" };
+
+    // get args
+    ret = RackModule::getArgs(argc, argv, argTab, "CameraConvertBench");
+    if (ret)
+    {
+        printf("Invalid arguments -> EXIT \n");
+        return ret;
+    }
+
+    width     = getIntArg("width", argTab);
+    height    = getIntArg("height", argTab);
+    loopNum   = getIntArg("loopNum", argTab);
+    workerNum = getIntArg("workerNum", argTab);
+
+    if ((width < 4) || (height < 4) || (width & 1) || (height & 1) || (loopNum < 1))
+    {
+        printf("Invalid image size or loop number -> EXIT\n");
+        return -EINVAL;
+    }
+
+    input     = (uint8_t *)malloc(width * height * 3);
+    reference = (uint8_t *)malloc(width * height * 3);
+    output    = (uint8_t *)malloc(width * height * 3);
+    if (!input || !reference || !output)
+    {
+        printf("Can't allocate buffers -> EXIT\n");
+        return -ENOMEM;
+    }
+
+    if (workerNum > 0)
+    {
+        ret = jobMbx.create(RackName::create(TEST, 0) | 1, CAMERA_TOOL_WORKER_NUM_MAX,
+                            0, NULL, 0, 0);
+        if (!ret)
+        {
+            ret = doneMbx.create(RackName::create(TEST, 0) | 2, CAMERA_TOOL_WORKER_NUM_MAX,
+                                 0, NULL, 0, 0);
+        }
+        if (ret)
+        {
+            printf("Can't create the worker mailboxes (TiMS router running?), code = %d\n", ret);
+            return ret;
+        }
+    }
+
+    ret = stripeTool.initStripes(workerNum, 1, &jobMbx, &doneMbx);
+    if (ret)
+    {
+        printf("Can't create conversion workers, code = %d\n", ret);
+        return ret;
+    }
+
+    maxLevel = CameraTool::getSimdLevel();
+    printf("%d x %d pixels, %d worker tasks, up to %s\n", width, height, workerNum,
+           levelName[maxLevel]);
+
+    for (t = 0; t < (int)(sizeof(convertTypes) / sizeof(convertTypes[0])); t++)
+    {
+        const convert_type *c = &convertTypes[t];
+
+        fillImage(input, c->type, width, height, c->inBytes);
+        printf("%s", c->name);
+
+        msScalar = 0.0;
+        for (level = CAMERA_TOOL_SIMD_NONE; level <= maxLevel + 1; level++)
+        {
+            memset(output, 0, width * height * c->outBytes);
+
+            time = rackTime.getNano();
+            for (i = 0; i < loopNum; i++)
+            {
+                // the last run converts in stripes
+                if (level <= maxLevel)
+                {
+                    CameraTool::setSimdLevel(level);
+                    serialTool.convert(c->type, output, input, width, height, c->colorFilterId);
+                }
+                else
+                {
+                    stripeTool.convert(c->type, output, input, width, height, c->colorFilterId);
+                }
+            }
+            ms = (double)(rackTime.getNano() - time) / 1000000.0 / loopNum;
+
+            if (level == CAMERA_TOOL_SIMD_NONE)
+            {
+                memcpy(reference, output, width * height * c->outBytes);
+                msScalar = ms;
+            }
+
+            err = 0;
+            for (k = 0; k < width * height * c->outBytes; k++)
+            {
+                if (output[k] != reference[k])
+                    err++;
+            }
+
+            printf(" %s %7.3f ms (x%4.1f)%s", level <= maxLevel ? levelName[level] : "stripes",
+                   ms, msScalar / ms, err ? " ERROR" : "");
+        }
+        printf("\n");
+        CameraTool::setSimdLevel(maxLevel);
+    }
+
+    // 16 bit filters of a full range and a depth image
+    for (image = 0; image < 2; image++)
+    {
+        if (image == 0)
+        {
+            fillImage(input, 0, width, height, 2);
+            printf("full range image\n");
+        }
+        else
+        {
+            fillDepth((short *)input, width, height);
+            printf("12 bit depth image\n");
+        }
+
+        for (t = 0; t < (int)(sizeof(filterTypes) / sizeof(filterTypes[0])); t++)
+        {
+            const filter_type *f = &filterTypes[t];
+
+            printf("%s", f->name);
+
+            time = rackTime.getNano();
+            refFilter(f->type, (short *)reference, (short *)input, width, height, f->radius);
+            msScalar = (double)(rackTime.getNano() - time) / 1000000.0;
+            printf(" ref    %7.3f ms", msScalar);
+
+            for (level = 0; level < 2; level++)
+            {
+                memset(output, 0, width * height * 2);
+
+                time = rackTime.getNano();
+                for (i = 0; i < loopNum; i++)
+                {
+                    ret = filter(level ? &stripeTool : &serialTool, f->type, (short *)output,
+                                 (short *)input, width, height, f->radius);
+                }
+                ms = (double)(rackTime.getNano() - time) / 1000000.0 / loopNum;
+
+                err = ret ? 1 : 0;
+                for (k = 0; k < width * height * 2; k++)
+                {
+                    if (output[k] != reference[k])
+                        err++;
+                }
+
+                printf(" %s %7.3f ms (x%4.1f)%s", level ? "stripes" : "serial ",
+                       ms, msScalar / ms, err ? " ERROR" : "");
+            }
+            printf("\n");
+        }
+    }
+
+    stripeTool.cleanupStripes();
+    if (workerNum > 0)
+    {
+        doneMbx.remove();
+        jobMbx.remove();
+    }
+    free(output);
+    free(reference);
+    free(input);
+    return 0;
+}
@@ -20,8 +20,8 @@
 #define INIT_BIT_MBX_WORK     1
 #define INIT_BIT_MBX_CAMERA   2
 #define INIT_BIT_PROXY_CAMERA 3
-#define INIT_BIT_RGBARRAY     4
-#define INIT_BIT_JPEGBUFFER   5
+#define INIT_BIT_ENCODER      4
+#define INIT_BIT_MBX_JOB      5
 
 arg_table_t argTab[] = {
 
@@ -34,6 +34,24 @@ arg_table_t argTab[] = {
     { ARGOPT_OPT, "quality", ARGOPT_REQVAL, ARGOPT_VAL_INT,
       "quality", { 50 } },
 
+    { ARGOPT_OPT, "workerNum", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Number of compression worker tasks, 0 = data task, default 0", { 0 } },
+
+    { ARGOPT_OPT, "scale", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Downscaling factor of the image, default 1", { 1 } },
+
+    { ARGOPT_OPT, "roiX", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Left column of the region of interest, default 0", { 0 } },
+
+    { ARGOPT_OPT, "roiY", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Top row of the region of interest, default 0", { 0 } },
+
+    { ARGOPT_OPT, "roiWidth", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Width of the region of interest, 0 = image width, default 0", { 0 } },
+
+    { ARGOPT_OPT, "roiHeight", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Height of the region of interest, 0 = image height, default 0", { 0 } },
+
     { 0, "", 0, 0, "", { 0 } } // last entry
 };
 
@@ -55,15 +73,22 @@ arg_table_t argTab[] = {
 
     // get dynamic module parameter
     quality       = getInt32Param("quality");
-
-    GDOS_DBG_DETAIL("Initialising static compression structs \n");
+    scale         = getInt32Param("scale");
+    roiX          = getInt32Param("roiX");
+    roiY          = getInt32Param("roiY");
+    roiWidth      = getInt32Param("roiWidth");
+    roiHeight     = getInt32Param("roiHeight");
 
     RackTask::disableRealtimeMode();
 
-    cinfo.err = jpeg_std_error(&jerr);
-    jpeg_create_compress(&cinfo);
+    encoder->setParam(quality, scale, roiX, roiY, roiWidth, roiHeight);
 
-    jpeg_stdmem_dest( &cinfo, jpegBuffer );
+    // every frame in process is compressed into its own data buffer entry
+    ret = setDataBufferWorkSpaceNum(encoder->getFrameNum());
+    if (ret)
+    {
+        return ret;
+    }
 
     GDOS_DBG_DETAIL("Turn on Camera(%d/%d) \n", cameraSys, cameraInst);
 
@@ -75,25 +100,6 @@ arg_table_t argTab[] = {
     }
     GDOS_DBG_DETAIL("Camera(%d/%d) has been turned on \n", cameraSys, cameraInst);
 
-    //get one image to get all needed parameter
-    GDOS_DBG_DETAIL("Request data from Camera(%d/%d)\n", cameraSys, cameraInst);
-    ret = camera->getData(&cameraInputMsg.data, sizeof(cameraInputMsg), 0);
-    if (ret)
-    {
-        GDOS_ERROR("Can't get single data from Camera(%d/%d), "
-                   "code = %d \n", cameraSys, cameraInst, ret);
-        return ret;
-    }
-
-    cinfo.image_width      = cameraInputMsg.data.width;
-    cinfo.image_height     = cameraInputMsg.data.height;
-    cinfo.input_components = (cameraInputMsg.data.depth / 8) > 1 ? 3 : 1; //16 bit werte sind yuv und werden zu rgb24 aufskaliert
-    cinfo.in_color_space   = (cameraInputMsg.data.depth / 8) > 1 ? JCS_RGB : JCS_GRAYSCALE;
-
-    jpeg_set_defaults( &cinfo );
-    jpeg_set_quality( &cinfo, quality, TRUE /* limit to baseline-JPEG values */ );
-
-
     GDOS_DBG_DETAIL("Request continuous data from Camera(%d/%d)\n", cameraSys, cameraInst);
     ret = camera->getContData(dataBufferPeriodTime, &cameraMbx, &dataBufferPeriodTime);
     if (ret)
@@ -103,6 +109,9 @@ arg_table_t argTab[] = {
         return ret;
     }
 
+    timeCount1s  = rackTime.get();
+    frameCount1s = 0;
+
     return RackDataModule::moduleOn();  // has to be last command in moduleOn();
 }
 
@@ -111,31 +120,70 @@ void CameraJpeg::moduleOff(void)
 {
    RackDataModule::moduleOff();        // has to be first command in moduleOff();
 
-   jpeg_destroy_compress(&cinfo);
-
    camera->stopContData(&cameraMbx);
 
+   // drop the frames in process
+   encoder->flush();
 }
 
 int CameraJpeg::moduleLoop(void)
 {
     camera_data_msg*   p_data = NULL;
     camera_data_msg*   dataCameraInput = NULL;
-    ssize_t            datalength = 0;
-//    rack_time_t          starttime;
     RackMessage        msgInfo;
     int                ret;
 
-    GDOS_DBG_INFO("starting loop\n");
+    // compression by the data task
+    if (!workerNum)
+    {
+        // get datapointer from rackdatabuffer
+        p_data = (camera_data_msg *)getDataBufferWorkSpace();
+
+        // get Camera data
+        ret = cameraMbx.peek(&msgInfo);
+        if (ret)
+        {
+            GDOS_ERROR("Can't receive camera data on DATA_MBX, "
+                       "code = %d \n", ret);
+            return ret;
+        }
+
+        if ((msgInfo.getType() != MSG_DATA) ||
+            (msgInfo.getSrc()  != camera->getDestAdr()))
+        {
+            GDOS_ERROR("Received unexpected message from %n to %n type %d on "
+                       "data mailbox\n", msgInfo.getSrc(), msgInfo.getDest(), msgInfo.getType());
+
+            cameraMbx.peekEnd();
+            return -EINVAL;
+        }
+
+        dataCameraInput = (camera_data_msg *) CameraData::parse(&msgInfo);
 
-    // get datapointer from rackdatabuffer
-    p_data = (camera_data_msg *)getDataBufferWorkSpace();
+        // the jpeg is written directly into the data buffer
+        ret = encoder->compress(dataCameraInput, p_data, dataBufferMaxDataSize);
 
-    GDOS_DBG_INFO("getting data from Camera(%d/%d\n", cameraSys, cameraInst);
+        cameraMbx.peekEnd();
+        putFrame(ret);
+        return 0;
+    }
+
+    // publish the compressed frames in the order of the camera frames
+    while ((ret = encoder->getOutput()) != -EAGAIN)
+    {
+        putFrame(ret);
+    }
 
-    // get Camera data
-    ret = cameraMbx.peek(&msgInfo);
-//    ret = cameraMbx.peekTimed(1000000000llu, &msgInfo); // 1s
+    dataCameraInput = encoder->getInput();
+    if (!dataCameraInput)
+    {
+        // all frames in process, camera frames are dropped until a worker
+        // reports a compressed frame
+        return encoder->waitOutput();
+    }
+
+    // get Camera data or the done message of a worker
+    ret = cameraMbx.recvDataMsg(dataCameraInput, sizeof(camera_data_msg), &msgInfo);
     if (ret)
     {
         GDOS_ERROR("Can't receive camera data on DATA_MBX, "
@@ -143,70 +191,51 @@ int CameraJpeg::moduleLoop(void)
         return ret;
     }
 
-    GDOS_DBG_INFO("parsing camera data \n");
+    if (msgInfo.getType() == CAMERA_JPEG_MSG_DONE)
+    {
+        return 0;
+    }
 
     if ((msgInfo.getType() != MSG_DATA) ||
         (msgInfo.getSrc()  != camera->getDestAdr()))
     {
         GDOS_ERROR("Received unexpected message from %n to %n type %d on "
                    "data mailbox\n", msgInfo.getSrc(), msgInfo.getDest(), msgInfo.getType());
-
-        cameraMbx.peekEnd();
         return -EINVAL;
     }
 
-    dataCameraInput = (camera_data_msg *) CameraData::parse(&msgInfo);
-
-    GDOS_DBG_INFO("converting camera data \n");
-
-    //convert camera_bytestream (may be yuv/raw mode) to rgb mode
-    switch(dataCameraInput->data.mode) {
-        case CAMERA_MODE_YUV422:
-            cameraTool.convertCharUYVY2BGR(rgbByteArray,
-                                           dataCameraInput->byteStream,
-                                           dataCameraInput->data.width,
-                                           dataCameraInput->data.height);
-            break;
-        case CAMERA_MODE_MONO8:
-        case CAMERA_MODE_RGB24:
-            cameraTool.convertCharBGR2RGB(rgbByteArray,
-                                           dataCameraInput->byteStream,
-                                           dataCameraInput->data.width,
-                                           dataCameraInput->data.height);
-//memcpy(rgbByteArray, dataCameraInput->byteStream, sizeof(dataCameraInput->byteStream));
-            break;
-        default:
-            GDOS_ERROR( "Unkown image mode %i for camera_jpeg\n", dataCameraInput->data.mode);
-    }
-    GDOS_DBG_INFO("starting compress \n");
-
-    jpeg_start_compress(&cinfo, TRUE);//true for outputting all tables
+    CameraData::parse(&msgInfo);
 
-    GDOS_DBG_INFO("compressing\n");
+    // the frames in process use the following data buffer entries
+    p_data = (camera_data_msg *)getDataBufferWorkSpace(encoder->getFrameCount());
 
-    compressByteStream2JpegStream(rgbByteArray, &cinfo);
-
-    GDOS_DBG_INFO("finishing compress\n");
-
-    jpeg_finish_compress(&cinfo);
+    return encoder->queue(p_data, dataBufferMaxDataSize);
+}
 
-    GDOS_DBG_INFO("sending data with jpeg size %i\n", ((jpeg_data_dst_ptr)cinfo.dest)->outstreamOffset);
+// puts the next data buffer entry, failed frames are dropped
+void CameraJpeg::putFrame(int datalen)
+{
+    rack_time_t time;
 
-    p_data->data.recordingTime = dataCameraInput->data.recordingTime;
-    p_data->data.width         = dataCameraInput->data.width;
-    p_data->data.height        = dataCameraInput->data.height;
-    p_data->data.depth         = cinfo.input_components * 8;
-    p_data->data.mode          = CAMERA_MODE_JPEG;
-    p_data->data.colorFilterId = ((jpeg_data_dst_ptr)cinfo.dest)->outstreamOffset; //missused as array length here
+    if (datalen < 0)
+    {
+        GDOS_WARNING("Can't compress camera frame, code = %d\n", datalen);
+        dropDataBufferWorkSpace();
+        return;
+    }
 
-    memcpy(&(p_data->byteStream), jpegBuffer, ((jpeg_data_dst_ptr)cinfo.dest)->outstreamOffset);
+    GDOS_DBG_INFO("sending data with jpeg size %i\n", datalen - (int)sizeof(camera_data));
 
-    datalength = sizeof(camera_data) +
-                 ((jpeg_data_dst_ptr)cinfo.dest)->outstreamOffset; //special in jdatadstmem.c!!
+    putDataBufferWorkSpace(datalen);
 
-    cameraMbx.peekEnd();
-    putDataBufferWorkSpace(datalength);
-    return 0;
+    frameCount1s++;
+    time = rackTime.get();
+    if (time - timeCount1s >= 1000)
+    {
+        GDOS_DBG_INFO("%d frames/s\n", frameCount1s * 1000 / (int)(time - timeCount1s));
+        timeCount1s  = time;
+        frameCount1s = 0;
+    }
 }
 
 
@@ -251,7 +280,7 @@ int CameraJpeg::moduleCommand(RackMessage *msgInfo)
 
 int CameraJpeg::moduleInit(void)
 {
-    int ret;
+    int ret, slots;
 
     // call RackDataModule init function (first command in init)
     ret = RackDataModule::moduleInit();
@@ -269,8 +298,15 @@ int CameraJpeg::moduleInit(void)
     }
     initBits.setBit(INIT_BIT_MBX_WORK);
 
-    // camera-data mailbox
-    ret = createMbx(&cameraMbx, 1, sizeof(camera_data_msg),
+    // camera-data mailbox, receives a done message per frame in process
+    // (workerNum + 1) as well
+    slots = 1;
+    if (workerNum > 0)
+    {
+        slots += (workerNum < CAMERA_JPEG_WORKER_NUM_MAX ? workerNum :
+                                                            CAMERA_JPEG_WORKER_NUM_MAX) + 1;
+    }
+    ret = createMbx(&cameraMbx, slots, sizeof(camera_data_msg),
                     MBX_IN_USERSPACE | MBX_SLOT);
     if (ret)
     {
@@ -278,6 +314,18 @@ int CameraJpeg::moduleInit(void)
     }
     initBits.setBit(INIT_BIT_MBX_CAMERA);
 
+    // job mailbox of the workers
+    if (workerNum > 0)
+    {
+        ret = createMbx(&jobMbx, CAMERA_JPEG_FRAME_NUM_MAX, 0,
+                        MBX_IN_KERNELSPACE | MBX_SLOT);
+        if (ret)
+        {
+            goto init_error;
+        }
+        initBits.setBit(INIT_BIT_MBX_JOB);
+    }
+
     // create Camera Proxy
     camera = new CameraProxy(&workMbx, cameraSys, cameraInst);
     if (!camera)
@@ -287,19 +335,21 @@ int CameraJpeg::moduleInit(void)
     }
     initBits.setBit(INIT_BIT_PROXY_CAMERA);
 
-    if((rgbByteArray = (uint8_t *) malloc(CAMERA_MAX_WIDTH*CAMERA_MAX_HEIGHT*CAMERA_MAX_DEPTH/8)) == NULL)
+    // jpeg compression
+    encoder = new CameraJpegEncoder(&cmdMbx, gdosLevel);
+    if (!encoder)
     {
-        GDOS_ERROR("Can't allocate rgbByteArray buffer\n");
-        return -ENOMEM;
+        ret = -ENOMEM;
+        goto init_error;
     }
-    initBits.setBit(INIT_BIT_RGBARRAY);
+    initBits.setBit(INIT_BIT_ENCODER);
 
-    if((jpegBuffer = (char *) malloc(CAMERA_MAX_WIDTH*CAMERA_MAX_HEIGHT*CAMERA_MAX_DEPTH/8)) == NULL)
+    ret = encoder->init(workerNum, getDataTaskPrio(), &jobMbx, &cameraMbx);
+    if (ret)
     {
-        GDOS_ERROR("Can't allocate jpegBuffer\n");
-        return -ENOMEM;
+        GDOS_ERROR("Can't create jpeg compression, code = %d\n", ret);
+        goto init_error;
     }
-    initBits.setBit(INIT_BIT_JPEGBUFFER);
 
     return 0;
 
@@ -317,19 +367,19 @@ void CameraJpeg::moduleCleanup(void)
         RackDataModule::moduleCleanup();
     }
 
-    if (initBits.testAndClearBit(INIT_BIT_JPEGBUFFER))
+    if (initBits.testAndClearBit(INIT_BIT_ENCODER))
     {
-        free(jpegBuffer);
+        delete encoder;
     }
 
-    if (initBits.testAndClearBit(INIT_BIT_RGBARRAY))
+   if (initBits.testAndClearBit(INIT_BIT_PROXY_CAMERA))
     {
-        free(rgbByteArray);
+        delete camera;
     }
 
-   if (initBits.testAndClearBit(INIT_BIT_PROXY_CAMERA))
+    if (initBits.testAndClearBit(INIT_BIT_MBX_JOB))
     {
-        delete camera;
+        destroyMbx(&jobMbx);
     }
 
     if (initBits.testAndClearBit(INIT_BIT_MBX_CAMERA))
@@ -351,12 +401,13 @@ CameraJpeg::CameraJpeg()
                       16,                   // command mailbox slots
                       48,                   // command mailbox data size per slot
                       MBX_IN_KERNELSPACE | MBX_SLOT, // command mailbox flags //## it should be user space
-                      10,                    // max buffer entries
+                      CAMERA_JPEG_FRAME_NUM_MAX + 2, // max buffer entries
                       10)                   // data buffer listener
 {
     // get static module parameter
     cameraSys     = getIntArg("cameraSys", argTab);
     cameraInst    = getIntArg("cameraInst", argTab);
+    workerNum     = getIntArg("workerNum", argTab);
 
     dataBufferMaxDataSize = sizeof(camera_data_msg);
 }
@@ -401,18 +452,3 @@ exit_error:
 
     return ret;
 }
-
-void CameraJpeg::compressByteStream2JpegStream(uint8_t* byteStream, j_compress_ptr cinfo)
-{
-    JSAMPLE* image_buffer = (JSAMPLE*) byteStream;
-    JSAMPROW row_pointer[1];   /* pointer to a single row */
-    int row_stride;            /* physical row width in buffer */
-
-    row_stride = cinfo->image_width * cinfo->input_components;    /* JSAMPLEs per row in image_buffer */
-
-    while (cinfo->next_scanline < cinfo->image_height) {
-        row_pointer[0] = &(image_buffer[cinfo->next_scanline * row_stride]);
-        jpeg_write_scanlines(cinfo, row_pointer, 1);
-    }
-        GDOS_DBG_INFO("end while\n");
-}
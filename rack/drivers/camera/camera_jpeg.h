@@ -17,10 +17,9 @@
 #define __CAMERA_JPEG_H__
 
 #include <main/rack_data_module.h>
-#include <main/camera_tool.h>
 #include <drivers/camera_proxy.h>
 
-#include <main/jpeg_tool.h> //destination manager for memory destination
+#include "camera_jpeg_encoder.h"
 
 // define module class
 #define MODULE_CLASS_ID     CAMERA
@@ -30,7 +29,11 @@
 /**
  * Compression of raw camera images.
  *
- * Uses libjpeg.
+ * Uses libjpeg. With workerNum > 0 several frames are converted and
+ * compressed in parallel by worker tasks, they are written directly into
+ * the data buffer and published in the order of the camera frames. The
+ * workers report the compressed frames to the camera mailbox, so the data
+ * task waits for camera frames and compressed frames at once.
  *
  * @ingroup modules_camera
  */
@@ -40,28 +43,30 @@ class CameraJpeg : public RackDataModule {
     // your values
     //variables for common control
     rack_time_t                 timeCount1s;
-    uint8_t*                    rgbByteArray; //converted to char later on
-    char*                       jpegBuffer;//char enforced by jpegLib
-    struct jpeg_compress_struct cinfo;
-    struct jpeg_error_mgr       jerr;
+    int                         frameCount1s;
 
     //variables for parameter
     int cameraSys;
     int cameraInst;
     int quality;
+    int workerNum;
+    int scale;
+    int roiX;
+    int roiY;
+    int roiWidth;
+    int roiHeight;
 
     // additional mailboxes
     RackMailbox cameraMbx;
     RackMailbox workMbx;
+    RackMailbox jobMbx;                     // frames queued for the workers
 
     // proxies
     CameraProxy  *camera;
 
-    camera_data_msg cameraInputMsg;
+    CameraJpegEncoder   *encoder;
 
-    CameraTool      cameraTool;
-
-    void compressByteStream2JpegStream(uint8_t* byteStream, j_compress_ptr cinfo);
+    void putFrame(int datalen);
 
   protected:
 
@@ -0,0 +1,275 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2006 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Marko Reimer <reimer@l3s.de>
+ *
+ */
+#include <main/rack_module.h>
+#include <main/rack_name.h>
+#include <main/argopts.h>
+
+#include "camera_jpeg_encoder.h"
+
+//
+// Compresses synthetic camera images like CameraJpeg, first by the calling
+// task and then in the pipeline of the worker tasks. The frames per second
+// are printed, the pipeline output has to be in order and equal to the
+// serial compression. The job mailboxes of the workers need a running TiMS
+// router.
+//
+
+#define BENCH_IMAGE_NUM             4               // different input images
+
+//
+// data structures
+//
+
+arg_table_t argTab[] = {
+
+    { ARGOPT_OPT, "width", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Image width, default 1280", { 1280 } },
+
+    { ARGOPT_OPT, "height", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Image height, default 1024", { 1024 } },
+
+    { ARGOPT_OPT, "frameNum", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Frames per measurement, default 40", { 40 } },
+
+    { ARGOPT_OPT, "workerNum", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Number of worker tasks, default 3", { 3 } },
+
+    { ARGOPT_OPT, "quality", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Jpeg quality, default 75", { 75 } },
+
+    { 0, "", 0, 0, "", { 0 } } // last entry
+};
+
+typedef struct {
+    int         mode;
+    int         colorFilterId;
+    int         bytes;                      // per pixel
+    int         scale;
+    const char  *name;
+} bench_type;
+
+static const bench_type benchTypes[] = {
+    { CAMERA_MODE_YUV422, 0,                2, 1, "yuv422       " },
+    { CAMERA_MODE_YUV422, 0,                2, 2, "yuv422 1/2   " },
+    { CAMERA_MODE_RAW8,   COLORFILTER_RGGB, 1, 1, "raw8 rggb    " },
+    { CAMERA_MODE_MONO8,  0,                1, 1, "mono8        " },
+};
+
+// gradients with some noise and edges
+static void fillImage(camera_data_msg *msg, const bench_type *t, int width, int height,
+                      int n)
+{
+    int x, y, b, val;
+
+    msg->data.recordingTime = n;
+    msg->data.width         = width;
+    msg->data.height        = height;
+    msg->data.depth         = t->bytes * 8;
+    msg->data.mode          = t->mode;
+    msg->data.colorFilterId = t->colorFilterId;
+
+    for (y = 0; y < height; y++)
+    {
+        for (x = 0; x < width; x++)
+        {
+            for (b = 0; b < t->bytes; b++)
+            {
+                val = ((x + n * 16) * 255 / width + y / 4 + b * 77 + (rand() & 7)) & 0xff;
+                if ((((x + n * 16) / 64) + (y / 64)) & 1)
+                    val = 255 - val;
+
+                msg->byteStream[(y * width + x) * t->bytes + b] = val;
+            }
+        }
+    }
+}
+
+int  main(int argc, char *argv[])
+{
+    RackTime            rackTime;
+    RackMailbox         jobMbx, doneMbx;
+    CameraJpegEncoder   serialEncoder, pipeEncoder;
+    camera_data_msg     *image[BENCH_IMAGE_NUM];
+    camera_data_msg     *reference[BENCH_IMAGE_NUM];
+    camera_data_msg     *output[CAMERA_JPEG_FRAME_NUM_MAX];
+    camera_data_msg     *input;
+    int                 refLen[BENCH_IMAGE_NUM];
+    uint64_t            time;
+    double              fpsSerial, fpsPipe;
+    int                 width, height, frameNum, workerNum, quality, outNum;
+    int                 t, i, n, queued, done, err, ret;
+
+    // get args
+    ret = RackModule::getArgs(argc, argv, argTab, "CameraJpegBench");
+    if (ret)
+    {
+        printf("Invalid arguments -> EXIT \n");
+        return ret;
+    }
+
+    width     = getIntArg("width", argTab);
+    height    = getIntArg("height", argTab);
+    frameNum  = getIntArg("frameNum", argTab);
+    workerNum = getIntArg("workerNum", argTab);
+    quality   = getIntArg("quality", argTab);
+
+    if ((width < 16) || (height < 16) || (width > CAMERA_MAX_WIDTH) ||
+        (height > CAMERA_MAX_HEIGHT) || (width & 1) || (frameNum < 1))
+    {
+        printf("Invalid image size or frame number -> EXIT\n");
+        return -EINVAL;
+    }
+
+    for (i = 0; i < BENCH_IMAGE_NUM; i++)
+    {
+        image[i]     = (camera_data_msg *)malloc(sizeof(camera_data_msg));
+        reference[i] = (camera_data_msg *)malloc(sizeof(camera_data_msg));
+        if (!image[i] || !reference[i])
+        {
+            printf("Can't allocate buffers -> EXIT\n");
+            return -ENOMEM;
+        }
+    }
+
+    if (workerNum > 0)
+    {
+        ret = jobMbx.create(RackName::create(TEST, 0) | 1, CAMERA_JPEG_FRAME_NUM_MAX,
+                            0, NULL, 0, 0);
+        if (!ret)
+        {
+            ret = doneMbx.create(RackName::create(TEST, 0) | 2, CAMERA_JPEG_FRAME_NUM_MAX,
+                                 0, NULL, 0, 0);
+        }
+        if (ret)
+        {
+            printf("Can't create the worker mailboxes (TiMS router running?), code = %d\n", ret);
+            return ret;
+        }
+    }
+
+    ret = serialEncoder.init(0, 0, NULL, NULL);
+    if (!ret)
+        ret = pipeEncoder.init(workerNum, 1, &jobMbx, &doneMbx);
+    if (ret)
+    {
+        printf("Can't create jpeg encoders, code = %d\n", ret);
+        return ret;
+    }
+
+    outNum = pipeEncoder.getFrameNum();
+    for (i = 0; i < outNum; i++)
+    {
+        output[i] = (camera_data_msg *)malloc(sizeof(camera_data_msg));
+        if (!output[i])
+        {
+            printf("Can't allocate buffers -> EXIT\n");
+            return -ENOMEM;
+        }
+    }
+
+    printf("%d x %d pixels, quality %d, %d worker tasks\n", width, height, quality,
+           outNum - 1);
+
+    for (t = 0; t < (int)(sizeof(benchTypes) / sizeof(benchTypes[0])); t++)
+    {
+        const bench_type *b = &benchTypes[t];
+
+        serialEncoder.setParam(quality, b->scale, 0, 0, 0, 0);
+        pipeEncoder.setParam(quality, b->scale, 0, 0, 0, 0);
+
+        for (i = 0; i < BENCH_IMAGE_NUM; i++)
+        {
+            fillImage(image[i], b, width, height, i);
+        }
+
+        // compression by the calling task, the input is copied like a mailbox message
+        time = rackTime.getNano();
+        for (n = 0; n < frameNum; n++)
+        {
+            i = n % BENCH_IMAGE_NUM;
+            memcpy(output[0], image[i], sizeof(camera_data) + width * height * b->bytes);
+            refLen[i] = serialEncoder.compress(output[0], reference[i], sizeof(camera_data_msg));
+        }
+        fpsSerial = frameNum * 1000000000.0 / (rackTime.getNano() - time);
+
+        // pipeline, the k-th frame in process is written into output k
+        err    = 0;
+        queued = 0;
+        done   = 0;
+
+        time = rackTime.getNano();
+        while (done < frameNum)
+        {
+            while ((ret = pipeEncoder.getOutput()) != -EAGAIN)
+            {
+                i = done % BENCH_IMAGE_NUM;
+                if ((ret != refLen[i]) ||
+                    (output[done % outNum]->data.recordingTime != (rack_time_t)i) ||
+                    memcmp(output[done % outNum], reference[i], ret))
+                {
+                    err++;
+                }
+                done++;
+            }
+
+            if (done == frameNum)
+            {
+                break;
+            }
+
+            input = pipeEncoder.getInput();
+            if (!input || (queued == frameNum))
+            {
+                // wait for the next compressed frame
+                if (pipeEncoder.waitOutput())
+                {
+                    err++;
+                    break;
+                }
+                continue;
+            }
+
+            memcpy(input, image[queued % BENCH_IMAGE_NUM],
+                   sizeof(camera_data) + width * height * b->bytes);
+            pipeEncoder.queue(output[queued % outNum], sizeof(camera_data_msg));
+            queued++;
+        }
+        fpsPipe = frameNum * 1000000000.0 / (rackTime.getNano() - time);
+
+        printf("%s %6.1f kbyte serial %6.1f fps pipeline %6.1f fps (x%4.1f)%s\n", b->name,
+               refLen[0] / 1024.0, fpsSerial, fpsPipe, fpsPipe / fpsSerial,
+               err || (refLen[0] < 0) ? " ERROR" : "");
+    }
+
+    serialEncoder.cleanup();
+    pipeEncoder.cleanup();
+    if (workerNum > 0)
+    {
+        doneMbx.remove();
+        jobMbx.remove();
+    }
+
+    for (i = 0; i < outNum; i++)
+    {
+        free(output[i]);
+    }
+    for (i = 0; i < BENCH_IMAGE_NUM; i++)
+    {
+        free(reference[i]);
+        free(image[i]);
+    }
+    return 0;
+}
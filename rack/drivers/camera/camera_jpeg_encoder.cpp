@@ -0,0 +1,599 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2006 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Marko Reimer <reimer@l3s.de>
+ *
+ */
+#include "camera_jpeg_encoder.h"
+
+//######################################################################
+//# worker tasks (non realtime context)
+//######################################################################
+
+void camera_jpeg_worker_task_proc(void *arg)
+{
+    camera_jpeg_worker  *p_worker  = (camera_jpeg_worker *)arg;
+    CameraJpegEncoder   *p_encoder = p_worker->p_encoder;
+    RackMessage         msgInfo;
+
+    RackTask::disableRealtimeMode();
+
+    while (1)
+    {
+        // every queued frame sends a job message
+        if (p_encoder->jobMbx->recvMsg(&msgInfo))
+            return;
+        if (msgInfo.getType() == CAMERA_JPEG_MSG_STOP)
+            return;
+
+        if (p_encoder->compressQueued(p_worker->p_compressor))
+            p_encoder->jobMbx->sendMsg(CAMERA_JPEG_MSG_DONE, p_encoder->doneMbx->getAdr(), 0);
+    }
+}
+
+//######################################################################
+//# class CameraJpegEncoder
+//######################################################################
+
+CameraJpegEncoder::CameraJpegEncoder()
+{
+    gdos = NULL;
+
+    quality       = 50;
+    scale         = 1;
+    roiX          = 0;
+    roiY          = 0;
+    roiWidth      = 0;
+    roiHeight     = 0;
+    compressorNum = 0;
+    frameNum      = 0;
+    frameFirst    = 0;
+    frameCount    = 0;
+    workerNum     = 0;
+    jobMbx        = NULL;
+    doneMbx       = NULL;
+    dropInput     = NULL;
+    mtxCreated    = 0;
+}
+
+CameraJpegEncoder::CameraJpegEncoder(RackMailbox *p_mbx, int gdos_level)
+{
+    gdos = new RackGdos(p_mbx, gdos_level);
+
+    quality       = 50;
+    scale         = 1;
+    roiX          = 0;
+    roiY          = 0;
+    roiWidth      = 0;
+    roiHeight     = 0;
+    compressorNum = 0;
+    frameNum      = 0;
+    frameFirst    = 0;
+    frameCount    = 0;
+    workerNum     = 0;
+    jobMbx        = NULL;
+    doneMbx       = NULL;
+    dropInput     = NULL;
+    mtxCreated    = 0;
+}
+
+CameraJpegEncoder::~CameraJpegEncoder()
+{
+    cleanup();
+    if (gdos)
+        delete gdos;
+}
+
+int CameraJpegEncoder::createCompressor(camera_jpeg_compressor *p_compressor)
+{
+    p_compressor->image  = (uint8_t *)malloc(CAMERA_MAX_BYTES);
+    p_compressor->row    = (uint8_t *)malloc(CAMERA_MAX_WIDTH * 3);
+    p_compressor->rowSum = (uint16_t *)malloc(CAMERA_MAX_WIDTH * 3 * sizeof(uint16_t));
+    if (!p_compressor->image || !p_compressor->row || !p_compressor->rowSum)
+    {
+        free(p_compressor->image);
+        free(p_compressor->row);
+        free(p_compressor->rowSum);
+        return -ENOMEM;
+    }
+
+    p_compressor->cinfo.err = jpeg_std_error(&p_compressor->jerr);
+    jpeg_create_compress(&p_compressor->cinfo);
+
+    p_compressor->width      = 0;
+    p_compressor->height     = 0;
+    p_compressor->components = 0;
+    p_compressor->quality    = 0;
+    return 0;
+}
+
+void CameraJpegEncoder::destroyCompressor(camera_jpeg_compressor *p_compressor)
+{
+    jpeg_destroy_compress(&p_compressor->cinfo);
+    free(p_compressor->rowSum);
+    free(p_compressor->row);
+    free(p_compressor->image);
+}
+
+// jobMbx and doneMbx need CAMERA_JPEG_FRAME_NUM_MAX slots for messages without
+// data, doneMbx may be the mailbox of the camera data (see waitOutput)
+int CameraJpegEncoder::init(int workerNum, int prio, RackMailbox *jobMbx,
+                            RackMailbox *doneMbx)
+{
+    char    taskName[30];
+    int     i, ret;
+
+    cleanup();
+
+    if (workerNum < 0)
+        workerNum = 0;
+    if (workerNum > CAMERA_JPEG_WORKER_NUM_MAX)
+        workerNum = CAMERA_JPEG_WORKER_NUM_MAX;
+    if ((workerNum > 0) && (!jobMbx || !doneMbx))
+        return -EINVAL;
+
+    ret = frameMtx.create();
+    if (ret)
+        return ret;
+    mtxCreated = 1;
+
+    // the calling task and every worker have their own compressor
+    for (compressorNum = 0; compressorNum <= workerNum; compressorNum++)
+    {
+        ret = createCompressor(&compressor[compressorNum]);
+        if (ret)
+        {
+            GDOS_ERROR("Can't allocate jpeg compressor %d\n", compressorNum);
+            cleanup();
+            return ret;
+        }
+    }
+
+    // one frame more than workers, it is received while the others are compressed
+    frameNum   = workerNum + 1;
+    frameFirst = 0;
+    frameCount = 0;
+    for (i = 0; i < frameNum; i++)
+    {
+        frame[i].state = CAMERA_JPEG_FRAME_FREE;
+        frame[i].input = (camera_data_msg *)malloc(sizeof(camera_data_msg));
+        if (!frame[i].input)
+        {
+            GDOS_ERROR("Can't allocate jpeg frame %d\n", i);
+            frameNum = i;
+            cleanup();
+            return -ENOMEM;
+        }
+    }
+
+    this->jobMbx  = jobMbx;
+    this->doneMbx = doneMbx;
+    if (workerNum > 0)
+    {
+        jobMbx->clean();
+
+        dropInput = (camera_data_msg *)malloc(sizeof(camera_data_msg));
+        if (!dropInput)
+        {
+            GDOS_ERROR("Can't allocate jpeg drop buffer\n");
+            cleanup();
+            return -ENOMEM;
+        }
+    }
+
+    for (i = 0; i < workerNum; i++)
+    {
+        worker[i].p_encoder    = this;
+        worker[i].p_compressor = &compressor[i + 1];
+
+        snprintf(taskName, sizeof(taskName), "camJpeg%p_%d", (void *)this, i);
+        ret = workerTask[i].create(taskName, 0, prio, RACK_TASK_FPU | RACK_TASK_JOINABLE);
+        if (!ret)
+        {
+            ret = workerTask[i].start(&camera_jpeg_worker_task_proc, &worker[i]);
+            if (ret)
+                workerTask[i].destroy();
+        }
+        if (ret)
+            break;
+    }
+    this->workerNum = i;
+
+    if (this->workerNum < workerNum)
+    {
+        GDOS_WARNING("Can't create all jpeg workers, using %d of %d\n",
+                     this->workerNum, workerNum);
+    }
+    return 0;
+}
+
+void CameraJpegEncoder::cleanup(void)
+{
+    int i;
+
+    for (i = 0; i < workerNum; i++)
+    {
+        doneMbx->sendMsg(CAMERA_JPEG_MSG_STOP, jobMbx->getAdr(), 0);
+    }
+    for (i = 0; i < workerNum; i++)
+    {
+        workerTask[i].join();
+        workerTask[i].destroy();
+    }
+    workerNum = 0;
+
+    free(dropInput);
+    dropInput = NULL;
+
+    for (i = 0; i < frameNum; i++)
+    {
+        free(frame[i].input);
+    }
+    frameNum   = 0;
+    frameFirst = 0;
+    frameCount = 0;
+
+    for (i = 0; i < compressorNum; i++)
+    {
+        destroyCompressor(&compressor[i]);
+    }
+    compressorNum = 0;
+
+    if (mtxCreated)
+    {
+        frameMtx.destroy();
+        mtxCreated = 0;
+    }
+}
+
+// has to be called while no frame is in process
+void CameraJpegEncoder::setParam(int quality, int scale, int roiX, int roiY, int roiWidth,
+                                 int roiHeight)
+{
+    this->quality   = quality;
+    this->scale     = scale < 1 ? 1 : scale;
+    this->roiX      = roiX < 0 ? 0 : roiX;
+    this->roiY      = roiY < 0 ? 0 : roiY;
+    this->roiWidth  = roiWidth < 0 ? 0 : roiWidth;
+    this->roiHeight = roiHeight < 0 ? 0 : roiHeight;
+}
+
+// mean of scale x scale pixels, the rows are added first
+static void downscaleRow(uint8_t *out, uint16_t *sum, uint8_t *in, int stride, int width,
+                         int components, int scale)
+{
+    int x, c, i, n = width * scale * components, num = scale * scale, val;
+
+    for (x = 0; x < n; x++)
+    {
+        sum[x] = in[x];
+    }
+    for (i = 1; i < scale; i++)
+    {
+        in += stride;
+        for (x = 0; x < n; x++)
+        {
+            sum[x] += in[x];
+        }
+    }
+
+    if (scale == 2)
+    {
+        for (x = 0; x < width; x++, sum += 2 * components)
+        {
+            for (c = 0; c < components; c++)
+            {
+                *out++ = (sum[c] + sum[c + components] + 2) >> 2;
+            }
+        }
+        return;
+    }
+
+    for (x = 0; x < width; x++)
+    {
+        for (c = 0; c < components; c++)
+        {
+            val = num / 2;
+            for (i = 0; i < scale; i++)
+            {
+                val += sum[(x * scale + i) * components + c];
+            }
+            *out++ = val / num;
+        }
+    }
+}
+
+// returns the data length of the output or a negative error code
+int CameraJpegEncoder::compressFrame(camera_jpeg_compressor *p_compressor,
+                                     camera_data_msg *input, camera_data_msg *output,
+                                     uint32_t outputLen)
+{
+    j_compress_ptr      cinfo = &p_compressor->cinfo;
+    jpeg_data_dst_ptr   dest;
+    JSAMPROW            rowPointer[CAMERA_JPEG_ROW_NUM];
+    uint8_t             *image;
+    int                 width, height, x, y, w, h, outWidth, outHeight;
+    int                 type = 0, components, stride, i, n;
+
+    width  = input->data.width;
+    height = input->data.height;
+
+    // region of interest
+    x = roiX;
+    y = roiY;
+    w = roiWidth  ? roiWidth  : width;
+    h = roiHeight ? roiHeight : height;
+    if ((x >= width) || (y >= height))
+        return -EINVAL;
+    if (x + w > width)
+        w = width - x;
+    if (y + h > height)
+        h = height - y;
+
+    outWidth  = w / scale;
+    outHeight = h / scale;
+    if ((outWidth < 1) || (outHeight < 1) || (outputLen <= sizeof(camera_data)))
+        return -EINVAL;
+
+    // only the rows of the region of interest are converted
+    image      = p_compressor->image;
+    components = 3;
+
+    switch (input->data.mode)
+    {
+        case CAMERA_MODE_YUV422:
+            type = CAMERA_TOOL_UYVY2BGR;
+            break;
+        case CAMERA_MODE_RGB24:
+            CameraTool::convertCharBGR2RGB(image + y * width * 3,
+                                           input->byteStream + y * width * 3, width, h);
+            break;
+        case CAMERA_MODE_RAW8:
+            type = CAMERA_TOOL_BAYER2RGB;
+            break;
+        case CAMERA_MODE_MONO8:
+            image      = input->byteStream;
+            components = 1;
+            break;
+        case CAMERA_MODE_MONO12:
+            type       = CAMERA_TOOL_MONO122MONO8;
+            components = 1;
+            break;
+        case CAMERA_MODE_MONO16:
+            type       = CAMERA_TOOL_MONO162MONO8;
+            components = 1;
+            break;
+        default:
+            return -EINVAL;
+    }
+
+    if (type)
+    {
+        if (CameraTool::convertRows(type, image, input->byteStream, width, height,
+                                    input->data.colorFilterId, y, y + h))
+        {
+            return -EINVAL;
+        }
+    }
+
+    // the compressor settings are kept for frames of the same size
+    if ((p_compressor->width != outWidth) ||
+        (p_compressor->height != outHeight) ||
+        (p_compressor->components != components) ||
+        (p_compressor->quality != quality))
+    {
+        cinfo->image_width      = outWidth;
+        cinfo->image_height     = outHeight;
+        cinfo->input_components = components;
+        cinfo->in_color_space   = components > 1 ? JCS_RGB : JCS_GRAYSCALE;
+
+        jpeg_set_defaults(cinfo);
+        jpeg_set_quality(cinfo, quality, TRUE /* limit to baseline-JPEG values */);
+
+        p_compressor->width      = outWidth;
+        p_compressor->height     = outHeight;
+        p_compressor->components = components;
+        p_compressor->quality    = quality;
+    }
+
+    // the jpeg is written directly behind the output head
+    jpeg_directmem_dest(cinfo, (char *)output->byteStream, outputLen - sizeof(camera_data));
+    jpeg_start_compress(cinfo, TRUE);
+
+    stride = width * components;
+    image += y * stride + x * components;
+
+    while (cinfo->next_scanline < cinfo->image_height)
+    {
+        if (scale == 1)
+        {
+            n = cinfo->image_height - cinfo->next_scanline;
+            if (n > CAMERA_JPEG_ROW_NUM)
+                n = CAMERA_JPEG_ROW_NUM;
+
+            for (i = 0; i < n; i++)
+            {
+                rowPointer[i] = image + (cinfo->next_scanline + i) * stride;
+            }
+            jpeg_write_scanlines(cinfo, rowPointer, n);
+        }
+        else
+        {
+            downscaleRow(p_compressor->row, p_compressor->rowSum,
+                         image + cinfo->next_scanline * scale * stride, stride, outWidth,
+                         components, scale);
+            rowPointer[0] = p_compressor->row;
+            jpeg_write_scanlines(cinfo, rowPointer, 1);
+        }
+    }
+
+    jpeg_finish_compress(cinfo);
+
+    dest = (jpeg_data_dst_ptr)cinfo->dest;
+    if (dest->overflow)
+    {
+        return -ENOSPC;
+    }
+
+    output->data.recordingTime = input->data.recordingTime;
+    output->data.width         = outWidth;
+    output->data.height        = outHeight;
+    output->data.depth         = components * 8;
+    output->data.mode          = CAMERA_MODE_JPEG;
+    output->data.colorFilterId = dest->outstreamOffset; // used as jpeg length
+
+    return sizeof(camera_data) + dest->outstreamOffset;
+}
+
+// compresses the oldest queued frame, returns 0 if no frame is queued
+int CameraJpegEncoder::compressQueued(camera_jpeg_compressor *p_compressor)
+{
+    camera_jpeg_frame   *p_frame = NULL;
+    int                 i, datalen;
+
+    frameMtx.lock(RACK_INFINITE);
+    for (i = 0; i < frameCount; i++)
+    {
+        camera_jpeg_frame *p = &frame[(frameFirst + i) % frameNum];
+        if (p->state == CAMERA_JPEG_FRAME_QUEUED)
+        {
+            p->state = CAMERA_JPEG_FRAME_BUSY;
+            p_frame  = p;
+            break;
+        }
+    }
+    frameMtx.unlock();
+
+    if (!p_frame)
+        return 0;
+
+    datalen = compressFrame(p_compressor, p_frame->input, p_frame->output,
+                            p_frame->outputLen);
+
+    frameMtx.lock(RACK_INFINITE);
+    p_frame->datalen = datalen;
+    p_frame->state   = CAMERA_JPEG_FRAME_DONE;
+    frameMtx.unlock();
+    return 1;
+}
+
+int CameraJpegEncoder::compress(camera_data_msg *input, camera_data_msg *output,
+                                uint32_t outputLen)
+{
+    if (!compressorNum)
+        return -EINVAL;
+
+    return compressFrame(&compressor[0], input, output, outputLen);
+}
+
+//
+// pipeline
+//
+
+// input buffer of the next frame, NULL if all frames are in process
+camera_data_msg* CameraJpegEncoder::getInput(void)
+{
+    if (frameCount >= frameNum)
+        return NULL;
+
+    return frame[(frameFirst + frameCount) % frameNum].input;
+}
+
+// queues the frame of getInput(), the jpeg is written into the output
+int CameraJpegEncoder::queue(camera_data_msg *output, uint32_t outputLen)
+{
+    camera_jpeg_frame *p_frame;
+
+    if (frameCount >= frameNum)
+        return -EBUSY;
+
+    p_frame            = &frame[(frameFirst + frameCount) % frameNum];
+    p_frame->output    = output;
+    p_frame->outputLen = outputLen;
+
+    // without workers the calling task compresses the frame
+    if (!workerNum)
+    {
+        p_frame->datalen = compressFrame(&compressor[0], p_frame->input, output, outputLen);
+        p_frame->state   = CAMERA_JPEG_FRAME_DONE;
+        frameCount++;
+        return 0;
+    }
+
+    frameMtx.lock(RACK_INFINITE);
+    p_frame->state = CAMERA_JPEG_FRAME_QUEUED;
+    frameCount++;
+    frameMtx.unlock();
+
+    // every queued frame needs a job message, else the calling task compresses one
+    if (doneMbx->sendMsg(CAMERA_JPEG_MSG_JOB, jobMbx->getAdr(), 0))
+    {
+        compressQueued(&compressor[0]);
+    }
+    return 0;
+}
+
+// data length of the oldest frame (in order of queue()) or a negative error
+// code of its compression, -EAGAIN if it is still in process
+int CameraJpegEncoder::getOutput(void)
+{
+    camera_jpeg_frame *p_frame;
+    int               datalen;
+
+    if (!frameCount)
+        return -EAGAIN;
+
+    p_frame = &frame[frameFirst];
+    if (p_frame->state != CAMERA_JPEG_FRAME_DONE)
+        return -EAGAIN;
+
+    datalen = p_frame->datalen;
+
+    frameMtx.lock(RACK_INFINITE);
+    p_frame->state = CAMERA_JPEG_FRAME_FREE;
+    frameFirst     = (frameFirst + 1) % frameNum;
+    frameCount--;
+    frameMtx.unlock();
+
+    return datalen;
+}
+
+// waits for the next message in the done mailbox, other messages (e.g. camera
+// data) are dropped
+int CameraJpegEncoder::waitOutput(void)
+{
+    RackMessage msgInfo;
+
+    if (!workerNum)
+        return -EINVAL;
+
+    return doneMbx->recvDataMsg(dropInput, sizeof(camera_data_msg), &msgInfo);
+}
+
+// waits for the frames in process and drops them
+void CameraJpegEncoder::flush(void)
+{
+    int ret;
+
+    while (frameCount)
+    {
+        if (getOutput() != -EAGAIN)
+            continue;
+
+        ret = waitOutput();
+        if (ret)
+        {
+            GDOS_ERROR("Can't wait for the jpeg workers, code = %d\n", ret);
+            return;
+        }
+    }
+}
@@ -0,0 +1,151 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2006 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Marko Reimer <reimer@l3s.de>
+ *
+ */
+#ifndef __CAMERA_JPEG_ENCODER_H__
+#define __CAMERA_JPEG_ENCODER_H__
+
+#include <main/rack_gdos.h>
+#include <main/rack_mailbox.h>
+#include <main/rack_mutex.h>
+#include <main/rack_task.h>
+#include <main/camera_tool.h>
+#include <drivers/camera_proxy.h>
+
+#include <main/jpeg_tool.h>
+
+#define CAMERA_JPEG_WORKER_NUM_MAX      8
+#define CAMERA_JPEG_FRAME_NUM_MAX       (CAMERA_JPEG_WORKER_NUM_MAX + 1)
+#define CAMERA_JPEG_ROW_NUM             16              // rows per jpeg_write_scanlines
+
+#define CAMERA_JPEG_FRAME_FREE          0
+#define CAMERA_JPEG_FRAME_QUEUED        1               // waits for a worker
+#define CAMERA_JPEG_FRAME_BUSY          2               // compression in progress
+#define CAMERA_JPEG_FRAME_DONE          3               // waits for the output
+
+#define CAMERA_JPEG_MSG_JOB             1               // frame queued for the workers
+#define CAMERA_JPEG_MSG_STOP            2               // terminates a worker
+#define CAMERA_JPEG_MSG_DONE            3               // frame compressed by a worker
+
+//
+// libjpeg compressor, the settings are kept as long as the image size
+// doesn't change
+//
+typedef struct {
+    struct jpeg_compress_struct cinfo;
+    struct jpeg_error_mgr       jerr;
+    uint8_t                     *image;         // converted camera image
+    uint8_t                     *row;           // downscaled row
+    uint16_t                    *rowSum;        // sum of the rows of a downscaled row
+    int                         width;          // settings of cinfo
+    int                         height;
+    int                         components;
+    int                         quality;
+} camera_jpeg_compressor;
+
+typedef struct {
+    volatile int                state;
+    camera_data_msg             *input;
+    camera_data_msg             *output;        // e.g. data buffer entry
+    uint32_t                    outputLen;
+    int                         datalen;        // negative error code on failure
+} camera_jpeg_frame;
+
+class CameraJpegEncoder;
+
+typedef struct {
+    CameraJpegEncoder           *p_encoder;
+    camera_jpeg_compressor      *p_compressor;
+} camera_jpeg_worker;
+
+/**
+ * Jpeg compression of camera images with optional region of interest and
+ * downscaling. The frames are converted and compressed by the calling task
+ * or in a pipeline by worker tasks, the output of the pipeline keeps the
+ * order of the input. The workers wait in a job mailbox for the queued frames
+ * and send a done message per compressed frame.
+ *
+ * @ingroup modules_camera
+ */
+class CameraJpegEncoder
+{
+    private:
+        RackGdos                *gdos;
+
+        int                     quality;
+        int                     scale;
+        int                     roiX;
+        int                     roiY;
+        int                     roiWidth;
+        int                     roiHeight;
+
+        // compressor 0 is used by the calling task
+        camera_jpeg_compressor  compressor[CAMERA_JPEG_WORKER_NUM_MAX + 1];
+        int                     compressorNum;
+
+        camera_jpeg_frame       frame[CAMERA_JPEG_FRAME_NUM_MAX];
+        int                     frameNum;
+        int                     frameFirst;         // oldest frame in process
+        int                     frameCount;         // frames in process
+        RackMutex               frameMtx;
+
+        camera_jpeg_worker      worker[CAMERA_JPEG_WORKER_NUM_MAX];
+        RackTask                workerTask[CAMERA_JPEG_WORKER_NUM_MAX];
+        RackMailbox             *jobMbx;
+        RackMailbox             *doneMbx;
+        camera_data_msg         *dropInput;         // camera data in doneMbx (see waitOutput)
+        int                     workerNum;
+        int                     mtxCreated;
+
+        int   createCompressor(camera_jpeg_compressor *p_compressor);
+        void  destroyCompressor(camera_jpeg_compressor *p_compressor);
+        int   compressFrame(camera_jpeg_compressor *p_compressor, camera_data_msg *input,
+                            camera_data_msg *output, uint32_t outputLen);
+        int   compressQueued(camera_jpeg_compressor *p_compressor);
+
+        friend void camera_jpeg_worker_task_proc(void *arg);
+
+    public:
+        CameraJpegEncoder();
+        CameraJpegEncoder(RackMailbox *p_mbx, int gdos_level);
+        ~CameraJpegEncoder();
+
+        int   init(int workerNum, int prio, RackMailbox *jobMbx, RackMailbox *doneMbx);
+        void  cleanup(void);
+
+        void  setParam(int quality, int scale, int roiX, int roiY, int roiWidth,
+                       int roiHeight);
+
+        // compression by the calling task, returns the data length of the output
+        int   compress(camera_data_msg *input, camera_data_msg *output, uint32_t outputLen);
+
+        // pipeline of the worker tasks
+        camera_data_msg* getInput(void);
+        int   queue(camera_data_msg *output, uint32_t outputLen);
+        int   getOutput(void);
+        int   waitOutput(void);
+        void  flush(void);
+
+        int   getFrameCount(void)
+        {
+            return frameCount;
+        }
+
+        int   getFrameNum(void)
+        {
+            return frameNum;
+        }
+};
+
+#endif // __CAMERA_JPEG_ENCODER_H__
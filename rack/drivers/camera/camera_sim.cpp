@@ -0,0 +1,805 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2006 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Marko Reimer <reimer@l3s.de>
+ *
+ */
+
+#include "camera_sim.h"
+
+#include <main/argopts.h>
+
+#include <dirent.h>
+#include <strings.h>
+
+// init_flags
+#define INIT_BIT_DATA_MODULE 0
+
+//
+// data structures
+//
+
+CameraSim *p_inst;
+
+arg_table_t argTab[] = {
+
+    { ARGOPT_OPT, "width", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Image width of the pattern and raw files, default 640", { 640 } },
+
+    { ARGOPT_OPT, "height", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Image height of the pattern and raw files, default 480", { 480 } },
+
+    { ARGOPT_OPT, "mode", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Camera mode of the pattern and raw files, default YUV422 (21)", { CAMERA_MODE_YUV422 } },
+
+    { ARGOPT_OPT, "colorFilterId", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Color filter of the raw modes, default RGGB (512)", { COLORFILTER_RGGB } },
+
+    { ARGOPT_OPT, "imageDir", ARGOPT_REQVAL, ARGOPT_VAL_STR,
+      "Directory of *.raw and *.jpg files, default pattern", { 0 } },
+
+    { ARGOPT_OPT, "imageNum", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Maximum number of images in memory, default 16", { 16 } },
+
+    { ARGOPT_OPT, "quality", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Jpeg quality of the pattern, default 75", { 75 } },
+
+    { ARGOPT_OPT, "fps", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Frames per second, 0 = maximum, default 25", { 25 } },
+
+    { 0, "", 0, 0, "", { 0 } } // last entry
+};
+
+/*******************************************************************************
+ *   !!! REALTIME CONTEXT !!!
+ *
+ *   moduleOn,
+ *   moduleOff,
+ *   moduleLoop,
+ *   moduleCommand,
+ *
+ *   own realtime user functions
+ ******************************************************************************/
+
+ int CameraSim::moduleOn(void)
+{
+    int ret;
+
+    // get dynamic module parameter
+    fps = getInt32Param("fps");
+    if (fps < 0)
+    {
+        GDOS_ERROR("Invalid frame rate %d\n", fps);
+        return -EINVAL;
+    }
+
+    // the images are loaded once and kept until the format changes
+    if (imageNum == 0)
+    {
+        RackTask::disableRealtimeMode();
+        ret = loadImages();
+        RackTask::enableRealtimeMode();
+        if (ret)
+        {
+            freeImages();
+            return ret;
+        }
+        GDOS_PRINT("Loaded %d images\n", imageNum);
+    }
+
+    if (fps > 0)
+    {
+        periodTime           = 1000000000llu / fps;
+        dataBufferPeriodTime = fps < 1000 ? 1000 / fps : 1;
+    }
+    else
+    {
+        periodTime           = 0;
+        dataBufferPeriodTime = 1;
+    }
+
+    imageIndex   = 0;
+    nextTime     = rackTime.getNano();
+    timeCount1s  = rackTime.get();
+    frameCount1s = 0;
+
+    return RackDataModule::moduleOn();  // has to be last command in moduleOn();
+}
+
+void CameraSim::moduleOff(void)
+{
+    RackDataModule::moduleOff();        // has to be first command in moduleOff();
+}
+
+int CameraSim::moduleLoop(void)
+{
+    camera_data_msg *p_data;
+    rack_time_t     time;
+    uint64_t        timeNano;
+
+    // get datapointer from databuffer
+    p_data = (camera_data_msg *)getDataBufferWorkSpace();
+
+    memcpy(p_data, image[imageIndex], imageLen[imageIndex]);
+    p_data->data.recordingTime = rackTime.get();
+
+    GDOS_DBG_DETAIL("Data recordingtime %i width %i height %i depth %i mode %i\n",
+                    p_data->data.recordingTime, p_data->data.width, p_data->data.height,
+                    p_data->data.depth, p_data->data.mode);
+
+    putDataBufferWorkSpace(imageLen[imageIndex]);
+
+    imageIndex = (imageIndex + 1) % imageNum;
+
+    frameCount1s++;
+    time = rackTime.get();
+    if (time - timeCount1s >= 1000)
+    {
+        GDOS_DBG_INFO("%d frames/s\n", frameCount1s * 1000 / (int)(time - timeCount1s));
+        timeCount1s  = time;
+        frameCount1s = 0;
+    }
+
+    // a late frame doesn't shorten the following periods
+    if (periodTime)
+    {
+        nextTime += periodTime;
+        timeNano  = rackTime.getNano();
+
+        if (nextTime > timeNano)
+        {
+            RackTask::sleep(nextTime - timeNano);
+        }
+        else if (timeNano - nextTime > periodTime)
+        {
+            nextTime = timeNano;
+        }
+    }
+
+    return 0;
+}
+
+int CameraSim::moduleCommand(RackMessage *msgInfo)
+{
+    camera_format_data  *p_format;
+    camera_param_data   param;
+
+    switch (msgInfo->getType())
+    {
+    case MSG_CAMERA_GET_PARAMETER:
+        // ideal pinhole camera with the image center as principal point
+        memset(&param, 0, sizeof(param));
+        param.calibration_width     = width;
+        param.calibration_height    = height;
+        param.fx                    = width;
+        param.fy                    = width;
+        param.sx                    = 1.0f;
+        param.sy                    = 1.0f;
+        param.e0                    = width / 2;
+        param.n0                    = height / 2;
+        param.coordinateRotation[0] = 1.0f;
+        param.coordinateRotation[4] = 1.0f;
+        param.coordinateRotation[8] = 1.0f;
+
+        cmdMbx.sendDataMsgReply(MSG_CAMERA_PARAMETER, msgInfo, 1, &param,
+                                sizeof(camera_param_data));
+        break;
+
+    case MSG_CAMERA_SET_FORMAT:
+        if (status == MODULE_STATE_DISABLED)
+        {
+            p_format = CameraFormatData::parse(msgInfo);
+
+            GDOS_DBG_INFO("set format width=%i height=%i mode=%i\n",
+                          p_format->width, p_format->height, p_format->mode);
+
+            if (((p_format->mode >= 0) && !getDepth(p_format->mode)) ||
+                (p_format->width > CAMERA_MAX_WIDTH) ||
+                (p_format->height > CAMERA_MAX_HEIGHT))
+            {
+                GDOS_WARNING("Invalid camera format\n");
+                cmdMbx.sendMsgReply(MSG_ERROR, msgInfo);
+                break;
+            }
+
+            if (p_format->width > 0)
+                width  = p_format->width;
+            if (p_format->height > 0)
+                height = p_format->height;
+            if (p_format->mode >= 0)
+                mode   = p_format->mode;
+
+            // the images are loaded again by moduleOn
+            freeImages();
+
+            cmdMbx.sendMsgReply(MSG_OK, msgInfo);
+        }
+        else
+        {
+            GDOS_WARNING("Camera needs to be turned off to set format\n");
+            cmdMbx.sendMsgReply(MSG_ERROR, msgInfo);
+        }
+        break;
+
+    default:
+        // not for me -> ask RackDataModule
+        return RackDataModule::moduleCommand(msgInfo);
+    }
+    return 0;
+}
+
+/*******************************************************************************
+ *   !!! NON REALTIME CONTEXT !!!
+ *
+ *   moduleInit,
+ *   moduleCleanup,
+ *   Constructor,
+ *   Destructor,
+ *   main,
+ *
+ *   own non realtime user functions
+ ******************************************************************************/
+
+// bits per pixel of the image data, 0 for unknown modes
+int CameraSim::getDepth(int mode)
+{
+    switch (mode)
+    {
+        case CAMERA_MODE_MONO8:
+        case CAMERA_MODE_RAW8:
+        case CAMERA_MODE_DISPARITY:
+            return 8;
+
+        case CAMERA_MODE_MONO12:
+        case CAMERA_MODE_MONO16:
+        case CAMERA_MODE_RGB565:
+        case CAMERA_MODE_YUV422:
+        case CAMERA_MODE_RAW12:
+        case CAMERA_MODE_RAW16:
+        case CAMERA_MODE_RANGE:
+        case CAMERA_MODE_INTENSITY:
+        case CAMERA_MODE_TYPE_INTENSITY:
+        case CAMERA_MODE_RANGE_TYPE:
+        case CAMERA_MODE_SEGMENT:
+        case CAMERA_MODE_ELEVATION:
+        case CAMERA_MODE_TYPE:
+        case CAMERA_MODE_EDGE:
+            return 16;
+
+        case CAMERA_MODE_MONO24:
+        case CAMERA_MODE_RGB24:
+        case CAMERA_MODE_JPEG:
+            return 24;
+
+        default:
+            return 0;
+    }
+}
+
+int CameraSim::addImage(camera_data *head, uint8_t *data, int len)
+{
+    camera_data *p_image;
+
+    p_image = (camera_data *)malloc(sizeof(camera_data) + len);
+    if (!p_image)
+    {
+        GDOS_ERROR("Can't allocate image %d\n", imageNum);
+        return -ENOMEM;
+    }
+
+    memcpy(p_image, head, sizeof(camera_data));
+    memcpy(p_image->byteStream, data, len);
+
+    image[imageNum]    = p_image;
+    imageLen[imageNum] = sizeof(camera_data) + len;
+    imageNum++;
+
+    return 0;
+}
+
+void CameraSim::freeImages(void)
+{
+    int i;
+
+    for (i = 0; i < imageNum; i++)
+    {
+        free(image[i]);
+        image[i] = NULL;
+    }
+    imageNum = 0;
+}
+
+int CameraSim::readFile(const char *filename, uint8_t *buffer, int bufferLen)
+{
+    FILE    *fp;
+    int     len;
+
+    fp = fopen(filename, "r");
+    if (!fp)
+    {
+        GDOS_WARNING("Can't open image file %s\n", filename);
+        return -EIO;
+    }
+
+    // one byte more to detect files which are too large
+    len = fread(buffer, 1, bufferLen + 1, fp);
+    fclose(fp);
+
+    if (len > bufferLen)
+    {
+        GDOS_WARNING("Image file %s is too large\n", filename);
+        return -EFBIG;
+    }
+    return len;
+}
+
+// reads the image size from the start of frame segment
+int CameraSim::parseJpegHead(uint8_t *jpeg, int len, camera_data *head)
+{
+    int i, marker, segmentLen;
+
+    if ((len < 4) || (jpeg[0] != 0xff) || (jpeg[1] != 0xd8))
+    {
+        return -EINVAL;
+    }
+
+    i = 2;
+    while (i + 9 < len)
+    {
+        if (jpeg[i] != 0xff)
+        {
+            return -EINVAL;
+        }
+
+        marker     = jpeg[i + 1];
+        segmentLen = (jpeg[i + 2] << 8) | jpeg[i + 3];
+
+        // SOF0 - SOF15 without DHT, JPG and DAC
+        if ((marker >= 0xc0) && (marker <= 0xcf) &&
+            (marker != 0xc4) && (marker != 0xc8) && (marker != 0xcc))
+        {
+            head->height        = (jpeg[i + 5] << 8) | jpeg[i + 6];
+            head->width         = (jpeg[i + 7] << 8) | jpeg[i + 8];
+            head->depth         = jpeg[i + 9] * 8;
+            head->mode          = CAMERA_MODE_JPEG;
+            head->colorFilterId = len; // used as jpeg length
+            return 0;
+        }
+
+        i += 2 + segmentLen;
+    }
+    return -EINVAL;
+}
+
+int CameraSim::loadImages(void)
+{
+    struct dirent   **nameList;
+    camera_data     head;
+    uint8_t         *buffer;
+    char            filename[512];
+    const char      *suffix;
+    int             depth, rawLen, len, fileNum, i, ret;
+
+    depth = getDepth(mode);
+    if (!depth || (width <= 0) || (height <= 0) ||
+        (width > CAMERA_MAX_WIDTH) || (height > CAMERA_MAX_HEIGHT))
+    {
+        GDOS_ERROR("Invalid camera format, width %d height %d mode %d\n",
+                   width, height, mode);
+        return -EINVAL;
+    }
+
+    head.recordingTime = 0;
+    head.width         = width;
+    head.height        = height;
+    head.depth         = depth;
+    head.mode          = mode;
+    head.colorFilterId = 0;
+    if ((mode == CAMERA_MODE_RAW8) || (mode == CAMERA_MODE_RAW12) ||
+        (mode == CAMERA_MODE_RAW16))
+    {
+        head.colorFilterId = colorFilterId;
+    }
+
+    rawLen = width * height * depth / 8;
+
+    buffer = (uint8_t *)malloc(CAMERA_MAX_BYTES);
+    if (!buffer)
+    {
+        GDOS_ERROR("Can't allocate image buffer\n");
+        return -ENOMEM;
+    }
+
+    ret = 0;
+
+    // generated pattern
+    if (!imageDir || !imageDir[0])
+    {
+        for (i = 0; i < imageNumMax; i++)
+        {
+            len = createPattern(i, buffer);
+            if (len < 0)
+            {
+                ret = len;
+                break;
+            }
+
+            if (mode == CAMERA_MODE_JPEG)
+            {
+                head.colorFilterId = len; // used as jpeg length
+            }
+
+            ret = addImage(&head, buffer, len);
+            if (ret)
+                break;
+        }
+
+        free(buffer);
+        return ret;
+    }
+
+    // raw and jpeg files in alphabetical order
+    fileNum = scandir(imageDir, &nameList, NULL, alphasort);
+    if (fileNum < 0)
+    {
+        GDOS_ERROR("Can't read image directory %s\n", imageDir);
+        free(buffer);
+        return -ENOENT;
+    }
+
+    for (i = 0; i < fileNum; i++)
+    {
+        suffix = strrchr(nameList[i]->d_name, '.');
+
+        if (!ret && suffix && (imageNum < imageNumMax))
+        {
+            snprintf(filename, sizeof(filename), "%s/%s", imageDir, nameList[i]->d_name);
+
+            if (!strcasecmp(suffix, ".raw") && (mode != CAMERA_MODE_JPEG))
+            {
+                len = readFile(filename, buffer, rawLen);
+                if (len == rawLen)
+                {
+                    ret = addImage(&head, buffer, len);
+                }
+                else if (len >= 0)
+                {
+                    GDOS_WARNING("Image file %s has %d bytes instead of %d\n",
+                                 filename, len, rawLen);
+                }
+            }
+            else if (!strcasecmp(suffix, ".jpg") || !strcasecmp(suffix, ".jpeg"))
+            {
+                camera_data jpegHead;
+
+                len = readFile(filename, buffer, CAMERA_MAX_BYTES);
+                if (len >= 0)
+                {
+                    jpegHead.recordingTime = 0;
+                    if (parseJpegHead(buffer, len, &jpegHead) ||
+                        (jpegHead.width > CAMERA_MAX_WIDTH) ||
+                        (jpegHead.height > CAMERA_MAX_HEIGHT))
+                    {
+                        GDOS_WARNING("Invalid jpeg file %s\n", filename);
+                    }
+                    else
+                    {
+                        ret = addImage(&jpegHead, buffer, len);
+                    }
+                }
+            }
+        }
+        free(nameList[i]);
+    }
+    free(nameList);
+    free(buffer);
+
+    if (!ret && (imageNum == 0))
+    {
+        GDOS_ERROR("No images in %s\n", imageDir);
+        ret = -ENOENT;
+    }
+    return ret;
+}
+
+// moving colour gradients with edges, converted into the camera mode
+int CameraSim::createPattern(int n, uint8_t *buffer)
+{
+    uint8_t     *rgb = NULL;
+    uint8_t     *p;
+    int         x, y, xs, r, g, b, c, gray, val, len;
+    int         bayerX, bayerY;
+
+    if (mode == CAMERA_MODE_JPEG)
+    {
+        rgb = (uint8_t *)malloc(width * height * 3);
+        if (!rgb)
+        {
+            GDOS_ERROR("Can't allocate pattern buffer\n");
+            return -ENOMEM;
+        }
+    }
+
+    // bayer position of the red pixel
+    switch (colorFilterId)
+    {
+        case COLORFILTER_GBRG:
+            bayerX = 0;
+            bayerY = 1;
+            break;
+        case COLORFILTER_GRBG:
+            bayerX = 1;
+            bayerY = 0;
+            break;
+        case COLORFILTER_BGGR:
+            bayerX = 1;
+            bayerY = 1;
+            break;
+        default:
+            bayerX = 0;
+            bayerY = 0;
+            break;
+    }
+
+    p = buffer;
+    for (y = 0; y < height; y++)
+    {
+        for (x = 0; x < width; x++)
+        {
+            xs = (x + n * 16) % width;
+
+            r = xs * 255 / width;
+            g = y * 255 / height;
+            b = 255 - r;
+            if (((xs / 64) + (y / 64)) & 1)
+            {
+                r = 255 - r;
+                g = 255 - g;
+                b = 255 - b;
+            }
+            gray = (r * 77 + g * 150 + b * 29) >> 8;
+
+            switch (mode)
+            {
+                case CAMERA_MODE_MONO8:
+                case CAMERA_MODE_DISPARITY:
+                    *p++ = gray;
+                    break;
+
+                // 16 bit values in big endian, 12 bit values with a 4 bit pattern
+                case CAMERA_MODE_MONO12:
+                case CAMERA_MODE_MONO16:
+                case CAMERA_MODE_RANGE:
+                case CAMERA_MODE_INTENSITY:
+                case CAMERA_MODE_TYPE_INTENSITY:
+                case CAMERA_MODE_RANGE_TYPE:
+                case CAMERA_MODE_SEGMENT:
+                case CAMERA_MODE_ELEVATION:
+                case CAMERA_MODE_TYPE:
+                case CAMERA_MODE_EDGE:
+                    val  = mode == CAMERA_MODE_MONO12 ? (gray << 4) | (x & 0x0f) :
+                                                        (gray << 8) | (x & 0xff);
+                    *p++ = val >> 8;
+                    *p++ = val;
+                    break;
+
+                case CAMERA_MODE_MONO24:
+                    *p++ = gray;
+                    *p++ = y & 0xff;
+                    *p++ = x & 0xff;
+                    break;
+
+                // the bytes are in bgr order
+                case CAMERA_MODE_RGB24:
+                    *p++ = b;
+                    *p++ = g;
+                    *p++ = r;
+                    break;
+
+                case CAMERA_MODE_RGB565:
+                    val  = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+                    *p++ = val;
+                    *p++ = val >> 8;
+                    break;
+
+                // uyvy, u of the even and v of the odd pixel
+                case CAMERA_MODE_YUV422:
+                    if (!(x & 1))
+                        *p++ = ((-43 * r - 85 * g + 128 * b) >> 8) + 128;
+                    else
+                        *p++ = ((128 * r - 107 * g - 21 * b) >> 8) + 128;
+                    *p++ = gray;
+                    break;
+
+                case CAMERA_MODE_RAW8:
+                case CAMERA_MODE_RAW12:
+                case CAMERA_MODE_RAW16:
+                    if (((x & 1) == bayerX) && ((y & 1) == bayerY))
+                        c = r;
+                    else if (((x & 1) != bayerX) && ((y & 1) != bayerY))
+                        c = b;
+                    else
+                        c = g;
+
+                    if (mode == CAMERA_MODE_RAW8)
+                    {
+                        *p++ = c;
+                    }
+                    else
+                    {
+                        val  = mode == CAMERA_MODE_RAW12 ? c << 4 : c << 8;
+                        *p++ = val >> 8;
+                        *p++ = val;
+                    }
+                    break;
+
+                case CAMERA_MODE_JPEG:
+                    rgb[(y * width + x) * 3]     = r;
+                    rgb[(y * width + x) * 3 + 1] = g;
+                    rgb[(y * width + x) * 3 + 2] = b;
+                    break;
+            }
+        }
+    }
+
+    if (mode == CAMERA_MODE_JPEG)
+    {
+        len = compressPattern(rgb, buffer, CAMERA_MAX_BYTES);
+        free(rgb);
+        return len;
+    }
+
+    return p - buffer;
+}
+
+int CameraSim::compressPattern(uint8_t *rgb, uint8_t *buffer, int bufferLen)
+{
+    struct jpeg_compress_struct cinfo;
+    struct jpeg_error_mgr       jerr;
+    jpeg_data_dst_ptr           dest;
+    JSAMPROW                    rowPointer[1];
+    int                         len;
+
+    cinfo.err = jpeg_std_error(&jerr);
+    jpeg_create_compress(&cinfo);
+
+    cinfo.image_width      = width;
+    cinfo.image_height     = height;
+    cinfo.input_components = 3;
+    cinfo.in_color_space   = JCS_RGB;
+
+    jpeg_set_defaults(&cinfo);
+    jpeg_set_quality(&cinfo, quality, TRUE /* limit to baseline-JPEG values */);
+
+    jpeg_directmem_dest(&cinfo, (char *)buffer, bufferLen);
+    jpeg_start_compress(&cinfo, TRUE);
+
+    while (cinfo.next_scanline < cinfo.image_height)
+    {
+        rowPointer[0] = rgb + cinfo.next_scanline * width * 3;
+        jpeg_write_scanlines(&cinfo, rowPointer, 1);
+    }
+
+    jpeg_finish_compress(&cinfo);
+
+    dest = (jpeg_data_dst_ptr)cinfo.dest;
+    len  = dest->overflow ? -ENOSPC : dest->outstreamOffset;
+
+    jpeg_destroy_compress(&cinfo);
+
+    if (len < 0)
+    {
+        GDOS_ERROR("Can't compress pattern\n");
+    }
+    return len;
+}
+
+int CameraSim::moduleInit(void)
+{
+    int ret;
+
+    // call RackDataModule init function (first command in init)
+    ret = RackDataModule::moduleInit();
+    if (ret)
+    {
+        return ret;
+    }
+    initBits.setBit(INIT_BIT_DATA_MODULE);
+
+    return 0;
+}
+
+void CameraSim::moduleCleanup(void)
+{
+    // call RackDataModule cleanup function
+    if (initBits.testAndClearBit(INIT_BIT_DATA_MODULE))
+    {
+        RackDataModule::moduleCleanup();
+    }
+
+    freeImages();
+}
+
+CameraSim::CameraSim()
+        : RackDataModule( MODULE_CLASS_ID,
+                      5000000000llu,        // 5s datatask error sleep time
+                      16,                   // command mailbox slots
+                      48,                   // command mailbox data size per slot
+                      MBX_IN_KERNELSPACE | MBX_SLOT, // command mailbox flags
+                      10,                   // max buffer entries
+                      10)                   // data buffer listener
+{
+    int i;
+
+    // get static module parameter
+    width           = getIntArg("width", argTab);
+    height          = getIntArg("height", argTab);
+    mode            = getIntArg("mode", argTab);
+    colorFilterId   = getIntArg("colorFilterId", argTab);
+    imageDir        = getStrArg("imageDir", argTab);
+    imageNumMax     = getIntArg("imageNum", argTab);
+    quality         = getIntArg("quality", argTab);
+
+    if (imageNumMax < 1)
+    {
+        imageNumMax = 1;
+    }
+    if (imageNumMax > CAMERA_SIM_IMAGE_NUM_MAX)
+    {
+        imageNumMax = CAMERA_SIM_IMAGE_NUM_MAX;
+    }
+
+    for (i = 0; i < CAMERA_SIM_IMAGE_NUM_MAX; i++)
+    {
+        image[i]    = NULL;
+        imageLen[i] = 0;
+    }
+    imageNum    = 0;
+    imageIndex  = 0;
+
+    dataBufferMaxDataSize   = sizeof(camera_data_msg);
+    dataBufferPeriodTime    = 40;
+}
+
+int main(int argc, char *argv[])
+{
+    int ret;
+
+    // get args
+    ret = RackModule::getArgs(argc, argv, argTab, "CameraSim");
+    if (ret)
+    {
+        printf("Invalid arguments -> EXIT \n");
+        return ret;
+    }
+
+    // create new CameraSim
+    p_inst = new CameraSim();
+    if (!p_inst)
+    {
+        printf("Can't create new CameraSim -> EXIT\n");
+        return -ENOMEM;
+    }
+
+    // init
+    ret = p_inst->moduleInit();
+    if (ret)
+        goto exit_error;
+
+    p_inst->run();
+
+    return 0;
+
+exit_error:
+    delete (p_inst);
+    return ret;
+}
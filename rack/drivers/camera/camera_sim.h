@@ -0,0 +1,94 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2006 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Marko Reimer <reimer@l3s.de>
+ *
+ */
+#ifndef __CAMERA_SIM_H__
+#define __CAMERA_SIM_H__
+
+#include <main/rack_data_module.h>
+#include <drivers/camera_proxy.h>
+
+#include <main/jpeg_tool.h>
+
+// define module class
+#define MODULE_CLASS_ID     CAMERA
+
+#define CAMERA_SIM_IMAGE_NUM_MAX    256
+
+/**
+ * Camera simulation for benchmarks of the image processing. The images
+ * are loaded from a directory of raw and jpeg files or are generated as a
+ * moving pattern. All images are kept in memory and are sent in a loop at
+ * the given frame rate.
+ *
+ * @ingroup modules_camera
+ */
+class CameraSim : public RackDataModule {
+  private:
+
+    // static parameter
+    int         width;
+    int         height;
+    int         mode;
+    int         colorFilterId;
+    int         imageNumMax;
+    int         quality;
+    char        *imageDir;
+
+    // dynamic parameter
+    int         fps;
+
+    // images in memory, the head and the data of an image are allocated at once
+    camera_data *image[CAMERA_SIM_IMAGE_NUM_MAX];
+    int         imageLen[CAMERA_SIM_IMAGE_NUM_MAX];
+    int         imageNum;
+    int         imageIndex;
+
+    uint64_t    periodTime;         // [ns] 0 for the maximum frame rate
+    uint64_t    nextTime;
+    rack_time_t timeCount1s;
+    int         frameCount1s;
+
+    int         addImage(camera_data *head, uint8_t *data, int len);
+    int         loadImages(void);
+    int         readFile(const char *filename, uint8_t *buffer, int bufferLen);
+    int         parseJpegHead(uint8_t *jpeg, int len, camera_data *head);
+    int         createPattern(int n, uint8_t *buffer);
+    int         compressPattern(uint8_t *rgb, uint8_t *buffer, int bufferLen);
+    void        freeImages(void);
+
+  protected:
+
+    // -> realtime context
+    int  moduleOn(void);
+    void moduleOff(void);
+    int  moduleLoop(void);
+    int  moduleCommand(RackMessage *msgInfo);
+
+    // -> non realtime context
+    void moduleCleanup(void);
+
+  public:
+
+    // constructor und destructor
+    CameraSim();
+    ~CameraSim() {};
+
+    static int getDepth(int mode);
+
+    // -> non realtime context
+    int  moduleInit(void);
+};
+
+#endif // __CAMERA_SIM_H__
@@ -116,6 +116,11 @@ class CameraData
 
             camera_data *p_data = (camera_data *)msgInfo->p_data;
 
+            if (msgInfo->isDataByteorderCpu()) // data in cpu byteorder
+            {
+                return p_data;
+            }
+
             if (msgInfo->isDataByteorderLe()) // data in little endian
             {
                 le_to_cpu(p_data);
@@ -226,6 +231,11 @@ class CameraParamData
 
             camera_param_data *p_data = (camera_param_data *)msgInfo->p_data;
 
+            if (msgInfo->isDataByteorderCpu()) // data in cpu byteorder
+            {
+                return p_data;
+            }
+
             if (msgInfo->isDataByteorderLe()) // data in little endian
             {
                 le_to_cpu(p_data);
@@ -283,6 +293,11 @@ class CameraFormatData
 
             camera_format_data *p_data = (camera_format_data *)msgInfo->p_data;
 
+            if (msgInfo->isDataByteorderCpu()) // data in cpu byteorder
+            {
+                return p_data;
+            }
+
             if (msgInfo->isDataByteorderLe()) // data in little endian
             {
                 le_to_cpu(p_data);
@@ -137,6 +137,46 @@ const struct rtser_config pioneer_serial_config = {
     event_mask        : RTSER_EVENT_RXPEND
 };
 
+const uint8_t sipSync[] = {0xFA, 0xFB};
+
+// SIP: sync, byte count of the command, data and checksum
+static int sipFrameLen(const uint8_t *data, int dataLen)
+{
+    if (dataLen < 3)
+    {
+        return 0;
+    }
+    if (data[2] < 2)
+    {
+        return -1;
+    }
+    return 3 + data[2];
+}
+
+// checksum as in calculate_checksum()
+static int sipCheckFrame(const uint8_t *frame, int frameLen)
+{
+    const uint8_t *ptr = &frame[3];
+    int n = frame[2] - 2;
+    int c = 0;
+
+    while (n > 1)
+    {
+        c += (*(ptr) << 8) | *(ptr + 1);
+        c = c & 0xffff;
+        n -= 2;
+        ptr += 2;
+    }
+    if (n > 0)
+        c = c ^ (int) * (ptr++);
+
+    if ((*(ptr) != (c >> 8)) || (*(ptr + 1) != (c & 0x00ff)))
+    {
+        return -1;
+    }
+    return 0;
+}
+
 // vehicle parameter
 
 chassis_param_data param = {
@@ -211,6 +251,7 @@ chassis_param_data param = {
     param.pilotVTransMax    = getInt32Param("pilotVTransMax");
 
     serialPort.clean();
+    serialFramer.clean();
     serialPort.setRecvTimeout(200000000llu);
 
     // check if server connection is already open
@@ -701,36 +742,17 @@ int ChassisPioneer::calculate_checksum(unsigned char *ptr)
 
 int ChassisPioneer::receivePackage(unsigned char *sipBuffer, rack_time_t *timestamp)
 {
-    int totalCount = 0;
     int ret;
 
-    do
+    ret = serialFramer.recvFrame(sipBuffer, MAX_SIP_PACKAGE_SIZE, NULL, timestamp);
+    if (ret == -ETIME)
     {
-        ret = serialPort.recv(sipBuffer, 1, timestamp);
-        if (ret)
-        {
-            GDOS_ERROR("Receive package timeout on serial dev %i\n", serialDev);
-            return ret;
-        }
-        if (++totalCount > MAX_SIP_PACKAGE_SIZE)
-        {
-            GDOS_ERROR("Can't synchronize on package head\n");
-            return -ETIME;
-        }
-    }
-    while (sipBuffer[0] != 0xFA);
-
-    ret = serialPort.recv(&sipBuffer[1], 2, NULL);
-    if (ret)
-    {
-        GDOS_ERROR("Can't read package head\n");
+        GDOS_ERROR("Can't synchronize on package head\n");
         return ret;
     }
-
-    ret = serialPort.recv(&sipBuffer[3], sipBuffer[2], NULL);
-    if (ret)
+    else if (ret)
     {
-        GDOS_ERROR("Can't read package body\n");
+        GDOS_ERROR("Receive package timeout on serial dev %i\n", serialDev);
         return ret;
     }
 
@@ -871,6 +893,9 @@ int ChassisPioneer::moduleInit(void)
     }
     initBits.setBit(INIT_BIT_RTSERIAL_OPENED);
 
+    serialFramer.init(&serialPort, pioneer_serial_config.baud_rate,
+                      sipSync, sizeof(sipSync), sipFrameLen, sipCheckFrame);
+
     // create hardware mutex
     ret = hwMtx.create();
     if (ret)
@@ -19,6 +19,7 @@
 #include <main/rack_data_module.h>
 
 #include <main/serial_port.h>
+#include <main/serial_framer.h>
 #include <drivers/chassis_proxy.h>
 #include <drivers/ladar_proxy.h>
 
@@ -52,6 +53,7 @@ class ChassisPioneer : public RackDataModule {
     // your values
     int             serialDev;
     SerialPort      serialPort;
+    SerialFramer    serialFramer;
     int             ladarSonarSys;
     int             ladarSonarInst;
 
@@ -260,6 +260,8 @@ int ChassisUsarsim::moduleOn(void)
            return    errno;
     }
 
+    recvLen = 0;
+
     ret = chassisInit(usarsimChassis, chassisInitPos);
     if(ret)
     {
@@ -392,33 +394,76 @@ void ChassisUsarsim::moduleOff(void)
 
 int ChassisUsarsim::moduleLoop(void)
 {
-    chassis_data* p_data = NULL;
-    ssize_t datalength = 0;
+    char *line, *lineEnd;
     int ret;
-    int currentBatteryState;
     rack_time_t currentTime;
 
     RackTask::disableRealtimeMode();
     
-    ret = recv(tcpSocket, messageData, USARSIM_MAX_MSG_SIZE, 0);
+    ret = recv(tcpSocket, recvBuffer + recvLen, USARSIM_MAX_MSG_SIZE - recvLen, 0);
     RackTask::enableRealtimeMode();
     if (ret <= 0)
     {
         GDOS_ERROR("Can't get data from USARSIM server\n");
-        return ret;
+        return -1;
     }
-    else if (ret >= USARSIM_MAX_MSG_SIZE)
+    recvLen += ret;
+
+    currentTime = rackTime.get();
+
+    // USARSim messages are terminated by a line break. One read may contain
+    // several messages and the last one may be incomplete, so every complete
+    // line is parsed in place and the rest is kept for the next read
+    ret  = 0;
+    line = recvBuffer;
+
+    while ((lineEnd = (char *)memchr(line, '\n', recvLen - (line - recvBuffer))) != NULL)
+    {
+        *lineEnd = '\0';
+        ret      = parseMessage(line, currentTime);
+        line     = lineEnd + 1;
+        if (ret)
+        {
+            break;
+        }
+    }
+
+    recvLen -= line - recvBuffer;
+    if (recvLen >= USARSIM_MAX_MSG_SIZE)
     {
         GDOS_ERROR("USARSim message exceeds buffer size !\n");
+        recvLen = 0;
+    }
+    else if ((recvLen > 0) && (line != recvBuffer))
+    {
+        memmove(recvBuffer, line, recvLen);
+    }
+
+    if (ret)
+    {
+        return ret;
+    }
+
+    currentTime = rackTime.get();
+    if ( (currentTime - statusMsgTime) > (dataBufferPeriodTime * 5) )
+    {
+        GDOS_ERROR("Can't get status message from usarsim server\n");
+        return -1;
     }
-	
-	currentTime = rackTime.get();
     
-    messageStr = messageData;
+    return 0;
+}
 
-    if (messageStr.find("SEN") != string::npos)
+int ChassisUsarsim::parseMessage(char *msg, rack_time_t currentTime)
+{
+    chassis_data* p_data = NULL;
+    ssize_t datalength = 0;
+    int ret;
+    int currentBatteryState;
+
+    if (strncmp(msg, "SEN", 3) == 0)
     {
-        ret = searchOdometryData(currentTime);
+        ret = searchOdometryData(msg, currentTime);
         if (ret)
         {
             GDOS_ERROR("Can't receive odometry data\n");
@@ -427,7 +472,7 @@ int ChassisUsarsim::moduleLoop(void)
 
         if (ladarRelayInst >= 0)
         {
-            ret = searchRangeScannerData(currentTime);
+            ret = searchRangeScannerData(msg, currentTime);
             if (ret)
             {
                 GDOS_ERROR("Can't receive range scanner data\n");
@@ -437,7 +482,7 @@ int ChassisUsarsim::moduleLoop(void)
 
         if (positionGndTruthRelayInst >= 0)
         {
-            ret = searchGroundTruthData(currentTime);
+            ret = searchGroundTruthData(msg, currentTime);
             if (ret)
             {
                 GDOS_ERROR("Can't receive ground truth data\n");
@@ -445,15 +490,14 @@ int ChassisUsarsim::moduleLoop(void)
             }
         }
     }
-
-    if (messageStr.find("STA") != string::npos)
+    else if (strncmp(msg, "STA", 3) == 0)
     {
         // get datapointer from rackdatabuffer
         p_data = (chassis_data *)getDataBufferWorkSpace();
         
         statusMsgTime = currentTime;
     
-        currentBatteryState = getBatteryState();
+        currentBatteryState = getBatteryState(msg);
         if (currentBatteryState < 0)
         {
             GDOS_ERROR("Can't get battery state\n");
@@ -494,13 +538,6 @@ int ChassisUsarsim::moduleLoop(void)
                         p_data->recordingTime);
     }
 
-    currentTime = rackTime.get();
-    if ( (currentTime - statusMsgTime) > (dataBufferPeriodTime * 5) )
-    {
-        GDOS_ERROR("Can't get status message from usarsim server\n");
-        return -1;
-    }
-    
     return 0;
 }
 
@@ -665,276 +702,185 @@ int ChassisUsarsim::controlTrace(int state, float interval, int color)
     return 0;
 }
 
-int ChassisUsarsim::searchRangeScannerData(rack_time_t currentTime)
+/*
+ * In place tokenizer of the USARSim messages, e.g.
+ * "SEN {Time 12.34} {Type Odometry} {Name Odometry} {Pose 1.0,2.0,0.1}"
+ */
+
+char* ChassisUsarsim::findValue(char *msg, const char *key)
 {
-    size_t magicWordPos, startPos, endPos;
-    int ret;
-    dataStr.clear();
-    valueStr.clear();
+    char    *pos;
+    size_t  keyLen = strlen(key);
+
+    pos = msg;
+    while ((pos = strstr(pos, key)) != NULL)
+    {
+        pos += keyLen;
+
+        // skip keys with the same prefix
+        if ((*pos == ' ') || (*pos == '}'))
+        {
+            return pos;
+        }
+    }
+    return NULL;
+}
+
+int ChassisUsarsim::parseValues(const char *str, double *value, int valueMax)
+{
+    char    *end;
+    int     valueNum = 0;
+
+    while (valueNum < valueMax)
+    {
+        value[valueNum] = strtod(str, &end);
+        if (end == str)
+        {
+            break;
+        }
+        valueNum++;
+
+        str = end;
+        while (*str == ' ')
+        {
+            str++;
+        }
+        if (*str != ',')
+        {
+            break;
+        }
+        str++;
+    }
 
-    magicWordPos = messageStr.find("{Type RangeScanner");
+    // ignore the values behind valueMax
+    if (valueNum >= valueMax)
+    {
+        str = strchr(str, '}');
+    }
+
+    // incomplete list
+    if ((str == NULL) || (*str != '}'))
+    {
+        return -1;
+    }
+    return valueNum;
+}
+
+int ChassisUsarsim::searchRangeScannerData(char *msg, rack_time_t currentTime)
+{
+    char *section, *valuePos;
+    int i, ret, valueNum;
+
+    section = strstr(msg, "{Type RangeScanner");
     
-    if (magicWordPos != string::npos)
+    if (section != NULL)
     {
-        magicWordPos = messageStr.find("{Range", magicWordPos);
-        if (magicWordPos != string::npos)
+        valuePos = findValue(section, "{Range");
+        if (valuePos == NULL)
         {
-            startPos = magicWordPos + sizeof("{Range");
-            endPos = messageStr.find("}", startPos);
-            if (endPos != string::npos)
-            {
-                dataStr = messageStr.substr(startPos, endPos - startPos);
-                startPos = 0;
-                endPos = 0;
-                ladarData.data.pointNum = 0;
-
-                while ((startPos != string::npos) && (endPos != string::npos))
-                {
-                    endPos = dataStr.find(',', startPos);
-                    if (endPos != string::npos)
-                    {
-                        valueStr = dataStr.substr(startPos, endPos - startPos);
-                        startPos = endPos + 1;
-                    }
-                    else
-                    {
-                        valueStr = dataStr.substr(startPos);
-                    }
-                    ladarData.data.point[ladarData.data.pointNum].distance = (int)(atof(valueStr.c_str()) * 1000.0);
-                    ladarData.data.point[ladarData.data.pointNum].angle    =
-                                                ladarData.data.endAngle - (0.01745f * (float)ladarData.data.pointNum);
-                    ladarData.data.point[ladarData.data.pointNum].type = LADAR_POINT_TYPE_UNKNOWN;
-                    ladarData.data.pointNum++;
-                }
-                ladarData.data.startAngle = ladarData.data.endAngle - (0.01745f * (float)ladarData.data.pointNum);
-				ladarData.data.recordingTime = currentTime;
-
-                GDOS_DBG_DETAIL("ladarData.data.pointNum = %i",ladarData.data.pointNum);
-
-                ret = workMbx.sendDataMsg(MSG_DATA, ladarRelayMbxAdr + 1, 1, 1,
-                                         &ladarData, sizeof(ladar_data) + ladarData.data.pointNum * sizeof(ladar_point));
-                if (ret)
-                {
-                    GDOS_ERROR("Error while sending ladarData data from %x to %x, error code %i\n LadarDataPointNum %i\n",
-                               workMbx.getAdr(), ladarRelayMbxAdr, ret, ladarData.data.pointNum );
-                    return ret;
-                }
-            }
-            else
-            {
-                GDOS_ERROR("Can't receive Range Scanner Data. Incomplete message");
-                return -1;
-            }
+            GDOS_ERROR("Can't receive Range Scanner Data. Incomplete message");
+            return -1;
         }
-        else
+
+        valueNum = parseValues(valuePos, rangeValue, LADAR_DATA_MAX_POINT_NUM);
+        if (valueNum < 0)
         {
             GDOS_ERROR("Can't receive Range Scanner Data. Incomplete message");
             return -1;
         }
+
+        for (i = 0; i < valueNum; i++)
+        {
+            ladarData.data.point[i].distance = (int)(rangeValue[i] * 1000.0);
+            ladarData.data.point[i].angle    = ladarData.data.endAngle - (0.01745f * (float)i);
+            ladarData.data.point[i].type     = LADAR_POINT_TYPE_UNKNOWN;
+        }
+        ladarData.data.pointNum      = valueNum;
+        ladarData.data.startAngle    = ladarData.data.endAngle - (0.01745f * (float)ladarData.data.pointNum);
+        ladarData.data.recordingTime = currentTime;
+
+        GDOS_DBG_DETAIL("ladarData.data.pointNum = %i",ladarData.data.pointNum);
+
+        ret = workMbx.sendDataMsg(MSG_DATA, ladarRelayMbxAdr + 1, 1, 1,
+                                 &ladarData, sizeof(ladar_data) + ladarData.data.pointNum * sizeof(ladar_point));
+        if (ret)
+        {
+            GDOS_ERROR("Error while sending ladarData data from %x to %x, error code %i\n LadarDataPointNum %i\n",
+                       workMbx.getAdr(), ladarRelayMbxAdr, ret, ladarData.data.pointNum );
+            return ret;
+        }
     }
     return 0;
 }
 
-int ChassisUsarsim::searchOdometryData(rack_time_t currentTime)
+int ChassisUsarsim::searchOdometryData(char *msg, rack_time_t currentTime)
 {
-    size_t magicWordPos, startPos, endPos;
+    char *section, *valuePos;
+    double value[3];
     int ret;
-    int dataNum;
-    dataStr.clear();
-    valueStr.clear();
 
-    magicWordPos = messageStr.find("{Type Odometry");
+    section = strstr(msg, "{Type Odometry");
 
-    if (magicWordPos != string::npos)
+    if (section != NULL)
     {
-        magicWordPos = messageStr.find("{Pose", magicWordPos);
-        if (magicWordPos != string::npos)
-        {
-            startPos = magicWordPos + sizeof("{Pose");
-            endPos = messageStr.find("}", startPos);
-            if (endPos != string::npos)
-            {
-                dataStr = messageStr.substr(startPos, endPos - startPos);
-                startPos = 0;
-                endPos = 0;
-                dataNum = 0;
-
-                while ((startPos != string::npos) && (endPos != string::npos))
-                {
-                    endPos = dataStr.find(',', startPos);
-                    if (endPos != string::npos)
-                    {
-                        valueStr = dataStr.substr(startPos, endPos - startPos);
-                        startPos = endPos + 1;
-                    }
-                    else
-                    {
-                        valueStr = dataStr.substr(startPos);
-                    }
-                    
-                    switch (dataNum)
-                    {
-                        case 0:
-                                odometryData.pos.x = (int)(atof(valueStr.c_str()) * 1000.0);
-                            break;
-
-                        case 1:
-                                odometryData.pos.y = (int)(atof(valueStr.c_str()) * 1000.0);
-                            break;
-
-                        case 2:
-                                odometryData.pos.rho = atof(valueStr.c_str());
-                            break;
-                        default:
-                                GDOS_ERROR("Received odometry message doesn't match data format !");
-                    }
-                    dataNum++;
-                }
-                //odometryRelay
-                odometryData.recordingTime = currentTime;
-
-                ret = workMbx.sendDataMsg(MSG_DATA, odometryRelayMbxAdr + 1, 1, 1,
-                                 &odometryData, sizeof(odometry_data));
-                if (ret)
-                {
-                    GDOS_WARNING("Error while sending odometry data from %x to %x (bytes %d), %i\n",
-                        workMbx.getAdr(), odometryRelayMbxAdr, sizeof(odometry_data), ret);
-                    return ret;
-                }
-            }
-            else
-            {
-                GDOS_ERROR("Can't receive odometry data. Incomplete message");
-                return -1;
-            }
-        }
-        else
+        valuePos = findValue(section, "{Pose");
+        if ((valuePos == NULL) || (parseValues(valuePos, value, 3) != 3))
         {
             GDOS_ERROR("Can't receive odometry data. Incomplete message");
             return -1;
         }
+
+        odometryData.pos.x = (int)(value[0] * 1000.0);
+        odometryData.pos.y = (int)(value[1] * 1000.0);
+        odometryData.pos.rho = (float)value[2];
+
+        //odometryRelay
+        odometryData.recordingTime = currentTime;
+
+        ret = workMbx.sendDataMsg(MSG_DATA, odometryRelayMbxAdr + 1, 1, 1,
+                         &odometryData, sizeof(odometry_data));
+        if (ret)
+        {
+            GDOS_WARNING("Error while sending odometry data from %x to %x (bytes %d), %i\n",
+                workMbx.getAdr(), odometryRelayMbxAdr, sizeof(odometry_data), ret);
+            return ret;
+        }
     }
     return 0;
 }
 
-int ChassisUsarsim::searchGroundTruthData(rack_time_t currentTime)
+int ChassisUsarsim::searchGroundTruthData(char *msg, rack_time_t currentTime)
 {
-    size_t magicWordPos, startPos, endPos;
+    char *section, *valuePos;
+    double value[3];
     int ret;
-    int dataNum;
-    dataStr.clear();
-    valueStr.clear();
 
-    magicWordPos = messageStr.find("{Type GroundTruth");
+    section = strstr(msg, "{Type GroundTruth");
 
-    if (magicWordPos != string::npos)
+    if (section != NULL)
     {
-        magicWordPos = messageStr.find("{Location", magicWordPos);
-        if (magicWordPos != string::npos)
-        {
-            startPos = magicWordPos + sizeof("{Location");
-            endPos = messageStr.find("}", startPos);
-            if (endPos != string::npos)
-            {
-                dataStr = messageStr.substr(startPos, endPos - startPos);
-                startPos = 0;
-                endPos = 0;
-                dataNum = 0;
-
-                while ((startPos != string::npos) && (endPos != string::npos))
-                {
-                    endPos = dataStr.find(',', startPos);
-                    if (endPos != string::npos)
-                    {
-                        valueStr = dataStr.substr(startPos, endPos - startPos);
-                        startPos = endPos + 1;
-                    }
-                    else
-                    {
-                        valueStr = dataStr.substr(startPos);
-                    }
-
-                    switch (dataNum)
-                    {
-                        case 0:
-                                groundTruthData.pos.x = (int)(atof(valueStr.c_str()) * 1000.0);
-                            break;
-
-                        case 1:
-                                groundTruthData.pos.y = (int)(atof(valueStr.c_str()) * 1000.0);
-                            break;
-
-                        case 2:
-                                groundTruthData.pos.z = (int)(atof(valueStr.c_str()) * 1000.0);
-                            break;
-                        default:
-                                GDOS_ERROR("Received ground truth doesn't match data format !");
-                    }
-                    dataNum++;
-                }
-            }
-            else
-            {
-                GDOS_ERROR("Can't receive ground truth data. Incomplete message");
-                return -1;
-            }
-        }
-        magicWordPos = messageStr.find("{Orientation", magicWordPos);
-        if (magicWordPos != string::npos)
+        valuePos = findValue(section, "{Location");
+        if ((valuePos == NULL) || (parseValues(valuePos, value, 3) != 3))
         {
-            startPos = magicWordPos + sizeof("{Orientation");
-            endPos = messageStr.find("}", startPos);
-            if (endPos != string::npos)
-            {
-                dataStr = messageStr.substr(startPos, endPos - startPos);
-                startPos = 0;
-                endPos = 0;
-                dataNum = 0;
-
-                while ((startPos != string::npos) && (endPos != string::npos))
-                {
-                    endPos = dataStr.find(',', startPos);
-                    if (endPos != string::npos)
-                    {
-                        valueStr = dataStr.substr(startPos, endPos - startPos);
-                        startPos = endPos + 1;
-                    }
-                    else
-                    {
-                        valueStr = dataStr.substr(startPos);
-                    }
-
-                    switch (dataNum)
-                    {
-                        case 0:
-                                groundTruthData.pos.psi = atof(valueStr.c_str());
-                            break;
-
-                        case 1:
-                                groundTruthData.pos.rho = atof(valueStr.c_str());
-                            break;
-
-                        case 2:
-                                groundTruthData.pos.phi = atof(valueStr.c_str());
-                            break;
-                        default:
-                                GDOS_ERROR("Received ground truth message doesn't match data format !");
-                    }
-                    dataNum++;
-                }
-            }
-            else
-            {
-                GDOS_ERROR("Can't receive ground truth data. Incomplete message");
-                return -1;
-            }
+            GDOS_ERROR("Can't receive ground truth data. Incomplete message");
+            return -1;
         }
-        else
+
+        groundTruthData.pos.x = (int)(value[0] * 1000.0);
+        groundTruthData.pos.y = (int)(value[1] * 1000.0);
+        groundTruthData.pos.z = (int)(value[2] * 1000.0);
+
+        valuePos = findValue(section, "{Orientation");
+        if ((valuePos == NULL) || (parseValues(valuePos, value, 3) != 3))
         {
-            GDOS_ERROR("Can't ground truth data. Incomplete message");
+            GDOS_ERROR("Can't receive ground truth data. Incomplete message");
             return -1;
         }
 
+        groundTruthData.pos.psi = (float)value[0];
+        groundTruthData.pos.rho = (float)value[1];
+        groundTruthData.pos.phi = (float)value[2];
+
         //positionRelay
         groundTruthData.recordingTime = currentTime;
 
@@ -950,23 +896,15 @@ int ChassisUsarsim::searchGroundTruthData(rack_time_t currentTime)
     return 0;
 }
 
-int ChassisUsarsim::getBatteryState()
+int ChassisUsarsim::getBatteryState(char *msg)
 {
-    size_t magicWordPos, startPos, endPos;
-    valueStr.clear();
+    char *valuePos;
+    double value;
 
-    magicWordPos = messageStr.find("{Battery");
-
-    if (magicWordPos != string::npos)
+    valuePos = findValue(msg, "{Battery");
+    if ((valuePos != NULL) && (parseValues(valuePos, &value, 1) == 1))
     {
-        startPos = magicWordPos + sizeof("{Battery");
-        endPos = messageStr.find("}", startPos);
-        if (endPos != string::npos)
-        {
-            valueStr = messageStr.substr(startPos, endPos - startPos);
-
-            return (atoi(valueStr.c_str()));
-        }
+        return (int)value;
     }
 
     GDOS_ERROR("Can't receive battery state. Incomplete message");
@@ -974,23 +912,15 @@ int ChassisUsarsim::getBatteryState()
     return -1;
 }
 
-int ChassisUsarsim::getUsarsimTime()
+int ChassisUsarsim::getUsarsimTime(char *msg)
 {
-    size_t magicWordPos, startPos, endPos;
-    valueStr.clear();
+    char *valuePos;
+    double value;
 
-    magicWordPos = messageStr.find("{Time");
-
-    if (magicWordPos != string::npos)
+    valuePos = findValue(msg, "{Time");
+    if ((valuePos != NULL) && (parseValues(valuePos, &value, 1) == 1))
     {
-        startPos = magicWordPos + sizeof("{Time");
-        endPos = messageStr.find("}", startPos);
-        if (endPos != string::npos)
-        {
-            valueStr = messageStr.substr(startPos, endPos - startPos);
-
-            return ((int)(atof(valueStr.c_str()) * 1000.0));
-        }
+        return (int)(value * 1000.0);
     }
 
     GDOS_ERROR("Can't receive Usarsim time. Incomplete message");
@@ -25,9 +25,6 @@
 #include <netinet/in.h>
 #include <sys/socket.h>
 #include <arpa/inet.h>
-#include <string>
-
-using namespace std;
 
 
 // define module class
@@ -75,14 +72,12 @@ class ChassisUsarsim : public RackDataModule
     int                  usarsimPort;
     int                 maxBatteryState;
 
-    char                messageData[USARSIM_MAX_MSG_SIZE];
+    char                recvBuffer[USARSIM_MAX_MSG_SIZE];
+    int                 recvLen;
+    double              rangeValue[LADAR_DATA_MAX_POINT_NUM];
 
     rack_time_t         statusMsgTime;
 
-    string              messageStr;
-    string              dataStr;
-    string              valueStr;
-
     ladar_data_msg      ladarData;
     odometry_data       odometryData;
     position_data       groundTruthData;
@@ -111,11 +106,14 @@ class ChassisUsarsim : public RackDataModule
 
     int chassisInit(char *usarsimChassis, position_3d chassisInitPos);
     int sendMoveCommand(int speed, float omega, int type);
-    int searchRangeScannerData(rack_time_t currentTime);
-    int searchOdometryData(rack_time_t currentTime);
-    int searchGroundTruthData(rack_time_t currentTime);
-    int getBatteryState();
-    int getUsarsimTime();
+    int parseMessage(char *msg, rack_time_t currentTime);
+    char* findValue(char *msg, const char *key);
+    int parseValues(const char *str, double *value, int valueMax);
+    int searchRangeScannerData(char *msg, rack_time_t currentTime);
+    int searchOdometryData(char *msg, rack_time_t currentTime);
+    int searchGroundTruthData(char *msg, rack_time_t currentTime);
+    int getBatteryState(char *msg);
+    int getUsarsimTime(char *msg);
     int controlTrace(int state, float interval, int color);
 
     // -> non realtime context
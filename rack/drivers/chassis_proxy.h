@@ -67,6 +67,11 @@ class ChassisData : public RackDataMessage
 
             chassis_data *data = (chassis_data *)msgInfo->p_data;
 
+            if (msgInfo->isDataByteorderCpu()) // data in cpu byteorder
+            {
+                return data;
+            }
+
             data->recordingTime = msgInfo->data32ToCpu(data->recordingTime);
             data->deltaX        = msgInfo->data32FloatToCpu(data->deltaX);
             data->deltaY        = msgInfo->data32FloatToCpu(data->deltaY);
@@ -108,6 +113,11 @@ class ChassisMoveData : public RackMessage
 
             chassis_move_data *data = (chassis_move_data *)msgInfo->p_data;
 
+            if (msgInfo->isDataByteorderCpu()) // data in cpu byteorder
+            {
+                return data;
+            }
+
             data->vx      = msgInfo->data32ToCpu(data->vx);
             data->vy      = msgInfo->data32ToCpu(data->vy);
             data->omega   = msgInfo->data32FloatToCpu(data->omega);
@@ -186,6 +196,11 @@ class ChassisParamData : public RackMessage
 
             chassis_param_data *data = (chassis_param_data *)msgInfo->p_data;
 
+            if (msgInfo->isDataByteorderCpu()) // data in cpu byteorder
+            {
+                return data;
+            }
+
             data->vxMax             = msgInfo->data32ToCpu(data->vxMax);
             data->vyMax             = msgInfo->data32ToCpu(data->vyMax);
             data->vxMin             = msgInfo->data32ToCpu(data->vxMin);
@@ -244,6 +259,11 @@ class ChassisSetActivePilotData : public RackMessage
 
             chassis_set_active_pilot_data *data = (chassis_set_active_pilot_data *)msgInfo->p_data;
 
+            if (msgInfo->isDataByteorderCpu()) // data in cpu byteorder
+            {
+                return data;
+            }
+
             data->activePilot = msgInfo->data32ToCpu(data->activePilot);
 
             msgInfo->setDataByteorder();
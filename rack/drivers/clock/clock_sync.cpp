@@ -0,0 +1,126 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2006 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Matthias Hentschel      <hentschel@rts.uni-hannover.de>
+ *
+ */
+
+#include "clock_sync.h"
+
+ClockSync::ClockSync()
+{
+    reset();
+}
+
+void ClockSync::reset(void)
+{
+    sampleNum      = 0;
+    sampleIndex    = 0;
+    best.localTime = 0;
+    best.offset    = 0;
+    best.delay     = 0;
+    drift          = 0;
+}
+
+void ClockSync::addSample(int64_t t1, int64_t t2, int64_t t3, int64_t t4)
+{
+    clock_sync_sample *p = &sample[sampleIndex];
+
+    p->localTime = t1 + (t4 - t1) / 2;
+    p->offset    = ((t2 - t1) + (t3 - t4)) / 2;
+    p->delay     = (t4 - t1) - (t3 - t2);
+    if (p->delay < 0)
+    {
+        p->delay = 0;
+    }
+
+    sampleIndex = (sampleIndex + 1) % CLOCK_SYNC_SAMPLE_NUM;
+    if (sampleNum < CLOCK_SYNC_SAMPLE_NUM)
+    {
+        sampleNum++;
+    }
+
+    estimate();
+}
+
+void ClockSync::estimate(void)
+{
+    clock_sync_sample   *p;
+    int64_t             minDelay;
+    double              t, o, sumT, sumO, sumTT, sumTO, n;
+    int                 i;
+
+    // the shortest round trip of the last samples has the smallest error
+    for (i = 0; i < sampleNum; i++)
+    {
+        p = &sample[(sampleIndex - 1 - i + CLOCK_SYNC_SAMPLE_NUM) % CLOCK_SYNC_SAMPLE_NUM];
+
+        if ((i == 0) || ((i < CLOCK_SYNC_FILTER_NUM) && (p->delay < best.delay)))
+        {
+            best = *p;
+        }
+    }
+
+    minDelay = best.delay;
+    for (i = 0; i < sampleNum; i++)
+    {
+        if (sample[i].delay < minDelay)
+        {
+            minDelay = sample[i].delay;
+        }
+    }
+
+    // least squares fit of the offset over the local time, relative to the
+    // best sample to keep the precision
+    n = sumT = sumO = sumTT = sumTO = 0.0;
+    for (i = 0; i < sampleNum; i++)
+    {
+        p = &sample[i];
+        if (p->delay > 2 * minDelay + CLOCK_SYNC_DELAY_TOLERANCE)
+        {
+            continue;
+        }
+
+        t = (double)(p->localTime - best.localTime);
+        o = (double)(p->offset - best.offset);
+
+        n     += 1.0;
+        sumT  += t;
+        sumO  += o;
+        sumTT += t * t;
+        sumTO += t * o;
+    }
+
+    // the variance of the sample times has to be at least the variance of
+    // samples spread evenly over CLOCK_SYNC_DRIFT_TIME
+    if ((n < 4.0) ||
+        ((sumTT - sumT * sumT / n) / n < (double)CLOCK_SYNC_DRIFT_TIME * CLOCK_SYNC_DRIFT_TIME / 12.0))
+    {
+        return;
+    }
+
+    drift = (int64_t)((n * sumTO - sumT * sumO) / (n * sumTT - sumT * sumT) * 1.0e9);
+
+    if (drift > CLOCK_SYNC_DRIFT_MAX)
+    {
+        drift = CLOCK_SYNC_DRIFT_MAX;
+    }
+    if (drift < -CLOCK_SYNC_DRIFT_MAX)
+    {
+        drift = -CLOCK_SYNC_DRIFT_MAX;
+    }
+}
+
+int64_t ClockSync::getOffset(int64_t localTime)
+{
+    return best.offset + (int64_t)((double)(localTime - best.localTime) * drift * 1.0e-9);
+}
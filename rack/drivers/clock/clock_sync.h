@@ -0,0 +1,80 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2006 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Matthias Hentschel      <hentschel@rts.uni-hannover.de>
+ *
+ */
+#ifndef __CLOCK_SYNC_H__
+#define __CLOCK_SYNC_H__
+
+#include <inttypes.h>
+
+#define CLOCK_SYNC_SAMPLE_NUM       32                  // samples for the drift
+#define CLOCK_SYNC_FILTER_NUM       8                   // samples for the offset
+#define CLOCK_SYNC_DELAY_TOLERANCE  100000ll            // [ns] accepted delay above minimum
+#define CLOCK_SYNC_DRIFT_TIME       4000000000ll        // [ns] minimum time span for the drift
+#define CLOCK_SYNC_DRIFT_MAX        1000000ll           // [ns/s] maximum drift (1000 ppm)
+
+typedef struct {
+    int64_t     localTime;          // [ns] local time of the sample
+    int64_t     offset;             // [ns] remote time - local time
+    int64_t     delay;              // [ns] round trip delay
+} clock_sync_sample;
+
+/**
+ * Estimation of the offset and drift of the local clock to a remote clock
+ * from request / reply exchanges like NTP. The offset is taken from the
+ * exchange with the shortest round trip of the last samples, the drift is a
+ * least squares fit over the samples with a short round trip.
+ *
+ * @ingroup modules_clock
+ */
+class ClockSync
+{
+    private:
+        clock_sync_sample   sample[CLOCK_SYNC_SAMPLE_NUM];
+        int                 sampleNum;
+        int                 sampleIndex;
+
+        clock_sync_sample   best;
+        int64_t             drift;
+
+        void    estimate(void);
+
+    public:
+        ClockSync();
+
+        void    reset(void);
+
+        // t1 / t4 local send / receive time, t2 / t3 remote receive / send time
+        void    addSample(int64_t t1, int64_t t2, int64_t t3, int64_t t4);
+
+        // offset at the given local time
+        int64_t getOffset(int64_t localTime);
+
+        int64_t getDrift(void)
+        {
+            return drift;
+        }
+
+        int64_t getDelay(void)
+        {
+            return best.delay;
+        }
+
+        int     getSampleNum(void)
+        {
+            return sampleNum;
+        }
+};
+
+#endif // __CLOCK_SYNC_H__
@@ -37,6 +37,18 @@ arg_table_t argTab[] = {
     { ARGOPT_OPT, "systemClockUpdateTime", ARGOPT_REQVAL, ARGOPT_VAL_INT,
       "Time interval for updating the system clock in ms, default 60000 ", { 60000 } },
 
+    { ARGOPT_OPT, "syncSys", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The system of the time master ClockSystem, -1 = no synchronisation, default -1", { -1 } },
+
+    { ARGOPT_OPT, "syncInst", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The instance of the time master ClockSystem, default 0", { 0 } },
+
+    { ARGOPT_OPT, "syncTime", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Time interval of the synchronisation in ms, default 1000", { 1000 } },
+
+    { ARGOPT_OPT, "testOffset", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Offset in ms added to the RACK time before the synchronisation (test), default 0", { 0 } },
+
     { 0, "", 0, 0, "", { 0 } } // last entry
 };
 
@@ -57,6 +69,8 @@ int ClockSystem::moduleOn(void)
     // get dynamic module parameter
     systemClockUpdate     = getInt32Param("systemClockUpdate");
     systemClockUpdateTime = getInt32Param("systemClockUpdateTime");
+    syncTime              = getInt32Param("syncTime");
+    testOffset            = getInt32Param("testOffset");
 
     // use clock input for updating the system time
     if (clockInst >= 0)
@@ -72,6 +86,29 @@ int ClockSystem::moduleOn(void)
     }
 
 
+    // synchronisation of the RACK time with the time master
+    if (syncSys >= 0)
+    {
+        if (syncTime <= 0)
+        {
+            GDOS_ERROR("Invalid synchronisation time %d ms\n", syncTime);
+            return -EINVAL;
+        }
+
+        // the estimation starts again, the drift is reset
+        ret = rackTime.adjustOffset(rackTime.getOffset() + (int64_t)testOffset * 1000000ll, 0, 0);
+        if (ret)
+        {
+            GDOS_ERROR("Can't adjust the offset of the RACK time, code = %d\n", ret);
+            return ret;
+        }
+
+        clockSync.reset();
+        syncValid            = 0;
+        lastSyncTime         = rackTime.get() - syncTime;
+        dataBufferPeriodTime = syncTime;
+    }
+
     // init variables
     lastUpdateTime = rackTime.get() - systemClockUpdateTime;
     currSyncMode   = CLOCK_SYNC_MODE_NONE;
@@ -82,7 +119,19 @@ int ClockSystem::moduleOn(void)
 // realtime context
 void ClockSystem::moduleOff(void)
 {
+    int ret;
+
     RackDataModule::moduleOff();       // has to be first command in moduleOff();
+
+    // the RACK time keeps the current offset without drift
+    if (syncSys >= 0)
+    {
+        ret = rackTime.adjustOffset(rackTime.getOffset(), 0, 0);
+        if (ret)
+        {
+            GDOS_ERROR("Can't adjust the offset of the RACK time, code = %d\n", ret);
+        }
+    }
 }
 
 // realtime context
@@ -135,6 +184,15 @@ int ClockSystem::moduleLoop(void)
         }
     }
 
+    // synchronise the RACK time, the master may not be available all the time
+    if ((syncSys >= 0) &&
+        (((int)p_data->recordingTime - (int)lastSyncTime) >= syncTime))
+    {
+        lastSyncTime = p_data->recordingTime;
+        syncValid    = synchronise() ? 0 : 1;
+        currSyncMode = syncValid ? CLOCK_SYNC_MODE_REMOTE : CLOCK_SYNC_MODE_NONE;
+    }
+
     // get current system time
     RackTask::disableRealtimeMode();
     gettimeofday(&currSystemTime, 0);
@@ -151,7 +209,7 @@ int ClockSystem::moduleLoop(void)
     p_data->utcTime       = currSystemTime.tv_sec;
     p_data->dayOfWeek     = ptm->tm_wday;
     p_data->syncMode      = currSyncMode;
-    p_data->varT          = 0;
+    p_data->varT          = syncValid ? (int32_t)(clockSync.getDelay() / 2000000ll) : 0;
 
     // sunday correction
     if (p_data->dayOfWeek == 0)
@@ -166,10 +224,90 @@ int ClockSystem::moduleLoop(void)
     return 0;
 }
 
+// one request / reply exchange with the time master
+int ClockSystem::synchronise(void)
+{
+    int64_t t1, t4, offset, diff;
+    int     ret;
+
+    t1 = rackTime.getLocalNano();
+    syncData.requestTime = t1;
+    syncData.recvTime    = 0;
+    syncData.replyTime   = 0;
+
+    ret = syncClock->getSync(&syncData, rackTime.toNano(syncTime));
+    t4  = rackTime.getLocalNano();
+    if (ret)
+    {
+        GDOS_WARNING("Can't get time of Clock(%i/%i), code = %d\n", syncSys, syncInst, ret);
+        return ret;
+    }
+
+    // late reply of an older request
+    if (syncData.requestTime != t1)
+    {
+        GDOS_WARNING("Received outdated time of Clock(%i/%i)\n", syncSys, syncInst);
+        return -EAGAIN;
+    }
+
+    clockSync.addSample(t1, syncData.recvTime, syncData.replyTime, t4);
+
+    offset = clockSync.getOffset(t4);
+    diff   = offset - rackTime.getOffset();
+
+    // small differences are slewed, the RACK time stays continuous
+    if ((diff > CLOCK_SYSTEM_STEP_LIMIT) || (diff < -CLOCK_SYSTEM_STEP_LIMIT))
+    {
+        GDOS_PRINT("Step RACK time by %.3f ms\n", (double)diff / 1000000.0);
+        ret = rackTime.adjustOffset(offset, clockSync.getDrift(), 0);
+    }
+    else
+    {
+        ret = rackTime.adjustOffset(offset, clockSync.getDrift(), CLOCK_SYSTEM_SLEW_RATE);
+    }
+    if (ret)
+    {
+        GDOS_ERROR("Can't adjust the offset of the RACK time, code = %d\n", ret);
+        return ret;
+    }
+
+    GDOS_DBG_INFO("offset %.3f ms, difference %.3f ms, drift %.3f ppm, delay %.3f ms\n",
+                  (double)offset / 1000000.0, (double)diff / 1000000.0,
+                  (double)clockSync.getDrift() / 1000.0,
+                  (double)clockSync.getDelay() / 1000000.0);
+    return 0;
+}
+
 int ClockSystem::moduleCommand(RackMessage *msgInfo)
 {
-    // not for me -> ask RackDataModule
-    return RackDataModule::moduleCommand(msgInfo);
+    clock_sync_data *p_sync;
+    clock_sync_data syncReply;
+
+    switch (msgInfo->getType())
+    {
+        // time master, also in the disabled state
+        case MSG_CLOCK_GET_SYNC:
+            syncReply.recvTime = rackTime.getNano();
+
+            p_sync = ClockSyncData::parse(msgInfo);
+            if (!p_sync)
+            {
+                cmdMbx.sendMsgReply(MSG_ERROR, msgInfo);
+                break;
+            }
+
+            syncReply.requestTime = p_sync->requestTime;
+            syncReply.replyTime   = rackTime.getNano();
+
+            cmdMbx.sendDataMsgReply(MSG_CLOCK_SYNC, msgInfo, 1, &syncReply,
+                                    sizeof(clock_sync_data));
+            break;
+
+        default:
+            // not for me -> ask RackDataModule
+            return RackDataModule::moduleCommand(msgInfo);
+    }
+    return 0;
 }
 
 /*******************************************************************************
@@ -188,6 +326,7 @@ int ClockSystem::moduleCommand(RackMessage *msgInfo)
 #define INIT_BIT_DATA_MODULE                0
 #define INIT_BIT_MBX_WORK                   1
 #define INIT_BIT_PROXY_CLOCK                2
+#define INIT_BIT_PROXY_SYNC                 3
 
 int ClockSystem::moduleInit(void)
 {
@@ -226,6 +365,18 @@ int ClockSystem::moduleInit(void)
         initBits.setBit(INIT_BIT_PROXY_CLOCK);
     }
 
+    // clock proxy of the time master
+    if (syncSys >= 0)
+    {
+        syncClock = new ClockProxy(&workMbx, syncSys, syncInst);
+        if (!syncClock)
+        {
+            ret = -ENOMEM;
+            goto init_error;
+        }
+        initBits.setBit(INIT_BIT_PROXY_SYNC);
+    }
+
     return 0;
 
 init_error:
@@ -247,6 +398,11 @@ void ClockSystem::moduleCleanup(void)
         delete clock;
     }
 
+    if (initBits.testAndClearBit(INIT_BIT_PROXY_SYNC))
+    {
+        delete syncClock;
+    }
+
     // delete work mailbox
     if (initBits.testAndClearBit(INIT_BIT_MBX_WORK))
     {
@@ -266,6 +422,9 @@ ClockSystem::ClockSystem()
     // get static module parameter
     clockSys  = getIntArg("clockSys", argTab);
     clockInst = getIntArg("clockInst", argTab);
+    syncSys   = getIntArg("syncSys", argTab);
+    syncInst  = getIntArg("syncInst", argTab);
+    syncValid = 0;
     dataBufferMaxDataSize = sizeof(clock_data);
     dataBufferPeriodTime  = 5000;
 }
@@ -20,13 +20,19 @@
 #include <drivers/clock_proxy.h>
 #include <sys/time.h>
 
+#include "clock_sync.h"
+
 // define module class
 #define MODULE_CLASS_ID                     CLOCK
 
+#define CLOCK_SYSTEM_STEP_LIMIT             100000000ll     // [ns] larger offsets are stepped
+#define CLOCK_SYSTEM_SLEW_RATE              500000ll        // [ns/s] 500 ppm
 
 
 /**
- * System Clock
+ * System Clock. Optionally synchronises the RACK time of the system to the
+ * ClockSystem of a time master system, the offset is slewed without changes
+ * of the system time.
  *
  * @ingroup modules_clock
  */
@@ -37,16 +43,28 @@ class ClockSystem : public RackDataModule {
         int                 clockInst;
         int                 systemClockUpdate;
         int                 systemClockUpdateTime;
+        int                 syncSys;
+        int                 syncInst;
+        int                 syncTime;
+        int                 testOffset;
 
         clock_data          clockData;
         rack_time_t         lastUpdateTime;
         int                 currSyncMode;
 
+        ClockSync           clockSync;
+        clock_sync_data     syncData;
+        rack_time_t         lastSyncTime;
+        int                 syncValid;
+
         ClockProxy          *clock;
+        ClockProxy          *syncClock;
 
         // additional mailboxes
         RackMailbox         workMbx;
 
+        int      synchronise(void);
+
     protected:
         // -> realtime context
         int      moduleOn(void);
@@ -30,3 +30,19 @@
     recv_data = ClockData::parse(&msgInfo);
     return 0;
 }
+
+ int ClockProxy::getSync(clock_sync_data *sync_data, uint64_t reply_timeout_ns)
+{
+    RackMessage msgInfo;
+
+    int ret = proxySendRecvDataCmd(MSG_CLOCK_GET_SYNC, sync_data, sizeof(clock_sync_data),
+                                   MSG_CLOCK_SYNC, sync_data, sizeof(clock_sync_data),
+                                   reply_timeout_ns, &msgInfo);
+    if (ret)
+    {
+        return ret;
+    }
+
+    sync_data = ClockSyncData::parse(&msgInfo);
+    return 0;
+}
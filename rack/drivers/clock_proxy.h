@@ -21,6 +21,9 @@
 #define CLOCK_SYNC_MODE_NONE   0            /**< no clock synchronisation */
 #define CLOCK_SYNC_MODE_REMOTE 1            /**< remote clock synchronisation */
 
+#define MSG_CLOCK_GET_SYNC     (RACK_PROXY_MSG_POS_OFFSET + 1)
+#define MSG_CLOCK_SYNC         (RACK_PROXY_MSG_NEG_OFFSET - 1)
+
 //######################################################################
 //# Clock Data (static size - MESSAGE)
 //######################################################################
@@ -82,6 +85,68 @@ class ClockData
 
             clock_data *p_data = (clock_data *)msgInfo->p_data;
 
+            if (msgInfo->isDataByteorderCpu()) // data in cpu byteorder
+            {
+                return p_data;
+            }
+
+            if (msgInfo->isDataByteorderLe()) // data in little endian
+            {
+                le_to_cpu(p_data);
+            }
+            else // data in big endian
+            {
+                be_to_cpu(p_data);
+            }
+            msgInfo->setDataByteorder();
+            return p_data;
+        }
+
+};
+
+//######################################################################
+//# Clock Sync Data (static size - MESSAGE)
+//######################################################################
+
+/**
+ * clock synchronisation request and reply, the request time is returned
+ * unchanged
+ */
+typedef struct {
+    int64_t       requestTime;              /**< [ns] local send time of the request */
+    int64_t       recvTime;                 /**< [ns] RACK time of the request reception */
+    int64_t       replyTime;                /**< [ns] RACK time of the reply */
+} __attribute__((packed)) clock_sync_data;
+
+class ClockSyncData
+{
+    public:
+        static void le_to_cpu(clock_sync_data *data)
+        {
+            data->requestTime = __le64_to_cpu(data->requestTime);
+            data->recvTime    = __le64_to_cpu(data->recvTime);
+            data->replyTime   = __le64_to_cpu(data->replyTime);
+        }
+
+        static void be_to_cpu(clock_sync_data *data)
+        {
+            data->requestTime = __be64_to_cpu(data->requestTime);
+            data->recvTime    = __be64_to_cpu(data->recvTime);
+            data->replyTime   = __be64_to_cpu(data->replyTime);
+        }
+
+        static clock_sync_data* parse(RackMessage *msgInfo)
+        {
+            if (!msgInfo->p_data)
+                return NULL;
+
+            clock_sync_data *p_data = (clock_sync_data *)msgInfo->p_data;
+
+            if (msgInfo->isDataByteorderCpu()) // data in cpu byteorder
+            {
+                return p_data;
+            }
+
             if (msgInfo->isDataByteorderLe()) // data in little endian
             {
                 le_to_cpu(p_data);
@@ -126,6 +191,17 @@ class ClockProxy : public RackDataProxy {
     int getData(clock_data *recv_data, ssize_t recv_datalen, rack_time_t timeStamp,
                 uint64_t reply_timeout_ns);
 
+//
+// clock synchronisation
+//
+
+    int getSync(clock_sync_data *sync_data)
+    {
+        return getSync(sync_data, dataTimeout);
+    }
+
+    int getSync(clock_sync_data *sync_data, uint64_t reply_timeout_ns);
+
 };
 
 #endif // __CLOCK_PROXY_H__
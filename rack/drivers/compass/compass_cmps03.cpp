@@ -64,6 +64,25 @@ struct rtser_config serial_config = {
     event_mask        : RTSER_EVENT_RXPEND
 };
 
+const uint8_t messageSync[] = {'$'};
+
+// message: '$', ascii data, line feed
+static int messageLen(const uint8_t *data, int dataLen)
+{
+    const uint8_t *end;
+
+    end = (const uint8_t *)memchr(data, 10, dataLen);
+    if (end)
+    {
+        return (int)(end - data) + 1;
+    }
+    if (dataLen >= (int)sizeof(((compass_serial_data *)0)->data))
+    {
+        return -1;
+    }
+    return 0;
+}
+
 /*******************************************************************************
  *   !!! REALTIME CONTEXT !!!
  *
@@ -81,6 +100,7 @@ int CompassCmps03::moduleOn(void)
     compassOffset           = getInt32Param("compassOffset");
 
     serialPort.clean();
+    serialFramer.clean();
 
     // set rx timeout 2 * periodTime
     serialPort.setRecvTimeout(rackTime.toNano(2 * dataBufferPeriodTime));
@@ -165,75 +185,22 @@ int CompassCmps03::moduleCommand(RackMessage *msgInfo)
 
 int CompassCmps03::readSerialMessage(compass_serial_data *serialData)
 {
-    int             i, ret;
-    int             msgSize;
-    unsigned char   currChar;
-    rack_time_t     recordingTime;
-
-
-    // init local variables
-    recordingTime   = 0;
-    currChar        = 0;
-    i               = 0;
-    msgSize         = sizeof(serialData->data);
-
-    // synchronize to message head, timeout after 200 attempts
-    while ((i < 200) && (currChar != 36))
-    {
-        // read next character
-        ret = serialPort.recv(&currChar, 1, &recordingTime);
-        if (ret)
-        {
-            GDOS_ERROR("Can't read message head from serial device %i, code = %d\n",
-                       serialDev, ret);
-            return ret;
-        }
-        i++;
-    }
-
+    int ret;
 
-    // check for timeout
-    if (i >= 200)
+    // read serial message from '$' to line feed,
+    // the recordingtime is the one of the '$'
+    ret = serialFramer.recvFrame(serialData->data, sizeof(serialData->data), NULL,
+                                 &serialData->recordingTime);
+    if (ret == -ETIME)
     {
         GDOS_ERROR("Can't synchronize on message head\n");
-        return -ETIME;
-    }
-    // store first character
-    else
-    {
-        serialData->data[0] = currChar;
-        i = 1;
-    }
-
-
-    // read serial message until currChar == "0x03",
-    // timout if msgSize is reached
-    while ((i < msgSize) && (currChar != 10))
-    {
-        // read next character
-        ret = serialPort.recv(&currChar, 1, &recordingTime);
-        if (ret)
-        {
-            GDOS_ERROR("Can't read data from serial device %i, code = %d\n",
-                       serialDev, ret);
-            return ret;
-        }
-
-        // store character
-        serialData->data[i] = currChar;
-        i++;
-    }
-
-    // if last read character != "0x0a" an error occured
-    if (currChar != 10)
-    {
-        GDOS_ERROR("Can't read end of serial message\n");
-        return -EINVAL;
+        return ret;
     }
-    // store recordingtime of last character
-    else
+    else if (ret)
     {
-        serialData->recordingTime = recordingTime;
+        GDOS_ERROR("Can't read data from serial device %i, code = %d\n",
+                   serialDev, ret);
+        return ret;
     }
 
     return 0;
@@ -385,6 +352,9 @@ int CompassCmps03::moduleInit(void)
     GDOS_DBG_INFO("serialDev %d has been opened \n", serialDev);
     initBits.setBit(INIT_BIT_SERIALPORT_OPEN);
 
+    serialFramer.init(&serialPort, serial_config.baud_rate, messageSync,
+                      sizeof(messageSync), messageLen, NULL);
+
     //
     // create mailboxes
     //
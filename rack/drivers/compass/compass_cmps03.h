@@ -19,6 +19,7 @@
 #include <main/rack_data_module.h>
 #include <drivers/compass_proxy.h>
 #include <main/serial_port.h>
+#include <main/serial_framer.h>
 #include <main/angle_tool.h>
 
 
@@ -53,6 +54,7 @@ class CompassCmps03 : public RackDataModule {
               
 
         SerialPort          serialPort;
+        SerialFramer        serialFramer;
         compass_serial_data serialData;
 
         // additional mailboxes
@@ -57,6 +57,11 @@ class CompassData
 
             compass_data *p_data = (compass_data *)msgInfo->p_data;
 
+            if (msgInfo->isDataByteorderCpu()) // data in cpu byteorder
+            {
+                return p_data;
+            }
+
             if (msgInfo->isDataByteorderLe()) // data in little endian
             {
                 le_to_cpu(p_data);
@@ -60,6 +60,11 @@ class GpsData
 
             gps_data *data = (gps_data *)msgInfo->p_data;
 
+            if (msgInfo->isDataByteorderCpu()) // data in cpu byteorder
+            {
+                return data;
+            }
+
             data->recordingTime = msgInfo->data32ToCpu(data->recordingTime);
             data->mode          = msgInfo->data32ToCpu(data->mode);
             data->latitude      = msgInfo->data64FloatToCpu(data->latitude);
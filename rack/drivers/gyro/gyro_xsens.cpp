@@ -46,6 +46,48 @@ struct rtser_config serialConfig = {
     event_mask        : RTSER_EVENT_RXPEND
 };
 
+const uint8_t messageSync[] = {GYRO_XSENS_MESSAGE_PREAMBLE};
+
+// message: preamble, bid, mid, len, (extLen), data, checksum
+static int messageLen(const uint8_t *data, int dataLen)
+{
+    int extLen;
+
+    if (dataLen < 4)
+    {
+        return 0;
+    }
+    if (data[3] != 0xff)
+    {
+        return 5 + data[3];
+    }
+    if (dataLen < 6)
+    {
+        return 0;
+    }
+
+    extLen = (data[4] << 8) | data[5];
+    if (extLen > GYRO_XSENS_MESSAGE_DATA_MAX)
+    {
+        return -1;
+    }
+    return 7 + extLen;
+}
+
+// the sum of all bytes behind the preamble is zero
+static int messageCheck(const uint8_t *frame, int frameLen)
+{
+    uint8_t checksum = 0;
+    int     i;
+
+    for (i = 1; i < frameLen; i++)
+    {
+        checksum += frame[i];
+    }
+
+    return checksum;
+}
+
 /*******************************************************************************
  *   !!! REALTIME CONTEXT !!!
  *
@@ -66,6 +108,7 @@ int  GyroXsens::moduleOn(void)
     {
         GDOS_ERROR("Can't clean serial port, code = %d \n", ret);
     }
+    serialFramer.clean();
     
     GDOS_DBG_DETAIL("baudrate %i\n", serialConfig.baud_rate);
 
@@ -129,100 +172,45 @@ int  GyroXsens::moduleCommand(RackMessage *msgInfo)
 
 int  GyroXsens::readMessage(gyro_xsens_message *message, rack_time_t *recordingTime)
 {
-    int     i;
     int     ret;
-    int     messageSize;
-    uint8_t checksum;
-
-    // init variables
-    i                   = 0;
-    messageSize         = sizeof(gyro_xsens_message);
-    message->preamble   = 0;
-
-    // synchronize to preamble, timeout after 200 attempts
-    while ((i < messageSize) && (message->preamble != GYRO_XSENS_MESSAGE_PREAMBLE))
-    {
-        // wait for next event on serial port
-        ret = serialPort.recv(&message->preamble, 1, recordingTime);
-        if (ret)
-        {
-            GDOS_ERROR("Can't read message preamble on serial dev %i, code %d\n",
-                       serialDev, ret);
-            return ret;
-        }
-        i ++;
-    }
+    int     frameLen;
+    int     headLen;
 
-    // check for timeout
-    if (i >= messageSize)
+    // read next message with valid checksum
+    ret = serialFramer.recvFrame(serialBuffer, sizeof(serialBuffer), &frameLen,
+                                 recordingTime);
+    if (ret == -ETIME)
     {
         GDOS_ERROR("Can't synchronize on message head\n");
-        return -ETIME;
+        return ret;
     }
-
-    // read message header
-    ret = serialPort.recv(&message->bid, 3);
-    if (ret)
+    else if (ret)
     {
-        GDOS_ERROR("Can't read message header on serial dev %i, code %d\n",
+        GDOS_ERROR("Can't read message on serial dev %i, code %d\n",
                    serialDev, ret);
         return ret;
     }
 
+    message->preamble = serialBuffer[0];
+    message->bid      = serialBuffer[1];
+    message->mid      = serialBuffer[2];
+    message->len      = serialBuffer[3];
+
     // check if extended length message is given
     if (message->len == 0xff)
     {
-        message->len = 0;
-        ret = serialPort.recv(&message->extLen, 2);
-        if (ret)
-        {
-            GDOS_ERROR("Can't read extended length on serial dev %i, code %d\n",
-                       serialDev, ret);
-            return ret;
-        }
+        message->len    = 0;
+        message->extLen = (serialBuffer[4] << 8) | serialBuffer[5];
+        headLen         = 6;
     }
     else
     {
         message->extLen = 0;
+        headLen         = 4;
     }
 
-    // read message data
-    ret = serialPort.recv(&message->data, (message->len + message->extLen));
-    if (ret)
-    {
-        GDOS_ERROR("Can't read message data on serial dev %i, code %d\n",
-                   serialDev, ret);
-        return ret;
-    }
-
-    // read message checksum
-    ret = serialPort.recv(&message->checksum, 1);
-    if (ret)
-    {
-        GDOS_ERROR("Can't read message checksum on serial dev %i, code %d\n",
-                   serialDev, ret);
-        return ret;
-    }
-
-    // calculate checksum
-    checksum  = 0;
-    checksum += message->bid;
-    checksum += message->mid;
-    checksum += message->len;
-    checksum += message->extLen;
-
-    for (i = 0; i < (message->len + message->extLen); i++)
-    {
-        checksum += message->data[i];
-    }
-    checksum += message->checksum;
-
-    // valudate checksum
-    if (checksum != 0)
-    {
-        GDOS_ERROR("Wrong checksum in message\n");
-        //return -EINVAL;
-    }
+    memcpy(message->data, &serialBuffer[headLen], message->len + message->extLen);
+    message->checksum = serialBuffer[frameLen - 1];
 
     return 0;
 }
@@ -321,6 +309,9 @@ int  GyroXsens::moduleInit(void)
     GDOS_DBG_INFO("serialDev %d has been opened \n", serialDev);
     initBits.setBit(INIT_BIT_SERIALPORT_OPEN);
 
+    serialFramer.init(&serialPort, serialConfig.baud_rate, messageSync,
+                      sizeof(messageSync), messageLen, messageCheck);
+
     return 0;
 
 init_error:
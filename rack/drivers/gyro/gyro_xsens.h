@@ -20,6 +20,7 @@
 #include <main/rack_data_module.h>
 #include <main/angle_tool.h>
 #include <main/serial_port.h>
+#include <main/serial_framer.h>
 //#include "main/linux/serial_port_linux.cpp"
 #include <drivers/gyro_proxy.h>
 
@@ -30,6 +31,9 @@
 
 #define GYRO_XSENS_MESSAGE_MTDATA   0x32
 
+#define GYRO_XSENS_MESSAGE_DATA_MAX 2048
+#define GYRO_XSENS_MESSAGE_SIZE_MAX (7 + GYRO_XSENS_MESSAGE_DATA_MAX)
+
 
 typedef struct
 {
@@ -38,7 +42,7 @@ typedef struct
     uint8_t         mid;
     uint8_t         len;
     uint16_t        extLen;
-    uint8_t         data[2048];
+    uint8_t         data[GYRO_XSENS_MESSAGE_DATA_MAX];
     uint8_t         checksum;
 } gyro_xsens_message;
 
@@ -56,7 +60,9 @@ class GyroXsens : public RackDataModule
 
         // global variables
         SerialPort          serialPort;
+        SerialFramer        serialFramer;
         gyro_xsens_message  gyroMessage;
+        uint8_t             serialBuffer[GYRO_XSENS_MESSAGE_SIZE_MAX];
 
         // own functions
         int      readMessage(gyro_xsens_message *message, rack_time_t *recordingTime);
@@ -82,6 +82,11 @@ class GyroData
 
             gyro_data *p_data = (gyro_data *)msgInfo->p_data;
 
+            if (msgInfo->isDataByteorderCpu()) // data in cpu byteorder
+            {
+                return p_data;
+            }
+
             if (msgInfo->isDataByteorderLe()) // data in little endian
             {
                 le_to_cpu(p_data);
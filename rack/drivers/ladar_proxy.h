@@ -58,34 +58,24 @@ class LadarData
     public:
         static void le_to_cpu(ladar_data *data)
         {
-            int i;
-
             data->recordingTime   = __le32_to_cpu(data->recordingTime);
             data->duration        = __le32_to_cpu(data->duration);
             data->maxRange        = __le32_to_cpu(data->maxRange);
             data->startAngle      = __le32_float_to_cpu(data->startAngle);
             data->endAngle        = __le32_float_to_cpu(data->endAngle);
             data->pointNum        = __le32_to_cpu(data->pointNum);
-            for (i = 0; i < data->pointNum; i++)
-            {
-                LadarPoint::le_to_cpu(&data->point[i]);
-            }
+            LadarPoint::le_to_cpu(data->point, data->pointNum);
         }
 
         static void be_to_cpu(ladar_data *data)
         {
-            int i;
-
             data->recordingTime   = __be32_to_cpu(data->recordingTime);
             data->duration        = __be32_to_cpu(data->duration);
             data->maxRange        = __be32_to_cpu(data->maxRange);
             data->startAngle      = __be32_float_to_cpu(data->startAngle);
             data->endAngle        = __be32_float_to_cpu(data->endAngle);
             data->pointNum        = __be32_to_cpu(data->pointNum);
-            for (i = 0; i < data->pointNum; i++)
-            {
-                LadarPoint::be_to_cpu(&data->point[i]);
-            }
+            LadarPoint::be_to_cpu(data->point, data->pointNum);
         }
 
         static ladar_data *parse(RackMessage *msgInfo)
@@ -95,6 +85,11 @@ class LadarData
 
             ladar_data *p_data = (ladar_data *)msgInfo->p_data;
 
+            if (msgInfo->isDataByteorderCpu()) // data in cpu byteorder
+            {
+                return p_data;
+            }
+
             if (msgInfo->isDataByteorderLe()) // data in little endian
             {
                 le_to_cpu(p_data);
@@ -68,6 +68,11 @@ class PtzDriveData
 
             ptz_drive_data *p_data = (ptz_drive_data *)msgInfo->p_data;
 
+            if (msgInfo->isDataByteorderCpu()) // data in cpu byteorder
+            {
+                return p_data;
+            }
+
             if (msgInfo->isDataByteorderLe()) // data in little endian
             {
                 le_to_cpu(p_data);
@@ -146,6 +151,11 @@ class PtzDriveMovePosData
 
             ptz_drive_move_pos_data *p_data = (ptz_drive_move_pos_data *)msgInfo->p_data;
 
+            if (msgInfo->isDataByteorderCpu()) // data in cpu byteorder
+            {
+                return p_data;
+            }
+
             if (msgInfo->isDataByteorderLe()) // data in little endian
             {
                 le_to_cpu(p_data);
@@ -197,6 +207,11 @@ class PtzDriveMoveVelData
             ptz_drive_move_vel_data *p_data =
                                    (ptz_drive_move_vel_data *)msgInfo->p_data;
 
+            if (msgInfo->isDataByteorderCpu()) // data in cpu byteorder
+            {
+                return p_data;
+            }
+
             if (msgInfo->isDataByteorderLe()) // data in little endian
             {
                 le_to_cpu(p_data);
@@ -54,8 +54,8 @@ class ServoDriveData
 
         static void be_to_cpu(servo_drive_data *data)
         {
-            data->recordingTime = __le32_to_cpu(data->recordingTime);
-            data->position      = __le32_float_to_cpu(data->position);
+            data->recordingTime = __be32_to_cpu(data->recordingTime);
+            data->position      = __be32_float_to_cpu(data->position);
         }
 
         static servo_drive_data* parse(RackMessage *msgInfo)
@@ -65,6 +65,11 @@ class ServoDriveData
 
             servo_drive_data *p_data = (servo_drive_data *)msgInfo->p_data;
 
+            if (msgInfo->isDataByteorderCpu()) // data in cpu byteorder
+            {
+                return p_data;
+            }
+
             if (msgInfo->isDataByteorderLe()) // data in little endian
             {
                 le_to_cpu(p_data);
@@ -123,6 +128,11 @@ class ServoDriveMovePosData
             servo_drive_move_pos_data *p_data =
                                    (servo_drive_move_pos_data *)msgInfo->p_data;
 
+            if (msgInfo->isDataByteorderCpu()) // data in cpu byteorder
+            {
+                return p_data;
+            }
+
             if (msgInfo->isDataByteorderLe()) // data in little endian
             {
                 le_to_cpu(p_data);
@@ -168,6 +178,11 @@ class ServoDriveMoveVelData
             servo_drive_move_vel_data *p_data =
                                    (servo_drive_move_vel_data *)msgInfo->p_data;
 
+            if (msgInfo->isDataByteorderCpu()) // data in cpu byteorder
+            {
+                return p_data;
+            }
+
             if (msgInfo->isDataByteorderLe()) // data in little endian
             {
                 le_to_cpu(p_data);
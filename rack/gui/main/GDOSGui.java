@@ -234,12 +234,16 @@ public class GDOSGui extends GuiElement
 
                 if (data != null)
                 {
-                    if(ckeckMultiError(data))
+                    // all messages of a batch message
+                    for (; data != null; data = data.next)
                     {
-                        // print GDOS message
-                        gdosTableModel.addGDOSMsg(data);
-                        jsb.setValue(jsb.getMaximum());
-                        firstTimeout = true;
+                        if(ckeckMultiError(data))
+                        {
+                            // print GDOS message
+                            gdosTableModel.addGDOSMsg(data);
+                            jsb.setValue(jsb.getMaximum());
+                            firstTimeout = true;
+                        }
                     }
                 }
                 else
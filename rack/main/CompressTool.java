@@ -270,70 +270,35 @@ public class CompressTool {
     }
 
     //----- writes the [bits] lowest bit from [value] into the bitstream [bs] (max 32)
+    //----- The bits of the actual byte and of [value] are combined in one 64 bit word,
+    //----- which is stored bytewise (MSB first) afterwards.
     public void compr_writeBitStream(Compr_bitStream bs, int value, int bits) {
-        if (bs.aBit == 0) bs.data[bs.aByte] = 0;
-        int nBits = 8-bs.aBit;
-        if (nBits >= bits) {
-            bs.data[bs.aByte] = (byte)((bs.data[bs.aByte]) | (value << (nBits-bits)));
-            bs.aBit += bits;
-            bits = 0;
-        } else  {
-            bs.data[bs.aByte] = (byte)((bs.data[bs.aByte]) | (value >> (bits-nBits)));
-            bits-=nBits;
-            bs.aBit = 8;
-        }
-        if (bs.aBit == 8) { bs.aByte++; bs.data[bs.aByte] = 0; bs.aBit = 0; }
-        while (bits >= 8) {
-            bits-=8;
-            bs.data[bs.aByte] = (byte) ((value >> bits)  & 0x000000FF);
-            bs.aByte++; bs.data[bs.aByte] = 0;
-        }
-        if (bits > 0) {
-            bs.data[bs.aByte] = (byte) ((value << (8-bits)) & 0x000000FF);
-            bs.aBit += bits;
+        if (bits == 0) return;
+        int  total = bs.aBit + bits;                        //----- max 39 bits
+        long word  = (bs.aBit == 0) ? 0 : ((bs.data[bs.aByte] & 0xFF) >> (8-bs.aBit));
+        word  = (word << bits) | ((long)value & (0xFFFFFFFFL >>> (32-bits)));
+        word <<= 64-total;
+        for (int i = 0; i < ((total+7) >> 3); i++) {
+            bs.data[bs.aByte+i] = (byte)(word >>> 56);
+            word <<= 8;
         }
-        if (bs.aBit == 8) { bs.aByte++; bs.data[bs.aByte] = 0; bs.aBit = 0; }
+        bs.aByte += total >> 3;
+        bs.aBit   = total & 7;
     }
 
     //----- returns [bits] bits from the bitstream [bs] (max 32)
+    //----- All needed bytes are loaded into one 64 bit word at once.
     public int compr_readBitStream(Compr_bitStream bs, int bits) {
         if (bits == 0) return 0;
-        int output = 0;
-        int tmp = 0;
-        int nBits = 8-bits-bs.aBit;
-        if (bits <= (8-bs.aBit)) { //----- all bits in actual byte
-            output = bs.data[bs.aByte];
-            if (nBits > 0) output >>= nBits;
-            output <<= 32-bits-1;
-            output &= 0x7FFFFFFF;
-            output >>= 32-bits-1;
-            if ((bs.aBit + bits) == 8) { bs.aByte++; bs.aBit = 0; }
-            else bs.aBit += bits;
-            bits = 0;
-        } else {                    //----- read bits from first byte
-            output = bs.data[bs.aByte];
-            output <<= 24+bs.aBit-1;
-            output &= 0x7FFFFFFF;
-            output >>= 24+bs.aBit-1;
-            bits -= (8-bs.aBit);
-            bs.aByte++; bs.aBit = 0;
-        }
-        while (bits >= 8) {         //----- read full bytes
-            tmp = bs.data[bs.aByte++];
-            if (tmp < 0) tmp += 256;
-            bits -= 8;
-            output <<= 8;
-            output += tmp;
-        }
-        if (bits > 0) {             //----- read remaining bits
-            tmp = bs.data[bs.aByte];
-            if (tmp < 0) tmp += 256;
-            output <<= bits;
-            tmp >>= 8-bits;
-            output += tmp;
-            bs.aBit=bits;
-        }
-        return output;
+        int  total  = bs.aBit + bits;                       //----- max 39 bits
+        int  nBytes = (total+7) >> 3;
+        long word   = 0;
+        for (int i = 0; i < nBytes; i++)
+            word = (word << 8) | (bs.data[bs.aByte+i] & 0xFF);
+        word >>>= (nBytes << 3) - total;
+        bs.aByte += total >> 3;
+        bs.aBit   = total & 7;
+        return (int)(word & (0xFFFFFFFFL >>> (32-bits)));
     }
 
     //----- writes [bytes] bytes of [value] into the byte stream [bs] (max 4)
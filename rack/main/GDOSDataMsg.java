@@ -23,6 +23,8 @@ import rack.main.tims.*;
 public class GDOSDataMsg extends TimsMsg
 {
     public String message;
+    /** next message of a batch message */
+    public GDOSDataMsg next = null;
 
     public int getDataLen()
     {
@@ -53,8 +55,7 @@ public class GDOSDataMsg extends TimsMsg
     public void readTimsMsgBody(InputStream in) throws IOException
     {
         EndianDataInputStream dataIn;
-        int dataLen = msglen - HEAD_LEN;
-        int stringLen = dataLen;
+        GDOSDataMsg msg = this;
 
         if (bodyByteorder == BIG_ENDIAN)
         {
@@ -66,6 +67,24 @@ public class GDOSDataMsg extends TimsMsg
         }
 
         bodyByteorder = BIG_ENDIAN;
+
+        // a batch message contains several messages of the same level
+        while (msg.readMessage(dataIn, in.available()) && (in.available() > 0))
+        {
+            msg.next = new GDOSDataMsg();
+            msg.next.type     = type;
+            msg.next.priority = priority;
+            msg.next.seqNr    = seqNr;
+            msg.next.dest     = dest;
+            msg.next.src      = src;
+            msg = msg.next;
+        }
+    }
+
+    protected boolean readMessage(EndianDataInputStream dataIn, int dataLen)
+            throws IOException
+    {
+        int stringLen = dataLen;
         byte[] byteArray = new byte[dataLen];
 
         for (int i = 0; i < dataLen; i++)
@@ -158,7 +177,7 @@ public class GDOSDataMsg extends TimsMsg
                         message = "Unknown parameter %"
                                 + new String(byteArray, i, 1) + " \""
                                 + new String(byteArray, 0, stringLen) + "\"";
-                        return;
+                        return false;
                 }
 
             }
@@ -167,6 +186,7 @@ public class GDOSDataMsg extends TimsMsg
                 message = message + new String(byteArray, i, 1);
             }
         }
+        return true;
     }
 
     public void writeTimsMsgBody(OutputStream out) throws IOException
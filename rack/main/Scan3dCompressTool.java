@@ -28,6 +28,7 @@ public class Scan3dCompressTool {
     public final int COMPR_S1_DELTA_RLE           = 0x00000005;
     public final int COMPR_S1_REMOVE_INVALID      = 0x01000000;
     public final int SCAN_POINT_TYPE_INVALID      = 0x00000010;
+    public final int COMPR_BLOCK_MAGIC            = 0x4D42;
 
     CompressTool decompressor = new CompressTool();
     MinMax       minMax       = new MinMax();      //----- statistics on input data
@@ -38,6 +39,10 @@ public class Scan3dCompressTool {
 
     public int Decompress(byte[] inBuf, ScanPoint[] outBuf, int nC, int nP) throws IOException
     {
+    //----- chunked compression
+    if ((inBuf[0] == 'M') && (inBuf[1] == 'B'))
+        return DecompressBlocks(inBuf, outBuf, nC, nP);
+
        byte[] buf1 = new byte[nC];
        output = outBuf;
 
@@ -114,6 +119,42 @@ public class Scan3dCompressTool {
 
     }
 
+    //----- Decompresses data of Scan3dCompressTool::CompressBlocks() (header "MB").
+    //----- Every block is an independent compressed stream, that is decompressed
+    //----- into its part of [outBuf].
+    public int DecompressBlocks(byte[] inBuf, ScanPoint[] outBuf, int nC, int nP) throws IOException
+    {
+        CompressTool.Compr_bitStream inStream = decompressor.new Compr_bitStream();
+        inStream.data  = inBuf;
+        inStream.aByte = 0;
+        inStream.aBit  = 0;
+
+        //----- evaluate header: Magic value
+        if (decompressor.compr_readByteStream(inStream, 2) != COMPR_BLOCK_MAGIC) {
+            System.out.println("Fehler: Die blockweise komprimierten Daten haben keinen gueltigen Header!\n");
+            return -1;
+        }
+        int blockNum      = decompressor.compr_readByteStream(inStream, 4);
+        int blockPointNum = decompressor.compr_readByteStream(inStream, 4);
+        int pos           = 10 + blockNum * 4;
+
+        for (int i = 0; i < blockNum; i++) {
+            int size    = decompressor.compr_readByteStream(inStream, 4);
+            int nPoints = (i == blockNum - 1) ? nP - i * blockPointNum : blockPointNum;
+
+            //----- the block is expanded in its own buffer
+            byte[] blockBuf = new byte[nPoints * ScanPoint.getDataLen() + 42];
+            System.arraycopy(inBuf, pos, blockBuf, 0, size);
+
+            ScanPoint[] blockPoint = new ScanPoint[nPoints];
+            System.arraycopy(outBuf, i * blockPointNum, blockPoint, 0, nPoints);
+
+            if (Decompress(blockBuf, blockPoint, size, nPoints) == -1) return -1;
+            pos += size;
+        }
+        return nP * ScanPoint.getDataLen();
+    }
+
     //----- minMax contains min and max values of input data, their ranges
     //----- and the needed amount of bits and bytes
     class MinMax {
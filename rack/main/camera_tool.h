@@ -18,10 +18,39 @@
 #define __CAMERA_TOOL_H__
 
 #include <main/rack_gdos.h>
+#include <main/rack_mailbox.h>
+#include <main/rack_mutex.h>
+#include <main/rack_task.h>
+#include <drivers/camera_proxy.h>
 
 #include <math.h>
 #include <string.h>
 
+// conversion types of convert() and convertRows()
+#define CAMERA_TOOL_UYVY2RGB            1
+#define CAMERA_TOOL_UYVY2BGR            2
+#define CAMERA_TOOL_UYVY2GRAY           3
+#define CAMERA_TOOL_BAYER2RGB           4   // bilinear
+#define CAMERA_TOOL_BAYER2RGB_EDGE      5   // green interpolated along edges
+#define CAMERA_TOOL_MONO122MONO8        6
+#define CAMERA_TOOL_MONO162MONO8        7
+
+// 16 bit filters in row stripes
+#define CAMERA_TOOL_MEDIAN16            16  // window of radius pixels in the row
+#define CAMERA_TOOL_MEDIAN16_2D         17  // (2 * radius + 1)^2 window
+#define CAMERA_TOOL_BOX16               18  // (2 * radius + 1)^2 window
+
+// instruction sets of the conversions
+#define CAMERA_TOOL_SIMD_NONE           0
+#define CAMERA_TOOL_SIMD_SSE2           1
+#define CAMERA_TOOL_SIMD_AVX2           2
+
+#define CAMERA_TOOL_WORKER_NUM_MAX      8
+#define CAMERA_TOOL_STRIPE_NUM          4       // stripes per task
+#define CAMERA_TOOL_MSG_JOB             1       // job message to the workers
+#define CAMERA_TOOL_MSG_STOP            2       // terminates a worker
+#define CAMERA_TOOL_MSG_DONE            3       // job finished by a worker
+
 /**
  *
  * @ingroup main_tools
@@ -34,6 +63,30 @@ class CameraTool {
 
     int32_t         colorLookuptableThermalRed12[4096];
 
+    // row stripes converted by the calling task and the worker tasks
+    RackTask        stripeTask[CAMERA_TOOL_WORKER_NUM_MAX];
+    RackMutex       stripeMtx;
+    RackMailbox     *stripeJobMbx;          // workers wait for jobs here
+    RackMailbox     *stripeDoneMbx;         // caller waits for finished jobs here
+    int             stripeWorkerNum;
+    int             stripeInit;
+    // actual job
+    int             stripeType;
+    uint8_t         *stripeOutput;
+    uint8_t         *stripeInput;
+    int             stripeWidth;
+    int             stripeHeight;
+    int             stripeParam;            // color filter or filter radius
+    int             stripeRows;
+    int             stripeNum;
+    int             stripeNext;
+
+    void stripeInitVars(void);
+    void stripeProcess(void);
+    int  runStripes(int type, uint8_t* outputData, uint8_t* inputData, int width, int height,
+                    int param);
+    friend void camera_tool_stripe_task_proc(void *arg);
+
   public:
 
     CameraTool();
@@ -41,9 +94,24 @@ class CameraTool {
     void initColorTables();
 
     static inline int clip(int in);
+    static void setSimdLevel(int level);
+    static int  getSimdLevel(void);
+
     static int convertCharUYVY2RGB(uint8_t* outputData, uint8_t* inputData, int width, int height);
     static int convertCharUYVY2BGR(uint8_t* outputData, uint8_t* inputData, int width, int height);
     static int convertCharUYVY2Gray(uint8_t* outputData, uint8_t* inputData, int width, int height);
+    static int convertCharBayer2RGB(uint8_t* outputData, uint8_t* inputData, int width, int height,
+                                    int colorFilterId, int edgeAware);
+    static int convertCharMono162Mono8(uint8_t* outputData, uint8_t* inputData, int width, int height,
+                                       int depth);
+    static int convertRows(int type, uint8_t* outputData, uint8_t* inputData, int width, int height,
+                           int colorFilterId, int rowStart, int rowEnd);
+
+    int  initStripes(int workerNum, int prio, RackMailbox *jobMbx, RackMailbox *doneMbx);
+    void cleanupStripes(void);
+    int  convert(int type, uint8_t* outputData, uint8_t* inputData, int width, int height,
+                 int colorFilterId);
+
     static int convertCharBGR2RGB(uint8_t* outputData, uint8_t* inputData, int width, int height);
     static int convertCharRGB2MONO8(uint8_t* outputData, uint8_t* inputData,int width, int height);
     int convertCharMono82RGBThermalRed(uint8_t* outputData, uint8_t* inputData, int width, int height);
@@ -58,7 +126,10 @@ class CameraTool {
                                     int topMargin, int bottomMargin, int leftMargin, int rightMargin);
 
     int qsMedianFilter16Bit(short *outputData, short *inputData, int width, int height, int radius);
+    int medianFilter16Bit2d(short *outputData, short *inputData, int width, int height, int radius);
     int lowPassFilter16Bit(short *outputData, short *inputData, int width, int height, int radius);
+    static int filterRows(int type, short *outputData, short *inputData, int width, int height,
+                          int radius, int rowStart, int rowEnd);
 
     ~CameraTool();
 };
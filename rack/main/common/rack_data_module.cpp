@@ -25,6 +25,7 @@
 #define INIT_BIT_BUFFER_CREATED             3
 #define INIT_BIT_BUFFER_MTX_CREATED         4
 #define INIT_BIT_LISTENER_MTX_CREATED       5
+#define INIT_BIT_SPARE_CREATED              6
 
 //######################################################################
 //# class RackDataModule
@@ -45,7 +46,9 @@ RackDataModule::RackDataModule( uint32_t class_id,                // class ID
                                      cmdMbxFlags)
 {
     dataBufferMaxEntries    = maxDataBufferEntries;
+    dataBufferWorkSpaceNum  = 1;
     dataBufferMaxListener   = maxDataBufferListener;
+    dataBufferSpareNum      = 0;
     dataBufferSendMbx       = 0;
 
     dataBufferMaxDataSize   = 0;
@@ -57,6 +60,8 @@ RackDataModule::RackDataModule( uint32_t class_id,                // class ID
     index                   = 0;
 
     dataBuffer              = NULL;
+    dataBufferSpare         = NULL;
+    dataBufferRefs          = NULL;
     listener                = NULL;
 
     dataModuleInitBits.clearAllBits();
@@ -223,21 +228,22 @@ int         RackDataModule::getDataBufferIndex(rack_time_t time)
     new_index   = index;
     new_rectime = getRecordingTime(dataBuffer[new_index].pData);
 
-    n = globalDataCount > dataBufferMaxEntries ?
-        (dataBufferMaxEntries - 1) : globalDataCount;
+    // the work spaces of the data task are skipped
+    n = globalDataCount > (dataBufferMaxEntries - dataBufferWorkSpaceNum) ?
+        (dataBufferMaxEntries - dataBufferWorkSpaceNum) : globalDataCount;
 
     if (time != 0)
     {
         // globalDataCount > 0
 
         if ((index == globalDataCount) &&
-            (globalDataCount < (dataBufferMaxEntries -1)))
+            (globalDataCount < (dataBufferMaxEntries - dataBufferWorkSpaceNum)))
         {
             old_index = 1; // in slot 1 are the oldest data
         }
         else
         {
-            old_index = (index+2) % dataBufferMaxEntries;
+            old_index = (index + 1 + dataBufferWorkSpaceNum) % dataBufferMaxEntries;
         }
 
         old_rectime = getRecordingTime(dataBuffer[old_index].pData);
@@ -325,6 +331,66 @@ int         RackDataModule::sendDataReply(rack_time_t time, RackMessage *msgInfo
     return ret;
 }
 
+// the reference counters are decremented by the local listeners
+static inline int dataBufferEntryRefs(DataBufferEntry *entry)
+{
+    return entry->pRefs ? *(volatile int *)entry->pRefs : 0;
+}
+
+// realtime context (dataTask)
+// number of buffers which are read by local listeners
+uint32_t    RackDataModule::getDataBufferSharedNum(void)
+{
+    uint32_t i, num = 0;
+
+    for (i = 0; i < dataBufferMaxEntries; i++)
+    {
+        if (dataBufferEntryRefs(&dataBuffer[i]))
+            num++;
+    }
+
+    for (i = 0; i < dataBufferSpareNum; i++)
+    {
+        if (dataBufferEntryRefs(&dataBufferSpare[i]))
+            num++;
+    }
+
+    return num;
+}
+
+// realtime context (dataTask)
+//
+// Local listeners still read the data of the entry, so it gets a free spare
+// buffer. Data is only shared as long as fewer than dataBufferSpareNum
+// buffers are read (see putDataBufferWorkSpace()), so a free spare exists.
+void        RackDataModule::unshareDataBufferEntry(uint32_t entry)
+{
+    uint32_t i;
+    void     *pData;
+    int      *pRefs;
+
+    if (!dataBufferEntryRefs(&dataBuffer[entry]))
+    {
+        return;
+    }
+
+    for (i = 0; i < dataBufferSpareNum; i++)
+    {
+        if (!dataBufferEntryRefs(&dataBufferSpare[i]))
+        {
+            pData = dataBuffer[entry].pData;
+            pRefs = dataBuffer[entry].pRefs;
+
+            dataBuffer[entry].pData = dataBufferSpare[i].pData;
+            dataBuffer[entry].pRefs = dataBufferSpare[i].pRefs;
+
+            dataBufferSpare[i].pData = pData;
+            dataBufferSpare[i].pRefs = pRefs;
+            return;
+        }
+    }
+}
+
 void RackDataModule::setDataBufferMaxDataSize(uint32_t max_size)
 {
     dataBufferMaxDataSize = max_size;
@@ -342,14 +408,72 @@ uint32_t RackDataModule::getDataBufferMaxDataSize(void)
 // realtime context (dataTask)
 void*       RackDataModule::getDataBufferWorkSpace(void)
 {
+    unshareDataBufferEntry((index+1) % dataBufferMaxEntries);
+
     return dataBuffer[(index+1) % dataBufferMaxEntries].pData;
 }
 
+// realtime context (dataTask)
+//
+// Data tasks with several messages in process reserve the next num entries
+// as work spaces. They are filled in any order and put in order with
+// putDataBufferWorkSpace(), getData requests never return them.
+// It has to be called before RackDataModule::moduleOn().
+int         RackDataModule::setDataBufferWorkSpaceNum(uint32_t num)
+{
+    if ((num < 1) || (num + 1 >= dataBufferMaxEntries))
+    {
+        GDOS_ERROR("DataBuffer: %d work spaces don't fit into %d entries\n",
+                   num, dataBufferMaxEntries);
+        return -EINVAL;
+    }
+
+    dataBufferWorkSpaceNum = num;
+    return 0;
+}
+
+// realtime context (dataTask)
+void*       RackDataModule::getDataBufferWorkSpace(uint32_t ahead)
+{
+    if (ahead >= dataBufferWorkSpaceNum)
+    {
+        return NULL;
+    }
+
+    unshareDataBufferEntry((index + 1 + ahead) % dataBufferMaxEntries);
+
+    return dataBuffer[(index + 1 + ahead) % dataBufferMaxEntries].pData;
+}
+
+// realtime context (dataTask)
+// the next work space is not used, the following work spaces move forward
+void        RackDataModule::dropDataBufferWorkSpace(void)
+{
+    uint32_t i;
+    void     *pData;
+    int      *pRefs;
+
+    pData = dataBuffer[(index + 1) % dataBufferMaxEntries].pData;
+    pRefs = dataBuffer[(index + 1) % dataBufferMaxEntries].pRefs;
+
+    for (i = 1; i < dataBufferWorkSpaceNum; i++)
+    {
+        dataBuffer[(index + i) % dataBufferMaxEntries].pData =
+            dataBuffer[(index + i + 1) % dataBufferMaxEntries].pData;
+        dataBuffer[(index + i) % dataBufferMaxEntries].pRefs =
+            dataBuffer[(index + i + 1) % dataBufferMaxEntries].pRefs;
+    }
+
+    dataBuffer[(index + dataBufferWorkSpaceNum) % dataBufferMaxEntries].pData = pData;
+    dataBuffer[(index + dataBufferWorkSpaceNum) % dataBufferMaxEntries].pRefs = pRefs;
+}
+
 // realtime context (dataTask)
 void        RackDataModule::putDataBufferWorkSpace(uint32_t datalength)
 {
     uint32_t        i;
     int             ret;
+    int             shared;
 
     if ((datalength < 0) || (datalength > dataBufferMaxDataSize))
     {
@@ -383,11 +507,28 @@ void        RackDataModule::putDataBufferWorkSpace(uint32_t datalength)
                        "reduction %d\n", i, listener[i].msgInfo.getSrc(),
                        listenerNum, listener[i].reduction);
 */
-            ret = dataBufferSendMbx->sendDataMsgReply(MSG_DATA,
-                                                      &listener[i].msgInfo,
-                                                      1,
-                                                      dataBuffer[index].pData,
-                                                      dataBuffer[index].dataSize);
+            // local listeners read the data in place as long as a free
+            // spare buffer is left for the work space
+            shared = dataBufferSpareNum &&
+                     (dataBufferEntryRefs(&dataBuffer[index]) ||
+                      (getDataBufferSharedNum() < dataBufferSpareNum));
+
+            if (shared)
+            {
+                ret = dataBufferSendMbx->sendDataMsgReplyShared(MSG_DATA,
+                                                                &listener[i].msgInfo,
+                                                                dataBuffer[index].pData,
+                                                                dataBuffer[index].dataSize,
+                                                                dataBuffer[index].pRefs);
+            }
+            else
+            {
+                ret = dataBufferSendMbx->sendDataMsgReply(MSG_DATA,
+                                                          &listener[i].msgInfo,
+                                                          1,
+                                                          dataBuffer[index].pData,
+                                                          dataBuffer[index].dataSize);
+            }
             if (ret)
             {
                 GDOS_ERROR("DataBuffer: Can't send continuous data "
@@ -504,6 +645,42 @@ int         RackDataModule::moduleInit(void)
     dataModuleInitBits.setBit(INIT_BIT_BUFFER_CREATED);
     GDOS_DBG_DETAIL("Memory for DataBuffer entries allocated\n");
 
+    // local listeners read the data buffer in place (see RackModuleHost)
+    if (RackMailbox::getLocalDelivery())
+    {
+        dataBufferSpareNum = DATA_BUFFER_SPARE_NUM;
+        dataBufferSpare    = new DataBufferEntry[dataBufferSpareNum];
+        dataBufferRefs     = new int[dataBufferMaxEntries + dataBufferSpareNum];
+        dataModuleInitBits.setBit(INIT_BIT_SPARE_CREATED);
+
+        for (i=0; i<dataBufferSpareNum; i++)
+        {
+            dataBufferSpare[i].pData = malloc(dataBufferMaxDataSize);
+            if (!dataBufferSpare[i].pData)
+            {
+                GDOS_ERROR("Error while allocating databuffer spare[%d] \n", i);
+                goto init_error;
+            }
+            memset(dataBufferSpare[i].pData, 0, dataBufferMaxDataSize);
+        }
+
+        for (i=0; i<dataBufferMaxEntries + dataBufferSpareNum; i++)
+        {
+            dataBufferRefs[i] = 0;
+        }
+
+        for (i=0; i<dataBufferMaxEntries; i++)
+        {
+            dataBuffer[i].pRefs = &dataBufferRefs[i];
+        }
+
+        for (i=0; i<dataBufferSpareNum; i++)
+        {
+            dataBufferSpare[i].pRefs = &dataBufferRefs[dataBufferMaxEntries + i];
+        }
+        GDOS_DBG_DETAIL("DataBuffer spare buffers allocated\n");
+    }
+
     // create listener data structures
 
     listener = new ListenerEntry[dataBufferMaxListener];
@@ -567,6 +744,29 @@ void        RackDataModule::moduleCleanup(void)
         listener = NULL;
     }
 
+    if (dataModuleInitBits.testAndClearBit(INIT_BIT_SPARE_CREATED))
+    {
+        // local listeners which still read the data keep the buffers
+        if (getDataBufferSharedNum())
+        {
+            GDOS_WARNING("DataBuffer: Buffers are still read by local listeners\n");
+            dataModuleInitBits.clearBit(INIT_BIT_BUFFER_CREATED);
+        }
+        else
+        {
+            for (i=0; i<dataBufferSpareNum; i++)
+            {
+                free(dataBufferSpare[i].pData);
+            }
+            delete[] dataBufferRefs;
+        }
+        delete[] dataBufferSpare;
+
+        dataBufferSpare    = NULL;
+        dataBufferRefs     = NULL;
+        dataBufferSpareNum = 0;
+    }
+
     if (dataModuleInitBits.testAndClearBit(INIT_BIT_BUFFER_CREATED))
     {
        for (i=0; i<dataBufferMaxEntries; i++)
@@ -0,0 +1,374 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2006 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Oliver Wulf <oliver.wulf@web.de>
+ *
+ */
+#include <main/rack_gdos.h>
+
+#include <errno.h>
+#include <stdlib.h>
+
+// memory barrier between the ring data and the ring positions, x86 does not
+// reorder stores with other stores or loads with other loads
+#if defined (__i386__) || defined (__x86_64__)
+#define gdos_barrier()  __asm__ __volatile__("" : : : "memory")
+#else
+#define gdos_barrier()  __sync_synchronize()
+#endif
+
+//
+// ring of the calling task
+//
+
+static uint32_t gdos_generation = 0;
+
+static __thread RackGdos*   gdos_ring_owner      = NULL;
+static __thread uint32_t    gdos_ring_generation = 0;
+static __thread gdos_ring*  gdos_ring_task       = NULL;
+
+// realtime context
+gdos_ring* RackGdos::getRing(void)
+{
+    pthread_t   self;
+    int         i, num;
+
+    if ((gdos_ring_owner == this) && (gdos_ring_generation == ringGeneration))
+    {
+        return gdos_ring_task;
+    }
+
+    self = pthread_self();
+    num  = ringNum;
+    if (num > GDOS_RING_NUM_MAX)
+    {
+        num = GDOS_RING_NUM_MAX;
+    }
+
+    // the task may use other RackGdos instances too
+    for (i = 0; i < num; i++)
+    {
+        if (pthread_equal(ring[i].thread, self))
+        {
+            break;
+        }
+    }
+
+    if (i == num)
+    {
+        i = __sync_fetch_and_add(&ringNum, 1);
+        if (i >= GDOS_RING_NUM_MAX)
+        {
+            return NULL;
+        }
+        ring[i].thread = self;
+    }
+
+    gdos_ring_owner      = this;
+    gdos_ring_generation = ringGeneration;
+    gdos_ring_task       = &ring[i];
+
+    return gdos_ring_task;
+}
+
+//
+// deferred messages
+//
+
+// realtime context
+void RackGdos::printDeferred(int level, int constFormat, const char* format,
+                             va_list args)
+{
+    uint64_t        buffer[GDOS_RECORD_SIZE_MAX / 8];
+    gdos_record*    rec  = (gdos_record *)buffer;
+    char*           data = (char *)(rec + 1);
+    gdos_ring*      r;
+    int             datasize = 0;
+    uint32_t        len, need, pos;
+
+    r = getRing();
+    if (!r)
+    {
+        __sync_fetch_and_add(&ringDropped, 1);
+        return;
+    }
+
+    // the format string is only copied if it may change
+    if (constFormat)
+    {
+        rec->format = format;
+    }
+    else
+    {
+        rec->format = NULL;
+        while ((format[datasize] != 0) && (datasize < (GDOS_MAX_MSG_SIZE - 1)))
+        {
+            data[datasize] = format[datasize];
+            datasize++;
+        }
+        data[datasize++] = 0;
+    }
+    rec->formatLen = datasize;
+
+    datasize = pack(data, datasize + GDOS_MAX_MSG_SIZE, datasize, format, args);
+    if (datasize < 0)
+    {
+        return;
+    }
+
+    rec->level   = level;
+    rec->dataLen = datasize - rec->formatLen;
+
+    len       = (sizeof(gdos_record) + datasize + 7) & ~7;
+    rec->size = len;
+
+    // records are not split at the end of the ring
+    pos  = r->head & (ringSize - 1);
+    need = len;
+    if (pos + len > ringSize)
+    {
+        need += ringSize - pos;
+    }
+
+    if (need > ringSize - (r->head - r->tail))
+    {
+        r->dropped++;
+        return;
+    }
+
+    if (need > len)
+    {
+        ((gdos_record *)&r->buffer[pos])->size = 0;
+        pos = 0;
+    }
+
+    memcpy(&r->buffer[pos], buffer, len);
+
+    gdos_barrier();
+    r->head += need;
+}
+
+// flush task
+void RackGdos::flushRing(gdos_ring* r)
+{
+    gdos_record*    rec;
+    const char*     format;
+    char*           data;
+    uint32_t        head, tail, pos;
+    int             formatLen;
+
+    head = r->head;
+    gdos_barrier();
+
+    tail = r->tail;
+    while (tail != head)
+    {
+        pos = tail & (ringSize - 1);
+        rec = (gdos_record *)&r->buffer[pos];
+
+        if (rec->size == 0)
+        {
+            tail += ringSize - pos;
+            continue;
+        }
+
+        data = (char *)(rec + 1);
+        if (rec->format)
+        {
+            format    = rec->format;
+            formatLen = strnlen(format, GDOS_MAX_MSG_SIZE - 1) + 1;
+        }
+        else
+        {
+            format    = data;
+            formatLen = rec->formatLen;
+            data     += formatLen;
+        }
+
+        // a batch message contains messages of one level only
+        if ((rec->level != batchLevel) ||
+            (batchLen + formatLen + rec->dataLen > GDOS_BATCH_SIZE))
+        {
+            flushBatch();
+            batchLevel = rec->level;
+        }
+
+        memcpy(&batch[batchLen], format, formatLen - 1);
+        batch[batchLen + formatLen - 1] = 0;
+        memcpy(&batch[batchLen + formatLen], data, rec->dataLen);
+        batchLen += formatLen + rec->dataLen;
+
+        tail += rec->size;
+    }
+
+    gdos_barrier();
+    r->tail = tail;
+}
+
+// flush task
+void RackGdos::flushBatch(void)
+{
+    tims_msg_head   head;
+
+    if ((batchLen > 0) && sendMbx)
+    {
+        tims_fill_head(&head, batchLevel, RackName::create(GDOS, 0), sendMbx->getAdr(),
+                       sendMbx->getPriority(), 0, 0, TIMS_HEADLEN + batchLen);
+
+        sendMbx->sendDataMsg(&head, 1, batch, batchLen);
+    }
+    batchLen = 0;
+}
+
+// flush task
+void RackGdos::flush(void)
+{
+    uint32_t    dropped;
+    int         i, num;
+
+    dropped = getDropped();
+    if (dropped != droppedReported)
+    {
+        printConst(GDOS_MSG_WARNING, "GDOS: %u messages dropped\n",
+                   dropped - droppedReported);
+        droppedReported = dropped;
+    }
+
+    num = ringNum;
+    if (num > GDOS_RING_NUM_MAX)
+    {
+        num = GDOS_RING_NUM_MAX;
+    }
+
+    for (i = 0; i < num; i++)
+    {
+        flushRing(&ring[i]);
+    }
+
+    flushBatch();
+}
+
+void gdos_flush_task_proc(void *arg)
+{
+    RackGdos*   gdos = (RackGdos *)arg;
+
+    RackTask::enableRealtimeMode();
+
+    while (!gdos->flushTerminate)
+    {
+        gdos->flush();
+        RackTask::sleep(GDOS_FLUSH_TIME);
+    }
+}
+
+// non realtime context
+int RackGdos::startDeferred(const char *name, int prio, int cpu, int size)
+{
+    int i, ret;
+
+    if (deferred || (size <= 0))
+    {
+        return -EINVAL;
+    }
+
+    // a record is not split at the end of the ring, so it wastes up to the
+    // size of one record -> a ring of two records of maximum size always
+    // takes a message of maximum size if it is empty
+    ringSize = 1024;
+    while (((int)ringSize < size) || (ringSize < 2 * GDOS_RECORD_SIZE_MAX))
+    {
+        ringSize <<= 1;
+    }
+
+    ringBuffer = (char *)malloc(GDOS_RING_NUM_MAX * ringSize);
+    batch      = (char *)malloc(GDOS_BATCH_SIZE);
+    if (!ringBuffer || !batch)
+    {
+        free(ringBuffer);
+        free(batch);
+        ringBuffer = NULL;
+        batch      = NULL;
+        return -ENOMEM;
+    }
+
+    for (i = 0; i < GDOS_RING_NUM_MAX; i++)
+    {
+        ring[i].head    = 0;
+        ring[i].tail    = 0;
+        ring[i].dropped = 0;
+        ring[i].buffer  = &ringBuffer[i * ringSize];
+    }
+    ringNum         = 0;
+    ringGeneration  = __sync_add_and_fetch(&gdos_generation, 1);
+    ringDropped     = 0;
+    droppedReported = 0;
+    batchLen        = 0;
+    batchLevel      = 0;
+    flushTerminate  = 0;
+
+    ret = flushTask.create(name, 0, prio,
+                           RACK_TASK_FPU | RACK_TASK_JOINABLE | RACK_TASK_CPU(cpu));
+    if (!ret)
+    {
+        ret = flushTask.start(&gdos_flush_task_proc, this);
+        if (ret)
+        {
+            flushTask.destroy();
+        }
+    }
+    if (ret)
+    {
+        free(ringBuffer);
+        free(batch);
+        ringBuffer = NULL;
+        batch      = NULL;
+        return ret;
+    }
+
+    gdos_barrier();
+    deferred = 1;
+
+    return 0;
+}
+
+// non realtime context
+void RackGdos::stopDeferred(void)
+{
+    if (!deferred)
+    {
+        return;
+    }
+
+    flushTerminate = 1;
+    flushTask.join();
+
+    flush();
+    deferred = 0;
+
+    free(ringBuffer);
+    free(batch);
+    ringBuffer = NULL;
+    batch      = NULL;
+}
+
+uint32_t RackGdos::getDropped(void)
+{
+    uint32_t    dropped = ringDropped;
+    int         i;
+
+    for (i = 0; i < GDOS_RING_NUM_MAX; i++)
+    {
+        dropped += ring[i].dropped;
+    }
+
+    return dropped;
+}
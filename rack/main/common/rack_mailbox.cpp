@@ -21,10 +21,18 @@
 #include <string.h>
 #include <errno.h>
 #include <sys/uio.h>
+#include <stdlib.h>
+
+#include <main/rack_task.h>
 
 // init bits
 #define     INIT_BIT_TIMS_MBX_CREATED       0
 
+// local delivery
+static int          localDelivery = 0;
+static RackMutex    localListMtx;
+static RackMailbox  *localList[RACK_MBX_LOCAL_NUM_MAX];
+
  /*!
  * @ingroup mailbox
  *
@@ -50,6 +58,95 @@ RackMailbox::RackMailbox()
     fd          = -1;
     addr         = 0;
     sendPrio    = 0;
+
+    localSlotNum = 0;
+    localDatalen = 0;
+    localSeqNum  = 0;
+    localBuffer  = NULL;
+    localRecv    = NULL;
+    localPeek    = -1;
+    localShared  = 0;
+
+    latestDatalen = 0;
+    latestOrder   = 0;
+    latestSpare   = NULL;
+    memset(latestEntry, 0, sizeof(latestEntry));
+}
+
+/**
+ * @brief Enable the local delivery of messages
+ *
+ * All mailboxes which are created after this call are registered in the
+ * process. Data messages between two registered mailboxes are handed over
+ * in a local slot of the receiver and TiMS transfers only the message head.
+ * Messages to other mailboxes are sent via TiMS.
+ *
+ * @a sendDataMsgReplyShared() hands over a pointer to the data of the sender
+ * if the receiver accepts it (see @a setSharedData()), otherwise the data is
+ * copied into the slot. @a peek() gives the receiver the slot data in place,
+ * the receive functions copy it into the given buffer. So a sender with a
+ * shared buffer and a receiver using @a peek() transfer a message without
+ * any copy. Every message still costs
+ * one TiMS message head and the wakeup of the receiver.
+ *
+ * This function is called by RackModuleHost before the modules are created.
+ *
+ * Environments:
+ *
+ * This service can be called from:
+ *
+ * - User-space task (non-RT)
+ *
+ * Rescheduling: never.
+ */
+void RackMailbox::enableLocalDelivery(void)
+{
+    if (!localDelivery)
+    {
+        localListMtx.create();
+        localDelivery = 1;
+    }
+}
+
+/**
+ * @brief Get the local delivery state
+ *
+ * @return 1 if the local delivery is enabled, otherwise 0
+ *
+ * Environments:
+ *
+ * This service can be called from:
+ *
+ * - User-space task (non-RT, RT)
+ *
+ * Rescheduling: never.
+ */
+int RackMailbox::getLocalDelivery(void)
+{
+    return localDelivery;
+}
+
+/**
+ * @brief Accept shared data from local senders
+ *
+ * If @a shared is set local senders may hand over their shared data (see
+ * @a sendDataMsgReplyShared()) and @a peek() points directly to the data of
+ * the sender. The receiver must not change the peeked data then. Otherwise
+ * the data is copied into the local slot and may be changed in place.
+ *
+ * @param shared 1 if the receiver only reads peeked data, otherwise 0
+ *
+ * Environments:
+ *
+ * This service can be called from:
+ *
+ * - User-space task (non-RT, RT)
+ *
+ * Rescheduling: never.
+ */
+void RackMailbox::setSharedData(int shared)
+{
+    localShared = shared;
 }
 
 /**
@@ -70,6 +167,10 @@ RackMailbox::RackMailbox()
  * @param bufferSize Size of the mailbox buffer (in bytes). This value is
  *                    only needed if the buffer pointer is not NULL.
  * @param sendPriority Message priority of all sent messages.
+ * @param flags Mailbox flags. If TIMS_MBX_LATEST is set the driver keeps
+ *              only the newest unread message of every sender (latest-value
+ *              mailbox). This is supported by the Xenomai driver, the Linux
+ *              TCP backend queues all messages (see @a recvLatest()).
  *
  * @return 0 on success, otherwise negative error code
  *
@@ -83,14 +184,15 @@ RackMailbox::RackMailbox()
  */
 int RackMailbox::create(uint32_t address, int messageSlots,
                         ssize_t maxDatalen, void *buffer,
-                        ssize_t bufferSize, int8_t sendPriority)
+                        ssize_t bufferSize, int8_t sendPriority, int flags)
 {
     ssize_t maxMsglen = maxDatalen + TIMS_HEADLEN;
 
     sendMtx.create();
     recvMtx.create();
 
-    fd = tims_mbx_create(address, messageSlots, maxMsglen, buffer, bufferSize);
+    fd = tims_mbx_create(address, messageSlots, maxMsglen, buffer, bufferSize,
+                         flags);
 
     if (fd < 0)
     {
@@ -106,6 +208,14 @@ int RackMailbox::create(uint32_t address, int messageSlots,
     addr         = address;
     sendPrio    = sendPriority;
 
+    latestDatalen = maxDatalen;
+
+    if (localDelivery)
+    {
+        // without local slots the mailbox is reachable via TiMS only
+        createLocal(messageSlots, maxDatalen);
+    }
+
     return 0;
 }
 
@@ -129,6 +239,9 @@ int RackMailbox::remove(void)
 {
     int ret;
 
+    removeLocal();
+    removeLatest();
+
     ret = tims_mbx_remove(fd);
 
     fd          = -1;
@@ -164,6 +277,9 @@ int RackMailbox::clean(void)
 
     ret = tims_mbx_clean(fd, addr);
 
+    cleanLocal();
+    cleanLatest();
+
     recvMtx.unlock();
 
     return ret;
@@ -307,7 +423,7 @@ int RackMailbox::sendDataMsg(int8_t type, uint32_t dest, uint8_t seqNr,
 
     tims_fill_head(&head, type, dest, addr, sendPrio, seqNr, 0, msglen);
 
-    ret = tims_sendmsg(fd, &head, iov, dataPointers, 0);
+    ret = sendIov(&head, iov, dataPointers);
 
     sendMtx.unlock();
 
@@ -369,7 +485,7 @@ int RackMailbox::sendDataMsg(tims_msg_head *p_head, int dataPointers, void* data
 
     p_head->msglen = msglen;
 
-    ret = tims_sendmsg(fd, p_head, iov, dataPointers, 0);
+    ret = sendIov(p_head, iov, dataPointers);
 
     sendMtx.unlock();
 
@@ -434,7 +550,62 @@ int RackMailbox::sendDataMsgReply(int8_t type, RackMessage* msgInfo,
 
     tims_fill_head(&head, type, msgInfo->getSrc(), addr, msgInfo->getPriority(), msgInfo->getSeqNr(), 0, msglen);
 
-    ret = tims_sendmsg(fd, &head, iov, dataPointers, 0);
+    ret = sendIov(&head, iov, dataPointers);
+
+    sendMtx.unlock();
+
+    if (ret < 0)
+        return ret;
+
+    if (ret != (int)msglen)
+       return -EFAULT;
+
+    return 0;
+}
+
+/**
+ * @brief Send a reply data message from a shared buffer
+ *
+ * This function sends a reply message like @a sendDataMsgReply(). If the
+ * receiver is a local mailbox (see @a enableLocalDelivery()) which accepts
+ * shared data (see @a setSharedData()) the slot of the receiver points to
+ * the data of the sender and the data isn't copied.
+ * Every local receiver increments the reference counter @a refs while it
+ * holds the data. The sender must not change or free the buffer as long as
+ * the counter is not 0. Messages to other mailboxes are copied via TiMS.
+ *
+ * @param type Message type
+ * @param msgInfo Message info of the previously received message
+ * @param data Pointer to the shared data buffer
+ * @param datalen Length of the data buffer
+ * @param refs Pointer to the reference counter of the data buffer
+ *
+ * @return 0 on success, otherwise negative error code
+ *
+ * Environments:
+ *
+ * This service can be called from:
+ *
+ * - User-space task (non-RT, RT)
+ *
+ * Rescheduling: possible
+ */
+int RackMailbox::sendDataMsgReplyShared(int8_t type, RackMessage* msgInfo,
+                                        void *data, uint32_t datalen, int *refs)
+{
+    uint32_t        msglen = datalen + TIMS_HEADLEN;
+    int32_t         ret;
+    tims_msg_head   head;
+    struct iovec    iov[1];
+
+    sendMtx.lock();
+
+    iov[0].iov_base = data;
+    iov[0].iov_len  = datalen;
+
+    tims_fill_head(&head, type, msgInfo->getSrc(), addr, msgInfo->getPriority(), msgInfo->getSeqNr(), 0, msglen);
+
+    ret = sendIov(&head, iov, 1, refs);
 
     sendMtx.unlock();
 
@@ -462,6 +633,9 @@ int RackMailbox::sendDataMsgReply(int8_t type, RackMessage* msgInfo,
  *
  * This function can only be called if the mailbox is created in userspace.
  * Userspace tasks can't access kernel mailboxes using @a peek().
+ * Mailboxes with local slots (see @a enableLocalDelivery()) are an exception,
+ * they hand out local messages in their slot and receive all other messages
+ * into a peek buffer of the mailbox.
  *
  * If no message is inside the mailbox @a peek() is blocking until
  * a message is received.
@@ -491,6 +665,14 @@ int RackMailbox::sendDataMsgReply(int8_t type, RackMessage* msgInfo,
 
     recvMtx.lock();
 
+    if (localBuffer)
+    {
+        ret = peekRecv(TIMS_INFINITE, msgInfo);
+        if (ret)
+            recvMtx.unlock();
+        return ret;
+    }
+
     ret = tims_peek_timed(fd, &p_peek_head, TIMS_INFINITE);
 
     if (ret < 0)
@@ -500,6 +682,19 @@ int RackMailbox::sendDataMsgReply(int8_t type, RackMessage* msgInfo,
     }
 
     memcpy(msgInfo->getHead(), p_peek_head, sizeof(tims_msg_head));
+
+    if (msgInfo->getHead()->flags & RACK_MBX_HEAD_LOCAL)
+    {
+        ret = peekLocal(msgInfo);
+        if (ret)
+        {
+            tims_peek_end(fd);
+            recvMtx.unlock();
+            return ret;
+        }
+        return 0;
+    }
+
     msgInfo->datalen = msgInfo->getHead()->msglen - TIMS_HEADLEN;
     msgInfo->p_data = &p_peek_head->data;
 
@@ -546,6 +741,14 @@ int RackMailbox::peekTimed(uint64_t timeout_ns, RackMessage *msgInfo)
 
     recvMtx.lock();
 
+    if (localBuffer)
+    {
+        ret = peekRecv(timeout_ns, msgInfo);
+        if (ret)
+            recvMtx.unlock();
+        return ret;
+    }
+
     ret = tims_peek_timed(fd, &p_peek_head, timeout_ns);
 
     if (ret < 0)
@@ -555,6 +758,19 @@ int RackMailbox::peekTimed(uint64_t timeout_ns, RackMessage *msgInfo)
     }
 
     memcpy(msgInfo->getHead(), p_peek_head, sizeof(tims_msg_head));
+
+    if (msgInfo->getHead()->flags & RACK_MBX_HEAD_LOCAL)
+    {
+        ret = peekLocal(msgInfo);
+        if (ret)
+        {
+            tims_peek_end(fd);
+            recvMtx.unlock();
+            return ret;
+        }
+        return 0;
+    }
+
     msgInfo->datalen = msgInfo->getHead()->msglen - TIMS_HEADLEN;
     msgInfo->p_data = &p_peek_head->data;
 
@@ -600,6 +816,14 @@ int RackMailbox::peekIf(RackMessage *msgInfo)
 
     recvMtx.lock();
 
+    if (localBuffer)
+    {
+        ret = peekRecv(TIMS_NONBLOCK, msgInfo);
+        if (ret)
+            recvMtx.unlock();
+        return ret;
+    }
+
     ret = tims_peek_timed(fd, &p_peek_head, TIMS_NONBLOCK);
 
     if (ret < 0)
@@ -609,6 +833,19 @@ int RackMailbox::peekIf(RackMessage *msgInfo)
     }
 
     memcpy(msgInfo->getHead(), p_peek_head, sizeof(tims_msg_head));
+
+    if (msgInfo->getHead()->flags & RACK_MBX_HEAD_LOCAL)
+    {
+        ret = peekLocal(msgInfo);
+        if (ret)
+        {
+            tims_peek_end(fd);
+            recvMtx.unlock();
+            return ret;
+        }
+        return 0;
+    }
+
     msgInfo->datalen = msgInfo->getHead()->msglen - TIMS_HEADLEN;
     msgInfo->p_data = &p_peek_head->data;
 
@@ -635,6 +872,19 @@ int RackMailbox::peekEnd(void)
 {
     int ret;
 
+    if (localPeek >= 0)
+    {
+        freeLocal(localPeek);
+        localPeek = -1;
+    }
+
+    // the message was received by peekRecv()
+    if (localBuffer)
+    {
+        recvMtx.unlock();
+        return 0;
+    }
+
     ret = tims_peek_end(fd);
 
     recvMtx.unlock();
@@ -679,6 +929,9 @@ int RackMailbox::recvMsg(RackMessage *msgInfo)
 
     ret = tims_recvmsg_timed(fd, msgInfo->getHead(), NULL, 0, TIMS_INFINITE, 0);
 
+    if ((ret >= 0) && (msgInfo->getHead()->flags & RACK_MBX_HEAD_LOCAL))
+        ret = recvLocal(msgInfo->getHead(), NULL, 0);
+
     recvMtx.unlock();
 
     if (ret < 0)
@@ -724,6 +977,9 @@ int RackMailbox::recvMsgTimed(uint64_t timeout_ns, RackMessage *msgInfo)
 
     ret = tims_recvmsg_timed(fd, msgInfo->getHead(), NULL, 0, timeout_ns, 0);
 
+    if ((ret >= 0) && (msgInfo->getHead()->flags & RACK_MBX_HEAD_LOCAL))
+        ret = recvLocal(msgInfo->getHead(), NULL, 0);
+
     recvMtx.unlock();
 
     if (ret < 0)
@@ -768,6 +1024,9 @@ int     RackMailbox::recvMsgIf(RackMessage *msgInfo)
 
     ret = tims_recvmsg_timed(fd, msgInfo->getHead(), NULL, 0, TIMS_NONBLOCK, 0);
 
+    if ((ret >= 0) && (msgInfo->getHead()->flags & RACK_MBX_HEAD_LOCAL))
+        ret = recvLocal(msgInfo->getHead(), NULL, 0);
+
     recvMtx.unlock();
 
     if (ret < 0)
@@ -814,6 +1073,9 @@ int     RackMailbox::recvDataMsg(void *p_data, uint32_t maxDatalen, RackMessage
 
     ret = tims_recvmsg_timed(fd, msgInfo->getHead(), p_data, maxDatalen, TIMS_INFINITE, 0);
 
+    if ((ret >= 0) && (msgInfo->getHead()->flags & RACK_MBX_HEAD_LOCAL))
+        ret = recvLocal(msgInfo->getHead(), p_data, maxDatalen);
+
     recvMtx.unlock();
 
     if (ret < 0)
@@ -861,6 +1123,9 @@ int     RackMailbox::recvDataMsgTimed(uint64_t timeout_ns, void *p_data, uint32_
 
     ret = tims_recvmsg_timed(fd, msgInfo->getHead(), p_data, maxDatalen, timeout_ns, 0);
 
+    if ((ret >= 0) && (msgInfo->getHead()->flags & RACK_MBX_HEAD_LOCAL))
+        ret = recvLocal(msgInfo->getHead(), p_data, maxDatalen);
+
     recvMtx.unlock();
 
     if (ret < 0)
@@ -907,6 +1172,9 @@ int     RackMailbox::recvDataMsgIf(void *p_data, uint32_t maxDatalen, RackMessag
 
     ret = tims_recvmsg_timed(fd, msgInfo->getHead(), p_data, maxDatalen, TIMS_NONBLOCK, 0);
 
+    if ((ret >= 0) && (msgInfo->getHead()->flags & RACK_MBX_HEAD_LOCAL))
+        ret = recvLocal(msgInfo->getHead(), p_data, maxDatalen);
+
     recvMtx.unlock();
 
     if (ret < 0)
@@ -918,4 +1186,606 @@ int     RackMailbox::recvDataMsgIf(void *p_data, uint32_t maxDatalen, RackMessag
     return 0;
 }
 
+/**
+ * @brief Receive the newest message (with data - timeout blocking)
+ *
+ * This function receives all messages which are inside the mailbox and keeps
+ * only the newest message of every sender (source address, message type and
+ * priority). One of these messages is returned, the senders take turns in
+ * the order of their first kept message. Older messages of the same sender
+ * are dropped. If no message is inside the mailbox this function waits for
+ * the next one.
+ *
+ * The kept messages are buffered in the mailbox object, so a newer message
+ * replaces an older one by swapping the buffers. The Linux TCP backend has
+ * to read every message out of the socket, the Xenomai driver drops older
+ * messages itself if the mailbox is created with TIMS_MBX_LATEST.
+ *
+ * Up to RACK_MBX_LATEST_SRC_MAX senders are kept, messages of further
+ * senders stay in the mailbox until the next call. Don't mix this function
+ * with the other receive functions on the same mailbox.
+ *
+ * @param timeout_ns Receive timeout in nanoceconds
+ * @param p_data Pointer to the receive data buffer
+ * @param maxDatalen Size of the receive data buffer
+ * @param msgInfo Pointer to a @a RackMessage
+ *
+ * @return 0 on success, otherwise negative error code
+ *
+ * Environments:
+ *
+ * This service can be called from:
+ *
+ * - User-space task (RT)
+ *
+ * Rescheduling: possible
+ */
+int     RackMailbox::recvLatestTimed(uint64_t timeout_ns, void *p_data, uint32_t maxDatalen, RackMessage *msgInfo)
+{
+    return recvLatestIntern(timeout_ns, p_data, maxDatalen, msgInfo);
+}
+
+/**
+ * @brief Receive the newest message (with data - non-blocking)
+ *
+ * This function receives the newest message of a sender and drops its
+ * older messages (see @a recvLatestTimed()).
+ *
+ * If no message is inside the mailbox @a recvLatest() returns immediately
+ * with the returncode -EWOULDBLOCK.
+ *
+ * @param p_data Pointer to the receive data buffer
+ * @param maxDatalen Size of the receive data buffer
+ * @param msgInfo Pointer to a @a RackMessage
+ *
+ * @return 0 on success, otherwise negative error code
+ *
+ * Environments:
+ *
+ * This service can be called from:
+ *
+ * - User-space task (RT)
+ *
+ * Rescheduling: none
+ */
+int     RackMailbox::recvLatest(void *p_data, uint32_t maxDatalen, RackMessage *msgInfo)
+{
+    return recvLatestIntern(TIMS_NONBLOCK, p_data, maxDatalen, msgInfo);
+}
+
+int     RackMailbox::recvLatestIntern(int64_t timeout_ns, void *p_data, uint32_t maxDatalen, RackMessage *msgInfo)
+{
+    rack_mbx_latest_entry   *p_entry;
+    uint32_t                datalen;
+    int                     i, ret;
+
+    recvMtx.lock();
+
+    ret = latestDrain(TIMS_NONBLOCK);
+    i   = latestNext();
+
+    // wait for the next message
+    if ((i < 0) && (ret == -EWOULDBLOCK) && (timeout_ns != TIMS_NONBLOCK))
+    {
+        ret = latestDrain(timeout_ns);
+        i   = latestNext();
+    }
+
+    // an error of a dropped message doesn't discard the kept ones
+    if (i < 0)
+    {
+        recvMtx.unlock();
+        return ret ? ret : -EWOULDBLOCK;
+    }
+
+    p_entry        = &latestEntry[i];
+    p_entry->valid = 0;
+
+    memcpy(msgInfo->getHead(), &p_entry->head, sizeof(tims_msg_head));
+    datalen = p_entry->head.msglen - TIMS_HEADLEN;
+
+    if (datalen > maxDatalen)
+    {
+        recvMtx.unlock();
+        return -EMSGSIZE;
+    }
+
+    if (datalen)
+        memcpy(p_data, p_entry->data, datalen);
+
+    recvMtx.unlock();
+
+    msgInfo->datalen = datalen;
+    msgInfo->p_data = p_data;
+
+    return 0;
+}
+
 /*@}*/
+
+//
+// latest-value receive
+//
+
+// receive messages until the mailbox is empty, the first one with timeout
+int     RackMailbox::latestDrain(int64_t timeout_ns)
+{
+    rack_mbx_latest_entry   *p_entry;
+    tims_msg_head           head;
+    void                    *p_swap;
+    int                     i, ret;
+
+    while (1)
+    {
+        // free entry for a new sender
+        for (i = 0; i < RACK_MBX_LATEST_SRC_MAX; i++)
+        {
+            if (!latestEntry[i].valid)
+                break;
+        }
+        if (i == RACK_MBX_LATEST_SRC_MAX)
+            return 0;
+
+        if (!latestSpare && latestDatalen)
+        {
+            latestSpare = malloc(latestDatalen);
+            if (!latestSpare)
+                return -ENOMEM;
+        }
+
+        ret = tims_recvmsg_timed(fd, &head, latestSpare, latestDatalen, timeout_ns, 0);
+        if ((ret >= 0) && (head.flags & RACK_MBX_HEAD_LOCAL))
+            ret = recvLocal(&head, latestSpare, latestDatalen);
+
+        timeout_ns = TIMS_NONBLOCK;
+
+        // drop a broken message, keep on receiving
+        if (ret == -EMSGSIZE)
+            continue;
+        if (ret < 0)
+            return ret;
+
+        // replace the message of the same sender
+        p_entry = &latestEntry[i];
+        for (i = 0; i < RACK_MBX_LATEST_SRC_MAX; i++)
+        {
+            if (latestEntry[i].valid &&
+                (latestEntry[i].head.src      == head.src) &&
+                (latestEntry[i].head.type     == head.type) &&
+                (latestEntry[i].head.priority == head.priority))
+            {
+                p_entry = &latestEntry[i];
+                break;
+            }
+        }
+
+        if (!p_entry->valid)
+        {
+            p_entry->valid = 1;
+            p_entry->order = latestOrder++;
+        }
+
+        memcpy(&p_entry->head, &head, sizeof(tims_msg_head));
+
+        p_swap         = p_entry->data;
+        p_entry->data  = latestSpare;
+        latestSpare    = p_swap;
+    }
+}
+
+// kept message of the sender with the oldest turn
+int     RackMailbox::latestNext(void)
+{
+    int i, next = -1;
+
+    for (i = 0; i < RACK_MBX_LATEST_SRC_MAX; i++)
+    {
+        if (latestEntry[i].valid &&
+            ((next < 0) ||
+             ((int32_t)(latestEntry[i].order - latestEntry[next].order) < 0)))
+        {
+            next = i;
+        }
+    }
+
+    return next;
+}
+
+void    RackMailbox::cleanLatest(void)
+{
+    int i;
+
+    for (i = 0; i < RACK_MBX_LATEST_SRC_MAX; i++)
+        latestEntry[i].valid = 0;
+}
+
+void    RackMailbox::removeLatest(void)
+{
+    int i;
+
+    for (i = 0; i < RACK_MBX_LATEST_SRC_MAX; i++)
+    {
+        if (latestEntry[i].data)
+            free(latestEntry[i].data);
+        latestEntry[i].data  = NULL;
+        latestEntry[i].valid = 0;
+    }
+
+    if (latestSpare)
+        free(latestSpare);
+    latestSpare   = NULL;
+    latestDatalen = 0;
+}
+
+//
+// local delivery
+//
+
+int RackMailbox::createLocal(int messageSlots, uint32_t maxDatalen)
+{
+    int i;
+
+    if ((messageSlots <= 0) || (maxDatalen < RACK_MBX_LOCAL_DATALEN_MIN))
+        return -EINVAL;
+
+    localSlotNum = messageSlots;
+    if (localSlotNum > RACK_MBX_LOCAL_SLOT_MAX)
+        localSlotNum = RACK_MBX_LOCAL_SLOT_MAX;
+
+    // 8 byte aligned slots and the peek buffer of TiMS messages
+    localDatalen = (maxDatalen + 7) & ~7;
+    localBuffer  = malloc((localSlotNum + 1) * localDatalen);
+    if (!localBuffer)
+    {
+        localSlotNum = 0;
+        return -ENOMEM;
+    }
+
+    for (i = 0; i < localSlotNum; i++)
+    {
+        localSlot[i].state  = RACK_MBX_SLOT_FREE;
+        localSlot[i].buffer = (char *)localBuffer + i * localDatalen;
+        localSlot[i].data   = localSlot[i].buffer;
+        localSlot[i].refs   = NULL;
+    }
+    localRecv    = (char *)localBuffer + localSlotNum * localDatalen;
+    localDatalen = maxDatalen;
+    localSeqNum  = 0;
+    localPeek    = -1;
+    localMtx.create();
+
+    // register mailbox
+    localListMtx.lock();
+    for (i = 0; i < RACK_MBX_LOCAL_NUM_MAX; i++)
+    {
+        if (!localList[i])
+        {
+            localList[i] = this;
+            break;
+        }
+    }
+    localListMtx.unlock();
+
+    if (i == RACK_MBX_LOCAL_NUM_MAX)
+    {
+        removeLocal();
+        return -ENOSPC;
+    }
+
+    return 0;
+}
+
+void RackMailbox::removeLocal(void)
+{
+    int i, writing;
+
+    if (!localBuffer)
+        return;
+
+    // unregister mailbox
+    localListMtx.lock();
+    for (i = 0; i < RACK_MBX_LOCAL_NUM_MAX; i++)
+    {
+        if (localList[i] == this)
+        {
+            localList[i] = NULL;
+        }
+    }
+    localListMtx.unlock();
+
+    // wait for senders which still copy data into the slots
+    do
+    {
+        writing = 0;
+
+        localMtx.lock();
+        for (i = 0; i < localSlotNum; i++)
+        {
+            if (localSlot[i].state == RACK_MBX_SLOT_WRITE)
+                writing++;
+        }
+        localMtx.unlock();
+
+        if (writing)
+            RackTask::sleep(1000000llu);
+    }
+    while (writing);
+
+    // release the shared data of the senders
+    localMtx.lock();
+    for (i = 0; i < localSlotNum; i++)
+    {
+        releaseLocal(&localSlot[i]);
+    }
+    localMtx.unlock();
+
+    localMtx.destroy();
+    free(localBuffer);
+
+    localBuffer  = NULL;
+    localRecv    = NULL;
+    localSlotNum = 0;
+    localPeek    = -1;
+}
+
+void RackMailbox::cleanLocal(void)
+{
+    int i;
+
+    if (!localBuffer)
+        return;
+
+    localMtx.lock();
+    for (i = 0; i < localSlotNum; i++)
+    {
+        if (localSlot[i].state == RACK_MBX_SLOT_READY)
+            releaseLocal(&localSlot[i]);
+    }
+    localMtx.unlock();
+}
+
+// frees the slot and all older slots of the same sender, their messages
+// were dropped by the mailbox (full or latest-value mailbox)
+void RackMailbox::freeLocal(int slot)
+{
+    int i;
+    rack_mbx_local_slot *p_slot = &localSlot[slot];
+
+    localMtx.lock();
+    for (i = 0; i < localSlotNum; i++)
+    {
+        if ((i != slot) &&
+            (localSlot[i].state    == RACK_MBX_SLOT_READY) &&
+            (localSlot[i].src      == p_slot->src) &&
+            (localSlot[i].type     == p_slot->type) &&
+            (localSlot[i].priority == p_slot->priority) &&
+            ((int32_t)(localSlot[i].seqNum - p_slot->seqNum) < 0))
+        {
+            releaseLocal(&localSlot[i]);
+        }
+    }
+    releaseLocal(p_slot);
+    localMtx.unlock();
+}
+
+// frees the slot and drops its reference of shared data,
+// localMtx has to be locked
+void RackMailbox::releaseLocal(rack_mbx_local_slot *p_slot)
+{
+    if (p_slot->refs)
+    {
+        __sync_fetch_and_sub(p_slot->refs, 1);
+        p_slot->refs = NULL;
+        p_slot->data = p_slot->buffer;
+    }
+    p_slot->state = RACK_MBX_SLOT_FREE;
+}
+
+int RackMailbox::sendIov(tims_msg_head *p_head, struct iovec *iov, int iovNum,
+                         int *refs)
+{
+    int ret;
+
+    if (localDelivery &&
+        (p_head->msglen >= TIMS_HEADLEN + RACK_MBX_LOCAL_DATALEN_MIN))
+    {
+        ret = sendLocal(p_head, iov, iovNum, refs);
+        if (ret != -ENOENT)
+            return ret;
+    }
+
+    return tims_sendmsg(fd, p_head, iov, iovNum, 0);
+}
+
+// hands the data over in a local slot of the receiver and sends the head
+// via TiMS, returns -ENOENT if the message has to be sent via TiMS.
+// With a reference counter the slot points to the shared data of the sender,
+// otherwise the data is copied into the slot.
+int RackMailbox::sendLocal(tims_msg_head *p_head, struct iovec *iov, int iovNum,
+                           int *refs)
+{
+    RackMailbox     *p_dest = NULL;
+    tims_msg_head   head;
+    uint32_t        datalen = p_head->msglen - TIMS_HEADLEN;
+    char            *p_data;
+    int             i, slot = -1;
+    uint32_t        seqNum = 0;
+    int             ret;
+
+    // get a free slot of the receiver
+    localListMtx.lock();
+    for (i = 0; i < RACK_MBX_LOCAL_NUM_MAX; i++)
+    {
+        if (localList[i] && (localList[i]->addr == p_head->dest))
+        {
+            p_dest = localList[i];
+            break;
+        }
+    }
+
+    if (p_dest && (datalen <= p_dest->localDatalen))
+    {
+        p_dest->localMtx.lock();
+        for (i = 0; i < p_dest->localSlotNum; i++)
+        {
+            if (p_dest->localSlot[i].state == RACK_MBX_SLOT_FREE)
+            {
+                slot = i;
+                p_dest->localSlot[i].state    = RACK_MBX_SLOT_WRITE;
+                p_dest->localSlot[i].src      = p_head->src;
+                p_dest->localSlot[i].type     = p_head->type;
+                p_dest->localSlot[i].priority = p_head->priority;
+                p_dest->localSlot[i].seqNum   = p_dest->localSeqNum++;
+                p_dest->localSlot[i].datalen  = datalen;
+                seqNum = p_dest->localSlot[i].seqNum;
+                break;
+            }
+        }
+        p_dest->localMtx.unlock();
+    }
+    localListMtx.unlock();
+
+    if (slot < 0)
+        return -ENOENT;
+
+    if (refs && (iovNum == 1) && p_dest->localShared)
+    {
+        // the receiver reads the shared data of the sender
+        __sync_fetch_and_add(refs, 1);
+        p_dest->localSlot[slot].refs = refs;
+        p_dest->localSlot[slot].data = iov[0].iov_base;
+    }
+    else
+    {
+        // copy data into the slot of the receiver
+        p_data = (char *)p_dest->localSlot[slot].data;
+        for (i = 0; i < iovNum; i++)
+        {
+            memcpy(p_data, iov[i].iov_base, iov[i].iov_len);
+            p_data += iov[i].iov_len;
+        }
+    }
+
+    p_dest->localMtx.lock();
+    p_dest->localSlot[slot].state = RACK_MBX_SLOT_READY;
+    p_dest->localMtx.unlock();
+
+    // send message head
+    memcpy(&head, p_head, sizeof(tims_msg_head));
+    head.flags  |= RACK_MBX_HEAD_LOCAL | (slot << RACK_MBX_HEAD_SLOT_SHIFT);
+    head.msglen  = TIMS_HEADLEN;
+
+    ret = tims_sendmsg(fd, &head, NULL, 0, 0);
+    if (ret < 0)
+    {
+        // free the slot if the receiver still exists and didn't clean it
+        localListMtx.lock();
+        for (i = 0; i < RACK_MBX_LOCAL_NUM_MAX; i++)
+        {
+            if (localList[i] == p_dest)
+            {
+                p_dest->localMtx.lock();
+                if ((p_dest->localSlot[slot].state  == RACK_MBX_SLOT_READY) &&
+                    (p_dest->localSlot[slot].seqNum == seqNum))
+                    p_dest->releaseLocal(&p_dest->localSlot[slot]);
+                p_dest->localMtx.unlock();
+                break;
+            }
+        }
+        localListMtx.unlock();
+        return ret;
+    }
+
+    return p_head->msglen;
+}
+
+int RackMailbox::recvLocal(tims_msg_head *p_head, void *p_data, uint32_t maxDatalen)
+{
+    int                 slot = (p_head->flags & RACK_MBX_HEAD_SLOT_MASK) >>
+                               RACK_MBX_HEAD_SLOT_SHIFT;
+    rack_mbx_local_slot *p_slot;
+    int                 ret = 0;
+
+    if (slot >= localSlotNum)
+        return -EFAULT;
+
+    p_slot = &localSlot[slot];
+
+    localMtx.lock();
+    if ((p_slot->state != RACK_MBX_SLOT_READY) || (p_slot->src != p_head->src))
+    {
+        localMtx.unlock();
+        return -EFAULT;
+    }
+    p_slot->state = RACK_MBX_SLOT_READ;
+    localMtx.unlock();
+
+    p_head->flags  &= ~(RACK_MBX_HEAD_LOCAL | RACK_MBX_HEAD_SLOT_MASK);
+    p_head->msglen  = TIMS_HEADLEN + p_slot->datalen;
+
+    if (p_data)
+    {
+        if (p_slot->datalen > maxDatalen)
+            ret = -EMSGSIZE;
+        else
+            memcpy(p_data, p_slot->data, p_slot->datalen);
+    }
+
+    freeLocal(slot);
+
+    return ret;
+}
+
+int RackMailbox::peekLocal(RackMessage *msgInfo)
+{
+    tims_msg_head       *p_head = msgInfo->getHead();
+    int                 slot    = (p_head->flags & RACK_MBX_HEAD_SLOT_MASK) >>
+                                  RACK_MBX_HEAD_SLOT_SHIFT;
+    rack_mbx_local_slot *p_slot;
+
+    if (slot >= localSlotNum)
+        return -EFAULT;
+
+    p_slot = &localSlot[slot];
+
+    localMtx.lock();
+    if ((p_slot->state != RACK_MBX_SLOT_READY) || (p_slot->src != p_head->src))
+    {
+        localMtx.unlock();
+        return -EFAULT;
+    }
+    p_slot->state = RACK_MBX_SLOT_PEEK;
+    localMtx.unlock();
+
+    // the receiver works on the data in the local slot without copying
+    p_head->flags  &= ~(RACK_MBX_HEAD_LOCAL | RACK_MBX_HEAD_SLOT_MASK);
+    p_head->msglen  = TIMS_HEADLEN + p_slot->datalen;
+
+    msgInfo->datalen = p_slot->datalen;
+    msgInfo->p_data  = p_slot->data;
+    localPeek        = slot;
+
+    return 0;
+}
+
+// peek of a mailbox with local slots, recvMtx has to be locked.
+// TiMS messages are received into the peek buffer, local messages are
+// handed out in their slot.
+int RackMailbox::peekRecv(int64_t timeout_ns, RackMessage *msgInfo)
+{
+    int ret;
+
+    ret = tims_recvmsg_timed(fd, msgInfo->getHead(), localRecv, localDatalen,
+                             timeout_ns, 0);
+    if (ret < 0)
+        return ret;
+
+    if (msgInfo->getHead()->flags & RACK_MBX_HEAD_LOCAL)
+        return peekLocal(msgInfo);
+
+    msgInfo->datalen = msgInfo->getHead()->msglen - TIMS_HEADLEN;
+    msgInfo->p_data  = localRecv;
+
+    return 0;
+}
+
@@ -44,6 +44,7 @@
 #define INIT_BIT_CMDTSK_STARTED         3
 #define INIT_BIT_DATATSK_STARTED        4
 #define INIT_BIT_MALLOC_PARAM_MSG       5
+#define INIT_BIT_GDOS_DEFERRED          6
 
 class MbxListHead : public ListHead {
 
@@ -79,6 +80,9 @@ arg_table_t module_argTab[] = {
   {ARGOPT_OPT, "gdosLevel", ARGOPT_REQVAL, ARGOPT_VAL_INT,
    "GDOS level (0:print, 1:error, 2:warning, 3:info, 4:detail), [2]", { 2 } },
 
+  {ARGOPT_OPT, "gdosRingSize", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+   "size of the deferred GDOS messages of each task [byte] (0 = send immediately), [0]", { 0 } },
+
   {ARGOPT_OPT, "targetStatus", ARGOPT_REQVAL, ARGOPT_VAL_INT,
    "target status (0:off, 1:on), [0])", { 0 } },
 
@@ -98,12 +102,22 @@ arg_table_t module_argTab[] = {
 };
 
 //
-// arguments
+// arguments of the module which is created next (see save_argTab),
+// every module copies them in its constructor
 //
 
 static arg_table_t* arg_table;
 static char classname[50];
 
+// name of the process in the signal handler
+static char process_name[50];
+
+//
+// module host
+//
+
+static int module_hosted = 0;
+
 //
 // command task
 //
@@ -365,6 +379,11 @@ RackModule::RackModule( uint32_t classId,
 {
     gdosLevel = GDOS_MSG_DEBUG_BEGIN - getIntArg("gdosLevel", module_argTab);
     gdos = new RackGdos(gdosLevel);
+    gdosRingSize = getIntArg("gdosRingSize", module_argTab);
+
+    // start arguments of this module
+    argTable = arg_table;
+    strncpy(className, classname, sizeof(className));
 
     // get instance from module_argTab
     instance                  = getIntArg("instance", module_argTab);
@@ -416,6 +435,7 @@ RackModule::RackModule( uint32_t classId,
 
 RackModule::~RackModule()
 {
+    exit_signal_handler(this);
     delete gdos;
 }
 
@@ -486,7 +506,8 @@ int       RackModule::mailboxCreate(RackMailbox *p_mbx, uint32_t adr, int slots,
     p_new->add_tail(&mbxList);
 
     // create
-    ret = p_mbx->create(adr, slots, data_size, buffer, buffersize, prio );
+    ret = p_mbx->create(adr, slots, data_size, buffer, buffersize, prio,
+                        (flags & MBX_LATEST) ? TIMS_MBX_LATEST : 0);
     if (ret)
     {
         GDOS_ERROR("mailboxCreate: Can't create mailbox %x, slots: %d, datasize: %d,"
@@ -497,13 +518,15 @@ int       RackModule::mailboxCreate(RackMailbox *p_mbx, uint32_t adr, int slots,
     p_new->flags |= RACKMBX_CREATED;
     if (buffer)
     {
-        GDOS_DBG_INFO("MAILBOX: adr: %x, slots: %d, data/msg: %d, size %d, prio: %d, USER\n",
-                    adr, slots, data_size, buffersize, prio);
+        GDOS_DBG_INFO("MAILBOX: adr: %x, slots: %d, data/msg: %d, size %d, prio: %d, USER%s\n",
+                    adr, slots, data_size, buffersize, prio,
+                    (flags & MBX_LATEST) ? ", LATEST" : "");
     }
     else
     {
-        GDOS_DBG_INFO("MAILBOX: adr: %x, slots: %d, data/msg: %d, size %d, prio: %d, KERNEL\n",
-                    adr, slots, data_size, buffersize, prio);
+        GDOS_DBG_INFO("MAILBOX: adr: %x, slots: %d, data/msg: %d, size %d, prio: %d, KERNEL%s\n",
+                    adr, slots, data_size, buffersize, prio,
+                    (flags & MBX_LATEST) ? ", LATEST" : "");
     }
     return 0;
 
@@ -727,7 +750,7 @@ int       RackModule::moduleInit(void)
     ret = createCmdMbx();
     if (ret)
     {
-        printf("%s error: Can't create command mailbox (%x), code %d\n", classname, name, ret);
+        printf("%s error: Can't create command mailbox (%x), code %d\n", className, name, ret);
         goto exit_error;
     }
     moduleInitBits.setBit(INIT_BIT_CMDMBX_CREATED);
@@ -741,7 +764,7 @@ int       RackModule::moduleInit(void)
     GDOS_PRINT("Init\n");
 
     // init rack time
-    ret = rackTime.init(cmdMbx.getFd());
+    ret = rackTime.init(cmdMbx.getFd(), systemId);
     if (ret)
     {
         GDOS_ERROR("Can't init rack time, code = %d\n", ret);
@@ -758,7 +781,7 @@ int       RackModule::moduleInit(void)
     srand((unsigned int)rackTime.get());
 
     // create command task
-    snprintf(cmdTaskName, sizeof(cmdTaskName), "%.28s%u%uC", classname,
+    snprintf(cmdTaskName, sizeof(cmdTaskName), "%.28s%u%uC", className,
              (unsigned int)systemId, (unsigned int)instance);
 
     ret = cmdTask.create(cmdTaskName, 0, cmdTaskPrio,
@@ -771,7 +794,7 @@ int       RackModule::moduleInit(void)
     moduleInitBits.setBit(INIT_BIT_CMDTSK_CREATED);
 
     // create data task
-    snprintf(dataTaskName, sizeof(dataTaskName), "%.28s%u%uD", classname,
+    snprintf(dataTaskName, sizeof(dataTaskName), "%.28s%u%uD", className,
              (unsigned int)systemId, (unsigned int)instance);
 
     ret = dataTask.create(dataTaskName, 0, dataTaskPrio,
@@ -783,9 +806,24 @@ int       RackModule::moduleInit(void)
     }
     moduleInitBits.setBit(INIT_BIT_DATATSK_CREATED);
 
+    // defer the GDOS messages to a flush task
+    if (gdosRingSize > 0)
+    {
+        snprintf(gdosTaskName, sizeof(gdosTaskName), "%.28s%u%uG", className,
+                 (unsigned int)systemId, (unsigned int)instance);
+
+        ret = gdos->startDeferred(gdosTaskName, 1, cpu, gdosRingSize);
+        if (ret)
+        {
+            GDOS_ERROR("Can't start GDOS flush task, code = %d\n", ret);
+            goto exit_error;
+        }
+        moduleInitBits.setBit(INIT_BIT_GDOS_DEFERRED);
+    }
+
     // fill rackParameterMsg
     ret = parseArgTable(module_argTab, NULL);
-    ret += parseArgTable(arg_table, NULL);
+    ret += parseArgTable(argTable, NULL);
     ret += 1;
 
     paramMsg = (rack_param_msg*)malloc(sizeof(rack_param_msg) + ret * sizeof(rack_param));
@@ -798,11 +836,11 @@ int       RackModule::moduleInit(void)
 
     strncpy(paramMsg->parameter[0].name, "name", RACK_PARAM_MAX_STRING_LEN);
     paramMsg->parameter[0].type = RACK_PARAM_STRING;
-    strncpy(paramMsg->parameter[0].valueString, classname, RACK_PARAM_MAX_STRING_LEN);
+    strncpy(paramMsg->parameter[0].valueString, className, RACK_PARAM_MAX_STRING_LEN);
     paramMsg->parameterNum = 1;
 
     parseArgTable(module_argTab, paramMsg);
-    parseArgTable(arg_table, paramMsg);
+    parseArgTable(argTable, paramMsg);
 
     return 0;
 
@@ -835,6 +873,12 @@ void      RackModule::moduleCleanup(void)
         dataTask.join();
     }
 
+    // send all deferred messages
+    if (moduleInitBits.testAndClearBit(INIT_BIT_GDOS_DEFERRED))
+    {
+        gdos->stopDeferred();
+    }
+
     GDOS_PRINT("Terminated\n");
 
     // Stop transmitting messages to GUI
@@ -995,6 +1039,11 @@ void  RackModule::run(void)
     }
     moduleInitBits.setBit(INIT_BIT_DATATSK_STARTED);
 
+    // hosted modules return to the module host, the signal handler
+    // terminates all modules of the process
+    if (module_hosted)
+        return;
+
     pause();
 
 exit_error:
@@ -1013,6 +1062,9 @@ void save_argTab(arg_table_t* p_tab, const char* name)
 {
     arg_table = p_tab;
     strncpy(classname, name, 50);
+
+    if (!module_hosted)
+        strncpy(process_name, name, 50);
 }
 
 //
@@ -1022,9 +1074,11 @@ void save_argTab(arg_table_t* p_tab, const char* name)
 // !!!!! WARNING !!!!!
 // p_signal_module is only valid, if the derived classes have only ONE
 // instance. Else the signal handler calls the wrong function.
+// Only a module host (see RackModuleHost) registers several modules.
 // !!!!! WARNING !!!!!
 
-static RackModule *p_signal_module = NULL;
+static RackModule *p_signal_module[RACK_MODULE_HOST_NUM_MAX];
+static int signal_module_num = 0;
 static int signal_flags = 0;
 
 #define HANDLING_TERM           0x0001
@@ -1032,6 +1086,7 @@ static int signal_flags = 0;
 
 void signal_handler(int sig)
 {
+    int j;
 #ifdef __XENO__
     int nentries;
     void *array[10];
@@ -1043,7 +1098,7 @@ void signal_handler(int sig)
     {
 #ifdef __XENO__
         case SIGXCPU:
-            printf("%s: SIGXCPU (%02d) -> Unexpected switch to secondary mode\n", classname, sig);
+            printf("%s: SIGXCPU (%02d) -> Unexpected switch to secondary mode\n", process_name, sig);
             
             nentries = backtrace (array, 10);
             strings = backtrace_symbols (array, nentries);
@@ -1059,7 +1114,7 @@ void signal_handler(int sig)
                 (signal_flags & HANDLING_TERM))   // handle segmentation fault only if module is not terminated
                 break;
 
-            printf("%s: SIGSEGV (%02d) -> Segmentation fault\n", classname, sig);
+            printf("%s: SIGSEGV (%02d) -> Segmentation fault\n", process_name, sig);
 
             signal_flags |= HANDLING_SEGV;
 
@@ -1071,39 +1126,61 @@ void signal_handler(int sig)
             }
             free (strings);
 
-            p_signal_module->moduleTerminate();
+            for (i = 0; i < signal_module_num; i++)
+            {
+                p_signal_module[i]->moduleTerminate();
+            }
             break;
 #endif
         case SIGTERM:
         case SIGINT:
-            printf("%s: SIGTERM/SIGINT (%02d)\n", classname, sig);
+            printf("%s: SIGTERM/SIGINT (%02d)\n", process_name, sig);
 
             if (signal_flags & HANDLING_TERM) // call moduleCleanup only once
                 break;
 
             signal_flags |= HANDLING_TERM;
 
-            p_signal_module->moduleTerminate();
-            p_signal_module->moduleCleanup();
+            // terminate all modules first, hosted modules may wait for
+            // each other
+            for (j = 0; j < signal_module_num; j++)
+            {
+                p_signal_module[j]->moduleTerminate();
+            }
+            for (j = signal_module_num - 1; j >= 0; j--)
+            {
+                p_signal_module[j]->moduleCleanup();
+            }
             
-            printf("%s: Done\n", classname);
+            printf("%s: Done\n", process_name);
             break;
 
         default:
-            printf("%s: SIGNAL (%02d) -> NOT HANDLED\n", classname, sig);
+            printf("%s: SIGNAL (%02d) -> NOT HANDLED\n", process_name, sig);
     }
     return;
 }
 
 int init_signal_handler(RackModule *p_mod)
 {
-    if (p_signal_module)
+    if ((signal_module_num > 0) && !module_hosted)
     {
         printf("signal handler is allready defined\n");
         return -EBUSY;
     }
 
-    p_signal_module = p_mod;
+    if (signal_module_num >= RACK_MODULE_HOST_NUM_MAX)
+    {
+        printf("signal handler can't handle more than %d modules\n",
+               RACK_MODULE_HOST_NUM_MAX);
+        return -EBUSY;
+    }
+
+    p_signal_module[signal_module_num] = p_mod;
+    signal_module_num++;
+
+    if (signal_module_num > 1)
+        return 0;
 
     signal(SIGTERM, signal_handler);
     signal(SIGINT,  signal_handler);
@@ -1114,3 +1191,36 @@ int init_signal_handler(RackModule *p_mod)
 
     return 0;
 }
+
+void exit_signal_handler(RackModule *p_mod)
+{
+    int i, j;
+
+    for (i = 0; i < signal_module_num; i++)
+    {
+        if (p_signal_module[i] == p_mod)
+        {
+            for (j = i; j < signal_module_num - 1; j++)
+            {
+                p_signal_module[j] = p_signal_module[j + 1];
+            }
+            signal_module_num--;
+            break;
+        }
+    }
+}
+
+//
+// module host functions
+//
+
+void enable_module_hosting(void)
+{
+    module_hosted = 1;
+    strncpy(process_name, "RackModuleHost", 50);
+}
+
+int module_hosting_terminated(void)
+{
+    return (signal_flags & HANDLING_TERM) ? 1 : 0;
+}
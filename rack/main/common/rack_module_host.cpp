@@ -0,0 +1,207 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Oliver Wulf <oliver.wulf@web.de>
+ *
+ */
+
+#include <main/rack_module_host.h>
+
+#include <getopt.h>
+#include <signal.h>
+
+/*!
+ * @ingroup module
+ *
+ *@{*/
+
+/**
+ * @brief Module host constructor
+ *
+ * @param moduleTab Table of all modules which can be started by the host,
+ *                  the last entry has the name NULL.
+ *
+ * Environments:
+ *
+ * This service can be called from:
+ *
+ * - User-space task (non-RT)
+ *
+ * Rescheduling: never.
+ */
+RackModuleHost::RackModuleHost(rack_module_host_entry *moduleTab)
+{
+    this->moduleTab = moduleTab;
+    moduleNum       = 0;
+
+    // save the default values of the common module arguments, getArgs()
+    // overwrites them for every module
+    moduleArgNum = 0;
+    while ((module_argTab[moduleArgNum].name.length() != 0) &&
+           (moduleArgNum < RACK_MODULE_HOST_ARG_MAX))
+    {
+        moduleArgVal[moduleArgNum]  = module_argTab[moduleArgNum].val;
+        moduleArgType[moduleArgNum] = module_argTab[moduleArgNum].arg_type;
+        moduleArgNum++;
+    }
+
+    enable_module_hosting();
+    RackMailbox::enableLocalDelivery();
+}
+
+RackModuleHost::~RackModuleHost()
+{
+}
+
+/**
+ * @brief Start all modules
+ *
+ * The modules are started one after another in the order of the arguments.
+ * The arguments of the modules are separated by "--", the first argument
+ * of every module is its class name. If a module can't be started all
+ * running modules are terminated.
+ *
+ * @param argc Argument count of the host
+ * @param argv Arguments of the host
+ *
+ * @return 0 on success, otherwise negative error code
+ *
+ * Environments:
+ *
+ * This service can be called from:
+ *
+ * - User-space task (non-RT)
+ *
+ * Rescheduling: possible.
+ */
+int RackModuleHost::start(int argc, char *argv[])
+{
+    int i, first, ret;
+
+    if (argc < 2)
+    {
+        usage(argv[0]);
+        return -EINVAL;
+    }
+
+    first = 1;
+    for (i = 1; i <= argc; i++)
+    {
+        if ((i < argc) && strcmp(argv[i], "--"))
+            continue;
+
+        // module arguments argv[first] ... argv[i - 1]
+        if (i > first)
+        {
+            // the separator is replaced by the end of the argument list
+            if (i < argc)
+                argv[i] = NULL;
+
+            ret = startModule(i - first, &argv[first]);
+            if (ret)
+            {
+                printf("Can't start module %s, code = %d\n", argv[first], ret);
+
+                // terminate all running modules
+                if (moduleNum > 0)
+                    raise(SIGTERM);
+
+                return ret;
+            }
+        }
+        first = i + 1;
+    }
+
+    if (!moduleNum)
+    {
+        usage(argv[0]);
+        return -EINVAL;
+    }
+
+    printf("RackModuleHost: %d modules started\n", moduleNum);
+
+    return 0;
+}
+
+/**
+ * @brief Run the module host
+ *
+ * This function returns after all modules are terminated by SIGTERM or
+ * SIGINT.
+ *
+ * Environments:
+ *
+ * This service can be called from:
+ *
+ * - User-space task (non-RT)
+ *
+ * Rescheduling: possible.
+ */
+void RackModuleHost::run(void)
+{
+    while (!module_hosting_terminated())
+    {
+        pause();
+    }
+}
+
+/*@}*/
+
+int RackModuleHost::startModule(int argc, char *argv[])
+{
+    rack_module_host_entry  *p_entry;
+    int                     i, ret;
+
+    for (p_entry = moduleTab; p_entry->name; p_entry++)
+    {
+        if (!strcmp(p_entry->name, argv[0]))
+            break;
+    }
+
+    if (!p_entry->name)
+    {
+        printf("Unknown module %s\n", argv[0]);
+        return -ENOENT;
+    }
+
+    // restore the default values of the common module arguments
+    for (i = 0; i < moduleArgNum; i++)
+    {
+        module_argTab[i].val      = moduleArgVal[i];
+        module_argTab[i].arg_type = moduleArgType[i];
+    }
+
+    // restart the argument scan of getopt
+    optind = 0;
+
+    // the module main function returns after the module is running
+    ret = p_entry->moduleMain(argc, argv);
+    if (ret)
+        return ret;
+
+    moduleNum++;
+    return 0;
+}
+
+void RackModuleHost::usage(const char *hostName)
+{
+    int i;
+
+    printf("Usage: %s <module> [module args] -- <module> [module args] ...\n",
+           hostName);
+    printf("Modules:");
+    for (i = 0; moduleTab[i].name; i++)
+    {
+        printf(" %s", moduleTab[i].name);
+    }
+    printf("\n");
+}
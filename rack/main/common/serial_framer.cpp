@@ -0,0 +1,213 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2006 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Oliver Wulf <oliver.wulf@web.de>
+ *
+ */
+
+#include <string.h>
+#include <errno.h>
+
+#include <main/serial_framer.h>
+
+SerialFramer::SerialFramer()
+{
+    serialPort   = NULL;
+    baudrate     = 0;
+    syncLen      = 0;
+    frameLenFunc = NULL;
+    checkFunc    = NULL;
+
+    clean();
+}
+
+void SerialFramer::init(SerialPort *serialPort, int baudrate,
+                        const uint8_t *sync, int syncLen,
+                        serial_framer_len_t frameLen, serial_framer_check_t check)
+{
+    if (syncLen > SERIAL_FRAMER_SYNC_MAX)
+    {
+        syncLen = SERIAL_FRAMER_SYNC_MAX;
+    }
+
+    this->serialPort   = serialPort;
+    this->baudrate     = baudrate;
+    this->syncLen      = syncLen;
+    this->frameLenFunc = frameLen;
+    this->checkFunc    = check;
+    memcpy(this->sync, sync, syncLen);
+
+    clean();
+}
+
+void SerialFramer::clean(void)
+{
+    bufferStart = 0;
+    bufferEnd   = 0;
+    chunkStart  = 0;
+    chunkTime   = 0;
+    oldStart    = 0;
+    oldTime     = 0;
+}
+
+// timestamp of a buffered byte, 10 bits per byte
+rack_time_t SerialFramer::getTime(int index)
+{
+    if (baudrate <= 0)
+    {
+        return index >= chunkStart ? chunkTime : oldTime;
+    }
+
+    if (index >= chunkStart)
+    {
+        return chunkTime + (rack_time_t)((index - chunkStart) * 10000 / baudrate);
+    }
+    else
+    {
+        return oldTime + (rack_time_t)((index - oldStart) * 10000 / baudrate);
+    }
+}
+
+// read all available data into the buffer
+int SerialFramer::fill(void)
+{
+    int         ret, len;
+    rack_time_t time;
+
+    // move the unused data to the front
+    if (bufferStart > 0)
+    {
+        memmove(buffer, &buffer[bufferStart], bufferEnd - bufferStart);
+        bufferEnd  -= bufferStart;
+        chunkStart -= bufferStart;
+        oldStart   -= bufferStart;
+        bufferStart = 0;
+    }
+
+    ret = serialPort->recvAvailable(&buffer[bufferEnd], SERIAL_FRAMER_BUFFER_SIZE - bufferEnd,
+                                    &len, &time);
+    if (ret)
+    {
+        return ret;
+    }
+
+    // keep the time reference of the unused data, without rounding errors
+    // if it starts within the last read
+    if ((bufferEnd > 0) && (chunkStart <= 0))
+    {
+        oldTime  = chunkTime;
+        oldStart = chunkStart;
+    }
+
+    chunkStart = bufferEnd;
+    chunkTime  = time;
+    bufferEnd += len;
+
+    return 0;
+}
+
+int SerialFramer::recvFrame(void *frame, int frameMaxLen, int *frameLen,
+                            rack_time_t *timestamp)
+{
+    int     ret, avail, len, discarded;
+    uint8_t *head;
+
+    discarded = 0;
+
+    while (discarded < SERIAL_FRAMER_BUFFER_SIZE)
+    {
+        avail = bufferEnd - bufferStart;
+
+        // synchronize to the first byte of the sync pattern
+        if ((avail > 0) && (buffer[bufferStart] != sync[0]))
+        {
+            head = (uint8_t *)memchr(&buffer[bufferStart], sync[0], avail);
+            len  = head ? (int)(head - &buffer[bufferStart]) : avail;
+
+            bufferStart += len;
+            discarded   += len;
+            continue;
+        }
+
+        if (avail >= syncLen)
+        {
+            head = &buffer[bufferStart];
+            len  = 0;
+
+            if (memcmp(head, sync, syncLen) != 0)
+            {
+                len = -1;
+            }
+            else
+            {
+                len = frameLenFunc(head, avail);
+                if ((len < 0) || ((len > 0) && (len < syncLen)) ||
+                    (len > frameMaxLen) || (len > SERIAL_FRAMER_BUFFER_SIZE))
+                {
+                    len = -1;
+                }
+                else if ((len > 0) && (len <= avail) && checkFunc &&
+                         (checkFunc(head, len) != 0))
+                {
+                    len = -1;
+                }
+            }
+
+            // invalid frame, resynchronize behind its first byte
+            if (len < 0)
+            {
+                bufferStart++;
+                discarded++;
+                continue;
+            }
+
+            // complete frame
+            if ((len > 0) && (len <= avail))
+            {
+                memcpy(frame, head, len);
+                if (frameLen)
+                {
+                    *frameLen = len;
+                }
+                if (timestamp)
+                {
+                    *timestamp = getTime(bufferStart);
+                }
+
+                bufferStart += len;
+                return 0;
+            }
+        }
+        else if (memcmp(&buffer[bufferStart], sync, avail) != 0)
+        {
+            bufferStart++;
+            discarded++;
+            continue;
+        }
+
+        // buffer is full without a complete frame
+        if (avail >= SERIAL_FRAMER_BUFFER_SIZE)
+        {
+            bufferStart++;
+            discarded++;
+            continue;
+        }
+
+        ret = fill();
+        if (ret)
+        {
+            return ret;
+        }
+    }
+
+    return -ETIME;
+}
@@ -190,7 +190,7 @@ class CompressTool {
     RackGdos            *gdos; //----- only for debugging
 
     uint8_t             *pbuf23;
-    uint8_t             buf23[COMPR_MAX_INPUT_SIZE];
+    uint32_t            buf23Size;
 #ifdef COMPR_DEBUG
     int8_t              statStr[350];                   //----- for statistic output
 #endif
@@ -238,6 +238,7 @@ class CompressTool {
     CompressTool();
     CompressTool(RackMailbox * p_mbx, int32_t gdos_level);
     ~CompressTool();
+    int      compr_setMaxInputSize(uint32_t size);
     int8_t*  compr_getStatisticsStr();
     int8_t*  compr_getStatisticsTable();
     void     compr_writeStatistics(uint32_t step, uint32_t size);
@@ -296,4 +297,69 @@ class CompressTool {
 #endif
 };
 
+//----- ----------------------------------------------------------------------------------------------------
+//----- functions for accessing bit- and bytestreams
+//----- They are called for every symbol, so they are inline.
+//----- ----------------------------------------------------------------------------------------------------
+
+//----- writes the [bits] lowest bit from [value] into the bitstream [bs] (max 32)
+//----- The bits of the actual byte and of [value] are combined in one 64 bit word,
+//----- which is stored bytewise (MSB first) afterwards.
+inline void CompressTool::compr_writeBitStream(compr_bitStream *bs, uint32_t value, uint32_t bits) {
+    if (bits == 0) return;
+    uint32_t total = bs->aBit + bits;                       //----- max 39 bits
+    uint64_t word  = (bs->aBit == 0) ? 0 : (bs->data[bs->aByte] >> (8-bs->aBit));
+    word  = (word << bits) | ((uint64_t)value & (0xFFFFFFFFllu >> (32-bits)));
+    word <<= 64-total;
+    uint8_t *p = &bs->data[bs->aByte];
+    switch ((total+7) >> 3) {
+        case 5: p[4] = (uint8_t)(word >> 24);
+        case 4: p[3] = (uint8_t)(word >> 32);
+        case 3: p[2] = (uint8_t)(word >> 40);
+        case 2: p[1] = (uint8_t)(word >> 48);
+        case 1: p[0] = (uint8_t)(word >> 56);
+    }
+    bs->aByte += total >> 3;
+    bs->aBit   = total & 7;
+}
+
+//----- returns [bits] bits from the bitstream [bs] (max 32)
+//----- All needed bytes are loaded into one 64 bit word at once.
+inline uint32_t CompressTool::compr_readBitStream(compr_bitStream *bs, uint32_t bits) {
+    if (bits == 0) return 0;
+    uint32_t total  = bs->aBit + bits;                      //----- max 39 bits
+    uint32_t nBytes = (total+7) >> 3;
+    uint8_t  *p     = &bs->data[bs->aByte];
+    uint64_t word   = 0;
+    switch (nBytes) {
+        case 5: word |= (uint64_t)p[4] << 24;
+        case 4: word |= (uint64_t)p[3] << 32;
+        case 3: word |= (uint64_t)p[2] << 40;
+        case 2: word |= (uint64_t)p[1] << 48;
+        case 1: word |= (uint64_t)p[0] << 56;
+    }
+    word >>= 64 - total;
+    bs->aByte += total >> 3;
+    bs->aBit   = total & 7;
+    return (uint32_t)(word & (0xFFFFFFFFllu >> (32-bits)));
+}
+
+//----- writes [bytes] bytes of [value] into the byte stream [bs] (max 4)
+inline void CompressTool::compr_writeByteStream(compr_bitStream *bs, uint32_t value, uint32_t bytes) {
+    while (bytes > 0) {
+        bs->data[bs->aByte++] = (value >> ((bytes-1) << 3)) & 0xFF;
+        bytes--;
+    }
+}
+
+//----- reads [bytes] bytes from the byte stream [bs] (max 4)
+inline uint32_t CompressTool::compr_readByteStream(compr_bitStream *bs, uint32_t bytes) {
+    uint32_t output = 0;
+    for (uint32_t i = 0; i<bytes; i++) {
+        output <<= 8;
+        output |= bs->data[bs->aByte++];
+    }
+    return output;
+}
+
 #endif // __COMPRESS_TOOL_H__
@@ -55,6 +55,17 @@ class LadarPoint {
             data->type      = __be32_to_cpu(data->type);
             data->intensity = __be32_to_cpu(data->intensity);
         }
+
+        // all values are 32 bit
+        static void le_to_cpu(ladar_point *data, int num)
+        {
+            __le32_array_to_cpu(data, num * sizeof(ladar_point) / 4);
+        }
+
+        static void be_to_cpu(ladar_point *data, int num)
+        {
+            __be32_array_to_cpu(data, num * sizeof(ladar_point) / 4);
+        }
 };
 
 #endif // __LADAR_POINT_H__
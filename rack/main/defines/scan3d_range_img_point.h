@@ -38,6 +38,17 @@ class Scan3dRangeImgPoint {
             data->range = __be16_to_cpu(data->range);
             data->type  = __be16_to_cpu(data->type);
         }
+
+        // all values are 16 bit
+        static void le_to_cpu(scan3d_range_img_point *data, int num)
+        {
+            __le16_array_to_cpu(data, num * sizeof(scan3d_range_img_point) / 2);
+        }
+
+        static void be_to_cpu(scan3d_range_img_point *data, int num)
+        {
+            __be16_array_to_cpu(data, num * sizeof(scan3d_range_img_point) / 2);
+        }
 };
 
 #endif // __SCAN3D_RANGE_IMG_POINT_H__
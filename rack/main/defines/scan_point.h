@@ -73,6 +73,22 @@ class ScanPoint {
             data->segment   = __be16_to_cpu(data->segment);
             data->intensity = __be16_to_cpu(data->intensity);
         }
+
+        static void le_to_cpu(scan_point *data, int num)
+        {
+            if (__le32_to_cpu(1) != 1)
+            {
+                swap32x4_16x2_array(data, num);
+            }
+        }
+
+        static void be_to_cpu(scan_point *data, int num)
+        {
+            if (__be32_to_cpu(1) != 1)
+            {
+                swap32x4_16x2_array(data, num);
+            }
+        }
 };
 
 #endif // __SCAN_POINT_H__
@@ -16,6 +16,12 @@
 #ifndef __DXF_MAP_H__
 #define __DXF_MAP_H__
 
+#include <stdio.h>
+#include <inttypes.h>
+#include <sys/stat.h>
+
+#define DXF_MAP_CACHE_VERSION   1
+
 typedef struct {
     double x;
     double y;
@@ -28,7 +34,42 @@ typedef struct {
     int layer;
 } dxf_map_feature;
 
+// dxf file mapped into memory
+typedef struct {
+    const char *pos;
+    const char *end;
+    int line;
+} dxf_map_parser;
+
+// binary cache of the features read from a dxf file
+typedef struct {
+    char     magic[4];          // "RDXF"
+    uint32_t version;
+    int64_t  dxfSize;           // size and modification time of the dxf file
+    int64_t  dxfMtimeSec;
+    int64_t  dxfMtimeNsec;
+    uint64_t hash;              // of the features
+    int32_t  featureNum;
+    int32_t  reserved;
+} dxf_map_cache_head;
+
+typedef struct {
+    double  x;
+    double  y;
+    double  x2;
+    double  y2;
+    int32_t layer;
+    int32_t reserved;
+} dxf_map_cache_feature;
+
 /**
+ * DXF map with lines and points.
+ *
+ * The dxf file is mapped into memory and is parsed in place. The features
+ * read from the file are stored in a binary cache next to the dxf file
+ * (filename.cache), following loads of the unchanged file read the cache.
+ * The feature array grows if the file contains more than maxFeatureNum
+ * features.
  *
  * @ingroup main_tools
  */
@@ -38,13 +79,19 @@ class DxfMap
 
         int maxFeatureNum;
 
+        int reserve(int num);
+
+        int parse(const char *filename);
+        int loadCache(const char *cacheName, struct stat *dxfStat);
+        int saveCache(const char *cacheName, struct stat *dxfStat);
+
     protected:
 
-        int read_group(FILE *fp, char *string, int *number, double *real, int *line, int *level, int *vertices);
-        int read_polyline(FILE *fp);
-        int read_line(FILE *fp);
-        int read_lwpolyline(FILE *fp);
-        int read_point(FILE *fp);
+        int read_group(dxf_map_parser *parser, char *string, int *number, double *real, int *level, int *vertices);
+        int read_polyline(dxf_map_parser *parser);
+        int read_line(dxf_map_parser *parser);
+        int read_lwpolyline(dxf_map_parser *parser);
+        int read_point(dxf_map_parser *parser);
 
         int write_string(FILE *fp, int groupCode, char *string);
         int write_real(FILE *fp, int groupCode, double real);
@@ -64,11 +111,18 @@ class DxfMap
         dxf_map_feature *feature;
         int featureNum;
 
+        /** Returns the next free feature (not counted in featureNum), the
+         *  feature array grows if it is full */
+        dxf_map_feature *newFeature(void);
+
         double xMin;
         double xMax;
         double yMin;
         double yMax;
 
+        /** The binary cache is used (default) */
+        int useCache;
+
         int save(char *filename, int savefeatureNum, double scaleFactor);
         int save(char *filename, int savefeatureNum)
         {
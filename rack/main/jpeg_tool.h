@@ -39,6 +39,8 @@ typedef struct {
     char * outstream;          /* target stream */
     int    outstreamOffset;    /* offset into outstream */
     JOCTET * buffer;           /* start of buffer */
+    int    outstreamSize;      /* size of outstream (direct destination) */
+    int    overflow;           /* outstream too small (direct destination) */
 } jpeg_data_dst_mgr;
 
 typedef jpeg_data_dst_mgr * jpeg_data_dst_ptr;
@@ -159,6 +161,82 @@ inline GLOBAL(void) jpeg_stdmem_dest (j_compress_ptr cinfo, char * outstream)
     dest->outstreamOffset         = 0;
 }
 
+/**
+ * Initialize the direct destination --- the compressor writes into the
+ * outstream without the intermediate buffer.
+ */
+inline METHODDEF(void) init_direct_destination (j_compress_ptr cinfo)
+{
+    jpeg_data_dst_ptr dest = (jpeg_data_dst_ptr) cinfo->dest;
+
+    dest->pub.next_output_byte = (JOCTET *)dest->outstream;
+    dest->pub.free_in_buffer   = dest->outstreamSize;
+    dest->outstreamOffset      = 0;
+    dest->overflow             = 0;
+}
+
+/**
+ * The outstream of the direct destination is full. The rest of the image
+ * is written into a scratch buffer and dropped, the caller has to check
+ * the overflow flag after jpeg_finish_compress.
+ */
+inline METHODDEF(boolean) empty_direct_output_buffer (j_compress_ptr cinfo)
+{
+    jpeg_data_dst_ptr dest = (jpeg_data_dst_ptr) cinfo->dest;
+
+    if (!dest->overflow)
+    {
+        dest->buffer = (JOCTET *)
+          (*cinfo->mem->alloc_small) ((j_common_ptr) cinfo, JPOOL_IMAGE,
+                                      OUTPUT_BUF_SIZE * sizeof(JOCTET));
+        dest->overflow = 1;
+    }
+
+    dest->pub.next_output_byte = dest->buffer;
+    dest->pub.free_in_buffer   = OUTPUT_BUF_SIZE;
+
+    return TRUE;
+}
+
+/**
+ * Terminate the direct destination --- the data is already in place.
+ */
+inline METHODDEF(void) term_direct_destination (j_compress_ptr cinfo)
+{
+    jpeg_data_dst_ptr dest = (jpeg_data_dst_ptr) cinfo->dest;
+
+    if (!dest->overflow)
+    {
+        dest->outstreamOffset = dest->outstreamSize - dest->pub.free_in_buffer;
+    }
+}
+
+/**
+ * Prepare for output directly into a memory block of outstreamSize bytes.
+ * Can be called before every image with a new outstream.
+ */
+inline GLOBAL(void) jpeg_directmem_dest (j_compress_ptr cinfo, char * outstream,
+                                         int outstreamSize)
+{
+    jpeg_data_dst_ptr dest;
+
+    if (cinfo->dest == NULL)
+    {    /* first time for this JPEG object? */
+        cinfo->dest = (struct jpeg_destination_mgr *)
+              (*cinfo->mem->alloc_small) ((j_common_ptr) cinfo, JPOOL_PERMANENT,
+              sizeof(jpeg_data_dst_mgr));
+    }
+
+    dest = (jpeg_data_dst_ptr) cinfo->dest;
+    dest->pub.init_destination    = init_direct_destination;
+    dest->pub.empty_output_buffer = empty_direct_output_buffer;
+    dest->pub.term_destination    = term_direct_destination;
+    dest->outstream               = outstream;
+    dest->outstreamSize           = outstreamSize;
+    dest->outstreamOffset         = 0;
+    dest->overflow                = 0;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -21,20 +21,180 @@
 #include <main/rack_time.h>
 
 #include <sys/time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
 #include <stdio.h>
+#include <stdlib.h>
+
+#define RACK_TIME_CLOCK_MAGIC       0x5241434b          // "RACK"
+#define RACK_TIME_CLOCK_WAIT        1000                // [ms] wait for the clock creator
+#define RACK_TIME_DRIFT_HOLD        60000000000ll       // [ns] drift is applied after an update
+
+//
+// Clock of a RACK system in shared memory. The local time is the monotonic
+// clock plus the system time at the creation of the clock, so it starts as
+// wall clock time but is not stepped by settimeofday. The offset to the
+// reference clock is written by one module (e.g. ClockSystem) and read by all
+// modules of the system, a sequence counter protects the readers. The drift
+// is applied up to RACK_TIME_DRIFT_HOLD after the last update, so the clock
+// doesn't run away if the writer stopped.
+//
+struct rack_time_clock
+{
+    volatile uint32_t   magic;
+    volatile uint32_t   seq;            // odd while the offset is updated
+    int64_t             base;           // [ns] local time - monotonic time
+    int64_t             refTime;        // [ns] local time of the last update
+    int64_t             offset;         // [ns] offset at refTime
+    int64_t             drift;          // [ns/s] drift of the offset
+    int64_t             slew;           // [ns/s] slew rate until slewEnd
+    int64_t             slewEnd;        // [ns] local time
+};
+
+static int64_t getMonotonicNano(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000ll + ts.tv_nsec;
+}
+
+static int64_t getLocalBase(void)
+{
+    struct timeval time;
+
+    gettimeofday(&time, NULL);
+    return (int64_t)time.tv_sec * 1000000000ll + (int64_t)time.tv_usec * 1000ll -
+           getMonotonicNano();
+}
 
 RackTime::RackTime()
 {
+    clock     = NULL;
+    localBase = getLocalBase();
 }
 
-int RackTime::init(int tims_fd)
+int RackTime::init(int tims_fd, uint32_t system_id)
 {
+    char                    name[32];
+    struct rack_time_clock  *p_clock;
+    int                     fd, created, i;
+
+    if (clock)
+    {
+        return 0;
+    }
+
+    snprintf(name, sizeof(name), "/rack_time_%u", (unsigned int)system_id);
+
+    // the first module of the system creates the clock
+    created = 1;
+    fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0666);
+    if ((fd < 0) && (errno == EEXIST))
+    {
+        created = 0;
+        fd = shm_open(name, O_RDWR, 0666);
+    }
+    if (fd < 0)
+    {
+        printf("RackTime: Can't open shared clock %s, using local time\n", name);
+        return 0;
+    }
+
+    if (created && ftruncate(fd, sizeof(struct rack_time_clock)))
+    {
+        close(fd);
+        shm_unlink(name);
+        return -errno;
+    }
+
+    p_clock = (struct rack_time_clock *)mmap(NULL, sizeof(struct rack_time_clock),
+                                             PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p_clock == MAP_FAILED)
+    {
+        return -errno;
+    }
+
+    if (created)
+    {
+        p_clock->seq     = 0;
+        p_clock->base    = localBase;
+        p_clock->refTime = 0;
+        p_clock->offset  = 0;
+        p_clock->drift   = 0;
+        p_clock->slew    = 0;
+        p_clock->slewEnd = 0;
+        __sync_synchronize();
+        p_clock->magic   = RACK_TIME_CLOCK_MAGIC;
+    }
+    else
+    {
+        for (i = 0; (p_clock->magic != RACK_TIME_CLOCK_MAGIC) && (i < RACK_TIME_CLOCK_WAIT); i++)
+        {
+            usleep(1000);
+        }
+
+        if (p_clock->magic != RACK_TIME_CLOCK_MAGIC)
+        {
+            munmap(p_clock, sizeof(struct rack_time_clock));
+            return -ETIMEDOUT;
+        }
+        __sync_synchronize();
+    }
+
+    clock = p_clock;
     return 0;
 }
 
+int64_t RackTime::getClockOffset(int64_t localTime)
+{
+    struct rack_time_clock  c;
+    uint32_t                seq;
+    int64_t                 driftEnd;
+
+    if (!clock)
+    {
+        return 0;
+    }
+
+    do
+    {
+        seq = clock->seq;
+        __sync_synchronize();
+        c.refTime = clock->refTime;
+        c.offset  = clock->offset;
+        c.drift   = clock->drift;
+        c.slew    = clock->slew;
+        c.slewEnd = clock->slewEnd;
+        __sync_synchronize();
+    }
+    while ((seq & 1) || (seq != clock->seq));
+
+    // the slew ends at slewEnd
+    if (localTime < c.slewEnd)
+    {
+        c.slewEnd = localTime;
+    }
+
+    // the drift is not extrapolated without updates, e.g. if the writer stopped
+    driftEnd = localTime;
+    if (driftEnd > c.refTime + RACK_TIME_DRIFT_HOLD)
+    {
+        driftEnd = c.refTime + RACK_TIME_DRIFT_HOLD;
+    }
+
+    return c.offset + (int64_t)((double)(driftEnd - c.refTime) * c.drift * 1.0e-9 +
+                                (double)(c.slewEnd - c.refTime) * c.slew * 1.0e-9);
+}
+
 rack_time_t RackTime::fromNano(uint64_t ntime)
 {
-    return (rack_time_t)(ntime / RACK_TIME_FACTOR);
+    return (rack_time_t)((ntime + getClockOffset(ntime)) / RACK_TIME_FACTOR);
 }
 
 uint64_t RackTime::toNano(rack_time_t rtime)
@@ -54,17 +214,55 @@ int RackTime::set(uint64_t utcTimestamp, uint64_t recTimestamp)
 
 uint64_t RackTime::getNano(void)
 {
-    struct timeval time;
-    uint64_t nanoTime;
+    int64_t localTime = getLocalNano();
 
-    gettimeofday(&time, NULL);
+    return localTime + getClockOffset(localTime);
+}
 
-    nanoTime = (uint64_t) time.tv_sec * 1000000000llu + (uint64_t) time.tv_usec * 1000llu;
+int64_t RackTime::getOffset(void)
+{
+    return getClockOffset(getLocalNano());
+}
 
-    return nanoTime;
+uint64_t RackTime::getLocalNano(void)
+{
+    return getMonotonicNano() + (clock ? clock->base : localBase);
 }
 
-int64_t RackTime::getOffset(void)
+int RackTime::adjustOffset(int64_t offset, int64_t drift, int64_t slew_rate)
 {
+    int64_t localTime, currOffset, diff;
+
+    if (!clock)
+    {
+        return -ENODEV;
+    }
+
+    localTime  = getLocalNano();
+    currOffset = getClockOffset(localTime);
+    diff       = offset - currOffset;
+
+    clock->seq++;
+    __sync_synchronize();
+
+    clock->refTime = localTime;
+    clock->drift   = drift;
+
+    if ((slew_rate <= 0) || (diff == 0))
+    {
+        clock->offset  = offset;
+        clock->slew    = 0;
+        clock->slewEnd = localTime;
+    }
+    else
+    {
+        clock->offset  = currOffset;
+        clock->slew    = diff > 0 ? slew_rate : -slew_rate;
+        clock->slewEnd = localTime + (int64_t)((double)llabs(diff) * 1.0e9 / slew_rate);
+    }
+
+    __sync_synchronize();
+    clock->seq++;
+
     return 0;
 }
@@ -77,6 +77,7 @@ SerialPort::SerialPort()
 {
     module = NULL;
     fd = -1;
+    baudrate = 0;
 }
 
 SerialPort::~SerialPort()
@@ -221,6 +222,8 @@ int SerialPort::setBaudrate(int baudrate)
 	// Set the new options for the port...
 	tcsetattr(fd, TCSAFLUSH, &options);
 
+    this->baudrate = baudrate;
+
     return 0;
 }
 
@@ -343,6 +346,41 @@ int SerialPort::recv(void *data, int dataLen, rack_time_t *timestamp, int64_t ti
     return recv(data, dataLen, timestamp);
 }
 
+// receive the available data with timestamp and the default timeout
+int SerialPort::recvAvailable(void *data, int dataMaxLen, int *dataLen,
+                              rack_time_t *timestamp)
+{
+    int ret;
+
+    // read returns as soon as data is available (VMIN = 0)
+    ret = read(fd, data, dataMaxLen);
+
+    if (ret == 0)
+    {
+        return -ETIMEDOUT;      // timeout
+    }
+    else if (ret < 0)
+    {
+        return ret;             // IO error
+    }
+
+    *dataLen = ret;
+
+    // the time of the read is the one of the last byte (or later),
+    // go back to the first byte by the byte time (10 bits per byte)
+    if (timestamp)
+    {
+        *timestamp = module->rackTime.get();
+
+        if (baudrate > 0)
+        {
+            *timestamp -= (rack_time_t)((ret - 1) * 10000 / baudrate);
+        }
+    }
+
+    return 0;
+}
+
 int SerialPort::waitEvent(struct rtser_event *event)
 {
     int ret;
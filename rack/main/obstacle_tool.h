@@ -0,0 +1,102 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Matthias Hentschel <hentschel@rts.uni-hannover.de>
+ *
+ */
+
+#ifndef __OBSTACLE_TOOL_H__
+#define __OBSTACLE_TOOL_H__
+
+#include <perception/scan2d_proxy.h>
+#include <main/defines/scan_point.h>
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define OBSTACLE_TOOL_CELL_NUM      200             // cells per axis
+#define OBSTACLE_TOOL_CELL_SIZE     50              // default cell size in mm
+#define OBSTACLE_TOOL_DIST_MAX      0xffff          // distance of free space in mm
+
+/**
+ * Robot-centric obstacle grid
+ *
+ * The grid is built once per control cycle from the current scan2d data.
+ * Afterwards rectangle and arc clearance queries don't depend on the number
+ * of scan points, so many candidate trajectories can be tested per cycle:
+ *
+ * - rectTest()         O(1) by summed area tables of the obstacle cells
+ * - getDistance()      O(1) by a chamfer distance transform of the grid
+ * - arcClearance()     O(length / cellSize) distance lookups
+ *
+ * All obstacles are entered with the resolution of the grid, so the queries
+ * are conservative by up to one cell. Points outside the grid are not
+ * entered, so tests beyond the grid (see rectInside()) have to use the scan
+ * points of getScan().
+ *
+ * @ingroup main_tools
+ */
+class ObstacleTool {
+  private:
+    int             cellSize;
+    int             range;                          // half size of the grid in mm
+    int             pointNum;
+    scan2d_data     *scan;                          // scan of the last update
+
+    // summed area tables of all obstacles and of dynamic obstacles
+    int32_t         pointSum[(OBSTACLE_TOOL_CELL_NUM + 1) * (OBSTACLE_TOOL_CELL_NUM + 1)];
+    int32_t         dynSum[(OBSTACLE_TOOL_CELL_NUM + 1) * (OBSTACLE_TOOL_CELL_NUM + 1)];
+
+    // distance of every cell to the next obstacle in mm
+    uint16_t        distance[OBSTACLE_TOOL_CELL_NUM * OBSTACLE_TOOL_CELL_NUM];
+
+    int             rectSum(int32_t *sum, int xMin, int yMin, int xMax, int yMax);
+    void            distanceTransform(void);
+
+  public:
+
+    ObstacleTool(int cellSize = OBSTACLE_TOOL_CELL_SIZE);
+    ~ObstacleTool() {};
+
+    int update(scan2d_data *scan);
+    void clear(void);
+
+    int rectInside(int xMin, int yMin, int xMax, int yMax);
+    int rectTest(int xMin, int yMin, int xMax, int yMax);
+    int rectTestDyn(int xMin, int yMin, int xMax, int yMax);
+    int getDistance(int x, int y);
+    int arcClearance(int radius, int length, int width, int *p_distMin,
+                     int offset = 0, int front = 0);
+
+    int getCellSize(void)
+    {
+        return cellSize;
+    }
+
+    int getRange(void)
+    {
+        return range;
+    }
+
+    int getPointNum(void)
+    {
+        return pointNum;
+    }
+
+    scan2d_data *getScan(void)
+    {
+        return scan;
+    }
+};
+
+#endif // __OBSTACLE_TOOL_H__
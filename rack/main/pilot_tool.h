@@ -19,6 +19,7 @@
 #include <main/defines/scan_point.h>
 #include <perception/scan2d_proxy.h>
 #include <drivers/chassis_proxy.h>
+#include <main/obstacle_tool.h>
 
 #define MOVING    0
 #define HOLD      1
@@ -68,6 +69,83 @@ static inline int curve2Radius(float curve)
     }
 }
 
+/**
+ * Tests if an obstacle of the grid limits the speed "speed". The free
+ * rectangle of the robot is enlarged by the braking distance of "speed"
+ * (kFront ... kLeft are the braking distances per speed in each direction),
+ * dynamic obstacles need three times the braking distance.
+ * @ingroup main_tools
+ */
+static inline int safeSpeedBlocked(ObstacleTool *obstacle, int speed,
+                                   int xMin, int xMax, int yMin, int yMax,
+                                   float kFront, float kBack,
+                                   float kRight, float kLeft)
+{
+    if (obstacle->rectTest(xMin - (int)(speed * kBack),  yMin - (int)(speed * kLeft),
+                           xMax + (int)(speed * kFront), yMax + (int)(speed * kRight)))
+        return 1;
+
+    if (obstacle->rectTestDyn(xMin - (int)(speed * kBack * 3.0f),
+                              yMin - (int)(speed * kLeft * 3.0f),
+                              xMax + (int)(speed * kFront * 3.0f),
+                              yMax + (int)(speed * kRight * 3.0f)))
+        return 1;
+
+    return 0;
+}
+
+/**
+ * Tests if the grid covers all rectangles of safeSpeedBlocked() up to the
+ * speed "speed". Otherwise the scan points have to be tested.
+ * @ingroup main_tools
+ */
+static inline int safeSpeedInGrid(ObstacleTool *obstacle, int speed,
+                                  int xMin, int xMax, int yMin, int yMax,
+                                  float kFront, float kBack,
+                                  float kRight, float kLeft)
+{
+    return obstacle->rectInside(xMin - (int)(speed * kBack * 3.0f),
+                                yMin - (int)(speed * kLeft * 3.0f),
+                                xMax + (int)(speed * kFront * 3.0f),
+                                yMax + (int)(speed * kRight * 3.0f));
+}
+
+/**
+ * Max. speed without collision in the obstacle grid, found by a binary
+ * search over the speed. Each step needs two rectangle tests only.
+ * @ingroup main_tools
+ */
+static inline int safeSpeedObstacle(ObstacleTool *obstacle, int speed,
+                                    int xMin, int xMax, int yMin, int yMax,
+                                    float kFront, float kBack,
+                                    float kRight, float kLeft)
+{
+    int vFree, vBlocked, v;
+
+    if (!safeSpeedBlocked(obstacle, speed, xMin, xMax, yMin, yMax,
+                          kFront, kBack, kRight, kLeft))
+        return speed;
+
+    if (safeSpeedBlocked(obstacle, 0, xMin, xMax, yMin, yMax,
+                         kFront, kBack, kRight, kLeft))
+        return 0;
+
+    vFree    = 0;
+    vBlocked = speed;
+    while (vBlocked - vFree > 1)
+    {
+        v = (vFree + vBlocked) / 2;
+
+        if (safeSpeedBlocked(obstacle, v, xMin, xMax, yMin, yMax,
+                             kFront, kBack, kRight, kLeft))
+            vBlocked = v;
+        else
+            vFree    = v;
+    }
+
+    return vFree;
+}
+
 /**
  * This function is an assistant for the speed reduction of the robot. The
  * parameters "speed" and "radius" are the current speed and radius value of
@@ -79,9 +157,9 @@ static inline int curve2Radius(float curve)
  * then the current speed the current speed is reduced.
  * @ingroup main_tools
  */
-static inline int safeSpeed(int speed, int radius, int *moveStatus,
-                            scan2d_data *scan,
-                            chassis_param_data *param)
+static inline int safeSpeedIntern(int speed, int radius, int *moveStatus,
+                                  scan2d_data *scan, ObstacleTool *obstacle,
+                                  chassis_param_data *param)
 {
     int     i;
     int     xMax, xMin;
@@ -90,6 +168,7 @@ static inline int safeSpeed(int speed, int radius, int *moveStatus,
     int     vMax, vMaxX, vMaxY;
     float   rotationSpeed;
     float   breakConstant;
+    float   kFront, kBack;
 
     // set parameters for forward movement
 
@@ -176,8 +255,37 @@ static inline int safeSpeed(int speed, int radius, int *moveStatus,
         }
     }
 
+    // check obstacle grid
+    if (obstacle)
+    {
+        if (sign > 0)
+        {
+            kFront = param->breakConstant;
+            kBack  = 0.0f;
+        }
+        else
+        {
+            kFront = 0.0f;
+            kBack  = param->breakConstant;
+        }
+
+        // the braking distance exceeds the grid, check the scan points
+        if (!safeSpeedInGrid(obstacle, speed, xMin, xMax, yMin, yMax, kFront, kBack,
+                             param->breakConstant / 4.0f, param->breakConstant / 4.0f) &&
+            obstacle->getScan())
+        {
+            scan     = obstacle->getScan();
+            obstacle = NULL;
+        }
+        else
+        {
+            speed = safeSpeedObstacle(obstacle, speed, xMin, xMax, yMin, yMax, kFront, kBack,
+                                      param->breakConstant / 4.0f, param->breakConstant / 4.0f);
+        }
+    }
+
     // check Scan2D
-    for (i = 0; i < scan->pointNum; i += 2)
+    for (i = 0; (obstacle == NULL) && (i < scan->pointNum); i += 2)
     {
         if (((scan->point[i].type & SCAN_POINT_TYPE_INVALID) == 0) &
             ((scan->point[i].type & SCAN_POINT_TYPE_MASK) != SCAN_POINT_TYPE_LANDMARK))
@@ -254,6 +362,31 @@ static inline int safeSpeed(int speed, int radius, int *moveStatus,
     return speed * sign;
 }
 
+/**
+ * Speed reduction (see safeSpeedIntern()), all points of the scan2D "scan"
+ * are checked.
+ * @ingroup main_tools
+ */
+static inline int safeSpeed(int speed, int radius, int *moveStatus,
+                            scan2d_data *scan,
+                            chassis_param_data *param)
+{
+    return safeSpeedIntern(speed, radius, moveStatus, scan, NULL, param);
+}
+
+/**
+ * Speed reduction (see safeSpeedIntern()) by the obstacle grid of the
+ * current scan. The effort doesn't depend on the number of scan points,
+ * unless the braking distance exceeds the grid and the scan is checked.
+ * @ingroup main_tools
+ */
+static inline int safeSpeed(int speed, int radius, int *moveStatus,
+                            ObstacleTool *obstacle,
+                            chassis_param_data *param)
+{
+    return safeSpeedIntern(speed, radius, moveStatus, NULL, obstacle, param);
+}
+
 /**
  * This function is an assistant for the speed reduction of the robot. The
  * parameters "speed" and "radius" are the current speed and radius value of
@@ -265,9 +398,9 @@ static inline int safeSpeed(int speed, int radius, int *moveStatus,
  * then the current speed the current speed is reduced.
  * @ingroup main_tools
  */
-static inline int safeSpeedSide(int speedSide, int *moveStatus,
-                                scan2d_data *scan,
-                                chassis_param_data *param)
+static inline int safeSpeedSideIntern(int speedSide, int *moveStatus,
+                                      scan2d_data *scan, ObstacleTool *obstacle,
+                                      chassis_param_data *param)
 {
     int     i;
     int     xMax, xMin;
@@ -275,6 +408,7 @@ static inline int safeSpeedSide(int speedSide, int *moveStatus,
     int     sign;
     int     vMax, vMaxX, vMaxY;
     float   breakConstant;
+    float   kRight, kLeft;
 
     // set parameters for right movement
     if (speedSide > 0)  // set hysteresis boundaries
@@ -346,8 +480,40 @@ static inline int safeSpeedSide(int speedSide, int *moveStatus,
         return speedSide;
     }
 
+    // check obstacle grid
+    if (obstacle)
+    {
+        if (sign > 0)
+        {
+            kRight = param->breakConstant;
+            kLeft  = 0.0f;
+        }
+        else
+        {
+            kRight = 0.0f;
+            kLeft  = param->breakConstant;
+        }
+
+        // the braking distance exceeds the grid, check the scan points
+        if (!safeSpeedInGrid(obstacle, speedSide, xMin, xMax, yMin, yMax,
+                             param->breakConstant / 4.0f, param->breakConstant / 4.0f,
+                             kRight, kLeft) &&
+            obstacle->getScan())
+        {
+            scan     = obstacle->getScan();
+            obstacle = NULL;
+        }
+        else
+        {
+            speedSide = safeSpeedObstacle(obstacle, speedSide, xMin, xMax, yMin, yMax,
+                                          param->breakConstant / 4.0f,
+                                          param->breakConstant / 4.0f,
+                                          kRight, kLeft);
+        }
+    }
+
     // check scan2D
-    for (i = 0; i < scan->pointNum; i += 2)
+    for (i = 0; (obstacle == NULL) && (i < scan->pointNum); i += 2)
     {
         if (((scan->point[i].type & SCAN_POINT_TYPE_INVALID) == 0) &
             ((scan->point[i].type & SCAN_POINT_TYPE_MASK) != SCAN_POINT_TYPE_LANDMARK))
@@ -425,6 +591,30 @@ static inline int safeSpeedSide(int speedSide, int *moveStatus,
     return speedSide * sign;
 }
 
+/**
+ * Lateral speed reduction (see safeSpeedSideIntern()), all points of the
+ * scan2D "scan" are checked.
+ * @ingroup main_tools
+ */
+static inline int safeSpeedSide(int speedSide, int *moveStatus,
+                                scan2d_data *scan,
+                                chassis_param_data *param)
+{
+    return safeSpeedSideIntern(speedSide, moveStatus, scan, NULL, param);
+}
+
+/**
+ * Lateral speed reduction (see safeSpeedSideIntern()) by the obstacle grid
+ * of the current scan.
+ * @ingroup main_tools
+ */
+static inline int safeSpeedSide(int speedSide, int *moveStatus,
+                                ObstacleTool *obstacle,
+                                chassis_param_data *param)
+{
+    return safeSpeedSideIntern(speedSide, moveStatus, NULL, obstacle, param);
+}
+
 /**
  *
  * @ingroup main_tools
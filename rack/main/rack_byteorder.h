@@ -50,6 +50,234 @@ int64_t __cpu_to_be64(int64_t x)
 float32_t   __be32_float_to_cpu(float32_t x)
 float64_t   __be64_float_to_cpu(float64_t x)
 
+// arrays (in place, no alignment needed) //
+
+void swap16_array(void *data, int num)
+void swap32_array(void *data, int num)
+void swap32x4_16x2_array(void *data, int num)
+
+void __le16_array_to_cpu(void *data, int num)
+void __le32_array_to_cpu(void *data, int num)
+void __be16_array_to_cpu(void *data, int num)
+void __be32_array_to_cpu(void *data, int num)
+
 */
 
+#include <string.h>
+
+#if defined (__SSSE3__)
+#include <tmmintrin.h>
+#elif defined (__SSE2__)
+#include <emmintrin.h>
+#elif defined (__ARM_NEON__) || defined (__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+//
+// --- byte swapping of arrays ---
+//
+
+// swaps num 16 bit values, 8 per SIMD step
+static inline void swap16_array(void *data, int num)
+{
+    uint8_t     *p = (uint8_t *)data;
+    uint16_t    x;
+    int         i = 0;
+
+#if defined (__SSSE3__)
+    const __m128i mask = _mm_set_epi8(14, 15, 12, 13, 10, 11, 8, 9,
+                                       6,  7,  4,  5,  2,  3, 0, 1);
+    for (; i + 8 <= num; i += 8, p += 16)
+    {
+        _mm_storeu_si128((__m128i *)p,
+                         _mm_shuffle_epi8(_mm_loadu_si128((__m128i *)p), mask));
+    }
+#elif defined (__SSE2__)
+    __m128i     v;
+
+    for (; i + 8 <= num; i += 8, p += 16)
+    {
+        v = _mm_loadu_si128((__m128i *)p);
+        v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        _mm_storeu_si128((__m128i *)p, v);
+    }
+#elif defined (__ARM_NEON__) || defined (__ARM_NEON)
+    for (; i + 8 <= num; i += 8, p += 16)
+    {
+        vst1q_u8(p, vrev16q_u8(vld1q_u8(p)));
+    }
+#endif
+
+    for (; i < num; i++, p += 2)
+    {
+        memcpy(&x, p, 2);
+        x = bswap_16(x);
+        memcpy(p, &x, 2);
+    }
+}
+
+// swaps num 32 bit values, 4 per SIMD step
+static inline void swap32_array(void *data, int num)
+{
+    uint8_t     *p = (uint8_t *)data;
+    uint32_t    x;
+    int         i = 0;
+
+#if defined (__SSSE3__)
+    const __m128i mask = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11,
+                                       4,  5,  6,  7, 0, 1,  2,  3);
+    for (; i + 4 <= num; i += 4, p += 16)
+    {
+        _mm_storeu_si128((__m128i *)p,
+                         _mm_shuffle_epi8(_mm_loadu_si128((__m128i *)p), mask));
+    }
+#elif defined (__SSE2__)
+    __m128i     v;
+
+    for (; i + 4 <= num; i += 4, p += 16)
+    {
+        // swap the 16 bit halves, then the bytes of each half
+        v = _mm_loadu_si128((__m128i *)p);
+        v = _mm_or_si128(_mm_slli_epi32(v, 16), _mm_srli_epi32(v, 16));
+        v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        _mm_storeu_si128((__m128i *)p, v);
+    }
+#elif defined (__ARM_NEON__) || defined (__ARM_NEON)
+    for (; i + 4 <= num; i += 4, p += 16)
+    {
+        vst1q_u8(p, vrev32q_u8(vld1q_u8(p)));
+    }
+#endif
+
+    for (; i < num; i++, p += 4)
+    {
+        memcpy(&x, p, 4);
+        x = bswap_32(x);
+        memcpy(p, &x, 4);
+    }
+}
+
+// swaps num records of four 32 bit values followed by two 16 bit values
+// (20 bytes, e.g. scan_point), 4 records per SIMD step
+static inline void swap32x4_16x2_array(void *data, int num)
+{
+    uint8_t     *p = (uint8_t *)data;
+    uint32_t    x;
+    uint16_t    y;
+    int         i = 0, j;
+
+#if defined (__SSSE3__)
+    // 4 records are 5 vectors, the 16 bit values are in lane j - 1 of vector j
+    const __m128i mask[5] = {
+        _mm_set_epi8(12, 13, 14, 15,  8,  9, 10, 11,  4,  5,  6,  7,  0,  1,  2,  3),
+        _mm_set_epi8(12, 13, 14, 15,  8,  9, 10, 11,  4,  5,  6,  7,  2,  3,  0,  1),
+        _mm_set_epi8(12, 13, 14, 15,  8,  9, 10, 11,  6,  7,  4,  5,  0,  1,  2,  3),
+        _mm_set_epi8(12, 13, 14, 15, 10, 11,  8,  9,  4,  5,  6,  7,  0,  1,  2,  3),
+        _mm_set_epi8(14, 15, 12, 13,  8,  9, 10, 11,  4,  5,  6,  7,  0,  1,  2,  3)};
+
+    for (; i + 4 <= num; i += 4)
+    {
+        for (j = 0; j < 5; j++, p += 16)
+        {
+            _mm_storeu_si128((__m128i *)p,
+                             _mm_shuffle_epi8(_mm_loadu_si128((__m128i *)p), mask[j]));
+        }
+    }
+#elif defined (__SSE2__)
+    const __m128i mask[5] = {
+        _mm_setzero_si128(),
+        _mm_set_epi32(0, 0, 0, -1),
+        _mm_set_epi32(0, 0, -1, 0),
+        _mm_set_epi32(0, -1, 0, 0),
+        _mm_set_epi32(-1, 0, 0, 0)};
+    __m128i     v16, v32;
+
+    for (; i + 4 <= num; i += 4)
+    {
+        for (j = 0; j < 5; j++, p += 16)
+        {
+            v16 = _mm_loadu_si128((__m128i *)p);
+            v16 = _mm_or_si128(_mm_slli_epi16(v16, 8), _mm_srli_epi16(v16, 8));
+            v32 = _mm_or_si128(_mm_slli_epi32(v16, 16), _mm_srli_epi32(v16, 16));
+            _mm_storeu_si128((__m128i *)p,
+                             _mm_or_si128(_mm_and_si128(mask[j], v16),
+                                          _mm_andnot_si128(mask[j], v32)));
+        }
+    }
+#elif defined (__ARM_NEON__) || defined (__ARM_NEON)
+    static const uint32_t lane[5][4] = {
+        {0, 0, 0, 0}, {0xffffffff, 0, 0, 0}, {0, 0xffffffff, 0, 0},
+        {0, 0, 0xffffffff, 0}, {0, 0, 0, 0xffffffff}};
+    uint8x16_t  v;
+
+    for (; i + 4 <= num; i += 4)
+    {
+        for (j = 0; j < 5; j++, p += 16)
+        {
+            v = vld1q_u8(p);
+            vst1q_u8(p, vbslq_u8(vreinterpretq_u8_u32(vld1q_u32(lane[j])),
+                                 vrev16q_u8(v), vrev32q_u8(v)));
+        }
+    }
+#endif
+
+    for (; i < num; i++, p += 20)
+    {
+        for (j = 0; j < 16; j += 4)
+        {
+            memcpy(&x, p + j, 4);
+            x = bswap_32(x);
+            memcpy(p + j, &x, 4);
+        }
+        for (j = 16; j < 20; j += 2)
+        {
+            memcpy(&y, p + j, 2);
+            y = bswap_16(y);
+            memcpy(p + j, &y, 2);
+        }
+    }
+}
+
+#ifdef __LITTLE_ENDIAN_BITFIELD
+
+static inline void __le16_array_to_cpu(void *data, int num)
+{
+}
+
+static inline void __le32_array_to_cpu(void *data, int num)
+{
+}
+
+static inline void __be16_array_to_cpu(void *data, int num)
+{
+    swap16_array(data, num);
+}
+
+static inline void __be32_array_to_cpu(void *data, int num)
+{
+    swap32_array(data, num);
+}
+
+#else // ! __LITTLE_ENDIAN_BITFIELD
+
+static inline void __le16_array_to_cpu(void *data, int num)
+{
+    swap16_array(data, num);
+}
+
+static inline void __le32_array_to_cpu(void *data, int num)
+{
+    swap32_array(data, num);
+}
+
+static inline void __be16_array_to_cpu(void *data, int num)
+{
+}
+
+static inline void __be32_array_to_cpu(void *data, int num)
+{
+}
+
+#endif // ! __LITTLE_ENDIAN_BITFIELD
+
 #endif // __RACK_BYTEORDER_H__
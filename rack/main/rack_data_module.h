@@ -21,6 +21,9 @@
 
 #include <math.h>
 
+// spare buffers for data which is still read by local listeners
+#define DATA_BUFFER_SPARE_NUM       2
+
 //######################################################################
 //# class DataBufferEntry
 //######################################################################
@@ -29,12 +32,14 @@ class DataBufferEntry {
     public:
         void*       pData;
         uint32_t    dataSize;
+        int*        pRefs;      // local listeners reading pData
 
         // Konstruktor
         DataBufferEntry()
         {
             pData      = NULL;
             dataSize    = 0;
+            pRefs      = NULL;
         }
 
         // Destruktor
@@ -81,6 +86,8 @@ class RackDataModule : public RackModule
         uint32_t            listenerNum;
 
         DataBufferEntry*    dataBuffer;
+        DataBufferEntry*    dataBufferSpare;        // local delivery only
+        int*                dataBufferRefs;
         ListenerEntry*      listener;
 
         RackMutex           bufferMtx;
@@ -90,8 +97,10 @@ class RackDataModule : public RackModule
         char                listenerMtxName[30];
 
         uint32_t            dataBufferMaxEntries;
+        uint32_t            dataBufferWorkSpaceNum; // entries reserved for the data task
         uint32_t            dataBufferMaxDataSize;  // per slot !!!
         uint32_t            dataBufferMaxListener;
+        uint32_t            dataBufferSpareNum;
         int16_t             dataBufferSendType;
         RackMailbox*        dataBufferSendMbx;
         rack_time_t         dataBufferPeriodTime;
@@ -107,6 +116,9 @@ class RackDataModule : public RackModule
         void                removeAllListener(void);
         rack_time_t         getListenerPeriodTime(uint32_t dataMbx);
 
+        uint32_t            getDataBufferSharedNum(void);
+        void                unshareDataBufferEntry(uint32_t entry);
+
         void                setDataBufferMaxDataSize(uint32_t max_size);
         uint32_t            getDataBufferMaxDataSize(void);
 
@@ -127,6 +139,10 @@ class RackDataModule : public RackModule
     void*     getDataBufferWorkSpace(void);
     void      putDataBufferWorkSpace(uint32_t datalength);
 
+    int       setDataBufferWorkSpaceNum(uint32_t num);
+    void*     getDataBufferWorkSpace(uint32_t ahead);
+    void      dropDataBufferWorkSpace(void);
+
     void      sleepDataBufferPeriodTime(void);
 
     //
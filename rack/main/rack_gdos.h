@@ -20,9 +20,11 @@
 #include <stdarg.h> // va_start ...
 #include <stdio.h>  // printf ...
 #include <string.h>
+#include <pthread.h>
 
 #include <main/rack_mailbox.h>
 #include <main/rack_name.h>
+#include <main/rack_task.h>
 
 #define GDOS_MAX_MSG_SIZE   256     // size for message string and variables
 
@@ -45,7 +47,10 @@
             {                                                         \
                 if (gdos)                                             \
                 {                                                     \
-                    gdos->print(level, fmt, ##__VA_ARGS__);           \
+                    if (__builtin_constant_p(fmt))                    \
+                        gdos->printConst(level, fmt, ##__VA_ARGS__);  \
+                    else                                              \
+                        gdos->print(level, fmt, ##__VA_ARGS__);       \
                 }                                                     \
             }                                                         \
             while(0)
@@ -80,8 +85,6 @@
 
 #if defined (__XENO__) || defined (__KERNEL__)
 
-#include <main/rack_task.h>
-
 // non realtime / realtime context
 static inline int in_rt_context(void)
 {
@@ -103,7 +106,50 @@ static inline int in_rt_context(void)
 
 
 
+//
+// deferred messages
+//
+
+#define GDOS_RING_NUM_MAX   16          // tasks with deferred messages
+#define GDOS_BATCH_SIZE     1024        // maximum size of a batch message
+#define GDOS_FLUSH_TIME     20000000llu // [ns] period of the flush task
+
+// head of a deferred message in the ring of a task, followed by the packed
+// values (and the format string if it is not a constant)
+typedef struct
+{
+    uint16_t        size;           // record size, 0 = wrap around
+    int8_t          level;
+    uint8_t         reserved;
+    uint16_t        formatLen;      // length of a copied format string
+    uint16_t        dataLen;        // length of the packed values
+    const char*     format;         // NULL if the format string is copied
+} gdos_record;
+
+// maximum size of a record in the ring
+#define GDOS_RECORD_SIZE_MAX    ((sizeof(gdos_record) + 2 * GDOS_MAX_MSG_SIZE + 7) & ~7)
+
+// single producer / single consumer ring, written by one task only
+typedef struct
+{
+    volatile uint32_t   head;       // written by the producer task
+    volatile uint32_t   tail;       // written by the flush task
+    volatile uint32_t   dropped;    // messages dropped on a full ring
+    pthread_t           thread;
+    char*               buffer;
+} gdos_ring;
+
 /**
+ * GDOS (Global Debug Output System) messages of a module.
+ *
+ * A message consists of the format string followed by the packed values.
+ * By default a message is sent immediately to the GDOS mailbox. After
+ * startDeferred() the messages are only packed into a lock-free ring of the
+ * calling task and a flush task sends them in batch messages. Consecutive
+ * messages of the same level are packed one after another into one batch
+ * message. Messages are dropped if the ring of a task is full. The flush
+ * task sends the rings one after another, so messages of different tasks
+ * may reach the GUI out of order.
  *
  * @ingroup main_common
  */
@@ -113,28 +159,67 @@ class RackGdos
         RackMailbox*    sendMbx;
         char            gdosLevel;
 
+        // deferred messages
+        volatile int    deferred;
+        volatile int    flushTerminate;
+        RackTask        flushTask;
+        gdos_ring       ring[GDOS_RING_NUM_MAX];
+        volatile int    ringNum;
+        uint32_t        ringSize;
+        uint32_t        ringGeneration;
+        char*           ringBuffer;
+        volatile uint32_t ringDropped;  // messages of tasks without a ring
+        uint32_t        droppedReported;
+        char*           batch;
+        int             batchLen;
+        int             batchLevel;
+
+        gdos_ring*  getRing(void);
+        void        printDeferred(int level, int constFormat, const char* format,
+                                  va_list args);
+        void        flush(void);
+        void        flushRing(gdos_ring* r);
+        void        flushBatch(void);
+
+        friend void gdos_flush_task_proc(void *arg);
+
     public:
 
         RackGdos( void )
         {
-            this->sendMbx   = NULL;
-            this->gdosLevel = GDOS_MSG_DBG_DETAIL;
+            init(NULL, GDOS_MSG_DBG_DETAIL);
         }
 
         RackGdos( int level )
         {
-            this->sendMbx   = NULL;
-            this->gdosLevel = level;
+            init(NULL, level);
         }
 
         RackGdos( RackMailbox *mbx, int level )
         {
-            this->sendMbx   = mbx;
-            this->gdosLevel = level;
+            init(mbx, level);
         }
 
         ~RackGdos()
         {
+            stopDeferred();
+        }
+
+        void init(RackMailbox *mbx, int level)
+        {
+            this->sendMbx     = mbx;
+            this->gdosLevel   = level;
+            this->deferred    = 0;
+            this->ringNum     = 0;
+            this->ringSize    = 0;
+            this->ringDropped = 0;
+            this->ringBuffer  = NULL;
+
+            for (int i = 0; i < GDOS_RING_NUM_MAX; i++)
+            {
+                this->ring[i].dropped = 0;
+            }
+            this->batch       = NULL;
         }
 
         void setMbx(RackMailbox *newMbx)
@@ -152,38 +237,62 @@ class RackGdos
             gdosLevel = newLevel;
         }
 
-        void print(int level, const char* format, ...)
+        /**
+         * @brief Defer the messages of all tasks to a flush task.
+         *
+         * @param[in] name Name of the flush task.
+         * @param[in] prio Priority of the flush task.
+         * @param[in] cpu  Cpu of the flush task.
+         * @param[in] size Size of the ring of each task in bytes, rounded up
+         *                 to a power of two of at least two records of
+         *                 maximum size.
+         *
+         * @return 0 on success, otherwise negative error code
+         *
+         * Environments:
+         *
+         * This service can be called from:
+         *
+         * - User-space task (non-RT)
+         *
+         * Rescheduling: possible.
+         */
+        int startDeferred(const char *name, int prio, int cpu, int size);
+
+        /**
+         * @brief Send all deferred messages, stop the flush task and send
+         * the following messages immediately again. The tasks writing
+         * messages have to be terminated before.
+         *
+         * Environments:
+         *
+         * This service can be called from:
+         *
+         * - User-space task (non-RT)
+         *
+         * Rescheduling: possible.
+         */
+        void stopDeferred(void);
+
+        /**
+         * @brief Number of deferred messages dropped because of a full ring.
+         */
+        uint32_t getDropped(void);
+
+        /**
+         * @brief Pack the values of a message behind the format string.
+         *
+         * @return Length of the message or -1 if it does not fit into the
+         * buffer.
+         */
+        static int pack(char* buffer, int bufferLen, int datasize,
+                        const char* format, va_list args)
         {
-            tims_msg_head   head;
-            char            buffer[GDOS_MAX_MSG_SIZE];
             int             percent = 0;
             const char*     src;
             char*           dst;
-            va_list         args;
-            int             datasize = 0;
             int             valuesize = 0;
 
-            if (level < gdosLevel ||
-                level > GDOS_MSG_PRINT)
-            {
-                return;
-            }
-
-            // copy format string
-            src = format;
-            dst = buffer;
-
-            while (*src != 0 && datasize < (GDOS_MAX_MSG_SIZE-1) )
-            {
-                *dst++ = *src++;
-                datasize++;
-            }
-
-            *dst = 0;
-            datasize++;
-
-            // copy values
-            va_start(args, format);
             src = format;
             dst = &buffer[datasize];
 
@@ -203,9 +312,9 @@ class RackGdos
                             case 'x':
                             case 'X':
                                 valuesize = sizeof(int);
-                                if ((datasize + valuesize) > GDOS_MAX_MSG_SIZE)
+                                if ((datasize + valuesize) > bufferLen)
                                 {
-                                    return;
+                                    return -1;
                                 }
                                 *((int*)dst) = va_arg(args, int);
                                 dst              += valuesize;
@@ -216,9 +325,9 @@ class RackGdos
                             case 'f':
                             case 'L':
                                 valuesize = sizeof(long long);
-                                if ((datasize + valuesize) > GDOS_MAX_MSG_SIZE)
+                                if ((datasize + valuesize) > bufferLen)
                                 {
-                                    return;
+                                    return -1;
                                 }
                                 *((long long*)dst) = va_arg(args, long long);
                                 dst              += valuesize;
@@ -227,9 +336,9 @@ class RackGdos
 
                             case 'p':
                                 valuesize = sizeof(unsigned long);
-                                if ((datasize + valuesize) > GDOS_MAX_MSG_SIZE)
+                                if ((datasize + valuesize) > bufferLen)
                                 {
-                                    return;
+                                    return -1;
                                 }
                                 *((unsigned long*)dst) = va_arg(args, unsigned long);
                                 dst              += valuesize;
@@ -244,10 +353,9 @@ class RackGdos
 
                                 while (*ptr)
                                 {
-                                    if ((datasize + valuesize - 1) > GDOS_MAX_MSG_SIZE)
+                                    if ((datasize + valuesize) >= bufferLen)
                                     {
-                                        *((char*)dst) = '\0'; // add char term
-                                        return;
+                                        return -1;
                                     }
                                     *((char*)dst) = *ptr++;
                                     dst      += valuesize;
@@ -267,7 +375,48 @@ class RackGdos
                 src++;
             }
 
-            va_end(args);
+            return datasize;
+        }
+
+        void vprint(int level, int constFormat, const char* format, va_list args)
+        {
+            tims_msg_head   head;
+            char            buffer[GDOS_MAX_MSG_SIZE];
+            const char*     src;
+            char*           dst;
+            int             datasize = 0;
+
+            if (level < gdosLevel ||
+                level > GDOS_MSG_PRINT)
+            {
+                return;
+            }
+
+            if (deferred && sendMbx)
+            {
+                printDeferred(level, constFormat, format, args);
+                return;
+            }
+
+            // copy format string
+            src = format;
+            dst = buffer;
+
+            while (*src != 0 && datasize < (GDOS_MAX_MSG_SIZE-1) )
+            {
+                *dst++ = *src++;
+                datasize++;
+            }
+
+            *dst = 0;
+            datasize++;
+
+            // copy values
+            datasize = pack(buffer, GDOS_MAX_MSG_SIZE, datasize, format, args);
+            if (datasize < 0)
+            {
+                return;
+            }
 
             if (sendMbx)
             {
@@ -285,6 +434,25 @@ class RackGdos
                 }
             }
         }
+
+        void print(int level, const char* format, ...)
+        {
+            va_list args;
+
+            va_start(args, format);
+            vprint(level, 0, format, args);
+            va_end(args);
+        }
+
+        // the format string is a constant and is not copied into the ring
+        void printConst(int level, const char* format, ...)
+        {
+            va_list args;
+
+            va_start(args, format);
+            vprint(level, 1, format, args);
+            va_end(args);
+        }
 };
 
 #endif  // __RACK_DEBUG_H__
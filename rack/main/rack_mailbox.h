@@ -19,8 +19,60 @@
 
 #include <main/tims/tims.h>
 #include <main/tims/tims_api.h>
+#include <main/rack_byteorder.h>
 #include <main/rack_mutex.h>
 
+#include <sys/uio.h>
+
+//
+// local delivery between the mailboxes of one process (see RackModuleHost)
+//
+
+#define RACK_MBX_LOCAL_NUM_MAX          128         // local mailboxes per process
+#define RACK_MBX_LOCAL_SLOT_MAX         32          // local slots per mailbox
+#define RACK_MBX_LOCAL_DATALEN_MIN      1024        // smaller messages use TiMS
+
+// The data of a local message is copied directly into a slot of the receiver
+// or the slot points to the shared buffer of the sender (see
+// RackMailbox::sendDataMsgReplyShared()). TiMS transfers only the message head
+// with the slot index in the head flags.
+#define RACK_MBX_HEAD_LOCAL             0x80
+#define RACK_MBX_HEAD_SLOT_MASK         0x7c
+#define RACK_MBX_HEAD_SLOT_SHIFT        2
+
+#define RACK_MBX_SLOT_FREE              0
+#define RACK_MBX_SLOT_WRITE             1           // sender copies the data
+#define RACK_MBX_SLOT_READY             2           // waits for the receiver
+#define RACK_MBX_SLOT_READ              3           // receiver copies the data
+#define RACK_MBX_SLOT_PEEK              4           // locked until peekEnd()
+
+typedef struct {
+    volatile int    state;
+    uint32_t        src;
+    int8_t          type;
+    uint8_t         priority;
+    uint32_t        seqNum;
+    uint32_t        datalen;
+    void            *data;                          // buffer or shared data
+    void            *buffer;                        // own slot buffer
+    int             *refs;                          // references of shared data
+} rack_mbx_local_slot;
+
+//
+// latest-value receive (see RackMailbox::recvLatest)
+//
+
+#define RACK_MBX_LATEST_SRC_MAX         8           // senders per mailbox
+
+// newest received message of one sender, the data buffers are swapped
+// instead of copied if a newer message of the same sender is received
+typedef struct {
+    tims_msg_head   head;
+    int             valid;
+    uint32_t        order;                          // receive order of the senders
+    void            *data;
+} rack_mbx_latest_entry;
+
 /**
  * This is the mailbox interface of RACK provided to application programs
  * in userspace.
@@ -103,6 +155,16 @@ public:
         return (head.flags & TIMS_BODY_BYTEORDER_LE);
     }
 
+    /** Data in cpu byteorder needs no conversion */
+    int isDataByteorderCpu(void)
+    {
+#ifdef __LITTLE_ENDIAN_BITFIELD
+        return (head.flags & TIMS_BODY_BYTEORDER_LE);
+#else
+        return !(head.flags & TIMS_BODY_BYTEORDER_LE);
+#endif
+    }
+
     int64_t data64ToCpu(int64_t x)
     {
         if(head.flags & TIMS_BODY_BYTEORDER_LE)
@@ -192,6 +254,42 @@ class RackMailbox
         RackMutex       sendMtx;
         RackMutex       recvMtx;
 
+        // local delivery
+        rack_mbx_local_slot localSlot[RACK_MBX_LOCAL_SLOT_MAX];
+        int             localSlotNum;
+        uint32_t        localDatalen;
+        uint32_t        localSeqNum;
+        void            *localBuffer;
+        void            *localRecv;                 // peek buffer of TiMS messages
+        int             localPeek;
+        volatile int    localShared;                // peek data is read only
+        RackMutex       localMtx;
+
+        int     createLocal(int messageSlots, uint32_t maxDatalen);
+        void    removeLocal(void);
+        void    cleanLocal(void);
+        void    freeLocal(int slot);
+        void    releaseLocal(rack_mbx_local_slot *p_slot);
+        int     sendIov(tims_msg_head *p_head, struct iovec *iov, int iovNum,
+                        int *refs = NULL);
+        int     sendLocal(tims_msg_head *p_head, struct iovec *iov, int iovNum,
+                          int *refs);
+        int     recvLocal(tims_msg_head *p_head, void *p_data, uint32_t maxDatalen);
+        int     peekLocal(RackMessage *msgInfo);
+        int     peekRecv(int64_t timeout_ns, RackMessage *msgInfo);
+
+        // latest-value receive
+        uint32_t        latestDatalen;
+        uint32_t        latestOrder;
+        void            *latestSpare;               // buffer of the next message
+        rack_mbx_latest_entry latestEntry[RACK_MBX_LATEST_SRC_MAX];
+
+        int     latestDrain(int64_t timeout_ns);
+        int     latestNext(void);
+        void    removeLatest(void);
+        void    cleanLatest(void);
+        int     recvLatestIntern(int64_t timeout_ns, void *p_data, uint32_t maxDatalen, RackMessage *msgInfo);
+
     public:
         RackMailbox();
 
@@ -207,13 +305,19 @@ class RackMailbox
         /** Get mailbox file descriptor */
         int             getFd(void)           { return fd; }
 
+        static void     enableLocalDelivery(void);
+
+        static int      getLocalDelivery(void);
+
+        void            setSharedData(int shared);
+
         //
         // create, destroy and clean
         //
 
         int     create(uint32_t address, int messageSlots,
                        ssize_t maxDatalen, void *buffer,
-                       ssize_t bufferSize, int8_t sendPriority);
+                       ssize_t bufferSize, int8_t sendPriority, int flags = 0);
 
         int     remove(void);
 
@@ -233,6 +337,8 @@ class RackMailbox
 
         int     sendDataMsgReply(int8_t type, RackMessage *msgInfo, int dataPointers, void* data1, uint32_t datalen1, ...);
 
+        int     sendDataMsgReplyShared(int8_t type, RackMessage *msgInfo, void *data, uint32_t datalen, int *refs);
+
         //
         // peek
         //
@@ -260,6 +366,10 @@ class RackMailbox
         int     recvDataMsg(void *p_data, uint32_t maxDatalen, RackMessage *msgInfo);
 
         int     recvDataMsgIf(void *p_data, uint32_t maxDatalen, RackMessage *msgInfo);
+
+        int     recvLatestTimed(uint64_t timeout_ns, void *p_data, uint32_t maxDatalen, RackMessage *msgInfo);
+
+        int     recvLatest(void *p_data, uint32_t maxDatalen, RackMessage *msgInfo);
 };
 
 #endif // __RACK_MAILBOX_H__
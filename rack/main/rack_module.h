@@ -76,6 +76,7 @@ extern arg_table_t module_argTab[];
 #define MBX_IN_USERSPACE                0x0002
 #define MBX_SLOT                        0x0004
 #define MBX_FIFO                        0x0008
+#define MBX_LATEST                      0x0010  // newest message per sender only
 
 /**
  * The class RackModule is the higest class of RACK components. All
@@ -182,6 +183,10 @@ class RackModule {
         /** Debugging level */
         char          gdosLevel;
 
+        /** Size of the GDOS ring of each task (0 = no deferred messages) */
+        int           gdosRingSize;
+        char          gdosTaskName[50];
+
 //
 // Rack time
 //
@@ -197,6 +202,9 @@ class RackModule {
         uint32_t  instance;      // instance number
         uint32_t  name;          // module name (12345678) == cmdMbxAdr
 
+        char      className[50]; // class name of the module
+        arg_table_t *argTable;   // start arguments of the module
+
         rack_param_msg *paramMsg;
 
         int       parseArgTable(arg_table_t *argTable, rack_param_msg *paramMsg);
@@ -313,5 +321,15 @@ class RackModule {
 
 void signal_handler(int sig);
 int init_signal_handler(RackModule *p_mod);
+void exit_signal_handler(RackModule *p_mod);
+
+//
+// module host functions (see RackModuleHost)
+//
+
+#define RACK_MODULE_HOST_NUM_MAX        32
+
+void enable_module_hosting(void);
+int module_hosting_terminated(void);
 
 #endif // __RACK_MODULE_H__
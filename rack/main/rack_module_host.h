@@ -0,0 +1,76 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Oliver Wulf <oliver.wulf@web.de>
+ *
+ */
+#ifndef __RACK_MODULE_HOST_H__
+#define __RACK_MODULE_HOST_H__
+
+#include <main/rack_module.h>
+
+//
+// Several modules are started in one process. Every module keeps its own
+// command and data task. Data messages between the modules of the process
+// are handed over in the local slots of the receiving mailbox
+// (see RackMailbox::enableLocalDelivery()), all other messages use TiMS.
+// Continuous data of a RackDataModule is read in place from its data buffer
+// by listeners which peek() their data (see RackMailbox::setSharedData()).
+//
+// The module sources are linked into the host program with renamed main()
+// functions and argument tables, see tools/module_host/module_host_module.cpp:
+//
+// #define main    scan2d_main
+// #define argTab  scan2d_argTab
+// #include <perception/scan2d/scan2d.cpp>
+//
+// Start arguments: <host> <module> [module args] -- <module> [module args] ...
+//
+
+#define RACK_MODULE_HOST_ARG_MAX        32      // entries of module_argTab
+
+typedef int (*rack_module_main)(int argc, char *argv[]);
+
+typedef struct
+{
+    const char          *name;          // class name of the module
+    rack_module_main    moduleMain;     // renamed main function of the module
+} rack_module_host_entry;
+
+/**
+ * Module host, runs several modules in one process.
+ *
+ * @ingroup main_common
+ */
+class RackModuleHost
+{
+    private:
+        rack_module_host_entry  *moduleTab;
+        int                     moduleNum;
+
+        // default values of module_argTab
+        arg_value_t             moduleArgVal[RACK_MODULE_HOST_ARG_MAX];
+        int                     moduleArgType[RACK_MODULE_HOST_ARG_MAX];
+        int                     moduleArgNum;
+
+        int     startModule(int argc, char *argv[]);
+        void    usage(const char *hostName);
+
+    public:
+        RackModuleHost(rack_module_host_entry *moduleTab);
+        ~RackModuleHost();
+
+        int     start(int argc, char *argv[]);
+        void    run(void);
+};
+
+#endif // __RACK_MODULE_HOST_H__
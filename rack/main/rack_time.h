@@ -54,6 +54,13 @@ private:
 #else // !__XENO__
 
 private:
+    /** Clock of the RACK system shared by all modules (global = local + offset) */
+    struct rack_time_clock *clock;
+
+    /** Local clock base, used if the shared clock is not available */
+    int64_t localBase;
+
+    int64_t getClockOffset(int64_t localTime);
 
 #endif // __XENO__
 
@@ -79,6 +86,8 @@ public:
      *
      * @param[in] tims_fd File descriptor of a TIMS mailbox. Has to remain valid
      * as long as the RackTime instance is uses.
+     * @param[in] system_id RACK system of the module. On Linux all modules of a
+     * system share the clock offset, which is set by adjustOffset().
      *
      * @return 0 on success, otherwise negative error code
      *
@@ -90,7 +99,7 @@ public:
      *
      * Rescheduling: never.
      */
-    int init(int tims_fd);
+    int init(int tims_fd, uint32_t system_id = 0);
 
     /**
      * @brief Converting nanoseconds into rack_time_t. If a global time offset is
@@ -176,6 +185,47 @@ public:
      */
     int64_t getOffset(void);
 
+    /**
+     * @brief Gets the local time in nanoseconds without the offset to the
+     * reference clock. The local time is not stepped by changes of the
+     * system time.
+     *
+     * @return Local time in nanoseconds
+     *
+     * Environments:
+     *
+     * This service can be called from:
+     *
+     * - User-space task (RT, non-RT)
+     *
+     * Rescheduling: never.
+     */
+    uint64_t getLocalNano(void);
+
+    /**
+     * @brief Adjusts the offset to the reference clock of all modules of the
+     * RACK system. The RACK time stays continuous, the difference to the new
+     * offset is slewed with slew_rate. A slew_rate of 0 steps the offset.
+     *
+     * @param[in] offset Offset to the reference clock at the current local
+     * time in nanoseconds
+     * @param[in] drift [ns/s] Drift of the offset, on Linux it is applied
+     * up to 60 s after the adjustment
+     * @param[in] slew_rate [ns/s] Maximum slew rate, 0 = step
+     *
+     * @return 0 on success, otherwise negative error code. On Xenomai the
+     * offset is kept by TIMS and -EOPNOTSUPP is returned.
+     *
+     * Environments:
+     *
+     * This service can be called from:
+     *
+     * - User-space task (RT, non-RT)
+     *
+     * Rescheduling: never.
+     */
+    int adjustOffset(int64_t offset, int64_t drift, int64_t slew_rate);
+
 };
 
 #endif // __RACK_TIME_H__
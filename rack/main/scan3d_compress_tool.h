@@ -24,8 +24,20 @@
 #define COMPR_S1_DELTA_RLE            0x00000005
 #define COMPR_S1_REMOVE_INVALID       0x01000000
 
+//----- chunked compression (see CompressBlocks)
+#define COMPR_BLOCK_MAGIC             0x4D42        //----- "MB"
+#define COMPR_BLOCK_NUM_MAX           256
+#define COMPR_BLOCK_WORKER_NUM_MAX    8
+#define COMPR_BLOCK_POINT_NUM         16384         //----- default points per block
+#define COMPR_BLOCK_MSG_JOB           1             //----- job message to the workers
+#define COMPR_BLOCK_MSG_STOP          2             //----- terminates a worker
+#define COMPR_BLOCK_MSG_DONE          3             //----- job finished by a worker
+
 
 #include <main/rack_gdos.h>
+#include <main/rack_mailbox.h>
+#include <main/rack_mutex.h>
+#include <main/rack_task.h>
 #include <main/compress_tool.h>
 
 //----- minMax contains min and max values of input data, their ranges
@@ -46,6 +58,15 @@ typedef struct scanPoint {
 
 
 
+class Scan3dCompressTool;
+
+//----- compr_blockWorker is the argument of a worker task of the chunked compression
+typedef struct compr_blockWorker {
+    Scan3dCompressTool  *tool;
+    uint32_t            index;                      //----- index of the worker tool
+} compr_blockWorker;
+
+
 //----- ----------------------------------------------------------------------------------------------------
 //----- Class Scan3dCompressTool
 //----- ----------------------------------------------------------------------------------------------------
@@ -63,8 +84,32 @@ class Scan3dCompressTool {
     scan3d_data     *inputHeader, *outputHeader;    //----- pointers to input/output data (header)
     CompressTool    compr_Tool;                     //----- CompressTool containing compression steps 2 and 3
     uint8_t         *pbuf1;
-    uint8_t         buf1[COMPR_MAX_INPUT_SIZE];
-    scan_point      s3d_buf1[SCAN3D_POINT_MAX];
+    uint32_t        maxPointNum;                    //----- size of s3d_buf and pbuf1
+
+//----- chunked compression
+    Scan3dCompressTool  *blockTool[COMPR_BLOCK_WORKER_NUM_MAX + 1];    //----- [0] is used by the caller
+    compr_blockWorker   blockWorker[COMPR_BLOCK_WORKER_NUM_MAX + 1];
+    RackTask            blockTask[COMPR_BLOCK_WORKER_NUM_MAX];
+    RackMutex           blockMtx;
+    RackMailbox         *blockJobMbx;               //----- workers wait for jobs here
+    RackMailbox         *blockDoneMbx;              //----- caller waits for finished jobs here
+    uint32_t            blockWorkerNum;
+    uint32_t            blockPointNum;
+    uint32_t            blockBufSize;
+    uint8_t             *blockBuf;
+    uint32_t            uncomprBufSize;
+    uint8_t             *uncomprBuf;                //----- copy of the input of DecompressBlocks
+    //----- actual job
+    scan3d_data         *blockInput;
+    uint32_t            blockFlags_s1, blockFlags_s2, blockFlags_s3;
+    uint32_t            blockJobPointNum;           //----- points per block of the actual job
+    uint32_t            blockSlotSize;              //----- buffer size per block of the actual job
+    uint32_t            blockNum;
+    uint32_t            blockNext;
+    uint32_t            blockSize[COMPR_BLOCK_NUM_MAX];
+
+    void     compr_blocks_process(uint32_t index);
+    friend void compr_block_task_proc(void *arg);
 
   public:
 //----- ----------------------------------------------------------------------------------------------------
@@ -73,7 +118,15 @@ class Scan3dCompressTool {
     Scan3dCompressTool();
     Scan3dCompressTool(RackMailbox * p_mbx, int32_t gdos_level, RackTime *rt);
     ~Scan3dCompressTool();
+    int      setMaxPointNum(uint32_t pointNum);
     uint32_t Compress(scan3d_data *s3d_in_out, uint32_t flags_s1, uint32_t flags_s2, uint32_t flags_s3);
+    uint32_t CompressPoints(scan_point *in, uint32_t nPoints, uint8_t *out, scan3d_data *header,
+                            uint32_t flags_s1, uint32_t flags_s2, uint32_t flags_s3);
+
+    int      initBlocks(uint32_t pointNum, uint32_t workerNum, int prio,
+                        RackMailbox *jobMbx, RackMailbox *doneMbx);
+    void     cleanupBlocks();
+    uint32_t CompressBlocks(scan3d_data *s3d_in_out, uint32_t flags_s1, uint32_t flags_s2, uint32_t flags_s3);
     void     compr_step1_searchMinMaxValues(uint32_t nPoints);
     void     compr_step1_reduceBitsPerSymbol(compr_bitStream *out, uint32_t nPoints);
     void     compr_step1_reduceBytesPerSymbol(compr_bitStream *out, uint32_t nPoints);
@@ -84,6 +137,8 @@ class Scan3dCompressTool {
 
 #ifdef COMPR_UNCOMPR
     uint32_t Decompress(scan3d_data *s3d_in_out);
+    uint32_t DecompressPoints(scan_point *in_out, uint32_t nPoints);
+    uint32_t DecompressBlocks(scan3d_data *s3d_in_out);
     uint32_t uncompr_step1_reduceBitsPerSymbol(compr_bitStream *in, uint32_t nPoints);
     uint32_t uncompr_step1_reduceBytesPerSymbol(compr_bitStream *in, uint32_t nPoints);
     uint32_t uncompr_step1_reduceBytesPerSymbol222110(compr_bitStream *in, uint32_t nPoints);
@@ -0,0 +1,81 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2006 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Oliver Wulf <oliver.wulf@web.de>
+ *
+ */
+#ifndef __SERIAL_FRAMER_H__
+#define __SERIAL_FRAMER_H__
+
+#include <main/serial_port.h>
+
+#define SERIAL_FRAMER_BUFFER_SIZE   4096
+#define SERIAL_FRAMER_SYNC_MAX      4
+
+/** returns the length of the frame at the begin of data, 0 if more data is
+ *  needed to know it and a negative value if the frame head is invalid */
+typedef int (*serial_framer_len_t)(const uint8_t *data, int dataLen);
+
+/** returns 0 if the checksum of the frame is valid */
+typedef int (*serial_framer_check_t)(const uint8_t *frame, int frameLen);
+
+/**
+ * Packet framer on top of a SerialPort. The data is read in chunks of all
+ * available bytes into a buffer, which is searched for the sync pattern of
+ * the frames. A frame with an invalid length or checksum is dropped by its
+ * first byte, so the framer resynchronizes within the buffered data.
+ * The timestamp of a frame is the one of its first byte, calculated from
+ * the timestamp of the first byte of the read (see
+ * SerialPort::recvAvailable()) and the byte time of the baudrate.
+ *
+ * @ingroup main_device_driver
+ */
+class SerialFramer
+{
+    private:
+        SerialPort              *serialPort;
+        int                     baudrate;
+        uint8_t                 sync[SERIAL_FRAMER_SYNC_MAX];
+        int                     syncLen;
+        serial_framer_len_t     frameLenFunc;
+        serial_framer_check_t   checkFunc;
+
+        uint8_t                 buffer[SERIAL_FRAMER_BUFFER_SIZE];
+        int                     bufferStart;    // first unused byte
+        int                     bufferEnd;
+        int                     chunkStart;     // first byte of the last read
+        rack_time_t             chunkTime;
+        int                     oldStart;       // time reference of the data
+        rack_time_t             oldTime;        // of the older reads
+
+        int         fill(void);
+        rack_time_t getTime(int index);
+
+    public:
+
+        SerialFramer();
+
+        void init(SerialPort *serialPort, int baudrate,
+                  const uint8_t *sync, int syncLen,
+                  serial_framer_len_t frameLen, serial_framer_check_t check);
+
+        /** drop the buffered data, call it together with SerialPort::clean() */
+        void clean(void);
+
+        /** receive the next valid frame with the timestamp of its first byte,
+         *  returns -ETIME if no sync pattern is found within
+         *  SERIAL_FRAMER_BUFFER_SIZE bytes */
+        int  recvFrame(void *frame, int frameMaxLen, int *frameLen,
+                       rack_time_t *timestamp);
+};
+
+#endif // __SERIAL_FRAMER_H__
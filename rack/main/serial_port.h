@@ -45,6 +45,7 @@ class SerialPort
 
         int fd;
         RackModule *module;
+        int baudrate;           // byte time of the received data
 
     public:
 
@@ -73,6 +74,12 @@ class SerialPort
         int recv(void *data, int dataLen, rack_time_t *timestamp,
                  int64_t timeout_ns);
 
+        /** receive the available data (at least one byte) with the default
+         *  timeout, the timestamp is the one of the first byte (on Linux
+         *  calculated back from the time of the read and the baudrate) */
+        int recvAvailable(void *data, int dataMaxLen, int *dataLen,
+                          rack_time_t *timestamp);
+
         int waitEvent(struct rtser_event *event);
 
         int clean(void);
@@ -181,7 +181,7 @@ int tims_recvmsg_timed(int fd, tims_msg_head *p_head, void *p_data,
 }
 
 int tims_mbx_create(uint32_t address, int messageSlots, ssize_t messageSize,
-                    void *buffer, ssize_t buffer_size)
+                    void *buffer, ssize_t buffer_size, int flags)
 {
     int fd, ret;
 
@@ -227,8 +227,8 @@ int tims_mbx_create(uint32_t address, int messageSlots, ssize_t messageSize,
     }
 
     // minimize transmission latency
-    int flags = 1;
-    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, (char*)&flags, sizeof(flags));
+    int nodelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, (char*)&nodelay, sizeof(nodelay));
 
     // disable watchdog
     tims_fill_head(&msg, TIMS_MSG_ROUTER_DISABLE_WATCHDOG, 0, 0, 0, 0, 0, sizeof(msg));
@@ -62,6 +62,9 @@ typedef struct
 #define TIMS_INFINITE               (0)                 /**< @ingroup main_tims */
 #define TIMS_NONBLOCK               ((int64_t)-1)       /**< @ingroup main_tims */
 
+/* mailbox flags (tims_mbx_create) */
+#define TIMS_MBX_LATEST             0x01                /**< @ingroup main_tims */
+
 //
 // common static inline functions
 //
@@ -86,10 +86,14 @@ int tims_recvmsg_timed(int fd, tims_msg_head *p_head, void *p_data,
 /**
  * creates a mailbox
  *
+ * If TIMS_MBX_LATEST is set in @a flags the mailbox keeps only the newest
+ * unread message of every sender (latest-value mailbox). The Linux TCP
+ * backend ignores the flag, use RackMailbox::recvLatest() there.
+ *
  * @ingroup main_tims
  */
 int tims_mbx_create(uint32_t address, int messageSlots, ssize_t messageSize,
-                    void *buffer, ssize_t buffer_size);
+                    void *buffer, ssize_t buffer_size, int flags);
 
 /**
  * deletes a mailbox
@@ -70,6 +70,7 @@ typedef struct
                                   // >0 => Priority Queuing
     void        *buffer;         // NULL: kernel-located
     uint32_t    buffer_size;
+    uint32_t    flags;           // TIMS_MBX_LATEST
 } tims_mbx_cfg;
 
 typedef struct
@@ -94,7 +94,7 @@ int tims_recvmsg_timed(int fd, tims_msg_head *p_head, void *p_data,
 
 // creates a mailbox
 int tims_mbx_create(uint32_t address, int messageSlots, ssize_t messageSize,
-                    void *buffer, ssize_t buffer_size)
+                    void *buffer, ssize_t buffer_size, int flags)
 {
     int ret = 0;
     int fd  = -1;
@@ -103,7 +103,8 @@ int tims_mbx_create(uint32_t address, int messageSlots, ssize_t messageSize,
         msg_size:       messageSize,
         slot_count:     messageSlots,
         buffer:         buffer,
-        buffer_size:    buffer_size
+        buffer_size:    buffer_size,
+        flags:          flags
     };
 
     // small checks
@@ -388,6 +388,38 @@ static void _move_write_to_read(tims_mbx *p_mbx, tims_mbx_slot *write_slot)
 }
 
 
+// latest-value mailbox: the new message takes the place of an unread
+// message of the same sender (same type and priority) in the read list.
+// The old slot is freed and the number of readable messages is unchanged.
+static int _replace_read(tims_mbx *p_mbx, tims_mbx_slot *write_slot)
+{
+    tims_mbx_slot*  p_slot     = NULL;
+    tims_msg_head*  p_head     = NULL;
+    tims_msg_head*  p_head_new = (tims_msg_head *)write_slot->p_head_map;
+    struct list_head* p_list   = p_mbx->read_list.next; // first element
+
+    while (p_list != &p_mbx->read_list)
+    {
+        p_slot = list_entry(p_list, tims_mbx_slot, mbx_list);
+        p_head = (void *)p_slot->p_head_map;
+
+        if ((p_head->src      == p_head_new->src) &&
+            (p_head->type     == p_head_new->type) &&
+            (p_head->priority == p_head_new->priority))
+        {
+            list_move(&write_slot->mbx_list, &p_slot->mbx_list);
+            list_move_tail(&p_slot->mbx_list, &p_mbx->free_list);
+            p_mbx->slot_state.write--;
+            p_mbx->slot_state.free++;
+            return 1;
+        }
+        p_list = p_list->next;
+    }
+
+    return 0;
+}
+
+
 static void _move_write_to_free(tims_mbx *p_mbx, tims_mbx_slot *write_slot)
 {
     list_move_tail(&write_slot->mbx_list, &p_mbx->free_list);
@@ -558,6 +590,18 @@ void tims_put_write_slot(tims_mbx *p_mbx, tims_mbx_slot *slot)
                     slot->p_head, slot->p_head_map, p_mbx->address);
 
     rtdm_lock_get_irqsave(&p_mbx->list_lock, lock_ctx);
+
+    if (test_bit(TIMS_MBX_BIT_LATEST, &p_mbx->flags) &&
+        _replace_read(p_mbx, slot))
+    {
+        rtdm_lock_put_irqrestore(&p_mbx->list_lock, lock_ctx);
+
+        tims_dbgdetail("Replaced unread msg of %08x in mailbox %08x\n",
+                       ((tims_msg_head *)slot->p_head_map)->src,
+                       p_mbx->address);
+        return;
+    }
+
     _move_write_to_read(p_mbx, slot);
     rtdm_lock_put_irqrestore(&p_mbx->list_lock, lock_ctx);
 
@@ -1284,6 +1328,13 @@ static int init_mailbox(tims_ctx *p_ctx, tims_mbx_cfg *p_cfg,
     return -EINVAL;
   }
 
+  // latest-value mailboxes need message slots
+  if ((p_cfg->flags & TIMS_MBX_LATEST) &&
+      !p_cfg->slot_count) {
+    tims_error("latest-value mailbox needs message slots\n");
+    return -EINVAL;
+  }
+
   // check fifo mailbox size
   if (p_cfg->buffer &&      // local buffer
       !p_cfg->slot_count && // fifo mailbox
@@ -1324,6 +1375,10 @@ static int init_mailbox(tims_ctx *p_ctx, tims_mbx_cfg *p_cfg,
     }
   }
 
+  if (p_cfg->flags & TIMS_MBX_LATEST) {
+    set_bit(TIMS_MBX_BIT_LATEST, &p_mbx->flags);
+  }
+
   // init values
   rtdm_lock_init(&p_mbx->list_lock);
   INIT_LIST_HEAD(&p_mbx->free_list);
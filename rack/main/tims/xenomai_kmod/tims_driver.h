@@ -128,6 +128,7 @@ typedef struct tims_mbx
 #define TIMS_MBX_BIT_FIFO                   2
 #define TIMS_MBX_BIT_READERWAIT             3
 #define TIMS_MBX_BIT_USRSPCBUFFER           4
+#define TIMS_MBX_BIT_LATEST                 5
 
 //
 // tims context
@@ -16,20 +16,27 @@
 
 #include <main/camera_tool.h>
 
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+
 CameraTool::CameraTool()
 {
     gdos = NULL;
+    stripeInitVars();
     initColorTables();
 }
 
 CameraTool::CameraTool(RackMailbox *p_mbx, int gdos_level)
 {
     gdos = new RackGdos(p_mbx, gdos_level);
+    stripeInitVars();
     initColorTables();
 }
 
 CameraTool::~CameraTool()
 {
+    cleanupStripes();
     if (gdos)
         delete gdos;
 }
@@ -91,91 +98,884 @@ int CameraTool::clip(int in)
     return in;
 }
 
-int CameraTool::convertCharUYVY2RGB(uint8_t* outputData, uint8_t* inputData,
-                        int width, int height)
+//
+// simd support
+//
+
+#if defined (__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined (__SSE2__) && (defined (__x86_64__) || defined (__i386__)) && !defined (__clang__) && \
+    ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9)))
+#define CAMERA_TOOL_USE_AVX2
+#include <immintrin.h>
+#endif
+
+static int cameraToolSimdLevel = -1;
+
+// limits the instruction set of the conversions, e.g. for comparisons
+void CameraTool::setSimdLevel(int level)
 {
-    int i,j;
-    int u,y0,v,y1;
+    cameraToolSimdLevel = -1;
+    if (level < getSimdLevel())
+    {
+        cameraToolSimdLevel = level < 0 ? CAMERA_TOOL_SIMD_NONE : level;
+    }
+}
 
-    for (i = 0; i < height; i++)
+int CameraTool::getSimdLevel(void)
+{
+    if (cameraToolSimdLevel < 0)
+    {
+        cameraToolSimdLevel = CAMERA_TOOL_SIMD_NONE;
+#if defined (__SSE2__)
+        cameraToolSimdLevel = CAMERA_TOOL_SIMD_SSE2;
+#endif
+#if defined (CAMERA_TOOL_USE_AVX2)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+        {
+            cameraToolSimdLevel = CAMERA_TOOL_SIMD_AVX2;
+        }
+#endif
+    }
+    return cameraToolSimdLevel;
+}
+
+static inline int avg2(int a, int b)
+{
+    return (a + b + 1) >> 1;
+}
+
+//
+// scalar kernels, the simd kernels give the same results
+//
+
+// uyvy pixel pairs, p516 / g / p409 are the byte positions of the channels
+static void uyvyScalar(uint8_t *out, const uint8_t *in, int n, int p516, int p409)
+{
+    int k, u, y0, v, y1;
+
+    for (k = 0; k < n; k += 2, in += 4, out += 6)
+    {
+        u  = in[0] - 128;
+        y0 = 298 * (in[1] - 16);
+        v  = in[2] - 128;
+        y1 = 298 * (in[3] - 16);
+
+        out[p409]     = (uint8_t)CameraTool::clip((y0            + 409 * v + 128) >> 8);
+        out[1]        = (uint8_t)CameraTool::clip((y0 - 100 * u  - 208 * v + 128) >> 8);
+        out[p516]     = (uint8_t)CameraTool::clip((y0 + 516 * u            + 128) >> 8);
+
+        out[p409 + 3] = (uint8_t)CameraTool::clip((y1            + 409 * v + 128) >> 8);
+        out[4]        = (uint8_t)CameraTool::clip((y1 - 100 * u  - 208 * v + 128) >> 8);
+        out[p516 + 3] = (uint8_t)CameraTool::clip((y1 + 516 * u            + 128) >> 8);
+    }
+}
+
+static void uyvyGrayScalar(uint8_t *out, const uint8_t *in, int n)
+{
+    int k;
+
+    for (k = 0; k < n; k++)
+    {
+        out[k] = in[2 * k + 1];
+    }
+}
+
+// big endian 16 bit pixels, shift = depth - 8
+static void mono16Scalar(uint8_t *out, const uint8_t *in, int n, int shift)
+{
+    int k, val;
+
+    for (k = 0; k < n; k++)
+    {
+        val    = ((in[2 * k] << 8) | in[2 * k + 1]) >> shift;
+        out[k] = val > 255 ? 255 : val;
+    }
+}
+
+// one bayer pixel, rows and columns are mirrored at the border
+static inline void bayerPixel(uint8_t *out, const uint8_t *up, const uint8_t *row,
+                              const uint8_t *down, int x, int width, int nonGreen,
+                              int red, int edge)
+{
+    int xl = x > 0 ? x - 1 : 1;
+    int xr = x < width - 1 ? x + 1 : width - 2;
+    int h, v, g, diag, dh, dv, c0, c1, c2;
+
+    h    = avg2(row[xl], row[xr]);
+    v    = avg2(up[x], down[x]);
+    g    = avg2(h, v);
+    diag = avg2(avg2(up[xl], up[xr]), avg2(down[xl], down[xr]));
+
+    if (edge)
+    {
+        dh = abs(row[xl] - row[xr]);
+        dv = abs(up[x] - down[x]);
+        if (dh < dv)
+            g = h;
+        else if (dv < dh)
+            g = v;
+    }
+
+    // channel of the row (red or blue), green, other channel
+    if ((x & 1) == nonGreen)
+    {
+        c0 = row[x];
+        c1 = g;
+        c2 = diag;
+    }
+    else
+    {
+        c0 = h;
+        c1 = row[x];
+        c2 = v;
+    }
+
+    out += 3 * x;
+    out[0] = red ? c0 : c2;
+    out[1] = c1;
+    out[2] = red ? c2 : c0;
+}
+
+#if defined (__SSE2__)
+
+//
+// sse2 kernels
+//
+
+static inline __m128i sse2Select(__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+// writes 4 pixels (c0 | c1 << 8 | c2 << 16 per 32 bit lane) as 12 bytes,
+// 16 bytes are stored
+static inline void sse2StoreRgb4(uint8_t *out, __m128i v)
+{
+    const __m128i lo32 = _mm_set_epi32(0, -1, 0, -1);
+    const __m128i lo64 = _mm_set_epi32(0, 0, -1, -1);
+
+    v = _mm_or_si128(_mm_and_si128(lo32, v), _mm_srli_epi64(_mm_andnot_si128(lo32, v), 8));
+    v = _mm_or_si128(_mm_and_si128(lo64, v), _mm_srli_si128(_mm_andnot_si128(lo64, v), 2));
+    _mm_storeu_si128((__m128i *)out, v);
+}
+
+// writes the lower 8 pixels of the channels, 28 bytes are stored
+static inline void sse2StoreRgb8(uint8_t *out, __m128i c0, __m128i c1, __m128i c2)
+{
+    __m128i a = _mm_unpacklo_epi8(c0, c1);
+    __m128i b = _mm_unpacklo_epi8(c2, _mm_setzero_si128());
+
+    sse2StoreRgb4(out,      _mm_unpacklo_epi16(a, b));
+    sse2StoreRgb4(out + 12, _mm_unpackhi_epi16(a, b));
+}
+
+// writes 16 pixels, 52 bytes are stored
+static inline void sse2StoreRgb16(uint8_t *out, __m128i c0, __m128i c1, __m128i c2)
+{
+    sse2StoreRgb8(out, c0, c1, c2);
+    sse2StoreRgb8(out + 24, _mm_unpackhi_epi64(c0, c0), _mm_unpackhi_epi64(c1, c1),
+                  _mm_unpackhi_epi64(c2, c2));
+}
+
+static int uyvySse2(uint8_t *out, const uint8_t *in, int n, int p516, int p409)
+{
+    const __m128i k16   = _mm_set1_epi16(16);
+    const __m128i k128  = _mm_set1_epi16(128);
+    const __m128i r128  = _mm_set1_epi32(128);
+    const __m128i low   = _mm_set1_epi16(0x00ff);
+    const __m128i c409  = _mm_set_epi16( 409, 298,  409, 298,  409, 298,  409, 298);
+    const __m128i c516  = _mm_set_epi16( 516, 298,  516, 298,  516, 298,  516, 298);
+    const __m128i cgu   = _mm_set_epi16(-100, 298, -100, 298, -100, 298, -100, 298);
+    const __m128i cgv   = _mm_set_epi16(-208,   0, -208,   0, -208,   0, -208,   0);
+    __m128i src, y, uv, u, v, yu, yv, ch409[2], ch516[2], chg[2], c409b, c516b, cgb;
+    int k, i;
+
+    // 8 pixels, the last 4 stored bytes belong to the following pixels
+    for (k = 0; k + 10 <= n; k += 8, in += 16, out += 24)
+    {
+        src = _mm_loadu_si128((__m128i *)in);
+        y   = _mm_sub_epi16(_mm_srli_epi16(src, 8), k16);
+        uv  = _mm_sub_epi16(_mm_and_si128(src, low), k128);
+        u   = _mm_shufflehi_epi16(_mm_shufflelo_epi16(uv, _MM_SHUFFLE(2, 2, 0, 0)),
+                                  _MM_SHUFFLE(2, 2, 0, 0));
+        v   = _mm_shufflehi_epi16(_mm_shufflelo_epi16(uv, _MM_SHUFFLE(3, 3, 1, 1)),
+                                  _MM_SHUFFLE(3, 3, 1, 1));
+
+        for (i = 0; i < 2; i++)
+        {
+            yu = i ? _mm_unpackhi_epi16(y, u) : _mm_unpacklo_epi16(y, u);
+            yv = i ? _mm_unpackhi_epi16(y, v) : _mm_unpacklo_epi16(y, v);
+
+            ch409[i] = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yv, c409), r128), 8);
+            ch516[i] = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yu, c516), r128), 8);
+            chg[i]   = _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(yu, cgu),
+                                                                  _mm_madd_epi16(yv, cgv)), r128), 8);
+        }
+
+        // saturation clips to 0 ... 255
+        c409b = _mm_packs_epi32(ch409[0], ch409[1]);
+        c409b = _mm_packus_epi16(c409b, c409b);
+        c516b = _mm_packs_epi32(ch516[0], ch516[1]);
+        c516b = _mm_packus_epi16(c516b, c516b);
+        cgb   = _mm_packs_epi32(chg[0], chg[1]);
+        cgb   = _mm_packus_epi16(cgb, cgb);
+
+        if (p516 == 0)
+            sse2StoreRgb8(out, c516b, cgb, c409b);
+        else
+            sse2StoreRgb8(out, c409b, cgb, c516b);
+    }
+    return k;
+}
+
+static int uyvyGraySse2(uint8_t *out, const uint8_t *in, int n)
+{
+    int k;
+
+    for (k = 0; k + 16 <= n; k += 16, in += 32, out += 16)
+    {
+        _mm_storeu_si128((__m128i *)out,
+                         _mm_packus_epi16(_mm_srli_epi16(_mm_loadu_si128((__m128i *)in), 8),
+                                          _mm_srli_epi16(_mm_loadu_si128((__m128i *)(in + 16)), 8)));
+    }
+    return k;
+}
+
+static int mono16Sse2(uint8_t *out, const uint8_t *in, int n, int shift)
+{
+    const __m128i low = _mm_set1_epi16(0x00ff);
+    const __m128i sl  = _mm_cvtsi32_si128(8 - shift);
+    const __m128i sr  = _mm_cvtsi32_si128(8 + shift);
+    __m128i a, b;
+    int k;
+
+    // the high byte is the first one
+    for (k = 0; k + 16 <= n; k += 16, in += 32, out += 16)
+    {
+        a = _mm_loadu_si128((__m128i *)in);
+        b = _mm_loadu_si128((__m128i *)(in + 16));
+        a = _mm_or_si128(_mm_sll_epi16(_mm_and_si128(a, low), sl), _mm_srl_epi16(a, sr));
+        b = _mm_or_si128(_mm_sll_epi16(_mm_and_si128(b, low), sl), _mm_srl_epi16(b, sr));
+        _mm_storeu_si128((__m128i *)out, _mm_packus_epi16(a, b));
+    }
+    return k;
+}
+
+// starts at an odd x, the last 4 stored bytes belong to the following pixels
+static int bayerSse2(uint8_t *out, const uint8_t *up, const uint8_t *row, const uint8_t *down,
+                     int width, int x, int nonGreen, int red, int edge)
+{
+    const __m128i mask = _mm_set1_epi16(nonGreen ? 0x00ff : (short)0xff00);
+    __m128i c, l, r, u, d, h, v, g, diag, dh, dv, mn, leH, leV, c0, c1, c2;
+
+    for (; x + 18 <= width; x += 16)
+    {
+        c    = _mm_loadu_si128((__m128i *)(row + x));
+        l    = _mm_loadu_si128((__m128i *)(row + x - 1));
+        r    = _mm_loadu_si128((__m128i *)(row + x + 1));
+        u    = _mm_loadu_si128((__m128i *)(up + x));
+        d    = _mm_loadu_si128((__m128i *)(down + x));
+
+        h    = _mm_avg_epu8(l, r);
+        v    = _mm_avg_epu8(u, d);
+        g    = _mm_avg_epu8(h, v);
+        diag = _mm_avg_epu8(_mm_avg_epu8(_mm_loadu_si128((__m128i *)(up + x - 1)),
+                                         _mm_loadu_si128((__m128i *)(up + x + 1))),
+                            _mm_avg_epu8(_mm_loadu_si128((__m128i *)(down + x - 1)),
+                                         _mm_loadu_si128((__m128i *)(down + x + 1))));
+        if (edge)
+        {
+            dh  = _mm_or_si128(_mm_subs_epu8(l, r), _mm_subs_epu8(r, l));
+            dv  = _mm_or_si128(_mm_subs_epu8(u, d), _mm_subs_epu8(d, u));
+            mn  = _mm_min_epu8(dh, dv);
+            leH = _mm_cmpeq_epi8(mn, dh);
+            leV = _mm_cmpeq_epi8(mn, dv);
+            g   = sse2Select(_mm_andnot_si128(leV, leH), h,
+                             sse2Select(_mm_andnot_si128(leH, leV), v, g));
+        }
+
+        c0 = sse2Select(mask, c, h);
+        c1 = sse2Select(mask, g, c);
+        c2 = sse2Select(mask, diag, v);
+
+        if (red)
+            sse2StoreRgb16(out + 3 * x, c0, c1, c2);
+        else
+            sse2StoreRgb16(out + 3 * x, c2, c1, c0);
+    }
+    return x;
+}
+
+#endif // __SSE2__
+
+#if defined (CAMERA_TOOL_USE_AVX2)
+
+//
+// avx2 kernels, the lanes are written by the sse2 functions
+//
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+
+static inline __m256i avx2Select(__m256i mask, __m256i a, __m256i b)
+{
+    return _mm256_or_si256(_mm256_and_si256(mask, a), _mm256_andnot_si256(mask, b));
+}
+
+static int uyvyAvx2(uint8_t *out, const uint8_t *in, int n, int p516, int p409)
+{
+    const __m256i k16   = _mm256_set1_epi16(16);
+    const __m256i k128  = _mm256_set1_epi16(128);
+    const __m256i r128  = _mm256_set1_epi32(128);
+    const __m256i low   = _mm256_set1_epi16(0x00ff);
+    const __m256i c409  = _mm256_set1_epi32((409 << 16) | 298);
+    const __m256i c516  = _mm256_set1_epi32((516 << 16) | 298);
+    const __m256i cgu   = _mm256_set1_epi32((int)(0xff9c0000u | 298));     // -100, 298
+    const __m256i cgv   = _mm256_set1_epi32((int)0xff300000u);              // -208, 0
+    __m256i src, y, uv, u, v, yu, yv, ch409[2], ch516[2], chg[2], c409b, c516b, cgb;
+    int k, i;
+
+    // 16 pixels, 8 per lane
+    for (k = 0; k + 18 <= n; k += 16, in += 32, out += 48)
     {
-        for (j = 0; j < width; j += 2) //step = 2
-        {//handling 4 byte <=> 2 pixel each turn
-            u  = (int) (0xff & inputData[2 * (i * width + j) + 0]);
-            y0 = (int) (0xff & inputData[2 * (i * width + j) + 1]);
-            v  = (int) (0xff & inputData[2 * (i * width + j) + 2]);
-            y1 = (int) (0xff & inputData[2 * (i * width + j) + 3]);
+        src = _mm256_loadu_si256((__m256i *)in);
+        y   = _mm256_sub_epi16(_mm256_srli_epi16(src, 8), k16);
+        uv  = _mm256_sub_epi16(_mm256_and_si256(src, low), k128);
+        u   = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(uv, _MM_SHUFFLE(2, 2, 0, 0)),
+                                     _MM_SHUFFLE(2, 2, 0, 0));
+        v   = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(uv, _MM_SHUFFLE(3, 3, 1, 1)),
+                                     _MM_SHUFFLE(3, 3, 1, 1));
 
-            outputData[3 * (i * width + j) + 2] = (uint8_t) clip(( 298 * (y0-16)                 + 409 * (v-128) + 128) >> 8);//bo
-            outputData[3 * (i * width + j) + 1] = (uint8_t) clip(( 298 * (y0-16) - 100 * (u-128) - 208 * (v-128) + 128) >> 8);//g0
-            outputData[3 * (i * width + j) + 0] = (uint8_t) clip(( 298 * (y0-16) + 516 * (u-128)                 + 128) >> 8);//r0
+        for (i = 0; i < 2; i++)
+        {
+            yu = i ? _mm256_unpackhi_epi16(y, u) : _mm256_unpacklo_epi16(y, u);
+            yv = i ? _mm256_unpackhi_epi16(y, v) : _mm256_unpacklo_epi16(y, v);
 
-            outputData[3 * (i * width + j) + 5] = (uint8_t) clip(( 298 * (y1-16)                 + 409 * (v-128) + 128) >> 8);
-            outputData[3 * (i * width + j) + 4] = (uint8_t) clip(( 298 * (y1-16) - 100 * (u-128) - 208 * (v-128) + 128) >> 8);
-            outputData[3 * (i * width + j) + 3] = (uint8_t) clip(( 298 * (y1-16) + 516 * (u-128)                 + 128) >> 8);
+            ch409[i] = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yv, c409), r128), 8);
+            ch516[i] = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yu, c516), r128), 8);
+            chg[i]   = _mm256_srai_epi32(_mm256_add_epi32(_mm256_add_epi32(_mm256_madd_epi16(yu, cgu),
+                                                                           _mm256_madd_epi16(yv, cgv)),
+                                                          r128), 8);
         }
+
+        c409b = _mm256_packs_epi32(ch409[0], ch409[1]);
+        c409b = _mm256_packus_epi16(c409b, c409b);
+        c516b = _mm256_packs_epi32(ch516[0], ch516[1]);
+        c516b = _mm256_packus_epi16(c516b, c516b);
+        cgb   = _mm256_packs_epi32(chg[0], chg[1]);
+        cgb   = _mm256_packus_epi16(cgb, cgb);
+
+        if (p516 != 0)
+        {
+            src   = c516b;
+            c516b = c409b;
+            c409b = src;
+        }
+        sse2StoreRgb8(out, _mm256_castsi256_si128(c516b), _mm256_castsi256_si128(cgb),
+                      _mm256_castsi256_si128(c409b));
+        sse2StoreRgb8(out + 24, _mm256_extracti128_si256(c516b, 1), _mm256_extracti128_si256(cgb, 1),
+                      _mm256_extracti128_si256(c409b, 1));
+    }
+    return k;
+}
+
+static int uyvyGrayAvx2(uint8_t *out, const uint8_t *in, int n)
+{
+    __m256i a;
+    int k;
+
+    for (k = 0; k + 32 <= n; k += 32, in += 64, out += 32)
+    {
+        a = _mm256_packus_epi16(_mm256_srli_epi16(_mm256_loadu_si256((__m256i *)in), 8),
+                                _mm256_srli_epi16(_mm256_loadu_si256((__m256i *)(in + 32)), 8));
+        _mm256_storeu_si256((__m256i *)out, _mm256_permute4x64_epi64(a, _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+    return k;
+}
+
+static int mono16Avx2(uint8_t *out, const uint8_t *in, int n, int shift)
+{
+    const __m256i low = _mm256_set1_epi16(0x00ff);
+    const __m128i sl  = _mm_cvtsi32_si128(8 - shift);
+    const __m128i sr  = _mm_cvtsi32_si128(8 + shift);
+    __m256i a, b;
+    int k;
+
+    for (k = 0; k + 32 <= n; k += 32, in += 64, out += 32)
+    {
+        a = _mm256_loadu_si256((__m256i *)in);
+        b = _mm256_loadu_si256((__m256i *)(in + 32));
+        a = _mm256_or_si256(_mm256_sll_epi16(_mm256_and_si256(a, low), sl), _mm256_srl_epi16(a, sr));
+        b = _mm256_or_si256(_mm256_sll_epi16(_mm256_and_si256(b, low), sl), _mm256_srl_epi16(b, sr));
+        a = _mm256_packus_epi16(a, b);
+        _mm256_storeu_si256((__m256i *)out, _mm256_permute4x64_epi64(a, _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+    return k;
+}
+
+static int bayerAvx2(uint8_t *out, const uint8_t *up, const uint8_t *row, const uint8_t *down,
+                     int width, int x, int nonGreen, int red, int edge)
+{
+    const __m256i mask = _mm256_set1_epi16(nonGreen ? 0x00ff : (short)0xff00);
+    __m256i c, l, r, u, d, h, v, g, diag, dh, dv, mn, leH, leV, c0, c1, c2;
+
+    for (; x + 34 <= width; x += 32)
+    {
+        c    = _mm256_loadu_si256((__m256i *)(row + x));
+        l    = _mm256_loadu_si256((__m256i *)(row + x - 1));
+        r    = _mm256_loadu_si256((__m256i *)(row + x + 1));
+        u    = _mm256_loadu_si256((__m256i *)(up + x));
+        d    = _mm256_loadu_si256((__m256i *)(down + x));
+
+        h    = _mm256_avg_epu8(l, r);
+        v    = _mm256_avg_epu8(u, d);
+        g    = _mm256_avg_epu8(h, v);
+        diag = _mm256_avg_epu8(_mm256_avg_epu8(_mm256_loadu_si256((__m256i *)(up + x - 1)),
+                                               _mm256_loadu_si256((__m256i *)(up + x + 1))),
+                               _mm256_avg_epu8(_mm256_loadu_si256((__m256i *)(down + x - 1)),
+                                               _mm256_loadu_si256((__m256i *)(down + x + 1))));
+        if (edge)
+        {
+            dh  = _mm256_or_si256(_mm256_subs_epu8(l, r), _mm256_subs_epu8(r, l));
+            dv  = _mm256_or_si256(_mm256_subs_epu8(u, d), _mm256_subs_epu8(d, u));
+            mn  = _mm256_min_epu8(dh, dv);
+            leH = _mm256_cmpeq_epi8(mn, dh);
+            leV = _mm256_cmpeq_epi8(mn, dv);
+            g   = avx2Select(_mm256_andnot_si256(leV, leH), h,
+                             avx2Select(_mm256_andnot_si256(leH, leV), v, g));
+        }
+
+        c0 = avx2Select(mask, c, h);
+        c1 = avx2Select(mask, g, c);
+        c2 = avx2Select(mask, diag, v);
+        if (!red)
+        {
+            h  = c0;
+            c0 = c2;
+            c2 = h;
+        }
+
+        sse2StoreRgb16(out + 3 * x, _mm256_castsi256_si128(c0), _mm256_castsi256_si128(c1),
+                       _mm256_castsi256_si128(c2));
+        sse2StoreRgb16(out + 3 * x + 48, _mm256_extracti128_si256(c0, 1),
+                       _mm256_extracti128_si256(c1, 1), _mm256_extracti128_si256(c2, 1));
+    }
+    return x;
+}
+
+#pragma GCC pop_options
+
+#endif // CAMERA_TOOL_USE_AVX2
+
+//
+// row conversions
+//
+
+static void uyvyRun(uint8_t *out, const uint8_t *in, int n, int p516, int p409)
+{
+    int k = 0, level = CameraTool::getSimdLevel();
+
+#if defined (CAMERA_TOOL_USE_AVX2)
+    if (level >= CAMERA_TOOL_SIMD_AVX2)
+        k = uyvyAvx2(out, in, n, p516, p409);
+#endif
+#if defined (__SSE2__)
+    if (level >= CAMERA_TOOL_SIMD_SSE2)
+        k += uyvySse2(out + 3 * k, in + 2 * k, n - k, p516, p409);
+#endif
+    uyvyScalar(out + 3 * k, in + 2 * k, n - k, p516, p409);
+}
+
+static void uyvyGrayRun(uint8_t *out, const uint8_t *in, int n)
+{
+    int k = 0, level = CameraTool::getSimdLevel();
+
+#if defined (CAMERA_TOOL_USE_AVX2)
+    if (level >= CAMERA_TOOL_SIMD_AVX2)
+        k = uyvyGrayAvx2(out, in, n);
+#endif
+#if defined (__SSE2__)
+    if (level >= CAMERA_TOOL_SIMD_SSE2)
+        k += uyvyGraySse2(out + k, in + 2 * k, n - k);
+#endif
+    uyvyGrayScalar(out + k, in + 2 * k, n - k);
+}
+
+static void mono16Run(uint8_t *out, const uint8_t *in, int n, int shift)
+{
+    int k = 0, level = CameraTool::getSimdLevel();
+
+#if defined (CAMERA_TOOL_USE_AVX2)
+    if (level >= CAMERA_TOOL_SIMD_AVX2)
+        k = mono16Avx2(out, in, n, shift);
+#endif
+#if defined (__SSE2__)
+    if (level >= CAMERA_TOOL_SIMD_SSE2)
+        k += mono16Sse2(out + k, in + 2 * k, n - k, shift);
+#endif
+    mono16Scalar(out + k, in + 2 * k, n - k, shift);
+}
+
+static void bayerRows(uint8_t *out, const uint8_t *in, int width, int height,
+                      int colorFilterId, int edge, int rowStart, int rowEnd)
+{
+    const uint8_t   *up, *row, *down;
+    uint8_t         *o;
+    int             level = CameraTool::getSimdLevel();
+    int             y, x, red0, nonGreen0, red, nonGreen;
+
+    // color of the non green pixels in row 0 and their column
+    switch (colorFilterId)
+    {
+        case COLORFILTER_GBRG:
+            red0      = 0;
+            nonGreen0 = 1;
+            break;
+        case COLORFILTER_GRBG:
+            red0      = 1;
+            nonGreen0 = 1;
+            break;
+        case COLORFILTER_BGGR:
+            red0      = 0;
+            nonGreen0 = 0;
+            break;
+        default:    // COLORFILTER_RGGB
+            red0      = 1;
+            nonGreen0 = 0;
+            break;
+    }
+
+    for (y = rowStart; y < rowEnd; y++)
+    {
+        up       = in + (y > 0 ? y - 1 : 1) * width;
+        row      = in + y * width;
+        down     = in + (y < height - 1 ? y + 1 : height - 2) * width;
+        o        = out + 3 * y * width;
+        red      = (y & 1) ? !red0 : red0;
+        nonGreen = (y & 1) ? !nonGreen0 : nonGreen0;
+
+        bayerPixel(o, up, row, down, 0, width, nonGreen, red, edge);
+        x = 1;
+
+#if defined (CAMERA_TOOL_USE_AVX2)
+        if (level >= CAMERA_TOOL_SIMD_AVX2)
+            x = bayerAvx2(o, up, row, down, width, x, nonGreen, red, edge);
+#endif
+#if defined (__SSE2__)
+        if (level >= CAMERA_TOOL_SIMD_SSE2)
+            x = bayerSse2(o, up, row, down, width, x, nonGreen, red, edge);
+#endif
+        for (; x < width; x++)
+        {
+            bayerPixel(o, up, row, down, x, width, nonGreen, red, edge);
+        }
+    }
+}
+
+// converts the rows rowStart ... rowEnd - 1 of the image
+int CameraTool::convertRows(int type, uint8_t* outputData, uint8_t* inputData, int width,
+                            int height, int colorFilterId, int rowStart, int rowEnd)
+{
+    int n = (rowEnd - rowStart) * width;
+
+    if ((width < 2) || (height < 2) || (rowStart < 0) || (rowEnd > height) ||
+        (rowStart >= rowEnd))
+    {
+        return -EINVAL;
+    }
+
+    switch (type)
+    {
+        case CAMERA_TOOL_UYVY2RGB:
+        case CAMERA_TOOL_UYVY2BGR:
+            if (width & 1)
+                return -EINVAL;
+            uyvyRun(outputData + 3 * rowStart * width, inputData + 2 * rowStart * width, n,
+                    type == CAMERA_TOOL_UYVY2RGB ? 0 : 2, type == CAMERA_TOOL_UYVY2RGB ? 2 : 0);
+            break;
+
+        case CAMERA_TOOL_UYVY2GRAY:
+            uyvyGrayRun(outputData + rowStart * width, inputData + 2 * rowStart * width, n);
+            break;
+
+        case CAMERA_TOOL_BAYER2RGB:
+        case CAMERA_TOOL_BAYER2RGB_EDGE:
+            bayerRows(outputData, inputData, width, height, colorFilterId,
+                      type == CAMERA_TOOL_BAYER2RGB_EDGE, rowStart, rowEnd);
+            break;
+
+        case CAMERA_TOOL_MONO122MONO8:
+        case CAMERA_TOOL_MONO162MONO8:
+            mono16Run(outputData + rowStart * width, inputData + 2 * rowStart * width, n,
+                      type == CAMERA_TOOL_MONO122MONO8 ? 4 : 8);
+            break;
+
+        default:
+            return -EINVAL;
     }
     return 0;
 }
 
+int CameraTool::convertCharUYVY2RGB(uint8_t* outputData, uint8_t* inputData,
+                        int width, int height)
+{
+    return convertRows(CAMERA_TOOL_UYVY2RGB, outputData, inputData, width, height, 0, 0, height);
+}
 
 int CameraTool::convertCharUYVY2BGR(uint8_t* outputData, uint8_t* inputData,
                                int width, int height)
 {
-    int i,j;
-    int u,y0,v,y1;
+    return convertRows(CAMERA_TOOL_UYVY2BGR, outputData, inputData, width, height, 0, 0, height);
+}
 
-    for (i = 0; i < height; i++)
+int CameraTool::convertCharUYVY2Gray(uint8_t* outputData, uint8_t* inputData,
+                                int width, int height)
+{
+    return convertRows(CAMERA_TOOL_UYVY2GRAY, outputData, inputData, width, height, 0, 0, height);
+}
+
+int CameraTool::convertCharBayer2RGB(uint8_t* outputData, uint8_t* inputData, int width,
+                                     int height, int colorFilterId, int edgeAware)
+{
+    return convertRows(edgeAware ? CAMERA_TOOL_BAYER2RGB_EDGE : CAMERA_TOOL_BAYER2RGB,
+                       outputData, inputData, width, height, colorFilterId, 0, height);
+}
+
+// big endian 12 or 16 bit pixels to 8 bit
+int CameraTool::convertCharMono162Mono8(uint8_t* outputData, uint8_t* inputData, int width,
+                                        int height, int depth)
+{
+    return convertRows(depth == 12 ? CAMERA_TOOL_MONO122MONO8 : CAMERA_TOOL_MONO162MONO8,
+                       outputData, inputData, width, height, 0, 0, height);
+}
+
+// conversions and filters of the row stripes
+static int processRows(int type, uint8_t* outputData, uint8_t* inputData, int width,
+                       int height, int param, int rowStart, int rowEnd)
+{
+    if (type >= CAMERA_TOOL_MEDIAN16)
     {
-        for (j = 0; j < width; j += 2) //step = 2
-        {//handling 4 byte <=> 2 pixel each turn
-            u  = (int) (0xff & inputData[2 * (i * width + j) + 0]);
-            y0 = (int) (0xff & inputData[2 * (i * width + j) + 1]);
-            v  = (int) (0xff & inputData[2 * (i * width + j) + 2]);
-            y1 = (int) (0xff & inputData[2 * (i * width + j) + 3]);
-            outputData[3 * (i * width + j) + 0] = (uint8_t) clip(( 298 * (y0-16)                 + 409 * (v-128) + 128) >> 8);//bo
-            outputData[3 * (i * width + j) + 1] = (uint8_t) clip(( 298 * (y0-16) - 100 * (u-128) - 208 * (v-128) + 128) >> 8);//g0
-            outputData[3 * (i * width + j) + 2] = (uint8_t) clip(( 298 * (y0-16) + 516 * (u-128)                 + 128) >> 8);//r0
+        return CameraTool::filterRows(type, (short *)outputData, (short *)inputData, width,
+                                      height, param, rowStart, rowEnd);
+    }
+    return CameraTool::convertRows(type, outputData, inputData, width, height, param,
+                                   rowStart, rowEnd);
+}
+
+//
+// row stripes
+//
+// The rows are split into stripes which are converted by the calling task
+// and a pool of worker tasks. The stripes only write their own rows.
+// The workers wait in the job mailbox for a job message and reply to the
+// done mailbox after their last stripe.
+//
+
+void camera_tool_stripe_task_proc(void *arg)
+{
+    CameraTool  *p_tool = (CameraTool *)arg;
+    RackMessage msgInfo;
 
-            outputData[3 * (i * width + j) + 3] = (uint8_t) clip(( 298 * (y1-16)                 + 409 * (v-128) + 128) >> 8);
-            outputData[3 * (i * width + j) + 4] = (uint8_t) clip(( 298 * (y1-16) - 100 * (u-128) - 208 * (v-128) + 128) >> 8);
-            outputData[3 * (i * width + j) + 5] = (uint8_t) clip(( 298 * (y1-16) + 516 * (u-128)                 + 128) >> 8);
+    while (1)
+    {
+        if (p_tool->stripeJobMbx->recvMsg(&msgInfo))
+            return;
+        if (msgInfo.getType() == CAMERA_TOOL_MSG_STOP)
+            return;
+
+        p_tool->stripeProcess();
+        p_tool->stripeJobMbx->sendMsg(CAMERA_TOOL_MSG_DONE, p_tool->stripeDoneMbx->getAdr(), 0);
+    }
+}
+
+void CameraTool::stripeInitVars(void)
+{
+    stripeWorkerNum = 0;
+    stripeInit      = 0;
+    stripeJobMbx    = NULL;
+    stripeDoneMbx   = NULL;
+    stripeNum       = 0;
+    stripeNext      = 0;
+}
+
+// creates workerNum worker tasks, jobMbx and doneMbx need workerNum slots
+// for messages without data
+int CameraTool::initStripes(int workerNum, int prio, RackMailbox *jobMbx, RackMailbox *doneMbx)
+{
+    char    taskName[30];
+    int     i, ret;
+
+    cleanupStripes();
+
+    if (workerNum > CAMERA_TOOL_WORKER_NUM_MAX)
+        workerNum = CAMERA_TOOL_WORKER_NUM_MAX;
+
+    if ((workerNum > 0) && (!jobMbx || !doneMbx))
+        return -EINVAL;
+
+    ret = stripeMtx.create();
+    if (ret)
+        return ret;
+
+    stripeInit      = 1;
+    stripeJobMbx    = jobMbx;
+    stripeDoneMbx   = doneMbx;
+    if (workerNum > 0)
+    {
+        jobMbx->clean();
+        doneMbx->clean();
+    }
+
+    for (i = 0; i < workerNum; i++)
+    {
+        snprintf(taskName, sizeof(taskName), "camTool%p_%d", (void *)this, i);
+        ret = stripeTask[i].create(taskName, 0, prio, RACK_TASK_FPU | RACK_TASK_JOINABLE);
+        if (!ret)
+        {
+            ret = stripeTask[i].start(&camera_tool_stripe_task_proc, this);
+            if (ret)
+                stripeTask[i].destroy();
         }
+        if (ret)
+            break;
+    }
+    stripeWorkerNum = i;
+
+    if (stripeWorkerNum < workerNum)
+    {
+        GDOS_WARNING("Can't create all conversion workers, using %d of %d\n",
+                     stripeWorkerNum, workerNum);
     }
     return 0;
 }
 
+// stops the worker tasks
+void CameraTool::cleanupStripes(void)
+{
+    int i;
 
-int CameraTool::convertCharUYVY2Gray(uint8_t* outputData, uint8_t* inputData,
-                                int width, int height)
+    if (!stripeInit)
+        return;
+
+    for (i = 0; i < stripeWorkerNum; i++)
+    {
+        stripeDoneMbx->sendMsg(CAMERA_TOOL_MSG_STOP, stripeJobMbx->getAdr(), 0);
+    }
+    for (i = 0; i < stripeWorkerNum; i++)
+    {
+        stripeTask[i].join();
+        stripeTask[i].destroy();
+    }
+    stripeMtx.destroy();
+    stripeInitVars();
+}
+
+// converts stripes of the actual job until all stripes are taken
+void CameraTool::stripeProcess(void)
 {
-    int i,j;
+    int stripe, rowStart, rowEnd;
 
-    for (i = 0; i < height; i++)
+    while (1)
     {
-        for (j = 0; j < width; j++ )
+        stripeMtx.lock(RACK_INFINITE);
+        if (stripeNext >= stripeNum)
         {
-            outputData[i * width + j] = inputData[(2 * (i * width + j)) + 1];
+            stripeMtx.unlock();
+            return;
         }
+        stripe = stripeNext++;
+        stripeMtx.unlock();
+
+        rowStart = stripe * stripeRows;
+        rowEnd   = rowStart + stripeRows;
+        if (rowEnd > stripeHeight)
+            rowEnd = stripeHeight;
+
+        processRows(stripeType, stripeOutput, stripeInput, stripeWidth, stripeHeight,
+                    stripeParam, rowStart, rowEnd);
+    }
+}
+
+// processes the image in row stripes (see initStripes), without worker
+// tasks the calling task processes the whole image
+int CameraTool::runStripes(int type, uint8_t* outputData, uint8_t* inputData, int width,
+                           int height, int param)
+{
+    RackMessage msgInfo;
+    int         i, num, rows, jobs;
+
+    rows = (height + (stripeWorkerNum + 1) * CAMERA_TOOL_STRIPE_NUM - 1) /
+           ((stripeWorkerNum + 1) * CAMERA_TOOL_STRIPE_NUM);
+    if (!stripeInit || (stripeWorkerNum == 0) || (rows >= height))
+    {
+        return processRows(type, outputData, inputData, width, height, param, 0, height);
     }
+    num = (height + rows - 1) / rows;
+
+    // start job, the calling task processes stripes as well
+    stripeMtx.lock(RACK_INFINITE);
+    stripeType   = type;
+    stripeOutput = outputData;
+    stripeInput  = inputData;
+    stripeWidth  = width;
+    stripeHeight = height;
+    stripeParam  = param;
+    stripeRows   = rows;
+    stripeNext   = 0;
+    stripeNum    = num;
+    stripeMtx.unlock();
+
+    for (jobs = 0; jobs < stripeWorkerNum; jobs++)
+    {
+        if (stripeDoneMbx->sendMsg(CAMERA_TOOL_MSG_JOB, stripeJobMbx->getAdr(), 0))
+            break;
+    }
+
+    stripeProcess();
+
+    // a worker replies after the last stripe it has taken
+    for (i = 0; i < jobs; i++)
+    {
+        if (stripeDoneMbx->recvMsg(&msgInfo))
+        {
+            GDOS_ERROR("Can't receive the reply of a conversion worker\n");
+            return -EIO;
+        }
+    }
+
     return 0;
 }
 
+// converts the image in row stripes
+int CameraTool::convert(int type, uint8_t* outputData, uint8_t* inputData, int width,
+                        int height, int colorFilterId)
+{
+    // check the arguments once for all stripes
+    if ((height < 2) || (convertRows(type, outputData, inputData, width, height, colorFilterId,
+                                     0, 1) != 0))
+    {
+        return -EINVAL;
+    }
+
+    return runStripes(type, outputData, inputData, width, height, colorFilterId);
+}
+
 int CameraTool::convertCharBGR2RGB(uint8_t* outputData, uint8_t* inputData,
                                 int width, int height)
 {
-    int i,j;
+    int     k, n = width * height;
     uint8_t swap;
 
-    for (i = 0; i < height; i++)
+    for (k = 0; k < n; k++, inputData += 3, outputData += 3)
     {
-        for (j = 0; j < width; j++ )
-        {
-            swap                                = inputData[(i * width + j) * 3];//swap = input_B
-            outputData[(i * width + j) * 3]     = inputData[(i * width + j) * 3 + 2];
-            outputData[(i * width + j) * 3 +1 ] = inputData[(i * width + j) * 3 + 1];
-            outputData[(i * width + j) * 3 + 2] = swap;
-        }
+        swap          = inputData[0];
+        outputData[0] = inputData[2];
+        outputData[1] = inputData[1];
+        outputData[2] = swap;
     }
     return 0;
 }
@@ -498,100 +1298,387 @@ int CameraTool::ctMedianFilter8Bit(uint8_t* outputData, uint8_t* inputData, int
     return 0; 
 }*/
 
-int CameraTool::qsMedianFilter16Bit(short *outputData, short *inputData, int width, int height, int radius)
+//
+// 16 bit filters
+//
+// The median uses a histogram of the window with 256 coarse and 65536 fine
+// bins. The search selects the coarse bin first and then the fine bin inside
+// it, both starting at the last median. The box filter keeps running sums of
+// the columns. Both only update the values entering and leaving the window.
+//
+
+#define MEDIAN_SELECT_MAX   11              // smaller windows are selected per pixel
+
+typedef struct {
+    uint32_t    coarse[256];
+    uint32_t    fine[65536];
+    int         c;                          // coarse bin of the last search
+    int         belowCoarse;                // number of values in the coarse bins below c
+    int         f;                          // fine bin of the last search, inside c
+    int         below;                      // number of values in the fine bins below f
+} median_hist;
+
+static inline void histAdd(median_hist *hist, int val)
 {
-    int i,j, k, l;
-    int minIndex;
-    short  swapValue; 
-    short  arr[radius];
-    
-    memset(outputData, 0, width * height * sizeof(short));
-    GDOS_DBG_INFO("doing Median filtering with radius:%i\n", radius);
-    
-    for (i = 0; i < height; i++)
+    int idx = val + 32768;
+
+    hist->coarse[idx >> 8]++;
+    hist->fine[idx]++;
+    if ((idx >> 8) < hist->c)
+        hist->belowCoarse++;
+    if (idx < hist->f)
+        hist->below++;
+}
+
+static inline void histRemove(median_hist *hist, int val)
+{
+    int idx = val + 32768;
+
+    hist->coarse[idx >> 8]--;
+    hist->fine[idx]--;
+    if ((idx >> 8) < hist->c)
+        hist->belowCoarse--;
+    if (idx < hist->f)
+        hist->below--;
+}
+
+// value with k smaller or equal values in front of it (k = 0 ... n - 1),
+// at most 256 coarse and 256 fine steps
+static inline int histGet(median_hist *hist, int k)
+{
+    int c = hist->c, belowCoarse = hist->belowCoarse;
+    int f, below;
+
+    while (belowCoarse > k)
     {
-        for (j = radius/2; j < width-radius/2; j++ )
-        {
-            memcpy(arr, &(inputData[i*width+j-radius/2]), radius*sizeof(short));  
-    
-            for (k=0; k <= radius/2; k++)
-            {
-                minIndex  = k;
-                swapValue = arr[k];
-                
-                for (l = k+1; l < radius; l++)
-                {
-                    if (arr[l] < arr[minIndex]) {minIndex = l;}    
-                }
-        
-                arr[k] = arr[minIndex]; 
-                arr[minIndex] = swapValue;
-            }
-            outputData[i*width+j] = arr[radius/2];
-       }
-        
-        //correct first and last pixel per row
-        for (j = 0; j < radius/2; j++ )
+        c--;
+        belowCoarse -= hist->coarse[c];
+    }
+    while (belowCoarse + (int)hist->coarse[c] <= k)
+    {
+        belowCoarse += hist->coarse[c];
+        c++;
+    }
+
+    // the fine search starts at the last median if it is in the same coarse bin
+    if (c == hist->c)
+    {
+        f     = hist->f;
+        below = hist->below;
+
+        while (below > k)
         {
-            outputData[i*width+j] = outputData[i*width+radius/2];
-            outputData[i*width+j+width-radius/2] = outputData[i*width+width-radius/2-1];
+            f--;
+            below -= hist->fine[f];
         }
     }
+    else
+    {
+        f     = c << 8;
+        below = belowCoarse;
+    }
+    while (below + (int)hist->fine[f] <= k)
+    {
+        below += hist->fine[f];
+        f++;
+    }
 
-    return 0;
+    hist->c           = c;
+    hist->belowCoarse = belowCoarse;
+    hist->f           = f;
+    hist->below       = below;
+    return f - 32768;
 }
 
-int CameraTool::lowPassFilter16Bit(short *outputData, short *inputData, int width, int height, int radius)
+// the first and last pixels take the nearest filtered pixel
+static void fillRowBorder(short *row, int width, int first, int last)
 {
+    int j;
 
-    int i,j, k, l;
-    int numElem, sideLength;
-    double sum;
-    
-    if (radius == 0) 
+    for (j = 0; j < first; j++)
     {
-        memcpy(outputData, inputData, sizeof(short) * width * height);
-        return 0; 
+        row[j] = row[first];
     }
-    
-    GDOS_DBG_INFO("doing low pass filtering with radius:%i\n", radius);
-    
-    sideLength = 2 * radius + 1;
-    numElem    = sideLength * sideLength;
-        
-    memset(outputData, 0, width * height * sizeof(short));
-    
-    for (i = radius; i < height-radius; i++)
+    for (j = last + 1; j < width; j++)
     {
-        for (j = radius; j < width-radius; j++ )
+        row[j] = row[last];
+    }
+}
+
+// median of len pixels in the row like the selection of qsMedianFilter16Bit,
+// out[j] is the value len / 2 of the sorted window in[j - len / 2 ...]
+static void medianRow(short *out, short *in, int width, int len, median_hist *hist)
+{
+    int j, k, l, pos, half = len / 2;
+    short val;
+
+    if (len <= MEDIAN_SELECT_MAX)
+    {
+        short win[MEDIAN_SELECT_MAX];
+
+        for (j = half; j < width - half; j++)
         {
-            sum = 0; 
-            for (k=0; k < sideLength; k++)
+            memcpy(win, &in[j - half], len * sizeof(short));
+            for (k = 0; k <= half; k++)
             {
-                for (l=0; l < sideLength; l++)
+                pos = k;
+                for (l = k + 1; l < len; l++)
                 {
-                    sum += inputData[(i-radius+k)*width + j - radius + l];
+                    if (win[l] < win[pos])
+                        pos = l;
                 }
+                val      = win[k];
+                win[k]   = win[pos];
+                win[pos] = val;
             }
-            outputData[i*width+j] = (short) floor(sum / numElem);
+            out[j] = win[half];
         }
-    
-        //error correction
-        for (j = 0; j < radius; j++ )
+    }
+    else
+    {
+        for (j = 0; j < len; j++)
+            histAdd(hist, in[j]);
+
+        for (j = half; ; j++)
         {
-            outputData[i*width+j] = outputData[i*width+radius];
-            outputData[i*width+j+width-radius] = outputData[i*width+width-radius-1];
+            out[j] = histGet(hist, half);
+            if (j + 1 >= width - half)
+                break;
+
+            histRemove(hist, in[j - half]);
+            histAdd(hist, in[j - half + len]);
         }
+
+        // empty the histogram for the next row
+        for (pos = j - half; pos < j - half + len; pos++)
+            histRemove(hist, in[pos]);
     }
-    
-    //error correction
-    for (i=0; i < radius; i++)
+
+    fillRowBorder(out, width, half, width - half - 1);
+}
+
+// median of the (2 * radius + 1)^2 window, sliding along the row
+static void median2dRow(short *out, short *in, int width, int row, int radius,
+                        median_hist *hist)
+{
+    int i, j, side = 2 * radius + 1, half = (side * side) / 2;
+
+    for (i = row - radius; i <= row + radius; i++)
     {
-        for (j = 0; j < width; j++ )
+        for (j = 0; j < side; j++)
+            histAdd(hist, in[i * width + j]);
+    }
+
+    for (j = radius; ; j++)
+    {
+        out[row * width + j] = histGet(hist, half);
+        if (j + radius + 1 >= width)
+            break;
+
+        for (i = row - radius; i <= row + radius; i++)
+        {
+            histRemove(hist, in[i * width + j - radius]);
+            histAdd(hist, in[i * width + j + radius + 1]);
+        }
+    }
+
+    // empty the histogram for the next row
+    for (i = row - radius; i <= row + radius; i++)
+    {
+        for (j = width - side; j < width; j++)
+            histRemove(hist, in[i * width + j]);
+    }
+
+    fillRowBorder(&out[row * width], width, radius, width - radius - 1);
+}
+
+// mean of the (2 * radius + 1)^2 window rounded down like lowPassFilter16Bit
+static inline short boxMean(int64_t sum, int num)
+{
+    int64_t q = sum / num;
+
+    if ((sum % num) < 0)
+        q--;
+    return (short)q;
+}
+
+static void boxRows(short *out, short *in, int width, int radius, int rowStart, int rowEnd,
+                    int32_t *colSum)
+{
+    int     i, j, num = (2 * radius + 1) * (2 * radius + 1);
+    int64_t sum;
+
+    for (j = 0; j < width; j++)
+    {
+        colSum[j] = 0;
+        for (i = rowStart - radius; i <= rowStart + radius; i++)
+            colSum[j] += in[i * width + j];
+    }
+
+    for (i = rowStart; i < rowEnd; i++)
+    {
+        if (i > rowStart)
         {
-            outputData[i*width+j] = outputData[radius*width+j];//first row dublicated
-            outputData[(height-i-1)*width+j] = outputData[(height-radius-1)*width+j];//last row dublicated
+            for (j = 0; j < width; j++)
+                colSum[j] += in[(i + radius) * width + j] - in[(i - radius - 1) * width + j];
         }
+
+        sum = 0;
+        for (j = 0; j <= 2 * radius; j++)
+            sum += colSum[j];
+
+        for (j = radius; ; j++)
+        {
+            out[i * width + j] = boxMean(sum, num);
+            if (j + radius + 1 >= width)
+                break;
+            sum += colSum[j + radius + 1] - colSum[j - radius];
+        }
+
+        fillRowBorder(&out[i * width], width, radius, width - radius - 1);
+    }
+}
+
+// filters the rows rowStart ... rowEnd - 1, rows without a complete window
+// are left to the caller
+int CameraTool::filterRows(int type, short *outputData, short *inputData, int width,
+                           int height, int radius, int rowStart, int rowEnd)
+{
+    median_hist *hist = NULL;
+    int32_t     *colSum;
+    int         i;
+
+    if ((type == CAMERA_TOOL_MEDIAN16_2D) || (type == CAMERA_TOOL_BOX16))
+    {
+        if (rowStart < radius)
+            rowStart = radius;
+        if (rowEnd > height - radius)
+            rowEnd = height - radius;
+    }
+    if (rowStart >= rowEnd)
+        return 0;
+
+    switch (type)
+    {
+        case CAMERA_TOOL_MEDIAN16:
+            if (radius > MEDIAN_SELECT_MAX)
+            {
+                hist = (median_hist *)calloc(1, sizeof(median_hist));
+                if (!hist)
+                    return -ENOMEM;
+            }
+
+            for (i = rowStart; i < rowEnd; i++)
+                medianRow(&outputData[i * width], &inputData[i * width], width, radius, hist);
+            break;
+
+        case CAMERA_TOOL_MEDIAN16_2D:
+            hist = (median_hist *)calloc(1, sizeof(median_hist));
+            if (!hist)
+                return -ENOMEM;
+
+            for (i = rowStart; i < rowEnd; i++)
+                median2dRow(outputData, inputData, width, i, radius, hist);
+            break;
+
+        case CAMERA_TOOL_BOX16:
+            colSum = (int32_t *)malloc(width * sizeof(int32_t));
+            if (!colSum)
+                return -ENOMEM;
+
+            boxRows(outputData, inputData, width, radius, rowStart, rowEnd, colSum);
+            free(colSum);
+            break;
+
+        default:
+            return -EINVAL;
+    }
+
+    if (hist)
+        free(hist);
+    return 0;
+}
+
+// the first and last radius rows take the nearest filtered row
+static void fillImageBorder(short *outputData, int width, int height, int radius)
+{
+    int i;
+
+    for (i = 0; i < radius; i++)
+    {
+        memcpy(&outputData[i * width], &outputData[radius * width], width * sizeof(short));
+        memcpy(&outputData[(height - i - 1) * width], &outputData[(height - radius - 1) * width],
+               width * sizeof(short));
+    }
+}
+
+// median of radius pixels in the row (window length, not the radius)
+int CameraTool::qsMedianFilter16Bit(short *outputData, short *inputData, int width, int height, int radius)
+{
+    // the window has to fit at least once into the row
+    if ((2 * (radius / 2) >= width) || (height < 1))
+        return -EINVAL;
+
+    if (radius <= 1)
+    {
+        memcpy(outputData, inputData, width * height * sizeof(short));
+        return 0;
+    }
+
+    GDOS_DBG_INFO("doing Median filtering with radius:%i\n", radius);
+
+    return runStripes(CAMERA_TOOL_MEDIAN16, (uint8_t *)outputData, (uint8_t *)inputData,
+                      width, height, radius);
+}
+
+// median of the (2 * radius + 1)^2 window, borders like lowPassFilter16Bit
+int CameraTool::medianFilter16Bit2d(short *outputData, short *inputData, int width, int height, int radius)
+{
+    int ret;
+
+    if ((radius < 0) || (2 * radius >= width) || (2 * radius >= height) ||
+        ((2 * radius + 1) * (2 * radius + 1) > 65535))
+    {
+        return -EINVAL;
+    }
+
+    if (radius == 0)
+    {
+        memcpy(outputData, inputData, width * height * sizeof(short));
+        return 0;
     }
+
+    GDOS_DBG_INFO("doing 2d Median filtering with radius:%i\n", radius);
+
+    ret = runStripes(CAMERA_TOOL_MEDIAN16_2D, (uint8_t *)outputData, (uint8_t *)inputData,
+                     width, height, radius);
+    if (ret)
+        return ret;
+
+    fillImageBorder(outputData, width, height, radius);
+    return 0;
+}
+
+int CameraTool::lowPassFilter16Bit(short *outputData, short *inputData, int width, int height, int radius)
+{
+    int ret;
+
+    if (radius == 0)
+    {
+        memcpy(outputData, inputData, sizeof(short) * width * height);
+        return 0;
+    }
+
+    if ((radius < 0) || (2 * radius >= width) || (2 * radius >= height))
+        return -EINVAL;
+
+    GDOS_DBG_INFO("doing low pass filtering with radius:%i\n", radius);
+
+    ret = runStripes(CAMERA_TOOL_BOX16, (uint8_t *)outputData, (uint8_t *)inputData,
+                     width, height, radius);
+    if (ret)
+        return ret;
+
+    fillImageBorder(outputData, width, height, radius);
     return 0;
 }
@@ -42,17 +42,36 @@
 
 #include <main/compress_tool.h>
 
+#include <errno.h>
 #include <string.h>
 
 CompressTool::CompressTool()  {
     gdos = NULL;
+    pbuf23 = NULL;
+    compr_setMaxInputSize(COMPR_MAX_INPUT_SIZE);
 }
 
 CompressTool::CompressTool(RackMailbox * p_mbx, int32_t gdos_level)  {
     gdos = new RackGdos(p_mbx, gdos_level);
+    pbuf23 = NULL;
+    compr_setMaxInputSize(COMPR_MAX_INPUT_SIZE);
+}
+
+//----- (re)allocates the buffer of steps 2 and 3 for inputs up to [size] bytes.
+//----- Tools that compress single blocks of a scan need much less memory.
+int CompressTool::compr_setMaxInputSize(uint32_t size) {
+    if (pbuf23) delete[] pbuf23;
+    buf23Size = size + 14;
+    pbuf23    = new uint8_t[buf23Size];
+    if (!pbuf23) {
+        buf23Size = 0;
+        return -ENOMEM;
+    }
+    return 0;
 }
 
 CompressTool::~CompressTool()  {
+    if (pbuf23) delete[] pbuf23;
     if (gdos) delete gdos;
 }
 
@@ -68,7 +87,6 @@ uint32_t CompressTool::Compress(uint8_t *in_out, uint32_t flags_s2, uint32_t fla
     inStream2.aByte     = 0;
     inStream2.aBit      = 0;
     //----- prepare output stream
-    pbuf23              = (uint8_t*)&buf23;
 
     pbuf23[0]           = 0x4D;             //----- "Magic value"
     pbuf23[1]           = 0x32;
@@ -779,7 +797,6 @@ uint32_t CompressTool::Decompress(uint8_t *in_out) {
     inStream3.aByte     = 0;
     inStream3.aBit      = 0;
     //----- prepare output stream
-    pbuf23              = (uint8_t*)&buf23;
     compr_bitStream     outStream3;
     outStream3.data     = pbuf23;
     outStream3.aByte    = 0;
@@ -1236,87 +1253,8 @@ void CompressTool::compr_writeBit(compr_bitStream *bs, bool value) {
     if (bs->aBit >= 8) { bs->aBit = 0; bs->aByte++; }
 }
 
-//----- writes the [bits] lowest bit from [value] into the bitstream [bs] (max 32)
-void CompressTool::compr_writeBitStream(compr_bitStream *bs, uint32_t value, uint32_t bits) {
-    if (bs->aBit == 0) bs->data[bs->aByte] = 0;
-    uint32_t nBits = 8-bs->aBit;
-    if (nBits >= bits) {
-        bs->data[bs->aByte] = ((bs->data[bs->aByte]) | (value << (nBits-bits)));
-        bs->aBit += bits;
-        bits = 0;
-    } else  {
-        bs->data[bs->aByte] = ((bs->data[bs->aByte]) | (value >> (bits-nBits)));
-        bits-=nBits;
-        bs->aBit = 8;
-    }
-    if (bs->aBit == 8) { bs->aByte++; bs->data[bs->aByte] = 0; bs->aBit = 0; }
-    while (bits >= 8) {
-        bits-=8;
-        bs->data[bs->aByte] = (uint8_t) ((value >> bits)  & 0x000000FF);
-        bs->aByte++; bs->data[bs->aByte] = 0;
-    }
-    if (bits > 0) {
-        bs->data[bs->aByte] = (uint8_t) ((value << (8-bits)) & 0x000000FF);
-        bs->aBit += bits;
-    }
-    if (bs->aBit == 8) { bs->aByte++; bs->data[bs->aByte] = 0; bs->aBit = 0; }
-}
-
-//----- returns [bits] bits from the bitstream [bs] (max 32)
-uint32_t CompressTool::compr_readBitStream(compr_bitStream *bs, uint32_t bits) {
-    if (bits == 0) return 0;
-    uint32_t output = 0;
-    uint8_t tmp = 0;
-    uint32_t nBits = 8-bits-bs->aBit;
-    if (bits <= (8-bs->aBit)) { //----- all bits in actual byte
-        output = bs->data[bs->aByte];
-        if (nBits > 0) output >>= nBits;
-        output <<= 32-bits;
-        output >>= 32-bits;
-        if ((bs->aBit + bits) == 8) { bs->aByte++; bs->aBit = 0; }
-        else bs->aBit += bits;
-        bits = 0;
-    } else {                    //----- read bits from first byte
-        output = bs->data[bs->aByte];
-        output <<= 24+bs->aBit;
-        output >>= 24+bs->aBit;
-        bits -= (8-bs->aBit);
-        bs->aByte++; bs->aBit = 0;
-    }
-    while (bits >= 8) {         //----- read full bytes
-        tmp = bs->data[bs->aByte++];
-        bits -= 8;
-        output <<= 8;
-        output += tmp;
-    }
-    if (bits > 0) {             //----- read remaining bits
-        tmp = bs->data[bs->aByte];
-        output <<= bits;
-        tmp >>= 8-bits;
-        output += tmp;
-        bs->aBit=bits;
-    }
-    return output;
-}
-
-//----- writes [bytes] bytes of [value] into the byte stream [bs] (max 4)
-void CompressTool::compr_writeByteStream(compr_bitStream *bs, uint32_t value, uint32_t bytes) {
-    while (bytes > 0) {
-        bs->data[bs->aByte++] = (value >> ((bytes-1) << 3)) & 0xFF;
-        bytes--;
-    }
-}
-
-//----- reads [bytes] bytes from the byte stream [bs] (max 4)
-uint32_t CompressTool::compr_readByteStream(compr_bitStream *bs, uint32_t bytes) {
-    uint32_t output = 0;
-    for (uint32_t i = 0; i<bytes; i++) {
-        output <<= 8;
-        output |= bs->data[bs->aByte++];
-    }
-    return output;
-}
-
+//----- compr_writeBitStream(), compr_readBitStream(), compr_writeByteStream() and
+//----- compr_readByteStream() are inline functions (see compress_tool.h)
 
 /*
 
@@ -19,6 +19,9 @@
 #include <unistd.h>
 #include <string.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include <main/dxf_map.h>
 
@@ -46,6 +49,8 @@ DxfMap::DxfMap(int maxFeatureNum)
     xMax = 0.0;
     yMin = 0.0;
     yMax = 0.0;
+
+    useCache = 1;
 }
 
 DxfMap::~DxfMap()
@@ -56,131 +61,332 @@ DxfMap::~DxfMap()
     }
 }
 
+int DxfMap::reserve(int num)
+{
+    dxf_map_feature *newFeature;
+
+    if (num <= maxFeatureNum)
+    {
+        return 0;
+    }
+
+    newFeature = (dxf_map_feature*)realloc(feature, num * sizeof(dxf_map_feature));
+    if (newFeature == NULL)
+    {
+        printf("Can't allocate memory for %i features\n", num);
+        return -ENOMEM;
+    }
+
+    memset(&newFeature[maxFeatureNum], 0, (num - maxFeatureNum) * sizeof(dxf_map_feature));
+
+    feature       = newFeature;
+    maxFeatureNum = num;
+    return 0;
+}
+
+// returns the next free feature, the feature array grows if it is full
+dxf_map_feature *DxfMap::newFeature(void)
+{
+    dxf_map_feature *f;
+
+    if (featureNum >= maxFeatureNum)
+    {
+        if (reserve(maxFeatureNum < 512 ? 1024 : 2 * maxFeatureNum))
+        {
+            return NULL;
+        }
+    }
+
+    f = &feature[featureNum];
+    memset(f, 0, sizeof(dxf_map_feature));
+    return f;
+}
+
 //
 // dxf_map_read
 //
 
-int DxfMap::read_group(FILE *fp, char *string, int *number, double *real,
-                       int *line, int *level, int *vertices)
+static const double pow10Table[] =
 {
-    int    groupCode;
-    char   buffer[256];
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static inline int isBlank(char c)
+{
+    return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\v') || (c == '\f');
+}
+
+// next line of the mapped file, the line end is not included
+static int getLine(dxf_map_parser *parser, const char **start, const char **end)
+{
+    const char *p = parser->pos;
+
+    if (p >= parser->end)
+    {
+        return -1;
+    }
+
+    *start = p;
+    p = (const char *)memchr(p, '\n', parser->end - p);
+    if (p == NULL)
+    {
+        p = parser->end;
+        parser->pos = p;
+    }
+    else
+    {
+        parser->pos = p + 1;
+    }
+    *end = p;
+
+    parser->line++;
+    return 0;
+}
+
+// like sscanf("%i"), returns 0 if there is no number
+static int parseInt(const char *p, const char *end, int *value)
+{
+    int sign = 1;
+    int v    = 0;
+
+    while ((p < end) && isBlank(*p))
+    {
+        p++;
+    }
+
+    if ((p < end) && ((*p == '-') || (*p == '+')))
+    {
+        if (*p == '-')
+        {
+            sign = -1;
+        }
+        p++;
+    }
+
+    if ((p >= end) || (*p < '0') || (*p > '9'))
+    {
+        return 0;
+    }
+
+    while ((p < end) && (*p >= '0') && (*p <= '9'))
+    {
+        v = v * 10 + (*p - '0');
+        p++;
+    }
+
+    *value = sign * v;
+    return 1;
+}
+
+// like sscanf("%lf"), numbers with up to 15 digits and a small exponent are
+// converted exactly without sscanf()
+static int parseReal(const char *p, const char *end, double *value)
+{
+    const char  *start;
+    char        buffer[64];
+    uint64_t    mantissa = 0;
+    int         digits   = 0;
+    int         exponent = 0;
+    int         expSign  = 1;
+    int         exp      = 0;
+    int         negative = 0;
+    int         len;
+
+    while ((p < end) && isBlank(*p))
+    {
+        p++;
+    }
+    start = p;
+
+    if ((p < end) && ((*p == '-') || (*p == '+')))
+    {
+        negative = (*p == '-');
+        p++;
+    }
+
+    while ((p < end) && (*p >= '0') && (*p <= '9'))
+    {
+        mantissa = mantissa * 10 + (*p - '0');
+        digits++;
+        p++;
+    }
+
+    if ((p < end) && (*p == '.'))
+    {
+        p++;
+        while ((p < end) && (*p >= '0') && (*p <= '9'))
+        {
+            mantissa = mantissa * 10 + (*p - '0');
+            digits++;
+            exponent--;
+            p++;
+        }
+    }
+
+    if ((digits > 0) && (p < end) && ((*p == 'e') || (*p == 'E')))
+    {
+        p++;
+        if ((p < end) && ((*p == '-') || (*p == '+')))
+        {
+            expSign = (*p == '-') ? -1 : 1;
+            p++;
+        }
+        while ((p < end) && (*p >= '0') && (*p <= '9') && (exp < 10000))
+        {
+            exp = exp * 10 + (*p - '0');
+            p++;
+        }
+        exponent += expSign * exp;
+    }
+
+    if ((digits > 0) && (digits <= 15) && (exponent >= -22) && (exponent <= 22) &&
+        ((p >= end) || isBlank(*p)))
+    {
+        if (exponent >= 0)
+        {
+            *value = (double)mantissa * pow10Table[exponent];
+        }
+        else
+        {
+            *value = (double)mantissa / pow10Table[-exponent];
+        }
+
+        if (negative)
+        {
+            *value = -*value;
+        }
+        return 1;
+    }
+
+    // long or unusual numbers
+    len = end - start;
+    if (len > (int)sizeof(buffer) - 1)
+    {
+        len = sizeof(buffer) - 1;
+    }
+    memcpy(buffer, start, len);
+    buffer[len] = 0;
+
+    return sscanf(buffer, "%lf", value);
+}
+
+int DxfMap::read_group(dxf_map_parser *parser, char *string, int *number,
+                       double *real, int *level, int *vertices)
+{
+    int         groupCode;
+    const char  *start, *end;
+    int         len;
 
     string[0] = 0;
     *number   = 0;
     *real     = 0.0;
     *level    = 0;
 
-    (*line)++;
-
-    if (fgets(buffer, 256, fp) == NULL)
+    if (getLine(parser, &start, &end))
     {
-        printf("Can't read group code (line %i)\n", *line);
+        printf("Can't read group code (line %i)\n", parser->line + 1);
         return -EIO;
     }
 
-    sscanf(buffer, "%i\n", &groupCode);
-
-        //printf("read group code %i ", groupCode);
+    if (!parseInt(start, end, &groupCode))
+    {
+        groupCode = 999;
+    }
 
-    (*line)++;
-    if (fgets(buffer, 256, fp) == NULL)
+    if (getLine(parser, &start, &end))
     {
-        printf("Can't read group data (line %i)\n", *line);
+        printf("Can't read group data (line %i)\n", parser->line + 1);
         return -EIO;
     }
 
     if (((groupCode >= 0) && (groupCode < 10) && (groupCode != 8)) || (groupCode == 999))
     {
-        sscanf(buffer, "%s\n", string);
-        //printf("string %s\n", string);
+        // first word of the line
+        while ((start < end) && isBlank(*start))
+        {
+            start++;
+        }
+        len = 0;
+        while ((start + len < end) && !isBlank(start[len]) && (len < 255))
+        {
+            len++;
+        }
+        memcpy(string, start, len);
+        string[len] = 0;
     }
 
     else if (groupCode == 8)
     {
-        sscanf(buffer, "%i", level);
-        //printf("layer %i\n", *level);
-          }
+        parseInt(start, end, level);
+    }
     else if (((groupCode >= 10) && (groupCode < 60)) ||
              ((groupCode >= 210) && (groupCode < 240)))
     {
-        sscanf(buffer, "%lf", real);
-        //printf("real %f\n", *real);
-          }
+        parseReal(start, end, real);
+    }
     else if ((groupCode >= 60) && (groupCode < 80))
     {
-        sscanf(buffer, "%i\n", number);
-        //printf("number %i\n", *number);
-          }
+        parseInt(start, end, number);
+    }
     else if (groupCode == 90)
     {
-        sscanf(buffer, "%i\n", vertices);
-       // printf("number %i\n", *vertices);
-          }
+        parseInt(start, end, vertices);
+    }
     else
     {
         return 999;
-      //  printf("unknown groupCode %i\n", groupCode);
-    //    return -1;                
     }
     return groupCode;
 }
 
-int DxfMap::read_polyline(FILE *fp)
+int DxfMap::read_polyline(dxf_map_parser *parser)
 {
     int    groupCode;
     char   string[256];
     int    number;
     double real;
-    int    line;
     int    level;
     int    vertices;
+    int    layer = 0;
     int    vertexNum = 0;
     double newX = 0.0;
     double newY = 0.0;
     double oldX = 0.0;
     double oldY = 0.0;
+    dxf_map_feature *f;
 
-    oldX = 0.0;
-    oldY = 0.0;
-    newX = 0.0;
-    newY = 0.0;
-    
-    
-    while ((groupCode = read_group(fp, string, &number, &real, &line, &level, &vertices)) >= 0)
+    while ((groupCode = read_group(parser, string, &number, &real, &level, &vertices)) >= 0)
     {
         if (groupCode == 8)
         {
-            feature[featureNum].layer = level;
+            layer = level;
         }
 
         if (groupCode == 10)
         {
             newX = (double)real;
-        //    printf("newX %f\n", newX);
-        //    printf("oldX %f\n", newX);
         }
 
         if (groupCode == 20)
         {
             newY = (double)real;
-        //    printf("newY %f\n", newY);
-        //    printf("oldY %f\n", newY);
         }
 
         if ((groupCode == 0) && (strncmp(string, "VERTEX", 6) == 0))
         {
-            //printf("VERTEX\n");
-
-
-
-            if ((vertexNum >= 2) && (featureNum < maxFeatureNum))
+            if (vertexNum >= 2)
             {
                 // create new line
-                feature[featureNum].x = oldX;
-                feature[featureNum].y = oldY;
-                feature[featureNum].x2 = newX;
-                feature[featureNum].y2 = newY;
+                if ((f = newFeature()) == NULL)
+                {
+                    return -ENOMEM;
+                }
+                f->x     = oldX;
+                f->y     = oldY;
+                f->x2    = newX;
+                f->y2    = newY;
+                f->layer = layer;
                 featureNum++;
             }
 
@@ -193,13 +399,18 @@ int DxfMap::read_polyline(FILE *fp)
 
         if ((groupCode == 0) && (strncmp(string, "SEQEND", 6) == 0))
         {
-            if ((vertexNum >= 2) && (featureNum < maxFeatureNum))
+            if (vertexNum >= 2)
             {
                 // create new line
-                feature[featureNum].x = oldX;
-                feature[featureNum].y = oldY;
-                feature[featureNum].x2 = newX;
-                feature[featureNum].y2 = newY;
+                if ((f = newFeature()) == NULL)
+                {
+                    return -ENOMEM;
+                }
+                f->x     = oldX;
+                f->y     = oldY;
+                f->x2    = newX;
+                f->y2    = newY;
+                f->layer = layer;
                 featureNum++;
             }
             break;
@@ -216,16 +427,16 @@ int DxfMap::read_polyline(FILE *fp)
     }
 }
 
-int DxfMap::read_line(FILE *fp)
+int DxfMap::read_line(dxf_map_parser *parser)
 {
     int    groupCode;
     char   string[256];
     int    number;
     double real;
-    int    line;
     int    level;
     int    vertices;
     int    x1, y1, x2, y2, l;
+    dxf_map_feature *f;
 
     x1 = 0;
     y1 = 0;
@@ -233,59 +444,56 @@ int DxfMap::read_line(FILE *fp)
     y2 = 0;
     l = 0;
 
-    if (featureNum < maxFeatureNum)
+    if ((f = newFeature()) == NULL)
     {
-        while ((groupCode = read_group(fp, string, &number, &real, &line, &level, &vertices)) >= 0)
-        {
-            if (groupCode == 8)
-            {
-                feature[featureNum].layer = level;
-                l = 1;
-            }
+        return -ENOMEM;
+    }
 
-            if (groupCode == 10)
-            {
-                feature[featureNum].x = (double)real;
-                x1 = 1;
-            }
+    while ((groupCode = read_group(parser, string, &number, &real, &level, &vertices)) >= 0)
+    {
+        if (groupCode == 8)
+        {
+            f->layer = level;
+            l = 1;
+        }
 
-            if (groupCode == 20)
-            {
-                feature[featureNum].y = (double)real;
-                y1 = 1;
-            }
+        if (groupCode == 10)
+        {
+            f->x = (double)real;
+            x1 = 1;
+        }
 
-            if (groupCode == 11)
-            {
-                feature[featureNum].x2 = (double)real;
-                x2 = 1;
-            }
+        if (groupCode == 20)
+        {
+            f->y = (double)real;
+            y1 = 1;
+        }
 
-            if (groupCode == 21)
-            {
-                feature[featureNum].y2 = (double)real;
-                y2 = 1;
-            }
+        if (groupCode == 11)
+        {
+            f->x2 = (double)real;
+            x2 = 1;
+        }
 
-            if ((x1 == 1) && (y1 == 1) && (x2 == 1) && (y2 == 1) && (l == 1))
-                break;
+        if (groupCode == 21)
+        {
+            f->y2 = (double)real;
+            y2 = 1;
         }
-        featureNum++;
-        return 1;
-    }
-    else
-    {
-        return -EIO;
+
+        if ((x1 == 1) && (y1 == 1) && (x2 == 1) && (y2 == 1) && (l == 1))
+            break;
     }
+    featureNum++;
+    return 1;
 }
 
-int DxfMap::read_lwpolyline(FILE *fp)
+int DxfMap::read_lwpolyline(dxf_map_parser *parser)
 {
     int    groupCode;
     char   string[256];
     int    number;
     double real;
-    int    line;
     int    level;
     int    vertices;
     int    vertexNum = 0;
@@ -295,16 +503,12 @@ int DxfMap::read_lwpolyline(FILE *fp)
     double newY = 0.0;
     double oldX = 0.0;
     double oldY = 0.0;
+    dxf_map_feature *f;
 
-    oldX = 0.0;
-    oldY = 0.0;
-    newX = 0.0;
-    newY = 0.0;
     x    = 0;
     y    = 0;
 
-
-    while ((groupCode = read_group(fp, string, &number, &real, &line, &level, &vertices)) >= 0)
+    while ((groupCode = read_group(parser, string, &number, &real, &level, &vertices)) >= 0)
     {
         if (groupCode == 8)
         {
@@ -338,15 +542,19 @@ int DxfMap::read_lwpolyline(FILE *fp)
 
         if ((y >= 2) && (x >= 2) && x==y && vertexNum > 0)
         {
-                feature[featureNum].x = oldX;
-                feature[featureNum].y = oldY;
-                feature[featureNum].x2 = newX;
-                feature[featureNum].y2 = newY;
-                feature[featureNum].layer = lwpolylayer;
-                oldX = newX;
-                oldY = newY;
-                featureNum++;
-                vertexNum--;
+            if ((f = newFeature()) == NULL)
+            {
+                return -ENOMEM;
+            }
+            f->x     = oldX;
+            f->y     = oldY;
+            f->x2    = newX;
+            f->y2    = newY;
+            f->layer = lwpolylayer;
+            oldX = newX;
+            oldY = newY;
+            featureNum++;
+            vertexNum--;
         }
 
         if ((groupCode == 0) && (vertexNum == 0))
@@ -365,120 +573,314 @@ int DxfMap::read_lwpolyline(FILE *fp)
     }
 }
 
-int DxfMap::read_point(FILE *fp)
+int DxfMap::read_point(dxf_map_parser *parser)
 {
     int    groupCode;
     char   string[256];
     int    number;
     double real;
-    int    line;
     int    level;
     int    vertices;
     int    x1, y1, l;
+    dxf_map_feature *f;
 
     x1 = 0;
     y1 = 0;
     l = 0;
 
-    if (featureNum < maxFeatureNum)
+    if ((f = newFeature()) == NULL)
     {
-        while ((groupCode = read_group(fp, string, &number, &real, &line, &level, &vertices)) >= 0)
-        {
-            if (groupCode == 8)
-            {
-                feature[featureNum].layer = level;
-//                printf("Layer fuer Point_1: %d\n", level);
-                l = 1;
-            }
+        return -ENOMEM;
+    }
 
-            if (groupCode == 10)
-            {
-                feature[featureNum].x = (double)real;
-                feature[featureNum].x2 = (double)real;
-                x1 = 1;
-            }
+    while ((groupCode = read_group(parser, string, &number, &real, &level, &vertices)) >= 0)
+    {
+        if (groupCode == 8)
+        {
+            f->layer = level;
+            l = 1;
+        }
 
-            if (groupCode == 20)
-            {
-                feature[featureNum].y = (double)real;
-                feature[featureNum].y2 =(double)real;
-                y1 = 1;
-            }
+        if (groupCode == 10)
+        {
+            f->x  = (double)real;
+            f->x2 = (double)real;
+            x1 = 1;
+        }
 
-            if ((x1 == 1) && (y1 == 1) && (l == 1))
-                break;
+        if (groupCode == 20)
+        {
+            f->y  = (double)real;
+            f->y2 = (double)real;
+            y1 = 1;
         }
-        featureNum++;
-        return 1;
-    }
-    else
-    {
-        return -EIO;
+
+        if ((x1 == 1) && (y1 == 1) && (l == 1))
+            break;
     }
+    featureNum++;
+    return 1;
 }
 
-
-int DxfMap::load(char *filename, double mapOffsetX, double mapOffsetY, double scaleFactor)
+// reads the features of a dxf file mapped into memory
+int DxfMap::parse(const char *filename)
 {
-    FILE   *fp;
-    int    groupCode;
-    char   string[256];
-    int    number;
-    double real;
-    int    line;
-    int    level;
-    int    vertices;
-    int    i;
-    double x, y;
+    dxf_map_parser parser;
+    struct stat    dxfStat;
+    void           *map = NULL;
+    int            fd, ret = 0;
+    int            groupCode;
+    char           string[256];
+    int            number;
+    double         real;
+    int            level;
+    int            vertices;
+
+    if ((fd = open(filename, O_RDONLY)) < 0)
+    {
+        printf("Can't open dxf file \"%s\"\n", filename);
+        return -EIO;
+    }
 
-    if ((fp = fopen(filename, "r")) == NULL)
+    if (fstat(fd, &dxfStat))
     {
         printf("Can't open dxf file \"%s\"\n", filename);
+        close(fd);
         return -EIO;
     }
 
+    if (dxfStat.st_size > 0)
+    {
+        map = mmap(NULL, dxfStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED)
+        {
+            printf("Can't map dxf file \"%s\" into memory\n", filename);
+            close(fd);
+            return -EIO;
+        }
+        madvise(map, dxfStat.st_size, MADV_SEQUENTIAL);
+    }
+    close(fd);
+
+    parser.pos  = (const char *)map;
+    parser.end  = parser.pos + dxfStat.st_size;
+    parser.line = 0;
+
     featureNum = 0;
-    line = 0;
 
-    while ((groupCode = read_group (fp, string, &number, &real, &line, &level, &vertices)) >= 0)
+    while ((groupCode = read_group (&parser, string, &number, &real, &level, &vertices)) >= 0)
     {
         if ((groupCode == 0) && (strncmp(string, "POLYLINE", 9) == 0))
         {
-            if (read_polyline(fp) < 0)
-            {
-                break;
-            }
+            ret = read_polyline(&parser);
         }
 
         if ((groupCode == 0) && (strncmp(string, "LINE", 5) == 0))
         {
-            if (read_line(fp) < 0)
-            {
-                break;
-            }
+            ret = read_line(&parser);
         }
 
         if ((groupCode == 0) && (strncmp(string, "LWPOLYLINE", 11) == 0))
         {
-            if (read_lwpolyline(fp) < 0)
-            {
-                break;
-            }
+            ret = read_lwpolyline(&parser);
         }
-        
+
         if ((groupCode == 0) && (strncmp(string, "POINT", 5) == 0))
         {
-            if (read_point(fp) < 0)
-            {
-                break;
-            }
+            ret = read_point(&parser);
         }
-        
+
+        if (ret < 0)
+        {
+            break;
+        }
+
         if ((groupCode == 0) && (strncmp(string, "EOF", 3) == 0))
             break;
     }
 
-    fclose(fp);
+    if (map != NULL)
+    {
+        munmap(map, dxfStat.st_size);
+    }
+
+    if (ret == -ENOMEM)
+    {
+        featureNum = 0;
+        return ret;
+    }
+    return 0;
+}
+
+//
+// binary cache
+//
+
+static uint64_t cacheHash(const dxf_map_cache_feature *cacheFeature, int num)
+{
+    const uint64_t *p   = (const uint64_t *)cacheFeature;
+    const uint64_t *end = (const uint64_t *)&cacheFeature[num];
+    uint64_t       hash = 14695981039346656037ull;
+
+    // FNV-1a over 64 bit words
+    while (p < end)
+    {
+        hash ^= *p++;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+int DxfMap::loadCache(const char *cacheName, struct stat *dxfStat)
+{
+    struct stat                 cacheStat;
+    const dxf_map_cache_head    *head;
+    const dxf_map_cache_feature *cacheFeature;
+    void                        *map;
+    int                         fd, i, ret = -EINVAL;
+
+    if ((fd = open(cacheName, O_RDONLY)) < 0)
+    {
+        return -ENOENT;
+    }
+
+    if (fstat(fd, &cacheStat) || (cacheStat.st_size < (off_t)sizeof(dxf_map_cache_head)))
+    {
+        close(fd);
+        return -EINVAL;
+    }
+
+    map = mmap(NULL, cacheStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        return -EINVAL;
+    }
+
+    head         = (const dxf_map_cache_head *)map;
+    cacheFeature = (const dxf_map_cache_feature *)(head + 1);
+
+    // the cache belongs to the unchanged dxf file
+    if ((memcmp(head->magic, "RDXF", 4) == 0) &&
+        (head->version      == DXF_MAP_CACHE_VERSION) &&
+        (head->dxfSize      == (int64_t)dxfStat->st_size) &&
+        (head->dxfMtimeSec  == (int64_t)dxfStat->st_mtim.tv_sec) &&
+        (head->dxfMtimeNsec == (int64_t)dxfStat->st_mtim.tv_nsec) &&
+        (head->featureNum   >= 0) &&
+        (cacheStat.st_size  == (off_t)(sizeof(dxf_map_cache_head) +
+                                       head->featureNum * sizeof(dxf_map_cache_feature))) &&
+        (head->hash         == cacheHash(cacheFeature, head->featureNum)))
+    {
+        ret = reserve(head->featureNum);
+        if (!ret)
+        {
+            for (i = 0; i < head->featureNum; i++)
+            {
+                feature[i].x     = cacheFeature[i].x;
+                feature[i].y     = cacheFeature[i].y;
+                feature[i].x2    = cacheFeature[i].x2;
+                feature[i].y2    = cacheFeature[i].y2;
+                feature[i].layer = cacheFeature[i].layer;
+            }
+            featureNum = head->featureNum;
+        }
+    }
+
+    munmap(map, cacheStat.st_size);
+    return ret;
+}
+
+int DxfMap::saveCache(const char *cacheName, struct stat *dxfStat)
+{
+    dxf_map_cache_head    head;
+    dxf_map_cache_feature *cacheFeature;
+    char                  tmpName[strlen(cacheName) + 16];
+    FILE                  *fp;
+    int                   i, ret;
+
+    cacheFeature = (dxf_map_cache_feature *)calloc(featureNum + 1, sizeof(dxf_map_cache_feature));
+    if (cacheFeature == NULL)
+    {
+        return -ENOMEM;
+    }
+
+    for (i = 0; i < featureNum; i++)
+    {
+        cacheFeature[i].x     = feature[i].x;
+        cacheFeature[i].y     = feature[i].y;
+        cacheFeature[i].x2    = feature[i].x2;
+        cacheFeature[i].y2    = feature[i].y2;
+        cacheFeature[i].layer = feature[i].layer;
+    }
+
+    memset(&head, 0, sizeof(head));
+    memcpy(head.magic, "RDXF", 4);
+    head.version      = DXF_MAP_CACHE_VERSION;
+    head.dxfSize      = dxfStat->st_size;
+    head.dxfMtimeSec  = dxfStat->st_mtim.tv_sec;
+    head.dxfMtimeNsec = dxfStat->st_mtim.tv_nsec;
+    head.hash         = cacheHash(cacheFeature, featureNum);
+    head.featureNum   = featureNum;
+
+    // modules loading the map at the same time don't see a partial cache
+    snprintf(tmpName, sizeof(tmpName), "%s.%d", cacheName, (int)getpid());
+
+    ret = -EIO;
+    if ((fp = fopen(tmpName, "w")) != NULL)
+    {
+        if ((fwrite(&head, sizeof(head), 1, fp) == 1) &&
+            (fwrite(cacheFeature, sizeof(dxf_map_cache_feature), featureNum, fp) == (size_t)featureNum))
+        {
+            ret = 0;
+        }
+        if (fclose(fp))
+        {
+            ret = -EIO;
+        }
+
+        if (!ret && rename(tmpName, cacheName))
+        {
+            ret = -EIO;
+        }
+        if (ret)
+        {
+            unlink(tmpName);
+        }
+    }
+
+    free(cacheFeature);
+    return ret;
+}
+
+int DxfMap::load(char *filename, double mapOffsetX, double mapOffsetY, double scaleFactor)
+{
+    struct stat dxfStat;
+    char        cacheName[strlen(filename) + 7];
+    int         i, ret;
+    double      x, y;
+
+    if (stat(filename, &dxfStat))
+    {
+        printf("Can't open dxf file \"%s\"\n", filename);
+        return -EIO;
+    }
+
+    snprintf(cacheName, sizeof(cacheName), "%s.cache", filename);
+
+    if (!useCache || (loadCache(cacheName, &dxfStat) < 0))
+    {
+        ret = parse(filename);
+        if (ret)
+        {
+            return ret;
+        }
+
+        // the cache is not written if the directory is read only
+        if (useCache)
+        {
+            saveCache(cacheName, &dxfStat);
+        }
+    }
 
     for (i = 0; i < featureNum; i++)
     {
@@ -778,6 +1180,12 @@ int DxfMap::save(char *filename, int savefeatureNum, double scaleFactor)
     write_eof(fp);
 
     fclose(fp);
+
+    // the binary cache of the old file is invalid
+    char cacheName[strlen(filename) + 7];
+    snprintf(cacheName, sizeof(cacheName), "%s.cache", filename);
+    unlink(cacheName);
+
     return 0;
 }
      
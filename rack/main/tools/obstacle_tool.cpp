@@ -0,0 +1,350 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Matthias Hentschel <hentschel@rts.uni-hannover.de>
+ *
+ */
+
+#include <main/obstacle_tool.h>
+
+#define N   OBSTACLE_TOOL_CELL_NUM
+
+ObstacleTool::ObstacleTool(int cellSize)
+{
+    if (cellSize <= 0)
+        cellSize = OBSTACLE_TOOL_CELL_SIZE;
+
+    this->cellSize = cellSize;
+    this->range    = cellSize * N / 2;
+
+    clear();
+}
+
+/**
+ * Removes all obstacles from the grid
+ */
+void ObstacleTool::clear(void)
+{
+    pointNum = 0;
+    scan     = NULL;
+
+    memset(pointSum, 0, sizeof(pointSum));
+    memset(dynSum, 0, sizeof(dynSum));
+    memset(distance, 0xff, sizeof(distance));
+}
+
+/**
+ * Builds the obstacle grid of a new scan
+ *
+ * Invalid points and landmarks are no obstacles. This function has to be
+ * called once after every new scan, all queries use the last grid. The scan
+ * is kept for tests beyond the grid, so it has to stay valid until the next
+ * update.
+ *
+ * @param scan Scan2d data in robot coordinates
+ *
+ * @return Number of obstacle points inside the grid
+ */
+int ObstacleTool::update(scan2d_data *scan)
+{
+    int i, j, ix, iy;
+    int32_t *p, *q;
+
+    clear();
+    this->scan = scan;
+
+    // enter the obstacle points, the sum tables start at index 1
+    for (i = 0; i < scan->pointNum; i++)
+    {
+        if (((scan->point[i].type & SCAN_POINT_TYPE_INVALID) != 0) ||
+            ((scan->point[i].type & SCAN_POINT_TYPE_MASK) == SCAN_POINT_TYPE_LANDMARK))
+            continue;
+
+        if ((scan->point[i].x < -range) || (scan->point[i].x >= range) ||
+            (scan->point[i].y < -range) || (scan->point[i].y >= range))
+            continue;
+
+        ix = (scan->point[i].x + range) / cellSize;
+        iy = (scan->point[i].y + range) / cellSize;
+
+        pointSum[(ix + 1) * (N + 1) + iy + 1]++;
+
+        if ((scan->point[i].type & SCAN_POINT_TYPE_MASK) == SCAN_POINT_TYPE_DYN_OBSTACLE)
+            dynSum[(ix + 1) * (N + 1) + iy + 1]++;
+
+        distance[ix * N + iy] = 0;
+        pointNum++;
+    }
+
+    // summed area tables
+    for (i = 1; i <= N; i++)
+    {
+        p = &pointSum[i * (N + 1)];
+        q = &dynSum[i * (N + 1)];
+
+        for (j = 1; j <= N; j++)
+        {
+            p[j] += p[j - 1] + p[j - (N + 1)] - p[j - (N + 2)];
+            q[j] += q[j - 1] + q[j - (N + 1)] - q[j - (N + 2)];
+        }
+    }
+
+    distanceTransform();
+
+    return pointNum;
+}
+
+/**
+ * Tests if a rectangle is covered by the grid
+ *
+ * @return 1 if the rectangle is inside the grid, otherwise 0
+ */
+int ObstacleTool::rectInside(int xMin, int yMin, int xMax, int yMax)
+{
+    if ((xMin < -range) || (xMax >= range) || (yMin < -range) || (yMax >= range))
+        return 0;
+
+    return 1;
+}
+
+/**
+ * Tests a rectangle for obstacles
+ *
+ * @return Number of obstacle points inside the rectangle, 0 if it is free
+ */
+int ObstacleTool::rectTest(int xMin, int yMin, int xMax, int yMax)
+{
+    return rectSum(pointSum, xMin, yMin, xMax, yMax);
+}
+
+/**
+ * Tests a rectangle for dynamic obstacles
+ *
+ * @return Number of dynamic obstacle points inside the rectangle
+ */
+int ObstacleTool::rectTestDyn(int xMin, int yMin, int xMax, int yMax)
+{
+    return rectSum(dynSum, xMin, yMin, xMax, yMax);
+}
+
+/**
+ * Distance of a position to the next obstacle
+ *
+ * @return Distance in mm, OBSTACLE_TOOL_DIST_MAX outside of the grid or
+ *         if there is no obstacle
+ */
+int ObstacleTool::getDistance(int x, int y)
+{
+    if ((x < -range) || (x >= range) || (y < -range) || (y >= range))
+        return OBSTACLE_TOOL_DIST_MAX;
+
+    return distance[((x + range) / cellSize) * N + (y + range) / cellSize];
+}
+
+/**
+ * Clearance of a circular arc
+ *
+ * The arc starts at the robot position in x-direction, the center of the
+ * arc is (0, radius), radius 0 is a straight line. The arc is free as long
+ * as the distance to the next obstacle is greater than "width". The free
+ * part ends at the border of the grid.
+ *
+ * A robot that is not symmetric to its arc is tested by shifting the
+ * tested corridor sideways with "offset". If "front" is set, obstacles
+ * behind the robot are ignored. Then the first "width" mm of the arc are
+ * tested as a rectangle from x = 0 on.
+ *
+ * @param radius    Radius of the arc in mm (positive to the right)
+ * @param length    Length of the arc in mm
+ * @param width     Half width of the robot including the safety margin
+ * @param p_distMin Minimum obstacle distance along the free part of the arc
+ *                  (may be NULL)
+ * @param offset    Shift of the tested corridor in mm (positive to the right)
+ * @param front     Ignore obstacles behind the robot (x < 0)
+ *
+ * @return Free length of the arc in mm, "length" if the whole arc is free
+ */
+int ObstacleTool::arcClearance(int radius, int length, int width, int *p_distMin,
+                               int offset, int front)
+{
+    int   s, xs, ys, free, dist, distMin;
+    float x, y, r, sign, sinPhi, cosPhi, sinStep, cosStep, tmp;
+
+    free    = 0;
+    distMin = OBSTACLE_TOOL_DIST_MAX;
+    s       = 0;
+
+    if (front)
+    {
+        s = (width < length) ? width : length;
+
+        if (rectTest(0, offset - width, s, offset + width))
+        {
+            if (p_distMin)
+                *p_distMin = distMin;
+
+            return 0;
+        }
+    }
+
+    // the arc is sampled with the cell size
+    width  += cellSize / 2;
+
+    r       = (float)abs(radius);
+    sign    = (radius < 0) ? -1.0f : 1.0f;
+    sinPhi  = 0.0f;
+    cosPhi  = 1.0f;
+    sinStep = 0.0f;
+    cosStep = 1.0f;
+    if (radius != 0)
+    {
+        sinPhi  = sinf((float)s / r);
+        cosPhi  = cosf((float)s / r);
+        sinStep = sinf((float)cellSize / r);
+        cosStep = cosf((float)cellSize / r);
+    }
+
+    for (; ; s += cellSize)
+    {
+        if (s > length)
+            s = length;
+
+        if (radius == 0)
+        {
+            x = (float)s;
+            y = 0.0f;
+        }
+        else
+        {
+            if (s == length)
+            {
+                sinPhi = sinf((float)s / r);
+                cosPhi = cosf((float)s / r);
+            }
+            x = r * sinPhi;
+            y = (float)radius * (1.0f - cosPhi);
+        }
+
+        // the corridor is shifted along the normal of the arc
+        xs = (int)(x - sign * (float)offset * sinPhi);
+        ys = (int)(y + (float)offset * cosPhi);
+        if (!rectInside(xs - width, ys - width, xs + width, ys + width))
+            break;
+
+        dist = getDistance(xs, ys);
+        if (dist <= width)
+            break;
+
+        if (offset != 0)
+            dist = getDistance((int)x, (int)y);
+
+        if (dist < distMin)
+            distMin = dist;
+        free = s;
+
+        if (s == length)
+            break;
+
+        // next point of the arc
+        tmp    = sinPhi * cosStep + cosPhi * sinStep;
+        cosPhi = cosPhi * cosStep - sinPhi * sinStep;
+        sinPhi = tmp;
+    }
+
+    if (p_distMin)
+        *p_distMin = distMin;
+
+    return free;
+}
+
+int ObstacleTool::rectSum(int32_t *sum, int xMin, int yMin, int xMax, int yMax)
+{
+    int tmp, ix0, iy0, ix1, iy1;
+
+    if (xMin > xMax)
+    {
+        tmp  = xMin;
+        xMin = xMax;
+        xMax = tmp;
+    }
+    if (yMin > yMax)
+    {
+        tmp  = yMin;
+        yMin = yMax;
+        yMax = tmp;
+    }
+
+    if ((xMax < -range) || (xMin >= range) || (yMax < -range) || (yMin >= range))
+        return 0;
+
+    ix0 = (xMin < -range) ? 0     : (xMin + range) / cellSize;
+    iy0 = (yMin < -range) ? 0     : (yMin + range) / cellSize;
+    ix1 = (xMax >= range) ? N - 1 : (xMax + range) / cellSize;
+    iy1 = (yMax >= range) ? N - 1 : (yMax + range) / cellSize;
+
+    return sum[(ix1 + 1) * (N + 1) + iy1 + 1] - sum[ix0 * (N + 1) + iy1 + 1] -
+           sum[(ix1 + 1) * (N + 1) + iy0]     + sum[ix0 * (N + 1) + iy0];
+}
+
+// two pass chamfer distance transform
+void ObstacleTool::distanceTransform(void)
+{
+    int      i, j, d, a, b;
+    uint16_t *p;
+
+    a = cellSize;
+    b = (int)rint(cellSize * M_SQRT2);
+
+    for (i = 0; i < N; i++)
+    {
+        p = &distance[i * N];
+
+        for (j = 0; j < N; j++)
+        {
+            d = p[j];
+            if (j > 0 && p[j - 1] + a < d)
+                d = p[j - 1] + a;
+            if (i > 0)
+            {
+                if (p[j - N] + a < d)
+                    d = p[j - N] + a;
+                if (j > 0 && p[j - N - 1] + b < d)
+                    d = p[j - N - 1] + b;
+                if (j < N - 1 && p[j - N + 1] + b < d)
+                    d = p[j - N + 1] + b;
+            }
+            p[j] = d;
+        }
+    }
+
+    for (i = N - 1; i >= 0; i--)
+    {
+        p = &distance[i * N];
+
+        for (j = N - 1; j >= 0; j--)
+        {
+            d = p[j];
+            if (j < N - 1 && p[j + 1] + a < d)
+                d = p[j + 1] + a;
+            if (i < N - 1)
+            {
+                if (p[j + N] + a < d)
+                    d = p[j + N] + a;
+                if (j < N - 1 && p[j + N + 1] + b < d)
+                    d = p[j + N + 1] + b;
+                if (j > 0 && p[j + N - 1] + b < d)
+                    d = p[j + N - 1] + b;
+            }
+            p[j] = d;
+        }
+    }
+}
@@ -19,11 +19,13 @@
 PositionTool::PositionTool()
 {
     gdos = NULL;
+    init();
 }
 
 PositionTool::PositionTool(RackMailbox *p_mbx, int gdos_level)
 {
     gdos = new RackGdos(p_mbx, gdos_level);
+    init();
 }
 
 PositionTool::~PositionTool()
@@ -32,34 +34,76 @@ PositionTool::~PositionTool()
         delete gdos;
 }
 
-void PositionTool::wgs84ToUtm(position_wgs84_data *posWgs84, position_utm_data *posUtm)
+// constants of the batch conversions, same terms as in the single conversions
+void PositionTool::init(void)
+{
+    int    zone;
+    double tn, tn2, tn3, tn4, tn5;
+    double eq2;
+    double utmA = 6378137.0;                        // Semi-major axis of ellipsoid in meters
+    double utmF = 1.0 / 298.257223563;              // flattening of ellipsoid
+
+    // transverse mercator
+    tmEs  = 2.0 * utmF - utmF * utmF;
+    tmEbs = (1.0 / (1.0 - tmEs)) - 1.0;
+
+    tn  = (utmA - utmA * (1.0 - utmF)) / (utmA + utmA * (1.0 - utmF));
+    tn2 = tn * tn;
+    tn3 = tn2 * tn;
+    tn4 = tn3 * tn;
+    tn5 = tn4 * tn;
+
+    tmAp = utmA * (1.0 - tn + 5.0 * (tn2 - tn3) / 4.0 +
+           81.0 * (tn4 - tn5) / 64.0 );
+    tmBp = 3.0 * utmA * (tn - tn2 + 7.0 * (tn3 - tn4) /
+           8.0 + 55.0 * tn5 / 64.0 ) / 2.0;
+    tmCp = 15.0 * utmA  * (tn2 - tn3 + 3.0 * (tn4 - tn5 ) / 4.0) / 16.0;
+    tmDp = 35.0 * utmA  * (tn3 - tn4 + 11.0 * tn5 / 16.0) / 48.0;
+    tmEp = 315.0 * utmA * (tn4 - tn5) / 512.0;
+
+    // utm zones (index 0 for invalid longitudes)
+    for (zone = 0; zone <= 60; zone++)
+    {
+        if (zone >= 31)
+        {
+            utmCentralMeridian[zone] = (6 * zone - 183) * M_PI / 180.0;
+        }
+        else
+        {
+            utmCentralMeridian[zone] = (6 * zone + 177) * M_PI / 180.0;
+        }
+
+        if (utmCentralMeridian[zone] > M_PI)
+        {
+            utmCentralMeridian[zone] -= (2.0*M_PI);
+        }
+    }
+
+    // gauss-krueger
+    gkEq    = (ABES * ABES - BBES * BBES) / (ABES * ABES);
+    gkEst   = sqrt(gkEq / (1.0 - gkEq));
+    gkCbess = ABES / sqrt(1.0 - gkEq);
+    eq2     = (ABES * ABES - BBES * BBES) / (BBES * BBES);
+    gkAlpha = (1.0 - (3.0 / 4.0) * eq2  + (45.0 / 64.0) * eq2 * eq2 -
+              (175.0 / 256.0) * eq2 * eq2 * eq2 + (11025.0 / 16384.0) * eq2 * eq2 * eq2 * eq2);
+    gkBeta  = (1.0 / 2.0) * ((3.0 / 4.0) * eq2  - (15.0 / 16.0) * eq2 * eq2 +
+              (525.0 / 512.0) * eq2 * eq2 * eq2 -
+              ( 2205.0 /  2048.0) * eq2 * eq2 * eq2 * eq2);
+    gkGamma = (1.0 / 4.0) * ((15.0 / 64.0) * eq2 * eq2 - (105.0 / 256.0) * eq2 * eq2 * eq2 +
+              ( 2205.0 /  4096.0) * eq2 * eq2 * eq2 * eq2);
+    gkDelta = (1.0 / 6.0) * (( 35.0 / 512.0) * eq2 * eq2 * eq2 +
+              ( 2205.0 /  4096.0) * eq2 * eq2 * eq2 * eq2);
+    gkI     = (ABES - BBES) / (ABES + BBES);
+    gkGrd   = (ABES / (1.0 + gkI)) * (1.0 + 0.25 * gkI * gkI + (1.0 / 64.0) * gkI * gkI * gkI * gkI);
+
+    wgsEq   = (AWGS * AWGS - BWGS * BWGS) / (AWGS * AWGS);
+}
+
+void PositionTool::utmZone(position_wgs84_data *posWgs84, position_utm_data *posUtm)
 {
     int    latDeg, lonDeg;
     int    utmBand;
     double lat, lon;
-    double dlam, dlam2, dlam3, dlam4;
-    double dlam5, dlam6, dlam7, dlam8;
-    double s, s2;
-    double sn;
-    double c, c2, c3, c5, c7;
-    double t, tan2, tan3, tan4, tan5, tan6;
-    double t1, t2, t3, t4, t5, t6, t7, t8, t9;
-    double eta, eta2, eta3, eta4;
-    double tn, tn2, tn3, tn4, tn5;
-    double tmd;
-    double tmdo;
-    double tranMercB;
-    double tranMercEs;
-    double tranMercEbs;
-    double tranMercAp, tranMercBp;
-    double tranMercCp, tranMercDp, tranMercEp;
-    double centralMeridian = 0.0;
-    double easting, northing;
-    double falseEasting    = 500000;
-    double falseNorthing   = 0;
-    double utmScale        = 0.9996;
-    static double utmA     = 6378137.0;             // Semi-major axis of ellipsoid in meters
-    static double utmF     = 1.0 / 298.257223563;   // flattening of ellipsoid
 
     lat = posWgs84->latitude;
     lon = posWgs84->longitude;
@@ -67,7 +111,7 @@ void PositionTool::wgs84ToUtm(position_wgs84_data *posWgs84, position_utm_data *
     {
         lon += (2.0 * M_PI) + 1.0e-10;
     }
-    latDeg = (int)(lat * 180.0 / M_PI);
+    latDeg = (int)floor(lat * 180.0 / M_PI);
     lonDeg = (int)(lon * 180.0 / M_PI);
 
     // zone calculation
@@ -110,25 +154,6 @@ void PositionTool::wgs84ToUtm(position_wgs84_data *posWgs84, position_utm_data *
         posUtm->zone = 37;
     }
 
-    if (posUtm->zone >= 31)
-    {
-        centralMeridian = (6 * posUtm->zone - 183) * M_PI / 180.0;
-    }
-    else
-    {
-        centralMeridian = (6 * posUtm->zone + 177) * M_PI / 180.0;
-    }
-
-    if (centralMeridian > M_PI)
-    {
-        centralMeridian -= (2.0*M_PI);
-    }
-
-    if (lat < 0)
-    {
-        falseNorthing = 10000000;
-    }
-
     // utm band calculation
 
     // south pole
@@ -224,6 +249,62 @@ void PositionTool::wgs84ToUtm(position_wgs84_data *posWgs84, position_utm_data *
                 break;
         }
     }
+}
+
+void PositionTool::wgs84ToUtm(position_wgs84_data *posWgs84, position_utm_data *posUtm)
+{
+    double lat, lon;
+    double dlam, dlam2, dlam3, dlam4;
+    double dlam5, dlam6, dlam7, dlam8;
+    double s, s2;
+    double sn;
+    double c, c2, c3, c5, c7;
+    double t, tan2, tan3, tan4, tan5, tan6;
+    double t1, t2, t3, t4, t5, t6, t7, t8, t9;
+    double eta, eta2, eta3, eta4;
+    double tn, tn2, tn3, tn4, tn5;
+    double tmd;
+    double tmdo;
+    double tranMercB;
+    double tranMercEs;
+    double tranMercEbs;
+    double tranMercAp, tranMercBp;
+    double tranMercCp, tranMercDp, tranMercEp;
+    double centralMeridian = 0.0;
+    double easting, northing;
+    double falseEasting    = 500000;
+    double falseNorthing   = 0;
+    double utmScale        = 0.9996;
+    static double utmA     = 6378137.0;             // Semi-major axis of ellipsoid in meters
+    static double utmF     = 1.0 / 298.257223563;   // flattening of ellipsoid
+
+    lat = posWgs84->latitude;
+    lon = posWgs84->longitude;
+    if (lon < 0)
+    {
+        lon += (2.0 * M_PI) + 1.0e-10;
+    }
+
+    utmZone(posWgs84, posUtm);
+
+    if (posUtm->zone >= 31)
+    {
+        centralMeridian = (6 * posUtm->zone - 183) * M_PI / 180.0;
+    }
+    else
+    {
+        centralMeridian = (6 * posUtm->zone + 177) * M_PI / 180.0;
+    }
+
+    if (centralMeridian > M_PI)
+    {
+        centralMeridian -= (2.0*M_PI);
+    }
+
+    if (lat < 0)
+    {
+        falseNorthing = 10000000;
+    }
 
     //
     // convert geodetic position to transverse mercator
@@ -367,7 +448,8 @@ void PositionTool::utmToWgs84(position_utm_data *posUtm, position_wgs84_data *po
     {
         centralMeridian = ((6 * posUtm->zone + 177) * M_PI / 180.0 /*+ 0.00000005*/);
     }
-    if (posUtm->northing < 0)
+    // southern hemisphere
+    if (posUtm->band < N)
     {
         falseNorthing = 10000000;
     }
@@ -648,7 +730,7 @@ void PositionTool::gkToWgs84(position_gk_data *posGk, position_wgs84_data *posWg
     c      = cos(bf);
     t      = tan(bf);
     nf     = ABES / sqrt(1.0 - eq * s * s);
-    mf     = (ABES * (1.0 - eq)) / pow((1.0 - eq * s * s), 3/2);
+    mf     = (ABES * (1.0 - eq)) / pow((1.0 - eq * s * s), 1.5);
     eta    = est * c;
 
     b1     =  1.0 / (nf * c);
@@ -706,3 +788,572 @@ void PositionTool::gkToWgs84(position_gk_data *posGk, position_wgs84_data *posWg
     posWgs84->altitude  = (int)rint(((xq / (cos(lat) * cos(lon))) - n) * 1000.0);
     posWgs84->heading   = posGk->heading;
 }
+
+//
+// batch conversions
+//
+
+void PositionTool::wgs84ToUtm(position_wgs84_data *posWgs84, position_utm_data *posUtm, int num)
+{
+    int    i, j, n, zone;
+    double lat[POSITION_TOOL_BLOCK_SIZE], dlam[POSITION_TOOL_BLOCK_SIZE];
+    double s[POSITION_TOOL_BLOCK_SIZE], c[POSITION_TOOL_BLOCK_SIZE];
+    double falseNorthing[POSITION_TOOL_BLOCK_SIZE];
+    double northing[POSITION_TOOL_BLOCK_SIZE], easting[POSITION_TOOL_BLOCK_SIZE];
+    double lon, dl, dlam2;
+    double s2, c2, c4, c6;
+    double tan2, tan4, tan6;
+    double eta, eta2, eta3, eta4;
+    double sin2, cos2, sin4, cos4, sin6, sin8;
+    double sn, snc, tmd;
+    double t1, t2, t3, t4, t5, t6, t7, t8, t9;
+    double falseEasting    = 500000;
+    double utmScale        = 0.9996;
+
+    for (i = 0; i < num; i += n)
+    {
+        n = num - i;
+        if (n > POSITION_TOOL_BLOCK_SIZE)
+        {
+            n = POSITION_TOOL_BLOCK_SIZE;
+        }
+
+        // zones and delta longitudes
+        for (j = 0; j < n; j++)
+        {
+            utmZone(&posWgs84[i + j], &posUtm[i + j]);
+
+            lat[j] = posWgs84[i + j].latitude;
+            lon    = posWgs84[i + j].longitude;
+            if (lon < 0)
+            {
+                lon += (2.0 * M_PI) + 1.0e-10;
+            }
+
+            zone = posUtm[i + j].zone;
+            if ((zone < 0) || (zone > 60))
+            {
+                zone = 0;
+            }
+
+            dl = lon - utmCentralMeridian[zone];
+            if (dl > M_PI)
+            {
+                dl -= (2.0 * M_PI);
+            }
+            if (dl < -M_PI)
+            {
+                dl += (2.0 * M_PI);
+            }
+            if (fabs(dl) < 2.e-10)
+            {
+                dl = 0.0;
+            }
+            dlam[j] = dl;
+
+            if (lat[j] < 0)
+            {
+                falseNorthing[j] = 10000000;
+            }
+            else
+            {
+                falseNorthing[j] = 0;
+            }
+
+            sincos(lat[j], &s[j], &c[j]);
+        }
+
+        // transverse mercator series
+        for (j = 0; j < n; j++)
+        {
+            s2    = s[j] * s[j];
+            c2    = c[j] * c[j];
+            c4    = c2 * c2;
+            c6    = c4 * c2;
+            tan2  = s2 / c2;
+            tan4  = tan2 * tan2;
+            tan6  = tan4 * tan2;
+            eta   = tmEbs * c2;
+            eta2  = eta * eta;
+            eta3  = eta2 * eta;
+            eta4  = eta3 * eta;
+
+            // multiple angles of the meridian arc
+            sin2  = 2.0 * s[j] * c[j];
+            cos2  = c2 - s2;
+            sin4  = 2.0 * sin2 * cos2;
+            cos4  = cos2 * cos2 - sin2 * sin2;
+            sin6  = sin4 * cos2 + cos4 * sin2;
+            sin8  = 2.0 * sin4 * cos4;
+
+            tmd   = tmAp * lat[j] - tmBp * sin2 + tmCp * sin4 - tmDp * sin6 + tmEp * sin8;
+
+            // radius of curvature in prime vertical
+            sn    = AWGS / sqrt(1.0 - tmEs * s2);
+            snc   = sn * c[j] * utmScale;
+
+            // northing
+            t1 = tmd * utmScale;
+            t2 = snc * s[j] / 2.0;
+            t3 = snc * s[j] * c2 * (5.0 - tan2 + 9.0 * eta + 4.0 * eta2) / 24.0;
+            t4 = snc * s[j] * c4 * (61.0 - 58.0 * tan2 + tan4 + 270.0 * eta -
+                                    330.0 * tan2 * eta + 445.0 * eta2 + 324.0 * eta3 -
+                                    680.0 * tan2 * eta2 + 88.0 * eta4 - 600.0 * tan2 * eta3 -
+                                    192.0 * tan2 * eta4) / 720.0;
+            t5 = snc * s[j] * c6 * (1385.0 - 3111.0 * tan2 + 543.0 * tan4 - tan6) / 40320.0;
+
+            // easting
+            t6 = snc;
+            t7 = snc * c2 * ( 1.0 - tan2 + eta ) / 6.0;
+            t8 = snc * c4 * ( 5.0 - 18.0 * tan2 + tan4 +
+                             14.0 * eta - 58.0 * tan2 * eta + 13.0 * eta2 + 4.0 * eta3 -
+                             64.0 * tan2 * eta2 - 24.0 * tan2 * eta3 ) / 120.0;
+            t9 = snc * c6 * (61.0 - 479.0 * tan2 + 179.0 * tan4 - tan6 ) / 5040.0;
+
+            dlam2       = dlam[j] * dlam[j];
+            northing[j] = falseNorthing[j] + t1 +
+                          dlam2 * (t2 + dlam2 * (t3 + dlam2 * (t4 + dlam2 * t5)));
+            easting[j]  = falseEasting +
+                          dlam[j] * (t6 + dlam2 * (t7 + dlam2 * (t8 + dlam2 * t9)));
+        }
+
+        for (j = 0; j < n; j++)
+        {
+            posUtm[i + j].northing = northing[j] * 1000.0;
+            posUtm[i + j].easting  = easting[j] * 1000.0;
+            posUtm[i + j].altitude = posWgs84[i + j].altitude;
+            posUtm[i + j].heading  = posWgs84[i + j].heading;
+        }
+    }
+}
+
+void PositionTool::utmToWgs84(position_utm_data *posUtm, position_wgs84_data *posWgs84, int num)
+{
+    int    i, j, k, n, zone;
+    double tmd[POSITION_TOOL_BLOCK_SIZE], ftphi[POSITION_TOOL_BLOCK_SIZE];
+    double de[POSITION_TOOL_BLOCK_SIZE], centralMeridian[POSITION_TOOL_BLOCK_SIZE];
+    double s[POSITION_TOOL_BLOCK_SIZE], c[POSITION_TOOL_BLOCK_SIZE];
+    double lat[POSITION_TOOL_BLOCK_SIZE], lon[POSITION_TOOL_BLOCK_SIZE];
+    double falseNorthing;
+    double sin2, cos2, sin4, cos4, sin6, sin8;
+    double s2, c2, a, sr, sr0;
+    double sn, sn2, sn3, sn5, sn7;
+    double t, tan2, tan4, tan6;
+    double eta, eta2, eta3, eta4;
+    double de2;
+    double t10, t11, t12, t13;
+    double t14, t15, t16, t17;
+    double utmScale2, utmScale3, utmScale4;
+    double utmScale5, utmScale6, utmScale7, utmScale8;
+    double falseEasting    = 500000;
+    double utmScale        = 0.9996;
+
+    utmScale2 = utmScale * utmScale;
+    utmScale3 = utmScale2 * utmScale;
+    utmScale4 = utmScale2 * utmScale2;
+    utmScale5 = utmScale3 * utmScale2;
+    utmScale6 = utmScale4 * utmScale2;
+    utmScale7 = utmScale4 * utmScale3;
+    utmScale8 = utmScale6 * utmScale2;
+    sr0       = AWGS * (1.0 - tmEs);
+
+    for (i = 0; i < num; i += n)
+    {
+        n = num - i;
+        if (n > POSITION_TOOL_BLOCK_SIZE)
+        {
+            n = POSITION_TOOL_BLOCK_SIZE;
+        }
+
+        for (j = 0; j < n; j++)
+        {
+            zone = posUtm[i + j].zone;
+            if ((zone < 0) || (zone > 60))
+            {
+                zone = 0;
+            }
+            centralMeridian[j] = utmCentralMeridian[zone];
+
+            if (posUtm[i + j].band < N)
+            {
+                falseNorthing = 10000000;
+            }
+            else
+            {
+                falseNorthing = 0;
+            }
+
+            de[j] = posUtm[i + j].easting / 1000.0 - falseEasting;
+            if (fabs(de[j]) < 0.0001)
+            {
+                de[j] = 0.0;
+            }
+
+            tmd[j]   = (posUtm[i + j].northing / 1000.0 - falseNorthing) / utmScale;
+            ftphi[j] = tmd[j] / sr0;
+        }
+
+        // footpoint latitude
+        for (k = 0; k < 5; k++)
+        {
+            for (j = 0; j < n; j++)
+            {
+                sincos(ftphi[j], &s[j], &c[j]);
+            }
+
+            for (j = 0; j < n; j++)
+            {
+                s2   = s[j] * s[j];
+                sin2 = 2.0 * s[j] * c[j];
+                cos2 = c[j] * c[j] - s2;
+                sin4 = 2.0 * sin2 * cos2;
+                cos4 = cos2 * cos2 - sin2 * sin2;
+                sin6 = sin4 * cos2 + cos4 * sin2;
+                sin8 = 2.0 * sin4 * cos4;
+
+                t10  = tmAp * ftphi[j] - tmBp * sin2 + tmCp * sin4 -
+                       tmDp * sin6 - tmEp * sin8;
+                a    = sqrt(1.0 - tmEs * s2);
+                sr   = sr0 / (a * a * a);
+                ftphi[j] += (tmd[j] - t10) / sr;
+            }
+        }
+
+        for (j = 0; j < n; j++)
+        {
+            sincos(ftphi[j], &s[j], &c[j]);
+        }
+
+        // transverse mercator series
+        for (j = 0; j < n; j++)
+        {
+            s2   = s[j] * s[j];
+            c2   = c[j] * c[j];
+            a    = sqrt(1.0 - tmEs * s2);
+            sr   = sr0 / (a * a * a);
+            sn   = AWGS / a;
+            sn2  = sn * sn;
+            sn3  = sn2 * sn;
+            sn5  = sn3 * sn2;
+            sn7  = sn5 * sn2;
+
+            t    = s[j] / c[j];
+            tan2 = t * t;
+            tan4 = tan2 * tan2;
+            tan6 = tan4 * tan2;
+            eta  = tmEbs * c2;
+            eta2 = eta * eta;
+            eta3 = eta2 * eta;
+            eta4 = eta3 * eta;
+            de2  = de[j] * de[j];
+
+            // latitude
+            t10 = t / (2.0 * sr * sn * utmScale2);
+            t11 = t * (5.0  + 3.0 * tan2 + eta - 4.0 * eta2 -
+                       9.0 * tan2 * eta) / (24.0 * sr * sn3 * utmScale4);
+            t12 = t * (61.0 + 90.0 * tan2 + 46.0 * eta + 45.0 * tan4 -
+                       252.0 * tan2 * eta  - 3.0 * eta2 + 100.0 * eta3 -
+                       66.0 * tan2 * eta2 - 90.0 * tan4 * eta +
+                       88.0 * eta4 + 225.0 * tan4 * eta2 + 84.0 * tan2 * eta3 -
+                       192.0 * tan2 * eta4) / ( 720.0 * sr * sn5 * utmScale6);
+            t13 = t * (1385.0 + 3633.0 * tan2 + 4095.0 * tan4 + 1575.0 * tan6) /
+                      (40320.0 * sr * sn7 * utmScale8);
+            lat[j] = ftphi[j] - de2 * (t10 - de2 * (t11 - de2 * (t12 - de2 * t13)));
+
+            // difference in longitude
+            t14 = 1.0 / (sn * c[j] * utmScale);
+            t15 = (1.0 + 2.0 * tan2 + eta) / (6.0 * sn3 * c[j] * utmScale3);
+            t16 = (5.0 + 6.0 * eta + 28.0 * tan2 - 3.0 * eta2 +
+                   8.0 * tan2 * eta + 24.0 * tan4 - 4.0 * eta3 +
+                   4.0 * tan2 * eta2 + 24.0 * tan2 * eta3) / (120.0 * sn5 * c[j] * utmScale5);
+            t17 = (61.0 +  662.0 * tan2 + 1320.0 * tan4 + 720.0 * tan6) /
+                  (5040.0 * sn7 * c[j] * utmScale7);
+            lon[j] = centralMeridian[j] +
+                     de[j] * (t14 - de2 * (t15 - de2 * (t16 - de2 * t17)));
+        }
+
+        for (j = 0; j < n; j++)
+        {
+            if (lon[j] > M_PI)
+            {
+                lon[j] -= (2.0 * M_PI);
+            }
+            if (lon[j] < -M_PI)
+            {
+                lon[j] += (2.0 * M_PI);
+            }
+
+            posWgs84[i + j].latitude  = lat[j];
+            posWgs84[i + j].longitude = lon[j];
+            posWgs84[i + j].altitude  = posUtm[i + j].altitude;
+            posWgs84[i + j].heading   = posUtm[i + j].heading;
+        }
+    }
+}
+
+void PositionTool::wgs84ToGk(position_wgs84_data *posWgs84, position_gk_data *posGk, int num)
+{
+    int     i, j, n, iterate;
+    double  phi[POSITION_TOOL_BLOCK_SIZE], tanPhi[POSITION_TOOL_BLOCK_SIZE];
+    double  sinPhi[POSITION_TOOL_BLOCK_SIZE], cosPhi[POSITION_TOOL_BLOCK_SIZE];
+    double  r[POSITION_TOOL_BLOCK_SIZE], zz[POSITION_TOOL_BLOCK_SIZE];
+    double  nq[POSITION_TOOL_BLOCK_SIZE], lambda[POSITION_TOOL_BLOCK_SIZE];
+    double  l[POSITION_TOOL_BLOCK_SIZE], zone[POSITION_TOOL_BLOCK_SIZE];
+    double  northing[POSITION_TOOL_BLOCK_SIZE], easting[POSITION_TOOL_BLOCK_SIZE];
+    double  altitude;
+    double  sinLat, cosLat;
+    double  sinLon, cosLon;
+    double  xq, yq, zq;
+    double  xz, yz;
+    double  n0, t, tOld;
+    double  c, s, t2, l2;
+    double  eta2;
+    double  a1, a2, a3, a4, a5;
+    double  sin2, cos2, sin4, cos4, sin6;
+    double  gb;
+
+    for (i = 0; i < num; i += n)
+    {
+        n = num - i;
+        if (n > POSITION_TOOL_BLOCK_SIZE)
+        {
+            n = POSITION_TOOL_BLOCK_SIZE;
+        }
+
+        for (j = 0; j < n; j++)
+        {
+            sincos(posWgs84[i + j].latitude, &sinLat, &cosLat);
+            sincos(posWgs84[i + j].longitude, &sinLon, &cosLon);
+            altitude = (double)posWgs84[i + j].altitude / 1000.0;      // unit m
+
+            // geocentric cartesian coordinates in wgs84 ellipsoid
+            n0 = AWGS / sqrt(1.0 - wgsEq * sinLat * sinLat);
+            xq = (n0 + altitude) * cosLat * cosLon;
+            yq = (n0 + altitude) * cosLat * sinLon;
+            zq = ((1.0 - wgsEq) * n0 + altitude) * sinLat;
+
+            // Helmert transformation
+            xz    = HELM_DX + HELM_SC * (       1.0 * xq  + HELM_ROTZ * yq - HELM_ROTY * zq);
+            yz    = HELM_DY + HELM_SC * (-HELM_ROTZ * xq  +         1 * yq + HELM_ROTX * zq);
+            zz[j] = HELM_DZ + HELM_SC * ( HELM_ROTY * xq  - HELM_ROTX * yq +       1.0 * zq);
+
+            lambda[j] = atan2(yz, xz);
+            r[j]      = sqrt(xz * xz + yz * yz);
+        }
+
+        // elliptic coordinates in Potsdam-Date, the iteration runs on the
+        // tangent of the latitude and steps all positions of the block until
+        // the last one has converged
+        for (j = 0; j < n; j++)
+        {
+            tanPhi[j] = zz[j] / r[j];
+            cosPhi[j] = 1.0 / sqrt(1.0 + tanPhi[j] * tanPhi[j]);
+            sinPhi[j] = tanPhi[j] * cosPhi[j];
+            nq[j]     = ABES / sqrt(1.0 - gkEq * sinPhi[j] * sinPhi[j]);
+        }
+
+        do
+        {
+            iterate = 0;
+            for (j = 0; j < n; j++)
+            {
+                tOld      = tanPhi[j];
+                t         = (zz[j] + gkEq * nq[j] * sinPhi[j]) / r[j];
+                tanPhi[j] = t;
+                cosPhi[j] = 1.0 / sqrt(1.0 + t * t);
+                sinPhi[j] = t * cosPhi[j];
+                nq[j]     = ABES / sqrt(1.0 - gkEq * sinPhi[j] * sinPhi[j]);
+                iterate  |= (fabs(t - tOld) > 10E-10 * (1.0 + t * t));
+            }
+        }
+        while (iterate);
+
+        for (j = 0; j < n; j++)
+        {
+            phi[j]  = atan(tanPhi[j]);
+            zone[j] = round((lambda[j] * 180.0 / M_PI) / 3.0);
+            l[j]    = lambda[j] - 3.0 * zone[j] * M_PI / 180.0;
+        }
+
+        // Gauss-Krueger series
+        for (j = 0; j < n; j++)
+        {
+            t    = tanPhi[j];
+            t2   = t * t;
+            c    = cosPhi[j];
+            s    = sinPhi[j];
+            eta2 = gkEst * gkEst * c * c;
+
+            a1   = nq[j] * c;
+            a2   = (1.0 /   2.0) * t * nq[j] * c * c;
+            a3   = (1.0 /   6.0) * nq[j] * c * c * c * (1.0 - t2 + eta2);
+            a4   = (1.0 /  24.0) * nq[j] * s * c * c * c * (5.0 - t2 + 9.0 * eta2 +
+                   4.0 * eta2 * eta2);
+            a5   = (1.0 / 120.0) * nq[j] * c * c * c * c * c * (5.0 - 18.0 * t2 + t2 * t2 +
+                   14.0 * eta2 - 58.0 * eta2 * t2 + 13.0 * eta2 * eta2 -
+                   64.0 * eta2 * eta2 * t2);
+
+            // multiple angles of the meridian arc
+            sin2 = 2.0 * s * c;
+            cos2 = c * c - s * s;
+            sin4 = 2.0 * sin2 * cos2;
+            cos4 = cos2 * cos2 - sin2 * sin2;
+            sin6 = sin4 * cos2 + cos4 * sin2;
+            gb   = (gkAlpha * phi[j] - gkBeta * sin2 + gkGamma * sin4 - gkDelta * sin6) * gkCbess;
+
+            l2          = l[j] * l[j];
+            northing[j] = (gb + l2 * (a2 + l2 * a4)) * 1000.0;
+            easting[j]  = (1000000.0 * zone[j] + 500000.0 +
+                           l[j] * (a1 + l2 * (a3 + l2 * a5))) * 1000.0;
+        }
+
+        for (j = 0; j < n; j++)
+        {
+            posGk[i + j].northing = northing[j];
+            posGk[i + j].easting  = easting[j];
+            posGk[i + j].altitude = (int)((r[j] / cosPhi[j] - nq[j]) * 1000.0);
+            posGk[i + j].heading  = posWgs84[i + j].heading;
+        }
+    }
+}
+
+void PositionTool::gkToWgs84(position_gk_data *posGk, position_wgs84_data *posWgs84, int num)
+{
+    int     i, j, n, iterate;
+    double  y[POSITION_TOOL_BLOCK_SIZE], l0[POSITION_TOOL_BLOCK_SIZE];
+    double  bf[POSITION_TOOL_BLOCK_SIZE];
+    double  s[POSITION_TOOL_BLOCK_SIZE], c[POSITION_TOOL_BLOCK_SIZE];
+    double  phi[POSITION_TOOL_BLOCK_SIZE], lambda[POSITION_TOOL_BLOCK_SIZE];
+    double  tanLat[POSITION_TOOL_BLOCK_SIZE];
+    double  sinLat[POSITION_TOOL_BLOCK_SIZE], cosLat[POSITION_TOOL_BLOCK_SIZE];
+    double  r[POSITION_TOOL_BLOCK_SIZE], zq[POSITION_TOOL_BLOCK_SIZE];
+    double  nq[POSITION_TOOL_BLOCK_SIZE], lon[POSITION_TOOL_BLOCK_SIZE];
+    double  easting, h;
+    double  sigma, sinSigma, cosSigma;
+    double  sin2, cos2, sin4, cos4, sin6;
+    double  sinPhi, cosPhi;
+    double  sinLambda, cosLambda;
+    double  xz, yz, zz;
+    double  xq, yq;
+    double  n0, t, tOld;
+    double  t2, y2, w;
+    double  nf, mf, eta2;
+    double  b1, b2, b3, b4, b5;
+
+    for (i = 0; i < num; i += n)
+    {
+        n = num - i;
+        if (n > POSITION_TOOL_BLOCK_SIZE)
+        {
+            n = POSITION_TOOL_BLOCK_SIZE;
+        }
+
+        for (j = 0; j < n; j++)
+        {
+            // meridian with the smallest distance, like the search of the
+            // single conversion
+            easting = posGk[i + j].easting / 1000.0;
+            l0[j]   = floor(3.0 * (easting - 500000.0) / 1000000.0 + 0.5);
+            if (l0[j] < 0.0)
+            {
+                l0[j] = 0.0;
+            }
+            l0[j] = l0[j] * M_PI / 180.0;
+            y[j]  = easting - 500000.0 - 1000000 * l0[j] * (180.0 / M_PI) / 3.0;
+
+            // footpoint latitude
+            sigma = posGk[i + j].northing / 1000.0 / gkGrd;
+            sincos(sigma, &sinSigma, &cosSigma);
+            sin2  = 2.0 * sinSigma * cosSigma;
+            cos2  = cosSigma * cosSigma - sinSigma * sinSigma;
+            sin4  = 2.0 * sin2 * cos2;
+            cos4  = cos2 * cos2 - sin2 * sin2;
+            sin6  = sin4 * cos2 + cos4 * sin2;
+            bf[j] = sigma + (3.0 / 2.0) * (gkI - (9.0 / 16.0) * gkI * gkI * gkI) * sin2 +
+                    (21.0 / 16.0) * gkI * gkI * sin4 + (151.0 / 96.0) * gkI * gkI * gkI * sin6;
+
+            sincos(bf[j], &s[j], &c[j]);
+        }
+
+        // Gauss-Krueger series
+        for (j = 0; j < n; j++)
+        {
+            t    = s[j] / c[j];
+            t2   = t * t;
+            w    = 1.0 - gkEq * s[j] * s[j];
+            nf   = ABES / sqrt(w);
+            mf   = (ABES * (1.0 - gkEq)) / (w * sqrt(w));
+            eta2 = gkEst * gkEst * c[j] * c[j];
+
+            b1   =  1.0 / (nf * c[j]);
+            b2   = -t / (2.0 * mf * nf);
+            b3   = -(1.0 + 2.0 * t2 + eta2) / (6.0 * nf * nf * nf * c[j]);
+            b4   =  (t / (24.0 * mf * nf * nf * nf)) * (5.0 + 3.0 * t2 + eta2 - 9.0 * eta2 * t2 -
+                                                       4.0 * eta2 * eta2);
+            b5   =  (1.0 / (120.0 * nf * nf * nf * nf * nf * c[j])) * (28.0 * t2 + 24.0 * t2 * t2 +
+                                                                     6.0 * eta2 + 8.0 * eta2 * t2);
+
+            y2        = y[j] * y[j];
+            phi[j]    = bf[j] + y2 * (b2 + y2 * b4);
+            lambda[j] = y[j] * (b1 + y2 * (b3 + y2 * b5)) + l0[j];
+        }
+
+        for (j = 0; j < n; j++)
+        {
+            h = posGk[i + j].altitude / 1000.0;
+
+            // geocentric cartesian coordinates in Potsdam-Date
+            sincos(phi[j], &sinPhi, &cosPhi);
+            sincos(lambda[j], &sinLambda, &cosLambda);
+            n0 = ABES / sqrt(1.0 - gkEq * sinPhi * sinPhi);
+            xz = (n0 + h)   * cosPhi * cosLambda;
+            yz = (n0 + h)   * cosPhi * sinLambda;
+            zz = ((1.0 - gkEq) * n0 + h) * sinPhi;
+
+            // inverse helmert transformation
+            xz    = xz - HELM_DX;
+            yz    = yz - HELM_DY;
+            zz    = zz - HELM_DZ;
+            xq    = (       1.0 * xz - HELM_ROTZ * yz + HELM_ROTY * zz) / HELM_SC;
+            yq    = ( HELM_ROTZ * xz +       1.0 * yz - HELM_ROTX * zz) / HELM_SC;
+            zq[j] = (-HELM_ROTY * xz + HELM_ROTX * yz +       1.0 * zz) / HELM_SC;
+
+            lon[j] = atan2(yq, xq);
+            r[j]   = sqrt(xq * xq + yq * yq);
+        }
+
+        // elliptic coordinates in wgs84 ellipsoid, iteration on the tangent
+        // of the latitude like in wgs84ToGk()
+        for (j = 0; j < n; j++)
+        {
+            tanLat[j] = zq[j] / r[j];
+            cosLat[j] = 1.0 / sqrt(1.0 + tanLat[j] * tanLat[j]);
+            sinLat[j] = tanLat[j] * cosLat[j];
+            nq[j]     = AWGS / sqrt(1.0 - wgsEq * sinLat[j] * sinLat[j]);
+        }
+
+        do
+        {
+            iterate = 0;
+            for (j = 0; j < n; j++)
+            {
+                tOld      = tanLat[j];
+                t         = (zq[j] + wgsEq * nq[j] * sinLat[j]) / r[j];
+                tanLat[j] = t;
+                cosLat[j] = 1.0 / sqrt(1.0 + t * t);
+                sinLat[j] = t * cosLat[j];
+                nq[j]     = AWGS / sqrt(1.0 - wgsEq * sinLat[j] * sinLat[j]);
+                iterate  |= (fabs(t - tOld) > 10E-10 * (1.0 + t * t));
+            }
+        }
+        while (iterate);
+
+        for (j = 0; j < n; j++)
+        {
+            posWgs84[i + j].latitude  = atan(tanLat[j]);
+            posWgs84[i + j].longitude = lon[j];
+            posWgs84[i + j].altitude  = (int)rint((r[j] / cosLat[j] - nq[j]) * 1000.0);
+            posWgs84[i + j].heading   = posGk[i + j].heading;
+        }
+    }
+}
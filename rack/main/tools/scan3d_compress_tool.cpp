@@ -53,25 +53,63 @@
 
 #include <main/scan3d_compress_tool.h>
 
+#include <errno.h>
 #include <math.h>
+#include <stdio.h>
 #include <string.h>
 
 
 Scan3dCompressTool::Scan3dCompressTool() {
     gdos = NULL;
     input = NULL;
+    s3d_buf = NULL;
+    pbuf1 = NULL;
+    blockBuf = NULL;
+    uncomprBuf = NULL;
+    uncomprBufSize = 0;
+    blockJobMbx = NULL;
+    blockDoneMbx = NULL;
+    blockWorkerNum = 0;
+    setMaxPointNum(SCAN3D_POINT_MAX);
 }
 
 Scan3dCompressTool::Scan3dCompressTool(RackMailbox * p_mbx, int32_t gdos_level, RackTime *rt) {
     gdos = new RackGdos(p_mbx, gdos_level);
     input = NULL;
+    s3d_buf = NULL;
+    pbuf1 = NULL;
+    blockBuf = NULL;
+    uncomprBuf = NULL;
+    uncomprBufSize = 0;
+    blockJobMbx = NULL;
+    blockDoneMbx = NULL;
+    blockWorkerNum = 0;
     compr_Tool.rackTime = rt;
+    setMaxPointNum(SCAN3D_POINT_MAX);
 }
 
 Scan3dCompressTool::~Scan3dCompressTool() {
+    cleanupBlocks();
+    if (uncomprBuf) delete[] uncomprBuf;
+    if (s3d_buf) delete[] s3d_buf;
+    if (pbuf1) delete[] pbuf1;
     if (gdos) delete gdos;
 }
 
+//----- (re)allocates the buffers for scans up to [pointNum] points
+int Scan3dCompressTool::setMaxPointNum(uint32_t pointNum) {
+    if (s3d_buf) delete[] s3d_buf;
+    if (pbuf1) delete[] pbuf1;
+    maxPointNum = pointNum;
+    s3d_buf     = new scanPoint[pointNum];
+    pbuf1       = new uint8_t[(uint32_t)(pointNum*sizeof(scan_point)*1.1)];
+    if (!s3d_buf || !pbuf1) {
+        maxPointNum = 0;
+        return -ENOMEM;
+    }
+    return compr_Tool.compr_setMaxInputSize((uint32_t)(pointNum*sizeof(scan_point)*1.1));
+}
+
 //----- ----------------------------------------------------------------------------------------------------
 //----- main compression function
 //----- ----------------------------------------------------------------------------------------------------
@@ -83,17 +121,24 @@ uint32_t Scan3dCompressTool::Compress(scan3d_data *s3d_in_out, uint32_t flags_s1
         return 0;
     }
 
-    //----- some preparations for compression
-    s3d_buf = (scanPoint*)&s3d_buf1;
-    pbuf1   = (uint8_t*)&buf1;
+    s3d_in_out->compressed = CompressPoints(s3d_in_out->point, s3d_in_out->pointNum,
+                                            (uint8_t*)s3d_in_out->point, s3d_in_out,
+                                            flags_s1, flags_s2, flags_s3);
+    return s3d_in_out->compressed;
+}
 
-    inputHeader      = s3d_in_out;
-    uint32_t lenIn   = s3d_in_out->pointNum * sizeof(scan_point);
-    uint32_t nPoints = s3d_in_out->pointNum;
+//----- compresses [nPoints] points of [in] into [out], in and out may be the same array.
+//----- The scan [header] is needed for COMPR_S1_REMOVE_INVALID.
+uint32_t Scan3dCompressTool::CompressPoints(scan_point *in, uint32_t nPoints, uint8_t *out, scan3d_data *header,
+                                            uint32_t flags_s1, uint32_t flags_s2, uint32_t flags_s3) {
+    //----- some preparations for compression
+    inputHeader      = header;
+    uint32_t nInput  = nPoints;
+    uint32_t lenIn   = nPoints * sizeof(scan_point);
     compr_Tool.compr_writeStatistics(0, lenIn);
-    uint8_t *pOut    = (uint8_t*)s3d_in_out->point;
+    uint8_t *pOut    = out;
     uint8_t *pIn     = (uint8_t*)s3d_buf;
-    memcpy(pIn, pOut, lenIn);
+    memcpy(pIn, in, lenIn);
 
     input = s3d_buf;
 
@@ -131,7 +176,7 @@ uint32_t Scan3dCompressTool::Compress(scan3d_data *s3d_in_out, uint32_t flags_s1
         inStream1a.aByte  = 0;
         inStream1a.aBit   = 0;
         compr_step1_reduceBytesPerSymbol222110(&outStream1a, nPoints);
-        compr_step1_resortBytesByColumns(&inStream1a, &outStream1, 8, s3d_in_out->pointNum);
+        compr_step1_resortBytesByColumns(&inStream1a, &outStream1, 8, nInput);
         break;
     case COMPR_S1_REDUCE_BITS:
         compr_step1_searchMinMaxValues(nPoints);
@@ -139,7 +184,7 @@ uint32_t Scan3dCompressTool::Compress(scan3d_data *s3d_in_out, uint32_t flags_s1
         break;
     case COMPR_S1_DELTA_RLE:
         compr_step1_searchMinMaxValues(nPoints);
-        compr_step1_delta_rle(&outStream1, s3d_in_out->pointNum);
+        compr_step1_delta_rle(&outStream1, nInput);
         break;
     case COMPR_S1_NONE:
         for (uint32_t i=0; i<nPoints; i++) {
@@ -170,8 +215,6 @@ uint32_t Scan3dCompressTool::Compress(scan3d_data *s3d_in_out, uint32_t flags_s1
     }
 
     //----- closing operations of step 1-3
-    inputHeader->compressed = compr_Tool.stats.s_step3;
-
     //----- amend header
     outStream1.aByte = 10; outStream1.aBit = 0;
     compr_Tool.compr_writeByteStream(&outStream1, compr_Tool.stats.s_step3, sizeof(compr_Tool.stats.s_step3));
@@ -184,6 +227,233 @@ uint32_t Scan3dCompressTool::Compress(scan3d_data *s3d_in_out, uint32_t flags_s1
     return compr_Tool.stats.s_step3;
 }
 
+//----- ----------------------------------------------------------------------------------------------------
+//----- chunked compression
+//----- The points are split into blocks which are compressed independently by the
+//----- calling task and a pool of worker tasks. Every worker has its own
+//----- Scan3dCompressTool with buffers for one block only.
+//----- The workers block on the job mailbox until CompressBlocks() sends them
+//----- a job message and reply with a done message to the done mailbox.
+//----- ----------------------------------------------------------------------------------------------------
+
+void compr_block_task_proc(void *arg) {
+    compr_blockWorker  *p_worker = (compr_blockWorker*)arg;
+    Scan3dCompressTool *p_tool   = p_worker->tool;
+    RackMessage        msgInfo;
+
+    while (1) {
+        if (p_tool->blockJobMbx->recvMsg(&msgInfo))
+            return;
+        if (msgInfo.getType() == COMPR_BLOCK_MSG_STOP)
+            return;
+
+        p_tool->compr_blocks_process(p_worker->index);
+        p_tool->blockJobMbx->sendMsg(COMPR_BLOCK_MSG_DONE, p_tool->blockDoneMbx->getAdr(), 0);
+    }
+}
+
+//----- creates [workerNum] worker tasks for blocks of [pointNum] points,
+//----- [jobMbx] and [doneMbx] need [workerNum] slots for messages without data
+int Scan3dCompressTool::initBlocks(uint32_t pointNum, uint32_t workerNum, int prio,
+                                   RackMailbox *jobMbx, RackMailbox *doneMbx) {
+    char     taskName[30];
+    uint32_t i;
+    int      ret;
+
+    cleanupBlocks();
+
+    if (pointNum == 0) pointNum = COMPR_BLOCK_POINT_NUM;
+    if (workerNum > COMPR_BLOCK_WORKER_NUM_MAX) workerNum = COMPR_BLOCK_WORKER_NUM_MAX;
+    if ((workerNum > 0) && (!jobMbx || !doneMbx))
+        return -EINVAL;
+
+    blockPointNum  = pointNum;
+    blockBufSize   = (uint32_t)((maxPointNum + pointNum)*sizeof(scan_point)*1.1) + COMPR_BLOCK_NUM_MAX*64;
+    blockBuf       = new uint8_t[blockBufSize];
+    if (!blockBuf)
+        return -ENOMEM;
+
+    blockJobMbx    = jobMbx;
+    blockDoneMbx   = doneMbx;
+    blockNum       = 0;
+    blockNext      = 0;
+    if (workerNum > 0) {
+        jobMbx->clean();
+        doneMbx->clean();
+    }
+
+    ret = blockMtx.create();
+    if (ret) {
+        delete[] blockBuf;
+        blockBuf = NULL;
+        return ret;
+    }
+
+    blockTool[0]         = this;
+    blockWorker[0].tool  = this;
+    blockWorker[0].index = 0;
+
+    for (i = 1; i <= workerNum; i++) {
+        blockTool[i] = new Scan3dCompressTool();
+        if (!blockTool[i])
+            break;
+        blockTool[i]->compr_Tool.rackTime = compr_Tool.rackTime;
+        if (blockTool[i]->setMaxPointNum(pointNum)) {
+            delete blockTool[i];
+            break;
+        }
+
+        blockWorker[i].tool  = this;
+        blockWorker[i].index = i;
+
+        snprintf(taskName, sizeof(taskName), "compr%p_%d", (void*)this, i);
+        ret = blockTask[i-1].create(taskName, 0, prio, RACK_TASK_FPU | RACK_TASK_JOINABLE);
+        if (!ret) {
+            ret = blockTask[i-1].start(&compr_block_task_proc, &blockWorker[i]);
+            if (ret) blockTask[i-1].destroy();
+        }
+        if (ret) {
+            delete blockTool[i];
+            break;
+        }
+    }
+    blockWorkerNum = i - 1;
+
+    if (blockWorkerNum < workerNum) {
+        GDOS_WARNING("Can't create all compression workers, using %d of %d\n", blockWorkerNum, workerNum);
+    }
+    return 0;
+}
+
+//----- stops the worker tasks
+void Scan3dCompressTool::cleanupBlocks() {
+    if (!blockBuf)
+        return;
+
+    for (uint32_t i = 1; i <= blockWorkerNum; i++)
+        blockDoneMbx->sendMsg(COMPR_BLOCK_MSG_STOP, blockJobMbx->getAdr(), 0);
+    for (uint32_t i = 1; i <= blockWorkerNum; i++) {
+        blockTask[i-1].join();
+        blockTask[i-1].destroy();
+        delete blockTool[i];
+    }
+    blockWorkerNum = 0;
+    blockMtx.destroy();
+
+    delete[] blockBuf;
+    blockBuf = NULL;
+}
+
+//----- compresses blocks of the actual job until all blocks are taken
+void Scan3dCompressTool::compr_blocks_process(uint32_t index) {
+    uint32_t block, n;
+
+    while (1) {
+        blockMtx.lock(RACK_INFINITE);
+        if (blockNext >= blockNum) {
+            blockMtx.unlock();
+            return;
+        }
+        block = blockNext++;
+        blockMtx.unlock();
+
+        n = blockJobPointNum;
+        if (block == blockNum - 1)
+            n = blockInput->pointNum - block * blockJobPointNum;
+
+        blockSize[block] = blockTool[index]->CompressPoints(&blockInput->point[block * blockJobPointNum], n,
+                                                            &blockBuf[block * blockSlotSize],
+                                                            blockInput, blockFlags_s1, blockFlags_s2, blockFlags_s3);
+    }
+}
+
+//----- Compresses the scan in blocks of blockPointNum points (see initBlocks).
+//----- Scans that fit into one block and tools without initBlocks() are
+//----- compressed by Compress(). Returns 0 and leaves the scan uncompressed,
+//----- if the compressed blocks are not smaller than the input.
+uint32_t Scan3dCompressTool::CompressBlocks(scan3d_data *s3d_in_out, uint32_t flags_s1, uint32_t flags_s2, uint32_t flags_s3) {
+    RackMessage msgInfo;
+    uint32_t    i, n, num, pos, lenIn, jobs;
+
+    // return if no compression needed
+    if ((flags_s1 == COMPR_S1_NONE) && (flags_s2 == COMPR_S2_NONE)
+        && (flags_s3 == COMPR_S3_NONE))
+    {
+        return 0;
+    }
+
+    if (!blockBuf || (s3d_in_out->pointNum <= (int32_t)blockPointNum))
+        return Compress(s3d_in_out, flags_s1, flags_s2, flags_s3);
+
+    //----- blocks contain complete scanlines for COMPR_S1_REMOVE_INVALID
+    n = blockPointNum;
+    if ((s3d_in_out->scanPointNum > 0) && ((uint32_t)s3d_in_out->scanPointNum <= n))
+        n -= n % s3d_in_out->scanPointNum;
+    num = (s3d_in_out->pointNum + n - 1) / n;
+
+    if ((num > COMPR_BLOCK_NUM_MAX) || (s3d_in_out->pointNum > (int32_t)maxPointNum)
+        || (num * ((uint32_t)(n*sizeof(scan_point)*1.1) + 64) > blockBufSize)) {
+        GDOS_WARNING("Can't split scan into blocks (%d points), compressing serially\n", s3d_in_out->pointNum);
+        return Compress(s3d_in_out, flags_s1, flags_s2, flags_s3);
+    }
+
+    //----- start job, the calling task compresses blocks as well
+    blockMtx.lock(RACK_INFINITE);
+    blockInput       = s3d_in_out;
+    blockFlags_s1    = flags_s1;
+    blockFlags_s2    = flags_s2;
+    blockFlags_s3    = flags_s3;
+    blockJobPointNum = n;
+    blockSlotSize    = (uint32_t)(n*sizeof(scan_point)*1.1) + 64;
+    blockNext        = 0;
+    blockNum         = num;
+    blockMtx.unlock();
+
+    for (jobs = 0; jobs < blockWorkerNum; jobs++) {
+        if (blockDoneMbx->sendMsg(COMPR_BLOCK_MSG_JOB, blockJobMbx->getAdr(), 0))
+            break;
+    }
+
+    compr_blocks_process(0);
+
+    //----- a worker replies after the last block it has taken
+    for (i = 0; i < jobs; i++) {
+        if (blockDoneMbx->recvMsg(&msgInfo)) {
+            GDOS_ERROR("Can't receive the reply of a compression worker\n");
+            s3d_in_out->compressed = 0;
+            return 0;
+        }
+    }
+
+    //----- check size
+    lenIn = s3d_in_out->pointNum * sizeof(scan_point);
+    pos   = 10 + num * 4;
+    for (i = 0; i < num; i++)
+        pos += blockSize[i];
+    if (pos >= lenIn) {
+        s3d_in_out->compressed = 0;
+        return 0;
+    }
+
+    //----- write header and blocks
+    compr_bitStream outStream;
+    outStream.data  = (uint8_t*)s3d_in_out->point;
+    outStream.aByte = 0;
+    outStream.aBit  = 0;
+    compr_Tool.compr_writeByteStream(&outStream, COMPR_BLOCK_MAGIC, 2);
+    compr_Tool.compr_writeByteStream(&outStream, num, 4);
+    compr_Tool.compr_writeByteStream(&outStream, n, 4);
+    for (i = 0; i < num; i++)
+        compr_Tool.compr_writeByteStream(&outStream, blockSize[i], 4);
+    for (i = 0; i < num; i++) {
+        memcpy(&outStream.data[outStream.aByte], &blockBuf[i * blockSlotSize], blockSize[i]);
+        outStream.aByte += blockSize[i];
+    }
+
+    s3d_in_out->compressed = outStream.aByte;
+    return s3d_in_out->compressed;
+}
+
 //----- ----------------------------------------------------------------------------------------------------
 //----- decompression functions step 1
 //----- ----------------------------------------------------------------------------------------------------
@@ -476,11 +746,25 @@ uint32_t Scan3dCompressTool::Decompress(scan3d_data *s3d_in_out) {
         return 0;
     }
 
-    //----- some preparations for decompression
-    s3d_buf         = (scanPoint*)&s3d_buf1;
-    output          = (scanPoint*)s3d_in_out->point;
     outputHeader    = s3d_in_out;
-    uint8_t *pOut   = (uint8_t*)s3d_in_out->point;
+    uint8_t *pData  = (uint8_t*)s3d_in_out->point;
+
+    //----- chunked compression
+    if ((pData[0] == 'M') && (pData[1] == 'B'))
+        return DecompressBlocks(s3d_in_out);
+
+    if (DecompressPoints(s3d_in_out->point, s3d_in_out->pointNum))
+        return 1;
+
+    outputHeader->compressed = 0;
+    return 0;
+}
+
+//----- decompresses the points of one compressed stream in place
+uint32_t Scan3dCompressTool::DecompressPoints(scan_point *in_out, uint32_t nInput) {
+    //----- some preparations for decompression
+    output          = (scanPoint*)in_out;
+    uint8_t *pOut   = (uint8_t*)in_out;
     uint8_t *pIn    = (uint8_t*)s3d_buf;
 
     //----- prepare input stream
@@ -511,8 +795,6 @@ uint32_t Scan3dCompressTool::Decompress(scan3d_data *s3d_in_out) {
     memcpy(pIn, pOut, lenIn);
     inStream1.data     = pIn;
 
-    pbuf1   = (uint8_t*)&buf1;
-
     //----- execute decompression functions of step 1
     switch (flags_s1 & 0x000000FF) {
     case COMPR_S1_REDUCE_BYTES:
@@ -526,7 +808,7 @@ uint32_t Scan3dCompressTool::Decompress(scan3d_data *s3d_in_out) {
         inStream1a.data  = pbuf1;
         inStream1a.aByte = 0;
         inStream1a.aBit  = 0;
-        uncompr_step1_resortBytesByColumns(&inStream1, &inStream1a, s3d_in_out->pointNum, 8);
+        uncompr_step1_resortBytesByColumns(&inStream1, &inStream1a, nInput, 8);
         inStream1a.aByte = 0;
         inStream1a.aBit  = 0;
         uncompr_step1_reduceBytesPerSymbol222110(&inStream1a, nPoints);
@@ -535,7 +817,7 @@ uint32_t Scan3dCompressTool::Decompress(scan3d_data *s3d_in_out) {
         aLen = uncompr_step1_reduceBitsPerSymbol(&inStream1, nPoints);
         break;
     case COMPR_S1_DELTA_RLE:
-        uncompr_step1_delta_rle(&inStream1, s3d_in_out->pointNum);
+        uncompr_step1_delta_rle(&inStream1, nInput);
         break;
     case COMPR_S1_NONE:
         for (uint32_t i=0; i<lenOut/20; i++) {
@@ -551,7 +833,6 @@ uint32_t Scan3dCompressTool::Decompress(scan3d_data *s3d_in_out) {
     if ((flags_s1 & 0xFF000000) == COMPR_S1_REMOVE_INVALID)
         uncompr_step1_remove_invalid(lenIn/sizeof(scanPoint), lenOut/sizeof(scanPoint));
 
-    outputHeader->compressed = 0;
     compr_Tool.uncompr_writeStatistics(0);
 #ifdef COMPR_DEBUG
 //  GDOS_PRINT(compr_Tool.uncompr_getStatisticsTable());
@@ -560,6 +841,59 @@ uint32_t Scan3dCompressTool::Decompress(scan3d_data *s3d_in_out) {
     return 0;
 }
 
+//----- decompresses a scan that was compressed by CompressBlocks(),
+//----- the blocks are decompressed one after another in place.
+uint32_t Scan3dCompressTool::DecompressBlocks(scan3d_data *s3d_in_out) {
+    uint32_t i, num, n, nPoints, size, pos;
+    uint8_t  *buf;
+
+    //----- the buffer of initBlocks() is used if available
+    buf = blockBuf;
+    if (!buf || (blockBufSize < (uint32_t)s3d_in_out->compressed)) {
+        if (uncomprBufSize < (uint32_t)s3d_in_out->compressed) {
+            if (uncomprBuf) delete[] uncomprBuf;
+            uncomprBufSize = s3d_in_out->compressed;
+            uncomprBuf     = new uint8_t[uncomprBufSize];
+            if (!uncomprBuf) {
+                uncomprBufSize = 0;
+                GDOS_PRINT("Fehler: Kein Speicher fuer die blockweise komprimierten Daten!\n");
+                return 1;
+            }
+        }
+        buf = uncomprBuf;
+    }
+
+    memcpy(buf, s3d_in_out->point, s3d_in_out->compressed);
+
+    compr_bitStream inStream;
+    inStream.data  = buf;
+    inStream.aByte = 0;
+    inStream.aBit  = 0;
+
+    //----- evaluate header: Magic value
+    if (compr_Tool.compr_readByteStream(&inStream, 2) != COMPR_BLOCK_MAGIC) {
+        GDOS_PRINT("Fehler: Die blockweise komprimierten Daten haben keinen gueltigen Header!\n");
+        return 1;
+    }
+    num = compr_Tool.compr_readByteStream(&inStream, 4);
+    n   = compr_Tool.compr_readByteStream(&inStream, 4);
+    pos = 10 + num * 4;
+
+    //----- blocks are expanded in ascending order, so the expansion of one block
+    //----- only overwrites blocks that are copied afterwards
+    for (i = 0; i < num; i++) {
+        size    = compr_Tool.compr_readByteStream(&inStream, 4);
+        nPoints = (i == num - 1) ? s3d_in_out->pointNum - i * n : n;
+        memcpy(&s3d_in_out->point[i * n], &buf[pos], size);
+        if (DecompressPoints(&s3d_in_out->point[i * n], nPoints))
+            return 1;
+        pos    += size;
+    }
+
+    s3d_in_out->compressed = 0;
+    return 0;
+}
+
 //----- ----------------------------------------------------------------------------------------------------
 //----- decompression functions step 1
 //----- ----------------------------------------------------------------------------------------------------
@@ -763,5 +1097,12 @@ uint32_t Scan3dCompressTool::uncompr_step1_remove_invalid(uint32_t nIn, uint32_t
 10  4   length compressed
 14  ?   compressed data
 
+//----- header of chunked compression (CompressBlocks)
+00  2   magic value (0x4D42, "MB")
+02  4   number of blocks (n)
+06  4   points per block, the last block contains the remaining points
+10  4*n compressed length of each block
+..  ?   compressed blocks, each with the headers of steps 1 to 3
+
 
 */
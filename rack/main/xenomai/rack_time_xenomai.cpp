@@ -28,7 +28,7 @@ RackTime::RackTime()
     tims_fd = -1;
 }
 
-int RackTime::init(int tims_fd)
+int RackTime::init(int tims_fd, uint32_t system_id)
 {
     int err;
     int64_t offset;
@@ -95,3 +95,14 @@ int64_t RackTime::getOffset(void)
 
     return offset;
 }
+
+uint64_t RackTime::getLocalNano(void)
+{
+    return rt_timer_read();
+}
+
+int RackTime::adjustOffset(int64_t offset, int64_t drift, int64_t slew_rate)
+{
+    // the global clock is synchronised by TIMS
+    return -EOPNOTSUPP;
+}
@@ -27,6 +27,7 @@
 SerialPort::SerialPort()
 {
     fd = -1;
+    baudrate = 0;
 }
 
 SerialPort::~SerialPort()
@@ -177,6 +178,35 @@ int SerialPort::recv(void *data, int dataLen, rack_time_t *timestamp,
     return recv(data, dataLen, timestamp);
 }
 
+int SerialPort::recvAvailable(void *data, int dataMaxLen, int *dataLen,
+                              rack_time_t *timestamp)
+{
+    int ret;
+    int len;
+    rtser_event_t rx_event;
+
+    ret = rt_dev_ioctl(fd, RTSER_RTIOC_WAIT_EVENT, &rx_event);
+    if (ret)
+        return ret;
+
+    if (timestamp)
+        *timestamp = module->rackTime.fromNano(rx_event.rxpend_timestamp);
+
+    len = rx_event.rx_pending;
+    if (len < 1)
+        len = 1;
+    if (len > dataMaxLen)
+        len = dataMaxLen;
+
+    ret = rt_dev_read(fd, data, len);
+    if (ret < 0)
+        return ret;
+
+    *dataLen = ret;
+
+    return 0;
+}
+
 int SerialPort::waitEvent(struct rtser_event *event)
 {
     return rt_dev_ioctl(fd, RTSER_RTIOC_WAIT_EVENT, event);
@@ -29,6 +29,8 @@ public class GridMapDataMsg extends TimsMsg
 	public int scale		   = 0;
 	public int gridNumX  	   = 0;
 	public int gridNumY   	   = 0;
+	public int mapNum		   = 0;
+	public int baseNum		   = 0;
 	public byte[] occupancy    = new byte[0];
 
 	public int[]  occupancyRGB = new int[0];
@@ -36,7 +38,7 @@ public class GridMapDataMsg extends TimsMsg
 
     public int getDataLen()
     {
-        return (24 + gridNumX * gridNumY);
+        return (32 + gridNumX * gridNumY);
     }
 
     public GridMapDataMsg()
@@ -82,6 +84,8 @@ public class GridMapDataMsg extends TimsMsg
 		scale		    = dataIn.readInt();
 		gridNumY  	    = dataIn.readInt();		// exchange gridNumX and gridNumY
 		gridNumX   	    = dataIn.readInt();		// for gridMap flip
+		mapNum		    = dataIn.readInt();
+		baseNum		    = dataIn.readInt();
 		gridNumMax      = gridNumX * gridNumY;
 
 		if(occupancy.length != gridNumMax)
@@ -122,6 +126,8 @@ public class GridMapDataMsg extends TimsMsg
 		dataOut.writeInt(scale);
 		dataOut.writeInt(gridNumX);
 		dataOut.writeInt(gridNumY);
+		dataOut.writeInt(mapNum);
+		dataOut.writeInt(baseNum);
 		gridNumMax = gridNumX * gridNumY;
 
 		for(int i = 0; i < gridNumMax; i++)
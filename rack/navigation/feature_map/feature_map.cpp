@@ -0,0 +1,762 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Matthias Hentschel <hentschel@rts.uni-hannover.de>
+ */
+
+#include "feature_map.h"
+
+#include <math.h>
+
+//
+// data structures
+//
+
+// external module parameter
+arg_table_t argTab[] = {
+
+    { ARGOPT_OPT, "positionSys", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The system number of the position module, default 0", { 0 } },
+
+    { ARGOPT_OPT, "positionInst", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The instance number of the position module, default 0", { 0 } },
+
+    { ARGOPT_OPT, "featureMax", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Initial number of map features, the map grows beyond it, default 100000", { 100000 } },
+
+    { ARGOPT_OPT, "mapFile", ARGOPT_REQVAL, ARGOPT_VAL_STR,
+      "filename of the DXF map to load", { 0 } },
+
+    { ARGOPT_OPT, "mapScaleFactor", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "map scale factor", { 1000 } },
+
+    { ARGOPT_OPT, "mapOffsetX", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "mapOffsetX for DXF maps in GK coordinates", { 0 } },
+
+    { ARGOPT_OPT, "mapOffsetY", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "mapOffsetY for DXF maps in GK coordinates", { 0 } },
+
+    { ARGOPT_OPT, "indexScale", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Cell size of the feature index in mm, default 2000 mm", { 2000 } },
+
+    { ARGOPT_OPT, "range", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Range of the published features around the robot in mm, 0 = whole map, "
+      "default 20000 mm", { 20000 } },
+
+    { ARGOPT_OPT, "periodTime", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "1 / sampling rate in ms, default 500", { 500 } },
+
+    { 0, "", 0, 0, "", { 0 } } // last entry
+};
+
+/*******************************************************************************
+ *   !!! REALTIME CONTEXT !!!
+ *
+ *   moduleOn,
+ *   moduleOff,
+ *   moduleLoop,
+ *   moduleCommand,
+ *
+ *   own realtime user functions
+ ******************************************************************************/
+ int  FeatureMap::moduleOn(void)
+{
+    int ret;
+
+    // get dynamic module parameter
+    mapFile              = getStringParam("mapFile");
+    mapScaleFactor       = getInt32Param("mapScaleFactor");
+    mapOffsetX           = getInt32Param("mapOffsetX");
+    mapOffsetY           = getInt32Param("mapOffsetY");
+    indexScale           = getInt32Param("indexScale");
+    range                = getInt32Param("range");
+    dataBufferPeriodTime = getInt32Param("periodTime");
+
+    // load map, changes of a loaded map are kept
+    if ((dxfMap->featureNum == 0) && mapFile)
+    {
+        ret = loadMap(mapFile);
+        if (ret)
+        {
+            return ret;
+        }
+    }
+
+    // turn on position module
+    ret = position->on();
+    if (ret)
+    {
+        GDOS_ERROR("Can't turn on Position(%d/%d), code = %d\n",
+                   positionSys, positionInst, ret);
+        return ret;
+    }
+
+    return RackDataModule::moduleOn(); // has to be last command in moduleOn();
+}
+
+
+void FeatureMap::moduleOff(void)
+{
+    RackDataModule::moduleOff();        // has to be first command in moduleOff();
+}
+
+
+// realtime context
+int  FeatureMap::moduleLoop(void)
+{
+    int                 i, num, ret;
+    feature_map_data*   featureMapData = NULL;
+
+    ret = position->getData(&positionData, sizeof(position_data), 0);
+    if (ret)
+    {
+        GDOS_ERROR("Can't get data from Position(%d/%d), code = %d\n",
+                   positionSys, positionInst, ret);
+        return ret;
+    }
+
+    // get datapointer from rackdatabuffer
+    featureMapData = (feature_map_data *)getDataBufferWorkSpace();
+
+    featureMapData->recordingTime = positionData.recordingTime;
+    memcpy(&featureMapData->pos, &positionData.pos, sizeof(position_3d));
+
+    mapMtx.lock(RACK_INFINITE);
+
+    // features around the robot, the index only returns the active layers
+    if (range > 0)
+    {
+        num = index.region(positionData.pos.x - range, positionData.pos.y - range,
+                           positionData.pos.x + range, positionData.pos.y + range,
+                           dataIndex, FEATURE_MAP_FEATURE_MAX);
+    }
+    else
+    {
+        num = index.region(-HUGE_VAL, -HUGE_VAL, HUGE_VAL, HUGE_VAL,
+                           dataIndex, FEATURE_MAP_FEATURE_MAX);
+    }
+
+    for (i = 0; i < num; i++)
+    {
+        copyFeature(&featureMapData->feature[i], &dxfMap->feature[dataIndex[i]]);
+    }
+    featureMapData->featureNum = num;
+    dataNum                    = num;
+
+    mapMtx.unlock();
+
+    GDOS_DBG_DETAIL("recordingTime %i, featureNum %i\n",
+                    featureMapData->recordingTime, featureMapData->featureNum);
+
+    putDataBufferWorkSpace(sizeof(feature_map_data) +
+                           featureMapData->featureNum * sizeof(feature_map_data_point));
+
+    sleepDataBufferPeriodTime();
+
+    return 0;
+}
+
+int  FeatureMap::moduleCommand(RackMessage *msgInfo)
+{
+    feature_map_filename        *pFilename;
+    feature_map_feature         *pFeature;
+    feature_map_layer_data      *pLayer;
+    feature_map_chunk_request   *pChunk;
+    feature_map_region_request  *pRegion;
+    feature_map_nearest_request *pNearest;
+    feature_map_nearest_data    nearestData;
+    feature_map_layer_data_msg  layerMsg;
+    char                        filename[129];
+    double                      dist;
+    int                         i, num, len, ret;
+
+    switch(msgInfo->getType())
+    {
+        case MSG_FEATURE_MAP_LOAD_MAP:
+        case MSG_FEATURE_MAP_SAVE_MAP:
+            pFilename = FeatureMapFilename::parse(msgInfo);
+
+            len = pFilename->filenameLen;
+            if ((len < 0) || (len > 128))
+                len = 128;
+            memcpy(filename, pFilename->filename, len);
+            filename[len] = 0;
+
+            if (msgInfo->getType() == MSG_FEATURE_MAP_LOAD_MAP)
+                ret = loadMap(filename);
+            else
+                ret = saveMap(filename);
+
+            cmdMbx.sendMsgReply(ret ? MSG_ERROR : MSG_OK, msgInfo);
+            break;
+
+        case MSG_FEATURE_MAP_ADD_LINE:
+            pFeature = FeatureMapFeature::parse(msgInfo);
+
+            ret = addLine(&pFeature->mapFeature);
+            cmdMbx.sendMsgReply(ret ? MSG_ERROR : MSG_OK, msgInfo);
+            break;
+
+        case MSG_FEATURE_MAP_DELETE_LINE:
+            pFeature = FeatureMapFeature::parse(msgInfo);
+
+            ret = deleteLine(pFeature->featureNumTemp);
+            cmdMbx.sendMsgReply(ret ? MSG_ERROR : MSG_OK, msgInfo);
+            break;
+
+        case MSG_FEATURE_MAP_DISPLACE_LINE:
+            pFeature = FeatureMapFeature::parse(msgInfo);
+
+            ret = displaceLine(pFeature->featureNumTemp, &pFeature->mapFeature);
+            cmdMbx.sendMsgReply(ret ? MSG_ERROR : MSG_OK, msgInfo);
+            break;
+
+        case MSG_FEATURE_MAP_GET_LAYER:
+            len = getLayer(&layerMsg);
+            cmdMbx.sendDataMsgReply(MSG_FEATURE_MAP_LAYER, msgInfo, 1, &layerMsg, len);
+            break;
+
+        case MSG_FEATURE_MAP_SET_LAYER:
+            pLayer = FeatureMapLayerData::parse(msgInfo);
+
+            mapMtx.lock(RACK_INFINITE);
+
+            layerNum = pLayer->layerNum;
+            if (layerNum > FEATURE_MAP_LAYER_MAX)
+                layerNum = FEATURE_MAP_LAYER_MAX;
+            if (layerNum < 0)
+                layerNum = 0;
+            for (i = 0; i < layerNum; i++)
+            {
+                layer[i] = pLayer->layer[i];
+            }
+            index.setLayer(layer, layerNum);
+
+            mapMtx.unlock();
+
+            cmdMbx.sendMsgReply(MSG_OK, msgInfo);
+            break;
+
+        case MSG_FEATURE_MAP_GIVE_MAP:
+            pChunk = FeatureMapChunkRequest::parse(msgInfo);
+
+            mapMtx.lock(RACK_INFINITE);
+
+            chunkMsg.data.featureTotal = dxfMap->featureNum;
+            chunkMsg.data.first        = pChunk->first;
+            chunkMsg.data.featureNum   = 0;
+
+            for (i = pChunk->first; (i >= 0) && (i < dxfMap->featureNum) &&
+                 (chunkMsg.data.featureNum < FEATURE_MAP_CHUNK_MAX); i++)
+            {
+                copyFeature(&chunkMsg.data.feature[chunkMsg.data.featureNum++],
+                            &dxfMap->feature[i]);
+            }
+
+            mapMtx.unlock();
+
+            cmdMbx.sendDataMsgReply(MSG_FEATURE_MAP_CHUNK, msgInfo, 1, &chunkMsg,
+                                    sizeof(feature_map_chunk_data) + chunkMsg.data.featureNum *
+                                    sizeof(feature_map_data_point));
+            break;
+
+        case MSG_FEATURE_MAP_GET_REGION:
+            pRegion = FeatureMapRegionRequest::parse(msgInfo);
+
+            mapMtx.lock(RACK_INFINITE);
+
+            num = index.region(pRegion->xMin, pRegion->yMin, pRegion->xMax, pRegion->yMax,
+                               result, resultMax);
+
+            chunkMsg.data.featureTotal = num;
+            chunkMsg.data.first        = pRegion->first;
+            chunkMsg.data.featureNum   = 0;
+
+            for (i = pRegion->first; (i >= 0) && (i < num) &&
+                 (chunkMsg.data.featureNum < FEATURE_MAP_CHUNK_MAX); i++)
+            {
+                copyFeature(&chunkMsg.data.feature[chunkMsg.data.featureNum++],
+                            &dxfMap->feature[result[i]]);
+            }
+
+            mapMtx.unlock();
+
+            cmdMbx.sendDataMsgReply(MSG_FEATURE_MAP_CHUNK, msgInfo, 1, &chunkMsg,
+                                    sizeof(feature_map_chunk_data) + chunkMsg.data.featureNum *
+                                    sizeof(feature_map_data_point));
+            break;
+
+        case MSG_FEATURE_MAP_GET_NEAREST:
+            pNearest = FeatureMapNearestRequest::parse(msgInfo);
+
+            mapMtx.lock(RACK_INFINITE);
+
+            memset(&nearestData, 0, sizeof(nearestData));
+            nearestData.index = index.nearest(pNearest->x, pNearest->y, pNearest->distMax, &dist);
+            if (nearestData.index >= 0)
+            {
+                nearestData.dist = (float)dist;
+                copyFeature(&nearestData.feature, &dxfMap->feature[nearestData.index]);
+            }
+
+            mapMtx.unlock();
+
+            cmdMbx.sendDataMsgReply(MSG_FEATURE_MAP_NEAREST, msgInfo, 1, &nearestData,
+                                    sizeof(feature_map_nearest_data));
+            break;
+
+        default:
+            // not for me -> ask RackDataModule
+            return RackDataModule::moduleCommand(msgInfo);
+      }
+      return 0;
+}
+
+// loads a DXF map and builds its index
+int  FeatureMap::loadMap(char *filename)
+{
+    int ret;
+
+    RackTask::disableRealtimeMode();
+
+    mapMtx.lock(RACK_INFINITE);
+
+    ret = dxfMap->load(filename, mapOffsetX, mapOffsetY, mapScaleFactor);
+    if (ret)
+    {
+        dxfMap->featureNum = 0;
+        GDOS_ERROR("Can't load DXF map %s, code = %d\n", filename, ret);
+    }
+
+    if (!ret)
+    {
+        ret = reserveResult(dxfMap->featureNum);
+        if (ret)
+        {
+            GDOS_ERROR("Can't allocate region result of %d features\n", dxfMap->featureNum);
+        }
+    }
+
+    if (!ret)
+    {
+        ret = index.build(dxfMap->feature, dxfMap->featureNum, indexScale);
+        if (ret)
+        {
+            GDOS_ERROR("Can't build feature index, code = %d\n", ret);
+        }
+    }
+    dataNum = 0;
+
+    mapMtx.unlock();
+    RackTask::enableRealtimeMode();
+
+    if (!ret)
+    {
+        GDOS_PRINT("Using DXF map %s with %d features, %d index cells\n",
+                   filename, dxfMap->featureNum, index.getCellNum());
+    }
+    return ret;
+}
+
+// the region result holds all features of the map, it grows like the
+// feature array of the DxfMap
+int  FeatureMap::reserveResult(int num)
+{
+    int *newResult;
+    int newMax;
+
+    if (num <= resultMax)
+    {
+        return 0;
+    }
+
+    newMax = resultMax;
+    while (newMax < num)
+    {
+        newMax = (newMax < 512) ? 1024 : 2 * newMax;
+    }
+
+    newResult = new int[newMax];
+    if (!newResult)
+    {
+        return -ENOMEM;
+    }
+
+    delete[] result;
+    result    = newResult;
+    resultMax = newMax;
+    return 0;
+}
+
+// saves the map as DXF file
+int  FeatureMap::saveMap(char *filename)
+{
+    int     i, ret;
+    double  x, y;
+
+    RackTask::disableRealtimeMode();
+
+    mapMtx.lock(RACK_INFINITE);
+
+    // DxfMap::save() converts the features in place, they are converted back
+    ret = dxfMap->save(filename, dxfMap->featureNum, mapScaleFactor);
+
+    for (i = 0; i < dxfMap->featureNum; i++)
+    {
+        x = dxfMap->feature[i].y * mapScaleFactor;
+        y = dxfMap->feature[i].x * mapScaleFactor;
+        dxfMap->feature[i].x = x;
+        dxfMap->feature[i].y = y;
+
+        x = dxfMap->feature[i].y2 * mapScaleFactor;
+        y = dxfMap->feature[i].x2 * mapScaleFactor;
+        dxfMap->feature[i].x2 = x;
+        dxfMap->feature[i].y2 = y;
+    }
+
+    mapMtx.unlock();
+    RackTask::enableRealtimeMode();
+
+    if (ret)
+    {
+        GDOS_ERROR("Can't save DXF map %s, code = %d\n", filename, ret);
+    }
+    return ret;
+}
+
+int  FeatureMap::addLine(feature_map_data_point *line)
+{
+    dxf_map_feature *f;
+    int             ret;
+
+    mapMtx.lock(RACK_INFINITE);
+
+    // the feature array and the region result grow with the map
+    f = dxfMap->newFeature();
+    if (!f || reserveResult(dxfMap->featureNum + 1))
+    {
+        mapMtx.unlock();
+        GDOS_ERROR("Can't add line, no memory for %d features\n", dxfMap->featureNum + 1);
+        return -ENOMEM;
+    }
+
+    setLine(f, line->x, line->y, line->x2, line->y2);
+    f->layer = line->layer;
+    dxfMap->featureNum++;
+
+    ret = index.build(dxfMap->feature, dxfMap->featureNum, indexScale);
+
+    mapMtx.unlock();
+    return ret;
+}
+
+// deletes a feature of the last data message
+int  FeatureMap::deleteLine(int dataNo)
+{
+    int i, ret;
+
+    mapMtx.lock(RACK_INFINITE);
+
+    if ((dataNo < 0) || (dataNo >= dataNum))
+    {
+        mapMtx.unlock();
+        return -EINVAL;
+    }
+
+    // the last feature takes its place
+    i = dataIndex[dataNo];
+    dxfMap->featureNum--;
+    memcpy(&dxfMap->feature[i], &dxfMap->feature[dxfMap->featureNum], sizeof(dxf_map_feature));
+
+    ret     = index.build(dxfMap->feature, dxfMap->featureNum, indexScale);
+    dataNum = 0;
+
+    mapMtx.unlock();
+    return ret;
+}
+
+// moves a feature of the last data message
+int  FeatureMap::displaceLine(int dataNo, feature_map_data_point *line)
+{
+    int ret;
+
+    mapMtx.lock(RACK_INFINITE);
+
+    if ((dataNo < 0) || (dataNo >= dataNum))
+    {
+        mapMtx.unlock();
+        return -EINVAL;
+    }
+
+    setLine(&dxfMap->feature[dataIndex[dataNo]], line->x, line->y, line->x2, line->y2);
+
+    ret = index.build(dxfMap->feature, dxfMap->featureNum, indexScale);
+
+    mapMtx.unlock();
+    return ret;
+}
+
+// collects the layers of the map, returns the message length
+int  FeatureMap::getLayer(feature_map_layer_data_msg *layerMsg)
+{
+    int i, j;
+
+    mapMtx.lock(RACK_INFINITE);
+
+    layerMsg->data.layerNum = 0;
+    for (i = 0; i < dxfMap->featureNum; i++)
+    {
+        for (j = 0; j < layerMsg->data.layerNum; j++)
+        {
+            if (layerMsg->layer[j] == dxfMap->feature[i].layer)
+                break;
+        }
+
+        if (j == layerMsg->data.layerNum)
+        {
+            if (layerMsg->data.layerNum >= FEATURE_MAP_LAYER_MAX)
+                break;
+            layerMsg->layer[layerMsg->data.layerNum++] = dxfMap->feature[i].layer;
+        }
+    }
+
+    mapMtx.unlock();
+
+    return sizeof(feature_map_layer_data) + layerMsg->data.layerNum * sizeof(int32_t);
+}
+
+void FeatureMap::setLine(dxf_map_feature *f, double x, double y, double x2, double y2)
+{
+    f->x  = x;
+    f->y  = y;
+    f->x2 = x2;
+    f->y2 = y2;
+    f->l  = sqrt((x2 - x) * (x2 - x) + (y2 - y) * (y2 - y));
+
+    if (f->l > 0.0)
+    {
+        f->rho = atan2(y2 - y, x2 - x);
+        f->sin = sin(f->rho);
+        f->cos = cos(f->rho);
+    }
+    else
+    {
+        f->rho = 0.0;
+        f->sin = 0.0;
+        f->cos = 1.0;
+    }
+}
+
+void FeatureMap::copyFeature(feature_map_data_point *point, dxf_map_feature *f)
+{
+    point->x     = f->x;
+    point->y     = f->y;
+    point->x2    = f->x2;
+    point->y2    = f->y2;
+    point->l     = f->l;
+    point->rho   = f->rho;
+    point->sin   = f->sin;
+    point->cos   = f->cos;
+    point->layer = f->layer;
+    point->type  = FEATURE_MAP_TYPE_LINE_FEATURE;
+}
+
+/*******************************************************************************
+ *   !!! NON REALTIME CONTEXT !!!
+ *
+ *   moduleInit,
+ *   moduleCleanup,
+ *   Constructor,
+ *   Destructor,
+ *   main,
+ *
+ *   own non realtime user functions
+ ******************************************************************************/
+
+// init_flags (for init and cleanup)
+#define INIT_BIT_DATA_MODULE        0
+#define INIT_BIT_MBX_WORK           1
+#define INIT_BIT_PROXY_POSITION     2
+#define INIT_BIT_MTX_MAP            3
+#define INIT_BIT_MAP                4
+
+int  FeatureMap::moduleInit(void)
+{
+    int ret;
+
+    // call RackDataModule init function (first command in init)
+    ret = RackDataModule::moduleInit();
+    if (ret)
+    {
+        return ret;
+    }
+    initBits.setBit(INIT_BIT_DATA_MODULE);
+
+    //
+    // create mailboxes
+    //
+
+    // work mailbox
+    ret = createMbx(&workMbx, 10, sizeof(position_data),
+                    MBX_IN_KERNELSPACE | MBX_SLOT);
+    if (ret)
+    {
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_MBX_WORK);
+
+
+    //
+    // create Proxys
+    //
+
+    // position proxy
+    position = new PositionProxy(&workMbx, positionSys, positionInst);
+    if (!position)
+    {
+        ret = -ENOMEM;
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_PROXY_POSITION);
+
+    // map mutex
+    ret = mapMtx.create();
+    if (ret)
+    {
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_MTX_MAP);
+
+    // feature list
+    dxfMap    = new DxfMap(featureMax);
+    result    = new int[featureMax];
+    resultMax = featureMax;
+    if (!dxfMap || !result || !dxfMap->feature)
+    {
+        GDOS_ERROR("Can't allocate map of %d features\n", featureMax);
+        ret = -ENOMEM;
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_MAP);
+
+    layerNum = 0;
+    dataNum  = 0;
+    index.setLayer(layer, layerNum);
+
+    return 0;
+
+init_error:
+    if (!initBits.testBit(INIT_BIT_MAP))
+    {
+        if (dxfMap)
+            delete dxfMap;
+        if (result)
+            delete[] result;
+    }
+    moduleCleanup();
+    return ret;
+}
+
+
+void FeatureMap::moduleCleanup(void)
+{
+    // call RackDataModule cleanup function
+    if (initBits.testAndClearBit(INIT_BIT_DATA_MODULE))
+    {
+        RackDataModule::moduleCleanup();
+    }
+
+    if (initBits.testAndClearBit(INIT_BIT_MAP))
+    {
+        delete dxfMap;
+        delete[] result;
+    }
+
+    if (initBits.testAndClearBit(INIT_BIT_MTX_MAP))
+    {
+        mapMtx.destroy();
+    }
+
+    //
+    // free proxies
+    //
+    if (initBits.testAndClearBit(INIT_BIT_PROXY_POSITION))
+    {
+        delete position;
+    }
+
+    //
+    // delete mailboxes
+    //
+    if (initBits.testAndClearBit(INIT_BIT_MBX_WORK))
+    {
+        destroyMbx(&workMbx);
+    }
+}
+
+
+FeatureMap::FeatureMap()
+      : RackDataModule( MODULE_CLASS_ID,
+                    5000000000llu,    // 5s datatask error sleep time
+                    16,               // command mailbox slots
+                    240,              // command mailbox data size per slot
+                    MBX_IN_KERNELSPACE | MBX_SLOT,  // command mailbox flags
+                    5,                // max buffer entries
+                    10)               // data buffer listener
+{
+    // get static module parameter
+    positionSys  = getIntArg("positionSys", argTab);
+    positionInst = getIntArg("positionInst", argTab);
+    featureMax   = getIntArg("featureMax", argTab);
+
+    dxfMap = NULL;
+    result = NULL;
+    resultMax = 0;
+
+    dataBufferMaxDataSize   = sizeof(feature_map_data_msg);
+}
+
+
+int  main(int argc, char *argv[])
+{
+    int ret;
+
+    // get args
+    ret = RackModule::getArgs(argc, argv, argTab, "FeatureMap");
+    if (ret)
+    {
+        printf("Invalid arguments -> EXIT \n");
+        return ret;
+    }
+
+    FeatureMap *pInst;
+
+    // create new FeatureMap
+    pInst = new FeatureMap();
+    if (!pInst)
+    {
+        printf("Can't create new FeatureMap -> EXIT\n");
+        return -ENOMEM;
+    }
+
+    // init
+    ret = pInst->moduleInit();
+    if (ret)
+        goto exit_error;
+
+    pInst->run();
+    return 0;
+
+exit_error:
+    delete (pInst);
+    return ret;
+}
@@ -0,0 +1,120 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Matthias Hentschel <hentschel@rts.uni-hannover.de>
+ */
+
+#ifndef __FEATURE_MAP_H__
+#define __FEATURE_MAP_H__
+
+#include <main/rack_data_module.h>
+#include <main/rack_mutex.h>
+
+#include <navigation/feature_map_proxy.h>
+#include <navigation/position_proxy.h>
+
+#include "feature_map_index.h"
+
+// define module class
+#define MODULE_CLASS_ID             FEATURE_MAP
+
+// feature map data message (use max message size)
+typedef struct {
+    feature_map_data        data;
+    feature_map_data_point  feature[FEATURE_MAP_FEATURE_MAX];
+} __attribute__((packed)) feature_map_data_msg;
+
+// feature map chunk message (use max message size)
+typedef struct {
+    feature_map_chunk_data  data;
+    feature_map_data_point  feature[FEATURE_MAP_CHUNK_MAX];
+} __attribute__((packed)) feature_map_chunk_data_msg;
+
+// feature map layer message (use max message size)
+typedef struct {
+    feature_map_layer_data  data;
+    int32_t                 layer[FEATURE_MAP_LAYER_MAX];
+} __attribute__((packed)) feature_map_layer_data_msg;
+
+/**
+ * Feature Map
+ *
+ * Holds a DXF map of line features in a grid index. The data messages
+ * contain the features of the active layers around the robot, the whole
+ * map is read in chunks (MSG_FEATURE_MAP_GIVE_MAP). Region and nearest
+ * feature queries only search the index cells around the query.
+ *
+ * @ingroup modules_feature_map
+ */
+class FeatureMap : public RackDataModule {
+      private:
+
+        // external module parameter
+        int                 positionSys;
+        int                 positionInst;
+        int                 featureMax;
+        char                *mapFile;
+        int                 mapScaleFactor;
+        int                 mapOffsetX;
+        int                 mapOffsetY;
+        int                 indexScale;
+        int                 range;
+
+        // mailboxes
+        RackMailbox         workMbx;                // communication
+
+        // proxies
+        PositionProxy*      position;
+
+        // data structures
+        position_data       positionData;
+        DxfMap*             dxfMap;
+        FeatureMapIndex     index;
+        RackMutex           mapMtx;
+        int                 layer[FEATURE_MAP_LAYER_MAX];
+        int                 layerNum;
+        int                 *result;
+        int                 resultMax;
+        int                 dataIndex[FEATURE_MAP_FEATURE_MAX];
+        int                 dataNum;
+        feature_map_chunk_data_msg  chunkMsg;
+
+        int      loadMap(char *filename);
+        int      reserveResult(int num);
+        int      saveMap(char *filename);
+        int      addLine(feature_map_data_point *line);
+        int      deleteLine(int dataNo);
+        int      displaceLine(int dataNo, feature_map_data_point *line);
+        int      getLayer(feature_map_layer_data_msg *layerMsg);
+        void     setLine(dxf_map_feature *f, double x, double y, double x2, double y2);
+        void     copyFeature(feature_map_data_point *point, dxf_map_feature *f);
+
+      protected:
+        // -> realtime context
+        int      moduleOn(void);
+        int      moduleLoop(void);
+        void     moduleOff(void);
+        int      moduleCommand(RackMessage *msgInfo);
+
+        // -> non realtime context
+        void     moduleCleanup(void);
+
+      public:
+        // constructor und destructor
+        FeatureMap();
+        ~FeatureMap() {};
+
+        // -> non realtime context
+        int  moduleInit(void);
+};
+
+#endif // __FEATURE_MAP_H__
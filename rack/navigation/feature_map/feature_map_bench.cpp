@@ -0,0 +1,254 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Matthias Hentschel <hentschel@rts.uni-hannover.de>
+ */
+#include <main/rack_module.h>
+#include <main/argopts.h>
+
+#include <math.h>
+
+#include "feature_map_index.h"
+
+//
+// Builds the feature index of a DXF map (or of random lines if no map is
+// given) and compares random nearest feature and region queries with a
+// search through all features.
+//
+
+//
+// data structures
+//
+
+arg_table_t argTab[] = {
+
+    { ARGOPT_OPT, "mapFile", ARGOPT_REQVAL, ARGOPT_VAL_STR,
+      "filename of the DXF map, default random lines", { 0 } },
+
+    { ARGOPT_OPT, "mapScaleFactor", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "map scale factor", { 1000 } },
+
+    { ARGOPT_OPT, "featureNum", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Number of random lines (or maximum map features), default 50000", { 50000 } },
+
+    { ARGOPT_OPT, "size", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Size of the random map in mm, default 500000 mm", { 500000 } },
+
+    { ARGOPT_OPT, "indexScale", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Cell size of the feature index in mm, default 2000 mm", { 2000 } },
+
+    { ARGOPT_OPT, "range", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Half size of the query regions in mm, default 20000 mm", { 20000 } },
+
+    { ARGOPT_OPT, "queryNum", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Number of random queries, default 1000", { 1000 } },
+
+    { ARGOPT_OPT, "seed", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Seed of the random lines and queries, default 1", { 1 } },
+
+    { 0, "", 0, 0, "", { 0 } } // last entry
+};
+
+static double randDouble(double min, double max)
+{
+    return min + (max - min) * (double)rand() / (double)RAND_MAX;
+}
+
+// Liang-Barsky test of a line against a box
+static int lineInBox(dxf_map_feature *f, double x0, double y0, double x1, double y1)
+{
+    double p[4], q[4], t0 = 0.0, t1 = 1.0, r;
+    double dx = f->x2 - f->x;
+    double dy = f->y2 - f->y;
+    int    i;
+
+    p[0] = -dx; q[0] = f->x - x0;
+    p[1] =  dx; q[1] = x1 - f->x;
+    p[2] = -dy; q[2] = f->y - y0;
+    p[3] =  dy; q[3] = y1 - f->y;
+
+    for (i = 0; i < 4; i++)
+    {
+        if (p[i] == 0.0)
+        {
+            if (q[i] < 0.0)
+                return 0;
+        }
+        else
+        {
+            r = q[i] / p[i];
+            if (p[i] < 0.0)
+            {
+                if (r > t1)
+                    return 0;
+                if (r > t0)
+                    t0 = r;
+            }
+            else
+            {
+                if (r < t0)
+                    return 0;
+                if (r < t1)
+                    t1 = r;
+            }
+        }
+    }
+    return 1;
+}
+
+int  main(int argc, char *argv[])
+{
+    RackTime            rackTime;
+    FeatureMapIndex     index;
+    DxfMap              *map;
+    dxf_map_feature     *f;
+    char                *mapFile;
+    int                 *result;
+    uint64_t            time, indexTime = 0, bruteTime = 0;
+    uint64_t            regionTime = 0, regionBruteTime = 0;
+    double              size, range, x, y, a, l, dist, bruteDist, d;
+    int                 featureNum, queryNum, resultNum, bruteNum, brute;
+    int                 nearestErr = 0, regionErr = 0;
+    int                 i, j, ret;
+
+    // get args
+    ret = RackModule::getArgs(argc, argv, argTab, "FeatureMapBench");
+    if (ret)
+    {
+        printf("Invalid arguments -> EXIT \n");
+        return ret;
+    }
+
+    mapFile    = getStrArg("mapFile", argTab);
+    featureNum = getIntArg("featureNum", argTab);
+    size       = getIntArg("size", argTab);
+    range      = getIntArg("range", argTab);
+    queryNum   = getIntArg("queryNum", argTab);
+
+    map    = new DxfMap(featureNum);
+    result = new int[featureNum];
+    if (!map || !map->feature || !result)
+    {
+        printf("Can't allocate %d features -> EXIT\n", featureNum);
+        return -ENOMEM;
+    }
+
+    srand(getIntArg("seed", argTab));
+
+    if (mapFile)
+    {
+        ret = map->load(mapFile, 0, 0, getIntArg("mapScaleFactor", argTab));
+        if (ret)
+        {
+            printf("Can't load DXF map %s, code = %d\n", mapFile, ret);
+            return ret;
+        }
+    }
+    else
+    {
+        // random short lines, like walls of buildings
+        for (i = 0; i < featureNum; i++)
+        {
+            f     = &map->feature[i];
+            f->x  = randDouble(0.0, size);
+            f->y  = randDouble(0.0, size);
+            a     = randDouble(-M_PI, M_PI);
+            l     = randDouble(100.0, 5000.0);
+            f->x2 = f->x + l * cos(a);
+            f->y2 = f->y + l * sin(a);
+            f->l  = l;
+            f->rho   = a;
+            f->sin   = sin(a);
+            f->cos   = cos(a);
+            f->layer = i % 4;
+        }
+        map->featureNum = featureNum;
+        map->xMin       = 0.0;
+        map->yMin       = 0.0;
+        map->xMax       = size;
+        map->yMax       = size;
+    }
+
+    time = rackTime.getNano();
+    ret  = index.build(map->feature, map->featureNum, getIntArg("indexScale", argTab));
+    if (ret)
+    {
+        printf("Can't build feature index, code = %d\n", ret);
+        return ret;
+    }
+    printf("index of %d features:  %8.3f ms, %d cells, %d entries\n", map->featureNum,
+           (double)(rackTime.getNano() - time) / 1000000.0, index.getCellNum(),
+           index.getEntryNum());
+
+    for (i = 0; i < queryNum; i++)
+    {
+        x = randDouble(map->xMin, map->xMax);
+        y = randDouble(map->yMin, map->yMax);
+
+        // nearest feature
+        time = rackTime.getNano();
+        j    = index.nearest(x, y, HUGE_VAL, &dist);
+        indexTime += rackTime.getNano() - time;
+
+        time      = rackTime.getNano();
+        brute     = -1;
+        bruteDist = HUGE_VAL;
+        for (j = 0; j < map->featureNum; j++)
+        {
+            d = FeatureMapIndex::pointDist(&map->feature[j], x, y);
+            if (d < bruteDist)
+            {
+                bruteDist = d;
+                brute     = j;
+            }
+        }
+        bruteTime += rackTime.getNano() - time;
+
+        if ((brute >= 0) && (fabs(dist - bruteDist) > 0.001))
+            nearestErr++;
+
+        // region
+        time      = rackTime.getNano();
+        resultNum = index.region(x - range, y - range, x + range, y + range,
+                                 result, map->featureNum);
+        regionTime += rackTime.getNano() - time;
+
+        time     = rackTime.getNano();
+        bruteNum = 0;
+        for (j = 0; j < map->featureNum; j++)
+        {
+            if (lineInBox(&map->feature[j], x - range, y - range, x + range, y + range))
+                bruteNum++;
+        }
+        regionBruteTime += rackTime.getNano() - time;
+
+        if (resultNum != bruteNum)
+            regionErr++;
+    }
+
+    if (queryNum > 0)
+    {
+        printf("%d random queries\n", queryNum);
+        printf("nearest, index:        %8.4f ms\n",
+               (double)indexTime / 1000000.0 / queryNum);
+        printf("nearest, all features: %8.4f ms, %d mismatches\n",
+               (double)bruteTime / 1000000.0 / queryNum, nearestErr);
+        printf("region, index:         %8.4f ms\n",
+               (double)regionTime / 1000000.0 / queryNum);
+        printf("region, all features:  %8.4f ms, %d mismatches\n",
+               (double)regionBruteTime / 1000000.0 / queryNum, regionErr);
+    }
+
+    delete[] result;
+    delete map;
+    return 0;
+}
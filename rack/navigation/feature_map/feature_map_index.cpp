@@ -0,0 +1,504 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Matthias Hentschel <hentschel@rts.uni-hannover.de>
+ */
+
+#include "feature_map_index.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+// clips the line of a feature at a box (Liang-Barsky), returns 1 if a part
+// of the line is inside
+static int lineInBox(dxf_map_feature *f, double x0, double y0, double x1, double y1)
+{
+    double  t0 = 0.0, t1 = 1.0, r;
+    double  p[4], q[4];
+    int     i;
+
+    p[0] = -(f->x2 - f->x);
+    q[0] = f->x - x0;
+    p[1] = f->x2 - f->x;
+    q[1] = x1 - f->x;
+    p[2] = -(f->y2 - f->y);
+    q[2] = f->y - y0;
+    p[3] = f->y2 - f->y;
+    q[3] = y1 - f->y;
+
+    for (i = 0; i < 4; i++)
+    {
+        if (p[i] == 0.0)
+        {
+            if (q[i] < 0.0)
+                return 0;
+        }
+        else
+        {
+            r = q[i] / p[i];
+            if (p[i] < 0.0)
+            {
+                if (r > t1)
+                    return 0;
+                if (r > t0)
+                    t0 = r;
+            }
+            else
+            {
+                if (r < t0)
+                    return 0;
+                if (r < t1)
+                    t1 = r;
+            }
+        }
+    }
+    return 1;
+}
+
+FeatureMapIndex::FeatureMapIndex()
+{
+    feature    = NULL;
+    featureNum = 0;
+    xMin       = 0.0;
+    yMin       = 0.0;
+    scale      = 1.0;
+    numX       = 0;
+    numY       = 0;
+    cellStart  = NULL;
+    cellEntry  = NULL;
+    entryNum   = 0;
+    entryMax   = 0;
+    stamp      = NULL;
+    stampMax   = 0;
+    query      = 0;
+    layer      = NULL;
+    layerNum   = 0;
+}
+
+FeatureMapIndex::~FeatureMapIndex()
+{
+    if (cellStart)
+        delete[] cellStart;
+    if (cellEntry)
+        delete[] cellEntry;
+    if (stamp)
+        delete[] stamp;
+}
+
+/**
+ * Builds the index of a feature list
+ *
+ * The features are not copied, the index has to be built again after
+ * the list has changed.
+ *
+ * @param feature       Feature list
+ * @param featureNum    Number of features
+ * @param scale         Cell size in mm, it is enlarged if the map needs more
+ *                      than FEATURE_MAP_INDEX_CELL_MAX cells
+ *
+ * @return 0 on success, otherwise negative error code
+ */
+int FeatureMapIndex::build(dxf_map_feature *feature, int featureNum, double scale)
+{
+    int     i, c, cellNum;
+    double  xMax, yMax, f;
+
+    if (scale <= 0.0)
+        return -EINVAL;
+
+    this->feature    = feature;
+    this->featureNum = featureNum;
+
+    // bounds
+    xMin = 0.0;
+    yMin = 0.0;
+    xMax = 0.0;
+    yMax = 0.0;
+    for (i = 0; i < featureNum; i++)
+    {
+        if ((i == 0) || (feature[i].x  < xMin))
+            xMin = feature[i].x;
+        if (feature[i].x2 < xMin)
+            xMin = feature[i].x2;
+        if ((i == 0) || (feature[i].y  < yMin))
+            yMin = feature[i].y;
+        if (feature[i].y2 < yMin)
+            yMin = feature[i].y2;
+        if ((i == 0) || (feature[i].x  > xMax))
+            xMax = feature[i].x;
+        if (feature[i].x2 > xMax)
+            xMax = feature[i].x2;
+        if ((i == 0) || (feature[i].y  > yMax))
+            yMax = feature[i].y;
+        if (feature[i].y2 > yMax)
+            yMax = feature[i].y2;
+    }
+
+    f = ((xMax - xMin) / scale + 1.0) * ((yMax - yMin) / scale + 1.0);
+    if (f > FEATURE_MAP_INDEX_CELL_MAX)
+    {
+        scale *= sqrt(f / FEATURE_MAP_INDEX_CELL_MAX) * 1.01;
+    }
+
+    this->scale = scale;
+    numX        = (int)((xMax - xMin) / scale) + 1;
+    numY        = (int)((yMax - yMin) / scale) + 1;
+    cellNum     = numX * numY;
+
+    if (cellStart)
+        delete[] cellStart;
+    cellStart = new int[cellNum + 1];
+    if (!cellStart)
+        return -ENOMEM;
+
+    if (featureNum > stampMax)
+    {
+        if (stamp)
+            delete[] stamp;
+        stamp = new uint32_t[featureNum];
+        if (!stamp)
+        {
+            stampMax = 0;
+            return -ENOMEM;
+        }
+        stampMax = featureNum;
+    }
+    memset(stamp, 0, stampMax * sizeof(uint32_t));
+    query = 0;
+
+    // count the entries of every cell
+    memset(cellStart, 0, (cellNum + 1) * sizeof(int));
+    for (i = 0; i < featureNum; i++)
+    {
+        traverse(&feature[i], &cellStart[1], -1);
+    }
+
+    for (c = 0; c < cellNum; c++)
+    {
+        cellStart[c + 1] += cellStart[c];
+    }
+    entryNum = cellStart[cellNum];
+
+    if (entryNum > entryMax)
+    {
+        if (cellEntry)
+            delete[] cellEntry;
+        cellEntry = new int[entryNum];
+        if (!cellEntry)
+        {
+            entryMax = 0;
+            return -ENOMEM;
+        }
+        entryMax = entryNum;
+    }
+
+    // fill the cells, cellStart is used as write position and restored
+    for (i = 0; i < featureNum; i++)
+    {
+        traverse(&feature[i], cellStart, i);
+    }
+
+    for (c = cellNum; c > 0; c--)
+    {
+        cellStart[c] = cellStart[c - 1];
+    }
+    cellStart[0] = 0;
+
+    return 0;
+}
+
+/**
+ * Restricts the queries to a list of layers
+ *
+ * The list is not copied and has to be valid until the next call,
+ * layerNum = 0 selects all layers.
+ */
+void FeatureMapIndex::setLayer(const int *layer, int layerNum)
+{
+    this->layer    = layer;
+    this->layerNum = layerNum;
+}
+
+/**
+ * Finds the features of the active layers touching a box
+ *
+ * @return Number of feature numbers written to result
+ */
+int FeatureMapIndex::region(double x0, double y0, double x1, double y1, int *result,
+                            int resultMax)
+{
+    int ix, iy, ix0, iy0, ix1, iy1, e, i, num;
+
+    if ((featureNum == 0) || (x1 < x0) || (y1 < y0))
+        return 0;
+
+    ix0 = (int)floor((x0 - xMin) / scale);
+    iy0 = (int)floor((y0 - yMin) / scale);
+    ix1 = (int)floor((x1 - xMin) / scale);
+    iy1 = (int)floor((y1 - yMin) / scale);
+    if ((ix1 < 0) || (iy1 < 0) || (ix0 >= numX) || (iy0 >= numY))
+        return 0;
+
+    if (ix0 < 0)
+        ix0 = 0;
+    if (iy0 < 0)
+        iy0 = 0;
+    if (ix1 >= numX)
+        ix1 = numX - 1;
+    if (iy1 >= numY)
+        iy1 = numY - 1;
+
+    nextQuery();
+    num = 0;
+
+    for (ix = ix0; ix <= ix1; ix++)
+    {
+        for (iy = iy0; iy <= iy1; iy++)
+        {
+            for (e = cellStart[ix * numY + iy]; e < cellStart[ix * numY + iy + 1]; e++)
+            {
+                i = cellEntry[e];
+                if (stamp[i] == query)
+                    continue;
+                stamp[i] = query;
+
+                if (!layerActive(feature[i].layer) ||
+                    !lineInBox(&feature[i], x0, y0, x1, y1))
+                    continue;
+
+                if (num >= resultMax)
+                    return num;
+                result[num++] = i;
+            }
+        }
+    }
+
+    return num;
+}
+
+/**
+ * Finds the feature of the active layers next to a point
+ *
+ * The cells are searched in rings around the point until the ring is
+ * farther away than the nearest feature found so far.
+ *
+ * @return Feature number, -1 if there is no feature within distMax
+ */
+int FeatureMapIndex::nearest(double x, double y, double distMax, double *dist)
+{
+    int     ix, iy, cx, cy, r, rMax, e, i, best;
+    double  px, py, d, dBest;
+
+    best  = -1;
+    dBest = distMax;
+
+    if (featureNum == 0)
+        return -1;
+
+    // cells of the grid are at least as far from the point as from its
+    // projection onto the grid
+    px = (x - xMin) / scale;
+    py = (y - yMin) / scale;
+    cx = (int)floor(px);
+    cy = (int)floor(py);
+    if (cx < 0)
+        cx = 0;
+    if (cx >= numX)
+        cx = numX - 1;
+    if (cy < 0)
+        cy = 0;
+    if (cy >= numY)
+        cy = numY - 1;
+
+    rMax = (numX > numY) ? numX : numY;
+    nextQuery();
+
+    for (r = 0; r < rMax; r++)
+    {
+        if ((r > 0) && ((double)(r - 1) * scale > dBest))
+            break;
+
+        for (ix = cx - r; ix <= cx + r; ix++)
+        {
+            if ((ix < 0) || (ix >= numX))
+                continue;
+
+            for (iy = cy - r; iy <= cy + r; iy++)
+            {
+                if ((iy < 0) || (iy >= numY))
+                    continue;
+
+                // ring only
+                if ((ix != cx - r) && (ix != cx + r) && (iy != cy - r) && (iy != cy + r))
+                {
+                    iy = cy + r - 1;
+                    continue;
+                }
+
+                for (e = cellStart[ix * numY + iy]; e < cellStart[ix * numY + iy + 1]; e++)
+                {
+                    i = cellEntry[e];
+                    if (stamp[i] == query)
+                        continue;
+                    stamp[i] = query;
+
+                    if (!layerActive(feature[i].layer))
+                        continue;
+
+                    d = pointDist(&feature[i], x, y);
+                    if (d <= dBest)
+                    {
+                        dBest = d;
+                        best  = i;
+                    }
+                }
+            }
+        }
+    }
+
+    if (dist)
+        *dist = dBest;
+    return best;
+}
+
+/**
+ * @return Distance of a point to the line of a feature in mm
+ */
+double FeatureMapIndex::pointDist(dxf_map_feature *f, double x, double y)
+{
+    double dx, dy, l2, t;
+
+    dx = f->x2 - f->x;
+    dy = f->y2 - f->y;
+    l2 = dx * dx + dy * dy;
+
+    t = 0.0;
+    if (l2 > 0.0)
+    {
+        t = ((x - f->x) * dx + (y - f->y) * dy) / l2;
+        if (t < 0.0)
+            t = 0.0;
+        if (t > 1.0)
+            t = 1.0;
+    }
+
+    dx = f->x + t * dx - x;
+    dy = f->y + t * dy - y;
+    return sqrt(dx * dx + dy * dy);
+}
+
+// walks the cells of a feature line (Amanatides-Woo), counts them if
+// index < 0, otherwise stores the feature number at pos[cell]++
+int FeatureMapIndex::traverse(dxf_map_feature *f, int *pos, int index)
+{
+    int     ix, iy, ix1, iy1, sx, sy, n, nMax;
+    double  x0, y0, x1, y1, dx, dy, tMaxX, tMaxY, tDeltaX, tDeltaY;
+
+    x0 = (f->x  - xMin) / scale;
+    y0 = (f->y  - yMin) / scale;
+    x1 = (f->x2 - xMin) / scale;
+    y1 = (f->y2 - yMin) / scale;
+
+    ix  = (int)x0;
+    iy  = (int)y0;
+    ix1 = (int)x1;
+    iy1 = (int)y1;
+    if (ix >= numX)
+        ix = numX - 1;
+    if (iy >= numY)
+        iy = numY - 1;
+    if (ix1 >= numX)
+        ix1 = numX - 1;
+    if (iy1 >= numY)
+        iy1 = numY - 1;
+
+    dx = x1 - x0;
+    dy = y1 - y0;
+    sx = (dx > 0.0) ? 1 : -1;
+    sy = (dy > 0.0) ? 1 : -1;
+
+    if (dx != 0.0)
+    {
+        tMaxX   = ((double)(ix + (sx > 0)) - x0) / dx;
+        tDeltaX = (double)sx / dx;
+    }
+    else
+    {
+        tMaxX   = HUGE_VAL;
+        tDeltaX = HUGE_VAL;
+    }
+
+    if (dy != 0.0)
+    {
+        tMaxY   = ((double)(iy + (sy > 0)) - y0) / dy;
+        tDeltaY = (double)sy / dy;
+    }
+    else
+    {
+        tMaxY   = HUGE_VAL;
+        tDeltaY = HUGE_VAL;
+    }
+
+    nMax = abs(ix1 - ix) + abs(iy1 - iy) + 1;
+
+    for (n = 0; n < nMax; n++)
+    {
+        if (index < 0)
+            pos[ix * numY + iy]++;
+        else
+            cellEntry[pos[ix * numY + iy]++] = index;
+
+        if (tMaxX < tMaxY)
+        {
+            ix    += sx;
+            tMaxX += tDeltaX;
+        }
+        else
+        {
+            iy    += sy;
+            tMaxY += tDeltaY;
+        }
+
+        if ((ix < 0) || (iy < 0) || (ix >= numX) || (iy >= numY))
+            break;
+    }
+
+    return n;
+}
+
+int FeatureMapIndex::layerActive(int featureLayer)
+{
+    int i;
+
+    if (layerNum == 0)
+        return 1;
+
+    for (i = 0; i < layerNum; i++)
+    {
+        if (layer[i] == featureLayer)
+            return 1;
+    }
+    return 0;
+}
+
+int FeatureMapIndex::nextQuery(void)
+{
+    query++;
+    if (query == 0)
+    {
+        memset(stamp, 0, stampMax * sizeof(uint32_t));
+        query = 1;
+    }
+    return query;
+}
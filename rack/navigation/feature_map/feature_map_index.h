@@ -0,0 +1,85 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Matthias Hentschel <hentschel@rts.uni-hannover.de>
+ */
+
+#ifndef __FEATURE_MAP_INDEX_H__
+#define __FEATURE_MAP_INDEX_H__
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include <main/dxf_map.h>
+
+#define FEATURE_MAP_INDEX_CELL_MAX  (1024 * 1024)   // maximum number of index cells
+
+/**
+ * Uniform grid index of map line features
+ *
+ * Every feature is entered into all cells its line passes. The cells store
+ * feature numbers in one array (cell lists one after another), so the
+ * features themselves are never copied. Region and nearest queries only
+ * visit the cells around the query and can be restricted to a list of
+ * layers.
+ */
+class FeatureMapIndex
+{
+    private:
+        dxf_map_feature *feature;
+        int             featureNum;
+
+        double          xMin;
+        double          yMin;
+        double          scale;
+        int             numX;
+        int             numY;
+        int             *cellStart;             // first entry of a cell, cellNum + 1
+        int             *cellEntry;
+        int             entryNum;
+        int             entryMax;
+
+        uint32_t        *stamp;                 // last query of a feature
+        int             stampMax;
+        uint32_t        query;
+
+        const int       *layer;
+        int             layerNum;
+
+        int     traverse(dxf_map_feature *f, int *pos, int index);
+        int     layerActive(int featureLayer);
+        int     nextQuery(void);
+
+    public:
+        FeatureMapIndex();
+        ~FeatureMapIndex();
+
+        int     build(dxf_map_feature *feature, int featureNum, double scale);
+        void    setLayer(const int *layer, int layerNum);
+        int     region(double x0, double y0, double x1, double y1, int *result,
+                       int resultMax);
+        int     nearest(double x, double y, double distMax, double *dist);
+
+        static double pointDist(dxf_map_feature *f, double x, double y);
+
+        int     getCellNum(void)
+        {
+            return numX * numY;
+        }
+
+        int     getEntryNum(void)
+        {
+            return entryNum;
+        }
+};
+
+#endif // __FEATURE_MAP_INDEX_H__
@@ -34,31 +34,38 @@ int FeatureMapProxy::getData(feature_map_data *recv_data, ssize_t recv_datalen,
     return 0;
 }
 
+int FeatureMapProxy::loadMap(feature_map_filename *recv_data, ssize_t recv_datalen,
+                              uint64_t reply_timeout_ns)
+{
+    return proxySendDataCmd(MSG_FEATURE_MAP_LOAD_MAP, recv_data, recv_datalen,
+                            reply_timeout_ns);
+}
+
 int FeatureMapProxy::addLine(feature_map_feature *recv_data, ssize_t recv_datalen,
                               uint64_t reply_timeout_ns)
 {
-    return proxySendDataCmd(MSG_FEATURE_MAP_ADD_LINE, &recv_data, recv_datalen,
+    return proxySendDataCmd(MSG_FEATURE_MAP_ADD_LINE, recv_data, recv_datalen,
                             reply_timeout_ns);
 }
 
 int FeatureMapProxy::saveMap(feature_map_filename *recv_data, ssize_t recv_datalen,
                               uint64_t reply_timeout_ns)
 {
-    return proxySendDataCmd(MSG_FEATURE_MAP_SAVE_MAP, &recv_data, recv_datalen,
+    return proxySendDataCmd(MSG_FEATURE_MAP_SAVE_MAP, recv_data, recv_datalen,
                             reply_timeout_ns);
 }
 
 int FeatureMapProxy::deleteLine(feature_map_feature *recv_data, ssize_t recv_datalen,
                               uint64_t reply_timeout_ns)
 {
-    return proxySendDataCmd(MSG_FEATURE_MAP_DELETE_LINE, &recv_data, recv_datalen,
+    return proxySendDataCmd(MSG_FEATURE_MAP_DELETE_LINE, recv_data, recv_datalen,
                             reply_timeout_ns);
 }
 
 int FeatureMapProxy::displaceLine(feature_map_feature *recv_data, ssize_t recv_datalen,
                               uint64_t reply_timeout_ns)
 {
-    return proxySendDataCmd(MSG_FEATURE_MAP_DISPLACE_LINE, &recv_data, recv_datalen,
+    return proxySendDataCmd(MSG_FEATURE_MAP_DISPLACE_LINE, recv_data, recv_datalen,
                             reply_timeout_ns);
 }
 
@@ -85,3 +92,57 @@ int FeatureMapProxy::getLayer(feature_map_layer_data *recv_data, ssize_t recv_da
     recv_data = FeatureMapLayerData::parse(&msgInfo);
     return 0;
 }
+
+int FeatureMapProxy::getChunk(feature_map_chunk_request *send_data, ssize_t send_datalen,
+                              feature_map_chunk_data *recv_data, ssize_t recv_datalen,
+                              uint64_t reply_timeout_ns)
+{
+    RackMessage msgInfo;
+
+    int ret = proxySendRecvDataCmd(MSG_FEATURE_MAP_GIVE_MAP, (void *)send_data, send_datalen,
+                                   MSG_FEATURE_MAP_CHUNK, (void *)recv_data, recv_datalen,
+                                   reply_timeout_ns, &msgInfo);
+    if (ret)
+    {
+        return ret;
+    }
+
+    recv_data = FeatureMapChunkData::parse(&msgInfo);
+    return 0;
+}
+
+int FeatureMapProxy::getRegion(feature_map_region_request *send_data, ssize_t send_datalen,
+                               feature_map_chunk_data *recv_data, ssize_t recv_datalen,
+                               uint64_t reply_timeout_ns)
+{
+    RackMessage msgInfo;
+
+    int ret = proxySendRecvDataCmd(MSG_FEATURE_MAP_GET_REGION, (void *)send_data, send_datalen,
+                                   MSG_FEATURE_MAP_CHUNK, (void *)recv_data, recv_datalen,
+                                   reply_timeout_ns, &msgInfo);
+    if (ret)
+    {
+        return ret;
+    }
+
+    recv_data = FeatureMapChunkData::parse(&msgInfo);
+    return 0;
+}
+
+int FeatureMapProxy::getNearest(feature_map_nearest_request *send_data, ssize_t send_datalen,
+                                feature_map_nearest_data *recv_data, ssize_t recv_datalen,
+                                uint64_t reply_timeout_ns)
+{
+    RackMessage msgInfo;
+
+    int ret = proxySendRecvDataCmd(MSG_FEATURE_MAP_GET_NEAREST, (void *)send_data, send_datalen,
+                                   MSG_FEATURE_MAP_NEAREST, (void *)recv_data, recv_datalen,
+                                   reply_timeout_ns, &msgInfo);
+    if (ret)
+    {
+        return ret;
+    }
+
+    recv_data = FeatureMapNearestData::parse(&msgInfo);
+    return 0;
+}
@@ -29,13 +29,18 @@
 #define MSG_FEATURE_MAP_DISPLACE_LINE           (RACK_PROXY_MSG_POS_OFFSET + 6)
 #define MSG_FEATURE_MAP_GET_LAYER               (RACK_PROXY_MSG_POS_OFFSET + 7)
 #define MSG_FEATURE_MAP_SET_LAYER               (RACK_PROXY_MSG_POS_OFFSET + 8)
+#define MSG_FEATURE_MAP_GET_REGION              (RACK_PROXY_MSG_POS_OFFSET + 9)
+#define MSG_FEATURE_MAP_GET_NEAREST             (RACK_PROXY_MSG_POS_OFFSET + 10)
 
 #define MSG_FEATURE_MAP_LAYER                   (RACK_PROXY_MSG_POS_OFFSET - 1)
+#define MSG_FEATURE_MAP_CHUNK                   (RACK_PROXY_MSG_POS_OFFSET - 2)
+#define MSG_FEATURE_MAP_NEAREST                 (RACK_PROXY_MSG_POS_OFFSET - 3)
 
 //#define MSG_FEATURE_MAP_ADD_LINE_OK            (RACK_PROXY_MSG_NEG_OFFSET - 10)
 
 #define FEATURE_MAP_FEATURE_MAX 200         /**< maximum number of map features */
 #define FEATURE_MAP_LAYER_MAX   20
+#define FEATURE_MAP_CHUNK_MAX   200         /**< maximum number of features of a map chunk */
 
 #define FEATURE_MAP_TYPE_LINE_FEATURE   10
 
@@ -117,7 +122,7 @@ class FeatureMapFeature
 
         static void be_to_cpu(feature_map_feature *data)
         {
-            data->recordingTime    = __le32_to_cpu(data->recordingTime);
+            data->recordingTime    = __be32_to_cpu(data->recordingTime);
             data->featureNumTemp    = __be32_to_cpu(data->featureNumTemp);
             FeatureMapDataPoint::be_to_cpu(&data->mapFeature);
         }
@@ -129,6 +134,11 @@ class FeatureMapFeature
 
             feature_map_feature *p_data = (feature_map_feature *)msgInfo->p_data;
 
+            if (msgInfo->isDataByteorderCpu()) // data in cpu byteorder
+            {
+                return p_data;
+            }
+
             if (msgInfo->isDataByteorderLe())
             {
                 le_to_cpu(p_data);
@@ -203,6 +213,11 @@ class FeatureMapData
 
             feature_map_data *p_data = (feature_map_data *)msgInfo->p_data;
 
+            if (msgInfo->isDataByteorderCpu()) // data in cpu byteorder
+            {
+                return p_data;
+            }
+
             if (msgInfo->isDataByteorderLe()) // data in little endian
             {
                 le_to_cpu(p_data);
@@ -245,6 +260,11 @@ class FeatureMapFilename
 
             feature_map_filename *p_data = (feature_map_filename*)msgInfo->p_data;
 
+            if (msgInfo->isDataByteorderCpu()) // data in cpu byteorder
+            {
+                return p_data;
+            }
+
             if (msgInfo->isDataByteorderLe()) // data in little endian
             {
                 le_to_cpu(p_data);
@@ -302,6 +322,11 @@ class FeatureMapLayerData
 
             feature_map_layer_data *p_data = (feature_map_layer_data *)msgInfo->p_data;
 
+            if (msgInfo->isDataByteorderCpu()) // data in cpu byteorder
+            {
+                return p_data;
+            }
+
            if (msgInfo->isDataByteorderLe()) // data in little endian
             {
                 le_to_cpu(p_data);
@@ -316,6 +341,310 @@ class FeatureMapLayerData
 };
 
 
+//######################################################################
+//# FeatureMap Chunk Request (static size - MESSAGE)
+//######################################################################
+
+/**
+ * feature map chunk request data structure
+ *
+ * Requests the map features first ... first + FEATURE_MAP_CHUNK_MAX - 1
+ * of all layers (MSG_FEATURE_MAP_GIVE_MAP).
+ */
+typedef struct {
+    int32_t     first;                      /**< index of the first feature */
+} __attribute__((packed)) feature_map_chunk_request;
+
+class FeatureMapChunkRequest
+{
+    public:
+        static void le_to_cpu(feature_map_chunk_request *data)
+        {
+            data->first = __le32_to_cpu(data->first);
+        }
+
+        static void be_to_cpu(feature_map_chunk_request *data)
+        {
+            data->first = __be32_to_cpu(data->first);
+        }
+
+        static feature_map_chunk_request* parse(RackMessage *msgInfo)
+        {
+            if (!msgInfo->p_data)
+                return NULL;
+
+            feature_map_chunk_request *p_data = (feature_map_chunk_request *)msgInfo->p_data;
+
+            if (msgInfo->isDataByteorderCpu()) // data in cpu byteorder
+            {
+                return p_data;
+            }
+
+            if (msgInfo->isDataByteorderLe()) // data in little endian
+            {
+                le_to_cpu(p_data);
+            }
+            else // data in big endian
+            {
+                be_to_cpu(p_data);
+            }
+            msgInfo->setDataByteorder();
+            return p_data;
+        }
+};
+
+//######################################################################
+//# FeatureMap Region Request (static size - MESSAGE)
+//######################################################################
+
+/**
+ * feature map region request data structure
+ *
+ * Requests the features of the active layers which touch the region
+ * (MSG_FEATURE_MAP_GET_REGION). Results with more than FEATURE_MAP_CHUNK_MAX
+ * features are read in several chunks starting at first.
+ */
+typedef struct {
+    int32_t     xMin;                       /**< [mm] lower x-coordinate of the region */
+    int32_t     yMin;                       /**< [mm] lower y-coordinate of the region */
+    int32_t     xMax;                       /**< [mm] upper x-coordinate of the region */
+    int32_t     yMax;                       /**< [mm] upper y-coordinate of the region */
+    int32_t     first;                      /**< index of the first result */
+} __attribute__((packed)) feature_map_region_request;
+
+class FeatureMapRegionRequest
+{
+    public:
+        static void le_to_cpu(feature_map_region_request *data)
+        {
+            data->xMin  = __le32_to_cpu(data->xMin);
+            data->yMin  = __le32_to_cpu(data->yMin);
+            data->xMax  = __le32_to_cpu(data->xMax);
+            data->yMax  = __le32_to_cpu(data->yMax);
+            data->first = __le32_to_cpu(data->first);
+        }
+
+        static void be_to_cpu(feature_map_region_request *data)
+        {
+            data->xMin  = __be32_to_cpu(data->xMin);
+            data->yMin  = __be32_to_cpu(data->yMin);
+            data->xMax  = __be32_to_cpu(data->xMax);
+            data->yMax  = __be32_to_cpu(data->yMax);
+            data->first = __be32_to_cpu(data->first);
+        }
+
+        static feature_map_region_request* parse(RackMessage *msgInfo)
+        {
+            if (!msgInfo->p_data)
+                return NULL;
+
+            feature_map_region_request *p_data = (feature_map_region_request *)msgInfo->p_data;
+
+            if (msgInfo->isDataByteorderCpu()) // data in cpu byteorder
+            {
+                return p_data;
+            }
+
+            if (msgInfo->isDataByteorderLe()) // data in little endian
+            {
+                le_to_cpu(p_data);
+            }
+            else // data in big endian
+            {
+                be_to_cpu(p_data);
+            }
+            msgInfo->setDataByteorder();
+            return p_data;
+        }
+};
+
+//######################################################################
+//# FeatureMap Chunk Data (!!! VARIABLE SIZE !!! MESSAGE !!!)
+//######################################################################
+
+/* CREATING A MESSAGE :
+
+typedef struct {
+    feature_map_chunk_data  data;
+    feature_map_data_point  feature[FEATURE_MAP_CHUNK_MAX];
+} __attribute__((packed)) feature_map_chunk_data_msg;
+
+*/
+
+/**
+ * feature map chunk data structure
+ */
+typedef struct {
+    int32_t     featureTotal;               /**< number of features of the map or the region */
+    int32_t     first;                      /**< index of the first feature of this chunk */
+    int32_t     featureNum;                 /**< number of following features */
+    feature_map_data_point  feature[0];     /**< list of map features */
+} __attribute__((packed)) feature_map_chunk_data;
+
+class FeatureMapChunkData
+{
+    public:
+        static void le_to_cpu(feature_map_chunk_data *data)
+        {
+            int i;
+            data->featureTotal = __le32_to_cpu(data->featureTotal);
+            data->first        = __le32_to_cpu(data->first);
+            data->featureNum   = __le32_to_cpu(data->featureNum);
+            for (i = 0; i < data->featureNum; i++)
+            {
+                FeatureMapDataPoint::le_to_cpu(&data->feature[i]);
+            }
+        }
+
+        static void be_to_cpu(feature_map_chunk_data *data)
+        {
+            int i;
+            data->featureTotal = __be32_to_cpu(data->featureTotal);
+            data->first        = __be32_to_cpu(data->first);
+            data->featureNum   = __be32_to_cpu(data->featureNum);
+            for (i = 0; i < data->featureNum; i++)
+            {
+                FeatureMapDataPoint::be_to_cpu(&data->feature[i]);
+            }
+        }
+
+        static feature_map_chunk_data* parse(RackMessage *msgInfo)
+        {
+            if (!msgInfo->p_data)
+                return NULL;
+
+            feature_map_chunk_data *p_data = (feature_map_chunk_data *)msgInfo->p_data;
+
+            if (msgInfo->isDataByteorderCpu()) // data in cpu byteorder
+            {
+                return p_data;
+            }
+
+            if (msgInfo->isDataByteorderLe()) // data in little endian
+            {
+                le_to_cpu(p_data);
+            }
+            else // data in big endian
+            {
+                be_to_cpu(p_data);
+            }
+            msgInfo->setDataByteorder();
+            return p_data;
+        }
+};
+
+//######################################################################
+//# FeatureMap Nearest Request (static size - MESSAGE)
+//######################################################################
+
+/**
+ * feature map nearest request data structure
+ */
+typedef struct {
+    int32_t     x;                          /**< [mm] global x-coordinate of the point */
+    int32_t     y;                          /**< [mm] global y-coordinate of the point */
+    int32_t     distMax;                    /**< [mm] maximum distance to the feature */
+} __attribute__((packed)) feature_map_nearest_request;
+
+class FeatureMapNearestRequest
+{
+    public:
+        static void le_to_cpu(feature_map_nearest_request *data)
+        {
+            data->x       = __le32_to_cpu(data->x);
+            data->y       = __le32_to_cpu(data->y);
+            data->distMax = __le32_to_cpu(data->distMax);
+        }
+
+        static void be_to_cpu(feature_map_nearest_request *data)
+        {
+            data->x       = __be32_to_cpu(data->x);
+            data->y       = __be32_to_cpu(data->y);
+            data->distMax = __be32_to_cpu(data->distMax);
+        }
+
+        static feature_map_nearest_request* parse(RackMessage *msgInfo)
+        {
+            if (!msgInfo->p_data)
+                return NULL;
+
+            feature_map_nearest_request *p_data = (feature_map_nearest_request *)msgInfo->p_data;
+
+            if (msgInfo->isDataByteorderCpu()) // data in cpu byteorder
+            {
+                return p_data;
+            }
+
+            if (msgInfo->isDataByteorderLe()) // data in little endian
+            {
+                le_to_cpu(p_data);
+            }
+            else // data in big endian
+            {
+                be_to_cpu(p_data);
+            }
+            msgInfo->setDataByteorder();
+            return p_data;
+        }
+};
+
+//######################################################################
+//# FeatureMap Nearest Data (static size - MESSAGE)
+//######################################################################
+
+/**
+ * feature map nearest data structure
+ */
+typedef struct {
+    int32_t                 index;          /**< index of the feature, -1 if there is none
+                                                 within distMax */
+    float                   dist;           /**< [mm] distance of the point to the feature */
+    feature_map_data_point  feature;        /**< nearest feature */
+} __attribute__((packed)) feature_map_nearest_data;
+
+class FeatureMapNearestData
+{
+    public:
+        static void le_to_cpu(feature_map_nearest_data *data)
+        {
+            data->index = __le32_to_cpu(data->index);
+            data->dist  = __le32_float_to_cpu(data->dist);
+            FeatureMapDataPoint::le_to_cpu(&data->feature);
+        }
+
+        static void be_to_cpu(feature_map_nearest_data *data)
+        {
+            data->index = __be32_to_cpu(data->index);
+            data->dist  = __be32_float_to_cpu(data->dist);
+            FeatureMapDataPoint::be_to_cpu(&data->feature);
+        }
+
+        static feature_map_nearest_data* parse(RackMessage *msgInfo)
+        {
+            if (!msgInfo->p_data)
+                return NULL;
+
+            feature_map_nearest_data *p_data = (feature_map_nearest_data *)msgInfo->p_data;
+
+            if (msgInfo->isDataByteorderCpu()) // data in cpu byteorder
+            {
+                return p_data;
+            }
+
+            if (msgInfo->isDataByteorderLe()) // data in little endian
+            {
+                le_to_cpu(p_data);
+            }
+            else // data in big endian
+            {
+                be_to_cpu(p_data);
+            }
+            msgInfo->setDataByteorder();
+            return p_data;
+        }
+};
+
+
 //######################################################################
 //# FeatureMap Proxy Functions
 //######################################################################
@@ -358,9 +687,14 @@ class FeatureMapProxy : public RackDataProxy {
     int getData(feature_map_data *recv_data, ssize_t recv_datalen,
                 rack_time_t timeStamp, uint64_t reply_timeout_ns);
 
-/*
- * loadMap, addLine etc. implementieren
- */
+    int loadMap(feature_map_filename *recv_data, ssize_t recv_datalen,
+                uint64_t reply_timeout_ns);
+
+    int loadMap(feature_map_filename *recv_data, ssize_t recv_datalen)
+    {
+        return loadMap(recv_data, recv_datalen, dataTimeout);
+    }
+
     int addLine(feature_map_feature *recv_data, ssize_t recv_datalen,
                        uint64_t reply_timeout_ns);
 
@@ -409,6 +743,36 @@ class FeatureMapProxy : public RackDataProxy {
 
     int setLayer(feature_map_layer_data *recv_data, ssize_t recv_datalen,
                  uint64_t reply_timeout_ns);
+
+    int getChunk(feature_map_chunk_request *send_data, ssize_t send_datalen,
+                 feature_map_chunk_data *recv_data, ssize_t recv_datalen)
+    {
+        return getChunk(send_data, send_datalen, recv_data, recv_datalen, dataTimeout);
+    }
+
+    int getChunk(feature_map_chunk_request *send_data, ssize_t send_datalen,
+                 feature_map_chunk_data *recv_data, ssize_t recv_datalen,
+                 uint64_t reply_timeout_ns);
+
+    int getRegion(feature_map_region_request *send_data, ssize_t send_datalen,
+                  feature_map_chunk_data *recv_data, ssize_t recv_datalen)
+    {
+        return getRegion(send_data, send_datalen, recv_data, recv_datalen, dataTimeout);
+    }
+
+    int getRegion(feature_map_region_request *send_data, ssize_t send_datalen,
+                  feature_map_chunk_data *recv_data, ssize_t recv_datalen,
+                  uint64_t reply_timeout_ns);
+
+    int getNearest(feature_map_nearest_request *send_data, ssize_t send_datalen,
+                   feature_map_nearest_data *recv_data, ssize_t recv_datalen)
+    {
+        return getNearest(send_data, send_datalen, recv_data, recv_datalen, dataTimeout);
+    }
+
+    int getNearest(feature_map_nearest_request *send_data, ssize_t send_datalen,
+                   feature_map_nearest_data *recv_data, ssize_t recv_datalen,
+                   uint64_t reply_timeout_ns);
 };
 
 #endif // __FEATURE_MAP_PROXY_H__
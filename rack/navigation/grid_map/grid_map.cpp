@@ -0,0 +1,351 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Matthias Hentschel <hentschel@rts.uni-hannover.de>
+ */
+
+#include "grid_map.h"
+
+// map output
+#define MAP_OUT_WINDOW              0
+#define MAP_OUT_DIRTY               1
+
+//
+// data structures
+//
+
+// external module parameter
+arg_table_t argTab[] = {
+
+    { ARGOPT_OPT, "scan2dSys", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The system number of the scan2d module, default 0", { 0 } },
+
+    { ARGOPT_OPT, "scan2dInst", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The instance number of the scan2d module, default 0", { 0 } },
+
+    { ARGOPT_OPT, "scale", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Size of a grid cell in mm, default 100 mm", { 100 } },
+
+    { ARGOPT_OPT, "gridNum", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Number of grid cells per side of the window, default 500", { 500 } },
+
+    { ARGOPT_OPT, "hitProb", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Occupancy probability of a scan point in percent (51 - 99), default 70", { 70 } },
+
+    { ARGOPT_OPT, "missProb", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Occupancy probability of a cell on a ray in percent (1 - 49), default 40", { 40 } },
+
+    { ARGOPT_OPT, "mapOut", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Published map (0 = whole window, 1 = changed tiles only), default 0", { 0 } },
+
+    { ARGOPT_OPT, "mapRefresh", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Every n-th map of mapOut = 1 is the whole window, default 50", { 50 } },
+
+    { 0, "", 0, 0, "", { 0 } } // last entry
+};
+
+/*******************************************************************************
+ *   !!! REALTIME CONTEXT !!!
+ *
+ *   moduleOn,
+ *   moduleOff,
+ *   moduleLoop,
+ *   moduleCommand,
+ *
+ *   own realtime user functions
+ ******************************************************************************/
+ int  GridMap::moduleOn(void)
+{
+    int ret;
+
+    // get dynamic module parameter
+    mapOut     = getInt32Param("mapOut");
+    mapRefresh = getInt32Param("mapRefresh");
+    if (mapRefresh < 1)
+    {
+        mapRefresh = 1;
+    }
+
+    // turn on scan2d module
+    ret = scan2d->on();
+    if (ret)
+    {
+        GDOS_ERROR("Can't turn on Scan2d(%d/%d), code = %d\n",
+                   scan2dSys, scan2dInst, ret);
+        return ret;
+    }
+
+    // get continuous data from scan2d module
+    scan2dDataMbx.clean();
+    ret = scan2d->getContData(0, &scan2dDataMbx, &dataBufferPeriodTime);
+    if (ret)
+    {
+        GDOS_ERROR("Can't get continuous data from Scan2d(%d/%d), code = %d\n",
+                   scan2dSys, scan2dInst, ret);
+        return ret;
+    }
+
+    window.clear();
+    mapNum = 0;
+
+    return RackDataModule::moduleOn(); // has to be last command in moduleOn();
+}
+
+
+void GridMap::moduleOff(void)
+{
+    RackDataModule::moduleOff();        // has to be first command in moduleOff();
+
+    scan2d->stopContData(&scan2dDataMbx);
+}
+
+
+// realtime context
+int  GridMap::moduleLoop(void)
+{
+    int             ret, datalen;
+    RackMessage     msgInfo;
+    grid_map_data*  gridMapData = NULL;
+
+    // get continuous data from scan2d module
+    ret = scan2dDataMbx.recvDataMsgTimed(rackTime.toNano(2 * dataBufferPeriodTime), &scan2dMsg.data,
+                                         sizeof(scan2dMsg), &msgInfo);
+    if (ret)
+    {
+        GDOS_ERROR("Can't read continuous data from Scan2d(%d/%d), code = %d\n",
+                   scan2dSys, scan2dInst, ret);
+        return ret;
+    }
+
+    // invalid data received
+    if (msgInfo.getType() != MSG_DATA ||
+        msgInfo.getSrc()  != scan2d->getDestAdr())
+    {
+        GDOS_ERROR("Received unexpected message from %x to %x, type %d on scan2dDataMbx\n",
+                   msgInfo.getSrc(), msgInfo.getDest(), msgInfo.getType());
+
+        if (msgInfo.getType() > 0)
+        {
+            scan2dDataMbx.sendMsgReply(MSG_ERROR, &msgInfo);
+        }
+        return -ECOMM;
+    }
+
+    // message parsing
+    Scan2dData::parse(&msgInfo);
+
+    // integrate scan
+    window.scroll(scan2dMsg.data.refPos.x, scan2dMsg.data.refPos.y);
+    window.update(&scan2dMsg.data);
+
+    // get datapointer from rackdatabuffer
+    gridMapData = (grid_map_data *)getDataBufferWorkSpace();
+
+    // a changed part follows the last map, a subscriber which missed it
+    // (e.g. by a reduction or a late start) waits for the next whole window
+    if ((mapOut == MAP_OUT_DIRTY) && (mapNum % mapRefresh != 0))
+    {
+        datalen = window.getDirtyMap(gridMapData);
+        gridMapData->baseNum = mapNum - 1;
+    }
+    else
+    {
+        datalen = window.getMap(gridMapData);
+        gridMapData->baseNum = mapNum;
+    }
+    gridMapData->recordingTime = scan2dMsg.data.recordingTime;
+    gridMapData->mapNum        = mapNum;
+    mapNum++;
+
+    GDOS_DBG_DETAIL("recordingTime %i, gridNumX %i, gridNumY %i\n",
+                    gridMapData->recordingTime, gridMapData->gridNumX, gridMapData->gridNumY);
+
+    putDataBufferWorkSpace(datalen);
+
+    return 0;
+}
+
+/*******************************************************************************
+ *   !!! NON REALTIME CONTEXT !!!
+ *
+ *   moduleInit,
+ *   moduleCleanup,
+ *   Constructor,
+ *   Destructor,
+ *   main,
+ *
+ *   own non realtime user functions
+ ******************************************************************************/
+
+// init_flags (for init and cleanup)
+#define INIT_BIT_DATA_MODULE        0
+#define INIT_BIT_MBX_WORK           1
+#define INIT_BIT_MBX_SCAN2D         2
+#define INIT_BIT_PROXY_SCAN2D       3
+
+int  GridMap::moduleInit(void)
+{
+    int ret;
+
+    // call RackDataModule init function (first command in init)
+    ret = RackDataModule::moduleInit();
+    if (ret)
+    {
+        return ret;
+    }
+    initBits.setBit(INIT_BIT_DATA_MODULE);
+
+    //
+    // create mailboxes
+    //
+
+    // work mailbox
+    ret = createMbx(&workMbx, 10, 128,
+                    MBX_IN_KERNELSPACE | MBX_SLOT);
+    if (ret)
+    {
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_MBX_WORK);
+
+    // scan2d mailbox
+    ret = createMbx(&scan2dDataMbx, 2, sizeof(scan2d_data_msg),
+                    MBX_IN_KERNELSPACE | MBX_SLOT);
+    if (ret)
+    {
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_MBX_SCAN2D);
+
+
+    //
+    // create Proxys
+    //
+
+    // scan2d proxy
+    scan2d = new Scan2dProxy(&workMbx, scan2dSys, scan2dInst);
+    if (!scan2d)
+    {
+        ret = -ENOMEM;
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_PROXY_SCAN2D);
+
+    // allocate grid window
+    ret = window.init(gridNum, scale, hitProb, missProb);
+    if (ret)
+    {
+        GDOS_ERROR("Can't allocate grid window %d x %d, scale %d, hitProb %d, "
+                   "missProb %d, code = %d\n", gridNum, gridNum, scale, hitProb,
+                   missProb, ret);
+        goto init_error;
+    }
+
+    return 0;
+
+init_error:
+    moduleCleanup();
+    return ret;
+}
+
+
+void GridMap::moduleCleanup(void)
+{
+    // call RackDataModule cleanup function
+    if (initBits.testAndClearBit(INIT_BIT_DATA_MODULE))
+    {
+        RackDataModule::moduleCleanup();
+    }
+
+    //
+    // free proxies
+    //
+    if (initBits.testAndClearBit(INIT_BIT_PROXY_SCAN2D))
+    {
+        delete scan2d;
+    }
+
+    //
+    // delete mailboxes
+    //
+    if (initBits.testAndClearBit(INIT_BIT_MBX_SCAN2D))
+    {
+        destroyMbx(&scan2dDataMbx);
+    }
+
+    if (initBits.testAndClearBit(INIT_BIT_MBX_WORK))
+    {
+        destroyMbx(&workMbx);
+    }
+}
+
+
+GridMap::GridMap()
+      : RackDataModule( MODULE_CLASS_ID,
+                    5000000000llu,    // 5s datatask error sleep time
+                    16,               // command mailbox slots
+                    48,               // command mailbox data size per slot
+                    MBX_IN_KERNELSPACE | MBX_SLOT,  // command mailbox flags
+                    5,                // max buffer entries
+                    10)               // data buffer listener
+{
+    // get static module parameter
+    scan2dSys   = getIntArg("scan2dSys", argTab);
+    scan2dInst  = getIntArg("scan2dInst", argTab);
+    scale       = getIntArg("scale", argTab);
+    gridNum     = getIntArg("gridNum", argTab);
+    hitProb     = getIntArg("hitProb", argTab);
+    missProb    = getIntArg("missProb", argTab);
+
+    if (gridNum > GRID_MAP_WINDOW_NUM_MAX)
+    {
+        gridNum = GRID_MAP_WINDOW_NUM_MAX;
+    }
+
+    dataBufferMaxDataSize   = sizeof(grid_map_data) + gridNum * gridNum;
+}
+
+
+int  main(int argc, char *argv[])
+{
+    int ret;
+
+    // get args
+    ret = RackModule::getArgs(argc, argv, argTab, "GridMap");
+    if (ret)
+    {
+        printf("Invalid arguments -> EXIT \n");
+        return ret;
+    }
+
+    GridMap *pInst;
+
+    // create new GridMap
+    pInst = new GridMap();
+    if (!pInst)
+    {
+        printf("Can't create new GridMap -> EXIT\n");
+        return -ENOMEM;
+    }
+
+    // init
+    ret = pInst->moduleInit();
+    if (ret)
+        goto exit_error;
+
+    pInst->run();
+    return 0;
+
+exit_error:
+    delete (pInst);
+    return ret;
+}
@@ -0,0 +1,89 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Matthias Hentschel <hentschel@rts.uni-hannover.de>
+ */
+
+#ifndef __GRID_MAP_H__
+#define __GRID_MAP_H__
+
+#include <main/rack_data_module.h>
+
+#include <navigation/grid_map_proxy.h>
+#include <perception/scan2d_proxy.h>
+
+#include "grid_map_window.h"
+
+// define module class
+#define MODULE_CLASS_ID             GRID_MAP
+
+// scan_2d data message (use max message size)
+typedef struct {
+    scan2d_data   data;
+    scan_point    point[SCAN2D_POINT_MAX];
+} __attribute__((packed)) scan2d_data_msg;
+
+/**
+ * Grid Map
+ *
+ * Integrates the scans of a scan2d module at their reference position into
+ * a scrolling log-odds occupancy grid around the robot. Depending on mapOut
+ * the whole window or only its changed part is published. A changed part
+ * has to be merged into the map of baseNum, every mapRefresh-th map is the
+ * whole window again.
+ *
+ * @ingroup modules_grid_map
+ */
+class GridMap : public RackDataModule {
+      private:
+
+        // external module parameter
+        int                 scan2dSys;
+        int                 scan2dInst;
+        int                 scale;
+        int                 gridNum;
+        int                 hitProb;
+        int                 missProb;
+        int                 mapOut;
+        int                 mapRefresh;
+
+        // mailboxes
+        RackMailbox         workMbx;                // communication
+        RackMailbox         scan2dDataMbx;          // scan2d data
+
+        // proxies
+        Scan2dProxy*        scan2d;
+
+        // data structures
+        scan2d_data_msg     scan2dMsg;
+        GridMapWindow       window;
+        int                 mapNum;
+
+      protected:
+        // -> realtime context
+        int      moduleOn(void);
+        int      moduleLoop(void);
+        void     moduleOff(void);
+
+        // -> non realtime context
+        void     moduleCleanup(void);
+
+      public:
+        // constructor und destructor
+        GridMap();
+        ~GridMap() {};
+
+        // -> non realtime context
+        int  moduleInit(void);
+};
+
+#endif // __GRID_MAP_H__
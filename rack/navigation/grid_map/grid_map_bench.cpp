@@ -0,0 +1,151 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Matthias Hentschel <hentschel@rts.uni-hannover.de>
+ */
+#include <tools/datalog/datalog_bin_file.h>
+#include <main/rack_module.h>
+#include <main/argopts.h>
+
+#include "grid_map_window.h"
+
+//
+// Integrates the scan2d data of a binary log (see DatalogRec) into a
+// GridMapWindow and prints the throughput in scans/s together with the
+// size of the whole and of the changed part of the published map.
+//
+
+//
+// data structures
+//
+
+arg_table_t argTab[] = {
+
+    { ARGOPT_REQ, "logFile", ARGOPT_REQVAL, ARGOPT_VAL_STR,
+      "Binary log file recorded by DatalogRec", { 0 } },
+
+    { ARGOPT_OPT, "scan2dInst", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Instance of the scan2d module, default -1 (all)", { -1 } },
+
+    { ARGOPT_OPT, "scale", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Size of a grid cell in mm, default 100 mm", { 100 } },
+
+    { ARGOPT_OPT, "gridNum", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Number of grid cells per side of the window, default 500", { 500 } },
+
+    { ARGOPT_OPT, "loopNum", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Number of passes through the log, default 1", { 1 } },
+
+    { 0, "", 0, 0, "", { 0 } } // last entry
+};
+
+int  main(int argc, char *argv[])
+{
+    RackMessage         msgInfo;
+    RackTime            rackTime;
+    DatalogBinReader    binReader(NULL, 0);
+    GridMapWindow       window;
+    scan2d_data         *scan;
+    grid_map_data       *map;
+    uint64_t            offset, time;
+    uint64_t            updateTime = 0, windowTime = 0, dirtyTime = 0;
+    uint64_t            windowBytes = 0, dirtyBytes = 0, rayNum = 0;
+    uint32_t            scanNum = 0;
+    int                 scan2dInst, gridNum, loop, loopNum, ret;
+
+    // get args
+    ret = RackModule::getArgs(argc, argv, argTab, "GridMapBench");
+    if (ret)
+    {
+        printf("Invalid arguments -> EXIT \n");
+        return ret;
+    }
+
+    scan2dInst = getIntArg("scan2dInst", argTab);
+    gridNum    = getIntArg("gridNum", argTab);
+    loopNum    = getIntArg("loopNum", argTab);
+
+    ret = window.init(gridNum, getIntArg("scale", argTab), 70, 40);
+    if (ret)
+    {
+        printf("Can't allocate grid window, code = %d\n", ret);
+        return ret;
+    }
+
+    ret = binReader.open(getStrArg("logFile", argTab));
+    if (ret)
+    {
+        printf("Can't open binary log %s, code = %d\n", getStrArg("logFile", argTab), ret);
+        return ret;
+    }
+
+    scan = (scan2d_data *)malloc(sizeof(scan2d_data) + SCAN2D_POINT_MAX * sizeof(scan_point));
+    map  = (grid_map_data *)malloc(sizeof(grid_map_data) + gridNum * gridNum);
+    if (!scan || !map)
+    {
+        printf("Can't allocate buffers -> EXIT\n");
+        return -ENOMEM;
+    }
+
+    for (loop = 0; loop < loopNum; loop++)
+    {
+        window.clear();
+
+        offset = binReader.first();
+        while (!binReader.getData(&offset, SCAN2D, scan2dInst, sizeof(scan2d_data),
+                                  sizeof(scan2d_data) + SCAN2D_POINT_MAX * sizeof(scan_point),
+                                  scan, &msgInfo))
+        {
+            Scan2dData::parse(&msgInfo);
+
+            time = rackTime.getNano();
+            window.scroll(scan->refPos.x, scan->refPos.y);
+            rayNum     += window.update(scan);
+            updateTime += rackTime.getNano() - time;
+
+            // dirty map first, getMap() resets the dirty tiles
+            time = rackTime.getNano();
+            dirtyBytes += window.getDirtyMap(map);
+            dirtyTime  += rackTime.getNano() - time;
+
+            time = rackTime.getNano();
+            windowBytes += window.getMap(map);
+            windowTime  += rackTime.getNano() - time;
+
+            scanNum++;
+        }
+    }
+
+    if ((scanNum > 0) && (updateTime > 0))
+    {
+        printf("%d scans, %d rays, window %d x %d cells\n",
+               scanNum, (int)rayNum, gridNum, gridNum);
+        printf("update:       %10.1f scans/s, %8.3f ms/scan\n",
+               1000000000.0 * scanNum / updateTime,
+               (double)updateTime / 1000000.0 / scanNum);
+        printf("whole window: %10.1f maps/s,  %8d bytes/map\n",
+               1000000000.0 * scanNum / (windowTime ? windowTime : 1),
+               (int)(windowBytes / scanNum));
+        printf("dirty tiles:  %10.1f maps/s,  %8d bytes/map\n",
+               1000000000.0 * scanNum / (dirtyTime ? dirtyTime : 1),
+               (int)(dirtyBytes / scanNum));
+    }
+    else
+    {
+        printf("No scan2d data in %s\n", getStrArg("logFile", argTab));
+    }
+
+    free(map);
+    free(scan);
+    binReader.close();
+    return 0;
+}
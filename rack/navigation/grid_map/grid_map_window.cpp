@@ -0,0 +1,397 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Matthias Hentschel <hentschel@rts.uni-hannover.de>
+ */
+
+#include "grid_map_window.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+// floor(a / b) for b > 0
+static inline int floorDiv(int a, int b)
+{
+    if (a >= 0)
+        return a / b;
+    else
+        return -((-a + b - 1) / b);
+}
+
+GridMapWindow::GridMapWindow()
+{
+    gridNum = 0;
+    scale   = 0;
+    cell    = NULL;
+    tileNum = 0;
+}
+
+GridMapWindow::~GridMapWindow()
+{
+    if (cell)
+        delete[] cell;
+}
+
+/**
+ * Allocates the window
+ *
+ * @param gridNum   Number of cells per side (max. GRID_MAP_WINDOW_NUM_MAX)
+ * @param scale     Cell size in mm
+ * @param hitProb   Occupancy probability of a scan point in percent
+ * @param missProb  Occupancy probability of a cell on the ray in percent
+ *
+ * @return 0 on success, otherwise negative error code
+ */
+int GridMapWindow::init(int gridNum, int scale, int hitProb, int missProb)
+{
+    int     i;
+    double  p;
+
+    if ((gridNum <= 0) || (gridNum > GRID_MAP_WINDOW_NUM_MAX) || (scale <= 0) ||
+        (hitProb <= 50) || (hitProb >= 100) || (missProb <= 0) || (missProb >= 50))
+    {
+        return -EINVAL;
+    }
+
+    if (cell)
+        delete[] cell;
+
+    cell = new int16_t[gridNum * gridNum];
+    if (!cell)
+        return -ENOMEM;
+
+    this->gridNum = gridNum;
+    this->scale   = scale;
+    tileNum       = (gridNum + GRID_MAP_TILE_SIZE - 1) / GRID_MAP_TILE_SIZE;
+
+    logOddsHit  = (int16_t)rint(100.0 * log((double)hitProb / (double)(100 - hitProb)));
+    logOddsMiss = (int16_t)rint(100.0 * log((double)missProb / (double)(100 - missProb)));
+
+    for (i = -GRID_MAP_LOG_ODDS_MAX; i <= GRID_MAP_LOG_ODDS_MAX; i++)
+    {
+        p = 1.0 / (1.0 + exp(-(double)i / 100.0));
+        occupancyTab[i + GRID_MAP_LOG_ODDS_MAX] = (uint8_t)rint(255.0 * p);
+    }
+
+    clear();
+    return 0;
+}
+
+/**
+ * Resets all cells to unknown, the window is centered at (0, 0)
+ */
+void GridMapWindow::clear(void)
+{
+    memset(cell, 0, gridNum * gridNum * sizeof(int16_t));
+
+    originX = -gridNum / 2;
+    originY = -gridNum / 2;
+    ringX   = 0;
+    ringY   = 0;
+
+    memset(tileDirty, 1, sizeof(tileDirty));
+}
+
+/**
+ * Moves the window with the robot
+ *
+ * The window is moved if the robot is more than a quarter of the window
+ * away from its center. The cells which leave the window are cleared, the
+ * whole window is marked dirty.
+ *
+ * @param x Global x-position of the robot in mm
+ * @param y Global y-position of the robot in mm
+ */
+void GridMapWindow::scroll(int x, int y)
+{
+    int cx, cy, dx, dy;
+
+    cx = floorDiv(x, scale);
+    cy = floorDiv(y, scale);
+    dx = cx - gridNum / 2 - originX;
+    dy = cy - gridNum / 2 - originY;
+
+    if ((abs(dx) <= gridNum / 4) && (abs(dy) <= gridNum / 4))
+        return;
+
+    if ((abs(dx) >= gridNum) || (abs(dy) >= gridNum))
+    {
+        clear();
+        originX = cx - gridNum / 2;
+        originY = cy - gridNum / 2;
+        return;
+    }
+
+    // reuse the ring columns and rows of the cells leaving the window
+    if (dx > 0)
+        clearColumns(originX, originX + dx - 1);
+    else if (dx < 0)
+        clearColumns(originX + gridNum + dx, originX + gridNum - 1);
+
+    originX += dx;
+    ringX    = (ringX + dx + gridNum) % gridNum;
+
+    if (dy > 0)
+        clearRows(originY, originY + dy - 1);
+    else if (dy < 0)
+        clearRows(originY + gridNum + dy, originY + gridNum - 1);
+
+    originY += dy;
+    ringY    = (ringY + dy + gridNum) % gridNum;
+
+    memset(tileDirty, 1, sizeof(tileDirty));
+}
+
+inline void GridMapWindow::updateCell(int cx, int cy, int16_t logOdds)
+{
+    int     wx, wy, rx, ry, v;
+    int16_t *p_cell;
+
+    wx = cx - originX;
+    wy = cy - originY;
+    if (((unsigned int)wx >= (unsigned int)gridNum) ||
+        ((unsigned int)wy >= (unsigned int)gridNum))
+        return;
+
+    rx = ringX + wx;
+    if (rx >= gridNum)
+        rx -= gridNum;
+    ry = ringY + wy;
+    if (ry >= gridNum)
+        ry -= gridNum;
+
+    p_cell = &cell[rx * gridNum + ry];
+    v      = *p_cell + logOdds;
+    if (v > GRID_MAP_LOG_ODDS_MAX)
+        v = GRID_MAP_LOG_ODDS_MAX;
+    if (v < -GRID_MAP_LOG_ODDS_MAX)
+        v = -GRID_MAP_LOG_ODDS_MAX;
+
+    if (v != *p_cell)
+    {
+        *p_cell = v;
+        tileDirty[(wx / GRID_MAP_TILE_SIZE) * tileNum + wy / GRID_MAP_TILE_SIZE] = 1;
+    }
+}
+
+/**
+ * Integrates a scan into the window
+ *
+ * The scan points are transformed by the reference position of the scan.
+ * Invalid points are ignored, max range points only clear their ray.
+ *
+ * @return Number of integrated rays
+ */
+int GridMapWindow::update(scan2d_data *scan)
+{
+    int     i, rayNum;
+    int     x0, y0, x1, y1, x, y;
+    int     dx, dy, sx, sy, err, e2;
+    float   sinRho, cosRho;
+
+    sinRho = sinf(scan->refPos.rho);
+    cosRho = cosf(scan->refPos.rho);
+    x0     = floorDiv(scan->refPos.x, scale);
+    y0     = floorDiv(scan->refPos.y, scale);
+    rayNum = 0;
+
+    for (i = 0; i < scan->pointNum; i++)
+    {
+        if (scan->point[i].type & SCAN_POINT_TYPE_INVALID)
+            continue;
+
+        x1 = floorDiv(scan->refPos.x + (int)(scan->point[i].x * cosRho -
+                                             scan->point[i].y * sinRho), scale);
+        y1 = floorDiv(scan->refPos.y + (int)(scan->point[i].x * sinRho +
+                                             scan->point[i].y * cosRho), scale);
+
+        // free cells of the ray (Bresenham)
+        dx  =  abs(x1 - x0);
+        dy  = -abs(y1 - y0);
+        sx  = (x0 < x1) ? 1 : -1;
+        sy  = (y0 < y1) ? 1 : -1;
+        err = dx + dy;
+        x   = x0;
+        y   = y0;
+
+        while ((x != x1) || (y != y1))
+        {
+            updateCell(x, y, logOddsMiss);
+
+            e2 = 2 * err;
+            if (e2 >= dy)
+            {
+                err += dy;
+                x   += sx;
+            }
+            if (e2 <= dx)
+            {
+                err += dx;
+                y   += sy;
+            }
+        }
+
+        // occupied end cell
+        if (!(scan->point[i].type & SCAN_POINT_TYPE_MAX_RANGE))
+            updateCell(x1, y1, logOddsHit);
+
+        rayNum++;
+    }
+
+    return rayNum;
+}
+
+/**
+ * Copies the whole window
+ *
+ * @param data Grid map data with space for getGridNum()^2 cells
+ *
+ * @return Data length of the grid map message
+ */
+int GridMapWindow::getMap(grid_map_data *data)
+{
+    copyRegion(data, 0, 0, gridNum, gridNum);
+
+    memset(tileDirty, 0, sizeof(tileDirty));
+
+    return sizeof(grid_map_data) + gridNum * gridNum;
+}
+
+/**
+ * Copies the changed part of the window
+ *
+ * The result is the bounding box of all tiles changed since the last
+ * getMap() or getDirtyMap(). Its cell[0,0] is at (offsetX, offsetY), a
+ * subscriber merges it into its own copy of the map. Without changes the
+ * result has no cells.
+ *
+ * @return Data length of the grid map message
+ */
+int GridMapWindow::getDirtyMap(grid_map_data *data)
+{
+    int tx, ty, tx0, ty0, tx1, ty1;
+    int wx0, wy0, wx1, wy1;
+
+    tx0 = tileNum;
+    ty0 = tileNum;
+    tx1 = -1;
+    ty1 = -1;
+
+    for (tx = 0; tx < tileNum; tx++)
+    {
+        for (ty = 0; ty < tileNum; ty++)
+        {
+            if (tileDirty[tx * tileNum + ty])
+            {
+                if (tx < tx0)
+                    tx0 = tx;
+                if (tx > tx1)
+                    tx1 = tx;
+                if (ty < ty0)
+                    ty0 = ty;
+                if (ty > ty1)
+                    ty1 = ty;
+            }
+        }
+    }
+
+    if (tx1 < 0)
+    {
+        copyRegion(data, 0, 0, 0, 0);
+        return sizeof(grid_map_data);
+    }
+
+    wx0 = tx0 * GRID_MAP_TILE_SIZE;
+    wy0 = ty0 * GRID_MAP_TILE_SIZE;
+    wx1 = (tx1 + 1) * GRID_MAP_TILE_SIZE;
+    wy1 = (ty1 + 1) * GRID_MAP_TILE_SIZE;
+    if (wx1 > gridNum)
+        wx1 = gridNum;
+    if (wy1 > gridNum)
+        wy1 = gridNum;
+
+    copyRegion(data, wx0, wy0, wx1 - wx0, wy1 - wy0);
+
+    memset(tileDirty, 0, sizeof(tileDirty));
+
+    return sizeof(grid_map_data) + (wx1 - wx0) * (wy1 - wy0);
+}
+
+void GridMapWindow::clearColumns(int cx0, int cx1)
+{
+    int cx, rx;
+
+    for (cx = cx0; cx <= cx1; cx++)
+    {
+        rx = ringX + cx - originX;
+        if (rx >= gridNum)
+            rx -= gridNum;
+
+        memset(&cell[rx * gridNum], 0, gridNum * sizeof(int16_t));
+    }
+}
+
+void GridMapWindow::clearRows(int cy0, int cy1)
+{
+    int cy, rx, ry;
+
+    for (cy = cy0; cy <= cy1; cy++)
+    {
+        ry = ringY + cy - originY;
+        if (ry >= gridNum)
+            ry -= gridNum;
+
+        for (rx = 0; rx < gridNum; rx++)
+        {
+            cell[rx * gridNum + ry] = 0;
+        }
+    }
+}
+
+// copies a region of the window (window coordinates) into a grid map message
+void GridMapWindow::copyRegion(grid_map_data *data, int wx0, int wy0, int numX, int numY)
+{
+    int     i, j, rx, ry;
+    int16_t *p_cell;
+    uint8_t *p_out;
+    uint8_t *p_tab = &occupancyTab[GRID_MAP_LOG_ODDS_MAX];
+
+    data->offsetX  = (originX + wx0) * scale;
+    data->offsetY  = (originY + wy0) * scale;
+    data->scale    = scale;
+    data->gridNumX = numX;
+    data->gridNumY = numY;
+
+    p_out = data->occupancy;
+
+    for (i = 0; i < numX; i++)
+    {
+        rx = ringX + wx0 + i;
+        if (rx >= gridNum)
+            rx -= gridNum;
+
+        p_cell = &cell[rx * gridNum];
+        ry     = ringY + wy0;
+        if (ry >= gridNum)
+            ry -= gridNum;
+
+        for (j = 0; j < numY; j++)
+        {
+            *p_out++ = p_tab[p_cell[ry]];
+
+            if (++ry >= gridNum)
+                ry = 0;
+        }
+    }
+}
@@ -0,0 +1,77 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Matthias Hentschel <hentschel@rts.uni-hannover.de>
+ */
+
+#ifndef __GRID_MAP_WINDOW_H__
+#define __GRID_MAP_WINDOW_H__
+
+#include <navigation/grid_map_proxy.h>
+#include <perception/scan2d_proxy.h>
+
+#define GRID_MAP_WINDOW_NUM_MAX     500             // cells per side
+#define GRID_MAP_TILE_SIZE          32              // cells per side of a dirty tile
+#define GRID_MAP_TILE_NUM_MAX       ((GRID_MAP_WINDOW_NUM_MAX + GRID_MAP_TILE_SIZE - 1) / \
+                                     GRID_MAP_TILE_SIZE)
+#define GRID_MAP_LOG_ODDS_MAX       500             // log-odds * 100, p = 0.993
+
+/**
+ * Scrolling log-odds occupancy grid
+ *
+ * The window of gridNum x gridNum cells is stored as a ring buffer in global
+ * cell coordinates and follows the robot in steps of whole cells, so memory
+ * is bounded and scrolling only clears the cells that leave the window.
+ * Every scan point updates the cells of its ray (Bresenham) as free and its
+ * end cell as occupied. Changed cells mark their tile dirty.
+ */
+class GridMapWindow
+{
+    private:
+        int         gridNum;
+        int         scale;
+        int16_t     logOddsHit;
+        int16_t     logOddsMiss;
+
+        int16_t     *cell;                  // log-odds * 100, ring buffer
+        int         originX;                // global cell index of the window
+        int         originY;
+        int         ringX;                  // ring index of the window origin
+        int         ringY;
+
+        int         tileNum;
+        uint8_t     tileDirty[GRID_MAP_TILE_NUM_MAX * GRID_MAP_TILE_NUM_MAX];
+        uint8_t     occupancyTab[2 * GRID_MAP_LOG_ODDS_MAX + 1];
+
+        inline void updateCell(int cx, int cy, int16_t logOdds);
+        void        clearColumns(int cx0, int cx1);
+        void        clearRows(int cy0, int cy1);
+        void        copyRegion(grid_map_data *data, int wx0, int wy0, int numX, int numY);
+
+    public:
+        GridMapWindow();
+        ~GridMapWindow();
+
+        int  init(int gridNum, int scale, int hitProb, int missProb);
+        void clear(void);
+        void scroll(int x, int y);
+        int  update(scan2d_data *scan);
+        int  getMap(grid_map_data *data);
+        int  getDirtyMap(grid_map_data *data);
+
+        int  getGridNum(void)
+        {
+            return gridNum;
+        }
+};
+
+#endif // __GRID_MAP_WINDOW_H__
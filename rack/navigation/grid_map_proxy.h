@@ -33,6 +33,9 @@ typedef struct {
     int32_t     scale;                      /**< [mm/cell] scale of the map */
     int32_t     gridNumX;                   /**< number of following cells in x-direction */
     int32_t     gridNumY;                   /**< number of following cells in y-direction */
+    int32_t     mapNum;                     /**< number of the map, increased by one per map */
+    int32_t     baseNum;                    /**< mapNum of the map this sub-grid is merged into,
+                                                 equal to mapNum for a complete map */
     uint8_t     occupancy[0];               /**< list of grid cells,
                                                  obstacle propability 0 - free, 255 - occupied */
 } __attribute__((packed)) grid_map_data;
@@ -48,6 +51,8 @@ class GridMapData
             data->scale         = __le32_to_cpu(data->scale);
             data->gridNumX      = __le32_to_cpu(data->gridNumX);
             data->gridNumY      = __le32_to_cpu(data->gridNumY);
+            data->mapNum        = __le32_to_cpu(data->mapNum);
+            data->baseNum       = __le32_to_cpu(data->baseNum);
         }
 
         static void be_to_cpu(grid_map_data *data)
@@ -58,6 +63,8 @@ class GridMapData
             data->scale         = __be32_to_cpu(data->scale);
             data->gridNumX      = __be32_to_cpu(data->gridNumX);
             data->gridNumY      = __be32_to_cpu(data->gridNumY);
+            data->mapNum        = __be32_to_cpu(data->mapNum);
+            data->baseNum       = __be32_to_cpu(data->baseNum);
         }
 
         static grid_map_data* parse(RackMessage *msgInfo)
@@ -67,6 +74,11 @@ class GridMapData
 
             grid_map_data *p_data = (grid_map_data *)msgInfo->p_data;
 
+            if (msgInfo->isDataByteorderCpu()) // data in cpu byteorder
+            {
+                return p_data;
+            }
+
             if (msgInfo->isDataByteorderLe()) // data in little endian
             {
                 le_to_cpu(p_data);
@@ -0,0 +1,711 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Matthias Hentschel <hentschel@rts.uni-hannover.de>
+ */
+
+#include "mcl.h"
+
+#include <main/angle_tool.h>
+
+//
+// data structures
+//
+
+// external module parameter
+arg_table_t argTab[] = {
+
+    { ARGOPT_OPT, "scan2dSys", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The system number of the scan2d module, default 0", { 0 } },
+
+    { ARGOPT_OPT, "scan2dInst", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The instance number of the scan2d module, default 0", { 0 } },
+
+    { ARGOPT_OPT, "odometrySys", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The system number of the odometry module, default 0", { 0 } },
+
+    { ARGOPT_OPT, "odometryInst", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The instance number of the odometry module, default 0", { 0 } },
+
+    { ARGOPT_OPT, "positionSys", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The system number of the position module, default 0", { 0 } },
+
+    { ARGOPT_OPT, "positionInst", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The instance number of the position module, default 0", { 0 } },
+
+    { ARGOPT_OPT, "workerNum", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Number of particle evaluation worker tasks, default 2", { 2 } },
+
+    { ARGOPT_OPT, "mapFile", ARGOPT_REQVAL, ARGOPT_VAL_STR,
+      "filename of the DXF map, if none is loaded by MSG_MCL_LOAD_MAP", { 0 } },
+
+    { ARGOPT_OPT, "mapScaleFactor", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "map scale factor", { 1000 } },
+
+    { ARGOPT_OPT, "mapOffsetX", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "mapOffsetX for DXF maps in GK coordinates", { 0 } },
+
+    { ARGOPT_OPT, "mapOffsetY", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "mapOffsetY for DXF maps in GK coordinates", { 0 } },
+
+    { ARGOPT_OPT, "fieldScale", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Cell size of the likelihood field in mm, default 50 mm", { 50 } },
+
+    { ARGOPT_OPT, "sigma", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Standard deviation of the scan points in mm, default 150 mm", { 150 } },
+
+    { ARGOPT_OPT, "distMax", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Maximum distance to the map in mm, default 2000 mm", { 2000 } },
+
+    { ARGOPT_OPT, "particleMin", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Minimum number of particles, default 300", { 300 } },
+
+    { ARGOPT_OPT, "particleMax", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Maximum number of particles, default 5000", { 5000 } },
+
+    { ARGOPT_OPT, "kldError", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Maximum error of the KLD sampling in percent, default 5", { 5 } },
+
+    { ARGOPT_OPT, "kldBinXY", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Bin size of the KLD sampling in mm, default 500 mm", { 500 } },
+
+    { ARGOPT_OPT, "kldBinRho", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Bin size of the KLD sampling in deg, default 10 deg", { 10 } },
+
+    { ARGOPT_OPT, "transNoise", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Odometry noise per moved distance in percent, default 10", { 10 } },
+
+    { ARGOPT_OPT, "rotNoise", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Odometry noise per rotated angle in percent, default 10", { 10 } },
+
+    { ARGOPT_OPT, "beamStep", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Use every n-th scan point, default 2", { 2 } },
+
+    { ARGOPT_OPT, "beamWeight", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Weight of the log-likelihood of a scan point in percent, default 10", { 10 } },
+
+    { ARGOPT_OPT, "initStdXY", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Standard deviation of the initial particles in mm, default 500 mm", { 500 } },
+
+    { ARGOPT_OPT, "initStdRho", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Standard deviation of the initial particles in deg, default 10 deg", { 10 } },
+
+    { ARGOPT_OPT, "updateDist", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Moved distance between two filter updates in mm, default 200 mm", { 200 } },
+
+    { ARGOPT_OPT, "updateAngle", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Rotated angle between two filter updates in deg, default 5 deg", { 5 } },
+
+    { ARGOPT_OPT, "positionUpdate", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Send the estimated position to the position module (0 = off, 1 = on), default 1", { 1 } },
+
+    { ARGOPT_OPT, "updateStdMax", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Maximum standard deviation of a position update in mm, default 300 mm", { 300 } },
+
+    { 0, "", 0, 0, "", { 0 } } // last entry
+};
+
+/*******************************************************************************
+ *   !!! REALTIME CONTEXT !!!
+ *
+ *   moduleOn,
+ *   moduleOff,
+ *   moduleLoop,
+ *   moduleCommand,
+ *
+ *   own realtime user functions
+ ******************************************************************************/
+ int  Mcl::moduleOn(void)
+{
+    int ret;
+
+    // get dynamic module parameter
+    mapFile        = getStringParam("mapFile");
+    mapScaleFactor = getInt32Param("mapScaleFactor");
+    mapOffsetX     = getInt32Param("mapOffsetX");
+    mapOffsetY     = getInt32Param("mapOffsetY");
+    fieldScale     = getInt32Param("fieldScale");
+    sigma          = getInt32Param("sigma");
+    distMax        = getInt32Param("distMax");
+    beamStep       = getInt32Param("beamStep");
+    updateDist     = (float)getInt32Param("updateDist");
+    updateAngle    = (float)getInt32Param("updateAngle") * M_PI / 180.0f;
+    positionUpdate = getInt32Param("positionUpdate");
+    updateStdMax   = getInt32Param("updateStdMax");
+
+    filter.setParam(getInt32Param("particleMin"),
+                    getInt32Param("particleMax"),
+                    (float)getInt32Param("kldError") / 100.0f,
+                    (float)getInt32Param("kldBinXY"),
+                    (float)getInt32Param("kldBinRho") * M_PI / 180.0f,
+                    (float)getInt32Param("transNoise") / 100.0f,
+                    (float)getInt32Param("rotNoise") / 100.0f,
+                    (float)getInt32Param("beamWeight") / 100.0f);
+
+    // load map, if there is none of MSG_MCL_LOAD_MAP
+    if ((dxfMap.featureNum == 0) && mapFile)
+    {
+        ret = loadMap(mapFile);
+        if (ret)
+        {
+            return ret;
+        }
+    }
+
+    if (dxfMap.featureNum == 0)
+    {
+        GDOS_ERROR("No DXF map\n");
+        return -EINVAL;
+    }
+
+    // turn on odometry module
+    ret = odometry->on();
+    if (ret)
+    {
+        GDOS_ERROR("Can't turn on Odometry(%d/%d), code = %d\n",
+                   odometrySys, odometryInst, ret);
+        return ret;
+    }
+
+    // turn on position module
+    ret = position->on();
+    if (ret)
+    {
+        GDOS_ERROR("Can't turn on Position(%d/%d), code = %d\n",
+                   positionSys, positionInst, ret);
+        return ret;
+    }
+
+    // initial particles around the actual position
+    ret = position->getData(&positionData, sizeof(position_data), 0);
+    if (ret)
+    {
+        GDOS_ERROR("Can't get data from Position(%d/%d), code = %d\n",
+                   positionSys, positionInst, ret);
+        return ret;
+    }
+
+    filter.init(&positionData.pos, (float)getInt32Param("initStdXY"),
+                (float)getInt32Param("initStdRho") * M_PI / 180.0f);
+    odometryOld.recordingTime = 0;
+
+    // turn on scan2d module
+    ret = scan2d->on();
+    if (ret)
+    {
+        GDOS_ERROR("Can't turn on Scan2d(%d/%d), code = %d\n",
+                   scan2dSys, scan2dInst, ret);
+        return ret;
+    }
+
+    // get continuous data from scan2d module
+    scan2dDataMbx.clean();
+    ret = scan2d->getContData(0, &scan2dDataMbx, &dataBufferPeriodTime);
+    if (ret)
+    {
+        GDOS_ERROR("Can't get continuous data from Scan2d(%d/%d), code = %d\n",
+                   scan2dSys, scan2dInst, ret);
+        return ret;
+    }
+
+    GDOS_PRINT("Localising with %d particles and %d worker tasks\n",
+               filter.getParticleNum(), filter.getWorkerNum());
+
+    return RackDataModule::moduleOn(); // has to be last command in moduleOn();
+}
+
+
+void Mcl::moduleOff(void)
+{
+    RackDataModule::moduleOff();        // has to be first command in moduleOff();
+
+    scan2d->stopContData(&scan2dDataMbx);
+}
+
+
+// realtime context
+int  Mcl::moduleLoop(void)
+{
+    int             i, step, ret, update;
+    float           dx, dy, dRho, sinRho, cosRho;
+    RackMessage     msgInfo;
+    mcl_data*       mclData = NULL;
+    mcl_particle*   p;
+
+    // get continuous data from scan2d module
+    ret = scan2dDataMbx.recvDataMsgTimed(rackTime.toNano(2 * dataBufferPeriodTime), &scan2dMsg.data,
+                                         sizeof(scan2dMsg), &msgInfo);
+    if (ret)
+    {
+        GDOS_ERROR("Can't read continuous data from Scan2d(%d/%d), code = %d\n",
+                   scan2dSys, scan2dInst, ret);
+        return ret;
+    }
+
+    // invalid data received
+    if (msgInfo.getType() != MSG_DATA ||
+        msgInfo.getSrc()  != scan2d->getDestAdr())
+    {
+        GDOS_ERROR("Received unexpected message from %x to %x, type %d on scan2dDataMbx\n",
+                   msgInfo.getSrc(), msgInfo.getDest(), msgInfo.getType());
+
+        if (msgInfo.getType() > 0)
+        {
+            scan2dDataMbx.sendMsgReply(MSG_ERROR, &msgInfo);
+        }
+        return -ECOMM;
+    }
+
+    // message parsing
+    Scan2dData::parse(&msgInfo);
+
+    // get odometry at the time of the scan
+    ret = odometry->getData(&odometryData, sizeof(odometry_data), scan2dMsg.data.recordingTime);
+    if (ret)
+    {
+        GDOS_ERROR("Can't get data from Odometry(%d/%d), code = %d\n",
+                   odometrySys, odometryInst, ret);
+        return ret;
+    }
+
+    // update the filter after a minimum movement
+    update = 0;
+    if (odometryOld.recordingTime == 0)
+    {
+        memcpy(&odometryOld, &odometryData, sizeof(odometry_data));
+    }
+    else
+    {
+        dx   = (float)(odometryData.pos.x - odometryOld.pos.x);
+        dy   = (float)(odometryData.pos.y - odometryOld.pos.y);
+        dRho = normaliseAngleSym0(odometryData.pos.rho - odometryOld.pos.rho);
+
+        if ((sqrtf(dx * dx + dy * dy) >= updateDist) || (fabsf(dRho) >= updateAngle))
+        {
+            update = 1;
+        }
+    }
+
+    filterMtx.lock(RACK_INFINITE);
+
+    if (update)
+    {
+        filter.move(&odometryOld.pos, &odometryData.pos);
+        memcpy(&odometryOld, &odometryData, sizeof(odometry_data));
+
+        if (filter.setScan(&scan2dMsg.data, beamStep) > 0)
+        {
+            filter.evaluate();
+        }
+    }
+
+    filter.estimate(&positionData.pos, &positionData.var);
+    positionData.recordingTime = scan2dMsg.data.recordingTime;
+
+    if (update)
+    {
+        filter.resample();
+    }
+
+    // get datapointer from rackdatabuffer
+    mclData = (mcl_data *)getDataBufferWorkSpace();
+
+    mclData->recordingTime = scan2dMsg.data.recordingTime;
+    memcpy(&mclData->pos, &positionData.pos, sizeof(position_3d));
+    mclData->pointNum      = 0;
+
+    // every n-th particle
+    step = filter.getParticleNum() / (MCL_DATA_POINT_MAX / 2) + 1;
+    for (i = 0; i < filter.getParticleNum(); i += step)
+    {
+        p = filter.getParticle(i);
+        mclData->point[mclData->pointNum].x     = (int32_t)p->x;
+        mclData->point[mclData->pointNum].y     = (int32_t)p->y;
+        mclData->point[mclData->pointNum].z     = 0;
+        mclData->point[mclData->pointNum].type  = MCL_TYPE_SAMPLE;
+        mclData->point[mclData->pointNum].layer = 0;
+        mclData->pointNum++;
+    }
+
+    filterMtx.unlock();
+
+    // scan at the estimated position
+    sinRho = sinf(positionData.pos.rho);
+    cosRho = cosf(positionData.pos.rho);
+    for (i = 0; (i < scan2dMsg.data.pointNum) && (mclData->pointNum < MCL_DATA_POINT_MAX);
+         i += beamStep)
+    {
+        if (scan2dMsg.data.point[i].type & SCAN_POINT_TYPE_INVALID)
+            continue;
+
+        mclData->point[mclData->pointNum].x     = positionData.pos.x +
+                                                  (int32_t)(scan2dMsg.data.point[i].x * cosRho -
+                                                            scan2dMsg.data.point[i].y * sinRho);
+        mclData->point[mclData->pointNum].y     = positionData.pos.y +
+                                                  (int32_t)(scan2dMsg.data.point[i].x * sinRho +
+                                                            scan2dMsg.data.point[i].y * cosRho);
+        mclData->point[mclData->pointNum].z     = scan2dMsg.data.point[i].z;
+        mclData->point[mclData->pointNum].type  = MCL_TYPE_MEASUREMENT;
+        mclData->point[mclData->pointNum].layer = 0;
+        mclData->pointNum++;
+    }
+
+    putDataBufferWorkSpace(sizeof(mcl_data) + mclData->pointNum * sizeof(mcl_data_point));
+
+    // position update
+    if (update && positionUpdate &&
+        (positionData.var.x <= updateStdMax) && (positionData.var.y <= updateStdMax))
+    {
+        ret = position->update(&positionData);
+        if (ret)
+        {
+            GDOS_WARNING("Can't send update to Position(%d/%d), code = %d\n",
+                         positionSys, positionInst, ret);
+        }
+    }
+
+    return 0;
+}
+
+int  Mcl::moduleCommand(RackMessage *msgInfo)
+{
+    mcl_filename    *pFilename;
+    char            filename[129];
+    int             len, ret;
+
+    switch(msgInfo->getType())
+    {
+        case MSG_MCL_LOAD_MAP:
+            pFilename = MCLFilename::parse(msgInfo);
+
+            len = pFilename->filenameLen;
+            if ((len < 0) || (len > 128))
+                len = 128;
+            memcpy(filename, pFilename->filename, len);
+            filename[len] = 0;
+
+            ret = loadMap(filename);
+            if (ret)
+            {
+                cmdMbx.sendMsgReply(MSG_ERROR, msgInfo);
+                break;
+            }
+
+            cmdMbx.sendMsgReply(MSG_OK, msgInfo);
+            break;
+
+        default:
+            // not for me -> ask RackDataModule
+            return RackDataModule::moduleCommand(msgInfo);
+      }
+      return 0;
+}
+
+// loads a DXF map and computes its likelihood field
+int  Mcl::loadMap(char *filename)
+{
+    int ret;
+
+    if (!filename)
+    {
+        GDOS_ERROR("No DXF map\n");
+        return -EINVAL;
+    }
+
+    RackTask::disableRealtimeMode();
+
+    filterMtx.lock(RACK_INFINITE);
+
+    ret = dxfMap.load(filename, mapOffsetX, mapOffsetY, mapScaleFactor);
+    if (ret)
+    {
+        filterMtx.unlock();
+        RackTask::enableRealtimeMode();
+        GDOS_ERROR("Can't load DXF map %s, code = %d\n", filename, ret);
+        return ret;
+    }
+
+    ret = filter.loadMap(&dxfMap, fieldScale, sigma, distMax);
+
+    filterMtx.unlock();
+    RackTask::enableRealtimeMode();
+
+    if (ret)
+    {
+        GDOS_ERROR("Can't compute likelihood field of %s, code = %d\n", filename, ret);
+        return ret;
+    }
+
+    GDOS_PRINT("Using DXF map %s with %d features\n", filename, dxfMap.featureNum);
+    return 0;
+}
+
+/*******************************************************************************
+ *   !!! NON REALTIME CONTEXT !!!
+ *
+ *   moduleInit,
+ *   moduleCleanup,
+ *   Constructor,
+ *   Destructor,
+ *   main,
+ *
+ *   own non realtime user functions
+ ******************************************************************************/
+
+// init_flags (for init and cleanup)
+#define INIT_BIT_DATA_MODULE        0
+#define INIT_BIT_MBX_WORK           1
+#define INIT_BIT_MBX_SCAN2D         2
+#define INIT_BIT_PROXY_SCAN2D       3
+#define INIT_BIT_PROXY_ODOMETRY     4
+#define INIT_BIT_PROXY_POSITION     5
+#define INIT_BIT_MTX_FILTER         6
+#define INIT_BIT_WORKER             7
+#define INIT_BIT_MBX_WORKER         8
+
+int  Mcl::moduleInit(void)
+{
+    int ret;
+
+    // call RackDataModule init function (first command in init)
+    ret = RackDataModule::moduleInit();
+    if (ret)
+    {
+        return ret;
+    }
+    initBits.setBit(INIT_BIT_DATA_MODULE);
+
+    //
+    // create mailboxes
+    //
+
+    // work mailbox
+    ret = createMbx(&workMbx, 10, sizeof(position_data),
+                    MBX_IN_KERNELSPACE | MBX_SLOT);
+    if (ret)
+    {
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_MBX_WORK);
+
+    // scan2d mailbox
+    ret = createMbx(&scan2dDataMbx, 2, sizeof(scan2d_data_msg),
+                    MBX_IN_KERNELSPACE | MBX_SLOT);
+    if (ret)
+    {
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_MBX_SCAN2D);
+
+
+    //
+    // create Proxys
+    //
+
+    // scan2d proxy
+    scan2d = new Scan2dProxy(&workMbx, scan2dSys, scan2dInst);
+    if (!scan2d)
+    {
+        ret = -ENOMEM;
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_PROXY_SCAN2D);
+
+    // odometry proxy
+    odometry = new OdometryProxy(&workMbx, odometrySys, odometryInst);
+    if (!odometry)
+    {
+        ret = -ENOMEM;
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_PROXY_ODOMETRY);
+
+    // position proxy
+    position = new PositionProxy(&workMbx, positionSys, positionInst);
+    if (!position)
+    {
+        ret = -ENOMEM;
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_PROXY_POSITION);
+
+    // filter mutex
+    ret = filterMtx.create();
+    if (ret)
+    {
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_MTX_FILTER);
+
+    // evaluation worker mailboxes
+    if (workerNum > 0)
+    {
+        ret = createMbx(&jobMbx, MCL_WORKER_NUM_MAX, 0, MBX_IN_KERNELSPACE | MBX_SLOT);
+        if (ret)
+        {
+            goto init_error;
+        }
+
+        ret = createMbx(&doneMbx, MCL_WORKER_NUM_MAX, 0, MBX_IN_KERNELSPACE | MBX_SLOT);
+        if (ret)
+        {
+            destroyMbx(&jobMbx);
+            goto init_error;
+        }
+        initBits.setBit(INIT_BIT_MBX_WORKER);
+    }
+
+    // evaluation worker tasks
+    ret = filter.initWorkers(workerNum, dataTaskPrio, &jobMbx, &doneMbx);
+    if (ret)
+    {
+        GDOS_ERROR("Can't create evaluation workers, code = %d\n", ret);
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_WORKER);
+
+    if (filter.getWorkerNum() < workerNum)
+    {
+        GDOS_WARNING("Can't create all evaluation workers, using %d of %d\n",
+                     filter.getWorkerNum(), workerNum);
+    }
+
+    return 0;
+
+init_error:
+    moduleCleanup();
+    return ret;
+}
+
+
+void Mcl::moduleCleanup(void)
+{
+    // call RackDataModule cleanup function
+    if (initBits.testAndClearBit(INIT_BIT_DATA_MODULE))
+    {
+        RackDataModule::moduleCleanup();
+    }
+
+    if (initBits.testAndClearBit(INIT_BIT_WORKER))
+    {
+        filter.cleanupWorkers();
+    }
+
+    if (initBits.testAndClearBit(INIT_BIT_MTX_FILTER))
+    {
+        filterMtx.destroy();
+    }
+
+    //
+    // free proxies
+    //
+    if (initBits.testAndClearBit(INIT_BIT_PROXY_POSITION))
+    {
+        delete position;
+    }
+
+    if (initBits.testAndClearBit(INIT_BIT_PROXY_ODOMETRY))
+    {
+        delete odometry;
+    }
+
+    if (initBits.testAndClearBit(INIT_BIT_PROXY_SCAN2D))
+    {
+        delete scan2d;
+    }
+
+    //
+    // delete mailboxes
+    //
+    if (initBits.testAndClearBit(INIT_BIT_MBX_WORKER))
+    {
+        destroyMbx(&doneMbx);
+        destroyMbx(&jobMbx);
+    }
+
+    if (initBits.testAndClearBit(INIT_BIT_MBX_SCAN2D))
+    {
+        destroyMbx(&scan2dDataMbx);
+    }
+
+    if (initBits.testAndClearBit(INIT_BIT_MBX_WORK))
+    {
+        destroyMbx(&workMbx);
+    }
+}
+
+
+Mcl::Mcl()
+      : RackDataModule( MODULE_CLASS_ID,
+                    5000000000llu,    // 5s datatask error sleep time
+                    16,               // command mailbox slots
+                    240,              // command mailbox data size per slot
+                    MBX_IN_KERNELSPACE | MBX_SLOT,  // command mailbox flags
+                    5,                // max buffer entries
+                    10)               // data buffer listener
+      , dxfMap(MCL_MAP_FEATURE_MAX)
+{
+    // get static module parameter
+    scan2dSys    = getIntArg("scan2dSys", argTab);
+    scan2dInst   = getIntArg("scan2dInst", argTab);
+    odometrySys  = getIntArg("odometrySys", argTab);
+    odometryInst = getIntArg("odometryInst", argTab);
+    positionSys  = getIntArg("positionSys", argTab);
+    positionInst = getIntArg("positionInst", argTab);
+    workerNum    = getIntArg("workerNum", argTab);
+
+    // parameter of MSG_MCL_LOAD_MAP before the first moduleOn()
+    mapScaleFactor = getIntArg("mapScaleFactor", argTab);
+    mapOffsetX     = getIntArg("mapOffsetX", argTab);
+    mapOffsetY     = getIntArg("mapOffsetY", argTab);
+    fieldScale     = getIntArg("fieldScale", argTab);
+    sigma          = getIntArg("sigma", argTab);
+    distMax        = getIntArg("distMax", argTab);
+
+    dataBufferMaxDataSize   = sizeof(mcl_data_msg);
+}
+
+
+int  main(int argc, char *argv[])
+{
+    int ret;
+
+    // get args
+    ret = RackModule::getArgs(argc, argv, argTab, "Mcl");
+    if (ret)
+    {
+        printf("Invalid arguments -> EXIT \n");
+        return ret;
+    }
+
+    Mcl *pInst;
+
+    // create new Mcl
+    pInst = new Mcl();
+    if (!pInst)
+    {
+        printf("Can't create new Mcl -> EXIT\n");
+        return -ENOMEM;
+    }
+
+    // init
+    ret = pInst->moduleInit();
+    if (ret)
+        goto exit_error;
+
+    pInst->run();
+    return 0;
+
+exit_error:
+    delete (pInst);
+    return ret;
+}
@@ -0,0 +1,120 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Matthias Hentschel <hentschel@rts.uni-hannover.de>
+ */
+
+#ifndef __MCL_H__
+#define __MCL_H__
+
+#include <main/rack_data_module.h>
+#include <main/rack_mutex.h>
+
+#include <navigation/mcl_proxy.h>
+#include <navigation/odometry_proxy.h>
+#include <navigation/position_proxy.h>
+#include <perception/scan2d_proxy.h>
+
+#include "mcl_filter.h"
+
+// define module class
+#define MODULE_CLASS_ID             MCL
+
+#define MCL_MAP_FEATURE_MAX         10000
+
+// scan_2d data message (use max message size)
+typedef struct {
+    scan2d_data   data;
+    scan_point    point[SCAN2D_POINT_MAX];
+} __attribute__((packed)) scan2d_data_msg;
+
+// mcl data message (use max message size)
+typedef struct {
+    mcl_data        data;
+    mcl_data_point  point[MCL_DATA_POINT_MAX];
+} __attribute__((packed)) mcl_data_msg;
+
+/**
+ * Monte Carlo Localisation
+ *
+ * Localises the robot in a DXF map with a particle filter. The particles are
+ * moved by the odometry and weighted by the scan2d data using a likelihood
+ * field of the map. The estimated position is sent to the position module.
+ *
+ * @ingroup modules_mcl
+ */
+class Mcl : public RackDataModule {
+      private:
+
+        // external module parameter
+        int                 scan2dSys;
+        int                 scan2dInst;
+        int                 odometrySys;
+        int                 odometryInst;
+        int                 positionSys;
+        int                 positionInst;
+        int                 workerNum;
+        char                *mapFile;
+        int                 mapScaleFactor;
+        int                 mapOffsetX;
+        int                 mapOffsetY;
+        int                 fieldScale;
+        int                 sigma;
+        int                 distMax;
+        int                 beamStep;
+        float               updateDist;
+        float               updateAngle;
+        int                 positionUpdate;
+        int                 updateStdMax;
+
+        // mailboxes
+        RackMailbox         workMbx;                // communication
+        RackMailbox         scan2dDataMbx;          // scan2d data
+        RackMailbox         jobMbx;                 // evaluation jobs of the workers
+        RackMailbox         doneMbx;                // finished evaluation jobs
+
+        // proxies
+        Scan2dProxy*        scan2d;
+        OdometryProxy*      odometry;
+        PositionProxy*      position;
+
+        // data structures
+        scan2d_data_msg     scan2dMsg;
+        odometry_data       odometryData;
+        odometry_data       odometryOld;
+        position_data       positionData;
+        DxfMap              dxfMap;
+        MclFilter           filter;
+        RackMutex           filterMtx;
+
+        int      loadMap(char *filename);
+
+      protected:
+        // -> realtime context
+        int      moduleOn(void);
+        int      moduleLoop(void);
+        void     moduleOff(void);
+        int      moduleCommand(RackMessage *msgInfo);
+
+        // -> non realtime context
+        void     moduleCleanup(void);
+
+      public:
+        // constructor und destructor
+        Mcl();
+        ~Mcl() {};
+
+        // -> non realtime context
+        int  moduleInit(void);
+};
+
+#endif // __MCL_H__
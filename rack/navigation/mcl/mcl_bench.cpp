@@ -0,0 +1,199 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Matthias Hentschel <hentschel@rts.uni-hannover.de>
+ */
+#include <tools/datalog/datalog_bin_file.h>
+#include <main/rack_module.h>
+#include <main/rack_name.h>
+#include <main/argopts.h>
+
+#include "mcl_filter.h"
+
+//
+// Evaluates particles around the reference position of the scan2d data of
+// a binary log (see DatalogRec) against a DXF map, once by the calling task
+// only and once with worker tasks, and prints particles x beams per second.
+// The job mailboxes of the workers need a running TiMS router.
+//
+
+//
+// data structures
+//
+
+arg_table_t argTab[] = {
+
+    { ARGOPT_REQ, "logFile", ARGOPT_REQVAL, ARGOPT_VAL_STR,
+      "Binary log file recorded by DatalogRec", { 0 } },
+
+    { ARGOPT_REQ, "mapFile", ARGOPT_REQVAL, ARGOPT_VAL_STR,
+      "filename of the DXF map", { 0 } },
+
+    { ARGOPT_OPT, "mapScaleFactor", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "map scale factor", { 1000 } },
+
+    { ARGOPT_OPT, "scan2dInst", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Instance of the scan2d module, default -1 (all)", { -1 } },
+
+    { ARGOPT_OPT, "particleNum", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Number of particles, default 5000", { 5000 } },
+
+    { ARGOPT_OPT, "beamStep", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Use every n-th scan point, default 2", { 2 } },
+
+    { ARGOPT_OPT, "fieldScale", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Cell size of the likelihood field in mm, default 50 mm", { 50 } },
+
+    { ARGOPT_OPT, "workerNum", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Number of evaluation worker tasks, default 3", { 3 } },
+
+    { 0, "", 0, 0, "", { 0 } } // last entry
+};
+
+int  main(int argc, char *argv[])
+{
+    RackMessage         msgInfo;
+    RackTime            rackTime;
+    RackMailbox         jobMbx, doneMbx;
+    DatalogBinReader    binReader(NULL, 0);
+    DxfMap              dxfMap(10000);
+    MclFilter           *serialFilter, *workerFilter;
+    scan2d_data         *scan;
+    uint64_t            offset, time;
+    uint64_t            serialTime = 0, workerTime = 0, evalNum = 0;
+    uint32_t            scanNum = 0;
+    int                 scan2dInst, particleNum, beamStep, ret;
+
+    // get args
+    ret = RackModule::getArgs(argc, argv, argTab, "MclBench");
+    if (ret)
+    {
+        printf("Invalid arguments -> EXIT \n");
+        return ret;
+    }
+
+    scan2dInst  = getIntArg("scan2dInst", argTab);
+    particleNum = getIntArg("particleNum", argTab);
+    beamStep    = getIntArg("beamStep", argTab);
+
+    ret = dxfMap.load(getStrArg("mapFile", argTab), 0.0, 0.0, getIntArg("mapScaleFactor", argTab));
+    if (ret)
+    {
+        printf("Can't load DXF map %s, code = %d\n", getStrArg("mapFile", argTab), ret);
+        return ret;
+    }
+
+    ret = binReader.open(getStrArg("logFile", argTab));
+    if (ret)
+    {
+        printf("Can't open binary log %s, code = %d\n", getStrArg("logFile", argTab), ret);
+        return ret;
+    }
+
+    scan         = (scan2d_data *)malloc(sizeof(scan2d_data) + SCAN2D_POINT_MAX * sizeof(scan_point));
+    serialFilter = new MclFilter();
+    workerFilter = new MclFilter();
+    if (!scan || !serialFilter || !workerFilter)
+    {
+        printf("Can't allocate buffers -> EXIT\n");
+        return -ENOMEM;
+    }
+
+    ret = serialFilter->loadMap(&dxfMap, getIntArg("fieldScale", argTab), 150, 2000);
+    if (!ret)
+        ret = workerFilter->loadMap(&dxfMap, getIntArg("fieldScale", argTab), 150, 2000);
+    if (ret)
+    {
+        printf("Can't compute likelihood field, code = %d\n", ret);
+        return ret;
+    }
+
+    serialFilter->setParam(particleNum, particleNum, 0.05f, 500.0f, 0.17f, 0.1f, 0.1f, 0.1f);
+    workerFilter->setParam(particleNum, particleNum, 0.05f, 500.0f, 0.17f, 0.1f, 0.1f, 0.1f);
+
+    if (getIntArg("workerNum", argTab) > 0)
+    {
+        ret = jobMbx.create(RackName::create(TEST, 0) | 1, MCL_WORKER_NUM_MAX,
+                            0, NULL, 0, 0);
+        if (!ret)
+        {
+            ret = doneMbx.create(RackName::create(TEST, 0) | 2, MCL_WORKER_NUM_MAX,
+                                 0, NULL, 0, 0);
+        }
+        if (ret)
+        {
+            printf("Can't create the worker mailboxes (TiMS router running?), code = %d\n", ret);
+            return ret;
+        }
+    }
+
+    ret = workerFilter->initWorkers(getIntArg("workerNum", argTab), 1, &jobMbx, &doneMbx);
+    if (ret)
+    {
+        printf("Can't create evaluation workers, code = %d\n", ret);
+        return ret;
+    }
+
+    offset = binReader.first();
+    while (!binReader.getData(&offset, SCAN2D, scan2dInst, sizeof(scan2d_data),
+                              sizeof(scan2d_data) + SCAN2D_POINT_MAX * sizeof(scan_point),
+                              scan, &msgInfo))
+    {
+        Scan2dData::parse(&msgInfo);
+
+        if (serialFilter->setScan(scan, beamStep) <= 0)
+        {
+            continue;
+        }
+        workerFilter->setScan(scan, beamStep);
+
+        serialFilter->init(&scan->refPos, 500.0f, 0.17f);
+        workerFilter->init(&scan->refPos, 500.0f, 0.17f);
+
+        time = rackTime.getNano();
+        serialFilter->evaluate();
+        serialTime += rackTime.getNano() - time;
+
+        time = rackTime.getNano();
+        workerFilter->evaluate();
+        workerTime += rackTime.getNano() - time;
+
+        evalNum += (uint64_t)serialFilter->getParticleNum() * serialFilter->getBeamNum();
+        scanNum++;
+    }
+
+    if ((scanNum > 0) && (serialTime > 0) && (workerTime > 0))
+    {
+        printf("%d scans, %d particles, %d beams/scan\n", scanNum, particleNum,
+               (int)(evalNum / scanNum / particleNum));
+        printf("serial:  %8.3f ms/scan, %6.2f M particles x beams/s\n",
+               (double)serialTime / 1000000.0 / scanNum, 1000.0 * evalNum / serialTime);
+        printf("workers: %8.3f ms/scan, %6.2f M particles x beams/s (%d workers)\n",
+               (double)workerTime / 1000000.0 / scanNum, 1000.0 * evalNum / workerTime,
+               workerFilter->getWorkerNum());
+    }
+    else
+    {
+        printf("No scan2d data in %s\n", getStrArg("logFile", argTab));
+    }
+
+    delete workerFilter;
+    delete serialFilter;
+    if (getIntArg("workerNum", argTab) > 0)
+    {
+        doneMbx.remove();
+        jobMbx.remove();
+    }
+    free(scan);
+    binReader.close();
+    return 0;
+}
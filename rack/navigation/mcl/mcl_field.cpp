@@ -0,0 +1,247 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Matthias Hentschel <hentschel@rts.uni-hannover.de>
+ */
+
+#include "mcl_field.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+MclField::MclField()
+{
+    scale     = 0;
+    offsetX   = 0;
+    offsetY   = 0;
+    numX      = 0;
+    numY      = 0;
+    logLik    = NULL;
+    logLikMin = 0;
+}
+
+MclField::~MclField()
+{
+    if (logLik)
+        delete[] logLik;
+}
+
+/**
+ * Computes the likelihood field of a map
+ *
+ * The field covers the bounding box of all features plus distMax on every
+ * side. Its border cells are at least distMax away from the map, so scan
+ * points outside the field are clamped to the border.
+ *
+ * @param map       DXF map
+ * @param scale     Cell size in mm
+ * @param sigma     Standard deviation of the measurements in mm
+ * @param distMax   Maximum distance to the map in mm (max. 65535 mm)
+ *
+ * @return 0 on success, otherwise negative error code
+ */
+int MclField::init(DxfMap *map, int scale, int sigma, int distMax)
+{
+    int         i, ix, iy, a, b, d, num;
+    double      xMin, xMax, yMin, yMax, p;
+    uint16_t    *dist;
+
+    if ((map->featureNum <= 0) || (scale <= 0) || (sigma <= 0) ||
+        (distMax <= 0) || (distMax > 0xffff))
+    {
+        return -EINVAL;
+    }
+
+    // bounding box of the map
+    xMin = map->feature[0].x;
+    xMax = map->feature[0].x;
+    yMin = map->feature[0].y;
+    yMax = map->feature[0].y;
+
+    for (i = 0; i < map->featureNum; i++)
+    {
+        xMin = fmin(xMin, fmin(map->feature[i].x, map->feature[i].x2));
+        xMax = fmax(xMax, fmax(map->feature[i].x, map->feature[i].x2));
+        yMin = fmin(yMin, fmin(map->feature[i].y, map->feature[i].y2));
+        yMax = fmax(yMax, fmax(map->feature[i].y, map->feature[i].y2));
+    }
+
+    offsetX = (int)floor(xMin) - distMax;
+    offsetY = (int)floor(yMin) - distMax;
+    num     = ((int)ceil(xMax) + distMax - offsetX) / scale + 1;
+    i       = ((int)ceil(yMax) + distMax - offsetY) / scale + 1;
+
+    if ((double)num * (double)i > MCL_FIELD_CELL_MAX)
+    {
+        return -E2BIG;
+    }
+
+    if (logLik)
+        delete[] logLik;
+
+    this->scale = scale;
+    numX        = num;
+    numY        = i;
+    logLik      = new int16_t[numX * numY];
+    dist        = new uint16_t[numX * numY];
+    if (!logLik || !dist)
+    {
+        if (dist)
+            delete[] dist;
+        numX = 0;
+        numY = 0;
+        return -ENOMEM;
+    }
+
+    // features
+    for (i = 0; i < numX * numY; i++)
+    {
+        dist[i] = 0xffff;
+    }
+
+    for (i = 0; i < map->featureNum; i++)
+    {
+        drawLine(dist, map->feature[i].x,  map->feature[i].y,
+                       map->feature[i].x2, map->feature[i].y2);
+    }
+
+    // chamfer distance transform (forward and backward pass)
+    a = scale;
+    b = (int)(scale * M_SQRT2);
+
+    for (ix = 0; ix < numX; ix++)
+    {
+        for (iy = 0; iy < numY; iy++)
+        {
+            i = ix * numY + iy;
+            d = dist[i];
+            if (iy > 0)
+                d = (dist[i - 1] + a < d) ? dist[i - 1] + a : d;
+            if (ix > 0)
+            {
+                d = (dist[i - numY] + a < d) ? dist[i - numY] + a : d;
+                if (iy > 0)
+                    d = (dist[i - numY - 1] + b < d) ? dist[i - numY - 1] + b : d;
+                if (iy < numY - 1)
+                    d = (dist[i - numY + 1] + b < d) ? dist[i - numY + 1] + b : d;
+            }
+            dist[i] = d;
+        }
+    }
+
+    for (ix = numX - 1; ix >= 0; ix--)
+    {
+        for (iy = numY - 1; iy >= 0; iy--)
+        {
+            i = ix * numY + iy;
+            d = dist[i];
+            if (iy < numY - 1)
+                d = (dist[i + 1] + a < d) ? dist[i + 1] + a : d;
+            if (ix < numX - 1)
+            {
+                d = (dist[i + numY] + a < d) ? dist[i + numY] + a : d;
+                if (iy < numY - 1)
+                    d = (dist[i + numY + 1] + b < d) ? dist[i + numY + 1] + b : d;
+                if (iy > 0)
+                    d = (dist[i + numY - 1] + b < d) ? dist[i + numY - 1] + b : d;
+            }
+            dist[i] = d;
+        }
+    }
+
+    // log-likelihood
+    for (i = 0; i < numX * numY; i++)
+    {
+        d         = (dist[i] < distMax) ? dist[i] : distMax;
+        p         = exp(-(double)d * (double)d / (2.0 * sigma * sigma)) + MCL_FIELD_P_RAND;
+        logLik[i] = (int16_t)rint(1000.0 * log(p));
+    }
+
+    p         = exp(-(double)distMax * (double)distMax / (2.0 * sigma * sigma)) + MCL_FIELD_P_RAND;
+    logLikMin = (int16_t)rint(1000.0 * log(p));
+
+    delete[] dist;
+    return 0;
+}
+
+/**
+ * Scores a scan at a pose
+ *
+ * The beam end points are transformed into cell indices first and looked
+ * up in a second loop. Both loops are free of branches, so the compiler can
+ * vectorize the transformation.
+ *
+ * @param beamX     x-coordinates of the beam end points in mm (robot frame)
+ * @param beamY     y-coordinates of the beam end points in mm (robot frame)
+ * @param index     Buffer for beamNum cell indices
+ * @param beamNum   Number of beams
+ * @param x         x-position of the pose in mm
+ * @param y         y-position of the pose in mm
+ * @param rho       Orientation of the pose in rad
+ *
+ * @return Sum of the log-likelihoods * 1000
+ */
+int MclField::score(float *beamX, float *beamY, int32_t *index, int beamNum,
+                    float x, float y, float rho)
+{
+    int     i, cx, cy, sum;
+    float   invScale, fx, fy, fc, fs;
+
+    if (!logLik)
+        return beamNum * logLikMin;
+
+    invScale = 1.0f / (float)scale;
+    fx       = (x - (float)offsetX) * invScale;
+    fy       = (y - (float)offsetY) * invScale;
+    fc       = cosf(rho) * invScale;
+    fs       = sinf(rho) * invScale;
+
+    for (i = 0; i < beamNum; i++)
+    {
+        cx = (int)(fx + fc * beamX[i] - fs * beamY[i]);
+        cy = (int)(fy + fs * beamX[i] + fc * beamY[i]);
+        cx = (cx < 0) ? 0 : ((cx >= numX) ? numX - 1 : cx);
+        cy = (cy < 0) ? 0 : ((cy >= numY) ? numY - 1 : cy);
+        index[i] = cx * numY + cy;
+    }
+
+    sum = 0;
+    for (i = 0; i < beamNum; i++)
+    {
+        sum += logLik[index[i]];
+    }
+
+    return sum;
+}
+
+// marks the cells of a map line
+void MclField::drawLine(uint16_t *dist, double x1, double y1, double x2, double y2)
+{
+    int     i, n, cx, cy;
+    double  l;
+
+    l = sqrt((x2 - x1) * (x2 - x1) + (y2 - y1) * (y2 - y1));
+    n = (int)(2.0 * l / scale) + 1;
+
+    for (i = 0; i <= n; i++)
+    {
+        cx = (int)((x1 + (x2 - x1) * i / n - offsetX) / scale);
+        cy = (int)((y1 + (y2 - y1) * i / n - offsetY) / scale);
+
+        if ((cx >= 0) && (cx < numX) && (cy >= 0) && (cy < numY))
+        {
+            dist[cx * numY + cy] = 0;
+        }
+    }
+}
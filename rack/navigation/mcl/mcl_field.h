@@ -0,0 +1,66 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Matthias Hentschel <hentschel@rts.uni-hannover.de>
+ */
+
+#ifndef __MCL_FIELD_H__
+#define __MCL_FIELD_H__
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <main/dxf_map.h>
+
+#define MCL_FIELD_CELL_MAX          (2000 * 2000)   // max. number of cells
+#define MCL_FIELD_P_RAND            0.05            // likelihood of random measurements
+
+/**
+ * Likelihood field of a DXF map
+ *
+ * The distance of every cell to the nearest map feature is computed once by
+ * a chamfer distance transform and stored as log-likelihood
+ * 1000 * ln(exp(-d^2 / 2 sigma^2) + p_rand), so scoring a scan against a
+ * pose only needs one table lookup per beam.
+ */
+class MclField
+{
+    private:
+        int         scale;
+        int         offsetX;                // [mm] position of cell[0,0]
+        int         offsetY;
+        int         numX;
+        int         numY;
+        int16_t     *logLik;
+        int16_t     logLikMin;              // log-likelihood outside the field
+
+        void        drawLine(uint16_t *dist, double x1, double y1, double x2, double y2);
+
+    public:
+        MclField();
+        ~MclField();
+
+        int  init(DxfMap *map, int scale, int sigma, int distMax);
+        int  score(float *beamX, float *beamY, int32_t *index, int beamNum,
+                   float x, float y, float rho);
+
+        int  getNumX(void)
+        {
+            return numX;
+        }
+
+        int  getNumY(void)
+        {
+            return numY;
+        }
+};
+
+#endif // __MCL_FIELD_H__
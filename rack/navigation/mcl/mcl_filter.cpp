@@ -0,0 +1,569 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Matthias Hentschel <hentschel@rts.uni-hannover.de>
+ */
+
+#include "mcl_filter.h"
+
+#include <main/angle_tool.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+MclFilter::MclFilter()
+{
+    particleNum   = 0;
+    particleSet   = 0;
+    beamNum       = 0;
+    workerNum     = 0;
+    jobMbx        = NULL;
+    doneMbx       = NULL;
+    evalNum       = 0;
+    evalNext      = 0;
+    randState     = 2463534242u;
+
+    worker[0].filter = this;
+    worker[0].index  = 0;
+
+    setParam(500, 5000, 0.05f, 500.0f, 10.0f * M_PI / 180.0f, 0.1f, 0.1f, 0.1f);
+}
+
+MclFilter::~MclFilter()
+{
+    cleanupWorkers();
+}
+
+//
+// evaluation workers
+//
+
+void mcl_eval_task_proc(void *arg)
+{
+    mcl_worker  *p_worker = (mcl_worker *)arg;
+    MclFilter   *p_filter = p_worker->filter;
+    RackMessage msgInfo;
+
+    while (1)
+    {
+        if (p_filter->jobMbx->recvMsg(&msgInfo))
+            return;
+        if (msgInfo.getType() == MCL_MSG_STOP)
+            return;
+
+        p_filter->evaluateBlocks(p_worker->index);
+        p_filter->jobMbx->sendMsg(MCL_MSG_DONE, p_filter->doneMbx->getAdr(), 0);
+    }
+}
+
+/**
+ * Creates the evaluation worker tasks
+ *
+ * Less workers are used if not all tasks can be created (see getWorkerNum).
+ *
+ * @param workerNum Number of worker tasks (max. MCL_WORKER_NUM_MAX), the
+ *                  calling task evaluates particles as well
+ * @param prio      Priority of the worker tasks
+ * @param jobMbx    Mailbox the workers wait in for jobs
+ * @param doneMbx   Mailbox the calling task waits in for the finished jobs,
+ *                  both need workerNum slots for messages without data
+ *
+ * @return 0 on success, otherwise negative error code
+ */
+int MclFilter::initWorkers(int workerNum, int prio, RackMailbox *jobMbx,
+                           RackMailbox *doneMbx)
+{
+    char    taskName[30];
+    int     i, ret;
+
+    cleanupWorkers();
+
+    if (workerNum > MCL_WORKER_NUM_MAX)
+        workerNum = MCL_WORKER_NUM_MAX;
+
+    if (workerNum <= 0)
+        return 0;
+
+    if (!jobMbx || !doneMbx)
+        return -EINVAL;
+
+    ret = evalMtx.create();
+    if (ret)
+        return ret;
+
+    this->jobMbx  = jobMbx;
+    this->doneMbx = doneMbx;
+    jobMbx->clean();
+    doneMbx->clean();
+
+    evalNum       = 0;
+    evalNext      = 0;
+
+    for (i = 1; i <= workerNum; i++)
+    {
+        worker[i].filter = this;
+        worker[i].index  = i;
+
+        snprintf(taskName, sizeof(taskName), "mcl%p_%d", (void *)this, i);
+        ret = workerTask[i - 1].create(taskName, 0, prio, RACK_TASK_FPU | RACK_TASK_JOINABLE);
+        if (!ret)
+        {
+            ret = workerTask[i - 1].start(&mcl_eval_task_proc, &worker[i]);
+            if (ret)
+                workerTask[i - 1].destroy();
+        }
+        if (ret)
+            break;
+    }
+    this->workerNum = i - 1;
+
+    return 0;
+}
+
+/**
+ * Stops the evaluation worker tasks
+ */
+void MclFilter::cleanupWorkers(void)
+{
+    int i;
+
+    if (!workerNum)
+        return;
+
+    for (i = 1; i <= workerNum; i++)
+    {
+        doneMbx->sendMsg(MCL_MSG_STOP, jobMbx->getAdr(), 0);
+    }
+    for (i = 1; i <= workerNum; i++)
+    {
+        workerTask[i - 1].join();
+        workerTask[i - 1].destroy();
+    }
+    workerNum = 0;
+    evalMtx.destroy();
+}
+
+/**
+ * Computes the likelihood field of the map
+ *
+ * @see MclField::init
+ */
+int MclFilter::loadMap(DxfMap *map, int scale, int sigma, int distMax)
+{
+    return field.init(map, scale, sigma, distMax);
+}
+
+/**
+ * Sets the filter parameter
+ *
+ * @param particleMin   Minimum number of particles
+ * @param particleMax   Maximum number of particles (max. MCL_PARTICLE_MAX)
+ * @param kldError      Maximum error of the KLD sampling
+ * @param kldBinXY      Bin size of the KLD sampling in mm
+ * @param kldBinRho     Bin size of the KLD sampling in rad
+ * @param transNoise    Standard deviation of the odometry per moved distance
+ * @param rotNoise      Standard deviation of the odometry per rotated angle
+ * @param beamWeight    Factor of the log-likelihood of the beams, values < 1
+ *                      compensate the dependency of neighbouring beams
+ */
+void MclFilter::setParam(int particleMin, int particleMax, float kldError,
+                         float kldBinXY, float kldBinRho, float transNoise,
+                         float rotNoise, float beamWeight)
+{
+    if (particleMax > MCL_PARTICLE_MAX)
+        particleMax = MCL_PARTICLE_MAX;
+    if (particleMax < 1)
+        particleMax = 1;
+    if (particleMin > particleMax)
+        particleMin = particleMax;
+    if (particleMin < 1)
+        particleMin = 1;
+
+    this->particleMin = particleMin;
+    this->particleMax = particleMax;
+    this->kldError    = kldError;
+    this->kldBinXY    = kldBinXY;
+    this->kldBinRho   = kldBinRho;
+    this->transNoise  = transNoise;
+    this->rotNoise    = rotNoise;
+    this->beamWeight  = beamWeight;
+}
+
+/**
+ * Distributes particleMax particles normally around a position
+ */
+void MclFilter::init(position_3d *pos, float stdXY, float stdRho)
+{
+    int           i;
+    mcl_particle  *p;
+
+    particleSet = 0;
+    particleNum = particleMax;
+
+    for (i = 0; i < particleNum; i++)
+    {
+        p         = &particle[particleSet][i];
+        p->x      = (float)pos->x + stdXY * randNormal();
+        p->y      = (float)pos->y + stdXY * randNormal();
+        p->rho    = normaliseAngle(pos->rho + stdRho * randNormal());
+        p->weight = 1.0f / (float)particleNum;
+        p->logLik = 0;
+    }
+}
+
+/**
+ * Moves the particles by the odometry difference
+ *
+ * The difference is applied in the frame of every particle with noise
+ * proportional to the moved distance and the rotated angle.
+ */
+void MclFilter::move(position_3d *odoOld, position_3d *odoNew)
+{
+    int           i;
+    float         dx, dy, dRho, sinRho, cosRho, trans, stdTrans, stdRot;
+    float         dxLocal, dyLocal, dRhoLocal;
+    mcl_particle  *p;
+
+    // odometry difference in the frame of the old position
+    dx      = (float)(odoNew->x - odoOld->x);
+    dy      = (float)(odoNew->y - odoOld->y);
+    sinRho  = sinf(odoOld->rho);
+    cosRho  = cosf(odoOld->rho);
+    dxLocal =  dx * cosRho + dy * sinRho;
+    dyLocal = -dx * sinRho + dy * cosRho;
+    dRho    = normaliseAngleSym0(odoNew->rho - odoOld->rho);
+
+    trans    = sqrtf(dxLocal * dxLocal + dyLocal * dyLocal);
+    stdTrans = transNoise * trans;
+    stdRot   = rotNoise * fabsf(dRho) + transNoise * trans / 1000.0f;
+
+    for (i = 0; i < particleNum; i++)
+    {
+        p         = &particle[particleSet][i];
+        dx        = dxLocal + stdTrans * randNormal();
+        dy        = dyLocal + stdTrans * randNormal();
+        dRhoLocal = dRho + stdRot * randNormal();
+
+        sinRho    = sinf(p->rho);
+        cosRho    = cosf(p->rho);
+        p->x     += dx * cosRho - dy * sinRho;
+        p->y     += dx * sinRho + dy * cosRho;
+        p->rho    = normaliseAngle(p->rho + dRhoLocal);
+    }
+}
+
+/**
+ * Takes every beamStep-th valid point of a scan as beam
+ *
+ * Max range points are ignored, they are not modelled by the likelihood
+ * field.
+ *
+ * @return Number of beams
+ */
+int MclFilter::setScan(scan2d_data *scan, int beamStep)
+{
+    int i;
+
+    if (beamStep < 1)
+        beamStep = 1;
+
+    beamNum = 0;
+    for (i = 0; (i < scan->pointNum) && (beamNum < MCL_BEAM_MAX); i += beamStep)
+    {
+        if (scan->point[i].type & (SCAN_POINT_TYPE_INVALID | SCAN_POINT_TYPE_MAX_RANGE))
+            continue;
+
+        beamX[beamNum] = (float)scan->point[i].x;
+        beamY[beamNum] = (float)scan->point[i].y;
+        beamNum++;
+    }
+
+    return beamNum;
+}
+
+// evaluates blocks of the actual job until all blocks are taken
+void MclFilter::evaluateBlocks(int index)
+{
+    int           block, i, iEnd;
+    mcl_particle  *p;
+
+    while (1)
+    {
+        evalMtx.lock(RACK_INFINITE);
+        if (evalNext >= evalNum)
+        {
+            evalMtx.unlock();
+            return;
+        }
+        block = evalNext++;
+        evalMtx.unlock();
+
+        i    = block * MCL_EVAL_BLOCK_SIZE;
+        iEnd = i + MCL_EVAL_BLOCK_SIZE;
+        if (iEnd > particleNum)
+            iEnd = particleNum;
+
+        for (; i < iEnd; i++)
+        {
+            p         = &particle[particleSet][i];
+            p->logLik = field.score(beamX, beamY, beamIndex[index], beamNum,
+                                    p->x, p->y, p->rho);
+        }
+    }
+}
+
+/**
+ * Weights the particles by the actual scan (see setScan)
+ *
+ * Without worker tasks the particles are evaluated by the calling task.
+ */
+void MclFilter::evaluate(void)
+{
+    int           i, num, jobs, logLikMax;
+    float         sum;
+    mcl_particle  *p;
+    RackMessage   msgInfo;
+
+    num = (particleNum + MCL_EVAL_BLOCK_SIZE - 1) / MCL_EVAL_BLOCK_SIZE;
+
+    if (workerNum > 0)
+    {
+        // start job, the calling task evaluates blocks as well
+        evalMtx.lock(RACK_INFINITE);
+        evalNext = 0;
+        evalNum  = num;
+        evalMtx.unlock();
+
+        for (jobs = 0; jobs < workerNum; jobs++)
+        {
+            if (doneMbx->sendMsg(MCL_MSG_EVAL, jobMbx->getAdr(), 0))
+                break;
+        }
+
+        evaluateBlocks(0);
+
+        // a worker replies after the last block it has taken
+        for (i = 0; i < jobs; i++)
+        {
+            if (doneMbx->recvMsg(&msgInfo))
+                break;
+        }
+    }
+    else
+    {
+        for (i = 0; i < particleNum; i++)
+        {
+            p         = &particle[particleSet][i];
+            p->logLik = field.score(beamX, beamY, beamIndex[0], beamNum,
+                                    p->x, p->y, p->rho);
+        }
+    }
+
+    // normalised weights
+    logLikMax = particle[particleSet][0].logLik;
+    for (i = 1; i < particleNum; i++)
+    {
+        if (particle[particleSet][i].logLik > logLikMax)
+            logLikMax = particle[particleSet][i].logLik;
+    }
+
+    sum = 0.0f;
+    for (i = 0; i < particleNum; i++)
+    {
+        p          = &particle[particleSet][i];
+        p->weight *= expf(beamWeight * (float)(p->logLik - logLikMax) / 1000.0f);
+        sum       += p->weight;
+    }
+
+    if (sum <= 0.0f)
+    {
+        for (i = 0; i < particleNum; i++)
+            particle[particleSet][i].weight = 1.0f / (float)particleNum;
+    }
+    else
+    {
+        for (i = 0; i < particleNum; i++)
+            particle[particleSet][i].weight /= sum;
+    }
+}
+
+/**
+ * Weighted mean and standard deviation of the particles
+ */
+void MclFilter::estimate(position_3d *pos, position_3d *var)
+{
+    int           i;
+    double        x, y, sinSum, cosSum, varX, varY, varRho, d;
+    float         rho;
+    mcl_particle  *p;
+
+    x      = 0.0;
+    y      = 0.0;
+    sinSum = 0.0;
+    cosSum = 0.0;
+    for (i = 0; i < particleNum; i++)
+    {
+        p       = &particle[particleSet][i];
+        x      += p->weight * p->x;
+        y      += p->weight * p->y;
+        sinSum += p->weight * sin(p->rho);
+        cosSum += p->weight * cos(p->rho);
+    }
+    rho = normaliseAngle((float)atan2(sinSum, cosSum));
+
+    varX   = 0.0;
+    varY   = 0.0;
+    varRho = 0.0;
+    for (i = 0; i < particleNum; i++)
+    {
+        p       = &particle[particleSet][i];
+        varX   += p->weight * (p->x - x) * (p->x - x);
+        varY   += p->weight * (p->y - y) * (p->y - y);
+        d       = normaliseAngleSym0(p->rho - rho);
+        varRho += p->weight * d * d;
+    }
+
+    memset(pos, 0, sizeof(position_3d));
+    pos->x   = (int)rint(x);
+    pos->y   = (int)rint(y);
+    pos->rho = rho;
+
+    memset(var, 0, sizeof(position_3d));
+    var->x   = (int)rint(sqrt(varX));
+    var->y   = (int)rint(sqrt(varY));
+    var->rho = (float)sqrt(varRho);
+}
+
+/**
+ * Draws a new particle set (KLD sampling)
+ *
+ * Particles are drawn until the number of occupied bins k bounds the
+ * Kullback-Leibler distance between the sample set and the distribution
+ * by kldError with 99% probability, i.e.
+ * n >= (k - 1) / (2 kldError) * (1 - 2 / (9 (k - 1)) + sqrt(2 / (9 (k - 1))) z)^3
+ */
+void MclFilter::resample(void)
+{
+    int           i, lo, hi, mid, n, binNum, nRequired, newSet;
+    float         r, sum, a, b;
+    mcl_particle  *p;
+
+    if (particleNum <= 0)
+        return;
+
+    sum = 0.0f;
+    for (i = 0; i < particleNum; i++)
+    {
+        sum         += particle[particleSet][i].weight;
+        cumWeight[i] = sum;
+    }
+
+    memset(kldHash, 0, sizeof(kldHash));
+
+    newSet    = 1 - particleSet;
+    n         = 0;
+    binNum    = 0;
+    nRequired = 0;
+
+    while ((n < particleMax) && ((n < particleMin) || (n < nRequired)))
+    {
+        // draw particle
+        r  = randUniform() * sum;
+        lo = 0;
+        hi = particleNum - 1;
+        while (lo < hi)
+        {
+            mid = (lo + hi) / 2;
+            if (cumWeight[mid] < r)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+
+        p = &particle[newSet][n++];
+        memcpy(p, &particle[particleSet][lo], sizeof(mcl_particle));
+
+        // new bin
+        if (kldInsert(p))
+        {
+            binNum++;
+            if (binNum > 1)
+            {
+                a = 2.0f / (9.0f * (binNum - 1));
+                b = 1.0f - a + sqrtf(a) * (float)MCL_KLD_Z;
+                nRequired = (int)ceilf((binNum - 1) / (2.0f * kldError) * b * b * b);
+            }
+        }
+    }
+
+    particleSet = newSet;
+    particleNum = n;
+
+    for (i = 0; i < particleNum; i++)
+    {
+        particle[particleSet][i].weight = 1.0f / (float)particleNum;
+    }
+}
+
+// inserts the bin of a particle, returns 1 if the bin was empty
+int MclFilter::kldInsert(mcl_particle *p)
+{
+    int32_t     bx, by, br;
+    uint64_t    key;
+    uint32_t    h;
+
+    bx  = (int32_t)floorf(p->x / kldBinXY);
+    by  = (int32_t)floorf(p->y / kldBinXY);
+    br  = (int32_t)floorf(p->rho / kldBinRho);
+    key = (1llu << 63) |
+          ((uint64_t)(bx & 0x1fffff) << 42) |
+          ((uint64_t)(by & 0x1fffff) << 21) |
+           (uint64_t)(br & 0x1fffff);
+
+    h = ((uint32_t)bx * 73856093u) ^ ((uint32_t)by * 19349663u) ^ ((uint32_t)br * 83492791u);
+    h &= MCL_KLD_HASH_SIZE - 1;
+
+    while (kldHash[h])
+    {
+        if (kldHash[h] == key)
+            return 0;
+        h = (h + 1) & (MCL_KLD_HASH_SIZE - 1);
+    }
+
+    kldHash[h] = key;
+    return 1;
+}
+
+// xorshift random number in [0, 1)
+float MclFilter::randUniform(void)
+{
+    randState ^= randState << 13;
+    randState ^= randState >> 17;
+    randState ^= randState << 5;
+
+    return (float)(randState >> 8) * (1.0f / 16777216.0f);
+}
+
+// normally distributed random number (Box-Muller)
+float MclFilter::randNormal(void)
+{
+    float u1, u2;
+
+    u1 = randUniform();
+    u2 = randUniform();
+    if (u1 < 1e-7f)
+        u1 = 1e-7f;
+
+    return sqrtf(-2.0f * logf(u1)) * cosf(2.0f * (float)M_PI * u2);
+}
@@ -0,0 +1,147 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Matthias Hentschel <hentschel@rts.uni-hannover.de>
+ */
+
+#ifndef __MCL_FILTER_H__
+#define __MCL_FILTER_H__
+
+#include <perception/scan2d_proxy.h>
+#include <main/rack_mailbox.h>
+#include <main/rack_task.h>
+#include <main/rack_mutex.h>
+#include <main/defines/position3d.h>
+
+#include "mcl_field.h"
+
+#define MCL_PARTICLE_MAX            20000
+#define MCL_BEAM_MAX                SCAN2D_POINT_MAX
+#define MCL_WORKER_NUM_MAX          8
+#define MCL_EVAL_BLOCK_SIZE         128             // particles per evaluation job
+#define MCL_MSG_EVAL                1               // evaluation job to the workers
+#define MCL_MSG_STOP                2               // terminates a worker
+#define MCL_MSG_DONE                3               // job finished by a worker
+#define MCL_KLD_HASH_SIZE           65536           // power of two, > 2 * MCL_PARTICLE_MAX
+#define MCL_KLD_Z                   2.326           // upper 0.99 quantile of N(0,1)
+
+typedef struct {
+    float       x;                          // [mm]
+    float       y;                          // [mm]
+    float       rho;                        // [rad]
+    float       weight;
+    int32_t     logLik;                     // log-likelihood * 1000 of the last scan
+} mcl_particle;
+
+class MclFilter;
+
+// argument of an evaluation worker task
+typedef struct {
+    MclFilter   *filter;
+    int         index;                      // index of the beam index buffer
+} mcl_worker;
+
+/**
+ * Particle filter of the Monte Carlo localisation
+ *
+ * The particles are scored against a likelihood field of the map. The
+ * evaluation is split into blocks of particles which are processed by the
+ * calling task and a pool of worker tasks. The workers wait in a job mailbox
+ * for an evaluation message. Resampling adapts the number of
+ * particles to the spread of the distribution (KLD sampling).
+ */
+class MclFilter
+{
+    private:
+        MclField        field;
+
+        // parameter
+        int             particleMin;
+        int             particleMax;
+        float           kldError;
+        float           kldBinXY;
+        float           kldBinRho;
+        float           transNoise;
+        float           rotNoise;
+        float           beamWeight;
+
+        // particles
+        mcl_particle    particle[2][MCL_PARTICLE_MAX];
+        int             particleNum;
+        int             particleSet;
+        float           cumWeight[MCL_PARTICLE_MAX];
+        uint64_t        kldHash[MCL_KLD_HASH_SIZE];
+        uint32_t        randState;
+
+        // beams
+        float           beamX[MCL_BEAM_MAX];
+        float           beamY[MCL_BEAM_MAX];
+        int             beamNum;
+        int32_t         beamIndex[MCL_WORKER_NUM_MAX + 1][MCL_BEAM_MAX];
+
+        // evaluation workers
+        mcl_worker      worker[MCL_WORKER_NUM_MAX + 1];     // [0] is the calling task
+        RackTask        workerTask[MCL_WORKER_NUM_MAX];
+        RackMutex       evalMtx;
+        RackMailbox     *jobMbx;
+        RackMailbox     *doneMbx;
+        int             workerNum;
+        int             evalNum;                // number of blocks of the actual job
+        int             evalNext;
+
+        float    randUniform(void);
+        float    randNormal(void);
+        int      kldInsert(mcl_particle *p);
+        void     evaluateBlocks(int index);
+        friend void mcl_eval_task_proc(void *arg);
+
+    public:
+        MclFilter();
+        ~MclFilter();
+
+        int  initWorkers(int workerNum, int prio, RackMailbox *jobMbx,
+                         RackMailbox *doneMbx);
+        void cleanupWorkers(void);
+        int  loadMap(DxfMap *map, int scale, int sigma, int distMax);
+        void setParam(int particleMin, int particleMax, float kldError,
+                      float kldBinXY, float kldBinRho, float transNoise,
+                      float rotNoise, float beamWeight);
+
+        void init(position_3d *pos, float stdXY, float stdRho);
+        void move(position_3d *odoOld, position_3d *odoNew);
+        int  setScan(scan2d_data *scan, int beamStep);
+        void evaluate(void);
+        void estimate(position_3d *pos, position_3d *var);
+        void resample(void);
+
+        int  getParticleNum(void)
+        {
+            return particleNum;
+        }
+
+        mcl_particle* getParticle(int i)
+        {
+            return &particle[particleSet][i];
+        }
+
+        int  getBeamNum(void)
+        {
+            return beamNum;
+        }
+
+        int  getWorkerNum(void)
+        {
+            return workerNum;
+        }
+};
+
+#endif // __MCL_FILTER_H__
@@ -0,0 +1,589 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2006 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Oliver Wulf      <wulf@rts.uni-hannover.de>
+ *
+ */
+#include <iostream>
+
+#include "odometry_fusion.h"
+#include <main/angle_tool.h>
+
+//
+// data structures
+//
+
+arg_table_t argTab[] = {
+
+    { ARGOPT_OPT, "chassisSys", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The system number of the chassis module", { 0 } },
+
+    { ARGOPT_OPT, "chassisInst", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The instance number of the chassis module", { 0 } },
+
+    { ARGOPT_OPT, "gyroSys", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The system number of the gyro module", { 0 } },
+
+    { ARGOPT_OPT, "gyroInst", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The instance number of the gyro module", { 0 } },
+
+    { ARGOPT_OPT, "initPosX", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The x-coordinate of the initial position in mm, default 0", { 0 } },
+
+    { ARGOPT_OPT, "initPosY", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The y-coordinate of the initial position in mm, default 0", { 0 } },
+
+    { ARGOPT_OPT, "initPosRho", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The rho-coordinate of the initial position in deg, default 0", { 0 } },
+
+    { ARGOPT_OPT, "gyroNoise", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Noise of a gyro yaw rate sample in mdeg/s, default 200", { 200 } },
+
+    { ARGOPT_OPT, "biasDrift", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Drift of the gyro bias in mdeg/s per s, default 10", { 10 } },
+
+    { ARGOPT_OPT, "omegaNoise", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Noise of the chassis yaw rate in mdeg/s, default 2000", { 2000 } },
+
+    { ARGOPT_OPT, "omegaSlip", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Slip of the chassis yaw rate in percent, default 10", { 10 } },
+
+    { 0, "", 0, 0, "", { 0 } } // last entry
+};
+
+/*******************************************************************************
+ *   !!! REALTIME CONTEXT !!!
+ *
+ *   moduleOn,
+ *   moduleOff,
+ *   moduleLoop,
+ *   moduleCommand,
+ *
+ *   own realtime user functions
+ ******************************************************************************/
+
+int  OdometryFusion::moduleOn(void)
+{
+    int         ret;
+
+    chassisPending = 0;
+    resetRequest   = 0;
+    historyCount   = 0;
+
+    dataMbx.clean();
+
+    ret = chassis->on();
+    if (ret)
+    {
+        GDOS_ERROR("Can't switch on chassis(%d/%d), code = %d\n",
+                   chassisSys, chassisInst, ret);
+        return ret;
+    }
+
+    ret = gyro->on();
+    if (ret)
+    {
+        GDOS_ERROR("Can't switch on gyro(%d/%d), code = %d\n",
+                   gyroSys, gyroInst, ret);
+        return ret;
+    }
+
+    ret = chassis->getContData(0, &dataMbx, &chassisPeriodTime);
+    if (ret)
+    {
+        GDOS_ERROR("Can't get continuous data from chassis module, "
+                   "code = %d\n", ret);
+        return ret;
+    }
+
+    // the odometry is published at the rate of the gyro
+    ret = gyro->getContData(0, &dataMbx, &dataBufferPeriodTime);
+    if (ret)
+    {
+        GDOS_ERROR("Can't get continuous data from gyro module, "
+                   "code = %d\n", ret);
+        chassis->stopContData(&dataMbx);
+        return ret;
+    }
+
+    filter.init(getInt32Param("initPosX"), getInt32Param("initPosY"),
+                (double)getInt32Param("initPosRho") * M_PI / 180.0,
+                getInt32Param("gyroNoise") * M_PI / 180000.0,
+                getInt32Param("biasDrift") * M_PI / 180000.0,
+                getInt32Param("omegaNoise") * M_PI / 180000.0,
+                getInt32Param("omegaSlip") / 100.0,
+                dataBufferPeriodTime);
+
+    return RackDataModule::moduleOn();    // has to be last command in moduleOn();
+}
+
+void OdometryFusion::moduleOff(void)
+{
+    RackDataModule::moduleOff();          // has to be first command in moduleOff();
+
+    gyro->stopContData(&dataMbx);
+    chassis->stopContData(&dataMbx);
+}
+
+int  OdometryFusion::moduleLoop(void)
+{
+    int             ret;
+    RackMessage     msgInfo;
+    rack_time_t     periodTime;
+
+    periodTime = chassisPeriodTime > dataBufferPeriodTime ?
+                 chassisPeriodTime : dataBufferPeriodTime;
+
+    ret = dataMbx.recvDataMsgTimed(rackTime.toNano(2 * periodTime), &dataMsg,
+                                   sizeof(dataMsg), &msgInfo);
+    if (ret)
+    {
+        GDOS_ERROR("Can't read continuous data, code = %d\n", ret);
+        return ret;
+    }
+
+    if ((msgInfo.getType() == MSG_DATA) &&
+        (msgInfo.getSrc()  == gyro->getDestAdr()))
+    {
+        gyroUpdate(GyroData::parse(&msgInfo));
+    }
+    else if ((msgInfo.getType() == MSG_DATA) &&
+             (msgInfo.getSrc()  == chassis->getDestAdr()))
+    {
+        chassisUpdate(ChassisData::parse(&msgInfo));
+    }
+    else
+    {
+        GDOS_ERROR("Received unexpected message from %x to %x, type %d on dataMbx\n",
+                   msgInfo.getSrc(), msgInfo.getDest(), msgInfo.getType());
+
+        if (msgInfo.getType() > 0)
+        {
+            dataMbx.sendMsgReply(MSG_ERROR, &msgInfo);
+        }
+        return -ECOMM;
+    }
+
+    return 0;
+}
+
+// predicts the heading and moves the position with the last chassis
+// velocity, publishes a new pose
+void OdometryFusion::gyroUpdate(gyro_data *data)
+{
+    odometry_data   *p_odo;
+
+    if (resetRequest)
+    {
+        filter.reset();
+        chassisPending = 0;
+        resetRequest   = 0;
+    }
+
+    if (filter.predict(data->recordingTime, data->wYaw))
+    {
+        return;
+    }
+
+    if (chassisPending)
+    {
+        chassisCorrect();
+    }
+
+    p_odo = (odometry_data *)getDataBufferWorkSpace();
+
+    p_odo->recordingTime = data->recordingTime;
+    p_odo->pos.x         = (int)rint(filter.getX());
+    p_odo->pos.y         = (int)rint(filter.getY());
+    p_odo->pos.z         = 0;
+    p_odo->pos.phi       = 0.0f;
+    p_odo->pos.psi       = 0.0f;
+    p_odo->pos.rho       = normaliseAngle((float)filter.getRho());
+
+    GDOS_DBG_DETAIL("recordingTime %i x %i y %i rho %a bias %a\n",
+                    p_odo->recordingTime, p_odo->pos.x, p_odo->pos.y, p_odo->pos.rho,
+                    (float)filter.getBias());
+
+    historyPut(p_odo);
+    putDataBufferWorkSpace(sizeof(odometry_data));
+}
+
+// queues the chassis movement until the gyro data of its time is there,
+// the movement of a waiting sample is added to the new one
+void OdometryFusion::chassisUpdate(chassis_data *data)
+{
+    float   sinRho, cosRho;
+
+    if (chassisPending)
+    {
+        sinRho = sin(chassisData.deltaRho);
+        cosRho = cos(chassisData.deltaRho);
+
+        chassisData.deltaX       += data->deltaX * cosRho - data->deltaY * sinRho;
+        chassisData.deltaY       += data->deltaX * sinRho + data->deltaY * cosRho;
+        chassisData.deltaRho     += data->deltaRho;
+        chassisData.recordingTime = data->recordingTime;
+        chassisData.vx            = data->vx;
+        chassisData.vy            = data->vy;
+        chassisData.omega         = data->omega;
+    }
+    else
+    {
+        memcpy(&chassisData, data, sizeof(chassis_data));
+        chassisPending = 1;
+    }
+
+    chassisCorrect();
+}
+
+void OdometryFusion::chassisCorrect(void)
+{
+    int     ret;
+
+    ret = filter.update(chassisData.recordingTime, chassisData.deltaX, chassisData.deltaY,
+                        chassisData.deltaRho, chassisData.vx, chassisData.vy);
+    if (ret == -EAGAIN)
+    {
+        return;                 // wait for the next gyro data
+    }
+
+    chassisPending = 0;
+
+    if (ret)
+    {
+        GDOS_DBG_INFO("Chassis data %d is older than the predicted poses\n",
+                      chassisData.recordingTime);
+    }
+}
+
+void OdometryFusion::historyPut(odometry_data *data)
+{
+    memcpy(&history[historyCount & (ODOMETRY_FUSION_HISTORY_SIZE - 1)], data,
+           sizeof(odometry_data));
+
+    // the pose has to be complete before it is counted
+    __sync_synchronize();
+    historyCount = historyCount + 1;
+}
+
+// interpolates the pose at the given time like OdometryChassis::sendDataReply(),
+// time 0 returns the newest pose
+int  OdometryFusion::historyGet(rack_time_t time, odometry_data *data)
+{
+    odometry_data   a, b;
+    uint32_t        count, oldest, lo, hi, mid;
+    int             retry, tooOld;
+    float           x;
+
+    for (retry = 0; retry < ODOMETRY_FUSION_HISTORY_RETRY; retry++)
+    {
+        count = historyCount;
+        __sync_synchronize();
+
+        if (count == 0)
+        {
+            GDOS_WARNING("No data in history. Try it again \n");
+            return -EFAULT;
+        }
+
+        oldest = count > ODOMETRY_FUSION_HISTORY_SEARCH ?
+                 count - ODOMETRY_FUSION_HISTORY_SEARCH : 0;
+        hi     = count - 1;
+        tooOld = 0;
+
+        if ((time != 0) && ((int)time < (int)history[hi & (ODOMETRY_FUSION_HISTORY_SIZE - 1)].recordingTime))
+        {
+            // search for the first pose newer than time
+            lo = oldest;
+            while (lo < hi)
+            {
+                mid = lo + (hi - lo) / 2;
+                if ((int)history[mid & (ODOMETRY_FUSION_HISTORY_SIZE - 1)].recordingTime > (int)time)
+                {
+                    hi = mid;
+                }
+                else
+                {
+                    lo = mid + 1;
+                }
+            }
+            tooOld = (hi == oldest);
+        }
+
+        memcpy(&b, &history[hi & (ODOMETRY_FUSION_HISTORY_SIZE - 1)], sizeof(odometry_data));
+        memcpy(&a, &history[(hi > oldest ? hi - 1 : hi) & (ODOMETRY_FUSION_HISTORY_SIZE - 1)],
+               sizeof(odometry_data));
+
+        // the copies are valid if the writer has not reached the oldest pose
+        __sync_synchronize();
+        if (historyCount - oldest < ODOMETRY_FUSION_HISTORY_SIZE)
+        {
+            break;
+        }
+    }
+
+    if (retry == ODOMETRY_FUSION_HISTORY_RETRY)
+    {
+        GDOS_ERROR("History lookup was overtaken by the data task\n");
+        return -EBUSY;
+    }
+
+    if (time == 0)
+    {
+        // get newest data, no interpolation
+        memcpy(data, &b, sizeof(odometry_data));
+        return 0;
+    }
+
+    if ((int)time > (int)(b.recordingTime + dataBufferPeriodTime))
+    {
+        GDOS_ERROR("Requested time %d is newer than newest "
+                   "data message %d + periodTime %d\n", time, b.recordingTime, dataBufferPeriodTime);
+        return -EINVAL;
+    }
+
+    if (tooOld)
+    {
+        GDOS_ERROR("Requested time %d is older than oldest "
+                   "data message %d\n", time, b.recordingTime);
+        return -EINVAL;
+    }
+
+    if (a.recordingTime == b.recordingTime)
+    {
+        memcpy(data, &b, sizeof(odometry_data));
+        data->recordingTime = time;
+        return 0;
+    }
+
+    // do interpolation
+    data->recordingTime = time;
+    x = (float)((int)time - (int)a.recordingTime) / (float)((int)b.recordingTime - (int)a.recordingTime);
+
+    data->pos.x = a.pos.x + (int)(x * (float)(b.pos.x - a.pos.x));
+    data->pos.y = a.pos.y + (int)(x * (float)(b.pos.y - a.pos.y));
+    data->pos.z = a.pos.z + (int)(x * (float)(b.pos.z - a.pos.z));
+
+    data->pos.phi = normaliseAngleSym0(a.pos.phi + (x * normaliseAngleSym0((float)(b.pos.phi - a.pos.phi))));
+    data->pos.psi = normaliseAngleSym0(a.pos.psi + (x * normaliseAngleSym0((float)(b.pos.psi - a.pos.psi))));
+    data->pos.rho = normaliseAngle(a.pos.rho + (x * normaliseAngleSym0((float)(b.pos.rho - a.pos.rho))));
+
+    return 0;
+}
+
+int  OdometryFusion::moduleCommand(RackMessage *msgInfo)
+{
+    switch(msgInfo->getType())
+    {
+        case MSG_ODOMETRY_RESET:
+            // the data task resets the pose with the next gyro data
+            resetRequest = 1;
+
+            cmdMbx.sendMsgReply(MSG_OK, msgInfo);
+            break;
+
+        default:
+            // not for me -> ask RackDataModule
+            return RackDataModule::moduleCommand(msgInfo);
+      }
+      return 0;
+}
+
+// getData with interpolation from the pose history, without the buffer mutex
+// overwrites RackDataModle::sendDataReply(rack_time_t time, RackMessage *msgInfo)
+int  OdometryFusion::sendDataReply(rack_time_t time, RackMessage *msgInfo)
+{
+    int             ret;
+    odometry_data   odometry;
+
+    if (!msgInfo)
+        return -EINVAL;
+
+    ret = historyGet(time, &odometry);
+    if (ret)
+    {
+        return ret;
+    }
+
+    ret = dataBufferSendMbx->sendDataMsgReply(MSG_DATA, msgInfo, 1, &odometry, sizeof(odometry_data));
+    if (ret)
+    {
+        GDOS_ERROR("Can't send data msg (code %d)\n", ret);
+    }
+
+    return ret;
+}
+
+/*******************************************************************************
+ *   !!! NON REALTIME CONTEXT !!!
+ *
+ *   moduleInit,
+ *   moduleCleanup,
+ *   Constructor,
+ *   Destructor,
+ *   main,
+ *
+ *   own non realtime user functions
+ ******************************************************************************/
+
+// init_flags (for init and cleanup)
+#define INIT_BIT_DATA_MODULE            0
+#define INIT_BIT_MBX_DATA               1
+#define INIT_BIT_MBX_WORK               2
+#define INIT_BIT_PROXY_CHASSIS          3
+#define INIT_BIT_PROXY_GYRO             4
+
+int  OdometryFusion::moduleInit(void)
+{
+    int ret;
+
+    // call RackDataModule init function (first command in init)
+    ret = RackDataModule::moduleInit();
+    if (ret)
+    {
+        return ret;
+    }
+    initBits.setBit(INIT_BIT_DATA_MODULE);
+
+    // work mailbox
+    ret = createMbx(&workMbx, 1, 128, MBX_IN_KERNELSPACE | MBX_SLOT);
+    if (ret)
+    {
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_MBX_WORK);
+
+    // data mailbox for chassis and gyro
+    ret = createMbx(&dataMbx, 10, sizeof(odometry_fusion_msg),
+                    MBX_IN_KERNELSPACE | MBX_SLOT);
+    if (ret)
+    {
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_MBX_DATA);
+
+    // chassis
+    chassis = new ChassisProxy(&workMbx, chassisSys, chassisInst);
+    if (!chassis)
+    {
+        ret = -ENOMEM;
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_PROXY_CHASSIS);
+
+    // gyro
+    gyro = new GyroProxy(&workMbx, gyroSys, gyroInst);
+    if (!gyro)
+    {
+        ret = -ENOMEM;
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_PROXY_GYRO);
+
+    return 0;
+
+init_error:
+    moduleCleanup();
+    return ret;
+}
+
+void OdometryFusion::moduleCleanup(void)
+{
+    // call RackDataModule cleanup function
+    if (initBits.testAndClearBit(INIT_BIT_DATA_MODULE))
+    {
+        RackDataModule::moduleCleanup();
+    }
+
+    // free proxies
+    if (initBits.testAndClearBit(INIT_BIT_PROXY_GYRO))
+    {
+        delete gyro;
+    }
+
+    if (initBits.testAndClearBit(INIT_BIT_PROXY_CHASSIS))
+    {
+        delete chassis;
+    }
+
+    // delete data mailbox
+    if (initBits.testAndClearBit(INIT_BIT_MBX_DATA))
+    {
+        destroyMbx(&dataMbx);
+    }
+
+    // delete work mailbox
+    if (initBits.testAndClearBit(INIT_BIT_MBX_WORK))
+    {
+        destroyMbx(&workMbx);
+    }
+}
+
+OdometryFusion::OdometryFusion()
+      : RackDataModule( MODULE_CLASS_ID,
+                    2000000000llu,    // 2s datatask error sleep time
+                    16,               // command mailbox slots
+                    48,               // command mailbox data size per slot
+                    MBX_IN_KERNELSPACE | MBX_SLOT,  // command mailbox flags
+                    1000,             // max buffer entries
+                    10)               // data buffer listener
+{
+    // get static module parameter
+    chassisSys    = getIntArg("chassisSys", argTab);
+    chassisInst   = getIntArg("chassisInst", argTab);
+    gyroSys       = getIntArg("gyroSys", argTab);
+    gyroInst      = getIntArg("gyroInst", argTab);
+
+    historyCount  = 0;
+
+    dataBufferMaxDataSize = sizeof(odometry_data);
+}
+
+int  main(int argc, char *argv[])
+{
+      int ret;
+
+      // get args
+
+      ret = RackModule::getArgs(argc, argv, argTab, "OdometryFusion");
+      if (ret)
+      {
+        printf("Invalid arguments -> EXIT \n");
+        return ret;
+      }
+
+      // create new OdometryFusion
+
+      OdometryFusion *pInst;
+
+      pInst = new OdometryFusion();
+      if (!pInst)
+      {
+        printf("Can't create new OdometryFusion -> EXIT\n");
+        return -ENOMEM;
+      }
+
+      // init
+
+      ret = pInst->moduleInit();
+      if (ret)
+        goto exit_error;
+
+      pInst->run();
+
+      return 0;
+
+exit_error:
+
+      delete (pInst);
+      return ret;
+}
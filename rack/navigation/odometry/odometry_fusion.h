@@ -0,0 +1,111 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2006 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Oliver Wulf      <wulf@rts.uni-hannover.de>
+ *
+ */
+#ifndef __ODOMETRY_FUSION_H__
+#define __ODOMETRY_FUSION_H__
+
+#include <main/rack_data_module.h>
+#include <navigation/odometry_proxy.h>
+#include <drivers/chassis_proxy.h>
+#include <drivers/gyro_proxy.h>
+
+#include "odometry_fusion_filter.h"
+
+// define module class
+#define MODULE_CLASS_ID                 ODOMETRY
+
+#define ODOMETRY_FUSION_HISTORY_SIZE    2048        // poses, power of two
+#define ODOMETRY_FUSION_HISTORY_SEARCH  1024        // poses searched by a lookup
+#define ODOMETRY_FUSION_HISTORY_RETRY   4
+
+// continuous data of chassis and gyro (use max message size)
+typedef union {
+    chassis_data    chassis;
+    gyro_data       gyro;
+} odometry_fusion_msg;
+
+/**
+ * Odometry Fusion
+ *
+ * Fuses the chassis odometry with the yaw rate of a gyro. Every gyro sample
+ * predicts the heading (OdometryFusionFilter) and moves the position with
+ * the last chassis velocity, so the odometry is published at the gyro rate.
+ * Every chassis sample corrects the gyro bias and replaces the predicted
+ * movement of its period by the measured one. A chassis sample, which is
+ * newer than the last gyro sample, waits for the next one.
+ *
+ * The poses are kept in a history, which is written by the data task and
+ * read without a lock by sendDataReply(). A reader checks the write count
+ * after the copy and repeats the lookup if the writer has overtaken it.
+ *
+ * @ingroup modules_odometry
+ */
+class OdometryFusion : public RackDataModule {
+    private:
+        int                 chassisSys;
+        int                 chassisInst;
+        int                 gyroSys;
+        int                 gyroInst;
+
+        // mailboxes
+        RackMailbox         dataMbx;
+        RackMailbox         workMbx;
+
+        // proxies
+        ChassisProxy*       chassis;
+        GyroProxy*          gyro;
+
+        // buffer
+        odometry_fusion_msg dataMsg;
+
+        // filter state
+        OdometryFusionFilter filter;
+        chassis_data        chassisData;        // waiting for the gyro data
+        int                 chassisPending;
+        rack_time_t         chassisPeriodTime;
+        volatile int        resetRequest;
+
+        // pose history
+        odometry_data       history[ODOMETRY_FUSION_HISTORY_SIZE];
+        volatile uint32_t   historyCount;
+
+        void     gyroUpdate(gyro_data *data);
+        void     chassisUpdate(chassis_data *data);
+        void     chassisCorrect(void);
+        void     historyPut(odometry_data *data);
+        int      historyGet(rack_time_t time, odometry_data *data);
+
+      protected:
+        // -> realtime context
+        int      moduleOn(void);
+        int      moduleLoop(void);
+        void     moduleOff(void);
+        int      moduleCommand(RackMessage *msgInfo);
+
+        int  sendDataReply(rack_time_t time, RackMessage *msgInfo);
+
+        // -> non realtime context
+        void     moduleCleanup(void);
+
+      public:
+        // constructor und destructor
+        OdometryFusion();
+        ~OdometryFusion() {};
+
+        // -> non realtime context
+        int  moduleInit(void);
+};
+
+#endif // __ODOMETRY_FUSION_H__
@@ -0,0 +1,258 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2006 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Oliver Wulf      <wulf@rts.uni-hannover.de>
+ *
+ */
+#include <errno.h>
+#include <string.h>
+
+#include "odometry_fusion_filter.h"
+
+OdometryFusionFilter::OdometryFusionFilter()
+{
+    init(0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0);
+}
+
+void OdometryFusionFilter::init(double x, double y, double rho, double gyroNoise,
+                                double biasDrift, double omegaNoise, double omegaSlip,
+                                rack_time_t gyroPeriod)
+{
+    this->x    = x;
+    this->y    = y;
+    this->rho  = rho;
+    bias       = 0.0;
+    vx         = 0.0f;
+    vy         = 0.0f;
+
+    p[0][0]    = 0.0;
+    p[0][1]    = 0.0;
+    p[1][0]    = 0.0;
+    p[1][1]    = ODOMETRY_FUSION_BIAS_STD_INIT * ODOMETRY_FUSION_BIAS_STD_INIT;
+
+    gyroVar          = gyroNoise * gyroNoise;
+    biasVar          = biasDrift * biasDrift;
+    this->omegaNoise = omegaNoise;
+    this->omegaSlip  = omegaSlip;
+    this->gyroPeriod = (double)gyroPeriod / 1000.0;
+
+    trackNum   = 0;
+    baseValid  = 0;
+}
+
+void OdometryFusionFilter::reset(void)
+{
+    x        = 0.0;
+    y        = 0.0;
+    rho      = 0.0;
+    p[0][0]  = 0.0;
+    p[0][1]  = 0.0;
+    p[1][0]  = 0.0;
+
+    // keep the time of the last gyro sample, the older chassis data is
+    // not used for a correction
+    if (trackNum > 0)
+    {
+        track[0].time = track[trackNum - 1].time;
+        track[0].x    = x;
+        track[0].y    = y;
+        track[0].rho  = rho;
+        trackNum      = 1;
+    }
+    baseValid = 0;
+}
+
+int OdometryFusionFilter::predict(rack_time_t time, double wYaw)
+{
+    double dt, rhoOld, rhoMid;
+
+    if (trackNum > 0)
+    {
+        dt = (double)(int)(time - track[trackNum - 1].time) / 1000.0;
+        if (dt <= 0.0)
+        {
+            return -EINVAL;
+        }
+
+        rhoOld = rho;
+        kalmanPredict(wYaw, dt);
+        rhoMid = 0.5 * (rhoOld + rho);
+
+        x += (vx * cos(rhoMid) - vy * sin(rhoMid)) * dt;
+        y += (vx * sin(rhoMid) + vy * cos(rhoMid)) * dt;
+    }
+
+    // without chassis data the oldest poses are dropped
+    if (trackNum == ODOMETRY_FUSION_TRACK_SIZE)
+    {
+        memmove(&track[0], &track[1], (trackNum - 1) * sizeof(odometry_fusion_pose));
+        trackNum--;
+        baseValid = 0;
+    }
+
+    track[trackNum].time = time;
+    track[trackNum].x    = x;
+    track[trackNum].y    = y;
+    track[trackNum].rho  = rho;
+    trackNum++;
+
+    return 0;
+}
+
+int OdometryFusionFilter::update(rack_time_t time, double deltaX, double deltaY,
+                                 double deltaRho, float vx, float vy)
+{
+    odometry_fusion_pose pose;
+    double               dt, rhoOld, dRho, rhoMid, dx, dy;
+    double               sigma, omega;
+    int                  i, ret;
+
+    ret = trackGet(time, &pose);
+    if (ret == -EAGAIN)
+    {
+        return ret;
+    }
+
+    this->vx = vx;
+    this->vy = vy;
+
+    if (ret)
+    {
+        return ret;
+    }
+
+    // first pose of the track newer than the chassis data
+    i = 1;
+    while ((i < trackNum) && ((int)(time - track[i].time) >= 0))
+    {
+        i++;
+    }
+
+    dt = (double)(int)(time - track[0].time) / 1000.0;
+    if (baseValid && (dt > 0.0))
+    {
+        // at standstill the chassis yaw rate is exact and only the noise of
+        // the gyro over the period is left
+        sigma = sqrt(gyroVar * gyroPeriod / dt);
+        if ((deltaX != 0.0) || (deltaY != 0.0) || (deltaRho != 0.0))
+        {
+            omega = omegaNoise + omegaSlip * fabs(deltaRho) / dt;
+            sigma = sqrt(sigma * sigma + omega * omega);
+        }
+
+        rhoOld = rho;
+        kalmanUpdate(pose.rho - track[0].rho, deltaRho, dt, sigma);
+        dRho   = rho - rhoOld;
+
+        // replace the predicted movement since the last chassis data by
+        // the measured one
+        pose.rho += dRho;
+        rhoMid    = 0.5 * (track[0].rho + pose.rho);
+        dx        = track[0].x + deltaX * cos(rhoMid) - deltaY * sin(rhoMid) - pose.x;
+        dy        = track[0].y + deltaX * sin(rhoMid) + deltaY * cos(rhoMid) - pose.y;
+
+        pose.x += dx;
+        pose.y += dy;
+        x      += dx;
+        y      += dy;
+
+        for (ret = i; ret < trackNum; ret++)
+        {
+            track[ret].x   += dx;
+            track[ret].y   += dy;
+            track[ret].rho += dRho;
+        }
+    }
+
+    // the corrected pose is the new base of the track
+    memmove(&track[1], &track[i], (trackNum - i) * sizeof(odometry_fusion_pose));
+    trackNum  = trackNum - i + 1;
+    track[0]  = pose;
+    baseValid = 1;
+
+    return 0;
+}
+
+// interpolates the track, the time has to be within the track
+int OdometryFusionFilter::trackGet(rack_time_t time, odometry_fusion_pose *pose)
+{
+    odometry_fusion_pose *a, *b;
+    double               f;
+    int                  i;
+
+    if ((trackNum == 0) || ((int)(time - track[trackNum - 1].time) > 0))
+    {
+        return -EAGAIN;
+    }
+
+    if ((int)(time - track[0].time) < 0)
+    {
+        return -EINVAL;
+    }
+
+    i = trackNum - 1;
+    while ((i > 0) && ((int)(time - track[i - 1].time) < 0))
+    {
+        i--;
+    }
+
+    b = &track[i];
+    if ((i == 0) || (time == b->time))
+    {
+        *pose      = *b;
+        pose->time = time;
+        return 0;
+    }
+
+    a = &track[i - 1];
+    f = (double)(int)(time - a->time) / (double)(int)(b->time - a->time);
+
+    pose->time = time;
+    pose->x    = a->x   + f * (b->x   - a->x);
+    pose->y    = a->y   + f * (b->y   - a->y);
+    pose->rho  = a->rho + f * (b->rho - a->rho);
+
+    return 0;
+}
+
+void OdometryFusionFilter::kalmanPredict(double wYaw, double dt)
+{
+    // rho = rho + (wYaw - bias) * dt, F = [1 -dt; 0 1]
+    rho += (wYaw - bias) * dt;
+
+    p[0][0] += -2.0 * dt * p[0][1] + dt * dt * (p[1][1] + gyroVar);
+    p[0][1] -= dt * p[1][1];
+    p[1][0]  = p[0][1];
+    p[1][1] += dt * biasVar;
+}
+
+void OdometryFusionFilter::kalmanUpdate(double dRhoFilter, double dRhoChassis, double dt,
+                                        double sigma)
+{
+    double innovation, s, k0, k1;
+
+    // the filter turned by (wYaw - bias) * dt, the chassis by
+    // (wYaw - biasTrue) * dt, so the bias is observed with H = [0 1]
+    innovation = (dRhoFilter - dRhoChassis) / dt;
+
+    s  = p[1][1] + sigma * sigma;
+    k0 = p[0][1] / s;
+    k1 = p[1][1] / s;
+
+    rho  += k0 * innovation;
+    bias += k1 * innovation;
+
+    p[0][0] -= k0 * p[1][0];
+    p[0][1] -= k0 * p[1][1];
+    p[1][1] -= k1 * p[1][1];
+    p[1][0]  = p[0][1];
+}
@@ -0,0 +1,123 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2006 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Oliver Wulf      <wulf@rts.uni-hannover.de>
+ *
+ */
+#ifndef __ODOMETRY_FUSION_FILTER_H__
+#define __ODOMETRY_FUSION_FILTER_H__
+
+#include <math.h>
+#include <main/rack_time.h>
+
+#define ODOMETRY_FUSION_BIAS_STD_INIT   (1.0 * M_PI / 180.0)    // [rad/s] initial bias std
+#define ODOMETRY_FUSION_TRACK_SIZE      256                     // poses
+
+typedef struct
+{
+    rack_time_t time;
+    double      x;                  // [mm]
+    double      y;                  // [mm]
+    double      rho;                // [rad] not normalised
+} odometry_fusion_pose;
+
+/**
+ * Kalman filter of the heading and the yaw rate bias of a gyro together with
+ * the position of the chassis. The heading is predicted with every gyro
+ * sample and the position is moved with the last chassis velocity.
+ * The bias is observed by the heading change of the chassis odometry over a
+ * chassis period, which corrects the heading by the correlation of both
+ * states. At standstill the observation is as precise as the gyro, while
+ * driving it is weighted by the slip of the chassis.
+ *
+ * The predicted poses since the last chassis data are kept in a track,
+ * whose first pose is the corrected one at the time of that data. A chassis
+ * update replaces the predicted movement since then by the measured one and
+ * moves the newer poses of the track by the same correction.
+ *
+ * @ingroup modules_odometry
+ */
+class OdometryFusionFilter
+{
+    private:
+        double  rho;                // [rad] heading
+        double  bias;               // [rad/s] yaw rate bias of the gyro
+        double  p[2][2];            // covariance of heading and bias
+        double  x, y;               // [mm] position
+        float   vx, vy;             // [mm/s] chassis velocity
+
+        double  gyroVar;            // [rad^2/s^2] noise of a gyro sample
+        double  biasVar;            // [rad^2/s^3] random walk of the bias
+        double  omegaNoise;         // [rad/s] noise of the chassis yaw rate
+        double  omegaSlip;          // slip of the chassis yaw rate
+        double  gyroPeriod;         // [s]
+
+        odometry_fusion_pose track[ODOMETRY_FUSION_TRACK_SIZE];
+        int     trackNum;
+        int     baseValid;          // track[0] is the pose of the last chassis data
+
+        int     trackGet(rack_time_t time, odometry_fusion_pose *pose);
+        void    kalmanPredict(double wYaw, double dt);
+        void    kalmanUpdate(double dRhoFilter, double dRhoChassis, double dt, double sigma);
+
+    public:
+        OdometryFusionFilter();
+
+        // gyroNoise [rad/s] per sample, biasDrift [rad/s] per s,
+        // omegaNoise [rad/s], omegaSlip [1], gyroPeriod [ms]
+        void    init(double x, double y, double rho, double gyroNoise, double biasDrift,
+                     double omegaNoise, double omegaSlip, rack_time_t gyroPeriod);
+
+        // set the pose to zero
+        void    reset(void);
+
+        // gyro sample, returns -EINVAL if it is not newer than the last one
+        int     predict(rack_time_t time, double wYaw);
+
+        // chassis movement since the last chassis data, returns -EAGAIN if
+        // the time is newer than the gyro samples and -EINVAL if it is
+        // older than the track
+        int     update(rack_time_t time, double deltaX, double deltaY, double deltaRho,
+                       float vx, float vy);
+
+        double  getX(void)
+        {
+            return x;
+        }
+
+        double  getY(void)
+        {
+            return y;
+        }
+
+        double  getRho(void)
+        {
+            return rho;
+        }
+
+        double  getBias(void)
+        {
+            return bias;
+        }
+
+        double  getRhoStd(void)
+        {
+            return sqrt(p[0][0]);
+        }
+
+        double  getBiasStd(void)
+        {
+            return sqrt(p[1][1]);
+        }
+};
+
+#endif // __ODOMETRY_FUSION_FILTER_H__
@@ -0,0 +1,619 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Matthias Hentschel <hentschel@rts.uni-hannover.de>
+ */
+
+#include "path.h"
+
+#include <math.h>
+
+// plan requests
+#define PLAN_NONE                   0
+#define PLAN_MAKE                   1
+#define PLAN_REPLAN                 2
+
+//
+// data structures
+//
+
+// external module parameter
+arg_table_t argTab[] = {
+
+    { ARGOPT_OPT, "gridMapSys", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The system number of the grid map module, default 0", { 0 } },
+
+    { ARGOPT_OPT, "gridMapInst", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The instance number of the grid map module, default 0", { 0 } },
+
+    { ARGOPT_OPT, "positionSys", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The system number of the position module, default 0", { 0 } },
+
+    { ARGOPT_OPT, "positionInst", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The instance number of the position module, default 0", { 0 } },
+
+    { ARGOPT_OPT, "robotRadius", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Radius of the robot in mm, default 400 mm", { 400 } },
+
+    { ARGOPT_OPT, "safetyMargin", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Distance to obstacles with additional path costs in mm, default 500 mm", { 500 } },
+
+    { ARGOPT_OPT, "occupiedThreshold", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Lowest occupancy of an obstacle (0 - 255), default 180", { 180 } },
+
+    { ARGOPT_OPT, "freeThreshold", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Highest occupancy of a free cell (0 - 255), default 100", { 100 } },
+
+    { ARGOPT_OPT, "unknownCost", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Additional cost of an unknown cell (0 - 254), default 8", { 8 } },
+
+    { ARGOPT_OPT, "expandMax", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Maximum number of expanded cells per cycle, 0 = unlimited, default 0", { 0 } },
+
+    { 0, "", 0, 0, "", { 0 } } // last entry
+};
+
+/*******************************************************************************
+ *   !!! REALTIME CONTEXT !!!
+ *
+ *   moduleOn,
+ *   moduleOff,
+ *   moduleLoop,
+ *   moduleCommand,
+ *
+ *   own realtime user functions
+ ******************************************************************************/
+ int  Path::moduleOn(void)
+{
+    int ret;
+
+    // get dynamic module parameter
+    expandMax = getInt32Param("expandMax");
+
+    grid.setParam(getInt32Param("robotRadius"),
+                  getInt32Param("safetyMargin"),
+                  getInt32Param("occupiedThreshold"),
+                  getInt32Param("freeThreshold"),
+                  getInt32Param("unknownCost"));
+    grid.clear();
+    mapValid    = 0;
+
+    destValid   = 0;
+    planRequest = PLAN_NONE;
+    planValid   = 0;
+    splineNum   = 0;
+
+    // turn on position module
+    ret = position->on();
+    if (ret)
+    {
+        GDOS_ERROR("Can't turn on Position(%d/%d), code = %d\n",
+                   positionSys, positionInst, ret);
+        return ret;
+    }
+
+    // turn on grid map module
+    ret = gridMap->on();
+    if (ret)
+    {
+        GDOS_ERROR("Can't turn on GridMap(%d/%d), code = %d\n",
+                   gridMapSys, gridMapInst, ret);
+        return ret;
+    }
+
+    // get continuous data from grid map module
+    gridMapDataMbx.clean();
+    ret = gridMap->getContData(0, &gridMapDataMbx, &dataBufferPeriodTime);
+    if (ret)
+    {
+        GDOS_ERROR("Can't get continuous data from GridMap(%d/%d), code = %d\n",
+                   gridMapSys, gridMapInst, ret);
+        return ret;
+    }
+
+    return RackDataModule::moduleOn(); // has to be last command in moduleOn();
+}
+
+
+void Path::moduleOff(void)
+{
+    RackDataModule::moduleOff();        // has to be first command in moduleOff();
+
+    gridMap->stopContData(&gridMapDataMbx);
+}
+
+
+// realtime context
+int  Path::moduleLoop(void)
+{
+    int             ret;
+    RackMessage     msgInfo;
+    path_data*      pathData = NULL;
+
+    // get continuous data from grid map module
+    ret = gridMapDataMbx.recvDataMsgTimed(rackTime.toNano(2 * dataBufferPeriodTime),
+                                          &gridMapMsg.data, sizeof(gridMapMsg), &msgInfo);
+    if (ret)
+    {
+        GDOS_ERROR("Can't read continuous data from GridMap(%d/%d), code = %d\n",
+                   gridMapSys, gridMapInst, ret);
+        return ret;
+    }
+
+    // invalid data received
+    if (msgInfo.getType() != MSG_DATA ||
+        msgInfo.getSrc()  != gridMap->getDestAdr())
+    {
+        GDOS_ERROR("Received unexpected message from %x to %x, type %d on gridMapDataMbx\n",
+                   msgInfo.getSrc(), msgInfo.getDest(), msgInfo.getType());
+
+        if (msgInfo.getType() > 0)
+        {
+            gridMapDataMbx.sendMsgReply(MSG_ERROR, &msgInfo);
+        }
+        return -ECOMM;
+    }
+
+    // message parsing
+    GridMapData::parse(&msgInfo);
+
+    planMtx.lock(RACK_INFINITE);
+
+    // a changed part of the map has to follow the last merged map,
+    // otherwise the next whole map is waited for
+    if ((gridMapMsg.data.baseNum != gridMapMsg.data.mapNum) &&
+        (!mapValid || (gridMapMsg.data.baseNum != mapNum)))
+    {
+        GDOS_DBG_INFO("Missed grid map %d, waiting for the whole map\n",
+                      gridMapMsg.data.baseNum);
+        mapValid = 0;
+    }
+    else
+    {
+        // update the cell costs
+        ret = grid.merge(&gridMapMsg.data, &planner);
+        if (ret < 0)
+        {
+            GDOS_WARNING("Can't merge grid map %d x %d, code = %d\n",
+                         gridMapMsg.data.gridNumX, gridMapMsg.data.gridNumY, ret);
+            mapValid = 0;
+        }
+        else
+        {
+            if (ret > 0)
+            {
+                // new grid, the next replanning has to start a new search
+                planValid = 0;
+            }
+            mapNum   = gridMapMsg.data.mapNum;
+            mapValid = 1;
+        }
+    }
+
+    if (planRequest != PLAN_NONE)
+    {
+        plan();
+    }
+
+    // get datapointer from rackdatabuffer
+    pathData = (path_data *)getDataBufferWorkSpace();
+
+    pathData->recordingTime = gridMapMsg.data.recordingTime;
+    pathData->splineNum     = splineNum;
+    memcpy(pathData->spline, spline, splineNum * sizeof(polar_spline));
+
+    planMtx.unlock();
+
+    GDOS_DBG_DETAIL("recordingTime %i, splineNum %i\n",
+                    pathData->recordingTime, pathData->splineNum);
+
+    putDataBufferWorkSpace(sizeof(path_data) + pathData->splineNum * sizeof(polar_spline));
+
+    return 0;
+}
+
+int  Path::moduleCommand(RackMessage *msgInfo)
+{
+    path_dest_data   *pDest;
+    path_make_data   *pMake;
+
+    switch(msgInfo->getType())
+    {
+        case MSG_PATH_SET_DESTINATION:
+            pDest = PathDestData::parse(msgInfo);
+
+            planMtx.lock(RACK_INFINITE);
+            memcpy(&destData, pDest, sizeof(path_dest_data));
+            destValid = 1;
+            planValid = 0;
+            planMtx.unlock();
+
+            GDOS_DBG_INFO("Destination x %i, y %i, speed %i\n",
+                          destData.pos.x, destData.pos.y, destData.speed);
+
+            cmdMbx.sendMsgReply(MSG_OK, msgInfo);
+            break;
+
+        case MSG_PATH_MAKE:
+            pMake = PathMakeData::parse(msgInfo);
+
+            planMtx.lock(RACK_INFINITE);
+            if (!destValid)
+            {
+                planMtx.unlock();
+                GDOS_ERROR("Can't make path without destination\n");
+                cmdMbx.sendMsgReply(MSG_ERROR, msgInfo);
+                break;
+            }
+            memcpy(&makeData, pMake, sizeof(path_make_data));
+            planRequest = PLAN_MAKE;
+            planMtx.unlock();
+
+            cmdMbx.sendMsgReply(MSG_OK, msgInfo);
+            break;
+
+        case MSG_PATH_REPLAN:
+            PathReplanData::parse(msgInfo);
+
+            planMtx.lock(RACK_INFINITE);
+            if (!destValid)
+            {
+                planMtx.unlock();
+                GDOS_ERROR("Can't replan path without destination\n");
+                cmdMbx.sendMsgReply(MSG_ERROR, msgInfo);
+                break;
+            }
+            planRequest = planValid ? PLAN_REPLAN : PLAN_MAKE;
+            planMtx.unlock();
+
+            cmdMbx.sendMsgReply(MSG_OK, msgInfo);
+            break;
+
+        default:
+            // not for me -> ask RackDataModule
+            return RackDataModule::moduleCommand(msgInfo);
+      }
+      return 0;
+}
+
+// searches the path from the actual position, planMtx has to be locked
+int  Path::plan(void)
+{
+    int         ret, start, goal, cellNum;
+    rack_time_t time;
+
+    ret = position->getData(&positionData, sizeof(position_data), 0);
+    if (ret)
+    {
+        GDOS_ERROR("Can't get data from Position(%d/%d), code = %d\n",
+                   positionSys, positionInst, ret);
+        return ret;
+    }
+
+    start = grid.posToCell(positionData.pos.x, positionData.pos.y);
+    goal  = grid.posToCell(destData.pos.x, destData.pos.y);
+    if ((start < 0) || (goal < 0))
+    {
+        GDOS_WARNING("Position or destination outside of the grid map\n");
+        planRequest = PLAN_NONE;
+        splineNum   = 0;
+        return -EINVAL;
+    }
+
+    time = rackTime.get();
+
+    if ((planRequest == PLAN_MAKE) || !planValid)
+    {
+        planner.reset(start, goal);
+        planValid   = 1;
+        planRequest = PLAN_REPLAN;
+    }
+    else
+    {
+        planner.moveStart(start);
+    }
+
+    ret = planner.computePath(expandMax);
+    if (ret == -ETIME)
+    {
+        // continue in the next cycle
+        GDOS_DBG_INFO("Search interrupted after %d cells\n", planner.getExpandNum());
+        return 0;
+    }
+    planRequest = PLAN_NONE;
+
+    if (ret == 0)
+    {
+        cellNum = planner.getPath(cells, PATH_CELL_MAX);
+        ret     = (cellNum < 0) ? cellNum : 0;
+    }
+
+    if (ret)
+    {
+        GDOS_WARNING("No path to x %i, y %i, code = %d\n",
+                     destData.pos.x, destData.pos.y, ret);
+        splineNum = 0;
+        return ret;
+    }
+
+    cellNum = grid.smooth(&planner, cells, cellNum);
+    makeSplines(cellNum);
+
+    GDOS_DBG_INFO("Path with %d splines, %d expanded cells, %d ms\n",
+                  splineNum, planner.getExpandNum(), rackTime.get() - time);
+    return 0;
+}
+
+// straight splines from the actual position over the path corners to the
+// destination
+void Path::makeSplines(int cellNum)
+{
+    int             i, x0, y0, x1, y1, vMax;
+    float           dx, dy, rho;
+    polar_spline*   p_spline;
+
+    vMax = makeData.vMax;
+    if ((destData.speed > 0) && (destData.speed < vMax))
+    {
+        vMax = destData.speed;
+    }
+
+    splineNum = 0;
+    x0        = positionData.pos.x;
+    y0        = positionData.pos.y;
+
+    for (i = 1; (i < cellNum) && (splineNum < PATH_WAYPOINT_MAX); i++)
+    {
+        if (i == cellNum - 1)
+        {
+            x1 = destData.pos.x;
+            y1 = destData.pos.y;
+        }
+        else
+        {
+            grid.cellToPos(cells[i], &x1, &y1);
+        }
+
+        dx = (float)(x1 - x0);
+        dy = (float)(y1 - y0);
+        if ((dx == 0.0f) && (dy == 0.0f))
+            continue;
+        rho = atan2f(dy, dx);
+
+        p_spline = &spline[splineNum];
+        memset(p_spline, 0, sizeof(polar_spline));
+
+        p_spline->startPos.x      = x0;
+        p_spline->startPos.y      = y0;
+        p_spline->startPos.rho    = rho;
+        p_spline->endPos.x        = x1;
+        p_spline->endPos.y        = y1;
+        p_spline->endPos.rho      = rho;
+        p_spline->length          = (int)sqrtf(dx * dx + dy * dy);
+        p_spline->radius          = 0;
+        p_spline->vMax            = vMax;
+        p_spline->vStart          = vMax;
+        p_spline->vEnd            = vMax;
+        p_spline->accMax          = makeData.accMax;
+        p_spline->decMax          = makeData.decMax;
+        p_spline->basepoint.x     = x1;
+        p_spline->basepoint.y     = y1;
+        p_spline->basepoint.speed = vMax;
+        p_spline->basepoint.id    = splineNum;
+        p_spline->basepoint.layer = destData.layer;
+
+        splineNum++;
+        x0 = x1;
+        y0 = y1;
+    }
+
+    if (splineNum > 0)
+    {
+        spline[splineNum - 1].vEnd = 0;
+    }
+}
+
+/*******************************************************************************
+ *   !!! NON REALTIME CONTEXT !!!
+ *
+ *   moduleInit,
+ *   moduleCleanup,
+ *   Constructor,
+ *   Destructor,
+ *   main,
+ *
+ *   own non realtime user functions
+ ******************************************************************************/
+
+// init_flags (for init and cleanup)
+#define INIT_BIT_DATA_MODULE        0
+#define INIT_BIT_MBX_WORK           1
+#define INIT_BIT_MBX_GRID_MAP       2
+#define INIT_BIT_PROXY_GRID_MAP     3
+#define INIT_BIT_PROXY_POSITION     4
+#define INIT_BIT_MTX_PLAN           5
+
+int  Path::moduleInit(void)
+{
+    int ret;
+
+    // call RackDataModule init function (first command in init)
+    ret = RackDataModule::moduleInit();
+    if (ret)
+    {
+        return ret;
+    }
+    initBits.setBit(INIT_BIT_DATA_MODULE);
+
+    //
+    // create mailboxes
+    //
+
+    // work mailbox
+    ret = createMbx(&workMbx, 10, sizeof(position_data),
+                    MBX_IN_KERNELSPACE | MBX_SLOT);
+    if (ret)
+    {
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_MBX_WORK);
+
+    // grid map mailbox
+    ret = createMbx(&gridMapDataMbx, 2, sizeof(grid_map_data_msg),
+                    MBX_IN_KERNELSPACE | MBX_SLOT);
+    if (ret)
+    {
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_MBX_GRID_MAP);
+
+
+    //
+    // create Proxys
+    //
+
+    // grid map proxy
+    gridMap = new GridMapProxy(&workMbx, gridMapSys, gridMapInst);
+    if (!gridMap)
+    {
+        ret = -ENOMEM;
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_PROXY_GRID_MAP);
+
+    // position proxy
+    position = new PositionProxy(&workMbx, positionSys, positionInst);
+    if (!position)
+    {
+        ret = -ENOMEM;
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_PROXY_POSITION);
+
+    // plan mutex
+    ret = planMtx.create();
+    if (ret)
+    {
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_MTX_PLAN);
+
+    // allocate cost grid
+    ret = grid.init(GRID_MAP_NUM_MAX);
+    if (ret)
+    {
+        GDOS_ERROR("Can't allocate cost grid, code = %d\n", ret);
+        goto init_error;
+    }
+
+    return 0;
+
+init_error:
+    moduleCleanup();
+    return ret;
+}
+
+
+void Path::moduleCleanup(void)
+{
+    // call RackDataModule cleanup function
+    if (initBits.testAndClearBit(INIT_BIT_DATA_MODULE))
+    {
+        RackDataModule::moduleCleanup();
+    }
+
+    if (initBits.testAndClearBit(INIT_BIT_MTX_PLAN))
+    {
+        planMtx.destroy();
+    }
+
+    //
+    // free proxies
+    //
+    if (initBits.testAndClearBit(INIT_BIT_PROXY_POSITION))
+    {
+        delete position;
+    }
+
+    if (initBits.testAndClearBit(INIT_BIT_PROXY_GRID_MAP))
+    {
+        delete gridMap;
+    }
+
+    //
+    // delete mailboxes
+    //
+    if (initBits.testAndClearBit(INIT_BIT_MBX_GRID_MAP))
+    {
+        destroyMbx(&gridMapDataMbx);
+    }
+
+    if (initBits.testAndClearBit(INIT_BIT_MBX_WORK))
+    {
+        destroyMbx(&workMbx);
+    }
+}
+
+
+Path::Path()
+      : RackDataModule( MODULE_CLASS_ID,
+                    5000000000llu,    // 5s datatask error sleep time
+                    16,               // command mailbox slots
+                    48,               // command mailbox data size per slot
+                    MBX_IN_KERNELSPACE | MBX_SLOT,  // command mailbox flags
+                    5,                // max buffer entries
+                    10)               // data buffer listener
+{
+    // get static module parameter
+    gridMapSys   = getIntArg("gridMapSys", argTab);
+    gridMapInst  = getIntArg("gridMapInst", argTab);
+    positionSys  = getIntArg("positionSys", argTab);
+    positionInst = getIntArg("positionInst", argTab);
+
+    dataBufferMaxDataSize   = sizeof(path_data_msg);
+}
+
+
+int  main(int argc, char *argv[])
+{
+    int ret;
+
+    // get args
+    ret = RackModule::getArgs(argc, argv, argTab, "Path");
+    if (ret)
+    {
+        printf("Invalid arguments -> EXIT \n");
+        return ret;
+    }
+
+    Path *pInst;
+
+    // create new Path
+    pInst = new Path();
+    if (!pInst)
+    {
+        printf("Can't create new Path -> EXIT\n");
+        return -ENOMEM;
+    }
+
+    // init
+    ret = pInst->moduleInit();
+    if (ret)
+        goto exit_error;
+
+    pInst->run();
+    return 0;
+
+exit_error:
+    delete (pInst);
+    return ret;
+}
@@ -0,0 +1,116 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Matthias Hentschel <hentschel@rts.uni-hannover.de>
+ */
+
+#ifndef __PATH_H__
+#define __PATH_H__
+
+#include <main/rack_data_module.h>
+#include <main/rack_mutex.h>
+
+#include <navigation/path_proxy.h>
+#include <navigation/grid_map_proxy.h>
+#include <navigation/position_proxy.h>
+
+#include "path_dstar.h"
+#include "path_grid.h"
+
+// define module class
+#define MODULE_CLASS_ID             PATH
+
+#define PATH_WAYPOINT_MAX           1000            // maximum number of published splines
+#define PATH_CELL_MAX               (GRID_MAP_NUM_MAX / 8)  // maximum number of path cells
+
+// grid map data message (use max message size)
+typedef struct {
+    grid_map_data   data;
+    uint8_t         occupancy[GRID_MAP_NUM_MAX];
+} __attribute__((packed)) grid_map_data_msg;
+
+// path data message (use max message size)
+typedef struct {
+    path_data       data;
+    polar_spline    spline[PATH_WAYPOINT_MAX];
+} __attribute__((packed)) path_data_msg;
+
+/**
+ * Path
+ *
+ * Plans a path on the occupancy grid of a GridMap module with D* Lite. The
+ * changed parts of the map only update the costs of the affected cells,
+ * so MSG_PATH_REPLAN repairs the last search from the actual position
+ * instead of planning again. After a missed map the changed parts are
+ * ignored up to the next whole map. The path is published as straight
+ * splines between its corners.
+ *
+ * @ingroup modules_path
+ */
+class Path : public RackDataModule {
+      private:
+
+        // external module parameter
+        int                 gridMapSys;
+        int                 gridMapInst;
+        int                 positionSys;
+        int                 positionInst;
+        int                 expandMax;
+
+        // mailboxes
+        RackMailbox         workMbx;                // communication
+        RackMailbox         gridMapDataMbx;         // grid map data
+
+        // proxies
+        GridMapProxy*       gridMap;
+        PositionProxy*      position;
+
+        // data structures
+        grid_map_data_msg   gridMapMsg;
+        int                 mapNum;                 // last merged map
+        int                 mapValid;
+        position_data       positionData;
+        path_dest_data      destData;
+        path_make_data      makeData;
+        int                 destValid;
+        int                 planRequest;
+        int                 planValid;
+        int                 splineNum;
+        polar_spline        spline[PATH_WAYPOINT_MAX];
+        int                 cells[PATH_CELL_MAX];
+        PathGrid            grid;
+        PathDStar           planner;
+        RackMutex           planMtx;
+
+        int      plan(void);
+        void     makeSplines(int cellNum);
+
+      protected:
+        // -> realtime context
+        int      moduleOn(void);
+        int      moduleLoop(void);
+        void     moduleOff(void);
+        int      moduleCommand(RackMessage *msgInfo);
+
+        // -> non realtime context
+        void     moduleCleanup(void);
+
+      public:
+        // constructor und destructor
+        Path();
+        ~Path() {};
+
+        // -> non realtime context
+        int  moduleInit(void);
+};
+
+#endif // __PATH_H__
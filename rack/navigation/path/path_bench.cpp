@@ -0,0 +1,287 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Matthias Hentschel <hentschel@rts.uni-hannover.de>
+ */
+#include <main/rack_module.h>
+#include <main/argopts.h>
+
+#include "path_dstar.h"
+#include "path_grid.h"
+
+//
+// Plans a path across a random grid map and moves along it. Every step
+// blocks the path ahead with a new obstacle, which is merged as a changed
+// sub-grid like the dirty tiles of GridMap. The incremental replanning is
+// compared with a new search from scratch on the same map, both have to
+// result in the same cost map and the same path costs.
+//
+
+#define OBSTACLE_SIZE_MAX           20              // cells per side
+
+//
+// data structures
+//
+
+arg_table_t argTab[] = {
+
+    { ARGOPT_OPT, "gridNum", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Number of grid cells per side, default 500", { 500 } },
+
+    { ARGOPT_OPT, "scale", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Size of a grid cell in mm, default 100 mm", { 100 } },
+
+    { ARGOPT_OPT, "obstacleNum", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Number of random obstacles, default 400", { 400 } },
+
+    { ARGOPT_OPT, "replanNum", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Number of replanning steps, default 20", { 20 } },
+
+    { ARGOPT_OPT, "stepNum", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Path cells moved between two replanning steps, default 10", { 10 } },
+
+    { ARGOPT_OPT, "robotRadius", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Radius of the robot in mm, default 300 mm", { 300 } },
+
+    { ARGOPT_OPT, "seed", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Seed of the random map, default 1", { 1 } },
+
+    { 0, "", 0, 0, "", { 0 } } // last entry
+};
+
+// fills a box of a grid map
+static void fillBox(grid_map_data *map, int x0, int y0, int numX, int numY, uint8_t occ)
+{
+    int ix, iy;
+
+    for (ix = x0; ix < x0 + numX; ix++)
+    {
+        for (iy = y0; iy < y0 + numY; iy++)
+        {
+            if ((ix >= 0) && (iy >= 0) && (ix < map->gridNumX) && (iy < map->gridNumY))
+            {
+                map->occupancy[ix * map->gridNumY + iy] = occ;
+            }
+        }
+    }
+}
+
+int  main(int argc, char *argv[])
+{
+    RackTime            rackTime;
+    PathGrid            grid, scratchGrid;
+    PathDStar           planner, scratch;
+    grid_map_data       *map, *sub;
+    int                 *cells, *scratchCells;
+    uint64_t            time, planTime, mergeTime = 0, replanTime = 0, scratchTime = 0;
+    uint64_t            replanExpand = 0, scratchExpand = 0;
+    int                 gridNum, scale, replanNum, stepNum, cellNum, scratchNum, cellMax;
+    int                 i, n, start, goal, cx, cy, ret;
+    int                 costError = 0, pathError = 0, pathEqual = 0;
+    int32_t             cost, scratchCost;
+
+    // get args
+    ret = RackModule::getArgs(argc, argv, argTab, "PathBench");
+    if (ret)
+    {
+        printf("Invalid arguments -> EXIT \n");
+        return ret;
+    }
+
+    gridNum   = getIntArg("gridNum", argTab);
+    scale     = getIntArg("scale", argTab);
+    replanNum = getIntArg("replanNum", argTab);
+    stepNum   = getIntArg("stepNum", argTab);
+    cellMax   = gridNum * gridNum;
+
+    map   = (grid_map_data *)malloc(sizeof(grid_map_data) + cellMax);
+    sub   = (grid_map_data *)malloc(sizeof(grid_map_data) +
+                                    OBSTACLE_SIZE_MAX * OBSTACLE_SIZE_MAX);
+    cells        = (int *)malloc(cellMax * sizeof(int));
+    scratchCells = (int *)malloc(cellMax * sizeof(int));
+    if (!map || !sub || !cells || !scratchCells)
+    {
+        printf("Can't allocate buffers -> EXIT\n");
+        return -ENOMEM;
+    }
+
+    ret = grid.init(cellMax);
+    if (!ret)
+        ret = scratchGrid.init(cellMax);
+    if (ret)
+    {
+        printf("Can't allocate cost grid, code = %d\n", ret);
+        return ret;
+    }
+    grid.setParam(getIntArg("robotRadius", argTab), 300, 180, 100, 8);
+    scratchGrid.setParam(getIntArg("robotRadius", argTab), 300, 180, 100, 8);
+
+    // random map, obstacles and unknown areas
+    srand(getIntArg("seed", argTab));
+
+    map->offsetX  = 0;
+    map->offsetY  = 0;
+    map->scale    = scale;
+    map->gridNumX = gridNum;
+    map->gridNumY = gridNum;
+    memset(map->occupancy, 0, cellMax);
+
+    for (i = 0; i < getIntArg("obstacleNum", argTab); i++)
+    {
+        fillBox(map, rand() % gridNum, rand() % gridNum,
+                rand() % OBSTACLE_SIZE_MAX + 1, rand() % OBSTACLE_SIZE_MAX + 1,
+                (i % 4) ? 255 : 128);
+    }
+    fillBox(map, 0, 0, 20, 20, 0);
+    fillBox(map, gridNum - 20, gridNum - 20, 20, 20, 0);
+
+    time = rackTime.getNano();
+    grid.merge(map, &planner);
+    printf("cost map %d x %d:      %8.3f ms\n", gridNum, gridNum,
+           (double)(rackTime.getNano() - time) / 1000000.0);
+
+    start = grid.posToCell(5 * scale, 5 * scale);
+    goal  = grid.posToCell((gridNum - 5) * scale, (gridNum - 5) * scale);
+
+    time = rackTime.getNano();
+    planner.reset(start, goal);
+    ret      = planner.computePath(0);
+    cellNum  = planner.getPath(cells, cellMax);
+    planTime = rackTime.getNano() - time;
+    if ((ret) || (cellNum < 0))
+    {
+        printf("No path through the random map, try another seed\n");
+        return -ENOENT;
+    }
+
+    printf("initial plan:          %8.3f ms, %7d expanded cells, %d path cells\n",
+           (double)planTime / 1000000.0, planner.getExpandNum(), cellNum);
+
+    for (n = 0; n < replanNum; n++)
+    {
+        if (cellNum <= 2 * stepNum + 2)
+            break;
+
+        // move along the path and block it further ahead
+        start = cells[stepNum];
+        cx    = cells[2 * stepNum] / gridNum;
+        cy    = cells[2 * stepNum] % gridNum;
+
+        if (cx < 2)
+            cx = 2;
+        if (cx > gridNum - 3)
+            cx = gridNum - 3;
+        if (cy < 2)
+            cy = 2;
+        if (cy > gridNum - 3)
+            cy = gridNum - 3;
+
+        sub->offsetX  = (cx - 2) * scale;
+        sub->offsetY  = (cy - 2) * scale;
+        sub->scale    = scale;
+        sub->gridNumX = 5;
+        sub->gridNumY = 5;
+        memset(sub->occupancy, 255, 25);
+        fillBox(map, cx - 2, cy - 2, 5, 5, 255);
+
+        time = rackTime.getNano();
+        grid.merge(sub, &planner);
+        mergeTime += rackTime.getNano() - time;
+
+        time = rackTime.getNano();
+        planner.moveStart(start);
+        ret          = planner.computePath(0);
+        replanTime  += rackTime.getNano() - time;
+        replanExpand += planner.getExpandNum();
+
+        // new search on the same map
+        scratchGrid.clear();
+        scratchGrid.merge(map, &scratch);
+        time = rackTime.getNano();
+        scratch.reset(start, goal);
+        i              = scratch.computePath(0);
+        scratchTime   += rackTime.getNano() - time;
+        scratchExpand += scratch.getExpandNum();
+
+        if (ret != i)
+        {
+            printf("ERROR: search results differ at step %d, incremental %d, scratch %d\n",
+                   n, ret, i);
+            pathError++;
+            break;
+        }
+        if (ret)
+        {
+            printf("Path blocked after %d steps\n", n);
+            break;
+        }
+
+        cellNum    = planner.getPath(cells, cellMax);
+        scratchNum = scratch.getPath(scratchCells, cellMax);
+        if ((cellNum < 0) || (scratchNum < 0))
+        {
+            printf("ERROR: no path at step %d, incremental %d, scratch %d\n",
+                   n, cellNum, scratchNum);
+            pathError++;
+            break;
+        }
+
+        // the merged sub-grids have to result in the cost map from scratch
+        for (i = 0; i < cellMax; i++)
+        {
+            if (planner.getCost(i) != scratch.getCost(i))
+            {
+                printf("ERROR: cost of cell %d differs at step %d, incremental %d, "
+                       "scratch %d\n", i, n, planner.getCost(i), scratch.getCost(i));
+                costError++;
+                break;
+            }
+        }
+
+        // both paths have the optimal costs, equal cost paths may differ
+        cost        = planner.getPathCost(cells, cellNum);
+        scratchCost = scratch.getPathCost(scratchCells, scratchNum);
+        if ((cost >= PATH_DSTAR_INF) || (cost != scratchCost))
+        {
+            printf("ERROR: path costs differ at step %d, incremental %d, scratch %d\n",
+                   n, cost, scratchCost);
+            pathError++;
+        }
+        else if ((cellNum == scratchNum) &&
+                 !memcmp(cells, scratchCells, cellNum * sizeof(int)))
+        {
+            pathEqual++;
+        }
+    }
+
+    if (n > 0)
+    {
+        printf("%d replanning steps\n", n);
+        printf("merge sub-grid:        %8.3f ms\n",
+               (double)mergeTime / 1000000.0 / n);
+        printf("incremental replan:    %8.3f ms, %7d expanded cells\n",
+               (double)replanTime / 1000000.0 / n, (int)(replanExpand / n));
+        printf("search from scratch:   %8.3f ms, %7d expanded cells\n",
+               (double)scratchTime / 1000000.0 / n, (int)(scratchExpand / n));
+        printf("equal paths:           %d of %d, %d cost map errors, %d path errors\n",
+               pathEqual, n, costError, pathError);
+    }
+
+    free(scratchCells);
+    free(cells);
+    free(sub);
+    free(map);
+
+    if (costError || pathError)
+        return -EINVAL;
+    return 0;
+}
@@ -0,0 +1,506 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Matthias Hentschel <hentschel@rts.uni-hannover.de>
+ */
+
+#include "path_dstar.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+PathDStar::PathDStar()
+{
+    numX      = 0;
+    numY      = 0;
+    cellNum   = 0;
+    cost      = NULL;
+    g         = NULL;
+    rhs       = NULL;
+    heapPos   = NULL;
+    heap      = NULL;
+    heapNum   = 0;
+    start     = 0;
+    goal      = 0;
+    last      = 0;
+    km        = 0;
+    expandNum = 0;
+}
+
+PathDStar::~PathDStar()
+{
+    if (cost)
+        delete[] cost;
+    if (g)
+        delete[] g;
+    if (rhs)
+        delete[] rhs;
+    if (heapPos)
+        delete[] heapPos;
+    if (heap)
+        delete[] heap;
+}
+
+/**
+ * Allocates a grid of numX x numY free cells
+ *
+ * @return 0 on success, otherwise negative error code
+ */
+int PathDStar::init(int numX, int numY)
+{
+    if ((numX <= 0) || (numY <= 0))
+        return -EINVAL;
+
+    if (numX * numY != cellNum)
+    {
+        if (cost)
+            delete[] cost;
+        if (g)
+            delete[] g;
+        if (rhs)
+            delete[] rhs;
+        if (heapPos)
+            delete[] heapPos;
+        if (heap)
+            delete[] heap;
+
+        cellNum = numX * numY;
+        cost    = new uint8_t[cellNum];
+        g       = new int32_t[cellNum];
+        rhs     = new int32_t[cellNum];
+        heapPos = new int32_t[cellNum];
+        heap    = new path_dstar_node[cellNum];
+        if (!cost || !g || !rhs || !heapPos || !heap)
+        {
+            cellNum = 0;
+            return -ENOMEM;
+        }
+    }
+
+    this->numX = numX;
+    this->numY = numY;
+
+    memset(cost, 0, cellNum);
+    reset(0, 0);
+    return 0;
+}
+
+/**
+ * Sets the cost of a cell without repairing the search (see reset)
+ */
+void PathDStar::setCost(int cell, uint8_t c)
+{
+    cost[cell] = c;
+}
+
+/**
+ * Starts a new search from the goal to the start
+ */
+void PathDStar::reset(int start, int goal)
+{
+    int i;
+
+    for (i = 0; i < cellNum; i++)
+    {
+        g[i]       = PATH_DSTAR_INF;
+        rhs[i]     = PATH_DSTAR_INF;
+        heapPos[i] = -1;
+    }
+    heapNum = 0;
+
+    this->start = start;
+    this->goal  = goal;
+    last        = start;
+    km          = 0;
+
+    rhs[goal] = 0;
+    heapInsert(goal);
+}
+
+/**
+ * Changes the cost of a cell
+ *
+ * The cell and its neighbours become inconsistent and are repaired by the
+ * next computePath().
+ */
+void PathDStar::updateCost(int cell, uint8_t c)
+{
+    int i, n, nb[8];
+
+    if (cost[cell] == c)
+        return;
+
+    cost[cell] = c;
+
+    updateVertex(cell);
+
+    n = neighbours(cell, nb);
+    for (i = 0; i < n; i++)
+    {
+        updateVertex(nb[i]);
+    }
+}
+
+/**
+ * Moves the start of the search, e.g. to the actual robot position
+ */
+void PathDStar::moveStart(int start)
+{
+    km         += heuristic(last, start);
+    last        = start;
+    this->start = start;
+}
+
+/**
+ * Expands cells until the start is consistent
+ *
+ * @param expandMax Maximum number of expanded cells, 0 = unlimited
+ *
+ * @return 0 if a path exists, -ENOENT if the goal is unreachable, -ETIME
+ *         if expandMax was reached
+ */
+int PathDStar::computePath(int expandMax)
+{
+    int             i, n, u, nb[8];
+    path_dstar_node keyStart, keyNew;
+
+    expandNum = 0;
+
+    while (heapNum > 0)
+    {
+        calcKey(start, &keyStart);
+        if (!keyLess(&heap[0], &keyStart) && (rhs[start] == g[start]))
+            break;
+
+        if ((expandMax > 0) && (expandNum >= expandMax))
+            return -ETIME;
+        expandNum++;
+
+        u = heap[0].cell;
+        calcKey(u, &keyNew);
+
+        if (keyLess(&heap[0], &keyNew))
+        {
+            // outdated key
+            heap[0].k1 = keyNew.k1;
+            heap[0].k2 = keyNew.k2;
+            heapUpdate(0);
+        }
+        else if (g[u] > rhs[u])
+        {
+            // overconsistent
+            g[u] = rhs[u];
+            heapRemove(u);
+
+            n = neighbours(u, nb);
+            for (i = 0; i < n; i++)
+            {
+                updateVertex(nb[i]);
+            }
+        }
+        else
+        {
+            // underconsistent
+            g[u] = PATH_DSTAR_INF;
+            updateVertex(u);
+
+            n = neighbours(u, nb);
+            for (i = 0; i < n; i++)
+            {
+                updateVertex(nb[i]);
+            }
+        }
+    }
+
+    if (rhs[start] >= PATH_DSTAR_INF)
+        return -ENOENT;
+
+    return 0;
+}
+
+/**
+ * Follows the cheapest neighbours from the start to the goal
+ *
+ * @return Number of cells (start and goal included), -ENOENT if there is
+ *         no path, -ENOSPC if the path is longer than cellMax
+ */
+int PathDStar::getPath(int *cells, int cellMax)
+{
+    int     i, n, num, s, best, nb[8];
+    int32_t c, bestCost;
+
+    if (rhs[start] >= PATH_DSTAR_INF)
+        return -ENOENT;
+
+    s   = start;
+    num = 0;
+
+    while (s != goal)
+    {
+        if (num >= cellMax)
+            return -ENOSPC;
+        cells[num++] = s;
+
+        best     = -1;
+        bestCost = PATH_DSTAR_INF;
+
+        n = neighbours(s, nb);
+        for (i = 0; i < n; i++)
+        {
+            c = edgeCost(s, nb[i]);
+            if ((c < PATH_DSTAR_INF) && (g[nb[i]] < PATH_DSTAR_INF) &&
+                (c + g[nb[i]] < bestCost))
+            {
+                bestCost = c + g[nb[i]];
+                best     = nb[i];
+            }
+        }
+
+        if (best < 0)
+            return -ENOENT;
+        s = best;
+    }
+
+    if (num >= cellMax)
+        return -ENOSPC;
+    cells[num++] = goal;
+
+    return num;
+}
+
+// costs of a cell path, PATH_DSTAR_INF if a step is not possible
+int32_t PathDStar::getPathCost(const int *cells, int num)
+{
+    int     i, j, n, nb[8];
+    int32_t c, sum;
+
+    sum = 0;
+
+    for (i = 1; i < num; i++)
+    {
+        n = neighbours(cells[i - 1], nb);
+        for (j = 0; j < n; j++)
+        {
+            if (nb[j] == cells[i])
+                break;
+        }
+        if (j == n)
+            return PATH_DSTAR_INF;
+
+        c = edgeCost(cells[i - 1], cells[i]);
+        if (c >= PATH_DSTAR_INF)
+            return PATH_DSTAR_INF;
+        sum += c;
+    }
+
+    return sum;
+}
+
+//
+// search
+//
+
+// octile distance, lower bound of the path costs
+int32_t PathDStar::heuristic(int a, int b)
+{
+    int dx, dy;
+
+    dx = abs(a / numY - b / numY);
+    dy = abs(a % numY - b % numY);
+
+    if (dx > dy)
+        return PATH_DSTAR_STEP * dx + (PATH_DSTAR_STEP_DIAG - PATH_DSTAR_STEP) * dy;
+    else
+        return PATH_DSTAR_STEP * dy + (PATH_DSTAR_STEP_DIAG - PATH_DSTAR_STEP) * dx;
+}
+
+// cost of the step from cell u into the neighbour cell v, leaving a blocked
+// cell is allowed (e.g. a start close to an obstacle)
+int32_t PathDStar::edgeCost(int u, int v)
+{
+    int ux, uy, dx, dy, base;
+
+    if (cost[v] == PATH_DSTAR_COST_BLOCKED)
+        return PATH_DSTAR_INF;
+
+    ux = u / numY;
+    uy = u % numY;
+    dx = v / numY - ux;
+    dy = v % numY - uy;
+
+    if (dx && dy)
+    {
+        // no corner cutting
+        if ((cost[(ux + dx) * numY + uy] == PATH_DSTAR_COST_BLOCKED) ||
+            (cost[ux * numY + uy + dy]   == PATH_DSTAR_COST_BLOCKED))
+            return PATH_DSTAR_INF;
+
+        base = PATH_DSTAR_STEP_DIAG;
+    }
+    else
+    {
+        base = PATH_DSTAR_STEP;
+    }
+
+    return base + (base * cost[v]) / 16;
+}
+
+void PathDStar::calcKey(int cell, path_dstar_node *node)
+{
+    int32_t m;
+
+    m = (g[cell] < rhs[cell]) ? g[cell] : rhs[cell];
+
+    node->cell = cell;
+    node->k2   = m;
+    if (m >= PATH_DSTAR_INF)
+        node->k1 = PATH_DSTAR_INF;
+    else
+        node->k1 = m + heuristic(start, cell) + km;
+}
+
+int PathDStar::keyLess(path_dstar_node *a, path_dstar_node *b)
+{
+    return (a->k1 < b->k1) || ((a->k1 == b->k1) && (a->k2 < b->k2));
+}
+
+void PathDStar::updateVertex(int u)
+{
+    int     i, n, nb[8];
+    int32_t c, best;
+
+    if (u != goal)
+    {
+        best = PATH_DSTAR_INF;
+
+        n = neighbours(u, nb);
+        for (i = 0; i < n; i++)
+        {
+            if (g[nb[i]] >= PATH_DSTAR_INF)
+                continue;
+
+            c = edgeCost(u, nb[i]);
+            if ((c < PATH_DSTAR_INF) && (c + g[nb[i]] < best))
+                best = c + g[nb[i]];
+        }
+        rhs[u] = best;
+    }
+
+    if (heapPos[u] >= 0)
+        heapRemove(u);
+
+    if (g[u] != rhs[u])
+        heapInsert(u);
+}
+
+// 8-neighbourhood of a cell inside the grid
+int PathDStar::neighbours(int cell, int *nb)
+{
+    int ix, iy, n;
+
+    ix = cell / numY;
+    iy = cell % numY;
+    n  = 0;
+
+    if (ix > 0)
+    {
+        nb[n++] = cell - numY;
+        if (iy > 0)
+            nb[n++] = cell - numY - 1;
+        if (iy < numY - 1)
+            nb[n++] = cell - numY + 1;
+    }
+    if (ix < numX - 1)
+    {
+        nb[n++] = cell + numY;
+        if (iy > 0)
+            nb[n++] = cell + numY - 1;
+        if (iy < numY - 1)
+            nb[n++] = cell + numY + 1;
+    }
+    if (iy > 0)
+        nb[n++] = cell - 1;
+    if (iy < numY - 1)
+        nb[n++] = cell + 1;
+
+    return n;
+}
+
+//
+// open list (binary heap)
+//
+
+void PathDStar::heapInsert(int cell)
+{
+    calcKey(cell, &heap[heapNum]);
+    heapPos[cell] = heapNum;
+    heapNum++;
+    heapUpdate(heapNum - 1);
+}
+
+void PathDStar::heapRemove(int cell)
+{
+    int pos = heapPos[cell];
+
+    heapNum--;
+    heapPos[cell] = -1;
+
+    if (pos != heapNum)
+    {
+        heap[pos]               = heap[heapNum];
+        heapPos[heap[pos].cell] = pos;
+        heapUpdate(pos);
+    }
+}
+
+// restores the heap order after the key at pos changed
+void PathDStar::heapUpdate(int pos)
+{
+    int parent, child;
+
+    // up
+    while (pos > 0)
+    {
+        parent = (pos - 1) / 2;
+        if (!keyLess(&heap[pos], &heap[parent]))
+            break;
+        heapSwap(pos, parent);
+        pos = parent;
+    }
+
+    // down
+    while (1)
+    {
+        child = 2 * pos + 1;
+        if (child >= heapNum)
+            break;
+        if ((child + 1 < heapNum) && keyLess(&heap[child + 1], &heap[child]))
+            child++;
+        if (!keyLess(&heap[child], &heap[pos]))
+            break;
+        heapSwap(pos, child);
+        pos = child;
+    }
+}
+
+void PathDStar::heapSwap(int a, int b)
+{
+    path_dstar_node tmp;
+
+    tmp     = heap[a];
+    heap[a] = heap[b];
+    heap[b] = tmp;
+
+    heapPos[heap[a].cell] = a;
+    heapPos[heap[b].cell] = b;
+}
@@ -0,0 +1,107 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Matthias Hentschel <hentschel@rts.uni-hannover.de>
+ */
+
+#ifndef __PATH_DSTAR_H__
+#define __PATH_DSTAR_H__
+
+#include <inttypes.h>
+
+#define PATH_DSTAR_INF              0x3fffffff      // unreachable
+#define PATH_DSTAR_COST_BLOCKED     255             // cell cost of an obstacle
+#define PATH_DSTAR_STEP             10              // cost of a straight step
+#define PATH_DSTAR_STEP_DIAG        14              // cost of a diagonal step
+
+// open list entry
+typedef struct {
+    int32_t     k1;
+    int32_t     k2;
+    int32_t     cell;
+} path_dstar_node;
+
+/**
+ * D* Lite path planner on an 8-connected grid
+ *
+ * The search runs from the goal to the start, so after cost changes or a
+ * new start only the inconsistent cells are expanded again. Cells are
+ * indexed by ix * numY + iy like grid_map_data. Every cell has a cost of
+ * 0 - 254 (the step cost is multiplied by 1 + cost / 16) or is blocked
+ * (PATH_DSTAR_COST_BLOCKED). Diagonal steps must not cut a blocked cell.
+ */
+class PathDStar
+{
+    private:
+        int                 numX;
+        int                 numY;
+        int                 cellNum;
+        uint8_t             *cost;
+        int32_t             *g;
+        int32_t             *rhs;
+        int32_t             *heapPos;       // position in the open list, -1 if not open
+        path_dstar_node     *heap;
+        int                 heapNum;
+
+        int                 start;
+        int                 goal;
+        int                 last;
+        int32_t             km;
+        int                 expandNum;
+
+        int32_t  heuristic(int a, int b);
+        int32_t  edgeCost(int u, int v);
+        void     calcKey(int cell, path_dstar_node *node);
+        int      keyLess(path_dstar_node *a, path_dstar_node *b);
+        void     updateVertex(int u);
+        int      neighbours(int cell, int *nb);
+
+        void     heapInsert(int cell);
+        void     heapRemove(int cell);
+        void     heapUpdate(int pos);
+        void     heapSwap(int a, int b);
+
+    public:
+        PathDStar();
+        ~PathDStar();
+
+        int  init(int numX, int numY);
+        void setCost(int cell, uint8_t c);
+        void reset(int start, int goal);
+        void updateCost(int cell, uint8_t c);
+        void moveStart(int start);
+        int  computePath(int expandMax);
+        int  getPath(int *cells, int cellMax);
+        int32_t getPathCost(const int *cells, int num);
+
+        uint8_t getCost(int cell)
+        {
+            return cost[cell];
+        }
+
+        int  getExpandNum(void)
+        {
+            return expandNum;
+        }
+
+        int  getNumX(void)
+        {
+            return numX;
+        }
+
+        int  getNumY(void)
+        {
+            return numY;
+        }
+};
+
+#endif // __PATH_DSTAR_H__
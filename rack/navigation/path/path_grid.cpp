@@ -0,0 +1,450 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Matthias Hentschel <hentschel@rts.uni-hannover.de>
+ */
+
+#include "path_grid.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+// cell classes
+#define CELL_FREE                   0
+#define CELL_UNKNOWN                1
+#define CELL_OCCUPIED               2
+
+PathGrid::PathGrid()
+{
+    robotRadius       = 400;
+    safetyMargin      = 500;
+    occupiedThreshold = 180;
+    freeThreshold     = 100;
+    unknownCost       = 8;
+    cellMax           = 0;
+    occupancy         = NULL;
+    dist              = NULL;
+    clear();
+}
+
+PathGrid::~PathGrid()
+{
+    if (occupancy)
+        delete[] occupancy;
+    if (dist)
+        delete[] dist;
+}
+
+/**
+ * Allocates the grid
+ *
+ * @param cellMax Maximum number of cells of a grid map
+ *
+ * @return 0 on success, otherwise negative error code
+ */
+int PathGrid::init(int cellMax)
+{
+    if (cellMax <= 0)
+        return -EINVAL;
+
+    if (occupancy)
+        delete[] occupancy;
+    if (dist)
+        delete[] dist;
+
+    occupancy = new uint8_t[cellMax];
+    dist      = new uint16_t[cellMax];
+    if (!occupancy || !dist)
+        return -ENOMEM;
+
+    this->cellMax = cellMax;
+    clear();
+    return 0;
+}
+
+/**
+ * Sets the cost parameters, they are used from the next new grid on
+ *
+ * @param robotRadius       Radius of the robot in mm
+ * @param safetyMargin      Distance to the robot radius with additional costs in mm
+ * @param occupiedThreshold Lowest occupancy (0 - 255) of an obstacle
+ * @param freeThreshold     Highest occupancy (0 - 255) of a free cell
+ * @param unknownCost       Cost of a cell between both thresholds
+ */
+void PathGrid::setParam(int robotRadius, int safetyMargin, int occupiedThreshold,
+                        int freeThreshold, int unknownCost)
+{
+    this->robotRadius       = robotRadius;
+    this->safetyMargin      = safetyMargin;
+    this->occupiedThreshold = occupiedThreshold;
+    this->freeThreshold     = freeThreshold;
+    this->unknownCost       = unknownCost;
+}
+
+/**
+ * Forgets the grid, the next map is merged as a new grid
+ */
+void PathGrid::clear(void)
+{
+    offsetX = 0;
+    offsetY = 0;
+    scale   = 0;
+    numX    = 0;
+    numY    = 0;
+    range   = 0;
+}
+
+/**
+ * Merges a grid map into the grid and updates the cell costs of the planner
+ *
+ * A map which is inside the actual grid is merged and only the costs around
+ * its changed cells are updated. Any other map (e.g. the window of GridMap
+ * has moved) becomes the new grid, in this case the planner is initialised
+ * with its costs and has to start a new search.
+ *
+ * @return 1 for a new grid, 0 for a merged map, otherwise negative error code
+ */
+int PathGrid::merge(grid_map_data *map, PathDStar *planner)
+{
+    int     ix, iy, mx, my, ox, oy, ret;
+    int     x0, y0, x1, y1;
+    uint8_t *p_occ, *p_map;
+
+    if ((map->scale <= 0) || (map->gridNumX < 0) || (map->gridNumY < 0) ||
+        (map->gridNumX * map->gridNumY > cellMax))
+        return -EINVAL;
+
+    // map without changes
+    if ((map->gridNumX == 0) || (map->gridNumY == 0))
+        return 0;
+
+    ox = 0;
+    oy = 0;
+    if (numX > 0)
+    {
+        ox = (map->offsetX - offsetX) / map->scale;
+        oy = (map->offsetY - offsetY) / map->scale;
+    }
+
+    // new grid
+    if ((numX == 0) || (map->scale != scale) ||
+        ((map->offsetX - offsetX) % scale) || ((map->offsetY - offsetY) % scale) ||
+        (ox < 0) || (oy < 0) || (ox + map->gridNumX > numX) || (oy + map->gridNumY > numY))
+    {
+        offsetX = map->offsetX;
+        offsetY = map->offsetY;
+        scale   = map->scale;
+        numX    = map->gridNumX;
+        numY    = map->gridNumY;
+        range   = (robotRadius + safetyMargin + scale - 1) / scale;
+
+        memcpy(occupancy, map->occupancy, numX * numY);
+
+        ret = planner->init(numX, numY);
+        if (ret)
+        {
+            clear();
+            return ret;
+        }
+
+        computeCosts(planner, 0, 0, numX - 1, numY - 1, 0);
+        return 1;
+    }
+
+    // merge sub-grid and find the bounding box of the changed cells
+    x0 = numX;
+    y0 = numY;
+    x1 = -1;
+    y1 = -1;
+
+    p_map = map->occupancy;
+    for (mx = 0; mx < map->gridNumX; mx++)
+    {
+        ix    = ox + mx;
+        p_occ = &occupancy[ix * numY + oy];
+
+        for (my = 0; my < map->gridNumY; my++, p_occ++, p_map++)
+        {
+            if (cellClass(*p_occ) != cellClass(*p_map))
+            {
+                iy = oy + my;
+                if (ix < x0)
+                    x0 = ix;
+                if (ix > x1)
+                    x1 = ix;
+                if (iy < y0)
+                    y0 = iy;
+                if (iy > y1)
+                    y1 = iy;
+            }
+            *p_occ = *p_map;
+        }
+    }
+
+    if (x1 >= 0)
+    {
+        computeCosts(planner, x0 - range, y0 - range, x1 + range, y1 + range, 1);
+    }
+
+    return 0;
+}
+
+/**
+ * @return Index of the cell at the global position (x, y) in mm, -1 if
+ *         outside of the grid
+ */
+int PathGrid::posToCell(int x, int y)
+{
+    int ix, iy;
+
+    if (numX == 0)
+        return -1;
+
+    if ((x < offsetX) || (y < offsetY))
+        return -1;
+
+    ix = (x - offsetX) / scale;
+    iy = (y - offsetY) / scale;
+    if ((ix >= numX) || (iy >= numY))
+        return -1;
+
+    return ix * numY + iy;
+}
+
+/**
+ * Global position of the cell center in mm
+ */
+void PathGrid::cellToPos(int cell, int *x, int *y)
+{
+    *x = offsetX + (cell / numY) * scale + scale / 2;
+    *y = offsetY + (cell % numY) * scale + scale / 2;
+}
+
+/**
+ * @return Highest cell cost on the straight line from cell a to cell b
+ */
+int PathGrid::lineCost(PathDStar *planner, int a, int b)
+{
+    int x, y, x1, y1, dx, dy, sx, sy, err, e2, c, costMax;
+
+    x  = a / numY;
+    y  = a % numY;
+    x1 = b / numY;
+    y1 = b % numY;
+
+    dx  =  abs(x1 - x);
+    dy  = -abs(y1 - y);
+    sx  = (x < x1) ? 1 : -1;
+    sy  = (y < y1) ? 1 : -1;
+    err = dx + dy;
+
+    costMax = planner->getCost(a);
+
+    while ((x != x1) || (y != y1))
+    {
+        e2 = 2 * err;
+        if (e2 >= dy)
+        {
+            err += dy;
+            x   += sx;
+        }
+        if (e2 <= dx)
+        {
+            err += dx;
+            y   += sy;
+        }
+
+        c = planner->getCost(x * numY + y);
+        if (c == PATH_DSTAR_COST_BLOCKED)
+            return c;
+        if (c > costMax)
+            costMax = c;
+    }
+
+    return costMax;
+}
+
+/**
+ * Reduces a path of neighbouring cells to its corners
+ *
+ * A cell is skipped if the straight line from the previous corner is not
+ * more expensive than the cells of the path in between.
+ *
+ * @return Number of remaining cells
+ */
+int PathGrid::smooth(PathDStar *planner, int *cells, int cellNum)
+{
+    int i, j, num, c, costMax;
+
+    if (cellNum <= 2)
+        return cellNum;
+
+    num     = 1;
+    i       = 0;
+    costMax = planner->getCost(cells[0]);
+
+    for (j = 1; j < cellNum; j++)
+    {
+        c = planner->getCost(cells[j]);
+        if (c > costMax)
+            costMax = c;
+
+        if ((j - i > 1) && (lineCost(planner, cells[i], cells[j]) > costMax))
+        {
+            // new corner at the previous cell
+            i             = j - 1;
+            cells[num++]  = cells[i];
+            costMax       = planner->getCost(cells[i]);
+            if (c > costMax)
+                costMax = c;
+        }
+    }
+
+    cells[num++] = cells[cellNum - 1];
+    return num;
+}
+
+int PathGrid::cellClass(uint8_t occ)
+{
+    if (occ >= occupiedThreshold)
+        return CELL_OCCUPIED;
+    if (occ > freeThreshold)
+        return CELL_UNKNOWN;
+    return CELL_FREE;
+}
+
+// computes the costs of the cells x0..x1, y0..y1, the distances to the
+// obstacles are computed on the box enlarged by the influence range
+void PathGrid::computeCosts(PathDStar *planner, int x0, int y0, int x1, int y1,
+                            int incremental)
+{
+    int         ix, iy, bx0, by0, bx1, by1, d, dMax, cls, c;
+    int         radius, margin;
+    uint16_t    *p_dist;
+
+    if (x0 < 0)
+        x0 = 0;
+    if (y0 < 0)
+        y0 = 0;
+    if (x1 >= numX)
+        x1 = numX - 1;
+    if (y1 >= numY)
+        y1 = numY - 1;
+
+    bx0 = (x0 - range < 0) ? 0 : x0 - range;
+    by0 = (y0 - range < 0) ? 0 : y0 - range;
+    bx1 = (x1 + range >= numX) ? numX - 1 : x1 + range;
+    by1 = (y1 + range >= numY) ? numY - 1 : y1 + range;
+
+    dMax = 10 * (range + 1);
+
+    // chamfer distance transform (10 / 14), forward pass
+    for (ix = bx0; ix <= bx1; ix++)
+    {
+        p_dist = &dist[ix * numY];
+
+        for (iy = by0; iy <= by1; iy++)
+        {
+            if (cellClass(occupancy[ix * numY + iy]) == CELL_OCCUPIED)
+            {
+                p_dist[iy] = 0;
+                continue;
+            }
+
+            d = dMax;
+            if (ix > bx0)
+            {
+                if (p_dist[iy - numY] + 10 < d)
+                    d = p_dist[iy - numY] + 10;
+                if ((iy > by0) && (p_dist[iy - numY - 1] + 14 < d))
+                    d = p_dist[iy - numY - 1] + 14;
+                if ((iy < by1) && (p_dist[iy - numY + 1] + 14 < d))
+                    d = p_dist[iy - numY + 1] + 14;
+            }
+            if ((iy > by0) && (p_dist[iy - 1] + 10 < d))
+                d = p_dist[iy - 1] + 10;
+
+            p_dist[iy] = d;
+        }
+    }
+
+    // backward pass
+    for (ix = bx1; ix >= bx0; ix--)
+    {
+        p_dist = &dist[ix * numY];
+
+        for (iy = by1; iy >= by0; iy--)
+        {
+            d = p_dist[iy];
+            if (d == 0)
+                continue;
+
+            if (ix < bx1)
+            {
+                if (p_dist[iy + numY] + 10 < d)
+                    d = p_dist[iy + numY] + 10;
+                if ((iy > by0) && (p_dist[iy + numY - 1] + 14 < d))
+                    d = p_dist[iy + numY - 1] + 14;
+                if ((iy < by1) && (p_dist[iy + numY + 1] + 14 < d))
+                    d = p_dist[iy + numY + 1] + 14;
+            }
+            if ((iy < by1) && (p_dist[iy + 1] + 10 < d))
+                d = p_dist[iy + 1] + 10;
+
+            p_dist[iy] = d;
+        }
+    }
+
+    // cell costs, distances in mm * 10 / scale
+    radius = robotRadius * 10;
+    margin = safetyMargin * 10;
+
+    for (ix = x0; ix <= x1; ix++)
+    {
+        for (iy = y0; iy <= y1; iy++)
+        {
+            d   = dist[ix * numY + iy] * scale;
+            cls = cellClass(occupancy[ix * numY + iy]);
+
+            if ((cls == CELL_OCCUPIED) || (d < radius))
+            {
+                c = PATH_DSTAR_COST_BLOCKED;
+            }
+            else
+            {
+                c = 0;
+                if ((margin > 0) && (d < radius + margin))
+                {
+                    c = PATH_GRID_MARGIN_COST * (radius + margin - d) / margin;
+                }
+                if (cls == CELL_UNKNOWN)
+                {
+                    c += unknownCost;
+                }
+                if (c > PATH_GRID_COST_MAX)
+                {
+                    c = PATH_GRID_COST_MAX;
+                }
+            }
+
+            if (incremental)
+            {
+                planner->updateCost(ix * numY + iy, c);
+            }
+            else
+            {
+                planner->setCost(ix * numY + iy, c);
+            }
+        }
+    }
+}
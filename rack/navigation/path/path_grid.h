@@ -0,0 +1,85 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Matthias Hentschel <hentschel@rts.uni-hannover.de>
+ */
+
+#ifndef __PATH_GRID_H__
+#define __PATH_GRID_H__
+
+#include <navigation/grid_map_proxy.h>
+
+#include "path_dstar.h"
+
+#define PATH_GRID_MARGIN_COST       64              // cell cost at the robot radius
+#define PATH_GRID_COST_MAX          254             // highest cost of a free cell
+
+/**
+ * Cost map of the path planner
+ *
+ * Keeps a copy of the occupancy grid of a GridMap module and converts it
+ * into the cell costs of a PathDStar planner. Cells closer than the robot
+ * radius to an obstacle are blocked, cells inside the safety margin get a
+ * cost falling linearly with the distance and unknown cells an extra cost.
+ * Sub-grids inside the actual grid (changed tiles of GridMap) are merged and
+ * only the costs around the changed cells are computed again, so the
+ * planner can repair its search incrementally.
+ */
+class PathGrid
+{
+    private:
+        int         robotRadius;
+        int         safetyMargin;
+        int         occupiedThreshold;
+        int         freeThreshold;
+        int         unknownCost;
+
+        int         offsetX;
+        int         offsetY;
+        int         scale;
+        int         numX;
+        int         numY;
+        int         cellMax;
+        int         range;                  // cells influenced by an obstacle
+        uint8_t     *occupancy;
+        uint16_t    *dist;                  // chamfer distance, 10 per cell
+
+        int         cellClass(uint8_t occ);
+        void        computeCosts(PathDStar *planner, int x0, int y0, int x1, int y1,
+                                 int incremental);
+
+    public:
+        PathGrid();
+        ~PathGrid();
+
+        int  init(int cellMax);
+        void setParam(int robotRadius, int safetyMargin, int occupiedThreshold,
+                      int freeThreshold, int unknownCost);
+        void clear(void);
+        int  merge(grid_map_data *map, PathDStar *planner);
+        int  posToCell(int x, int y);
+        void cellToPos(int cell, int *x, int *y);
+        int  lineCost(PathDStar *planner, int a, int b);
+        int  smooth(PathDStar *planner, int *cells, int cellNum);
+
+        int  getNumX(void)
+        {
+            return numX;
+        }
+
+        int  getNumY(void)
+        {
+            return numY;
+        }
+};
+
+#endif // __PATH_GRID_H__
@@ -0,0 +1,816 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Matthias Hentschel <hentschel@rts.uni-hannover.de>
+ */
+
+#include "pilot_dwa.h"
+
+// spline output
+#define SPLINE_OUT_NONE             0
+#define SPLINE_OUT_CHOSEN           1
+#define SPLINE_OUT_ALL              2
+
+//
+// data structures
+//
+
+// external module parameter
+arg_table_t argTab[] = {
+
+    { ARGOPT_OPT, "chassisSys", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The system number of the chassis module, default 0", { 0 } },
+
+    { ARGOPT_OPT, "chassisInst", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The instance number of the chassis module, default 0", { 0 } },
+
+    { ARGOPT_OPT, "positionSys", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The system number of the position module, default 0", { 0 } },
+
+    { ARGOPT_OPT, "positionInst", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The instance number of the position module, default 0", { 0 } },
+
+    { ARGOPT_OPT, "scan2dSys", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The system number of the scan2d module, default 0", { 0 } },
+
+    { ARGOPT_OPT, "scan2dInst", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The instance number of the scan2d module, default 0", { 0 } },
+
+    { ARGOPT_OPT, "speedMax", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Maximum speed in mm/s, default 1000 mm/s", { 1000 } },
+
+    { ARGOPT_OPT, "omegaMax", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Maximum angular velocity in deg/s, default 60 deg/s", { 60 } },
+
+    { ARGOPT_OPT, "omegaAcc", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Maximum angular acceleration in deg/s^2, default 120 deg/s^2", { 120 } },
+
+    { ARGOPT_OPT, "speedSampleNum", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Number of speed samples of the dynamic window, default 11", { 11 } },
+
+    { ARGOPT_OPT, "omegaSampleNum", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Number of omega samples of the dynamic window, default 31", { 31 } },
+
+    { ARGOPT_OPT, "predictTime", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Prediction time of the arcs in ms, default 2000 ms", { 2000 } },
+
+    { ARGOPT_OPT, "timeBudget", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Time for the evaluation of the arcs in ms, default 20 ms", { 20 } },
+
+    { ARGOPT_OPT, "headingWeight", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Weight of the heading in percent, default 60", { 60 } },
+
+    { ARGOPT_OPT, "clearanceWeight", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Weight of the clearance in percent, default 25", { 25 } },
+
+    { ARGOPT_OPT, "speedWeight", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Weight of the speed in percent, default 15", { 15 } },
+
+    { ARGOPT_OPT, "destTolerance", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Distance to the destination to stop in mm, default 200 mm", { 200 } },
+
+    { ARGOPT_OPT, "splineOut", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Splines in the pilot data (0 = none, 1 = chosen arc, 2 = all admissible arcs), "
+      "default 2", { 2 } },
+
+    { 0, "", 0, 0, "", { 0 } } // last entry
+};
+
+/*******************************************************************************
+ *   !!! REALTIME CONTEXT !!!
+ *
+ *   moduleOn,
+ *   moduleOff,
+ *   moduleLoop,
+ *   moduleCommand,
+ *
+ *   own realtime user functions
+ ******************************************************************************/
+ int  PilotDwa::moduleOn(void)
+{
+    int             ret;
+
+    // get dynamic module parameter
+    speedMax        = getInt32Param("speedMax");
+    omegaMax        = (float)getInt32Param("omegaMax") * M_PI / 180.0f;
+    omegaAcc        = (float)getInt32Param("omegaAcc") * M_PI / 180.0f;
+    speedSampleNum  = getInt32Param("speedSampleNum");
+    omegaSampleNum  = getInt32Param("omegaSampleNum");
+    predictTime     = getInt32Param("predictTime");
+    timeBudget      = getInt32Param("timeBudget");
+    headingWeight   = (float)getInt32Param("headingWeight") / 100.0f;
+    clearanceWeight = (float)getInt32Param("clearanceWeight") / 100.0f;
+    speedWeight     = (float)getInt32Param("speedWeight") / 100.0f;
+    destTolerance   = getInt32Param("destTolerance");
+    splineOut       = getInt32Param("splineOut");
+
+    if (speedSampleNum < 1)
+        speedSampleNum = 1;
+    if (omegaSampleNum < 1)
+        omegaSampleNum = 1;
+    if (speedSampleNum * omegaSampleNum > PILOT_DWA_SAMPLE_MAX)
+    {
+        omegaSampleNum = PILOT_DWA_SAMPLE_MAX / speedSampleNum;
+        GDOS_WARNING("Too many samples, omegaSampleNum limited to %d\n", omegaSampleNum);
+    }
+
+    // turn on chassis module
+    ret = chassis->on();
+    if (ret)
+    {
+        GDOS_ERROR("Can't turn on Chassis(%d/%d), code = %d\n",
+                   chassisSys, chassisInst, ret);
+        return ret;
+    }
+
+    // get parameter data from chassis module
+    ret = chassis->getParam(&chasParData, sizeof(chassis_param_data));
+    if (ret)
+    {
+        GDOS_ERROR("Can't get parameter from Chassis(%d/%d), code = %d\n",
+                   chassisSys, chassisInst, ret);
+        return ret;
+    }
+
+    // turn on position module
+    ret = position->on();
+    if (ret)
+    {
+        GDOS_ERROR("Can't turn on Position(%d/%d), code = %d\n",
+                   positionSys, positionInst, ret);
+        return ret;
+    }
+
+    // turn on scan2d module
+    ret = scan2d->on();
+    if (ret)
+    {
+        GDOS_ERROR("Can't turn on Scan2d(%d/%d), code = %d\n",
+                   scan2dSys, scan2dInst, ret);
+        return ret;
+    }
+
+    // get continuous data from scan2d module
+    scan2dDataMbx.clean();
+    ret = scan2d->getContData(0, &scan2dDataMbx, &dataBufferPeriodTime);
+    if (ret)
+    {
+        GDOS_ERROR("Can't get continuous data from Scan2d(%d/%d), code = %d\n",
+                   scan2dSys, scan2dInst, ret);
+        return ret;
+    }
+
+    // upper bound pilot speed to chassis parameter
+    if (speedMax > chasParData.vxMax)
+    {
+        speedMax = chasParData.vxMax;
+        GDOS_PRINT("speedMax %f m/s\n", (float)speedMax / 1000.0f);
+    }
+    if (omegaMax > chasParData.omegaMax)
+    {
+        omegaMax = chasParData.omegaMax;
+        GDOS_PRINT("omegaMax %f deg/s\n", omegaMax * 180.0f / M_PI);
+    }
+    if (chasParData.decMax <= 0)
+    {
+        GDOS_ERROR("Invalid deceleration of Chassis(%d/%d)\n",
+                   chassisSys, chassisInst);
+        return -EINVAL;
+    }
+
+    GDOS_PRINT("Sampling %d x %d arcs, pilot is waiting for a new destination...\n",
+               speedSampleNum, omegaSampleNum);
+
+    // init global variables
+    pilotState  = PILOT_STATE_IDLE;
+    sampleNum   = 0;
+    speed       = 0;
+    omega       = 0.0f;
+    obstacle.clear();
+
+    return RackDataModule::moduleOn(); // has to be last command in moduleOn();
+}
+
+
+void PilotDwa::moduleOff(void)
+{
+    RackDataModule::moduleOff();        // has to be first command in moduleOff();
+
+    chassis->move(0, 0, 0.0f);
+    scan2d->stopContData(&scan2dDataMbx);
+}
+
+
+// realtime context
+int  PilotDwa::moduleLoop(void)
+{
+    int          i, best, ret;
+    int          destX, destY, destDistance;
+    float        dx, dy, sinRho, cosRho;
+    RackMessage  msgInfo;
+    pilot_data*  pilotData = NULL;
+
+    // get continuous data from scan2d module
+    ret = scan2dDataMbx.recvDataMsgTimed(rackTime.toNano(2 * dataBufferPeriodTime), &scan2dMsg.data,
+                                         sizeof(scan2dMsg), &msgInfo);
+    if (ret)
+    {
+        GDOS_ERROR("Can't read continuous data from Scan2d(%d/%d), code = %d\n",
+                   scan2dSys, scan2dInst, ret);
+        return ret;
+    }
+
+    // invalid data received
+    if (msgInfo.getType() != MSG_DATA ||
+        msgInfo.getSrc()  != scan2d->getDestAdr())
+    {
+        GDOS_ERROR("Received unexpected message from %x to %x, type %d on scan2dDataMbx\n",
+                   msgInfo.getSrc(), msgInfo.getDest(), msgInfo.getType());
+
+        if (msgInfo.getType() > 0)
+        {
+            scan2dDataMbx.sendMsgReply(MSG_ERROR, &msgInfo);
+        }
+        return -ECOMM;
+    }
+
+    // message parsing
+    Scan2dData::parse(&msgInfo);
+
+    // build the obstacle grid once for all arcs
+    obstacle.update(&scan2dMsg.data);
+
+    // get current position
+    ret = position->getData(&positionData, sizeof(position_data), scan2dMsg.data.recordingTime);
+    if (ret)
+    {
+        GDOS_ERROR("Can't get data from Position(%d/%d), code = %d\n",
+                   positionSys, positionInst, ret);
+        return ret;
+    }
+
+    best         = -1;
+    destDistance = -1;
+    sampleNum    = 0;
+
+    if (pilotState == PILOT_STATE_RUNNING)
+    {
+        // destination in robot coordinates
+        dx     = (float)(pilotDest.pos.x - positionData.pos.x);
+        dy     = (float)(pilotDest.pos.y - positionData.pos.y);
+        sinRho = sinf(positionData.pos.rho);
+        cosRho = cosf(positionData.pos.rho);
+        destX  = (int)( dx * cosRho + dy * sinRho);
+        destY  = (int)(-dx * sinRho + dy * cosRho);
+        destDistance = (int)sqrtf(dx * dx + dy * dy);
+
+        if (destDistance <= destTolerance)
+        {
+            GDOS_PRINT("Destination reached, x = %dmm, y = %dmm\n",
+                       pilotDest.pos.x, pilotDest.pos.y);
+            pilotState = PILOT_STATE_IDLE;
+        }
+        else
+        {
+            best = evaluateWindow(destX, destY, destDistance);
+            if (best < 0)
+            {
+                GDOS_DBG_INFO("No admissible arc, stopping\n");
+            }
+        }
+    }
+
+    if (best >= 0)
+    {
+        speed = sample[best].speed;
+        omega = sample[best].omega;
+    }
+    else
+    {
+        speed = 0;
+        omega = 0.0f;
+    }
+
+    // move chassis
+    ret = chassis->move(speed, 0, omega);
+    if (ret)
+    {
+        GDOS_ERROR("Can't send move command to chassis, code = %d\n", ret);
+        return ret;
+    }
+
+    // get datapointer from rackdatabuffer
+    pilotData = (pilot_data *)getDataBufferWorkSpace();
+
+    pilotData->recordingTime  = scan2dMsg.data.recordingTime;
+    memcpy(&(pilotData->pos), &positionData.pos, sizeof(pilotData->pos));
+    memcpy(&(pilotData->dest), &pilotDest.pos, sizeof(pilotData->dest));
+    pilotData->speed          = speed;
+    pilotData->curve          = (speed != 0) ? omega / (float)speed : 0.0f;
+    pilotData->distanceToDest = destDistance;
+    pilotData->pilotState     = pilotState;
+    pilotData->splineNum      = 0;
+
+    if ((splineOut >= SPLINE_OUT_CHOSEN) && (best >= 0))
+    {
+        fillSpline(&pilotData->spline[pilotData->splineNum++], &sample[best]);
+    }
+
+    if (splineOut >= SPLINE_OUT_ALL)
+    {
+        for (i = 0; i < sampleNum; i++)
+        {
+            if ((i != best) && (sample[i].score >= 0.0f))
+            {
+                fillSpline(&pilotData->spline[pilotData->splineNum++], &sample[i]);
+            }
+        }
+    }
+
+    putDataBufferWorkSpace(sizeof(pilot_data) +
+                           pilotData->splineNum * sizeof(polar_spline));
+
+    return 0;
+}
+
+int  PilotDwa::moduleCommand(RackMessage *msgInfo)
+{
+    pilot_dest_data     *pDest;
+
+    switch(msgInfo->getType())
+    {
+        // new pilot destination received
+        case MSG_PILOT_SET_DESTINATION:
+            if (status == MODULE_STATE_ENABLED)
+            {
+                // message parsing
+                pDest = PilotDestData::parse(msgInfo);
+
+                memcpy(&pilotDest, pDest, sizeof(pilot_dest_data));
+                pilotState = PILOT_STATE_RUNNING;
+
+                GDOS_PRINT("Received new destination, x = %dmm, y = %dmm, rho = %adeg\n",
+                           pilotDest.pos.x, pilotDest.pos.y, pilotDest.pos.rho);
+
+                cmdMbx.sendMsgReply(MSG_OK, msgInfo);
+            }
+            else
+            {
+                cmdMbx.sendMsgReply(MSG_ERROR, msgInfo);
+            }
+            break;
+
+        default:
+            // not for me -> ask RackDataModule
+            return RackDataModule::moduleCommand(msgInfo);
+      }
+      return 0;
+}
+
+/**
+ * Evaluates the arcs of the dynamic window
+ *
+ * The speed rows are evaluated from the current speed outwards. If the time
+ * budget is exceeded the remaining rows are skipped.
+ *
+ * @return index of the best arc, -1 if no arc is admissible
+ */
+int PilotDwa::evaluateWindow(int destX, int destY, int destDistance)
+{
+    int          i, j, k, row, best;
+    int          periodTime, speedLo, speedHi, speedDest, speedRow;
+    float        omegaLo, omegaHi;
+    rack_time_t  timeout;
+
+    periodTime = dataBufferPeriodTime;
+    if (periodTime <= 0)
+        periodTime = 100;
+
+    // speed window, limited by the braking distance to the destination
+    speedDest = speedMax;
+    if ((pilotDest.speed > 0) && (pilotDest.speed < speedDest))
+        speedDest = pilotDest.speed;
+    i = (int)sqrtf(2.0f * chasParData.decMax * destDistance);
+    if (i < speedDest)
+        speedDest = i;
+
+    speedLo = speed - chasParData.decMax * periodTime / 1000;
+    speedHi = speed + chasParData.accMax * periodTime / 1000;
+    if (speedLo < 0)
+        speedLo = 0;
+    if (speedHi > speedDest)
+        speedHi = speedDest;
+    if (speedLo > speedHi)
+        speedLo = speedHi;
+
+    // omega window
+    omegaLo = omega - omegaAcc * (float)periodTime / 1000.0f;
+    omegaHi = omega + omegaAcc * (float)periodTime / 1000.0f;
+    if (omegaLo < -omegaMax)
+        omegaLo = -omegaMax;
+    if (omegaHi > omegaMax)
+        omegaHi = omegaMax;
+    if (omegaLo > omegaHi)
+        omegaLo = omegaHi;
+
+    // current speed row
+    row = 0;
+    if ((speedSampleNum > 1) && (speedHi > speedLo))
+        row = (speed - speedLo) * (speedSampleNum - 1) / (speedHi - speedLo);
+    if (row > speedSampleNum - 1)
+        row = speedSampleNum - 1;
+
+    timeout   = rackTime.get() + timeBudget;
+    best      = -1;
+    sampleNum = 0;
+
+    for (k = 0; k < 2 * speedSampleNum; k++)
+    {
+        // row, row + 1, row - 1, row + 2, ...
+        i = (k & 1) ? row - (k + 1) / 2 : row + k / 2;
+        if ((i < 0) || (i >= speedSampleNum))
+            continue;
+
+        if ((timeBudget > 0) && (sampleNum > 0) && (rackTime.get() > timeout))
+        {
+            GDOS_DBG_DETAIL("Time budget exceeded, %d arcs evaluated\n", sampleNum);
+            break;
+        }
+
+        if (speedSampleNum > 1)
+            speedRow = speedLo + (speedHi - speedLo) * i / (speedSampleNum - 1);
+        else
+            speedRow = speedHi;
+
+        for (j = 0; j < omegaSampleNum; j++)
+        {
+            sample[sampleNum].speed = speedRow;
+            if (omegaSampleNum > 1)
+                sample[sampleNum].omega = omegaLo + (omegaHi - omegaLo) * (float)j /
+                                                    (float)(omegaSampleNum - 1);
+            else
+                sample[sampleNum].omega = 0.5f * (omegaLo + omegaHi);
+
+            evaluateArc(&sample[sampleNum], destX, destY);
+
+            if ((sample[sampleNum].score >= 0.0f) &&
+                ((best < 0) || (sample[sampleNum].score > sample[best].score)))
+            {
+                best = sampleNum;
+            }
+            sampleNum++;
+        }
+    }
+
+    return best;
+}
+
+/**
+ * Scores an arc by heading, clearance and speed
+ *
+ * An arc is admissible if the robot can stop in front of the next obstacle
+ * on the arc.
+ *
+ * @return score of the arc, < 0 if the arc is not admissible
+ */
+float PilotDwa::evaluateArc(pilot_dwa_sample *p_sample, int destX, int destY)
+{
+    int         width, front, brake, testLength, free, distMin;
+    float       heading, clearance, velocity, angle;
+    position_2d pos;
+
+    width = chasParData.boundaryLeft;
+    if (chasParData.boundaryRight > width)
+        width = chasParData.boundaryRight;
+    width += chasParData.safetyMargin;
+    front  = chasParData.boundaryFront + chasParData.safetyMargin;
+
+    // rotation on the spot
+    if ((p_sample->speed < chasParData.vxMin) || (p_sample->speed <= 0))
+    {
+        p_sample->speed  = 0;
+        p_sample->radius = 0;
+        p_sample->length = 0;
+
+        distMin = obstacle.getDistance(0, 0);
+        if ((p_sample->omega != 0.0f) && (distMin != OBSTACLE_TOOL_DIST_MAX) &&
+            (distMin * distMin <= front * front + width * width))
+        {
+            p_sample->score = -1.0f;
+            return p_sample->score;
+        }
+
+        pos.x   = 0;
+        pos.y   = 0;
+        pos.rho = p_sample->omega * (float)predictTime / 1000.0f;
+        free    = 0;
+    }
+    else
+    {
+        if (p_sample->omega != 0.0f)
+            p_sample->radius = curve2Radius(p_sample->omega / (float)p_sample->speed);
+        else
+            p_sample->radius = 0;
+
+        if ((p_sample->radius != 0) &&
+            (abs(p_sample->radius) < chasParData.minTurningRadius))
+        {
+            p_sample->score = -1.0f;
+            return p_sample->score;
+        }
+
+        p_sample->length = p_sample->speed * predictTime / 1000;
+        if ((p_sample->radius != 0) && (p_sample->length > M_PI * abs(p_sample->radius)))
+            p_sample->length = (int)(M_PI * abs(p_sample->radius));
+
+        // the robot has to stop in front of the next obstacle
+        brake = p_sample->speed * p_sample->speed / (2 * chasParData.decMax);
+
+        testLength = p_sample->length;
+        if (brake > testLength)
+            testLength = brake;
+
+        free = obstacle.arcClearance(p_sample->radius, testLength + front, width,
+                                     &distMin) - front;
+        if (free < brake)
+        {
+            p_sample->score = -1.0f;
+            return p_sample->score;
+        }
+
+        predictPos(p_sample->radius, p_sample->length, &pos);
+    }
+
+    // heading to the destination at the end of the arc
+    angle   = atan2f((float)(destY - pos.y), (float)(destX - pos.x)) - pos.rho;
+    heading = 1.0f - fabsf(normaliseAngleSym0(angle)) / M_PI;
+
+    // clearance along the arc
+    clearance = (float)(distMin - width) / (float)(2 * width);
+    if (clearance > 1.0f)
+        clearance = 1.0f;
+    if (clearance < 0.0f)
+        clearance = 0.0f;
+
+    velocity = (float)p_sample->speed / (float)speedMax;
+
+    p_sample->score = headingWeight * heading + clearanceWeight * clearance +
+                      speedWeight * velocity;
+    return p_sample->score;
+}
+
+// end position of an arc in robot coordinates
+void PilotDwa::predictPos(int radius, int length, position_2d *p_pos)
+{
+    float phi;
+
+    if (radius == 0)
+    {
+        p_pos->x   = length;
+        p_pos->y   = 0;
+        p_pos->rho = 0.0f;
+    }
+    else
+    {
+        phi        = (float)length / (float)abs(radius);
+        p_pos->x   = (int)( abs(radius) * sinf(phi));
+        p_pos->y   = (int)( radius * (1.0f - cosf(phi)));
+        p_pos->rho = (float)length / (float)radius;
+    }
+}
+
+// arc as spline in world coordinates
+void PilotDwa::fillSpline(polar_spline *p_spline, pilot_dwa_sample *p_sample)
+{
+    position_2d end;
+    float       sinRho, cosRho;
+
+    sinRho = sinf(positionData.pos.rho);
+    cosRho = cosf(positionData.pos.rho);
+
+    predictPos(p_sample->radius, p_sample->length, &end);
+
+    memset(&p_spline->basepoint, 0, sizeof(p_spline->basepoint));
+    p_spline->startPos.x    = positionData.pos.x;
+    p_spline->startPos.y    = positionData.pos.y;
+    p_spline->startPos.rho  = positionData.pos.rho;
+    p_spline->endPos.x      = positionData.pos.x + (int)(end.x * cosRho - end.y * sinRho);
+    p_spline->endPos.y      = positionData.pos.y + (int)(end.x * sinRho + end.y * cosRho);
+    p_spline->endPos.rho    = normaliseAngle(positionData.pos.rho + end.rho);
+    p_spline->centerPos.x   = positionData.pos.x - (int)(p_sample->radius * sinRho);
+    p_spline->centerPos.y   = positionData.pos.y + (int)(p_sample->radius * cosRho);
+    p_spline->centerPos.rho = 0.0f;
+    p_spline->length        = p_sample->length;
+    p_spline->radius        = p_sample->radius;
+    p_spline->vMax          = p_sample->speed;
+    p_spline->vStart        = p_sample->speed;
+    p_spline->vEnd          = p_sample->speed;
+    p_spline->accMax        = chasParData.accMax;
+    p_spline->decMax        = chasParData.decMax;
+    p_spline->type          = 0;
+    p_spline->request       = 0;
+    p_spline->lbo           = 0;
+}
+
+
+ /*******************************************************************************
+ *   !!! NON REALTIME CONTEXT !!!
+ *
+ *   moduleInit,
+ *   moduleCleanup,
+ *   Constructor,
+ *   Destructor,
+ *   main,
+ *
+ *   own non realtime user functions
+ ******************************************************************************/
+
+// init_flags (for init and cleanup)
+#define INIT_BIT_DATA_MODULE        0
+#define INIT_BIT_MBX_WORK           1
+#define INIT_BIT_MBX_SCAN2D         2
+#define INIT_BIT_PROXY_CHASSIS      3
+#define INIT_BIT_PROXY_POSITION     4
+#define INIT_BIT_PROXY_SCAN2D       5
+
+int  PilotDwa::moduleInit(void)
+{
+    int ret;
+
+    // call RackDataModule init function (first command in init)
+    ret = RackDataModule::moduleInit();
+    if (ret)
+    {
+        return ret;
+    }
+    initBits.setBit(INIT_BIT_DATA_MODULE);
+
+    //
+    // create mailboxes
+    //
+
+    // work mailbox
+    ret = createMbx(&workMbx, 10, sizeof(chassis_param_data),
+                    MBX_IN_KERNELSPACE | MBX_SLOT);
+    if (ret)
+    {
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_MBX_WORK);
+
+    // scan2d mailbox
+    ret = createMbx(&scan2dDataMbx, 2, sizeof(scan2d_data_msg),
+                    MBX_IN_KERNELSPACE | MBX_SLOT);
+    if (ret)
+    {
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_MBX_SCAN2D);
+
+
+    //
+    // create Proxys
+    //
+
+    // chassis proxy
+    chassis = new ChassisProxy(&workMbx, chassisSys, chassisInst);
+    if (!chassis)
+    {
+        ret = -ENOMEM;
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_PROXY_CHASSIS);
+
+    // position proxy
+    position = new PositionProxy(&workMbx, positionSys, positionInst);
+    if (!position)
+    {
+        ret = -ENOMEM;
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_PROXY_POSITION);
+
+    // scan2d proxy
+    scan2d = new Scan2dProxy(&workMbx, scan2dSys, scan2dInst);
+    if (!scan2d)
+    {
+        ret = -ENOMEM;
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_PROXY_SCAN2D);
+
+    return 0;
+
+init_error:
+    moduleCleanup();
+    return ret;
+}
+
+
+void PilotDwa::moduleCleanup(void)
+{
+    // call RackDataModule cleanup function
+    if (initBits.testAndClearBit(INIT_BIT_DATA_MODULE))
+    {
+        RackDataModule::moduleCleanup();
+    }
+
+    //
+    // free proxies
+    //
+    if (initBits.testAndClearBit(INIT_BIT_PROXY_SCAN2D))
+    {
+        delete scan2d;
+    }
+
+    if (initBits.testAndClearBit(INIT_BIT_PROXY_POSITION))
+    {
+        delete position;
+    }
+
+    if (initBits.testAndClearBit(INIT_BIT_PROXY_CHASSIS))
+    {
+        delete chassis;
+    }
+
+    //
+    // delete mailboxes
+    //
+    if (initBits.testAndClearBit(INIT_BIT_MBX_SCAN2D))
+    {
+        destroyMbx(&scan2dDataMbx);
+    }
+
+    if (initBits.testAndClearBit(INIT_BIT_MBX_WORK))
+    {
+        destroyMbx(&workMbx);
+    }
+}
+
+
+PilotDwa::PilotDwa()
+      : RackDataModule( MODULE_CLASS_ID,
+                    5000000000llu,    // 5s datatask error sleep time
+                    16,               // command mailbox slots
+                    48,               // command mailbox data size per slot
+                    MBX_IN_KERNELSPACE | MBX_SLOT,  // command mailbox flags
+                    5,                // max buffer entries
+                    10)               // data buffer listener
+{
+    // get static module parameter
+    chassisSys   = getIntArg("chassisSys", argTab);
+    chassisInst  = getIntArg("chassisInst", argTab);
+    positionSys  = getIntArg("positionSys", argTab);
+    positionInst = getIntArg("positionInst", argTab);
+    scan2dSys    = getIntArg("scan2dSys", argTab);
+    scan2dInst   = getIntArg("scan2dInst", argTab);
+
+    memset(&pilotDest, 0, sizeof(pilotDest));
+
+    dataBufferMaxDataSize   = sizeof(pilot_data_msg);
+}
+
+
+int  main(int argc, char *argv[])
+{
+    int ret;
+
+    // get args
+    ret = RackModule::getArgs(argc, argv, argTab, "PilotDwa");
+    if (ret)
+    {
+        printf("Invalid arguments -> EXIT \n");
+        return ret;
+    }
+
+    PilotDwa *pInst;
+
+    // create new PilotDwa
+    pInst = new PilotDwa();
+    if (!pInst)
+    {
+        printf("Can't create new PilotDwa -> EXIT\n");
+        return -ENOMEM;
+    }
+
+    // init
+    ret = pInst->moduleInit();
+    if (ret)
+        goto exit_error;
+
+    pInst->run();
+    return 0;
+
+exit_error:
+    delete (pInst);
+    return ret;
+}
@@ -0,0 +1,132 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Matthias Hentschel <hentschel@rts.uni-hannover.de>
+ */
+
+#ifndef __PILOT_DWA_H__
+#define __PILOT_DWA_H__
+
+#include <main/rack_data_module.h>
+
+#include <drivers/chassis_proxy.h>
+#include <navigation/pilot_proxy.h>
+#include <navigation/position_proxy.h>
+#include <main/pilot_tool.h>
+#include <main/angle_tool.h>
+#include <perception/scan2d_proxy.h>
+
+// define module class
+#define MODULE_CLASS_ID             PILOT
+
+#define PILOT_DWA_SAMPLE_MAX        PILOT_DATA_SPLINE_MAX
+
+// scan_2d data message (use max message size)
+typedef struct {
+    scan2d_data   data;
+    scan_point    point[SCAN2D_POINT_MAX];
+} __attribute__((packed)) scan2d_data_msg;
+
+// pilot data message (chosen arc and all evaluated arcs)
+typedef struct {
+     pilot_data        data;
+     polar_spline      spline[PILOT_DWA_SAMPLE_MAX];
+} __attribute__((packed)) pilot_data_msg;
+
+// evaluated arc of the dynamic window
+typedef struct {
+    int         speed;                      // [mm/s]
+    float       omega;                      // [rad/s]
+    int         radius;                     // [mm] 0 = straight or rotation
+    int         length;                     // [mm] predicted length of the arc
+    float       score;                      // < 0 if the arc is not admissible
+} pilot_dwa_sample;
+
+/**
+ * Pilot Dynamic Window
+ *
+ * Samples a dense grid of (speed, omega) arcs inside the dynamic window of
+ * the chassis and chooses the best arc by heading, clearance and speed.
+ *
+ * @ingroup modules_pilot
+ */
+class PilotDwa : public RackDataModule {
+      private:
+
+        // external module parameter
+        int                 chassisSys;
+        int                 chassisInst;
+        int                 positionSys;
+        int                 positionInst;
+        int                 scan2dSys;
+        int                 scan2dInst;
+        int                 speedMax;
+        float               omegaMax;
+        float               omegaAcc;
+        int                 speedSampleNum;
+        int                 omegaSampleNum;
+        int                 predictTime;
+        int                 timeBudget;
+        float               headingWeight;
+        float               clearanceWeight;
+        float               speedWeight;
+        int                 destTolerance;
+        int                 splineOut;
+
+        // mailboxes
+        RackMailbox         workMbx;                // communication
+        RackMailbox         scan2dDataMbx;          // scan2d data
+
+        // proxies
+        ChassisProxy*       chassis;
+        PositionProxy*      position;
+        Scan2dProxy*        scan2d;
+
+        // data structures
+        chassis_param_data  chasParData;
+        position_data       positionData;
+        scan2d_data_msg     scan2dMsg;
+        ObstacleTool        obstacle;               // obstacle grid of scan2dMsg
+        pilot_dest_data     pilotDest;
+        pilot_dwa_sample    sample[PILOT_DWA_SAMPLE_MAX];
+
+        // variables
+        int                 pilotState;
+        int                 sampleNum;
+        int                 speed;
+        float               omega;
+
+        int      evaluateWindow(int destX, int destY, int destDistance);
+        float    evaluateArc(pilot_dwa_sample *p_sample, int destX, int destY);
+        void     predictPos(int radius, int length, position_2d *p_pos);
+        void     fillSpline(polar_spline *p_spline, pilot_dwa_sample *p_sample);
+
+      protected:
+        // -> realtime context
+        int      moduleOn(void);
+        int      moduleLoop(void);
+        void     moduleOff(void);
+        int      moduleCommand(RackMessage *msgInfo);
+
+        // -> non realtime context
+        void     moduleCleanup(void);
+
+      public:
+        // constructor und destructor
+        PilotDwa();
+        ~PilotDwa() {};
+
+        // -> non realtime context
+        int  moduleInit(void);
+};
+
+#endif // __PILOT_DWA_H__
@@ -192,6 +192,7 @@ arg_table_t argTab[] = {
 
         scan2dMsg.data.pointNum = 0;
         scan2dDataMissing = 0;
+        obstacle.clear();
     }
 
     GDOS_PRINT("maxSpeed %f m/s, minRadius %f m  Scan2D(%i/%i)\n",
@@ -322,14 +323,10 @@ int  PilotJoystick::moduleLoop(void)
     if (scan2dInst >= 0) // scan2d is not used if id is -1
     {
         s2dMsg.clear();
-        do
-        {
-            ret = scan2dMbx.recvDataMsgIf(&scan2dMsg.data,
-                                          sizeof(scan2d_data_msg), &s2dMsg);
-            if (ret && ret != -EWOULDBLOCK) // error
-                return ret;
-        }
-        while (!ret);
+        ret = scan2dMbx.recvLatest(&scan2dMsg.data, sizeof(scan2d_data_msg),
+                                   &s2dMsg);
+        if (ret && ret != -EWOULDBLOCK) // error
+            return ret;
 
         // joystick data message received
 
@@ -338,6 +335,9 @@ int  PilotJoystick::moduleLoop(void)
         {
             scan2dDataMissing = 0;
             Scan2dData::parse(&s2dMsg);
+
+            // build the obstacle grid for the speed limitation
+            obstacle.update(&scan2dMsg.data);
         }
         else
         {
@@ -364,7 +364,7 @@ int  PilotJoystick::moduleLoop(void)
             if(joystickSpeed >= 0)
             {
                 speedSafe = safeSpeed(2 * chasParData.vxMax, curve2Radius(joystickCurve), NULL,
-                                   &scan2dMsg.data, &chasParData);
+                                   &obstacle, &chasParData);
 
                 if(joystickSpeed < speedSafe)
                 {
@@ -378,7 +378,7 @@ int  PilotJoystick::moduleLoop(void)
             else
             {
                 speedSafe = safeSpeed(-2 * chasParData.vxMax, curve2Radius(joystickCurve), NULL,
-                                   &scan2dMsg.data, &chasParData);
+                                   &obstacle, &chasParData);
 
                 if(joystickSpeed > speedSafe)
                 {
@@ -442,7 +442,7 @@ int  PilotJoystick::moduleLoop(void)
     else
     {
         speedSide = safeSpeedSide(joystickSpeedSide,  NULL,
-                                  &scan2dMsg.data, &chasParData);
+                                  &obstacle, &chasParData);
 
         ret = chassis->move(speed, speedSide, omega);
         if (ret)
@@ -586,7 +586,7 @@ int  PilotJoystick::moduleInit(void)
 
     // scan2d
     ret = createMbx(&scan2dMbx, 2, sizeof(scan2d_data_msg),
-                    MBX_IN_KERNELSPACE | MBX_SLOT);
+                    MBX_IN_KERNELSPACE | MBX_SLOT | MBX_LATEST);
     if (ret)
     {
         goto init_error;
@@ -86,6 +86,7 @@ class PilotJoystick : public RackDataModule {
         joystick_data       jstkData;
         chassis_param_data  chasParData;
         scan2d_data_msg     scan2dMsg;
+        ObstacleTool        obstacle;       // obstacle grid of scan2dMsg
 
       protected:
         // -> realtime context
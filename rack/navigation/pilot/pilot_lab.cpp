@@ -216,6 +216,9 @@ int  PilotLab::moduleLoop(void)
         // message parsing
         Scan2dData::parse(&msgInfo);
 
+        // build the obstacle grid for the speed limitation
+        obstacle.update(&scan2dMsg.data);
+
         // get current position
         ret = position->getData(&positionData, sizeof(position_data), scan2dMsg.data.recordingTime);
         if (ret)
@@ -275,7 +278,7 @@ int  PilotLab::moduleLoop(void)
             curve  = 0.0f;
             radius = 0;
         }
-        speed = safeSpeed(speed, radius, NULL, &scan2dMsg.data, &chasParData);
+        speed = safeSpeed(speed, radius, NULL, &obstacle, &chasParData);
         
         // move chassis with limited speed
         ret = chassis->move(speed, sideSpeed, omega);
@@ -81,6 +81,7 @@ class PilotLab : public RackDataModule {
         chassis_param_data  chasParData;
         position_data       positionData;
         scan2d_data_msg     scan2dMsg;
+        ObstacleTool        obstacle;       // obstacle grid of scan2dMsg
         pilot_dest_data     pilotDest;
 
         // variables
@@ -135,6 +135,7 @@ arg_table_t argTab[] = {
       return ret;
     }
 
+    scan2dDataMbx.setSharedData(1);         // scan2d data is read in place
     scan2dDataMbx.clean();
 
     ret = scan2d->getContData(0, &scan2dDataMbx, &dataBufferPeriodTime);
@@ -154,7 +155,8 @@ arg_table_t argTab[] = {
     omega                   = 0.0f;
     angle                   = 0.0f;
     angleStart              = 0.0f;
-    scan2dMsg.data.pointNum = 0;
+    scan2dData              = NULL;
+    obstacle.clear();
 
     globalSpeed             = 0;
     radius                  = 0;
@@ -179,16 +181,13 @@ int  PilotWallFollowing::moduleLoop(void)
     int          speed = 0;
     int          ret;
     RackMessage msgInfo;
-    scan2d_data  *pS2dData = NULL;
     pilot_data*  pilotData = NULL;
 
 
 
     // get continuous data from scan2d module
-    ret = scan2dDataMbx.recvDataMsgTimed(rackTime.toNano(2 * dataBufferPeriodTime),
-                                         &scan2dMsg.data,
-                                         sizeof(scan2dMsg),
-                                         &msgInfo);
+    ret = scan2dDataMbx.peekTimed(rackTime.toNano(2 * dataBufferPeriodTime),
+                                  &msgInfo);
     if (ret)
     {
         GDOS_ERROR("Can't read continuous data from Scan2d(%d/%d), code = %d\n",
@@ -200,10 +199,11 @@ int  PilotWallFollowing::moduleLoop(void)
     if (msgInfo.getType() == MSG_DATA &&
         msgInfo.getSrc()  == scan2d->getDestAdr())
     {
-        // message parsing
-        pS2dData = Scan2dData::parse(&msgInfo);
-        memcpy(&scan2dMsg.data, pS2dData, sizeof(scan2d_data) +
-               pS2dData->pointNum * sizeof(scan_point));
+        // message parsing, the data is read in place until peekEnd()
+        scan2dData = Scan2dData::parse(&msgInfo);
+
+        // build the obstacle grid once for all collision tests
+        obstacle.update(scan2dData);
 
         GDOS_DBG_DETAIL("mode:%d  globalState:%i preState:%d subState:%d\n", mode, globalState, preState, subState);
 
@@ -262,6 +262,7 @@ int  PilotWallFollowing::moduleLoop(void)
 
         if (ret)
         {
+            scan2dDataMbx.peekEnd();
             return ret;
         }
 
@@ -269,7 +270,7 @@ int  PilotWallFollowing::moduleLoop(void)
         // get datapointer from rackdatabuffer
         pilotData = (pilot_data *)getDataBufferWorkSpace();
 
-        pilotData->recordingTime = scan2dMsg.data.recordingTime;
+        pilotData->recordingTime = scan2dData->recordingTime;
         memset(&(pilotData->pos), 0, sizeof(pilotData->pos));
         memset(&(pilotData->dest), 0, sizeof(pilotData->dest));
         pilotData->speed     = speed;
@@ -289,6 +290,8 @@ int  PilotWallFollowing::moduleLoop(void)
         putDataBufferWorkSpace(sizeof(pilot_data));
     }
 
+    scan2dDataMbx.peekEnd();
+
     return 0;
 }
 
@@ -299,38 +302,16 @@ int  PilotWallFollowing::moduleCommand(RackMessage *msgInfo)
 }
 
 
-int  PilotWallFollowing::testRec(int x, int y, int xSize, int ySize, scan2d_data *scan)
+int  PilotWallFollowing::testRec(int x, int y, int xSize, int ySize)
 {
-    int   test;
-    int   i;
-    int   xMiddle;
-    int   yMiddle;
-    int   xDistance;
-    int   yDistance;
-
-    xMiddle = (2 * x + xSize) / 2;
-    yMiddle = (2 * y + ySize) / 2;
-    xDistance = abs(xSize / 2);
-    yDistance = abs(ySize / 2);
-
-    test = 0;
-
-    for (i = 0; i < scan->pointNum; i += 2)
-    {
-        if (((scan->point[i].type & SCAN_POINT_TYPE_INVALID) == 0) &
-           ((scan->point[i].type & SCAN_POINT_TYPE_MASK) != SCAN_POINT_TYPE_LANDMARK))
-            if ((abs(scan->point[i].x - xMiddle) <= xDistance) && (abs(scan->point[i].y - yMiddle) <= yDistance))
-            {
-                test = 1;
-                break;
-            }
-    }
-
-    return test;
+    if (obstacle.rectTest(x, y, x + xSize, y + ySize))
+        return 1;
+    else
+        return 0;
 }
 
 
-int  PilotWallFollowing::safeRot(float omega, scan2d_data *scan, chassis_param_data *param)
+int  PilotWallFollowing::safeRot(float omega, chassis_param_data *param)
 {
     int test;
 
@@ -338,15 +319,15 @@ int  PilotWallFollowing::safeRot(float omega, scan2d_data *scan, chassis_param_d
 
     if (omega > 0)
     {
-        if (testRec(0, -param->boundaryLeft, param->boundaryFront + 2 * param->safetyMargin, param->boundaryLeft + param->boundaryRight + 2 * param->safetyMargin, scan) ||
-            testRec(0, param->boundaryRight, -param->boundaryBack - 2 * param->safetyMargin, -param->boundaryLeft - param->boundaryRight - 2 * param->safetyMargin, scan))
+        if (testRec(0, -param->boundaryLeft, param->boundaryFront + 2 * param->safetyMargin, param->boundaryLeft + param->boundaryRight + 2 * param->safetyMargin) ||
+            testRec(0, param->boundaryRight, -param->boundaryBack - 2 * param->safetyMargin, -param->boundaryLeft - param->boundaryRight - 2 * param->safetyMargin))
 
             test = 0;
     }
     else
     {
-        if (testRec(0, param->boundaryRight, param->boundaryFront + 2 * param->safetyMargin, -param->boundaryLeft - param->boundaryRight - 2 * param->safetyMargin, scan) ||
-            testRec (0, -param->boundaryLeft, -param->boundaryBack - 2 * param->safetyMargin, param->boundaryLeft + param->boundaryRight +  2 * param->safetyMargin, scan))
+        if (testRec(0, param->boundaryRight, param->boundaryFront + 2 * param->safetyMargin, -param->boundaryLeft - param->boundaryRight - 2 * param->safetyMargin) ||
+            testRec (0, -param->boundaryLeft, -param->boundaryBack - 2 * param->safetyMargin, param->boundaryLeft + param->boundaryRight +  2 * param->safetyMargin))
 
             test = 0;
     }
@@ -391,216 +372,34 @@ float PilotWallFollowing::funRadius(int x)
     return y;
 }
 
-float PilotWallFollowing::radiusTest(int splineRadius, float length, scan2d_data *scan, chassis_param_data *param)
+float PilotWallFollowing::radiusTest(int splineRadius, float length, chassis_param_data *param)
 {
     float       test;
-    int         i;
-    int         t;
-    float       l;
-    float       lMin;
+    int         width, offset;
     int         disMin;
-    point_2d    centerPos;
 
-    test        = 0.0f;
-    t           = 0;
-    l           = 0.0f;
-    disMin      = 10000;
-    centerPos.x = 0;
-    centerPos.y = splineRadius;
-    lMin        = 0;
-
-    if (splineRadius > 0)
+    if (splineRadius != 0)
     {
-        if ( length > M_PI * splineRadius )
-            length = M_PI * splineRadius;
-
-        for (i = 0; i < scan->pointNum; i++)
-        {
-            if (((scan->point[i].type & SCAN_POINT_TYPE_INVALID) == 0) &
-            ((scan->point[i].type & SCAN_POINT_TYPE_MASK) != SCAN_POINT_TYPE_LANDMARK))
-            {
-                if (scan->point[i].x > 0)
-                {
-                    t = (int)sqrtf( (float)( (scan->point[i].x - centerPos.x)*(scan->point[i].x - centerPos.x) + (scan->point[i].y - centerPos.y)*(scan->point[i].y - centerPos.y))) - splineRadius;
-
-                    if (scan->point[i].y < splineRadius)
-                    {
-                        l = atanf( (float)(scan->point[i].x) / (float)(splineRadius - scan->point[i].y) ) * splineRadius;
-                    }
-                    else if (scan->point[i].y == splineRadius)
-                    {
-                        l = splineRadius * M_PI / 4.0f;
-                    }
-                    else
-                    {
-                        l = splineRadius * (  M_PI - atanf( (float)(scan->point[i].x) / (float)(scan->point[i].y - splineRadius) )    );
-                    }
-
-                    if( (l <= length) && (  (t <= (param->boundaryLeft + param->safetyMargin)) && (t >= -(param->boundaryRight + param->safetyMargin))   )      )
-                    {
-                        test = -1.0f;
-                        break;
-                    }
-                    else
-                    {
-                        if (l <= length)
-                        {
-                            if(abs(t) < disMin)
-                            {
-                                disMin = abs(t);
-                                lMin = l;
-                            }
-                        }
-                    }
-                }
+        if ( length > M_PI * abs(splineRadius) )
+            length = M_PI * abs(splineRadius);
+    }
 
-                if (scan->point[i].x == 0)
-                {
-                    if(scan->point[i].y <= splineRadius)
-                    {
-                        l = 0.0f;
-                        t = (int)sqrtf( (float)( (scan->point[i].x - centerPos.x)*(scan->point[i].x - centerPos.x) + (scan->point[i].y - centerPos.y)*(scan->point[i].y - centerPos.y))) - splineRadius;
-                    }
-                    else
-                    {
-                        l = M_PI * splineRadius;
-                        t = (int)sqrtf( (float)( (scan->point[i].x - centerPos.x)*(scan->point[i].x - centerPos.x) + (scan->point[i].y - centerPos.y)*(scan->point[i].y - centerPos.y))) - splineRadius;
-                    }
+    // corridor from -boundaryLeft to boundaryRight of the arc in front of
+    // the robot
+    width  = (param->boundaryLeft + param->boundaryRight + 2 * param->safetyMargin + 1) / 2;
+    offset = (param->boundaryRight - param->boundaryLeft) / 2;
 
-                    if( (l <= length) && (  (t <= (param->boundaryLeft + param->safetyMargin)) && (t >= -(param->boundaryRight + param->safetyMargin))   )      )
-                    {
-                        test = -1.0f;
-                        break;
-                    }
-                    else
-                    {
-                        if (l <= length)
-                        {
-                            if(abs(t) < disMin)
-                            {
-                                disMin = abs(t);
-                                lMin = l;
-                            }
-                        }
-                    }
-                }
-            }
-        }
-    }
-    else if (splineRadius == 0)
+    // test the arc in the obstacle grid
+    if (obstacle.arcClearance(splineRadius, (int)length, width, &disMin,
+                              offset, 1) < (int)length)
     {
-        for (i = 0; i < scan->pointNum; i++)
-        {
-            if (((scan->point[i].type & SCAN_POINT_TYPE_INVALID) == 0) &
-            ((scan->point[i].type & SCAN_POINT_TYPE_MASK) != SCAN_POINT_TYPE_LANDMARK))
-            {
-                if (scan->point[i].x >= 0)
-                {
-                    l = scan->point[i].x;
-                    t = scan->point[i].y;
-
-                    if( (l <= length) && ((t >= -(param->boundaryLeft + param->safetyMargin)) && (t <= (param->boundaryRight + param->safetyMargin))))
-                    {
-                        test = -1.0f;
-                        break;
-                    }
-                    else
-                    {
-                        if (l <= length)
-                        {
-                            if(abs(t) < disMin)
-                            {
-                                disMin = abs(t);
-                                lMin = l;
-                            }
-                        }
-                    }
-                }
-            }
-        }
+        test = -1.0f;
     }
     else
     {
-        if ( length > M_PI * abs(splineRadius) )
-            length = M_PI * abs(splineRadius);
-
-        for (i = 0; i < scan->pointNum; i++)
-        {
-            if (((scan->point[i].type & SCAN_POINT_TYPE_INVALID) == 0) &
-            ((scan->point[i].type & SCAN_POINT_TYPE_MASK) != SCAN_POINT_TYPE_LANDMARK))
-            {
-                if (scan->point[i].x > 0)
-                {
-                    t = (int)sqrtf( (float)( (scan->point[i].x - centerPos.x)*(scan->point[i].x - centerPos.x) + (scan->point[i].y - centerPos.y)*(scan->point[i].y - centerPos.y))) + splineRadius;
-
-                    if (scan->point[i].y > splineRadius)
-                    {
-                        l = - splineRadius * atanf( (float)(scan->point[i].x) / (float)(scan->point[i].y - splineRadius) );
-                    }
-                    else if (scan->point[i].y == splineRadius)
-                    {
-                        l = - splineRadius * M_PI / 4.0f;
-                    }
-                    else
-                    {
-                        l = - splineRadius * (   M_PI - atanf((float)(scan->point[i].x) / (float)( splineRadius - scan->point[i].y))    );
-                    }
-
-                    if( (l <= length) && ((t <= (param->boundaryRight + param->safetyMargin)) && (t >= -(param->boundaryLeft + param->safetyMargin))))
-                    {
-                        test = -1.0f;
-                        break;
-                    }
-                    else
-                    {
-                        if (l <= length)
-                        {
-                            if(abs(t) < disMin)
-                            {
-                                disMin = abs(t);
-                                lMin = l;
-                            }
-                        }
-                    }
-                }
-
-                if (scan->point[i].x == 0)
-                {
-                    if(scan->point[i].y >= splineRadius)
-                    {
-                        l = 0.0f;
-                        t = (int)sqrtf( (float)( (scan->point[i].x - centerPos.x)*(scan->point[i].x - centerPos.x) + (scan->point[i].y - centerPos.y)*(scan->point[i].y - centerPos.y))) + splineRadius;
-                    }
-                    else
-                    {
-                        l = - M_PI * splineRadius;
-                        t = (int)sqrtf( (float)( (scan->point[i].x - centerPos.x)*(scan->point[i].x - centerPos.x) + (scan->point[i].y - centerPos.y)*(scan->point[i].y - centerPos.y))) + splineRadius;
-                    }
-
-                    if( (l <= length) && ((t <= (param->boundaryRight + param->safetyMargin)) && (t >= -(param->boundaryLeft + param->safetyMargin))))
-                    {
-                        test = -1.0f;
-                        break;
-                    }
-                    else
-                    {
-                        if (l <= length)
-                        {
-                            if(abs(t) < disMin)
-                            {
-                                disMin = abs(t);
-                                lMin = l;
-                            }
-                        }
-                    }
-                }
-            }
-        }
-    }
-
+        if (disMin > 10000)
+            disMin = 10000;
 
-    if (test != -1.0f)
-    {
         test = (float)funDis(disMin);
         test = test * funRadius(splineRadius);
     }
@@ -628,10 +427,10 @@ int  PilotWallFollowing::modeWallFollowing(int* state)
             switch (subState)
             {
                 case 0:
-                    tempRange = scan2dMsg.data.maxRange;
-                    for (i = 0;i < scan2dMsg.data.pointNum;i++)
+                    tempRange = scan2dData->maxRange;
+                    for (i = 0;i < scan2dData->pointNum;i++)
                     {
-                        if ((scan2dMsg.point[i].z < tempRange) && scan2dMsg.point[i].y >= 0)
+                        if ((scan2dData->point[i].z < tempRange) && scan2dData->point[i].y >= 0)
                         {
                             subState = 1;
                             break;
@@ -645,14 +444,14 @@ int  PilotWallFollowing::modeWallFollowing(int* state)
 
                 case 1:
                     // find nearest point
-                    tempRange = scan2dMsg.data.maxRange;
-                    for (i = 0;i < scan2dMsg.data.pointNum;i++)
+                    tempRange = scan2dData->maxRange;
+                    for (i = 0;i < scan2dData->pointNum;i++)
                     {
-                        if ((scan2dMsg.point[i].z < tempRange) && (scan2dMsg.point[i].y >= 0))
+                        if ((scan2dData->point[i].z < tempRange) && (scan2dData->point[i].y >= 0))
                         {
-                            tempRange = scan2dMsg.point[i].z;
-                            pointX = scan2dMsg.point[i].x;
-                            pointY = scan2dMsg.point[i].y;
+                            tempRange = scan2dData->point[i].z;
+                            pointX = scan2dData->point[i].x;
+                            pointY = scan2dData->point[i].y;
 
                         }
                     }
@@ -756,22 +555,22 @@ int  PilotWallFollowing::modeWallFollowing(int* state)
 
                 case 2:
                     // find nearest point
-                    tempRange = scan2dMsg.data.maxRange;
-                    for (i = 0;i < scan2dMsg.data.pointNum;i++)
+                    tempRange = scan2dData->maxRange;
+                    for (i = 0;i < scan2dData->pointNum;i++)
                     {
-                        if (scan2dMsg.point[i].z < tempRange)
+                        if (scan2dData->point[i].z < tempRange)
                         {
-                            tempRange = scan2dMsg.point[i].z;
-                            pointX = scan2dMsg.point[i].x;
-                            pointY = scan2dMsg.point[i].y;
+                            tempRange = scan2dData->point[i].z;
+                            pointX = scan2dData->point[i].x;
+                            pointY = scan2dData->point[i].y;
 
                         }
                     }
 
-                    if (tempRange == scan2dMsg.data.maxRange)
+                    if (tempRange == scan2dData->maxRange)
                     {
                         globalSpeed  = safeSpeed(globalSpeed, 0, NULL,
-                        &scan2dMsg.data, &chasParDataTransForward);
+                        &obstacle, &chasParDataTransForward);
 
 
                         ret = chassis->move(globalSpeed, 0, 0);
@@ -826,7 +625,7 @@ int  PilotWallFollowing::modeWallFollowing(int* state)
 
                 case 3:
                     globalSpeed  = safeSpeed(globalSpeed, radius, NULL,
-                    &scan2dMsg.data, &chasParData);
+                    &obstacle, &chasParData);
 
                     if (globalSpeed < chasParData.vxMin)
                     {
@@ -844,7 +643,7 @@ int  PilotWallFollowing::modeWallFollowing(int* state)
                     {
                         if (angle == 0)
                         {
-                            if (safeRot(omega, &scan2dMsg.data, &chasParData) == 0)
+                            if (safeRot(omega, &chasParData) == 0)
                             omega = 0;
 
                             GDOS_DBG_DETAIL("move speed %d omega %a\n", globalSpeed, omega);
@@ -889,7 +688,7 @@ int  PilotWallFollowing::modeWallFollowing(int* state)
 
                     if (((angle >= 0 ) && ( normaliseAngleSym0(positionData.pos.rho - angleStart ) >= angle )) ||
                     ((angle  < 0 ) && ( normaliseAngleSym0(positionData.pos.rho - angleStart ) <= angle )) ||
-                    (safeRot(omega, &scan2dMsg.data, &chasParData) == 0))
+                    (safeRot(omega, &chasParData) == 0))
 
                     {
                         globalSpeed = 0;
@@ -902,7 +701,7 @@ int  PilotWallFollowing::modeWallFollowing(int* state)
                             return ret;
                         }
 
-                        if ((safeRot(omega, &scan2dMsg.data, &chasParData) == 0))
+                        if ((safeRot(omega, &chasParData) == 0))
                         {
                             *state = 2;
                             subState = 0;
@@ -937,14 +736,14 @@ int  PilotWallFollowing::modeWallFollowing(int* state)
             {
                 case 0:
                      // find nearest point
-                    tempRange = scan2dMsg.data.maxRange;
-                    for (i = 0;i < scan2dMsg.data.pointNum;i++)
+                    tempRange = scan2dData->maxRange;
+                    for (i = 0;i < scan2dData->pointNum;i++)
                     {
-                        if (scan2dMsg.point[i].z < tempRange)
+                        if (scan2dData->point[i].z < tempRange)
                         {
-                            tempRange = scan2dMsg.point[i].z;
-                            pointX = scan2dMsg.point[i].x;
-                            pointY = scan2dMsg.point[i].y;
+                            tempRange = scan2dData->point[i].z;
+                            pointX = scan2dData->point[i].x;
+                            pointY = scan2dData->point[i].y;
 
                         }
                     }
@@ -1013,7 +812,7 @@ int  PilotWallFollowing::modeWallFollowing(int* state)
 
                     if (((angle >= 0 ) && ( normaliseAngleSym0(positionData.pos.rho - angleStart ) >= angle )) ||
                     ((angle  < 0 ) && ( normaliseAngleSym0(positionData.pos.rho - angleStart ) <= angle )) ||
-                    (safeRot(omega, &scan2dMsg.data, &chasParData) == 0))
+                    (safeRot(omega, &chasParData) == 0))
 
                     {
                         globalSpeed = 0;
@@ -1025,7 +824,7 @@ int  PilotWallFollowing::modeWallFollowing(int* state)
                             return ret;
                         }
 
-                        if ((safeRot(omega, &scan2dMsg.data, &chasParData) == 0))
+                        if ((safeRot(omega, &chasParData) == 0))
                         {
                             *state = 2;
                             subState = 0;
@@ -1066,7 +865,7 @@ int  PilotWallFollowing::modeWallFollowing(int* state)
             }
 
             globalSpeed  = safeSpeed(globalSpeed, 0, NULL,
-            &scan2dMsg.data, &chasParDataTransForward);
+            &obstacle, &chasParDataTransForward);
 
             if (globalSpeed > chasParData.vxMin)
             {
@@ -1131,9 +930,9 @@ int  PilotWallFollowing::modeWallFollowingBraitenberger(int* state)
             {
                 case 0:
                     globalSpeed  = safeSpeed(globalSpeed, 0, NULL,
-                    &scan2dMsg.data, &chasParDataTransForward);
+                    &obstacle, &chasParDataTransForward);
 
-                    if ((globalSpeed < chasParData.vxMin) || testRec(chasParData.boundaryFront, -chasParData.boundaryLeft - chasParData.safetyMargin, testDis, chasParData.boundaryLeft + chasParData.boundaryRight + 2 * chasParData.safetyMargin, &scan2dMsg.data))
+                    if ((globalSpeed < chasParData.vxMin) || testRec(chasParData.boundaryFront, -chasParData.boundaryLeft - chasParData.safetyMargin, testDis, chasParData.boundaryLeft + chasParData.boundaryRight + 2 * chasParData.safetyMargin))
                     {
                         // stop chassis
                         ret = chassis->move(0, 0, 0);
@@ -1150,35 +949,35 @@ int  PilotWallFollowing::modeWallFollowingBraitenberger(int* state)
                     else
                     {
 
-                        tempRange = scan2dMsg.data.maxRange;
-                        rangeLF = scan2dMsg.data.maxRange;
-                        rangeRF = scan2dMsg.data.maxRange;
+                        tempRange = scan2dData->maxRange;
+                        rangeLF = scan2dData->maxRange;
+                        rangeRF = scan2dData->maxRange;
 
-                        for (i = 0;i < scan2dMsg.data.pointNum;i++)
+                        for (i = 0;i < scan2dData->pointNum;i++)
                         {
-                            if (scan2dMsg.point[i].z < tempRange)
+                            if (scan2dData->point[i].z < tempRange)
                             {
-                                tempRange = scan2dMsg.point[i].z;
-                                pointX = scan2dMsg.point[i].x;
-                                pointY = scan2dMsg.point[i].y;
+                                tempRange = scan2dData->point[i].z;
+                                pointX = scan2dData->point[i].x;
+                                pointY = scan2dData->point[i].y;
                             }
 
-                            if ((scan2dMsg.point[i].x >= -chasParData.boundaryBack) && (scan2dMsg.point[i].y > 0) && (scan2dMsg.point[i].z < rangeRF))
+                            if ((scan2dData->point[i].x >= -chasParData.boundaryBack) && (scan2dData->point[i].y > 0) && (scan2dData->point[i].z < rangeRF))
                             {
-                                rangeRF = scan2dMsg.point[i].z;
-                                pointRFX = scan2dMsg.point[i].x;
-                                pointRFY = scan2dMsg.point[i].y;
+                                rangeRF = scan2dData->point[i].z;
+                                pointRFX = scan2dData->point[i].x;
+                                pointRFY = scan2dData->point[i].y;
                             }
 
-                            if ((scan2dMsg.point[i].x >= -chasParData.boundaryBack) && (scan2dMsg.point[i].y < 0) && (scan2dMsg.point[i].z < rangeLF))
+                            if ((scan2dData->point[i].x >= -chasParData.boundaryBack) && (scan2dData->point[i].y < 0) && (scan2dData->point[i].z < rangeLF))
                             {
-                                rangeLF = scan2dMsg.point[i].z;
-                                pointLFX = scan2dMsg.point[i].x;
-                                pointLFY = scan2dMsg.point[i].y;
+                                rangeLF = scan2dData->point[i].z;
+                                pointLFX = scan2dData->point[i].x;
+                                pointLFY = scan2dData->point[i].y;
                             }
                         }
 
-                        if (tempRange == scan2dMsg.data.maxRange)
+                        if (tempRange == scan2dData->maxRange)
                         {
                             rightRot = 0;
                             leftRot = 0;
@@ -1223,24 +1022,24 @@ int  PilotWallFollowing::modeWallFollowingBraitenberger(int* state)
                     break;
 
                 case 1:
-                    tempRange = scan2dMsg.data.maxRange;
-                    for (i = 0;i < scan2dMsg.data.pointNum;i++)
+                    tempRange = scan2dData->maxRange;
+                    for (i = 0;i < scan2dData->pointNum;i++)
                     {
-                        if (scan2dMsg.point[i].z < scan2dMsg.data.maxRange)
+                        if (scan2dData->point[i].z < scan2dData->maxRange)
                         {
-                           tempRange = scan2dMsg.point[i].z;
+                           tempRange = scan2dData->point[i].z;
                            break;
                         }
                     }
 
-                    if (tempRange < scan2dMsg.data.maxRange)
+                    if (tempRange < scan2dData->maxRange)
                     {
                         subState = 0;
                     }
                     else
                     {
                         globalSpeed  = safeSpeed(globalSpeed, 0, NULL,
-                        &scan2dMsg.data, &chasParDataTransForward);
+                        &obstacle, &chasParDataTransForward);
 
                         ret = chassis->move(globalSpeed, 0, 0);
                         if (ret)
@@ -1253,27 +1052,27 @@ int  PilotWallFollowing::modeWallFollowingBraitenberger(int* state)
                     break;
 
                 case 2:
-                    rangeLF = scan2dMsg.data.maxRange;
-                    rangeRF = scan2dMsg.data.maxRange;
+                    rangeLF = scan2dData->maxRange;
+                    rangeRF = scan2dData->maxRange;
 
-                    for (i = 0;i < scan2dMsg.data.pointNum;i++)
+                    for (i = 0;i < scan2dData->pointNum;i++)
                     {
-                        if ((scan2dMsg.point[i].x >= -chasParData.boundaryBack) && (scan2dMsg.point[i].y > 0) && (scan2dMsg.point[i].z < rangeRF))
+                        if ((scan2dData->point[i].x >= -chasParData.boundaryBack) && (scan2dData->point[i].y > 0) && (scan2dData->point[i].z < rangeRF))
                         {
-                            rangeRF = scan2dMsg.point[i].z;
-                            pointRFX = scan2dMsg.point[i].x;
-                            pointRFY = scan2dMsg.point[i].y;
+                            rangeRF = scan2dData->point[i].z;
+                            pointRFX = scan2dData->point[i].x;
+                            pointRFY = scan2dData->point[i].y;
                         }
 
-                        if ((scan2dMsg.point[i].x >= -chasParData.boundaryBack) && (scan2dMsg.point[i].y < 0) && (scan2dMsg.point[i].z < rangeLF))
+                        if ((scan2dData->point[i].x >= -chasParData.boundaryBack) && (scan2dData->point[i].y < 0) && (scan2dData->point[i].z < rangeLF))
                         {
-                            rangeLF = scan2dMsg.point[i].z;
-                            pointLFX = scan2dMsg.point[i].x;
-                            pointLFY = scan2dMsg.point[i].y;
+                            rangeLF = scan2dData->point[i].z;
+                            pointLFX = scan2dData->point[i].x;
+                            pointLFY = scan2dData->point[i].y;
                         }
                     }
 
-                    if (testRec(chasParData.boundaryFront, -chasParData.boundaryLeft - chasParData.safetyMargin, testDis, chasParData.boundaryLeft + chasParData.boundaryRight + 2 * chasParData.safetyMargin, &scan2dMsg.data))
+                    if (testRec(chasParData.boundaryFront, -chasParData.boundaryLeft - chasParData.safetyMargin, testDis, chasParData.boundaryLeft + chasParData.boundaryRight + 2 * chasParData.safetyMargin))
                     {
                         ret = chassis->move(0, 0, 0);
                         if (ret)
@@ -1337,7 +1136,7 @@ int  PilotWallFollowing::modeWallFollowingBraitenberger(int* state)
 
 
                         globalSpeed  = safeSpeed(globalSpeed, radius, NULL,
-                        &scan2dMsg.data, &chasParData);
+                        &obstacle, &chasParData);
 
                         if (globalSpeed < chasParData.vxMin)
                         {
@@ -1370,27 +1169,27 @@ int  PilotWallFollowing::modeWallFollowingBraitenberger(int* state)
                     break;
 
                 case 3:
-                    rangeLF = scan2dMsg.data.maxRange;
-                    rangeR = scan2dMsg.data.maxRange;
+                    rangeLF = scan2dData->maxRange;
+                    rangeR = scan2dData->maxRange;
 
-                    for (i = 0;i < scan2dMsg.data.pointNum;i++)
+                    for (i = 0;i < scan2dData->pointNum;i++)
                     {
-                        if ((scan2dMsg.point[i].y > 0) && (scan2dMsg.point[i].z < rangeR))
+                        if ((scan2dData->point[i].y > 0) && (scan2dData->point[i].z < rangeR))
                         {
-                            rangeR = scan2dMsg.point[i].z;
-                            pointRX = scan2dMsg.point[i].x;
-                            pointRY = scan2dMsg.point[i].y;
+                            rangeR = scan2dData->point[i].z;
+                            pointRX = scan2dData->point[i].x;
+                            pointRY = scan2dData->point[i].y;
                         }
 
-                        if ((scan2dMsg.point[i].x >= -chasParData.boundaryBack) && (scan2dMsg.point[i].y < 0) && (scan2dMsg.point[i].z < rangeLF))
+                        if ((scan2dData->point[i].x >= -chasParData.boundaryBack) && (scan2dData->point[i].y < 0) && (scan2dData->point[i].z < rangeLF))
                         {
-                            rangeLF = scan2dMsg.point[i].z;
-                            pointLFX = scan2dMsg.point[i].x;
-                            pointLFY = scan2dMsg.point[i].y;
+                            rangeLF = scan2dData->point[i].z;
+                            pointLFX = scan2dData->point[i].x;
+                            pointLFY = scan2dData->point[i].y;
                         }
                     }
 
-                    if (testRec(chasParData.boundaryFront, -chasParData.boundaryLeft - chasParData.safetyMargin, testDis, chasParData.boundaryLeft + chasParData.boundaryRight + 2 * chasParData.safetyMargin, &scan2dMsg.data))
+                    if (testRec(chasParData.boundaryFront, -chasParData.boundaryLeft - chasParData.safetyMargin, testDis, chasParData.boundaryLeft + chasParData.boundaryRight + 2 * chasParData.safetyMargin))
                     {
                         ret = chassis->move(0, 0, 0);
                         if (ret)
@@ -1403,7 +1202,7 @@ int  PilotWallFollowing::modeWallFollowingBraitenberger(int* state)
                         *state = 1;
                         subState = 0;
                     }
-                    else if ((rangeLF < rangeR) || (rangeLF <= distance) || (rangeR == scan2dMsg.data.maxRange))
+                    else if ((rangeLF < rangeR) || (rangeLF <= distance) || (rangeR == scan2dData->maxRange))
                     {
                         subState = 0;
                     }
@@ -1447,7 +1246,7 @@ int  PilotWallFollowing::modeWallFollowingBraitenberger(int* state)
 
 
                         globalSpeed  = safeSpeed(globalSpeed, radius, NULL,
-                        &scan2dMsg.data, &chasParData);
+                        &obstacle, &chasParData);
 
                         if (globalSpeed < chasParData.vxMin)
                         {
@@ -1476,27 +1275,27 @@ int  PilotWallFollowing::modeWallFollowingBraitenberger(int* state)
                     break;
 
                 case 4:
-                    rangeL = scan2dMsg.data.maxRange;
-                    rangeRF = scan2dMsg.data.maxRange;
+                    rangeL = scan2dData->maxRange;
+                    rangeRF = scan2dData->maxRange;
 
-                    for (i = 0;i < scan2dMsg.data.pointNum;i++)
+                    for (i = 0;i < scan2dData->pointNum;i++)
                     {
-                        if ((scan2dMsg.point[i].x >= -chasParData.boundaryBack) && (scan2dMsg.point[i].y > 0) && (scan2dMsg.point[i].z < rangeRF))
+                        if ((scan2dData->point[i].x >= -chasParData.boundaryBack) && (scan2dData->point[i].y > 0) && (scan2dData->point[i].z < rangeRF))
                         {
-                            rangeRF = scan2dMsg.point[i].z;
-                            pointRFX = scan2dMsg.point[i].x;
-                            pointRFY = scan2dMsg.point[i].y;
+                            rangeRF = scan2dData->point[i].z;
+                            pointRFX = scan2dData->point[i].x;
+                            pointRFY = scan2dData->point[i].y;
                         }
 
-                        if ((scan2dMsg.point[i].y < 0) && (scan2dMsg.point[i].z < rangeL))
+                        if ((scan2dData->point[i].y < 0) && (scan2dData->point[i].z < rangeL))
                         {
-                            rangeL = scan2dMsg.point[i].z;
-                            pointLX = scan2dMsg.point[i].x;
-                            pointLY = scan2dMsg.point[i].y;
+                            rangeL = scan2dData->point[i].z;
+                            pointLX = scan2dData->point[i].x;
+                            pointLY = scan2dData->point[i].y;
                         }
                     }
 
-                    if (testRec(chasParData.boundaryFront, -chasParData.boundaryLeft - chasParData.safetyMargin, testDis, chasParData.boundaryLeft + chasParData.boundaryRight + 2 * chasParData.safetyMargin, &scan2dMsg.data))
+                    if (testRec(chasParData.boundaryFront, -chasParData.boundaryLeft - chasParData.safetyMargin, testDis, chasParData.boundaryLeft + chasParData.boundaryRight + 2 * chasParData.safetyMargin))
                     {
                         ret = chassis->move(0, 0, 0);
                         if (ret)
@@ -1509,7 +1308,7 @@ int  PilotWallFollowing::modeWallFollowingBraitenberger(int* state)
                         *state = 1;
                         subState = 0;
                     }
-                    else if ((rangeRF < rangeL) || (rangeRF <= distance) || (rangeL == scan2dMsg.data.maxRange))
+                    else if ((rangeRF < rangeL) || (rangeRF <= distance) || (rangeL == scan2dData->maxRange))
                     {
                         subState = 0;
                     }
@@ -1553,7 +1352,7 @@ int  PilotWallFollowing::modeWallFollowingBraitenberger(int* state)
 
 
                         globalSpeed  = safeSpeed(globalSpeed, radius, NULL,
-                        &scan2dMsg.data, &chasParData);
+                        &obstacle, &chasParData);
 
                         if (globalSpeed < chasParData.vxMin)
                         {
@@ -1594,25 +1393,25 @@ int  PilotWallFollowing::modeWallFollowingBraitenberger(int* state)
             {
                 case 0:
                     // find nearest point
-                    tempRange = scan2dMsg.data.maxRange;
-                    rangeL = scan2dMsg.data.maxRange;
-                    rangeR = scan2dMsg.data.maxRange;
+                    tempRange = scan2dData->maxRange;
+                    rangeL = scan2dData->maxRange;
+                    rangeR = scan2dData->maxRange;
 
-                    for (i = 0;i < scan2dMsg.data.pointNum;i++)
+                    for (i = 0;i < scan2dData->pointNum;i++)
                     {
-                        if ((scan2dMsg.point[i].z < tempRange) && ( scan2dMsg.point[i].x > chasParData.boundaryFront))
+                        if ((scan2dData->point[i].z < tempRange) && ( scan2dData->point[i].x > chasParData.boundaryFront))
                         {
-                            tempRange = scan2dMsg.point[i].z;
-                            pointX = scan2dMsg.point[i].x;
-                            pointY = scan2dMsg.point[i].y;
+                            tempRange = scan2dData->point[i].z;
+                            pointX = scan2dData->point[i].x;
+                            pointY = scan2dData->point[i].y;
 
-                            if( (scan2dMsg.point[i].x < chasParData.boundaryFront) && (scan2dMsg.point[i].x > - chasParData.boundaryBack))
+                            if( (scan2dData->point[i].x < chasParData.boundaryFront) && (scan2dData->point[i].x > - chasParData.boundaryBack))
                             {
-                                if( (scan2dMsg.point[i].y > 0) && (scan2dMsg.point[i].z < rangeR)                        )
-                                    rangeR = scan2dMsg.point[i].z;
+                                if( (scan2dData->point[i].y > 0) && (scan2dData->point[i].z < rangeR)                        )
+                                    rangeR = scan2dData->point[i].z;
 
-                                if( (scan2dMsg.point[i].y < 0) && (scan2dMsg.point[i].z < rangeL)                        )
-                                    rangeL = scan2dMsg.point[i].z;
+                                if( (scan2dData->point[i].y < 0) && (scan2dData->point[i].z < rangeL)                        )
+                                    rangeL = scan2dData->point[i].z;
                             }
                         }
                     }
@@ -1683,7 +1482,7 @@ int  PilotWallFollowing::modeWallFollowingBraitenberger(int* state)
 
                     if (((angle >= 0 ) && ( normaliseAngleSym0(positionData.pos.rho - angleStart ) >= angle )) ||
                     ((angle  < 0 ) && ( normaliseAngleSym0(positionData.pos.rho - angleStart ) <= angle )) ||
-                    (safeRot(omega, &scan2dMsg.data, &chasParData) == 0) || !testRec(chasParData.boundaryFront, -chasParData.boundaryLeft - chasParData.safetyMargin, (int)(1.5 * testDis), chasParData.boundaryLeft + chasParData.boundaryRight + 2 * chasParData.safetyMargin, &scan2dMsg.data) )
+                    (safeRot(omega, &chasParData) == 0) || !testRec(chasParData.boundaryFront, -chasParData.boundaryLeft - chasParData.safetyMargin, (int)(1.5 * testDis), chasParData.boundaryLeft + chasParData.boundaryRight + 2 * chasParData.safetyMargin) )
 
                     {
                         // stop chassis
@@ -1694,7 +1493,7 @@ int  PilotWallFollowing::modeWallFollowingBraitenberger(int* state)
                             return ret;
                         }
 
-                        if ((safeRot(omega, &scan2dMsg.data, &chasParData) == 0))
+                        if ((safeRot(omega, &chasParData) == 0))
                         {
                             *state = 2;
                             subState = 0;
@@ -1738,7 +1537,7 @@ int  PilotWallFollowing::modeWallFollowingBraitenberger(int* state)
             }
 
             globalSpeed  = safeSpeed(globalSpeed, 0, NULL,
-            &scan2dMsg.data, &chasParDataTransForward);
+            &obstacle, &chasParDataTransForward);
 
             if (globalSpeed > chasParData.vxMin)
             {
@@ -1804,7 +1603,7 @@ int  PilotWallFollowing::moduleInit(void)
 
     // scan2d
     ret = createMbx(&scan2dDataMbx, 2, sizeof(scan2d_data_msg),
-                    MBX_IN_KERNELSPACE | MBX_SLOT);
+                    MBX_IN_USERSPACE | MBX_SLOT);
     if (ret)
     {
         goto init_error;
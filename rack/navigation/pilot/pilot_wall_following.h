@@ -99,7 +99,8 @@ class PilotWallFollowing : public RackDataModule {
         chassis_param_data  chasParDataTransForward;
         chassis_param_data  chasParDataTransBackward;
 
-        scan2d_data_msg     scan2dMsg;
+        scan2d_data*        scan2dData;             // peeked scan2d data
+        ObstacleTool        obstacle;               // obstacle grid of scan2dData
 
       protected:
         // -> realtime context
@@ -107,14 +108,14 @@ class PilotWallFollowing : public RackDataModule {
         int      moduleLoop(void);
         void     moduleOff(void);
         int      moduleCommand(RackMessage *msgInfo);
-        int      testRec(int x, int y, int xSize, int ySize, scan2d_data *scan);
-        int      safeRot(float omega, scan2d_data *scan, chassis_param_data *param);
+        int      testRec(int x, int y, int xSize, int ySize);
+        int      safeRot(float omega, chassis_param_data *param);
         int      controlSpeed(int oldSpeed);
         double   funAngle(double x);
         double   funDistance(int x);
         double   funDis(int x);
         float    funRadius(int x);
-        float    radiusTest(int splineRadius, float length, scan2d_data *scan, chassis_param_data *param);
+        float    radiusTest(int splineRadius, float length, chassis_param_data *param);
         int      modeRandomAngle(int* state);
         int      modeFreeSpace(int* state);
         int      modeWallFollowing(int* state);
@@ -0,0 +1,264 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Matthias Hentschel <hentschel@rts.uni-hannover.de>
+ */
+#include <main/rack_module.h>
+#include <main/argopts.h>
+#include <main/position_tool.h>
+
+//
+// Converts random positions around a center point with the single and the
+// batch conversions of PositionTool. The batch results are compared with
+// the single conversions and with the position before a round trip.
+//
+
+#define EARTH_RADIUS                6378137.0       // m
+
+//
+// data structures
+//
+
+arg_table_t argTab[] = {
+
+    { ARGOPT_OPT, "positionNum", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Number of random positions, default 100000", { 100000 } },
+
+    { ARGOPT_OPT, "latitude", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Latitude of the center in deg, default 52", { 52 } },
+
+    { ARGOPT_OPT, "longitude", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Longitude of the center in deg, default 9", { 9 } },
+
+    { ARGOPT_OPT, "range", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Size of the area around the center in km, default 400 km", { 400 } },
+
+    { ARGOPT_OPT, "loopNum", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Number of conversion loops for the timing, default 10", { 10 } },
+
+    { ARGOPT_OPT, "seed", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Seed of the random positions, default 1", { 1 } },
+
+    { 0, "", 0, 0, "", { 0 } } // last entry
+};
+
+typedef struct {
+    double  lat;                    // [m]
+    double  lon;                    // [m]
+    int     alt;                    // [mm]
+} wgs84_error;
+
+static double random1(void)
+{
+    return (double)rand() / (double)RAND_MAX - 0.5;
+}
+
+static void wgs84Error(position_wgs84_data *a, position_wgs84_data *b, int num,
+                       wgs84_error *err)
+{
+    double dlon;
+    int    i;
+
+    err->lat = err->lon = 0.0;
+    err->alt = 0;
+
+    for (i = 0; i < num; i++)
+    {
+        err->lat = fmax(err->lat, fabs(a[i].latitude - b[i].latitude) * EARTH_RADIUS);
+        dlon     = remainder(a[i].longitude - b[i].longitude, 2.0 * M_PI);
+        err->lon = fmax(err->lon, fabs(dlon) * EARTH_RADIUS * cos(a[i].latitude));
+        if (abs(a[i].altitude - b[i].altitude) > err->alt)
+            err->alt = abs(a[i].altitude - b[i].altitude);
+    }
+}
+
+static void printTime(const char *name, uint64_t single, uint64_t batch, int num)
+{
+    printf("%-12s single %8.1f ns, batch %8.1f ns, %5.2f x\n", name,
+           (double)single / num, (double)batch / num, (double)single / batch);
+}
+
+int  main(int argc, char *argv[])
+{
+    RackTime            rackTime;
+    PositionTool        positionTool;
+    position_wgs84_data *wgs84, *wgs84Single, *wgs84Batch;
+    position_utm_data   *utmSingle, *utmBatch;
+    position_gk_data    *gkSingle, *gkBatch;
+    wgs84_error         err;
+    uint64_t            time, singleTime, batchTime;
+    double              lat, lon, range, gkErr;
+    int64_t             utmErr;
+    int                 positionNum, loopNum;
+    int                 i, k, ret;
+
+    // get args
+    ret = RackModule::getArgs(argc, argv, argTab, "PositionBench");
+    if (ret)
+    {
+        printf("Invalid arguments -> EXIT \n");
+        return ret;
+    }
+
+    positionNum = getIntArg("positionNum", argTab);
+    loopNum     = getIntArg("loopNum", argTab);
+    lat         = getIntArg("latitude", argTab) * M_PI / 180.0;
+    lon         = getIntArg("longitude", argTab) * M_PI / 180.0;
+    range       = getIntArg("range", argTab) * 1000.0 / EARTH_RADIUS;
+
+    wgs84       = (position_wgs84_data *)malloc(positionNum * sizeof(position_wgs84_data));
+    wgs84Single = (position_wgs84_data *)malloc(positionNum * sizeof(position_wgs84_data));
+    wgs84Batch  = (position_wgs84_data *)malloc(positionNum * sizeof(position_wgs84_data));
+    utmSingle   = (position_utm_data *)malloc(positionNum * sizeof(position_utm_data));
+    utmBatch    = (position_utm_data *)malloc(positionNum * sizeof(position_utm_data));
+    gkSingle    = (position_gk_data *)malloc(positionNum * sizeof(position_gk_data));
+    gkBatch     = (position_gk_data *)malloc(positionNum * sizeof(position_gk_data));
+    if (!wgs84 || !wgs84Single || !wgs84Batch || !utmSingle || !utmBatch ||
+        !gkSingle || !gkBatch)
+    {
+        printf("Can't allocate buffers -> EXIT\n");
+        return -ENOMEM;
+    }
+
+    // random positions
+    srand(getIntArg("seed", argTab));
+
+    for (i = 0; i < positionNum; i++)
+    {
+        wgs84[i].latitude  = lat + range * random1();
+        wgs84[i].longitude = lon + range * random1() / cos(lat);
+        wgs84[i].altitude  = (int)(1000000.0 * random1());
+        wgs84[i].heading   = 0.0f;
+    }
+
+    printf("%d positions, time per position\n", positionNum);
+
+    //
+    // wgs84 -> utm
+    //
+
+    time = rackTime.getNano();
+    for (k = 0; k < loopNum; k++)
+        for (i = 0; i < positionNum; i++)
+            positionTool.wgs84ToUtm(&wgs84[i], &utmSingle[i]);
+    singleTime = rackTime.getNano() - time;
+
+    time = rackTime.getNano();
+    for (k = 0; k < loopNum; k++)
+        positionTool.wgs84ToUtm(wgs84, utmBatch, positionNum);
+    batchTime = rackTime.getNano() - time;
+
+    printTime("wgs84ToUtm", singleTime, batchTime, positionNum * loopNum);
+
+    utmErr = 0;
+    for (i = 0; i < positionNum; i++)
+    {
+        if ((utmSingle[i].zone != utmBatch[i].zone) ||
+            (utmSingle[i].band != utmBatch[i].band))
+        {
+            printf("Zone of position %d differs\n", i);
+            return -EINVAL;
+        }
+        utmErr = llabs(utmSingle[i].northing - utmBatch[i].northing) > utmErr ?
+                 llabs(utmSingle[i].northing - utmBatch[i].northing) : utmErr;
+        utmErr = llabs(utmSingle[i].easting - utmBatch[i].easting) > utmErr ?
+                 llabs(utmSingle[i].easting - utmBatch[i].easting) : utmErr;
+    }
+
+    //
+    // utm -> wgs84
+    //
+
+    time = rackTime.getNano();
+    for (k = 0; k < loopNum; k++)
+        for (i = 0; i < positionNum; i++)
+            positionTool.utmToWgs84(&utmSingle[i], &wgs84Single[i]);
+    singleTime = rackTime.getNano() - time;
+
+    time = rackTime.getNano();
+    for (k = 0; k < loopNum; k++)
+        positionTool.utmToWgs84(utmBatch, wgs84Batch, positionNum);
+    batchTime = rackTime.getNano() - time;
+
+    printTime("utmToWgs84", singleTime, batchTime, positionNum * loopNum);
+    printf("UTM batch to single:   northing / easting %lld mm\n", (long long)utmErr);
+    wgs84Error(wgs84Single, wgs84Batch, positionNum, &err);
+    printf("                       latitude %.3f mm, longitude %.3f mm\n",
+           err.lat * 1000.0, err.lon * 1000.0);
+    wgs84Error(wgs84, wgs84Single, positionNum, &err);
+    printf("UTM round trip single: latitude %.3f mm, longitude %.3f mm\n",
+           err.lat * 1000.0, err.lon * 1000.0);
+    wgs84Error(wgs84, wgs84Batch, positionNum, &err);
+    printf("UTM round trip batch:  latitude %.3f mm, longitude %.3f mm\n",
+           err.lat * 1000.0, err.lon * 1000.0);
+
+    //
+    // wgs84 -> gauss-krueger
+    //
+
+    time = rackTime.getNano();
+    for (k = 0; k < loopNum; k++)
+        for (i = 0; i < positionNum; i++)
+            positionTool.wgs84ToGk(&wgs84[i], &gkSingle[i]);
+    singleTime = rackTime.getNano() - time;
+
+    time = rackTime.getNano();
+    for (k = 0; k < loopNum; k++)
+        positionTool.wgs84ToGk(wgs84, gkBatch, positionNum);
+    batchTime = rackTime.getNano() - time;
+
+    printTime("wgs84ToGk", singleTime, batchTime, positionNum * loopNum);
+
+    gkErr = 0.0;
+    for (i = 0; i < positionNum; i++)
+    {
+        gkErr = fmax(gkErr, fabs(gkSingle[i].northing - gkBatch[i].northing));
+        gkErr = fmax(gkErr, fabs(gkSingle[i].easting - gkBatch[i].easting));
+        gkErr = fmax(gkErr, (double)abs(gkSingle[i].altitude - gkBatch[i].altitude));
+    }
+
+    //
+    // gauss-krueger -> wgs84
+    //
+
+    time = rackTime.getNano();
+    for (k = 0; k < loopNum; k++)
+        for (i = 0; i < positionNum; i++)
+            positionTool.gkToWgs84(&gkSingle[i], &wgs84Single[i]);
+    singleTime = rackTime.getNano() - time;
+
+    time = rackTime.getNano();
+    for (k = 0; k < loopNum; k++)
+        positionTool.gkToWgs84(gkBatch, wgs84Batch, positionNum);
+    batchTime = rackTime.getNano() - time;
+
+    printTime("gkToWgs84", singleTime, batchTime, positionNum * loopNum);
+    printf("GK batch to single:    northing / easting / altitude %.3f mm\n", gkErr);
+    wgs84Error(wgs84Single, wgs84Batch, positionNum, &err);
+    printf("                       latitude %.3f mm, longitude %.3f mm, altitude %d mm\n",
+           err.lat * 1000.0, err.lon * 1000.0, err.alt);
+    wgs84Error(wgs84, wgs84Single, positionNum, &err);
+    printf("GK round trip single:  latitude %.3f mm, longitude %.3f mm, altitude %d mm\n",
+           err.lat * 1000.0, err.lon * 1000.0, err.alt);
+    wgs84Error(wgs84, wgs84Batch, positionNum, &err);
+    printf("GK round trip batch:   latitude %.3f mm, longitude %.3f mm, altitude %d mm\n",
+           err.lat * 1000.0, err.lon * 1000.0, err.alt);
+
+    free(gkBatch);
+    free(gkSingle);
+    free(utmBatch);
+    free(utmSingle);
+    free(wgs84Batch);
+    free(wgs84Single);
+    free(wgs84);
+    return 0;
+}
@@ -154,6 +154,8 @@ arg_table_t argTab[] = {
     }
 
 
+    // the ladar data is read in place unless a filter changes it
+    ladarMbx.setSharedData(!ladarUpsideDown && !medianFilter);
     ladarMbx.clean();
 
     ret = ladar->getContData(0, &ladarMbx, &dataBufferPeriodTime);
@@ -190,6 +192,7 @@ int  Scan2d::moduleLoop(void)
     ladar_data*     dataLadar;
     RackMessage     msgInfo;
     double          x, y;
+    int32_t         distance;
     int             i, j, ret;
 
     // get datapointer from rackdatabuffer
@@ -284,21 +287,22 @@ int  Scan2d::moduleLoop(void)
                     break;
             }
 
-            if (dataLadar->point[i].distance >= data2D->maxRange)
+            distance = dataLadar->point[i].distance;
+            if (distance >= data2D->maxRange)
             {
-                dataLadar->point[i].distance  = data2D->maxRange;
+                distance = data2D->maxRange;
                 data2D->point[j].type  |= SCAN_POINT_TYPE_MAX_RANGE;
                 data2D->point[j].type  |= SCAN_POINT_TYPE_INVALID;
             }
 
-            x = (double)dataLadar->point[i].distance *
+            x = (double)distance *
                         cos(dataLadar->point[i].angle + ladarOffsetRhoFloat);
-            y = (double)dataLadar->point[i].distance *
+            y = (double)distance *
                         sin(dataLadar->point[i].angle + ladarOffsetRhoFloat);
 
             data2D->point[j].x = (int)x + ladarOffsetX;
             data2D->point[j].y = (int)y + ladarOffsetY;
-            data2D->point[j].z = dataLadar->point[i].distance;
+            data2D->point[j].z = distance;
 
             data2D->pointNum++;
         }
@@ -314,6 +318,7 @@ int  Scan2d::moduleLoop(void)
         if(ret)
         {
             GDOS_ERROR("Can't add scan intensity, code = %d\n", ret);
+            ladarMbx.peekEnd();
             return ret;
         }
     }
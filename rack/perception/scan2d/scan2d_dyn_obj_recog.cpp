@@ -74,6 +74,7 @@ arg_table_t argTab[] = {
     }
 
 
+    dataMbx.setSharedData(1);               // scan2d data is read in place
     dataMbx.clean();
     GDOS_DBG_INFO("Requesting continuous data from Scan2d(%d/%d)...\n", scan2dSys, scan2dInst);
     ret = scan2d->getContData(0, &dataMbx, &dataBufferPeriodTime);
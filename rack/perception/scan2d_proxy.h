@@ -62,8 +62,6 @@ class Scan2dData
     public:
         static void le_to_cpu(scan2d_data *data)
         {
-            int i;
-
             data->recordingTime = __le32_to_cpu(data->recordingTime);
             data->duration      = __le32_to_cpu(data->duration);
             data->maxRange      = __le32_to_cpu(data->maxRange);
@@ -73,15 +71,11 @@ class Scan2dData
             Position3D::le_to_cpu(&data->refPos);
 
             data->pointNum      = __le32_to_cpu(data->pointNum);
-            for (i=0; i< data->pointNum; i++) {
-                ScanPoint::le_to_cpu(&data->point[i]);
-            }
+            ScanPoint::le_to_cpu(data->point, data->pointNum);
         }
 
         static void be_to_cpu(scan2d_data *data)
         {
-            int i;
-
             data->recordingTime = __be32_to_cpu(data->recordingTime);
             data->duration      = __be32_to_cpu(data->duration);
             data->maxRange      = __be32_to_cpu(data->maxRange);
@@ -91,9 +85,7 @@ class Scan2dData
             Position3D::be_to_cpu(&data->refPos);
 
             data->pointNum      = __be32_to_cpu(data->pointNum);
-            for (i=0; i< data->pointNum; i++) {
-                ScanPoint::be_to_cpu(&data->point[i]);
-            }
+            ScanPoint::be_to_cpu(data->point, data->pointNum);
         }
 
         static scan2d_data* parse(RackMessage *msgInfo)
@@ -103,6 +95,11 @@ class Scan2dData
 
             scan2d_data *p_data = (scan2d_data *)msgInfo->p_data;
 
+            if (msgInfo->isDataByteorderCpu()) // data in cpu byteorder
+            {
+                return p_data;
+            }
+
             if (msgInfo->isDataByteorderLe()) // data in little endian
             {
                 le_to_cpu(p_data);
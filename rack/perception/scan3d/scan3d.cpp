@@ -0,0 +1,638 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Oliver Wulf <wulf@rts.uni-hannover.de>
+ *
+ */
+#include "scan3d.h"
+#include <main/argopts.h>
+
+#include <math.h>
+
+//
+// data structures
+//
+
+arg_table_t argTab[] = {
+
+    { ARGOPT_OPT, "ladarSys", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The system number of the ladar driver", { 0 } },
+
+    { ARGOPT_REQ, "ladarInst", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The instance number of the ladar driver", { -1 } },
+
+    { ARGOPT_OPT, "servoSys", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The system number of the servo drive", { 0 } },
+
+    { ARGOPT_REQ, "servoInst", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The instance number of the servo drive", { -1 } },
+
+    { ARGOPT_OPT, "positionSys", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The system number of the position module", { 0 } },
+
+    { ARGOPT_OPT, "positionInst", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "The instance number of the position module, -1 no reference position", { -1 } },
+
+    { ARGOPT_OPT, "scanMode", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Scan mode (1: roll (default), 2: pitch, 3: yaw)", { SCAN3D_ROLL } },
+
+    { ARGOPT_OPT, "scanHardware", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Id of the scan hardware (default 0)", { 0 } },
+
+    { ARGOPT_OPT, "angleStart", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Servo angle at the start of the sweep in deg (default -90)", { -90 } },
+
+    { ARGOPT_OPT, "angleEnd", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Servo angle at the end of the sweep in deg (default 90)", { 90 } },
+
+    { ARGOPT_OPT, "servoVel", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Servo velocity in deg/s (default 45)", { 45 } },
+
+    { ARGOPT_OPT, "servoAcc", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Servo acceleration in deg/s^2 (default 90)", { 90 } },
+
+    { ARGOPT_OPT, "ladarOffsetX", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Ladar X offset (default 0)", { 0 } },
+
+    { ARGOPT_OPT, "ladarOffsetY", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Ladar Y offset (default 0)", { 0 } },
+
+    { ARGOPT_OPT, "ladarOffsetZ", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Ladar Z offset (default 0)", { 0 } },
+
+    { ARGOPT_OPT, "maxRange", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Maximal ladar range", { 30000 } },
+
+    { ARGOPT_OPT, "reduce", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "reduce (default 1)", { 1 } },
+
+    { ARGOPT_OPT, "compressFlagsS1", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Compression flags of step 1 (default 0, no compression)", { COMPR_S1_NONE } },
+
+    { ARGOPT_OPT, "compressFlagsS2", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Compression flags of step 2 (default 0, no compression)", { COMPR_S2_NONE } },
+
+    { ARGOPT_OPT, "compressFlagsS3", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Compression flags of step 3 (default 0, no compression)", { COMPR_S3_NONE } },
+
+    { ARGOPT_OPT, "compressWorkerNum", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Number of compression worker tasks, 0 compresses serially (default 0)", { 0 } },
+
+    { 0, "", 0, 0, "", { 0 } } // last entry
+};
+
+/*******************************************************************************
+ *   !!! REALTIME CONTEXT !!!
+ *
+ *   moduleOn,
+ *   moduleOff,
+ *   moduleLoop,
+ *   moduleCommand,
+ *
+ *   own realtime user functions
+ ******************************************************************************/
+
+ int  Scan3d::moduleOn(void)
+{
+    rack_time_t moveTime;
+    int         ret;
+
+    // get dynamic module parameter
+    scanMode        = getInt32Param("scanMode");
+    angleStart      = (float)getInt32Param("angleStart") * M_PI / 180.0;
+    angleEnd        = (float)getInt32Param("angleEnd")   * M_PI / 180.0;
+    servoVel        = (float)getInt32Param("servoVel")   * M_PI / 180.0;
+    servoAcc        = (float)getInt32Param("servoAcc")   * M_PI / 180.0;
+    ladarOffsetX    = getInt32Param("ladarOffsetX");
+    ladarOffsetY    = getInt32Param("ladarOffsetY");
+    ladarOffsetZ    = getInt32Param("ladarOffsetZ");
+    maxRange        = getInt32Param("maxRange");
+    reduce          = getInt32Param("reduce");
+    compressFlagsS1 = getInt32Param("compressFlagsS1");
+    compressFlagsS2 = getInt32Param("compressFlagsS2");
+    compressFlagsS3 = getInt32Param("compressFlagsS3");
+
+    if (servoVel <= 0.0f)
+    {
+        GDOS_ERROR("Invalid servo velocity %d deg/s\n", getInt32Param("servoVel"));
+        return -EINVAL;
+    }
+
+    // one 3d scan per sweep
+    moveTime             = (rack_time_t)(fabs(angleEnd - angleStart) / servoVel * 1000.0);
+    dataBufferPeriodTime = moveTime;
+
+    ret = ladar->on();
+    if (ret)
+    {
+        GDOS_ERROR("Can't turn on Ladar(%d/%d), code = %d \n", ladarSys, ladarInst, ret);
+        return ret;
+    }
+
+    ret = servo->on();
+    if (ret)
+    {
+        GDOS_ERROR("Can't turn on ServoDrive(%d/%d), code = %d \n", servoSys, servoInst, ret);
+        return ret;
+    }
+
+    if (positionInst >= 0)
+    {
+        ret = position->on();
+        if (ret)
+        {
+            GDOS_ERROR("Can't turn on Position(%d/%d), code = %d\n", positionSys, positionInst, ret);
+            return ret;
+        }
+    }
+
+    // move to the start of the first sweep
+    GDOS_DBG_INFO("Moving servo to the start angle %d deg\n", getInt32Param("angleStart"));
+
+    ret = servo->movePos(angleStart, servoVel, servoAcc, 1, 0,
+                         rackTime.toNano(2 * moveTime + 5000));
+    if (ret)
+    {
+        GDOS_ERROR("Can't move ServoDrive(%d/%d) to the start angle, code = %d \n",
+                   servoSys, servoInst, ret);
+        return ret;
+    }
+
+    assembly.clearServo();
+    servoTarget = angleEnd;
+    scanning    = 0;
+
+    ladarMbx.clean();
+
+    ret = ladar->getContData(0, &ladarMbx, &ladarPeriodTime);
+    if (ret)
+    {
+        GDOS_ERROR("Can't get continuous data from Ladar(%d/%d), "
+                   "code = %d \n", ladarSys, ladarInst, ret);
+        return ret;
+    }
+
+    return RackDataModule::moduleOn();  // has to be last command in moduleOn();
+}
+
+void Scan3d::moduleOff(void)
+{
+    RackDataModule::moduleOff();        // has to be first command in moduleOff();
+
+    ladar->stopContData(&ladarMbx);
+    servo->moveVel(0.0f);
+}
+
+int  Scan3d::moduleLoop(void)
+{
+    scan3d_data*    data3D;
+    ladar_data*     dataLadar;
+    RackMessage     msgInfo;
+    int             ret;
+
+    // get datapointer from rackdatabuffer, the 3d scan grows there
+    // until the end of the sweep
+    data3D = (scan3d_data *)getDataBufferWorkSpace();
+
+    // get Ladar data
+    ret = ladarMbx.peekTimed(rackTime.toNano(2 * ladarPeriodTime), &msgInfo);
+    if (ret)
+    {
+        GDOS_ERROR("Can't receive ladar data on DATA_MBX, "
+                   "code = %d \n", ret);
+        return ret;
+    }
+
+    if ((msgInfo.getType() != MSG_DATA) ||
+        (msgInfo.getSrc()  != ladar->getDestAdr()))
+    {
+        GDOS_ERROR("Received unexpected message from %n to %n type %d on "
+                   "data mailbox\n", msgInfo.getSrc(), msgInfo.getDest(), msgInfo.getType());
+
+        ladarMbx.peekEnd();
+        return -EINVAL;
+    }
+
+    dataLadar = LadarData::parse(&msgInfo);
+
+    if (dataLadar->pointNum > LADAR_DATA_MAX_POINT_NUM)
+    {
+        GDOS_ERROR("PointNum (%d) too great\n", dataLadar->pointNum);
+        ladarMbx.peekEnd();
+        return -EINVAL;
+    }
+
+    // get servo position
+    ret = servo->getData(&servoData, sizeof(servo_drive_data), 0);
+    if (ret)
+    {
+        GDOS_ERROR("Can't get data from ServoDrive(%d/%d), code = %d\n",
+                   servoSys, servoInst, ret);
+        ladarMbx.peekEnd();
+        return ret;
+    }
+    assembly.addServo(servoData.recordingTime, servoData.position);
+
+    if (!scanning)
+    {
+        ret = startScan(data3D);
+        if (ret)
+        {
+            ladarMbx.peekEnd();
+            return ret;
+        }
+    }
+
+    // transform the 2d scan and write the range image row
+    ret = assembly.addScan(dataLadar);
+
+    ladarMbx.peekEnd();
+
+    if (ret == -ENOSPC)
+    {
+        GDOS_WARNING("3d scan is full after %d 2d scans, increase reduce\n",
+                     assembly.getScanNum());
+        return finishScan(data3D);
+    }
+    else if (ret)
+    {
+        GDOS_ERROR("Can't add 2d scan, code = %d\n", ret);
+        return ret;
+    }
+
+    // the sweep ends at the target angle, the next one turns back
+    if (fabs(servoData.position - servoTarget) < SCAN3D_SERVO_TOLERANCE)
+    {
+        if (servoTarget == angleEnd)
+            servoTarget = angleStart;
+        else
+            servoTarget = angleEnd;
+
+        return finishScan(data3D);
+    }
+
+    return 0;
+}
+
+int  Scan3d::moduleCommand(RackMessage *msgInfo)
+{
+    scan3d_range_img_data   *img;
+
+    switch (msgInfo->getType())
+    {
+        case MSG_SCAN3D_GET_RANGE_IMAGE:
+            rangeImgMtx.lock(RACK_INFINITE);
+
+            img = assembly.getRangeImage();
+            if (img)
+            {
+                cmdMbx.sendDataMsgReply(MSG_SCAN3D_RANGE_IMAGE, msgInfo, 1, img,
+                                        Scan3dAssembly::getRangeImageLen(img));
+            }
+            else
+            {
+                cmdMbx.sendMsgReply(MSG_ERROR, msgInfo);
+            }
+
+            rangeImgMtx.unlock();
+            break;
+
+        default:
+            // not for me -> ask RackDataModule
+            return RackDataModule::moduleCommand(msgInfo);
+    }
+    return 0;
+}
+
+// starts the servo and a new 3d scan
+int  Scan3d::startScan(scan3d_data *data3D)
+{
+    int mode, ret;
+
+    mode = scanMode & ~SCAN3D_POSITIVE_TURN;
+    if (servoTarget > servoData.position)
+    {
+        mode |= SCAN3D_POSITIVE_TURN;
+    }
+
+    ret = servo->movePos(servoTarget, servoVel, servoAcc, 0, 0);
+    if (ret)
+    {
+        GDOS_ERROR("Can't move ServoDrive(%d/%d), code = %d\n",
+                   servoSys, servoInst, ret);
+        return ret;
+    }
+
+    assembly.setParam(mode, maxRange, ladarOffsetX, ladarOffsetY, ladarOffsetZ, reduce);
+    assembly.start(data3D);
+    data3D->scanHardware = scanHardware;
+
+    scanning = 1;
+    return 0;
+}
+
+// publishes the 3d scan, the range image becomes valid
+int  Scan3d::finishScan(scan3d_data *data3D)
+{
+    int ret;
+
+    scanning = 0;
+
+    rangeImgMtx.lock(RACK_INFINITE);
+    assembly.finish();
+    rangeImgMtx.unlock();
+
+    if (data3D->scanNum == 0)
+    {
+        return 0;
+    }
+
+    if (positionInst >= 0)
+    {
+        ret = position->getData(&positionData, sizeof(position_data),
+                                data3D->recordingTime);
+        if (ret)
+        {
+            GDOS_ERROR("Can't get data from Position(%d/%d), code = %d\n",
+                       positionSys, positionInst, ret);
+            return ret;
+        }
+        memcpy(&data3D->refPos, &positionData.pos, sizeof(position_3d));
+    }
+    else
+    {
+        memset(&data3D->refPos, 0, sizeof(position_3d));
+    }
+
+    compressTool->CompressBlocks(data3D, compressFlagsS1, compressFlagsS2, compressFlagsS3);
+
+    GDOS_DBG_DETAIL("recordingTime %i, scanNum %i, pointNum %i, compressed %i\n",
+                    data3D->recordingTime, data3D->scanNum, data3D->pointNum,
+                    data3D->compressed);
+
+    putDataBufferWorkSpace(Scan3dData::getDatalen(data3D));
+    return 0;
+}
+
+/*******************************************************************************
+ *   !!! NON REALTIME CONTEXT !!!
+ *
+ *   moduleInit,
+ *   moduleCleanup,
+ *   Constructor,
+ *   Destructor,
+ *   main,
+ *
+ *   own non realtime user functions
+ ******************************************************************************/
+
+// init_flags (for init and cleanup)
+#define INIT_BIT_DATA_MODULE        0
+#define INIT_BIT_MBX_WORK           1
+#define INIT_BIT_MBX_LADAR          2
+#define INIT_BIT_PROXY_LADAR        3
+#define INIT_BIT_PROXY_SERVO        4
+#define INIT_BIT_PROXY_POSITION     5
+#define INIT_BIT_MTX_RANGE_IMG      6
+#define INIT_BIT_COMPRESS_TOOL      7
+#define INIT_BIT_MBX_COMPRESS       8
+
+int  Scan3d::moduleInit(void)
+{
+    int ret;
+
+    // call RackDataModule init function (first command in init)
+    ret = RackDataModule::moduleInit();
+    if (ret)
+    {
+        return ret;
+    }
+    initBits.setBit(INIT_BIT_DATA_MODULE);
+
+    // work mailbox
+    ret = createMbx(&workMbx, 1, sizeof(position_data), MBX_IN_KERNELSPACE | MBX_SLOT);
+    if (ret)
+    {
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_MBX_WORK);
+
+    // ladar mailbox, keeps the 2d scans during the compression
+    ret = createMbx(&ladarMbx, 5, sizeof(ladar_data_msg),
+                    MBX_IN_USERSPACE | MBX_SLOT);
+    if (ret)
+    {
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_MBX_LADAR);
+
+    // create ladar proxy
+    ladar = new LadarProxy(&workMbx, ladarSys, ladarInst);
+    if (!ladar)
+    {
+        ret = -ENOMEM;
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_PROXY_LADAR);
+
+    // create servo drive proxy
+    servo = new ServoDriveProxy(&workMbx, servoSys, servoInst);
+    if (!servo)
+    {
+        ret = -ENOMEM;
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_PROXY_SERVO);
+
+    // create position proxy
+    if (positionInst >= 0)
+    {
+        position = new PositionProxy(&workMbx, positionSys, positionInst);
+        if (!position)
+        {
+            ret = -ENOMEM;
+            goto init_error;
+        }
+        initBits.setBit(INIT_BIT_PROXY_POSITION);
+    }
+
+    // range image mutex
+    ret = rangeImgMtx.create();
+    if (ret)
+    {
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_MTX_RANGE_IMG);
+
+    // range images
+    ret = assembly.init(SCAN3D_POINT_MAX);
+    if (ret)
+    {
+        goto init_error;
+    }
+
+    // compression
+    compressTool = new Scan3dCompressTool(&cmdMbx, gdosLevel, &rackTime);
+    if (!compressTool)
+    {
+        ret = -ENOMEM;
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_COMPRESS_TOOL);
+
+    if (compressWorkerNum > 0)
+    {
+        // the compression workers wait for jobs in these mailboxes
+        ret = createMbx(&compressJobMbx, COMPR_BLOCK_WORKER_NUM_MAX, 0,
+                        MBX_IN_KERNELSPACE | MBX_SLOT);
+        if (ret)
+        {
+            goto init_error;
+        }
+
+        ret = createMbx(&compressDoneMbx, COMPR_BLOCK_WORKER_NUM_MAX, 0,
+                        MBX_IN_KERNELSPACE | MBX_SLOT);
+        if (ret)
+        {
+            destroyMbx(&compressJobMbx);
+            goto init_error;
+        }
+        initBits.setBit(INIT_BIT_MBX_COMPRESS);
+
+        ret = compressTool->initBlocks(COMPR_BLOCK_POINT_NUM, compressWorkerNum,
+                                       getDataTaskPrio(), &compressJobMbx,
+                                       &compressDoneMbx);
+        if (ret)
+        {
+            GDOS_ERROR("Can't create compression workers, code = %d\n", ret);
+            goto init_error;
+        }
+    }
+
+    return 0;
+
+init_error:
+    // !!! call local cleanup function !!!
+    Scan3d::moduleCleanup();
+    return ret;
+}
+
+void Scan3d::moduleCleanup(void)
+{
+    // call RackDataModule cleanup function
+    if (initBits.testAndClearBit(INIT_BIT_DATA_MODULE))
+    {
+        RackDataModule::moduleCleanup();
+    }
+
+    if (initBits.testAndClearBit(INIT_BIT_COMPRESS_TOOL))
+    {
+        delete compressTool;
+    }
+
+    if (initBits.testAndClearBit(INIT_BIT_MTX_RANGE_IMG))
+    {
+        rangeImgMtx.destroy();
+    }
+
+    // free proxies
+    if (initBits.testAndClearBit(INIT_BIT_PROXY_POSITION))
+    {
+        delete position;
+    }
+
+    if (initBits.testAndClearBit(INIT_BIT_PROXY_SERVO))
+    {
+        delete servo;
+    }
+
+    if (initBits.testAndClearBit(INIT_BIT_PROXY_LADAR))
+    {
+        delete ladar;
+    }
+
+    // delete mailboxes
+    if (initBits.testAndClearBit(INIT_BIT_MBX_COMPRESS))
+    {
+        destroyMbx(&compressDoneMbx);
+        destroyMbx(&compressJobMbx);
+    }
+
+    if (initBits.testAndClearBit(INIT_BIT_MBX_LADAR))
+    {
+        destroyMbx(&ladarMbx);
+    }
+
+    if (initBits.testAndClearBit(INIT_BIT_MBX_WORK))
+    {
+        destroyMbx(&workMbx);
+    }
+}
+
+Scan3d::Scan3d(void)
+      : RackDataModule( MODULE_CLASS_ID,
+                    5000000000llu,    // 5s datatask error sleep time
+                    16,               // command mailbox slots
+                    48,               // command mailbox data size per slot
+                    MBX_IN_KERNELSPACE | MBX_SLOT,  // command mailbox flags
+                    5,                // max buffer entries
+                    10)               // data buffer listener
+{
+    // get static module parameter
+    ladarSys          = getIntArg("ladarSys", argTab);
+    ladarInst         = getIntArg("ladarInst", argTab);
+    servoSys          = getIntArg("servoSys", argTab);
+    servoInst         = getIntArg("servoInst", argTab);
+    positionSys       = getIntArg("positionSys", argTab);
+    positionInst      = getIntArg("positionInst", argTab);
+    scanHardware      = getIntArg("scanHardware", argTab);
+    compressWorkerNum = getIntArg("compressWorkerNum", argTab);
+
+    dataBufferMaxDataSize = sizeof(scan3d_msg);
+}
+
+int  main(int argc, char *argv[])
+{
+    int ret;
+
+    // get args
+    ret = RackModule::getArgs(argc, argv, argTab, "Scan3d");
+    if (ret)
+    {
+        printf("Invalid arguments -> EXIT \n");
+        return ret;
+    }
+
+    // create new Scan3d
+
+    Scan3d *pInst;
+
+    pInst = new Scan3d();
+    if (!pInst)
+    {
+        printf("Can't create new Scan3d -> EXIT\n");
+        return -ENOMEM;
+    }
+
+    // init
+    ret = pInst->moduleInit();
+    if (ret)
+        goto exit_error;
+
+    pInst->run();
+
+    return 0;
+
+exit_error:
+    delete (pInst);
+    return ret;
+}
@@ -0,0 +1,126 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Oliver Wulf <wulf@rts.uni-hannover.de>
+ *
+ */
+#ifndef __SCAN3D_H__
+#define __SCAN3D_H__
+
+#include <main/rack_data_module.h>
+#include <main/rack_mutex.h>
+#include <main/scan3d_compress_tool.h>
+#include <perception/scan3d_proxy.h>
+#include <drivers/ladar_proxy.h>
+#include <drivers/servo_drive_proxy.h>
+#include <navigation/position_proxy.h>
+
+#include "scan3d_assembly.h"
+
+#define MODULE_CLASS_ID             SCAN3D
+
+#define SCAN3D_SERVO_TOLERANCE      0.01            // [rad] end of a sweep
+
+typedef struct {
+    ladar_data      data;
+    ladar_point     point[LADAR_DATA_MAX_POINT_NUM];
+} __attribute__((packed)) ladar_data_msg;
+
+typedef struct {
+    scan3d_data     data;
+    scan_point      point[SCAN3D_POINT_MAX];
+} __attribute__((packed)) scan3d_msg;
+
+/**
+ * Scan3d
+ *
+ * Assembles 3d scans out of the 2d scans of a ladar turned by a servo
+ * drive. The servo sweeps between two angles, every sweep is one 3d scan.
+ * The range image is built together with the 3d scan, the last complete
+ * one is replied on MSG_SCAN3D_GET_RANGE_IMAGE.
+ *
+ * @ingroup modules_scan3d
+ */
+class Scan3d : public RackDataModule {
+    private:
+
+        // own vars
+        int             ladarSys;
+        int             ladarInst;
+        int             servoSys;
+        int             servoInst;
+        int             positionSys;
+        int             positionInst;
+        int             scanHardware;
+        int             compressWorkerNum;
+
+        int             scanMode;
+        int             ladarOffsetX;
+        int             ladarOffsetY;
+        int             ladarOffsetZ;
+        int             maxRange;
+        int             reduce;
+        float           angleStart;
+        float           angleEnd;
+        float           servoVel;
+        float           servoAcc;
+        uint32_t        compressFlagsS1;
+        uint32_t        compressFlagsS2;
+        uint32_t        compressFlagsS3;
+
+        int             scanning;
+        float           servoTarget;
+        rack_time_t     ladarPeriodTime;
+
+        // mailboxes
+        RackMailbox     workMbx;
+        RackMailbox     ladarMbx;
+        RackMailbox     compressJobMbx;
+        RackMailbox     compressDoneMbx;
+
+        // proxies
+        LadarProxy          *ladar;
+        ServoDriveProxy     *servo;
+        PositionProxy       *position;
+
+        // data structures
+        Scan3dAssembly      assembly;
+        Scan3dCompressTool  *compressTool;
+        RackMutex           rangeImgMtx;
+        servo_drive_data    servoData;
+        position_data       positionData;
+
+        int      startScan(scan3d_data *data3D);
+        int      finishScan(scan3d_data *data3D);
+
+    protected:
+
+        // -> realtime context
+        int  moduleOn(void);
+        void moduleOff(void);
+        int  moduleLoop(void);
+        int  moduleCommand(RackMessage *msgInfo);
+
+        // -> non realtime context
+        void moduleCleanup(void);
+
+    public:
+
+        // constructor und destructor
+        Scan3d();
+        ~Scan3d() {};
+
+        // -> non realtime context
+        int  moduleInit(void);
+};
+
+#endif // __SCAN3D_H__
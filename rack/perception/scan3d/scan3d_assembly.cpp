@@ -0,0 +1,393 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Oliver Wulf <wulf@rts.uni-hannover.de>
+ *
+ */
+#include "scan3d_assembly.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+Scan3dAssembly::Scan3dAssembly()
+{
+    scanMode      = SCAN3D_ROLL;
+    maxRange      = SCAN3D_RANGE_IMG_MAX;
+    offsetX       = 0;
+    offsetY       = 0;
+    offsetZ       = 0;
+    reduce        = 1;
+    pointMax      = 0;
+    data          = NULL;
+    rangeImg[0]   = NULL;
+    rangeImg[1]   = NULL;
+    rangeImgWork  = 0;
+    rangeImgValid = -1;
+    angleNum      = 0;
+
+    clearServo();
+}
+
+Scan3dAssembly::~Scan3dAssembly()
+{
+    if (rangeImg[0])
+        free(rangeImg[0]);
+    if (rangeImg[1])
+        free(rangeImg[1]);
+}
+
+// allocates both range images for scans up to pointMax points
+int  Scan3dAssembly::init(int pointMax)
+{
+    int i;
+
+    for (i = 0; i < 2; i++)
+    {
+        if (rangeImg[i])
+            free(rangeImg[i]);
+
+        rangeImg[i] = (scan3d_range_img_data *)malloc(sizeof(scan3d_range_img_data) +
+                                                      pointMax * sizeof(scan3d_range_img_point));
+        if (!rangeImg[i])
+        {
+            this->pointMax = 0;
+            return -ENOMEM;
+        }
+        rangeImg[i]->scanNum      = 0;
+        rangeImg[i]->scanPointNum = 0;
+    }
+
+    this->pointMax = pointMax;
+    rangeImgWork   = 0;
+    rangeImgValid  = -1;
+    return 0;
+}
+
+void Scan3dAssembly::setParam(int scanMode, int maxRange, int offsetX, int offsetY,
+                              int offsetZ, int reduce)
+{
+    this->scanMode = scanMode;
+    this->maxRange = maxRange;
+    this->offsetX  = offsetX;
+    this->offsetY  = offsetY;
+    this->offsetZ  = offsetZ;
+    this->reduce   = (reduce > 0) ? reduce : 1;
+}
+
+//
+// servo positions
+//
+
+void Scan3dAssembly::addServo(rack_time_t time, float position)
+{
+    if (servoNum > 0)
+    {
+        // same data again
+        if (time == servoTime[servoIndex])
+            return;
+
+        // time jump, start a new history
+        if ((int32_t)(time - servoTime[servoIndex]) < 0)
+            clearServo();
+    }
+
+    servoIndex = (servoIndex + 1) % SCAN3D_SERVO_HISTORY_MAX;
+    servoTime[servoIndex] = time;
+    servoPos[servoIndex]  = position;
+
+    if (servoNum < SCAN3D_SERVO_HISTORY_MAX)
+        servoNum++;
+}
+
+// interpolates the servo position at the given time
+int  Scan3dAssembly::getServo(rack_time_t time, float *position)
+{
+    int     i, k, next, prev, dt;
+
+    if (servoNum == 0)
+        return -ENODATA;
+
+    // newer than the last position, extrapolate up to one interval
+    if ((int32_t)(time - servoTime[servoIndex]) >= 0)
+    {
+        if (servoNum == 1)
+        {
+            *position = servoPos[servoIndex];
+            return 0;
+        }
+
+        prev = (servoIndex + SCAN3D_SERVO_HISTORY_MAX - 1) % SCAN3D_SERVO_HISTORY_MAX;
+        dt   = (int32_t)(servoTime[servoIndex] - servoTime[prev]);
+        if ((int32_t)(time - servoTime[servoIndex]) > dt)
+            time = servoTime[servoIndex] + dt;
+
+        *position = servoPos[servoIndex] + (servoPos[servoIndex] - servoPos[prev]) *
+                    (float)(int32_t)(time - servoTime[servoIndex]) / (float)dt;
+        return 0;
+    }
+
+    // search the positions before and after time, newest first
+    k = servoIndex;
+    for (i = 1; i < servoNum; i++)
+    {
+        next = k;
+        k    = (k + SCAN3D_SERVO_HISTORY_MAX - 1) % SCAN3D_SERVO_HISTORY_MAX;
+
+        if ((int32_t)(time - servoTime[k]) >= 0)
+        {
+            dt        = (int32_t)(servoTime[next] - servoTime[k]);
+            *position = servoPos[k] + (servoPos[next] - servoPos[k]) *
+                        (float)(int32_t)(time - servoTime[k]) / (float)dt;
+            return 0;
+        }
+    }
+
+    // older than the history
+    *position = servoPos[k];
+    return 0;
+}
+
+void Scan3dAssembly::clearServo(void)
+{
+    servoIndex = 0;
+    servoNum   = 0;
+}
+
+//
+// 3d scan
+//
+
+// starts a new 3d scan in data
+void Scan3dAssembly::start(scan3d_data *data)
+{
+    scan3d_range_img_data *img = rangeImg[rangeImgWork];
+
+    this->data         = data;
+    data->duration     = 0;
+    data->maxRange     = maxRange;
+    data->scanNum      = 0;
+    data->scanPointNum = 0;
+    data->scanMode     = scanMode;
+    data->sectorNum    = 1;
+    data->sectorIndex  = 0;
+    data->pointNum     = 0;
+    data->compressed   = 0;
+
+    if (img)
+    {
+        img->scanMode     = scanMode;
+        img->maxRange     = maxRange < SCAN3D_RANGE_IMG_MAX ? maxRange : SCAN3D_RANGE_IMG_MAX;
+        img->scanNum      = 0;
+        img->scanPointNum = 0;
+    }
+}
+
+// appends a 2d scan, the servo angle moves from angleStart to angleEnd
+int  Scan3dAssembly::addScan(ladar_data *ladar, float angleStart, float angleEnd)
+{
+    scan3d_range_img_data   *img = rangeImg[rangeImgWork];
+    scan3d_range_img_point  *imgPoint;
+    scan_point              *point;
+    double                  c, s, cd, sd, tmp, d, xs, ys;
+    int                     i, j, width, type, range;
+
+    if (!data || !img || (ladar->pointNum > LADAR_DATA_MAX_POINT_NUM))
+        return -EINVAL;
+
+    if (ladar->pointNum <= 0)
+        return 0;
+
+    // the first 2d scan defines the row width of the 3d scan
+    width = (ladar->pointNum + reduce - 1) / reduce;
+    if (data->scanNum == 0)
+    {
+        data->scanPointNum  = width;
+        data->recordingTime = ladar->recordingTime;
+        startTime           = ladar->recordingTime;
+        if (ladar->maxRange < maxRange)
+        {
+            data->maxRange = ladar->maxRange;
+        }
+    }
+    width = data->scanPointNum;
+
+    if ((data->scanNum >= SCAN3D_SCAN_MAX) || (data->pointNum + width > pointMax))
+        return -ENOSPC;
+
+    // cos / sin of the ladar angles only change with the ladar
+    if (angleNum != ladar->pointNum)
+    {
+        angleNum = 0;
+    }
+    for (i = 0; i < ladar->pointNum; i++)
+    {
+        if ((i >= angleNum) || (angle[i] != ladar->point[i].angle))
+        {
+            angle[i]    = ladar->point[i].angle;
+            angleCos[i] = cos(angle[i]);
+            angleSin[i] = sin(angle[i]);
+        }
+    }
+    angleNum = ladar->pointNum;
+
+    // the servo angle of the points is turned on step by step
+    c = cos(angleStart);
+    s = sin(angleStart);
+    if (ladar->pointNum > 1)
+    {
+        d  = (double)(angleEnd - angleStart) * reduce / (ladar->pointNum - 1);
+        cd = cos(d);
+        sd = sin(d);
+    }
+    else
+    {
+        cd = 1.0;
+        sd = 0.0;
+    }
+
+    point    = &data->point[data->pointNum];
+    imgPoint = &img->point[data->scanNum * width];
+
+    for (j = 0; j < width; j++)
+    {
+        i = j * reduce;
+
+        if (i >= ladar->pointNum)
+        {
+            point[j].x         = offsetX;
+            point[j].y         = offsetY;
+            point[j].z         = offsetZ;
+            point[j].type      = SCAN_POINT_TYPE_INVALID;
+            point[j].segment   = 0;
+            point[j].intensity = 0;
+
+            imgPoint[j].range  = 0;
+            imgPoint[j].type   = SCAN_POINT_TYPE_INVALID;
+            continue;
+        }
+
+        type  = SCAN_POINT_TYPE_UNKNOWN;
+        range = ladar->point[i].distance;
+
+        switch (ladar->point[i].type)
+        {
+            case LADAR_POINT_TYPE_TRANSPARENT:
+            case LADAR_POINT_TYPE_RAIN:
+            case LADAR_POINT_TYPE_DIRT:
+            case LADAR_POINT_TYPE_INVALID:
+                type |= SCAN_POINT_TYPE_INVALID;
+                break;
+
+            case LADAR_POINT_TYPE_REFLECTOR:
+                type |= SCAN_POINT_TYPE_REFLECTOR;
+                break;
+        }
+
+        if (range >= data->maxRange)
+        {
+            range  = data->maxRange;
+            type  |= SCAN_POINT_TYPE_MAX_RANGE | SCAN_POINT_TYPE_INVALID;
+        }
+
+        xs = range * angleCos[i];
+        ys = range * angleSin[i];
+
+        switch (scanMode & 0xff)
+        {
+            case SCAN3D_ROLL:
+                point[j].x = (int32_t)xs + offsetX;
+                point[j].y = (int32_t)(ys * c) + offsetY;
+                point[j].z = (int32_t)(ys * s) + offsetZ;
+                break;
+
+            case SCAN3D_PITCH:
+                point[j].x = (int32_t)(xs * c) + offsetX;
+                point[j].y = (int32_t)ys + offsetY;
+                point[j].z = (int32_t)(xs * s) + offsetZ;
+                break;
+
+            default:    // yaw, the ladar scans vertically
+                point[j].x = (int32_t)(xs * c) + offsetX;
+                point[j].y = (int32_t)(xs * s) + offsetY;
+                point[j].z = (int32_t)ys + offsetZ;
+                break;
+        }
+        point[j].type      = type;
+        point[j].segment   = 0;
+        point[j].intensity = (int16_t)ladar->point[i].intensity;
+
+        imgPoint[j].range  = range < SCAN3D_RANGE_IMG_MAX ? range : SCAN3D_RANGE_IMG_MAX;
+        imgPoint[j].type   = type;
+
+        // next servo angle
+        tmp = c * cd - s * sd;
+        s   = s * cd + c * sd;
+        c   = tmp;
+    }
+
+    endTime         = ladar->recordingTime;
+    data->duration  = endTime - startTime;
+    data->pointNum += width;
+    data->scanNum++;
+
+    img->recordingTime = data->recordingTime;
+    img->scanNum       = data->scanNum;
+    img->scanPointNum  = width;
+
+    return 0;
+}
+
+// appends a 2d scan with the interpolated servo angles
+int  Scan3dAssembly::addScan(ladar_data *ladar)
+{
+    float   angleStart, angleEnd;
+    int     ret;
+
+    // recordingTime is the middle of the 2d scan
+    ret = getServo(ladar->recordingTime - ladar->duration / 2, &angleStart);
+    if (ret)
+        return ret;
+
+    ret = getServo(ladar->recordingTime + ladar->duration / 2, &angleEnd);
+    if (ret)
+        return ret;
+
+    return addScan(ladar, angleStart, angleEnd);
+}
+
+// the range image of the 3d scan becomes valid
+void Scan3dAssembly::finish(void)
+{
+    if (data && (data->scanNum > 0))
+    {
+        rangeImgValid = rangeImgWork;
+        rangeImgWork  = 1 - rangeImgWork;
+    }
+    data = NULL;
+}
+
+// last complete range image, NULL if there is none
+scan3d_range_img_data* Scan3dAssembly::getRangeImage(void)
+{
+    if (rangeImgValid < 0)
+        return NULL;
+
+    return rangeImg[rangeImgValid];
+}
+
+size_t Scan3dAssembly::getRangeImageLen(scan3d_range_img_data *img)
+{
+    return sizeof(scan3d_range_img_data) +
+           img->scanNum * img->scanPointNum * sizeof(scan3d_range_img_point);
+}
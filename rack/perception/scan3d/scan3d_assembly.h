@@ -0,0 +1,90 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Oliver Wulf <wulf@rts.uni-hannover.de>
+ *
+ */
+#ifndef __SCAN3D_ASSEMBLY_H__
+#define __SCAN3D_ASSEMBLY_H__
+
+#include <perception/scan3d_proxy.h>
+#include <drivers/ladar_proxy.h>
+
+#define SCAN3D_SERVO_HISTORY_MAX    64              // servo positions used for interpolation
+#define SCAN3D_RANGE_IMG_MAX        32767           // [mm] maximum range of the range image
+
+/**
+ * Assembly of 3d scans out of 2d ladar scans
+ *
+ * Every 2d scan is transformed with the servo angle at the time of its
+ * points and appended to a scan3d_data message. The servo angles are
+ * interpolated linearly between the recorded servo positions. At the same
+ * time the ranges are written into a row of the range image, so the range
+ * image is complete together with the 3d scan. Two range images are used,
+ * the last complete one stays valid while the next one is built.
+ */
+class Scan3dAssembly
+{
+    private:
+        int             scanMode;
+        int             maxRange;
+        int             offsetX;
+        int             offsetY;
+        int             offsetZ;
+        int             reduce;
+        int             pointMax;
+
+        scan3d_data     *data;
+        rack_time_t     startTime;
+        rack_time_t     endTime;
+
+        scan3d_range_img_data   *rangeImg[2];
+        int             rangeImgWork;               // range image being built
+        int             rangeImgValid;
+
+        float           angle[LADAR_DATA_MAX_POINT_NUM];    // ladar angles of the
+        double          angleCos[LADAR_DATA_MAX_POINT_NUM]; // cached cos / sin
+        double          angleSin[LADAR_DATA_MAX_POINT_NUM];
+        int             angleNum;
+
+        rack_time_t     servoTime[SCAN3D_SERVO_HISTORY_MAX];
+        float           servoPos[SCAN3D_SERVO_HISTORY_MAX];
+        int             servoIndex;
+        int             servoNum;
+
+    public:
+        Scan3dAssembly();
+        ~Scan3dAssembly();
+
+        int  init(int pointMax);
+        void setParam(int scanMode, int maxRange, int offsetX, int offsetY,
+                      int offsetZ, int reduce);
+
+        void addServo(rack_time_t time, float position);
+        int  getServo(rack_time_t time, float *position);
+        void clearServo(void);
+
+        void start(scan3d_data *data);
+        int  addScan(ladar_data *ladar, float angleStart, float angleEnd);
+        int  addScan(ladar_data *ladar);
+        void finish(void);
+
+        scan3d_range_img_data* getRangeImage(void);
+        static size_t getRangeImageLen(scan3d_range_img_data *img);
+
+        int  getScanNum(void)
+        {
+            return data ? data->scanNum : 0;
+        }
+};
+
+#endif // __SCAN3D_ASSEMBLY_H__
@@ -0,0 +1,280 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Oliver Wulf <wulf@rts.uni-hannover.de>
+ *
+ */
+#include <main/rack_module.h>
+#include <main/rack_name.h>
+#include <main/argopts.h>
+#include <main/scan3d_compress_tool.h>
+
+#include <math.h>
+
+#include "scan3d_assembly.h"
+
+//
+// Assembles rolling 3d scans of a synthetic room like the Scan3d module.
+// A servo position is recorded every 10 ms, the 2d scans take their
+// servo angles out of this history. The times of the assembly (transform
+// and range image) and of the compression are printed per 3d scan.
+// The job mailboxes of the compression workers need a running TiMS router.
+//
+
+#define ROOM_X                      5000            // [mm] half size of the room
+#define ROOM_Y                      4000
+#define ROOM_Z_MIN                  -1000
+#define ROOM_Z_MAX                  2000
+
+//
+// data structures
+//
+
+arg_table_t argTab[] = {
+
+    { ARGOPT_OPT, "scanNum", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Number of 3d scans, default 10", { 10 } },
+
+    { ARGOPT_OPT, "ladarPointNum", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Points per 2d scan over 180 deg, default 181", { 181 } },
+
+    { ARGOPT_OPT, "ladarPeriodTime", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Time of a 2d scan in ms, default 13", { 13 } },
+
+    { ARGOPT_OPT, "servoVel", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Servo velocity in deg/s, default 60", { 60 } },
+
+    { ARGOPT_OPT, "flagsS1", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Compression flags of step 1, default 1 (COMPR_S1_REDUCE_BITS)", { COMPR_S1_REDUCE_BITS } },
+
+    { ARGOPT_OPT, "flagsS2", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Compression flags of step 2, default 0 (COMPR_S2_NONE)", { COMPR_S2_NONE } },
+
+    { ARGOPT_OPT, "flagsS3", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Compression flags of step 3, default 49 (COMPR_S3_HUFFMANN)", { COMPR_S3_HUFFMANN } },
+
+    { ARGOPT_OPT, "workerNum", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Number of compression worker tasks, default 3", { 3 } },
+
+    { 0, "", 0, 0, "", { 0 } } // last entry
+};
+
+typedef struct {
+    ladar_data      data;
+    ladar_point     point[LADAR_DATA_MAX_POINT_NUM];
+} __attribute__((packed)) ladar_data_msg;
+
+// distance to the walls of the room along a direction
+static int roomDist(double dx, double dy, double dz)
+{
+    double d = 1e9;
+
+    if (dx > 1e-9)
+        d = fmin(d,  ROOM_X / dx);
+    if (dx < -1e-9)
+        d = fmin(d, -ROOM_X / dx);
+    if (dy > 1e-9)
+        d = fmin(d,  ROOM_Y / dy);
+    if (dy < -1e-9)
+        d = fmin(d, -ROOM_Y / dy);
+    if (dz > 1e-9)
+        d = fmin(d,  ROOM_Z_MAX / dz);
+    if (dz < -1e-9)
+        d = fmin(d,  ROOM_Z_MIN / dz);
+
+    return (int)d;
+}
+
+// servo turning between -90 and 90 deg
+static double servoAngle(rack_time_t t, double sweepTime)
+{
+    double u = fmod((double)t, 2.0 * sweepTime) / sweepTime;
+
+    if (u <= 1.0)
+        return -M_PI / 2.0 + M_PI * u;
+    else
+        return M_PI / 2.0 - M_PI * (u - 1.0);
+}
+
+int  main(int argc, char *argv[])
+{
+    RackTime            rackTime;
+    RackMailbox         jobMbx, doneMbx;
+    Scan3dAssembly      assembly;
+    Scan3dCompressTool  *serialTool, *blockTool;
+    ladar_data_msg      ladar;
+    scan3d_data         *data, *copy;
+    scan3d_range_img_data *img;
+    uint64_t            time, assemblyTime = 0, serialTime = 0, blockTime = 0;
+    uint64_t            scan2dNum = 0, pointNum = 0, serialBytes = 0, blockBytes = 0;
+    rack_time_t         t, servoT;
+    double              vel, phi, a, sweepTime;
+    int                 ladarPointNum, period, scanNum, n, i, ret;
+    int                 rangeErr = 0;
+    uint32_t            flagsS1, flagsS2, flagsS3;
+    size_t              len;
+
+    // get args
+    ret = RackModule::getArgs(argc, argv, argTab, "Scan3dBench");
+    if (ret)
+    {
+        printf("Invalid arguments -> EXIT \n");
+        return ret;
+    }
+
+    scanNum       = getIntArg("scanNum", argTab);
+    ladarPointNum = getIntArg("ladarPointNum", argTab);
+    period        = getIntArg("ladarPeriodTime", argTab);
+    vel           = getIntArg("servoVel", argTab) * M_PI / 180.0;
+    flagsS1       = getIntArg("flagsS1", argTab);
+    flagsS2       = getIntArg("flagsS2", argTab);
+    flagsS3       = getIntArg("flagsS3", argTab);
+
+    if ((ladarPointNum < 2) || (ladarPointNum > LADAR_DATA_MAX_POINT_NUM) || (vel <= 0.0))
+    {
+        printf("Invalid ladar point number or servo velocity -> EXIT\n");
+        return -EINVAL;
+    }
+
+    len  = sizeof(scan3d_data) + SCAN3D_POINT_MAX * sizeof(scan_point);
+    data = (scan3d_data *)malloc(len);
+    copy = (scan3d_data *)malloc(len);
+    serialTool = new Scan3dCompressTool();
+    blockTool  = new Scan3dCompressTool();
+    if (!data || !copy || !serialTool || !blockTool || assembly.init(SCAN3D_POINT_MAX))
+    {
+        printf("Can't allocate buffers -> EXIT\n");
+        return -ENOMEM;
+    }
+
+    if (getIntArg("workerNum", argTab) > 0)
+    {
+        ret = jobMbx.create(RackName::create(TEST, 0) | 1, COMPR_BLOCK_WORKER_NUM_MAX,
+                            0, NULL, 0, 0);
+        if (!ret)
+        {
+            ret = doneMbx.create(RackName::create(TEST, 0) | 2, COMPR_BLOCK_WORKER_NUM_MAX,
+                                 0, NULL, 0, 0);
+        }
+        if (ret)
+        {
+            printf("Can't create the worker mailboxes (TiMS router running?), code = %d\n", ret);
+            return ret;
+        }
+    }
+
+    ret = blockTool->initBlocks(COMPR_BLOCK_POINT_NUM, getIntArg("workerNum", argTab), 1,
+                                &jobMbx, &doneMbx);
+    if (ret)
+    {
+        printf("Can't create compression workers, code = %d\n", ret);
+        return ret;
+    }
+
+    assembly.setParam(SCAN3D_ROLL, 30000, 0, 0, 0, 1);
+
+    // ladar over 180 deg
+    ladar.data.duration   = period;
+    ladar.data.maxRange   = 30000;
+    ladar.data.startAngle = -M_PI / 2.0;
+    ladar.data.endAngle   =  M_PI / 2.0;
+    ladar.data.pointNum   = ladarPointNum;
+
+    sweepTime = M_PI / vel * 1000.0;
+    servoT    = 0;
+    t         = 0;
+
+    for (n = 0; n < scanNum; n++)
+    {
+        assembly.start(data);
+
+        // one sweep of the servo
+        for (; t < (n + 1) * sweepTime; t += period)
+        {
+            // servo positions up to the end of the 2d scan
+            for (; servoT <= t + period; servoT += 10)
+            {
+                assembly.addServo(servoT, servoAngle(servoT, sweepTime));
+            }
+
+            phi = servoAngle(t, sweepTime);
+
+            ladar.data.recordingTime = t;
+            for (i = 0; i < ladarPointNum; i++)
+            {
+                a = -M_PI / 2.0 + M_PI * i / (ladarPointNum - 1);
+                ladar.point[i].angle     = a;
+                ladar.point[i].distance  = roomDist(cos(a), sin(a) * cos(phi), sin(a) * sin(phi));
+                ladar.point[i].type      = LADAR_POINT_TYPE_UNKNOWN;
+                ladar.point[i].intensity = 0;
+            }
+
+            time = rackTime.getNano();
+            ret  = assembly.addScan(&ladar.data);
+            assemblyTime += rackTime.getNano() - time;
+            if (ret)
+                break;
+
+            scan2dNum++;
+        }
+
+        assembly.finish();
+        pointNum += data->pointNum;
+
+        // the range image holds the ranges of the 3d points
+        img = assembly.getRangeImage();
+        for (i = 0; i < data->pointNum; i++)
+        {
+            if (abs(img->point[i].range - (int)sqrt((double)data->point[i].x * data->point[i].x +
+                                                    (double)data->point[i].y * data->point[i].y +
+                                                    (double)data->point[i].z * data->point[i].z)) > 2)
+                rangeErr++;
+        }
+
+        memcpy(copy, data, Scan3dData::getDatalen(data));
+        time = rackTime.getNano();
+        serialBytes += serialTool->Compress(copy, flagsS1, flagsS2, flagsS3);
+        serialTime  += rackTime.getNano() - time;
+
+        memcpy(copy, data, Scan3dData::getDatalen(data));
+        time = rackTime.getNano();
+        ret  = blockTool->CompressBlocks(copy, flagsS1, flagsS2, flagsS3);
+        blockTime   += rackTime.getNano() - time;
+        blockBytes  += ret ? ret : data->pointNum * sizeof(scan_point);
+    }
+
+    if (scanNum > 0)
+    {
+        printf("%d 3d scans, %d 2d scans, %d points per 3d scan, %d range image errors\n",
+               scanNum, (int)scan2dNum, (int)(pointNum / scanNum), rangeErr);
+        printf("assembly:    %8.3f ms/3d scan, %6.3f ms/2d scan, %6.1f Mpoints/s\n",
+               (double)assemblyTime / 1000000.0 / scanNum,
+               (double)assemblyTime / 1000000.0 / scan2dNum,
+               (double)pointNum * 1000.0 / assemblyTime);
+        printf("compression: %8.3f ms/3d scan serial, %8.3f ms/3d scan in blocks, "
+               "%5.1f %% of the input size\n",
+               (double)serialTime / 1000000.0 / scanNum,
+               (double)blockTime / 1000000.0 / scanNum,
+               100.0 * serialBytes / (pointNum * sizeof(scan_point)));
+    }
+
+    delete blockTool;
+    delete serialTool;
+    if (getIntArg("workerNum", argTab) > 0)
+    {
+        doneMbx.remove();
+        jobMbx.remove();
+    }
+    free(copy);
+    free(data);
+    return 0;
+}
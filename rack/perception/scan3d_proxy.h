@@ -112,7 +112,6 @@ class Scan3dData
     public:
         static void le_to_cpu(scan3d_data *data)
         {
-            int i;
             data->recordingTime  = __le32_to_cpu(data->recordingTime);
             data->duration       = __le32_to_cpu(data->duration);
             data->maxRange       = __le32_to_cpu(data->maxRange);
@@ -130,16 +129,12 @@ class Scan3dData
 
             if (data->compressed == 0)
             {
-                for (i=0; i<data->pointNum; i++)
-                {
-                    ScanPoint::le_to_cpu(&data->point[i]);
-                }
+                ScanPoint::le_to_cpu(data->point, data->pointNum);
             }
         }
 
         static void be_to_cpu(scan3d_data *data)
         {
-            int i;
             data->recordingTime  = __be32_to_cpu(data->recordingTime);
             data->duration       = __be32_to_cpu(data->duration);
             data->maxRange       = __be32_to_cpu(data->maxRange);
@@ -157,10 +152,7 @@ class Scan3dData
 
             if (data->compressed == 0)
             {
-                for (i=0; i<data->pointNum; i++)
-                {
-                    ScanPoint::be_to_cpu(&data->point[i]);
-                }
+                ScanPoint::be_to_cpu(data->point, data->pointNum);
             }
         }
 
@@ -171,6 +163,11 @@ class Scan3dData
 
             scan3d_data *p_data = (scan3d_data *)msgInfo->p_data;
 
+            if (msgInfo->isDataByteorderCpu()) // data in cpu byteorder
+            {
+                return p_data;
+            }
+
             if (msgInfo->isDataByteorderLe()) // data in little endian
             {
                 le_to_cpu(p_data);
@@ -232,32 +229,26 @@ class Scan3dRangeImgData
     public:
         static void le_to_cpu(scan3d_range_img_data *data)
         {
-            int i;
             data->recordingTime = __le32_to_cpu(data->recordingTime);
             data->scanMode      = __le32_to_cpu(data->scanMode);
             data->maxRange      = __le32_to_cpu(data->maxRange);
             data->scanNum       = __le16_to_cpu(data->scanNum);
-            data->scanPointNum  = __le32_to_cpu(data->scanPointNum);
+            data->scanPointNum  = __le16_to_cpu(data->scanPointNum);
 
-            for (i=0; i<data->scanPointNum; i++)
-            {
-                Scan3dRangeImgPoint::le_to_cpu(&data->point[i]);
-            }
+            // the range image holds scanNum rows of scanPointNum points
+            Scan3dRangeImgPoint::le_to_cpu(data->point, data->scanNum * data->scanPointNum);
         }
 
         static void be_to_cpu(scan3d_range_img_data *data)
         {
-            int i;
             data->recordingTime = __be32_to_cpu(data->recordingTime);
             data->scanMode      = __be32_to_cpu(data->scanMode);
             data->maxRange      = __be32_to_cpu(data->maxRange);
             data->scanNum       = __be16_to_cpu(data->scanNum);
-            data->scanPointNum  = __be32_to_cpu(data->scanPointNum);
+            data->scanPointNum  = __be16_to_cpu(data->scanPointNum);
 
-            for (i=0; i<data->scanPointNum; i++)
-            {
-                Scan3dRangeImgPoint::be_to_cpu(&data->point[i]);
-            }
+            // the range image holds scanNum rows of scanPointNum points
+            Scan3dRangeImgPoint::be_to_cpu(data->point, data->scanNum * data->scanPointNum);
         }
 
         static scan3d_range_img_data* parse(RackMessage *msgInfo)
@@ -267,6 +258,11 @@ class Scan3dRangeImgData
 
             scan3d_range_img_data *p_data = (scan3d_range_img_data *)msgInfo->p_data;
 
+            if (msgInfo->isDataByteorderCpu()) // data in cpu byteorder
+            {
+                return p_data;
+            }
+
             if (msgInfo->isDataByteorderLe()) // data in little endian
             {
                 le_to_cpu(p_data);
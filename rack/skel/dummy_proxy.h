@@ -81,6 +81,11 @@ class DummyData
 
             dummy_data *pData = (dummy_data *)msgInfo->p_data;
 
+            if (msgInfo->isDataByteorderCpu()) // data in cpu byteorder
+            {
+                return pData;
+            }
+
             int i;
 
             pData->recordingTime = msgInfo->data32ToCpu(pData->recordingTime);
@@ -125,6 +130,11 @@ class DummyParam
 
             dummy_param *pData = (dummy_param *)msgInfo->p_data;
 
+            if (msgInfo->isDataByteorderCpu()) // data in cpu byteorder
+            {
+                return pData;
+            }
+
             pData->valX = msgInfo->data32FloatToCpu(pData->valX);
             pData->valY = msgInfo->data32ToCpu(pData->valY);
 
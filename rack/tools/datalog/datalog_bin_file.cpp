@@ -0,0 +1,876 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Oliver Wulf        <wulf@rts.uni-hannover.de>
+ *      Matthias Hentschel <hentschel@rts.uni-hannover.de>
+ */
+#include "datalog_bin_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+//######################################################################
+//# class DatalogBinWriter
+//######################################################################
+
+// writer task (non realtime context)
+void datalog_bin_writer_task_proc(void *arg)
+{
+    DatalogBinWriter *p_writer = (DatalogBinWriter *)arg;
+    RackGdos         *gdos     = p_writer->gdos;
+    uint32_t         chunk;
+
+    RackTask::disableRealtimeMode();
+
+    while (1)
+    {
+        chunk = p_writer->chunkFlush;
+
+        if (p_writer->chunkState[chunk] == DATALOG_BIN_CHUNK_FULL)
+        {
+            if (p_writer->flushChunk(chunk))
+            {
+                p_writer->writerError = 1;
+            }
+
+            p_writer->chunkMtx.lock(RACK_INFINITE);
+            p_writer->chunkState[chunk] = DATALOG_BIN_CHUNK_FREE;
+            p_writer->chunkMtx.unlock();
+
+            p_writer->chunkFlush = (chunk + 1) % DATALOG_BIN_CHUNK_NUM;
+        }
+        else if (p_writer->writerTerminate)
+        {
+            break;
+        }
+        else
+        {
+            RackTask::sleep(DATALOG_BIN_WRITER_SLEEP);
+        }
+    }
+
+    GDOS_DBG_INFO("DatalogBinWriter: writer task terminated\n");
+}
+
+DatalogBinWriter::DatalogBinWriter(RackMailbox *p_mbx, int gdos_level)
+{
+    int i;
+
+    gdos = new RackGdos(p_mbx, gdos_level);
+
+    fd             = -1;
+    chunkSize      = 0;
+    chunkWrite     = 0;
+    chunkFlush     = 0;
+    chunkPos       = 0;
+    chunkOffset    = 0;
+    chunkActive    = 0;
+    index          = NULL;
+    indexNum       = 0;
+    indexMax       = 0;
+    indexTime      = 0;
+    writerStarted  = 0;
+    writerTerminate = 0;
+    writerError    = 0;
+    droppedRecords = 0;
+    bytesWritten   = 0;
+
+    for (i = 0; i < DATALOG_BIN_CHUNK_NUM; i++)
+    {
+        chunkBuffer[i] = NULL;
+        chunkState[i]  = DATALOG_BIN_CHUNK_FREE;
+    }
+}
+
+DatalogBinWriter::~DatalogBinWriter()
+{
+    close();
+    delete gdos;
+}
+
+int DatalogBinWriter::writeBuffer(void *buffer, uint32_t len)
+{
+    uint8_t *p_buffer = (uint8_t *)buffer;
+    ssize_t ret;
+
+    while (len > 0)
+    {
+        ret = ::write(fd, p_buffer, len);
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -errno;
+        }
+
+        p_buffer     += ret;
+        len          -= ret;
+        bytesWritten += ret;
+    }
+
+    return 0;
+}
+
+// writer task
+int DatalogBinWriter::flushChunk(uint32_t chunk)
+{
+    datalog_bin_chunk_head *chunkHead = (datalog_bin_chunk_head *)chunkBuffer[chunk];
+    int ret;
+
+    ret = writeBuffer(chunkBuffer[chunk], chunkHead->chunkLen);
+    if (ret)
+    {
+        GDOS_ERROR("DatalogBinWriter: Can't write chunk (%d bytes), code = %d\n",
+                   chunkHead->chunkLen, ret);
+    }
+
+    return ret;
+}
+
+// data task
+int DatalogBinWriter::newChunk(void)
+{
+    datalog_bin_chunk_head *chunkHead;
+
+    chunkMtx.lock(RACK_INFINITE);
+    if (chunkState[chunkWrite] != DATALOG_BIN_CHUNK_FREE)
+    {
+        chunkMtx.unlock();
+        return -EBUSY;
+    }
+    chunkMtx.unlock();
+
+    chunkHead = (datalog_bin_chunk_head *)chunkBuffer[chunkWrite];
+    memset(chunkHead, 0, sizeof(datalog_bin_chunk_head));
+    chunkHead->sync = DATALOG_BIN_CHUNK_SYNC;
+
+    chunkPos    = sizeof(datalog_bin_chunk_head);
+    chunkActive = 1;
+
+    return 0;
+}
+
+// data task
+void DatalogBinWriter::closeChunk(void)
+{
+    datalog_bin_chunk_head *chunkHead;
+
+    chunkHead = (datalog_bin_chunk_head *)chunkBuffer[chunkWrite];
+    chunkHead->chunkLen = chunkPos;
+
+    chunkMtx.lock(RACK_INFINITE);
+    chunkState[chunkWrite] = DATALOG_BIN_CHUNK_FULL;
+    chunkMtx.unlock();
+
+    chunkOffset += chunkPos;
+    chunkWrite   = (chunkWrite + 1) % DATALOG_BIN_CHUNK_NUM;
+    chunkPos     = 0;
+    chunkActive  = 0;
+}
+
+// data task
+int DatalogBinWriter::addIndexEntry(rack_time_t logTime, uint64_t offset)
+{
+    datalog_bin_index_entry *newIndex;
+
+    if (indexNum >= indexMax)
+    {
+        newIndex = (datalog_bin_index_entry *)realloc(index, 2 * indexMax *
+                                                     sizeof(datalog_bin_index_entry));
+        if (!newIndex)
+        {
+            return -ENOMEM;
+        }
+        index    = newIndex;
+        indexMax = 2 * indexMax;
+    }
+
+    index[indexNum].logTime  = logTime;
+    index[indexNum].reserved = 0;
+    index[indexNum].offset   = offset;
+    indexNum++;
+
+    indexTime = logTime;
+    return 0;
+}
+
+int DatalogBinWriter::open(const char *fileName, datalog_data *data,
+                           uint32_t chunkSize, rack_time_t startTime)
+{
+    datalog_bin_file_head *fileHead = NULL;
+    int i, ret;
+
+    if (fd >= 0)
+    {
+        GDOS_ERROR("DatalogBinWriter: File is already open\n");
+        return -EBUSY;
+    }
+
+    if ((data->logNum < 0) || (data->logNum > DATALOG_LOGNUM_MAX))
+    {
+        GDOS_ERROR("DatalogBinWriter: Invalid number of log infos %d\n", data->logNum);
+        return -EINVAL;
+    }
+
+    this->chunkSize = datalog_bin_align(chunkSize, DATALOG_BIN_BUFFER_ALIGN);
+
+    // allocate chunk buffers
+    for (i = 0; i < DATALOG_BIN_CHUNK_NUM; i++)
+    {
+        if (posix_memalign((void **)&chunkBuffer[i], DATALOG_BIN_BUFFER_ALIGN,
+                           this->chunkSize))
+        {
+            chunkBuffer[i] = NULL;
+            GDOS_ERROR("DatalogBinWriter: Can't allocate chunk buffer (%d bytes)\n",
+                       this->chunkSize);
+            ret = -ENOMEM;
+            goto open_error;
+        }
+        chunkState[i] = DATALOG_BIN_CHUNK_FREE;
+    }
+
+    // allocate time index
+    index = (datalog_bin_index_entry *)malloc(DATALOG_BIN_INDEX_NUM_MIN *
+                                              sizeof(datalog_bin_index_entry));
+    if (!index)
+    {
+        GDOS_ERROR("DatalogBinWriter: Can't allocate time index\n");
+        ret = -ENOMEM;
+        goto open_error;
+    }
+    indexMax = DATALOG_BIN_INDEX_NUM_MIN;
+    indexNum = 0;
+
+    ret = chunkMtx.create();
+    if (ret)
+    {
+        GDOS_ERROR("DatalogBinWriter: Can't create chunk mutex, code = %d\n", ret);
+        goto open_error;
+    }
+
+    fd = ::open(fileName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        ret = -errno;
+        GDOS_ERROR("DatalogBinWriter: Can't open file %s, code = %d\n", fileName, ret);
+        chunkMtx.destroy();
+        goto open_error;
+    }
+
+    // write file head, use the first chunk buffer as temporary memory
+    fileHead = (datalog_bin_file_head *)chunkBuffer[0];
+    memset(fileHead, 0, DATALOG_BIN_FILE_HEAD_SIZE);
+
+    strncpy(fileHead->magic, DATALOG_BIN_FILE_MAGIC, sizeof(fileHead->magic));
+    fileHead->version   = DATALOG_BIN_FILE_VERSION;
+    fileHead->headSize  = DATALOG_BIN_FILE_HEAD_SIZE;
+    fileHead->chunkSize = this->chunkSize;
+    fileHead->startTime = startTime;
+    memcpy(&fileHead->data, data, sizeof(datalog_data) +
+           data->logNum * sizeof(datalog_log_info));
+
+    bytesWritten = 0;
+    ret = writeBuffer(fileHead, DATALOG_BIN_FILE_HEAD_SIZE);
+    if (ret)
+    {
+        GDOS_ERROR("DatalogBinWriter: Can't write file head, code = %d\n", ret);
+        ::close(fd);
+        fd = -1;
+        chunkMtx.destroy();
+        goto open_error;
+    }
+
+    chunkOffset     = DATALOG_BIN_FILE_HEAD_SIZE;
+    chunkWrite      = 0;
+    chunkFlush      = 0;
+    chunkPos        = 0;
+    chunkActive     = 0;
+    droppedRecords  = 0;
+    writerError     = 0;
+    writerTerminate = 0;
+
+    // start writer task
+    snprintf(writerTaskName, sizeof(writerTaskName), "DatalogBinW%d", fd);
+
+    ret = writerTask.create(writerTaskName, 0, 1, RACK_TASK_FPU | RACK_TASK_JOINABLE);
+    if (ret == 0)
+    {
+        ret = writerTask.start(&datalog_bin_writer_task_proc, this);
+    }
+    if (ret)
+    {
+        GDOS_ERROR("DatalogBinWriter: Can't start writer task, code = %d\n", ret);
+        ::close(fd);
+        fd = -1;
+        chunkMtx.destroy();
+        goto open_error;
+    }
+    writerStarted = 1;
+
+    return 0;
+
+open_error:
+    for (i = 0; i < DATALOG_BIN_CHUNK_NUM; i++)
+    {
+        if (chunkBuffer[i])
+        {
+            free(chunkBuffer[i]);
+            chunkBuffer[i] = NULL;
+        }
+    }
+
+    if (index)
+    {
+        free(index);
+        index = NULL;
+    }
+
+    return ret;
+}
+
+int DatalogBinWriter::close(void)
+{
+    datalog_bin_file_tail tail;
+    int i, ret = 0;
+
+    if (fd < 0)
+    {
+        return 0;
+    }
+
+    // hand over the last chunk and wait until the writer task has finished
+    if (chunkActive)
+    {
+        closeChunk();
+    }
+
+    if (writerStarted)
+    {
+        writerTerminate = 1;
+        writerTask.join();
+        writerTask.destroy();
+        writerStarted = 0;
+    }
+
+    // append time index and file tail
+    if (indexNum > 0)
+    {
+        ret = writeBuffer(index, indexNum * sizeof(datalog_bin_index_entry));
+    }
+
+    if (ret == 0)
+    {
+        tail.sync        = DATALOG_BIN_TAIL_SYNC;
+        tail.indexNum    = indexNum;
+        tail.indexOffset = chunkOffset;
+
+        ret = writeBuffer(&tail, sizeof(tail));
+    }
+
+    if (ret)
+    {
+        GDOS_ERROR("DatalogBinWriter: Can't write time index, code = %d\n", ret);
+    }
+
+    if (droppedRecords)
+    {
+        GDOS_WARNING("DatalogBinWriter: %d records dropped\n", droppedRecords);
+    }
+
+    ::close(fd);
+    fd = -1;
+
+    chunkMtx.destroy();
+
+    for (i = 0; i < DATALOG_BIN_CHUNK_NUM; i++)
+    {
+        free(chunkBuffer[i]);
+        chunkBuffer[i] = NULL;
+    }
+
+    free(index);
+    index    = NULL;
+    indexNum = 0;
+    indexMax = 0;
+
+    return ret;
+}
+
+// data task
+int DatalogBinWriter::write(RackMessage *msgInfo, rack_time_t logTime)
+{
+    datalog_bin_chunk_head  *chunkHead;
+    datalog_bin_record_head *record;
+    uint32_t                recordLen, alignedLen;
+    int                     ret;
+
+    if (fd < 0)
+    {
+        return -EBADF;
+    }
+
+    if (writerError)
+    {
+        return -EIO;
+    }
+
+    recordLen  = sizeof(datalog_bin_record_head) + msgInfo->datalen;
+    alignedLen = datalog_bin_align(recordLen, DATALOG_BIN_RECORD_ALIGN);
+
+    if (alignedLen > chunkSize - sizeof(datalog_bin_chunk_head))
+    {
+        GDOS_ERROR("DatalogBinWriter: Message from %n is too large (%d bytes)\n",
+                   msgInfo->getSrc(), msgInfo->datalen);
+        droppedRecords++;
+        return -EMSGSIZE;
+    }
+
+    // current chunk is full -> hand it over to the writer task
+    if (chunkActive && (chunkPos + alignedLen > chunkSize))
+    {
+        closeChunk();
+    }
+
+    if (!chunkActive)
+    {
+        ret = newChunk();
+        if (ret)
+        {
+            // all buffers are waiting for the writer task, don't block the caller
+            droppedRecords++;
+            return ret;
+        }
+    }
+
+    chunkHead = (datalog_bin_chunk_head *)chunkBuffer[chunkWrite];
+    record    = (datalog_bin_record_head *)(chunkBuffer[chunkWrite] + chunkPos);
+
+    record->sync      = DATALOG_BIN_RECORD_SYNC;
+    record->recordLen = recordLen;
+    record->logTime   = logTime;
+
+    if (msgInfo->datalen >= sizeof(rack_time_t))
+    {
+        record->recordingTime = msgInfo->data32ToCpu(*(rack_time_t *)msgInfo->p_data);
+    }
+    else
+    {
+        record->recordingTime = logTime;
+    }
+
+    memcpy(&record->head, msgInfo->getHead(), sizeof(tims_msg_head));
+    record->head.msglen = TIMS_HEADLEN + msgInfo->datalen;
+
+    memcpy(record->data, msgInfo->p_data, msgInfo->datalen);
+    memset((uint8_t *)record + recordLen, 0, alignedLen - recordLen);
+
+    if (chunkHead->recordNum == 0)
+    {
+        chunkHead->startTime = logTime;
+    }
+    chunkHead->endTime = logTime;
+    chunkHead->recordNum++;
+
+    if ((indexNum == 0) ||
+        (logTime >= indexTime + DATALOG_BIN_INDEX_PERIOD))
+    {
+        addIndexEntry(logTime, chunkOffset + chunkPos);
+    }
+
+    chunkPos += alignedLen;
+
+    // write chunks of slow data regularly
+    if (logTime >= chunkHead->startTime + DATALOG_BIN_FLUSH_PERIOD)
+    {
+        closeChunk();
+    }
+
+    return 0;
+}
+
+//######################################################################
+//# class DatalogBinReader
+//######################################################################
+
+DatalogBinReader::DatalogBinReader(RackMailbox *p_mbx, int gdos_level)
+{
+    gdos = new RackGdos(p_mbx, gdos_level);
+
+    fd             = -1;
+    fileData       = NULL;
+    fileSize       = 0;
+    dataEnd        = 0;
+    index          = NULL;
+    indexNum       = 0;
+    indexAllocated = 0;
+}
+
+DatalogBinReader::~DatalogBinReader()
+{
+    close();
+    delete gdos;
+}
+
+int DatalogBinReader::checkChunk(uint64_t offset)
+{
+    datalog_bin_chunk_head *chunkHead;
+
+    if (offset + sizeof(datalog_bin_chunk_head) > dataEnd)
+    {
+        return -EINVAL;
+    }
+
+    chunkHead = (datalog_bin_chunk_head *)(fileData + offset);
+
+    if ((chunkHead->sync != DATALOG_BIN_CHUNK_SYNC) ||
+        (chunkHead->chunkLen < sizeof(datalog_bin_chunk_head)) ||
+        (offset + chunkHead->chunkLen > dataEnd))
+    {
+        return -EINVAL;
+    }
+
+    return 0;
+}
+
+int DatalogBinReader::rebuildIndex(void)
+{
+    datalog_bin_chunk_head  *chunkHead;
+    datalog_bin_index_entry *newIndex;
+    uint64_t                offset;
+    uint32_t                indexMax = DATALOG_BIN_INDEX_NUM_MIN;
+
+    index = (datalog_bin_index_entry *)malloc(indexMax * sizeof(datalog_bin_index_entry));
+    if (!index)
+    {
+        return -ENOMEM;
+    }
+    indexAllocated = 1;
+    indexNum       = 0;
+
+    // one index entry per chunk, stop at the first incomplete chunk
+    offset = getFileHead()->headSize;
+
+    while (checkChunk(offset) == 0)
+    {
+        chunkHead = (datalog_bin_chunk_head *)(fileData + offset);
+
+        if (chunkHead->recordNum > 0)
+        {
+            if (indexNum >= indexMax)
+            {
+                newIndex = (datalog_bin_index_entry *)realloc(index, 2 * indexMax *
+                                                             sizeof(datalog_bin_index_entry));
+                if (!newIndex)
+                {
+                    return -ENOMEM;
+                }
+                index    = newIndex;
+                indexMax = 2 * indexMax;
+            }
+
+            index[indexNum].logTime  = chunkHead->startTime;
+            index[indexNum].reserved = 0;
+            index[indexNum].offset   = offset + sizeof(datalog_bin_chunk_head);
+            indexNum++;
+        }
+
+        offset += chunkHead->chunkLen;
+    }
+
+    if (offset < dataEnd)
+    {
+        GDOS_WARNING("DatalogBinReader: Log file is truncated, %d bytes ignored\n",
+                     (int)(dataEnd - offset));
+        dataEnd = offset;
+    }
+
+    return 0;
+}
+
+int DatalogBinReader::open(const char *fileName)
+{
+    datalog_bin_file_head *fileHead;
+    datalog_bin_file_tail *tail;
+    struct stat           fileStat;
+    int                   ret;
+
+    if (fd >= 0)
+    {
+        GDOS_ERROR("DatalogBinReader: File is already open\n");
+        return -EBUSY;
+    }
+
+    fd = ::open(fileName, O_RDONLY);
+    if (fd < 0)
+    {
+        ret = -errno;
+        GDOS_ERROR("DatalogBinReader: Can't open file %s, code = %d\n", fileName, ret);
+        return ret;
+    }
+
+    if (fstat(fd, &fileStat) < 0)
+    {
+        ret = -errno;
+        goto open_error;
+    }
+    fileSize = fileStat.st_size;
+
+    if (fileSize < DATALOG_BIN_FILE_HEAD_SIZE)
+    {
+        GDOS_ERROR("DatalogBinReader: File %s is too small\n", fileName);
+        ret = -EINVAL;
+        goto open_error;
+    }
+
+    // copy on write mapping, the message data may be parsed in place
+    fileData = (uint8_t *)mmap(NULL, fileSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (fileData == MAP_FAILED)
+    {
+        ret = -errno;
+        fileData = NULL;
+        GDOS_ERROR("DatalogBinReader: Can't map file %s, code = %d\n", fileName, ret);
+        goto open_error;
+    }
+
+    fileHead = getFileHead();
+    if ((strncmp(fileHead->magic, DATALOG_BIN_FILE_MAGIC, sizeof(fileHead->magic)) != 0) ||
+        (fileHead->version != DATALOG_BIN_FILE_VERSION) ||
+        (fileHead->headSize < sizeof(datalog_bin_file_head)) ||
+        (fileHead->headSize > fileSize))
+    {
+        GDOS_ERROR("DatalogBinReader: %s is no valid binary log file (or recorded "
+                   "with a different byteorder)\n", fileName);
+        ret = -EINVAL;
+        goto open_error;
+    }
+
+    // use the time index of the file tail if the file was closed correctly
+    tail = (datalog_bin_file_tail *)(fileData + fileSize - sizeof(datalog_bin_file_tail));
+
+    if ((fileSize >= fileHead->headSize + sizeof(datalog_bin_file_tail)) &&
+        (tail->sync == DATALOG_BIN_TAIL_SYNC) &&
+        (tail->indexOffset >= fileHead->headSize) &&
+        (tail->indexOffset + tail->indexNum * sizeof(datalog_bin_index_entry) +
+         sizeof(datalog_bin_file_tail) == fileSize))
+    {
+        index    = (datalog_bin_index_entry *)(fileData + tail->indexOffset);
+        indexNum = tail->indexNum;
+        dataEnd  = tail->indexOffset;
+    }
+    else
+    {
+        GDOS_WARNING("DatalogBinReader: No time index in %s, rebuilding index\n",
+                     fileName);
+        dataEnd = fileSize;
+
+        ret = rebuildIndex();
+        if (ret)
+        {
+            GDOS_ERROR("DatalogBinReader: Can't rebuild time index, code = %d\n", ret);
+            goto open_error;
+        }
+    }
+
+    return 0;
+
+open_error:
+    close();
+    return ret;
+}
+
+void DatalogBinReader::close(void)
+{
+    if (indexAllocated)
+    {
+        free(index);
+        indexAllocated = 0;
+    }
+    index    = NULL;
+    indexNum = 0;
+
+    if (fileData)
+    {
+        munmap(fileData, fileSize);
+        fileData = NULL;
+    }
+
+    if (fd >= 0)
+    {
+        ::close(fd);
+        fd = -1;
+    }
+
+    fileSize = 0;
+    dataEnd  = 0;
+}
+
+uint64_t DatalogBinReader::first(void)
+{
+    datalog_bin_chunk_head *chunkHead;
+    uint64_t               offset;
+
+    if (!fileData)
+    {
+        return 0;
+    }
+
+    offset = getFileHead()->headSize;
+
+    // skip empty chunks
+    while (checkChunk(offset) == 0)
+    {
+        chunkHead = (datalog_bin_chunk_head *)(fileData + offset);
+        if (chunkHead->recordNum > 0)
+        {
+            return offset + sizeof(datalog_bin_chunk_head);
+        }
+        offset += chunkHead->chunkLen;
+    }
+
+    return 0;
+}
+
+uint64_t DatalogBinReader::next(uint64_t offset)
+{
+    datalog_bin_record_head *record;
+    datalog_bin_chunk_head  *chunkHead;
+    uint32_t                sync;
+
+    if (!fileData || !offset)
+    {
+        return 0;
+    }
+
+    record = getRecord(offset);
+    offset += datalog_bin_align(record->recordLen, DATALOG_BIN_RECORD_ALIGN);
+
+    while (offset + sizeof(uint32_t) <= dataEnd)
+    {
+        sync = *(uint32_t *)(fileData + offset);
+
+        if (sync == DATALOG_BIN_RECORD_SYNC)
+        {
+            record = getRecord(offset);
+            if (offset + record->recordLen > dataEnd)
+            {
+                break;
+            }
+            return offset;
+        }
+        else if ((sync == DATALOG_BIN_CHUNK_SYNC) && (checkChunk(offset) == 0))
+        {
+            chunkHead = (datalog_bin_chunk_head *)(fileData + offset);
+            if (chunkHead->recordNum > 0)
+            {
+                offset += sizeof(datalog_bin_chunk_head);
+            }
+            else
+            {
+                offset += chunkHead->chunkLen;
+            }
+        }
+        else
+        {
+            GDOS_WARNING("DatalogBinReader: Invalid record at offset %d\n", (int)offset);
+            break;
+        }
+    }
+
+    return 0;
+}
+
+uint64_t DatalogBinReader::seek(rack_time_t time)
+{
+    datalog_bin_record_head *record;
+    uint64_t                offset;
+    int                     low, high, mid;
+
+    if (!fileData)
+    {
+        return 0;
+    }
+
+    // find the last index entry logged before the requested time, the
+    // recording time of a message is never newer than its log time
+    low  = 0;
+    high = (int)indexNum - 1;
+
+    while (low <= high)
+    {
+        mid = (low + high) / 2;
+        if (index[mid].logTime < time)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid - 1;
+        }
+    }
+
+    if (high >= 0)
+    {
+        offset = index[high].offset;
+    }
+    else
+    {
+        offset = first();
+    }
+
+    while (offset)
+    {
+        record = getRecord(offset);
+        if (record->recordingTime >= time)
+        {
+            break;
+        }
+        offset = next(offset);
+    }
+
+    return offset;
+}
+
+void DatalogBinReader::getMessage(uint64_t offset, RackMessage *msgInfo)
+{
+    datalog_bin_record_head *record = getRecord(offset);
+
+    memcpy(msgInfo->getHead(), &record->head, sizeof(tims_msg_head));
+    msgInfo->datalen = record->recordLen - sizeof(datalog_bin_record_head);
+    msgInfo->p_data  = record->data;
+}
+
+int DatalogBinReader::getData(uint64_t *offset, uint32_t classId, int instance,
+                              uint32_t minLen, uint32_t maxLen, void *data,
+                              RackMessage *msgInfo)
+{
+    while (*offset)
+    {
+        getMessage(*offset, msgInfo);
+        *offset = next(*offset);
+
+        if ((RackName::classId(msgInfo->getSrc()) != classId) ||
+            ((instance >= 0) && ((int)RackName::instanceId(msgInfo->getSrc()) != instance)) ||
+            (msgInfo->datalen < minLen) || (msgInfo->datalen > maxLen))
+        {
+            continue;
+        }
+
+        memcpy(data, msgInfo->p_data, msgInfo->datalen);
+        msgInfo->p_data = data;
+        return 0;
+    }
+
+    return -ENOENT;
+}
@@ -0,0 +1,272 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Oliver Wulf        <wulf@rts.uni-hannover.de>
+ *      Matthias Hentschel <hentschel@rts.uni-hannover.de>
+ */
+
+#ifndef __DATALOG_BIN_FILE_H__
+#define __DATALOG_BIN_FILE_H__
+
+#include <main/rack_gdos.h>
+#include <main/rack_mailbox.h>
+#include <main/rack_mutex.h>
+#include <main/rack_task.h>
+#include <main/rack_time.h>
+#include <tools/datalog_proxy.h>
+
+//
+// binary log file layout
+//
+// +------------------+ offset 0
+// | file head        | datalog_bin_file_head (incl. log infos of all modules)
+// +------------------+ offset DATALOG_BIN_FILE_HEAD_SIZE
+// | chunk head       | datalog_bin_chunk_head
+// | record head      | datalog_bin_record_head
+// | message data     | raw TiMS message body (not parsed)
+// | ...              | records are aligned to DATALOG_BIN_RECORD_ALIGN
+// +------------------+
+// | chunk head       |
+// | ...              |
+// +------------------+
+// | time index       | datalog_bin_index_entry[indexNum]
+// | file tail        | datalog_bin_file_tail (last bytes of the file)
+// +------------------+
+//
+// All heads are written in the byteorder of the recording cpu. The message
+// data keeps the byteorder of the sender, which is stored in the flags of the
+// TiMS head. The time index is built on the log time, which increases
+// monotonically through the file (unlike the recording times of different
+// modules). A missing file tail (e.g. after a crash) is detected by the
+// reader, the time index is rebuilt from the chunk heads in this case.
+//
+
+#define DATALOG_BIN_FILE_MAGIC          "RACKLOG"
+#define DATALOG_BIN_FILE_VERSION        1
+#define DATALOG_BIN_FILE_HEAD_SIZE      8192
+
+#define DATALOG_BIN_CHUNK_SYNC          0x4b4e4843      // "CHNK"
+#define DATALOG_BIN_RECORD_SYNC         0x44434552      // "RECD"
+#define DATALOG_BIN_TAIL_SYNC           0x4c494154      // "TAIL"
+
+#define DATALOG_BIN_BUFFER_ALIGN        4096
+#define DATALOG_BIN_RECORD_ALIGN        8
+
+#define DATALOG_BIN_CHUNK_NUM           4               // number of write buffers
+#define DATALOG_BIN_INDEX_PERIOD        500             // [ms] period of time index entries
+#define DATALOG_BIN_FLUSH_PERIOD        1000            // [ms] max age of a chunk before it is written
+#define DATALOG_BIN_WRITER_SLEEP        5000000llu      // [ns] writer task poll time
+#define DATALOG_BIN_INDEX_NUM_MIN       1024            // initial size of the time index
+
+#define DATALOG_BIN_CHUNK_FREE          0
+#define DATALOG_BIN_CHUNK_FULL          1
+
+/**
+ * binary log file head
+ */
+typedef struct {
+    char             magic[8];              /**< DATALOG_BIN_FILE_MAGIC */
+    uint32_t         version;               /**< DATALOG_BIN_FILE_VERSION */
+    uint32_t         headSize;              /**< size of the file head incl. padding */
+    uint32_t         chunkSize;             /**< maximum size of a chunk */
+    rack_time_t      startTime;             /**< [ms] time the log was started */
+    datalog_data     data;                  /**< log infos of the recorded modules */
+    datalog_log_info logInfo[DATALOG_LOGNUM_MAX];
+} __attribute__((packed)) datalog_bin_file_head;
+
+/**
+ * binary log chunk head
+ */
+typedef struct {
+    uint32_t         sync;                  /**< DATALOG_BIN_CHUNK_SYNC */
+    uint32_t         chunkLen;              /**< [byte] chunk length incl. this head */
+    uint32_t         recordNum;             /**< number of records in this chunk */
+    rack_time_t      startTime;             /**< [ms] log time of the first record */
+    rack_time_t      endTime;               /**< [ms] log time of the last record */
+    uint32_t         reserved[3];
+} __attribute__((packed)) datalog_bin_chunk_head;
+
+/**
+ * binary log record head
+ */
+typedef struct {
+    uint32_t         sync;                  /**< DATALOG_BIN_RECORD_SYNC */
+    uint32_t         recordLen;             /**< [byte] record length incl. this head */
+    rack_time_t      recordingTime;         /**< [ms] recording time of the message */
+    rack_time_t      logTime;               /**< [ms] time the message was logged */
+    tims_msg_head    head;                  /**< original TiMS head of the message */
+    uint8_t          data[0];               /**< raw message body */
+} __attribute__((packed)) datalog_bin_record_head;
+
+/**
+ * binary log time index entry
+ */
+typedef struct {
+    rack_time_t      logTime;               /**< [ms] log time of the record */
+    uint32_t         reserved;
+    uint64_t         offset;                /**< file offset of the record head */
+} __attribute__((packed)) datalog_bin_index_entry;
+
+/**
+ * binary log file tail
+ */
+typedef struct {
+    uint32_t         sync;                  /**< DATALOG_BIN_TAIL_SYNC */
+    uint32_t         indexNum;              /**< number of time index entries */
+    uint64_t         indexOffset;           /**< file offset of the time index */
+} __attribute__((packed)) datalog_bin_file_tail;
+
+static inline uint32_t datalog_bin_align(uint32_t len, uint32_t align)
+{
+    return (len + align - 1) & ~(align - 1);
+}
+
+/**
+ * Writes messages into a binary log file. Messages are copied into large
+ * aligned chunk buffers in the calling (data) task. Full chunks are written
+ * to disk by a dedicated writer task, so the caller never blocks on file I/O.
+ * If all chunk buffers are in use the message is dropped and counted.
+ *
+ * @ingroup tools_datalog
+ */
+class DatalogBinWriter
+{
+    private:
+        RackGdos                *gdos;
+
+        int                     fd;
+        uint32_t                chunkSize;
+        uint8_t                 *chunkBuffer[DATALOG_BIN_CHUNK_NUM];
+        volatile uint32_t       chunkState[DATALOG_BIN_CHUNK_NUM];
+        uint32_t                chunkWrite;     // chunk filled by the caller
+        uint32_t                chunkFlush;     // next chunk written by the writer task
+        uint32_t                chunkPos;       // write position in the current chunk
+        uint64_t                chunkOffset;    // file offset of the current chunk
+        int                     chunkActive;    // current chunk buffer is owned by the caller
+
+        datalog_bin_index_entry *index;
+        uint32_t                indexNum;
+        uint32_t                indexMax;
+        rack_time_t             indexTime;
+
+        RackTask                writerTask;
+        RackMutex               chunkMtx;
+        char                    writerTaskName[30];
+        volatile int            writerTerminate;
+        volatile int            writerError;
+        int                     writerStarted;
+
+        uint32_t                droppedRecords;
+        uint64_t                bytesWritten;
+
+        int   writeBuffer(void *buffer, uint32_t len);
+        int   flushChunk(uint32_t chunk);
+        int   newChunk(void);
+        void  closeChunk(void);
+        int   addIndexEntry(rack_time_t logTime, uint64_t offset);
+
+        friend void datalog_bin_writer_task_proc(void *arg);
+
+    public:
+        DatalogBinWriter(RackMailbox *p_mbx, int gdos_level);
+        ~DatalogBinWriter();
+
+        int   open(const char *fileName, datalog_data *data, uint32_t chunkSize,
+                   rack_time_t startTime);
+        int   close(void);
+
+        int   write(RackMessage *msgInfo, rack_time_t logTime);
+
+        uint32_t getDroppedRecords(void)
+        {
+            return droppedRecords;
+        }
+
+        uint64_t getBytesWritten(void)
+        {
+            return bytesWritten;
+        }
+};
+
+/**
+ * Reads a binary log file. The file is memory mapped (copy on write), so the
+ * message data of a record can be parsed in place.
+ *
+ * @ingroup tools_datalog
+ */
+class DatalogBinReader
+{
+    private:
+        RackGdos                *gdos;
+
+        int                     fd;
+        uint8_t                 *fileData;
+        uint64_t                fileSize;
+        uint64_t                dataEnd;        // end of the chunk area
+
+        datalog_bin_index_entry *index;
+        uint32_t                indexNum;
+        int                     indexAllocated;
+
+        int   checkChunk(uint64_t offset);
+        int   rebuildIndex(void);
+
+    public:
+        DatalogBinReader(RackMailbox *p_mbx, int gdos_level);
+        ~DatalogBinReader();
+
+        int   open(const char *fileName);
+        void  close(void);
+
+        datalog_bin_file_head*   getFileHead(void)
+        {
+            return (datalog_bin_file_head *)fileData;
+        }
+
+        datalog_bin_index_entry* getIndex(void)
+        {
+            return index;
+        }
+
+        uint32_t getIndexNum(void)
+        {
+            return indexNum;
+        }
+
+        /** Returns the offset of the first record or 0 if there is none */
+        uint64_t first(void);
+
+        /** Returns the offset of the record following @a offset or 0 */
+        uint64_t next(uint64_t offset);
+
+        /** Returns the offset of the first record not older than @a time or 0 */
+        uint64_t seek(rack_time_t time);
+
+        datalog_bin_record_head* getRecord(uint64_t offset)
+        {
+            return (datalog_bin_record_head *)(fileData + offset);
+        }
+
+        /** Fills a RackMessage with head and data pointer of a record */
+        void  getMessage(uint64_t offset, RackMessage *msgInfo);
+
+        /** Copies the data of the next record from @a offset on, which is of
+         *  class @a classId, of @a instance (all if < 0) and of a length
+         *  between @a minLen and @a maxLen into @a data. @a msgInfo points to
+         *  the copy and @a offset to the following record.
+         *  Returns -ENOENT at the end of the log */
+        int   getData(uint64_t *offset, uint32_t classId, int instance,
+                      uint32_t minLen, uint32_t maxLen, void *data,
+                      RackMessage *msgInfo);
+};
+
+#endif // __DATALOG_BIN_FILE_H__
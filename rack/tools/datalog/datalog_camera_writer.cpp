@@ -0,0 +1,611 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Oliver Wulf        <wulf@rts.uni-hannover.de>
+ *      Matthias Hentschel <hentschel@rts.uni-hannover.de>
+ */
+#include "datalog_camera_writer.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+//######################################################################
+//# compression (lossless)
+//######################################################################
+
+//
+// The difference to the same byte of the left pixel is coded. Runs of
+// 2..129 zero differences are coded as one control byte 0x80..0xff, up to
+// 128 literal differences follow a control byte 0x00..0x7f.
+//
+
+uint32_t DatalogCameraWriter::compress(uint8_t *in, uint32_t inLen, uint8_t *out,
+                                       uint32_t outLen, uint32_t bytesPerPixel)
+{
+    uint32_t i = 0, run, pos = 0, ctrl = 0;
+    int      literal = 0;
+    uint8_t  delta;
+
+    while (i < inLen)
+    {
+        // zero run
+        run = 0;
+        while ((i + run < inLen) && (run < 129) && (i + run >= bytesPerPixel) &&
+               (in[i + run] == in[i + run - bytesPerPixel]))
+        {
+            run++;
+        }
+
+        if (run >= 2)
+        {
+            if (pos + 1 > outLen)
+            {
+                return 0;
+            }
+            out[pos++] = 0x80 + (run - 2);
+            i         += run;
+            literal    = 0;
+            continue;
+        }
+
+        // literal
+        if (!literal || (out[ctrl] == 0x7f))
+        {
+            if (pos + 1 > outLen)
+            {
+                return 0;
+            }
+            ctrl       = pos;
+            out[pos++] = 0xff;          // incremented to 0x00 below
+            literal    = 1;
+        }
+
+        if (pos + 1 > outLen)
+        {
+            return 0;
+        }
+
+        if (i >= bytesPerPixel)
+        {
+            delta = in[i] - in[i - bytesPerPixel];
+        }
+        else
+        {
+            delta = in[i];
+        }
+
+        out[pos++] = delta;
+        out[ctrl]++;
+        i++;
+    }
+
+    return pos;
+}
+
+uint32_t DatalogCameraWriter::decompress(uint8_t *in, uint32_t inLen, uint8_t *out,
+                                         uint32_t outLen, uint32_t bytesPerPixel)
+{
+    uint32_t i = 0, pos = 0, n;
+    uint8_t  ctrl;
+
+    while (i < inLen)
+    {
+        ctrl = in[i++];
+
+        if (ctrl & 0x80)
+        {
+            n = (ctrl & 0x7f) + 2;
+            if ((pos + n > outLen) || (pos < bytesPerPixel))
+            {
+                return 0;
+            }
+            while (n--)
+            {
+                out[pos] = out[pos - bytesPerPixel];
+                pos++;
+            }
+        }
+        else
+        {
+            n = ctrl + 1;
+            if ((pos + n > outLen) || (i + n > inLen))
+            {
+                return 0;
+            }
+            while (n--)
+            {
+                if (pos >= bytesPerPixel)
+                {
+                    out[pos] = in[i++] + out[pos - bytesPerPixel];
+                }
+                else
+                {
+                    out[pos] = in[i++];
+                }
+                pos++;
+            }
+        }
+    }
+
+    return pos;
+}
+
+//######################################################################
+//# tasks (non realtime context)
+//######################################################################
+
+void datalog_camera_worker_task_proc(void *arg)
+{
+    DatalogCameraWriter *p_writer = (DatalogCameraWriter *)arg;
+    datalog_camera_slot *p_slot;
+    uint32_t            i, bytesPerPixel;
+
+    RackTask::disableRealtimeMode();
+
+    while (!p_writer->terminate)
+    {
+        // get the oldest queued frame
+        p_slot = NULL;
+
+        p_writer->slotMtx.lock(RACK_INFINITE);
+        for (i = 0; i < p_writer->slotNum; i++)
+        {
+            datalog_camera_slot *p = &p_writer->slot[(p_writer->slotFlush + i) %
+                                                     p_writer->slotNum];
+            if (p->state == DATALOG_CAMERA_SLOT_QUEUED)
+            {
+                p->state = DATALOG_CAMERA_SLOT_BUSY;
+                p_slot   = p;
+                break;
+            }
+        }
+        p_writer->slotMtx.unlock();
+
+        if (!p_slot)
+        {
+            RackTask::sleep(DATALOG_CAMERA_SLEEP);
+            continue;
+        }
+
+        // jpeg images are not compressed again
+        bytesPerPixel = p_slot->head.depth / 8;
+        if (bytesPerPixel == 0)
+        {
+            bytesPerPixel = 1;
+        }
+
+        p_slot->compression = DATALOG_CAMERA_COMPRESS_NONE;
+
+        if (p_slot->head.mode != CAMERA_MODE_JPEG)
+        {
+            p_slot->comprLen = DatalogCameraWriter::compress(p_slot->data, p_slot->dataLen,
+                                                             p_slot->compr, p_slot->dataLen,
+                                                             bytesPerPixel);
+            if (p_slot->comprLen > 0)
+            {
+                p_slot->compression = p_writer->compression;
+            }
+        }
+
+        p_writer->slotMtx.lock(RACK_INFINITE);
+        p_slot->state = DATALOG_CAMERA_SLOT_DONE;
+        p_writer->slotMtx.unlock();
+    }
+}
+
+void datalog_camera_writer_task_proc(void *arg)
+{
+    DatalogCameraWriter *p_writer = (DatalogCameraWriter *)arg;
+    datalog_camera_slot *p_slot;
+
+    RackTask::disableRealtimeMode();
+
+    while (1)
+    {
+        p_slot = &p_writer->slot[p_writer->slotFlush];
+
+        if (p_slot->state == DATALOG_CAMERA_SLOT_DONE)
+        {
+            if (!p_writer->writerError)
+            {
+                if (p_writer->writeFrame(p_slot))
+                {
+                    p_writer->writerError = 1;
+                }
+            }
+
+            p_writer->slotMtx.lock(RACK_INFINITE);
+            p_slot->state = DATALOG_CAMERA_SLOT_FREE;
+            p_writer->slotMtx.unlock();
+
+            p_writer->slotFlush = (p_writer->slotFlush + 1) % p_writer->slotNum;
+        }
+        else if (p_writer->terminate && (p_slot->state == DATALOG_CAMERA_SLOT_FREE))
+        {
+            break;
+        }
+        else
+        {
+            RackTask::sleep(DATALOG_CAMERA_SLEEP);
+        }
+    }
+}
+
+//######################################################################
+//# class DatalogCameraWriter
+//######################################################################
+
+DatalogCameraWriter::DatalogCameraWriter(RackMailbox *p_mbx, int gdos_level)
+{
+    int i;
+
+    gdos = new RackGdos(p_mbx, gdos_level);
+
+    logFile        = NULL;
+    fd             = -1;
+    segment        = 0;
+    segmentSize    = 0;
+    segmentOffset  = 0;
+    slotNum        = 0;
+    slotWrite      = 0;
+    slotFlush      = 0;
+    slotSize       = 0;
+    compression    = DATALOG_CAMERA_COMPRESS_NONE;
+    workerNum      = 0;
+    terminate      = 0;
+    writerError    = 0;
+    tasksStarted   = 0;
+    droppedFrames  = 0;
+
+    for (i = 0; i < DATALOG_CAMERA_SLOT_NUM_MAX; i++)
+    {
+        slot[i].state = DATALOG_CAMERA_SLOT_FREE;
+        slot[i].data  = NULL;
+        slot[i].compr = NULL;
+    }
+}
+
+DatalogCameraWriter::~DatalogCameraWriter()
+{
+    close();
+    delete gdos;
+}
+
+// writer task
+int DatalogCameraWriter::openSegment(void)
+{
+    char segmentName[120];
+    int  ret;
+
+    snprintf(segmentName, sizeof(segmentName), "%s_%i.frm", fileName, segment);
+
+    fd = ::open(segmentName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        ret = -errno;
+        GDOS_ERROR("DatalogCameraWriter: Can't open %s, code = %d\n", segmentName, ret);
+        return ret;
+    }
+
+    // reserve the disk space of the complete segment
+    ret = posix_fallocate(fd, 0, segmentSize);
+    if (ret)
+    {
+        GDOS_WARNING("DatalogCameraWriter: Can't preallocate %s, code = %d\n",
+                     segmentName, -ret);
+    }
+
+    segmentOffset = 0;
+    return 0;
+}
+
+// writer task
+void DatalogCameraWriter::closeSegment(void)
+{
+    if (fd >= 0)
+    {
+        if (ftruncate(fd, segmentOffset) < 0)
+        {
+            GDOS_WARNING("DatalogCameraWriter: Can't truncate segment %d\n", segment);
+        }
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+// writer task
+int DatalogCameraWriter::writeFrame(datalog_camera_slot *p_slot)
+{
+    uint8_t  *p_data;
+    uint32_t len;
+    ssize_t  ret;
+    int      err;
+
+    if (p_slot->compression != DATALOG_CAMERA_COMPRESS_NONE)
+    {
+        p_data = p_slot->compr;
+        len    = p_slot->comprLen;
+    }
+    else
+    {
+        p_data = p_slot->data;
+        len    = p_slot->dataLen;
+    }
+
+    // start a new segment
+    if ((segmentOffset > 0) && (segmentOffset + len > segmentSize))
+    {
+        closeSegment();
+        segment++;
+
+        err = openSegment();
+        if (err)
+        {
+            return err;
+        }
+    }
+
+    ret = pwrite(fd, p_data, len, segmentOffset);
+    if (ret != (ssize_t)len)
+    {
+        GDOS_ERROR("DatalogCameraWriter: Can't write frame %d, code = %d\n",
+                   p_slot->frameNum, -errno);
+        return -EIO;
+    }
+
+    fprintf(logFile, "%u %i %i %i %i %i %i %i %llu %u %i\n",
+            (unsigned int)p_slot->head.recordingTime,
+            p_slot->head.width,
+            p_slot->head.height,
+            p_slot->head.depth,
+            p_slot->head.mode,
+            p_slot->head.colorFilterId,
+            p_slot->frameNum,
+            segment,
+            (unsigned long long)segmentOffset,
+            len,
+            p_slot->compression);
+
+    segmentOffset += len;
+    return 0;
+}
+
+int DatalogCameraWriter::open(const char *fileName, FILE *logFile, uint32_t segmentSizeMb,
+                              uint32_t slotNum, int compression, int workerNum)
+{
+    char     taskName[30];
+    uint32_t i;
+    int      ret;
+
+    if (slotNum < 2)
+    {
+        slotNum = 2;
+    }
+    if (slotNum > DATALOG_CAMERA_SLOT_NUM_MAX)
+    {
+        slotNum = DATALOG_CAMERA_SLOT_NUM_MAX;
+    }
+    if (workerNum > DATALOG_CAMERA_WORKER_NUM_MAX)
+    {
+        workerNum = DATALOG_CAMERA_WORKER_NUM_MAX;
+    }
+    if (compression == DATALOG_CAMERA_COMPRESS_NONE)
+    {
+        workerNum = 0;
+    }
+    else if (workerNum < 1)
+    {
+        workerNum = 1;
+    }
+
+    snprintf(this->fileName, sizeof(this->fileName), "%s", fileName);
+    this->logFile     = logFile;
+    this->slotNum     = slotNum;
+    this->compression = compression;
+    this->workerNum   = workerNum;
+    segmentSize       = (uint64_t)segmentSizeMb * 1024 * 1024;
+    slotSize          = CAMERA_MAX_BYTES;
+    segment           = 0;
+    slotWrite         = 0;
+    slotFlush         = 0;
+    terminate         = 0;
+    writerError       = 0;
+    droppedFrames     = 0;
+
+    // allocate frame slots
+    for (i = 0; i < slotNum; i++)
+    {
+        slot[i].state = DATALOG_CAMERA_SLOT_FREE;
+        slot[i].data  = (uint8_t *)malloc(slotSize);
+        if (!slot[i].data)
+        {
+            ret = -ENOMEM;
+            goto open_error;
+        }
+
+        if (compression != DATALOG_CAMERA_COMPRESS_NONE)
+        {
+            slot[i].compr = (uint8_t *)malloc(slotSize);
+            if (!slot[i].compr)
+            {
+                ret = -ENOMEM;
+                goto open_error;
+            }
+        }
+    }
+
+    ret = slotMtx.create();
+    if (ret)
+    {
+        goto open_error;
+    }
+
+    ret = openSegment();
+    if (ret)
+    {
+        slotMtx.destroy();
+        goto open_error;
+    }
+
+    // start writer and compression tasks
+    snprintf(taskName, sizeof(taskName), "DlCamW%d", fd);
+    ret = writerTask.create(taskName, 0, 1, RACK_TASK_FPU | RACK_TASK_JOINABLE);
+    if (ret == 0)
+    {
+        ret = writerTask.start(&datalog_camera_writer_task_proc, this);
+    }
+    if (ret)
+    {
+        GDOS_ERROR("DatalogCameraWriter: Can't start writer task, code = %d\n", ret);
+        closeSegment();
+        slotMtx.destroy();
+        goto open_error;
+    }
+    tasksStarted = 1;
+
+    for (i = 0; i < (uint32_t)workerNum; i++)
+    {
+        snprintf(taskName, sizeof(taskName), "DlCamC%d_%d", fd, i);
+        ret = workerTask[i].create(taskName, 0, 1, RACK_TASK_FPU | RACK_TASK_JOINABLE);
+        if (ret == 0)
+        {
+            ret = workerTask[i].start(&datalog_camera_worker_task_proc, this);
+        }
+        if (ret)
+        {
+            GDOS_ERROR("DatalogCameraWriter: Can't start compression task, code = %d\n", ret);
+            this->workerNum = i;
+            close();
+            return ret;
+        }
+    }
+
+    return 0;
+
+open_error:
+    for (i = 0; i < slotNum; i++)
+    {
+        free(slot[i].data);
+        free(slot[i].compr);
+        slot[i].data  = NULL;
+        slot[i].compr = NULL;
+    }
+    this->slotNum = 0;
+
+    GDOS_ERROR("DatalogCameraWriter: Can't open %s, code = %d\n", fileName, ret);
+    return ret;
+}
+
+int DatalogCameraWriter::close(void)
+{
+    int      i;
+    uint32_t j;
+
+    if (!tasksStarted)
+    {
+        return 0;
+    }
+
+    // the writer task finishes all queued frames
+    terminate = 1;
+
+    for (i = 0; i < workerNum; i++)
+    {
+        workerTask[i].join();
+        workerTask[i].destroy();
+    }
+
+    // frames queued for compression are stored uncompressed
+    for (j = 0; j < slotNum; j++)
+    {
+        if (slot[j].state == DATALOG_CAMERA_SLOT_QUEUED)
+        {
+            slot[j].compression = DATALOG_CAMERA_COMPRESS_NONE;
+            slot[j].state       = DATALOG_CAMERA_SLOT_DONE;
+        }
+    }
+
+    writerTask.join();
+    writerTask.destroy();
+    tasksStarted = 0;
+
+    closeSegment();
+    slotMtx.destroy();
+
+    for (j = 0; j < slotNum; j++)
+    {
+        free(slot[j].data);
+        free(slot[j].compr);
+        slot[j].data  = NULL;
+        slot[j].compr = NULL;
+    }
+    slotNum = 0;
+
+    if (droppedFrames)
+    {
+        GDOS_WARNING("DatalogCameraWriter: %d frames dropped\n", droppedFrames);
+    }
+
+    return writerError ? -EIO : 0;
+}
+
+// data task
+int DatalogCameraWriter::write(camera_data *data, uint32_t dataLen, uint32_t frameNum)
+{
+    datalog_camera_slot *p_slot;
+
+    if (!tasksStarted)
+    {
+        return -EBADF;
+    }
+
+    if (writerError)
+    {
+        return -EIO;
+    }
+
+    if (dataLen > slotSize)
+    {
+        GDOS_ERROR("DatalogCameraWriter: Frame %d is too large (%d bytes)\n",
+                   frameNum, dataLen);
+        droppedFrames++;
+        return -EMSGSIZE;
+    }
+
+    // the queue is full, don't block the data task
+    p_slot = &slot[slotWrite];
+    if (p_slot->state != DATALOG_CAMERA_SLOT_FREE)
+    {
+        droppedFrames++;
+        return -EBUSY;
+    }
+
+    memcpy(&p_slot->head, data, sizeof(camera_data));
+    memcpy(p_slot->data, data->byteStream, dataLen);
+    p_slot->dataLen     = dataLen;
+    p_slot->frameNum    = frameNum;
+    p_slot->compression = DATALOG_CAMERA_COMPRESS_NONE;
+
+    slotMtx.lock(RACK_INFINITE);
+    if (compression != DATALOG_CAMERA_COMPRESS_NONE)
+    {
+        p_slot->state = DATALOG_CAMERA_SLOT_QUEUED;
+    }
+    else
+    {
+        p_slot->state = DATALOG_CAMERA_SLOT_DONE;
+    }
+    slotMtx.unlock();
+
+    slotWrite = (slotWrite + 1) % slotNum;
+    return 0;
+}
@@ -0,0 +1,123 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Oliver Wulf        <wulf@rts.uni-hannover.de>
+ *      Matthias Hentschel <hentschel@rts.uni-hannover.de>
+ */
+
+#ifndef __DATALOG_CAMERA_WRITER_H__
+#define __DATALOG_CAMERA_WRITER_H__
+
+#include <main/rack_gdos.h>
+#include <main/rack_mailbox.h>
+#include <main/rack_mutex.h>
+#include <main/rack_task.h>
+#include <drivers/camera_proxy.h>
+
+//
+// Camera frames are appended to preallocated segment files
+// "<name>_<segment>.frm". The frame data is stored without the camera_data
+// head, the position of every frame is written as one line into the text log
+// of the camera:
+//
+// recordingTime width height depth mode colorFilterId cameraFileNum
+// segment offset length compression
+//
+
+#define DATALOG_CAMERA_SLOT_NUM_MAX         32
+#define DATALOG_CAMERA_WORKER_NUM_MAX       8
+#define DATALOG_CAMERA_SLEEP                2000000llu      // [ns] task poll time
+
+#define DATALOG_CAMERA_COMPRESS_NONE        0
+#define DATALOG_CAMERA_COMPRESS_DELTA       1               // lossless, pixel delta + zero runs
+
+#define DATALOG_CAMERA_SLOT_FREE            0
+#define DATALOG_CAMERA_SLOT_QUEUED          1               // waits for a compression worker
+#define DATALOG_CAMERA_SLOT_BUSY            2               // compression in progress
+#define DATALOG_CAMERA_SLOT_DONE            3               // waits for the writer task
+
+typedef struct {
+    volatile int    state;
+    uint32_t        frameNum;
+    camera_data     head;
+    uint8_t         *data;
+    uint32_t        dataLen;
+    uint8_t         *compr;
+    uint32_t        comprLen;
+    int             compression;
+} datalog_camera_slot;
+
+/**
+ * Asynchronous camera frame writer of DatalogRec. Frames are copied into a
+ * queue of preallocated slots by the data task, optionally compressed by
+ * worker tasks and written in order by a writer task.
+ *
+ * @ingroup tools_datalog
+ */
+class DatalogCameraWriter
+{
+    private:
+        RackGdos            *gdos;
+
+        char                fileName[100];      // without segment number
+        FILE                *logFile;           // text log of the camera
+        int                 fd;
+        uint32_t            segment;
+        uint64_t            segmentSize;
+        uint64_t            segmentOffset;
+
+        datalog_camera_slot slot[DATALOG_CAMERA_SLOT_NUM_MAX];
+        uint32_t            slotNum;
+        uint32_t            slotWrite;
+        uint32_t            slotFlush;
+        uint32_t            slotSize;
+        RackMutex           slotMtx;
+
+        int                 compression;
+        int                 workerNum;
+        RackTask            workerTask[DATALOG_CAMERA_WORKER_NUM_MAX];
+        RackTask            writerTask;
+        volatile int        terminate;
+        volatile int        writerError;
+        int                 tasksStarted;
+
+        uint32_t            droppedFrames;
+
+        int   openSegment(void);
+        void  closeSegment(void);
+        int   writeFrame(datalog_camera_slot *p_slot);
+
+        friend void datalog_camera_worker_task_proc(void *arg);
+        friend void datalog_camera_writer_task_proc(void *arg);
+
+    public:
+        DatalogCameraWriter(RackMailbox *p_mbx, int gdos_level);
+        ~DatalogCameraWriter();
+
+        int   open(const char *fileName, FILE *logFile, uint32_t segmentSizeMb,
+                   uint32_t slotNum, int compression, int workerNum);
+        int   close(void);
+
+        int   write(camera_data *data, uint32_t dataLen, uint32_t frameNum);
+
+        uint32_t getDroppedFrames(void)
+        {
+            return droppedFrames;
+        }
+
+        static uint32_t compress(uint8_t *in, uint32_t inLen, uint8_t *out,
+                                 uint32_t outLen, uint32_t bytesPerPixel);
+        static uint32_t decompress(uint8_t *in, uint32_t inLen, uint8_t *out,
+                                   uint32_t outLen, uint32_t bytesPerPixel);
+};
+
+#endif // __DATALOG_CAMERA_WRITER_H__
@@ -0,0 +1,69 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Oliver Wulf        <wulf@rts.uni-hannover.de>
+ *      Matthias Hentschel <hentschel@rts.uni-hannover.de>
+ */
+#include "datalog_rec_class.h"
+
+#include <main/argopts.h>
+
+
+//
+// data structures
+//
+
+arg_table_t argTab[] = {
+
+    { ARGOPT_REQ, "logFile", ARGOPT_REQVAL, ARGOPT_VAL_STR,
+      "Binary log file recorded by DatalogRec", { 0 } },
+
+    { ARGOPT_OPT, "logPathName", ARGOPT_REQVAL, ARGOPT_VAL_STR,
+      "Path of the converted text log files, default \"\"", { 0 } },
+
+    { ARGOPT_OPT, "binaryIo", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Enable the binary storage of io-data, default 0", { 0 } },
+
+    { 0, "", 0, 0, "", { 0 } } // last entry
+};
+
+int  main(int argc, char *argv[])
+{
+    int ret;
+
+    // get args
+    ret = RackModule::getArgs(argc, argv, argTab, "DatalogConvert");
+    if (ret)
+    {
+        printf("Invalid arguments -> EXIT \n");
+        return ret;
+    }
+
+    // create new DatalogRec, it is only used to write the text log files and
+    // is not initialised as a module
+
+    DatalogRec *pInst;
+
+    pInst = new DatalogRec();
+    if (!pInst)
+    {
+        printf("Can't create new DatalogRec -> EXIT\n");
+        return -ENOMEM;
+    }
+
+    ret = pInst->convertBinaryLog(getStrArg("logFile", argTab),
+                                  getStrArg("logPathName", argTab),
+                                  getIntArg("binaryIo", argTab));
+
+    delete (pInst);
+    return ret;
+}
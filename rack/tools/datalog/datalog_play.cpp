@@ -0,0 +1,555 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Oliver Wulf        <wulf@rts.uni-hannover.de>
+ *      Matthias Hentschel <hentschel@rts.uni-hannover.de>
+ */
+#include "datalog_play.h"
+
+#include <main/argopts.h>
+
+// init_flags
+#define INIT_BIT_DATA_MODULE                0
+#define INIT_BIT_BIN_READER                 1
+#define INIT_BIT_LOG_FILE                   2
+
+//
+// data structures
+//
+
+arg_table_t argTab[] = {
+
+    { ARGOPT_REQ, "logFile", ARGOPT_REQVAL, ARGOPT_VAL_STR,
+      "Binary log file recorded by DatalogRec", { 0 } },
+
+    { ARGOPT_REQ, "playClass", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Class id of the recorded module (see rack_name.h), e.g. 25 = Scan2d", { 0 } },
+
+    { ARGOPT_OPT, "playInst", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Instance of the recorded module, default -1 = own instance", { -1 } },
+
+    { ARGOPT_OPT, "speed", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Replay speed in percent, 0 = as fast as possible, default 100", { 100 } },
+
+    { ARGOPT_OPT, "startTime", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Start position in ms after the start of the recording, default 0", { 0 } },
+
+    { ARGOPT_OPT, "loop", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Restart at the start position at the end of the log, default 0", { 0 } },
+
+    { ARGOPT_OPT, "timeShift", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Shift the recording times to the current time, default 1", { 1 } },
+
+    { 0, "", 0, 0, "", { 0 } } // last entry
+};
+
+/*******************************************************************************
+ *   !!! REALTIME CONTEXT !!!
+ *
+ *   moduleOn,
+ *   moduleOff,
+ *   moduleLoop,
+ *   moduleCommand,
+ *
+ *   own realtime user functions
+ ******************************************************************************/
+int  DatalogPlay::moduleOn(void)
+{
+    int ret;
+
+    GDOS_DBG_INFO("Turn on...\n");
+
+    // get dynamic module parameter
+    speed     = getInt32Param("speed");
+    startTime = getInt32Param("startTime");
+    loop      = getInt32Param("loop");
+    timeShift = getInt32Param("timeShift");
+
+    if (speed < 0)
+    {
+        GDOS_ERROR("Invalid replay speed %d\n", speed);
+        return -EINVAL;
+    }
+
+    // the listener reduction is based on the recorded period
+    if (playLogInfo && playLogInfo->periodTime)
+    {
+        dataBufferPeriodTime = playLogInfo->periodTime;
+    }
+    else
+    {
+        dataBufferPeriodTime = DATALOG_PLAY_PERIOD_DEFAULT;
+    }
+
+    playedRecords = 0;
+    playedBytes   = 0;
+    seekRequest   = 0;
+
+    ret = seekStart();
+    if (ret)
+    {
+        return ret;
+    }
+
+    return RackDataModule::moduleOn();  // has to be last command in moduleOn();
+}
+
+void DatalogPlay::moduleOff(void)
+{
+    RackDataModule::moduleOff();        // has to be first command in moduleOff();
+
+    GDOS_DBG_INFO("Turn off...\n");
+
+    playedTime = rackTime.get() - playRealTime;
+    if (playedTime > 0)
+    {
+        GDOS_PRINT("Played %d records, %d kB in %d ms (%d records/s)\n", playedRecords,
+                   (int)(playedBytes / 1024), playedTime,
+                   (int)((uint64_t)playedRecords * 1000 / playedTime));
+    }
+}
+
+int  DatalogPlay::moduleLoop(void)
+{
+    datalog_bin_record_head *record;
+    RackMessage             msgInfo;
+    void                    *pData;
+    rack_time_t             playTime;
+    rack_time_t             sleepTime;
+    int                     ret;
+
+    if (seekRequest)
+    {
+        seekRequest = 0;
+
+        ret = seekStart();
+        if (ret)
+        {
+            return ret;
+        }
+    }
+
+    // end of log
+    if (!playOffset)
+    {
+        if (loop)
+        {
+            ret = seekStart();
+            if (ret)
+            {
+                return ret;
+            }
+        }
+        else
+        {
+            RackTask::sleep(rackTime.toNano(DATALOG_PLAY_SLEEP_MAX));
+            return 0;
+        }
+    }
+
+    record = binReader->getRecord(playOffset);
+
+    // wait until the log time of the record is reached
+    if (speed > 0)
+    {
+        playTime = playLogTime +
+                   (rack_time_t)((uint64_t)(rackTime.get() - playRealTime) * speed / 100);
+
+        if ((int32_t)(record->logTime - playTime) > 0)
+        {
+            sleepTime = (rack_time_t)((uint64_t)(record->logTime - playTime) * 100 / speed);
+            if (sleepTime > DATALOG_PLAY_SLEEP_MAX)
+            {
+                sleepTime = DATALOG_PLAY_SLEEP_MAX;
+            }
+
+            RackTask::sleep(rackTime.toNano(sleepTime));
+            return 0;
+        }
+    }
+
+    binReader->getMessage(playOffset, &msgInfo);
+
+    if ((msgInfo.datalen < sizeof(rack_time_t)) ||
+        (msgInfo.datalen > dataBufferMaxDataSize))
+    {
+        GDOS_WARNING("Skipping record with invalid data size %d\n", msgInfo.datalen);
+    }
+    else
+    {
+        // the recorded data is parsed in the data buffer
+        pData = getDataBufferWorkSpace();
+        memcpy(pData, msgInfo.p_data, msgInfo.datalen);
+        msgInfo.p_data = pData;
+
+        ret = parseData(&msgInfo);
+        if (ret)
+        {
+            GDOS_ERROR("Can't parse recorded data, code = %d\n", ret);
+            return ret;
+        }
+
+        *(rack_time_t *)pData += recordingTimeShift;
+
+        putDataBufferWorkSpace(msgInfo.datalen);
+
+        playedRecords++;
+        playedBytes += msgInfo.datalen;
+    }
+
+    // find next record of the stream
+    do
+    {
+        playOffset = binReader->next(playOffset);
+    }
+    while (playOffset && !isPlayStream(playOffset));
+
+    return 0;
+}
+
+int  DatalogPlay::moduleCommand(RackMessage *msgInfo)
+{
+    int ret;
+
+    switch (msgInfo->getType())
+    {
+        case MSG_SET_PARAM:
+            ret = RackDataModule::moduleCommand(msgInfo);
+
+            speed     = getInt32Param("speed");
+            loop      = getInt32Param("loop");
+            timeShift = getInt32Param("timeShift");
+
+            // seek in the data task
+            if (startTime != getInt32Param("startTime"))
+            {
+                startTime   = getInt32Param("startTime");
+                seekRequest = 1;
+            }
+
+            GDOS_DBG_INFO("Module parameter changed\n");
+            return ret;
+
+        default:
+            // not for me -> ask RackDataModule
+            return RackDataModule::moduleCommand(msgInfo);
+    }
+    return 0;
+}
+
+int  DatalogPlay::isPlayStream(uint64_t offset)
+{
+    uint32_t src = binReader->getRecord(offset)->head.src;
+
+    return ((RackName::classId(src)    == playClass) &&
+            (RackName::instanceId(src) == playInst));
+}
+
+int  DatalogPlay::seekStart(void)
+{
+    datalog_bin_record_head *record;
+
+    playOffset = binReader->seek(binReader->getFileHead()->startTime + startTime);
+
+    while (playOffset && !isPlayStream(playOffset))
+    {
+        playOffset = binReader->next(playOffset);
+    }
+
+    if (!playOffset)
+    {
+        GDOS_ERROR("No data of %n after %d ms in log file\n",
+                   RackName::create(playClass, playInst), startTime);
+        return -ENOENT;
+    }
+
+    record = binReader->getRecord(playOffset);
+
+    playLogTime  = record->logTime;
+    playRealTime = rackTime.get();
+
+    if (timeShift)
+    {
+        recordingTimeShift = playRealTime - record->recordingTime;
+    }
+    else
+    {
+        recordingTimeShift = 0;
+    }
+
+    GDOS_DBG_INFO("Start replay at recording time %d\n", record->recordingTime);
+    return 0;
+}
+
+int  DatalogPlay::parseData(RackMessage *msgInfo)
+{
+    switch (playClass)
+    {
+        case CAMERA:
+            CameraData::parse(msgInfo);
+            break;
+        case CHASSIS:
+            ChassisData::parse(msgInfo);
+            break;
+        case CLOCK:
+            ClockData::parse(msgInfo);
+            break;
+        case COMPASS:
+            CompassData::parse(msgInfo);
+            break;
+        case GPS:
+            GpsData::parse(msgInfo);
+            break;
+        case GYRO:
+            GyroData::parse(msgInfo);
+            break;
+        case IO:
+            IoData::parse(msgInfo);
+            break;
+        case LADAR:
+            LadarData::parse(msgInfo);
+            break;
+        case ODOMETRY:
+            OdometryData::parse(msgInfo);
+            break;
+        case SERVO_DRIVE:
+            ServoDriveData::parse(msgInfo);
+            break;
+        case VEHICLE:
+            VehicleData::parse(msgInfo);
+            break;
+        case GRID_MAP:
+            GridMapData::parse(msgInfo);
+            break;
+        case MCL:
+            MCLData::parse(msgInfo);
+            break;
+        case PATH:
+            PathData::parse(msgInfo);
+            break;
+        case PILOT:
+            PilotData::parse(msgInfo);
+            break;
+        case POSITION:
+            PositionData::parse(msgInfo);
+            break;
+        case OBJ_RECOG:
+            ObjRecogData::parse(msgInfo);
+            break;
+        case SCAN2D:
+            Scan2dData::parse(msgInfo);
+            break;
+        case SCAN3D:
+            Scan3dData::parse(msgInfo);
+            break;
+
+        default:
+            // unknown data can only be republished in the local byteorder
+            if (msgInfo->data32ToCpu(0x01020304) != 0x01020304)
+            {
+                return -EINVAL;
+            }
+            break;
+    }
+
+    return 0;
+}
+
+/*******************************************************************************
+ *   !!! NON REALTIME CONTEXT !!!
+ *
+ *   moduleInit,
+ *   moduleCleanup,
+ *   Constructor,
+ *   Destructor,
+ *   main,
+ *
+ *   own non realtime user functions
+ ******************************************************************************/
+int  DatalogPlay::moduleInit(void)
+{
+    int ret;
+
+    // call RackDataModule init function (first command in init)
+    ret = RackDataModule::moduleInit();
+    if (ret)
+    {
+        return ret;
+    }
+    initBits.setBit(INIT_BIT_DATA_MODULE);
+
+    // create binary log reader
+    binReader = new DatalogBinReader(&cmdMbx, gdosLevel);
+    if (!binReader)
+    {
+        ret = -ENOMEM;
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_BIN_READER);
+
+    // map log file
+    ret = binReader->open(logFile);
+    if (ret)
+    {
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_LOG_FILE);
+
+    playLogInfo = NULL;
+    for (int i = 0; i < binReader->getFileHead()->data.logNum; i++)
+    {
+        if ((RackName::classId(binReader->getFileHead()->logInfo[i].moduleMbx) == playClass) &&
+            (RackName::instanceId(binReader->getFileHead()->logInfo[i].moduleMbx) == playInst))
+        {
+            playLogInfo = &binReader->getFileHead()->logInfo[i];
+        }
+    }
+
+    if (!playLogInfo)
+    {
+        GDOS_WARNING("%n has not been recorded in %s\n",
+                     RackName::create(playClass, playInst), logFile);
+    }
+
+    return 0;
+
+init_error:
+    // !!! call local cleanup function !!!
+    DatalogPlay::moduleCleanup();
+    return ret;
+}
+
+void DatalogPlay::moduleCleanup(void)
+{
+    // call RackDataModule cleanup function
+    if (initBits.testAndClearBit(INIT_BIT_DATA_MODULE))
+    {
+        RackDataModule::moduleCleanup();
+    }
+
+    if (initBits.testAndClearBit(INIT_BIT_LOG_FILE))
+    {
+        binReader->close();
+    }
+
+    if (initBits.testAndClearBit(INIT_BIT_BIN_READER))
+    {
+        delete binReader;
+    }
+}
+
+DatalogPlay::DatalogPlay(uint32_t classId)
+      : RackDataModule( classId,
+                    5000000000llu,    // 5s datatask error sleep time
+                    16,               // command mailbox slots
+                    240,              // command mailbox data size per slot
+                    MBX_IN_KERNELSPACE | MBX_SLOT,  // command mailbox flags
+                    10,               // max buffer entries
+                    10)               // data buffer listener
+{
+    DatalogBinReader         reader(NULL, gdosLevel);
+    datalog_bin_file_head    *fileHead;
+    datalog_bin_record_head  *record;
+    uint64_t                 offset;
+    int                      i;
+
+    // get static module parameter
+    logFile   = getStrArg("logFile", argTab);
+    playClass = classId;
+
+    if (getIntArg("playInst", argTab) < 0)
+    {
+        playInst = getIntArg("instance", module_argTab);
+    }
+    else
+    {
+        playInst = getIntArg("playInst", argTab);
+    }
+
+    binReader          = NULL;
+    playLogInfo        = NULL;
+    playOffset         = 0;
+    recordingTimeShift = 0;
+
+    // the data buffer has to hold the largest recorded message
+    dataBufferMaxDataSize = 0;
+
+    if (reader.open(logFile) == 0)
+    {
+        fileHead = reader.getFileHead();
+
+        for (i = 0; i < fileHead->data.logNum; i++)
+        {
+            if ((RackName::classId(fileHead->logInfo[i].moduleMbx) == playClass) &&
+                (RackName::instanceId(fileHead->logInfo[i].moduleMbx) == playInst))
+            {
+                dataBufferMaxDataSize = fileHead->logInfo[i].maxDataLen;
+            }
+        }
+
+        // no size information, search the largest message
+        if (dataBufferMaxDataSize == 0)
+        {
+            for (offset = reader.first(); offset; offset = reader.next(offset))
+            {
+                record = reader.getRecord(offset);
+                if ((RackName::classId(record->head.src)    == playClass) &&
+                    (RackName::instanceId(record->head.src) == playInst) &&
+                    (record->recordLen - sizeof(datalog_bin_record_head) >
+                     dataBufferMaxDataSize))
+                {
+                    dataBufferMaxDataSize = record->recordLen -
+                                            sizeof(datalog_bin_record_head);
+                }
+            }
+        }
+
+        reader.close();
+    }
+}
+
+int  main(int argc, char *argv[])
+{
+    int ret;
+
+    // get args
+    ret = RackModule::getArgs(argc, argv, argTab, "DatalogPlay");
+    if (ret)
+    {
+        printf("Invalid arguments -> EXIT \n");
+        return ret;
+    }
+
+    // create new DatalogPlay with the class of the recorded module
+
+    DatalogPlay *pInst;
+
+    pInst = new DatalogPlay(getIntArg("playClass", argTab));
+    if (!pInst)
+    {
+        printf("Can't create new DatalogPlay -> EXIT\n");
+        return -ENOMEM;
+    }
+
+    // init
+    ret = pInst->moduleInit();
+    if (ret)
+        goto exit_error;
+
+    pInst->run();
+
+    return 0;
+
+exit_error:
+    delete (pInst);
+    return ret;
+}
@@ -0,0 +1,104 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Oliver Wulf        <wulf@rts.uni-hannover.de>
+ *      Matthias Hentschel <hentschel@rts.uni-hannover.de>
+ */
+
+#ifndef __DATALOG_PLAY_H__
+#define __DATALOG_PLAY_H__
+
+#include <main/rack_data_module.h>
+#include <tools/datalog_proxy.h>
+#include <tools/datalog/datalog_bin_file.h>
+
+#include <drivers/camera_proxy.h>
+#include <drivers/chassis_proxy.h>
+#include <drivers/clock_proxy.h>
+#include <drivers/compass_proxy.h>
+#include <drivers/gps_proxy.h>
+#include <drivers/gyro_proxy.h>
+#include <drivers/io_proxy.h>
+#include <drivers/ladar_proxy.h>
+#include <drivers/servo_drive_proxy.h>
+#include <drivers/vehicle_proxy.h>
+#include <navigation/grid_map_proxy.h>
+#include <navigation/mcl_proxy.h>
+#include <navigation/odometry_proxy.h>
+#include <navigation/path_proxy.h>
+#include <navigation/pilot_proxy.h>
+#include <navigation/position_proxy.h>
+#include <perception/obj_recog_proxy.h>
+#include <perception/scan2d_proxy.h>
+#include <perception/scan3d_proxy.h>
+
+#define DATALOG_PLAY_SLEEP_MAX          100     // [ms] max sleep time of the data task
+#define DATALOG_PLAY_PERIOD_DEFAULT     100     // [ms] if the recorded period is unknown
+
+/**
+ * Datalog Play
+ *
+ * Republishes one stream of a binary log file (see DatalogRec) under the
+ * class and instance of the recorded module, so the data is consumed by the
+ * unchanged proxies. Start one DatalogPlay per stream to replay a complete
+ * scenario. speed = 0 publishes the data as fast as possible, e.g. as input
+ * for throughput benchmarks.
+ *
+ * @ingroup modules_datalog
+ */
+class DatalogPlay : public RackDataModule {
+    private:
+        char                *logFile;
+        uint32_t            playClass;
+        uint32_t            playInst;
+        int                 speed;
+        int                 startTime;
+        int                 loop;
+        int                 timeShift;
+
+        DatalogBinReader    *binReader;
+        datalog_log_info    *playLogInfo;
+
+        uint64_t            playOffset;
+        rack_time_t         playLogTime;        // log time of the start position
+        rack_time_t         playRealTime;       // real time of the start position
+        rack_time_t         recordingTimeShift;
+        volatile int        seekRequest;
+
+        uint32_t            playedRecords;
+        uint64_t            playedBytes;
+        rack_time_t         playedTime;
+
+        int     isPlayStream(uint64_t offset);
+        int     seekStart(void);
+        int     parseData(RackMessage *msgInfo);
+
+    protected:
+        // -> realtime context
+        int     moduleOn(void);
+        void    moduleOff(void);
+        int     moduleLoop(void);
+        int     moduleCommand(RackMessage *msgInfo);
+
+        // -> non realtime context
+        void    moduleCleanup(void);
+
+    public:
+        // constructor und destructor
+        DatalogPlay(uint32_t classId);
+        ~DatalogPlay() {};
+
+        // -> non realtime context
+        int     moduleInit(void);
+};
+
+#endif // __DATALOG_PLAY_H__
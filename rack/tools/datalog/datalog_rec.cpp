@@ -27,6 +27,30 @@ arg_table_t argTab[] = {
     { ARGOPT_OPT, "binaryIo", ARGOPT_REQVAL, ARGOPT_VAL_INT,
       "Enable the binary storage of io-data, default 0", { 0 } },
 
+    { ARGOPT_OPT, "binaryLog", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Record all data into one binary log file (see DatalogConvert), default 0", { 0 } },
+
+    { ARGOPT_OPT, "binaryChunkSize", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Size of the binary log write buffers in kB, default 4096", { 4096 } },
+
+    { ARGOPT_OPT, "cameraAsync", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Write camera frames asynchronously into segment files, default 0", { 0 } },
+
+    { ARGOPT_OPT, "cameraSegmentSize", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Size of the preallocated camera segment files in MB, default 1024", { 1024 } },
+
+    { ARGOPT_OPT, "cameraCompress", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Camera frame compression, 0 = none, 1 = lossless, default 0", { 0 } },
+
+    { ARGOPT_OPT, "cameraWorkerNum", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Number of camera compression tasks, default 2", { 2 } },
+
+    { ARGOPT_OPT, "cameraQueueLen", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Number of queued camera frames per camera, default 8", { 8 } },
+
+    { ARGOPT_OPT, "largeDataLatest", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Record only the newest large message (scan3d, camera ...) of every module, default 0", { 0 } },
+
     { ARGOPT_OPT, "logInfoFileName", ARGOPT_REQVAL, ARGOPT_VAL_STR,
       "Filename of an additional file with logInfos of the modules to log", { ((int)"") } },
 
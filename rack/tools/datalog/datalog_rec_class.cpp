@@ -25,6 +25,7 @@
 #define INIT_BIT_MBX_SMALL_CONT_DATA        4
 #define INIT_BIT_MBX_LARGE_CONT_DATA        5
 #define INIT_BIT_MTX_CREATED                6
+#define INIT_BIT_BIN_WRITER                 7
 
 /*******************************************************************************
  *   !!! REALTIME CONTEXT !!!
@@ -42,6 +43,7 @@ int  DatalogRec::moduleOn(void)
     int         logEnable;
     int         moduleMbx;
     char        string[100];
+    uint32_t    chunkSize;
     rack_time_t periodTime;
     rack_time_t realPeriodTime;
     rack_time_t datalogPeriodTime = RACK_TIME_MAX;
@@ -59,6 +61,52 @@ int  DatalogRec::moduleOn(void)
     for (i = 0; i < datalogInfoMsg.data.logNum; i++)
     {
         fileptr[i] = NULL;
+
+        datalogInfoMsg.logInfo[i].bytesLogged = 0;
+        datalogInfoMsg.logInfo[i].setsLogged  = 0;
+    }
+
+    // open binary log file
+    if (binaryLog)
+    {
+        // a chunk has to hold at least the largest message
+        chunkSize = binaryChunkSize * 1024;
+        if (chunkSize < DATALOG_BIN_CHUNK_SIZE_MIN)
+        {
+            chunkSize = DATALOG_BIN_CHUNK_SIZE_MIN;
+        }
+
+        for (i = 0; i < datalogInfoMsg.data.logNum; i++)
+        {
+            if ((datalogInfoMsg.logInfo[i].logEnable > 0) &&
+                (datalogInfoMsg.logInfo[i].maxDataLen + sizeof(datalog_bin_chunk_head) +
+                 sizeof(datalog_bin_record_head) + DATALOG_BIN_RECORD_ALIGN > chunkSize))
+            {
+                chunkSize = datalogInfoMsg.logInfo[i].maxDataLen +
+                            sizeof(datalog_bin_chunk_head) +
+                            sizeof(datalog_bin_record_head) + DATALOG_BIN_RECORD_ALIGN;
+            }
+        }
+
+        strcpy(string, (char *)datalogInfoMsg.data.logPathName);
+        strcat(string, DATALOG_BIN_FILENAME);
+
+        ret = binWriter->open(string, &datalogInfoMsg.data, chunkSize, rackTime.get());
+        if (ret)
+        {
+            GDOS_ERROR("Can't open binary log file %s, code= %d\n", string, ret);
+            return ret;
+        }
+    }
+
+    // open text log files
+    else
+    {
+        ret = openTextLogFiles();
+        if (ret)
+        {
+            return ret;
+        }
     }
 
     smallContDataMbx.clean();
@@ -70,22 +118,8 @@ int  DatalogRec::moduleOn(void)
         periodTime = datalogInfoMsg.logInfo[i].periodTime;
         moduleMbx  = datalogInfoMsg.logInfo[i].moduleMbx;
 
-        datalogInfoMsg.logInfo[i].bytesLogged = 0;
-        datalogInfoMsg.logInfo[i].setsLogged  = 0;
-
         if (logEnable > 0)
         {
-            // concatenate filename
-            strcpy(string, (char *)datalogInfoMsg.data.logPathName);
-            strcat(string, (char *)datalogInfoMsg.logInfo[i].filename);
-
-            // open log file
-            if ((fileptr[i] = fopen(string, "w")) == NULL)
-            {
-                GDOS_ERROR("Can't open file %n...\n", moduleMbx);
-                return -EIO;
-            }
-
             // turn on module
             ret = moduleOn(moduleMbx, &workMbx, 5000000000ll);
 
@@ -125,11 +159,23 @@ int  DatalogRec::moduleOn(void)
 
     dataBufferPeriodTime = datalogPeriodTime;
 
-    ret = initLogFile();
-    if (ret < 0)
+    if (!binaryLog)
     {
-        GDOS_ERROR("Can't init log files, code= %i\n", ret);
-        return ret;
+        ret = initLogFile();
+        if (ret < 0)
+        {
+            GDOS_ERROR("Can't init log files, code= %i\n", ret);
+            return ret;
+        }
+
+        if (cameraAsync)
+        {
+            ret = openCameraWriter();
+            if (ret)
+            {
+                return ret;
+            }
+        }
     }
 
     return RackDataModule::moduleOn();  // has to be last command in moduleOn();
@@ -162,14 +208,19 @@ void DatalogRec::moduleOff(void)
             {
                 stopContData(moduleMbx, &largeContDataMbx, &workMbx, 1000000000ll);
             }
-
-            if (fileptr[i] != NULL)
-            {
-                fclose(fileptr[i]);
-            }
         }
     }
 
+    if (binaryLog)
+    {
+        binWriter->close();
+    }
+    else
+    {
+        closeCameraWriter();
+        closeTextLogFiles();
+    }
+
     RackTask::enableRealtimeMode();
 }
 
@@ -181,8 +232,16 @@ int  DatalogRec::moduleLoop(void)
 
 
     // get continuous data on largeContDataMbx
-    ret = largeContDataMbx.recvDataMsgIf(largeContDataPtr, DATALOG_LARGE_MBX_SIZE_MAX,
-                                         &msgInfo);
+    if (largeDataLatest)
+    {
+        ret = largeContDataMbx.recvLatest(largeContDataPtr, DATALOG_LARGE_MBX_SIZE_MAX,
+                                          &msgInfo);
+    }
+    else
+    {
+        ret = largeContDataMbx.recvDataMsgIf(largeContDataPtr, DATALOG_LARGE_MBX_SIZE_MAX,
+                                             &msgInfo);
+    }
     if (ret && ret != -EWOULDBLOCK) // error
     {
         GDOS_ERROR("Can't read data on largeContDataMbx, code = %d\n", ret);
@@ -225,7 +284,14 @@ int  DatalogRec::moduleLoop(void)
     pDatalogData = (datalog_data *)getDataBufferWorkSpace();
 
     // log data
-    ret = logData(&msgInfo);
+    if (binaryLog)
+    {
+        ret = logBinaryData(&msgInfo);
+    }
+    else
+    {
+        ret = logData(&msgInfo);
+    }
     if (ret)
     {
 /*        datalogMtx.unlock();
@@ -309,6 +375,17 @@ int  DatalogRec::moduleCommand(RackMessage *msgInfo)
             GDOS_DBG_INFO("Module parameter changed\n");
             enableBinaryIo  = getInt32Param("binaryIo");
             logInfoFileName = getStringParam("logInfoFileName");
+            if (status == MODULE_STATE_DISABLED)
+            {
+                binaryLog       = getInt32Param("binaryLog");
+                binaryChunkSize = getInt32Param("binaryChunkSize");
+
+                cameraAsync       = getInt32Param("cameraAsync");
+                cameraSegmentSize = getInt32Param("cameraSegmentSize");
+                cameraCompress    = getInt32Param("cameraCompress");
+                cameraWorkerNum   = getInt32Param("cameraWorkerNum");
+                cameraQueueLen    = getInt32Param("cameraQueueLen");
+            }
             return ret;
 
         default:
@@ -318,6 +395,123 @@ int  DatalogRec::moduleCommand(RackMessage *msgInfo)
     return 0;
 }
 
+int DatalogRec::openTextLogFiles(void)
+{
+    int  i;
+    char string[100];
+
+    for (i = 0; i < datalogInfoMsg.data.logNum; i++)
+    {
+        fileptr[i] = NULL;
+
+        if (datalogInfoMsg.logInfo[i].logEnable > 0)
+        {
+            // concatenate filename
+            strcpy(string, (char *)datalogInfoMsg.data.logPathName);
+            strcat(string, (char *)datalogInfoMsg.logInfo[i].filename);
+
+            // open log file
+            if ((fileptr[i] = fopen(string, "w")) == NULL)
+            {
+                GDOS_ERROR("Can't open file %n...\n", datalogInfoMsg.logInfo[i].moduleMbx);
+                return -EIO;
+            }
+        }
+    }
+
+    return 0;
+}
+
+void DatalogRec::closeTextLogFiles(void)
+{
+    int i;
+
+    for (i = 0; i < datalogInfoMsg.data.logNum; i++)
+    {
+        if (fileptr[i] != NULL)
+        {
+            fclose(fileptr[i]);
+            fileptr[i] = NULL;
+        }
+    }
+}
+
+int DatalogRec::openCameraWriter(void)
+{
+    int  i, ret;
+    char string[100];
+
+    for (i = 0; i < datalogInfoMsg.data.logNum; i++)
+    {
+        if ((datalogInfoMsg.logInfo[i].logEnable > 0) &&
+            (RackName::classId(datalogInfoMsg.logInfo[i].moduleMbx) == CAMERA))
+        {
+            cameraWriter[i] = new DatalogCameraWriter(&cmdMbx, gdosLevel);
+            if (!cameraWriter[i])
+            {
+                return -ENOMEM;
+            }
+
+            // segment files are named after the log file
+            strcpy(string, (char *)datalogInfoMsg.data.logPathName);
+            strcat(string, (char *)datalogInfoMsg.logInfo[i].filename);
+            strtok(string, ".");
+
+            ret = cameraWriter[i]->open(string, fileptr[i], cameraSegmentSize,
+                                        cameraQueueLen, cameraCompress, cameraWorkerNum);
+            if (ret)
+            {
+                GDOS_ERROR("Can't open camera writer of %n, code= %d\n",
+                           datalogInfoMsg.logInfo[i].moduleMbx, ret);
+                delete cameraWriter[i];
+                cameraWriter[i] = NULL;
+                return ret;
+            }
+        }
+    }
+
+    return 0;
+}
+
+void DatalogRec::closeCameraWriter(void)
+{
+    int i;
+
+    for (i = 0; i < datalogInfoMsg.data.logNum; i++)
+    {
+        if (cameraWriter[i] != NULL)
+        {
+            cameraWriter[i]->close();
+            delete cameraWriter[i];
+            cameraWriter[i] = NULL;
+        }
+    }
+}
+
+int DatalogRec::logBinaryData(RackMessage *msgInfo)
+{
+    int i, ret;
+
+    for (i = 0; i < datalogInfoMsg.data.logNum; i++)
+    {
+        if (datalogInfoMsg.logInfo[i].moduleMbx == msgInfo->getSrc())
+        {
+            // store raw message, it is parsed offline by DatalogConvert
+            ret = binWriter->write(msgInfo, rackTime.get());
+            if (ret)
+            {
+                return ret;
+            }
+
+            datalogInfoMsg.logInfo[i].bytesLogged += msgInfo->datalen;
+            datalogInfoMsg.logInfo[i].setsLogged  += 1;
+            return 0;
+        }
+    }
+
+    return 0;
+}
+
 int DatalogRec::initLogFile()
 {
     int i, ret = 0;
@@ -331,9 +525,10 @@ int DatalogRec::initLogFile()
                 case CAMERA:
                     ret = fprintf(fileptr[i], "%% Camera(%i/%i)\n"
                                   "%% recordingTime width height depth mode"
-                                  " colorFilterId cameraFileNum\n",
+                                  " colorFilterId cameraFileNum%s\n",
                                   RackName::systemId(datalogInfoMsg.logInfo[i].moduleMbx),
-                                  RackName::instanceId(datalogInfoMsg.logInfo[i].moduleMbx));
+                                  RackName::instanceId(datalogInfoMsg.logInfo[i].moduleMbx),
+                                  cameraAsync ? " segment offset length compression" : "");
                     break;
 
                 case CHASSIS:
@@ -577,6 +772,21 @@ int DatalogRec::logData(RackMessage *msgInfo)
                 case CAMERA:
                     cameraData = CameraData::parse(msgInfo);
 
+                    // queue frame, the log line is written by the camera writer
+                    if (cameraWriter[i] != NULL)
+                    {
+                        bytes = msgInfo->datalen - sizeof(camera_data);
+
+                        ret = cameraWriter[i]->write(cameraData, bytes,
+                                                     datalogInfoMsg.logInfo[i].setsLogged + 1);
+                        if (ret == 0)
+                        {
+                            datalogInfoMsg.logInfo[i].bytesLogged += bytes;
+                            datalogInfoMsg.logInfo[i].setsLogged  += 1;
+                        }
+                        break;
+                    }
+
                     strcpy(extFilenameBuf, (char *)datalogInfoMsg.data.logPathName);
                     strcat(extFilenameBuf, (char *)datalogInfoMsg.logInfo[i].filename);
                     extFilenamePtr = strtok((char *)extFilenameBuf, ".");
@@ -2008,8 +2218,17 @@ int DatalogRec::moduleInit(void)
 
     // get static module parameter
     enableBinaryIo  = getInt32Param("binaryIo");
+    binaryLog       = getInt32Param("binaryLog");
+    binaryChunkSize = getInt32Param("binaryChunkSize");
     logInfoFileName = getStringParam("logInfoFileName");
 
+    cameraAsync       = getInt32Param("cameraAsync");
+    cameraSegmentSize = getInt32Param("cameraSegmentSize");
+    cameraCompress    = getInt32Param("cameraCompress");
+    cameraWorkerNum   = getInt32Param("cameraWorkerNum");
+    cameraQueueLen    = getInt32Param("cameraQueueLen");
+    largeDataLatest   = getInt32Param("largeDataLatest");
+
     // allocate memory for smallContData buffer
     smallContDataPtr = malloc(DATALOG_SMALL_MBX_SIZE_MAX);
     if (smallContDataPtr == NULL)
@@ -2046,8 +2265,10 @@ int DatalogRec::moduleInit(void)
     initBits.setBit(INIT_BIT_MBX_SMALL_CONT_DATA);
 
     // continuous-data mailbox for large messages
+    // -> latest-value mailbox drops unread messages if the recording falls behind
     ret = createMbx(&largeContDataMbx, 10, DATALOG_LARGE_MBX_SIZE_MAX,
-                    MBX_IN_USERSPACE | MBX_SLOT);
+                    MBX_IN_USERSPACE | MBX_SLOT |
+                    (largeDataLatest ? MBX_LATEST : 0));
     if (ret)
     {
         goto init_error;
@@ -2062,6 +2283,15 @@ int DatalogRec::moduleInit(void)
     }
     initBits.setBit(INIT_BIT_MTX_CREATED);
 
+    // binary log writer
+    binWriter = new DatalogBinWriter(&cmdMbx, gdosLevel);
+    if (!binWriter)
+    {
+        ret = -ENOMEM;
+        goto init_error;
+    }
+    initBits.setBit(INIT_BIT_BIN_WRITER);
+
     return 0;
 
 init_error:
@@ -2078,6 +2308,12 @@ void DatalogRec::moduleCleanup(void)
         RackDataModule::moduleCleanup();
     }
 
+    // destroy binary log writer
+    if (initBits.testAndClearBit(INIT_BIT_BIN_WRITER))
+    {
+        delete binWriter;
+    }
+
     // destroy mutex
     if (initBits.testAndClearBit(INIT_BIT_MTX_CREATED))
     {
@@ -2111,6 +2347,80 @@ void DatalogRec::moduleCleanup(void)
     }
 }
 
+int DatalogRec::convertBinaryLog(char *binFileName, char *logPathName, int binaryIo)
+{
+    int                   i, ret;
+    uint32_t              recordNum = 0;
+    uint64_t              offset;
+    RackMessage           msgInfo;
+    datalog_bin_file_head *fileHead;
+    DatalogBinReader      binReader(NULL, gdosLevel);
+
+    ret = binReader.open(binFileName);
+    if (ret)
+    {
+        return ret;
+    }
+
+    // restore logInfos of the recording
+    fileHead = binReader.getFileHead();
+    if ((fileHead->data.logNum < 0) || (fileHead->data.logNum > DATALOG_LOGNUM_MAX))
+    {
+        GDOS_ERROR("Invalid number of logInfos %d in %s\n", fileHead->data.logNum,
+                   binFileName);
+        binReader.close();
+        return -EINVAL;
+    }
+
+    memcpy(&datalogInfoMsg.data, &fileHead->data, sizeof(datalog_data) +
+           fileHead->data.logNum * sizeof(datalog_log_info));
+
+    snprintf((char *)datalogInfoMsg.data.logPathName,
+             sizeof(datalogInfoMsg.data.logPathName), "%s", logPathName ? logPathName : "");
+
+    for (i = 0; i < datalogInfoMsg.data.logNum; i++)
+    {
+        datalogInfoMsg.logInfo[i].bytesLogged = 0;
+        datalogInfoMsg.logInfo[i].setsLogged  = 0;
+    }
+
+    enableBinaryIo = binaryIo;
+
+    ret = openTextLogFiles();
+    if (ret == 0)
+    {
+        ret = initLogFile();
+        if (ret > 0)
+        {
+            ret = 0;
+        }
+    }
+
+    // write text log files in recording order
+    offset = binReader.first();
+    while ((ret == 0) && offset)
+    {
+        binReader.getMessage(offset, &msgInfo);
+
+        ret = logData(&msgInfo);
+        if (ret)
+        {
+            GDOS_ERROR("Can't convert record at offset %d, code= %d\n", (int)offset, ret);
+            break;
+        }
+
+        recordNum++;
+        offset = binReader.next(offset);
+    }
+
+    closeTextLogFiles();
+    binReader.close();
+
+    GDOS_PRINT("Converted %d records of %d modules from %s\n", recordNum,
+               datalogInfoMsg.data.logNum, binFileName);
+    return ret;
+}
+
 DatalogRec::DatalogRec(void)
       : RackDataModule( MODULE_CLASS_ID,
                     5000000000llu,    // 5s datatask error sleep time
@@ -2122,4 +2432,12 @@ DatalogRec::DatalogRec(void)
                     10)               // data buffer listener
 {
     dataBufferMaxDataSize   = sizeof(datalog_data_msg);
+    binWriter               = NULL;
+    cameraAsync             = 0;
+
+    for (int i = 0; i < DATALOG_LOGNUM_MAX; i++)
+    {
+        fileptr[i]      = NULL;
+        cameraWriter[i] = NULL;
+    }
 }
@@ -19,6 +19,8 @@
 
 #include <main/rack_data_module.h>
 #include <tools/datalog_proxy.h>
+#include <tools/datalog/datalog_bin_file.h>
+#include <tools/datalog/datalog_camera_writer.h>
 
 #include <drivers/camera_proxy.h>
 #include <drivers/chassis_proxy.h>
@@ -46,6 +48,9 @@
 
 #define DATALOG_SMALL_MBX_SIZE_MAX            20*1024  //20KB
 
+#define DATALOG_BIN_FILENAME              "datalog.rlog"
+#define DATALOG_BIN_CHUNK_SIZE_MIN        64*1024  //64KB
+
 #if defined (__MSG_VELODYNE__) || defined (__MSG_KINECT__)
 #define DATALOG_LARGE_MBX_SIZE_MAX        5*1024*1024  //5MB
 #else // (__MSG_SCANDRIVE__)
@@ -67,8 +72,19 @@ typedef struct {
 class DatalogRec : public RackDataModule {
     private:
         int         enableBinaryIo;
+        int         binaryLog;
+        int         binaryChunkSize;
+        int         cameraAsync;
+        int         cameraSegmentSize;
+        int         cameraCompress;
+        int         cameraWorkerNum;
+        int         cameraQueueLen;
+        int         largeDataLatest;
         char       *logInfoFileName;
 
+        DatalogBinWriter    *binWriter;
+        DatalogCameraWriter *cameraWriter[DATALOG_LOGNUM_MAX];
+
         void*       smallContDataPtr;
         void*       largeContDataPtr;
 
@@ -103,6 +119,12 @@ class DatalogRec : public RackDataModule {
                                    datalog_log_info *logInfoCurrent, RackMailbox *replyMbx,
                                    uint64_t reply_timeout_ns);
 
+        int  openTextLogFiles(void);
+        void closeTextLogFiles(void);
+        int  openCameraWriter(void);
+        void closeCameraWriter(void);
+        int  logBinaryData(RackMessage *msgInfo);
+
         int  loadLogInfoFile(char *fileName, datalog_data *data);
         int  parseLogInfo(FILE *file, datalog_data *data);
 
@@ -118,6 +140,8 @@ class DatalogRec : public RackDataModule {
         virtual int  initLogFile();
         virtual int  logData(RackMessage *msgInfo);
 
+        int  convertBinaryLog(char *binFileName, char *logPathName, int binaryIo);
+
         // constructor und destructor
         DatalogRec();
         ~DatalogRec() {};
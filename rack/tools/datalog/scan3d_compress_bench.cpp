@@ -0,0 +1,181 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Oliver Wulf        <wulf@rts.uni-hannover.de>
+ *      Matthias Hentschel <hentschel@rts.uni-hannover.de>
+ */
+#include <tools/datalog/datalog_bin_file.h>
+#include <main/scan3d_compress_tool.h>
+#include <main/rack_module.h>
+#include <main/rack_name.h>
+#include <main/argopts.h>
+
+//
+// Compresses the scan3d data of a binary log (see DatalogRec) serially
+// with Scan3dCompressTool::Compress() and in blocks with
+// Scan3dCompressTool::CompressBlocks() and prints the compression times.
+// The job mailboxes of the workers need a running TiMS router.
+//
+
+//
+// data structures
+//
+
+arg_table_t argTab[] = {
+
+    { ARGOPT_REQ, "logFile", ARGOPT_REQVAL, ARGOPT_VAL_STR,
+      "Binary log file recorded by DatalogRec", { 0 } },
+
+    { ARGOPT_OPT, "scan3dInst", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Instance of the scan3d module, default -1 (all)", { -1 } },
+
+    { ARGOPT_OPT, "flagsS1", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Compression flags of step 1, default 1 (COMPR_S1_REDUCE_BITS)", { COMPR_S1_REDUCE_BITS } },
+
+    { ARGOPT_OPT, "flagsS2", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Compression flags of step 2, default 0 (COMPR_S2_NONE)", { COMPR_S2_NONE } },
+
+    { ARGOPT_OPT, "flagsS3", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Compression flags of step 3, default 49 (COMPR_S3_HUFFMANN)", { COMPR_S3_HUFFMANN } },
+
+    { ARGOPT_OPT, "blockPointNum", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Points per block, default 16384", { COMPR_BLOCK_POINT_NUM } },
+
+    { ARGOPT_OPT, "workerNum", ARGOPT_REQVAL, ARGOPT_VAL_INT,
+      "Number of compression worker tasks, default 3", { 3 } },
+
+    { 0, "", 0, 0, "", { 0 } } // last entry
+};
+
+int  main(int argc, char *argv[])
+{
+    RackMessage         msgInfo;
+    RackTime            rackTime;
+    RackMailbox         jobMbx, doneMbx;
+    DatalogBinReader    binReader(NULL, 0);
+    Scan3dCompressTool  *serialTool, *blockTool;
+    scan3d_data         *scan, *data;
+    uint64_t            offset, time;
+    uint64_t            serialTime = 0, blockTime = 0;
+    uint64_t            rawBytes = 0, serialBytes = 0, blockBytes = 0;
+    uint32_t            scanNum = 0, flagsS1, flagsS2, flagsS3, len;
+    int                 scan3dInst, ret;
+
+    // get args
+    ret = RackModule::getArgs(argc, argv, argTab, "Scan3dCompressBench");
+    if (ret)
+    {
+        printf("Invalid arguments -> EXIT \n");
+        return ret;
+    }
+
+    scan3dInst = getIntArg("scan3dInst", argTab);
+    flagsS1    = getIntArg("flagsS1", argTab);
+    flagsS2    = getIntArg("flagsS2", argTab);
+    flagsS3    = getIntArg("flagsS3", argTab);
+
+    ret = binReader.open(getStrArg("logFile", argTab));
+    if (ret)
+    {
+        printf("Can't open binary log %s, code = %d\n", getStrArg("logFile", argTab), ret);
+        return ret;
+    }
+
+    scan       = (scan3d_data *)malloc(sizeof(scan3d_data) + SCAN3D_POINT_MAX * sizeof(scan_point));
+    data       = (scan3d_data *)malloc(sizeof(scan3d_data) + SCAN3D_POINT_MAX * sizeof(scan_point));
+    serialTool = new Scan3dCompressTool();
+    blockTool  = new Scan3dCompressTool();
+    if (!scan || !data || !serialTool || !blockTool)
+    {
+        printf("Can't allocate buffers -> EXIT\n");
+        return -ENOMEM;
+    }
+
+    if (getIntArg("workerNum", argTab) > 0)
+    {
+        ret = jobMbx.create(RackName::create(TEST, 0) | 1, COMPR_BLOCK_WORKER_NUM_MAX,
+                            0, NULL, 0, 0);
+        if (!ret)
+        {
+            ret = doneMbx.create(RackName::create(TEST, 0) | 2, COMPR_BLOCK_WORKER_NUM_MAX,
+                                 0, NULL, 0, 0);
+        }
+        if (ret)
+        {
+            printf("Can't create the worker mailboxes (TiMS router running?), code = %d\n", ret);
+            return ret;
+        }
+    }
+
+    ret = blockTool->initBlocks(getIntArg("blockPointNum", argTab),
+                                getIntArg("workerNum", argTab), 1, &jobMbx, &doneMbx);
+    if (ret)
+    {
+        printf("Can't create compression workers, code = %d\n", ret);
+        return ret;
+    }
+
+    offset = binReader.first();
+    while (!binReader.getData(&offset, SCAN3D, scan3dInst, sizeof(scan3d_data),
+                              sizeof(scan3d_data) + SCAN3D_POINT_MAX * sizeof(scan_point),
+                              scan, &msgInfo))
+    {
+        Scan3dData::parse(&msgInfo);
+
+        if (scan->compressed || (scan->pointNum <= 0))
+        {
+            continue;
+        }
+
+        len = scan->pointNum * sizeof(scan_point);
+
+        memcpy(data, scan, sizeof(scan3d_data) + len);
+        time = rackTime.getNano();
+        serialBytes += serialTool->Compress(data, flagsS1, flagsS2, flagsS3);
+        serialTime  += rackTime.getNano() - time;
+
+        memcpy(data, scan, sizeof(scan3d_data) + len);
+        time = rackTime.getNano();
+        ret  = blockTool->CompressBlocks(data, flagsS1, flagsS2, flagsS3);
+        blockTime   += rackTime.getNano() - time;
+        blockBytes  += ret ? ret : len;
+
+        rawBytes += len;
+        scanNum++;
+    }
+
+    if (scanNum > 0)
+    {
+        printf("%d scans, %d kB uncompressed\n", scanNum, (int)(rawBytes / 1024));
+        printf("serial:  %8.3f ms/scan, %5.1f %% of the input size\n",
+               (double)serialTime / 1000000.0 / scanNum, 100.0 * serialBytes / rawBytes);
+        printf("blocks:  %8.3f ms/scan, %5.1f %% of the input size (%d workers)\n",
+               (double)blockTime / 1000000.0 / scanNum, 100.0 * blockBytes / rawBytes,
+               getIntArg("workerNum", argTab));
+    }
+    else
+    {
+        printf("No uncompressed scan3d data in %s\n", getStrArg("logFile", argTab));
+    }
+
+    delete blockTool;
+    delete serialTool;
+    if (getIntArg("workerNum", argTab) > 0)
+    {
+        doneMbx.remove();
+        jobMbx.remove();
+    }
+    free(data);
+    free(scan);
+    binReader.close();
+    return 0;
+}
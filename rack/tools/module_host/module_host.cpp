@@ -0,0 +1,58 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Oliver Wulf <oliver.wulf@web.de>
+ *
+ */
+#include <main/rack_module_host.h>
+
+//
+// Runs a perception and navigation chain in one process, e.g.
+//
+// RackModuleHost LadarSickLms200 --instance 0 -- Scan2d --instance 0
+//                -- Scan2dDynObjRecog --instance 0 -- PilotWallFollowing
+//
+
+int ladar_hokuyo_urg_main(int argc, char *argv[]);
+int ladar_sick_lms200_main(int argc, char *argv[]);
+int scan2d_main(int argc, char *argv[]);
+int scan2d_dyn_obj_recog_main(int argc, char *argv[]);
+int pilot_joystick_main(int argc, char *argv[]);
+int pilot_wall_following_main(int argc, char *argv[]);
+
+rack_module_host_entry moduleTab[] = {
+    { "LadarHokuyoUrg",     ladar_hokuyo_urg_main },
+    { "LadarSickLms200",    ladar_sick_lms200_main },
+    { "Scan2d",             scan2d_main },
+    { "Scan2dDynObjRecog",  scan2d_dyn_obj_recog_main },
+    { "PilotJoystick",      pilot_joystick_main },
+    { "PilotWallFollowing", pilot_wall_following_main },
+    { NULL,                 NULL } // last entry
+};
+
+int  main(int argc, char *argv[])
+{
+    int ret;
+
+    RackModuleHost host(moduleTab);
+
+    ret = host.start(argc, argv);
+    if (ret)
+    {
+        printf("Can't start modules -> EXIT\n");
+        return ret;
+    }
+
+    host.run();
+
+    return 0;
+}
@@ -0,0 +1,28 @@
+/*
+ * RACK - Robotics Application Construction Kit
+ * Copyright (C) 2005-2010 University of Hannover
+ *                         Institute for Systems Engineering - RTS
+ *                         Professor Bernardo Wagner
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Authors
+ *      Oliver Wulf <oliver.wulf@web.de>
+ *
+ */
+
+
+// One module linked into RackModuleHost (see main/rack_module_host.h).
+// GNUmakefile.am compiles this file once per module with the name prefix
+// of the renamed main() and argTab and the source file of the module.
+
+#define RACK_MODULE_HOST_CAT(a, b)      a ## b
+#define RACK_MODULE_HOST_SYM(a, b)      RACK_MODULE_HOST_CAT(a, b)
+
+#define main    RACK_MODULE_HOST_SYM(RACK_MODULE_HOST_NAME, _main)
+#define argTab  RACK_MODULE_HOST_SYM(RACK_MODULE_HOST_NAME, _argTab)
+
+#include RACK_MODULE_HOST_SOURCE